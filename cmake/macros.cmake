@@ -210,6 +210,12 @@ macro(add_src_and_test NAME)
 			add_subdirectory(${NAME}/test)
 		endif()
 	endif()
+
+	if (BUILD_BENCHMARKS)
+		if(EXISTS ${CMAKE_CURRENT_SOURCE_DIR}/${NAME}/benchmark)
+			add_subdirectory(${NAME}/benchmark)
+		endif()
+	endif()
 endmacro()
 
 
@@ -313,6 +319,39 @@ macro(create_test PATH DEPS)
 
 endmacro()
 
+# Benchmarks are plain executables that print their measurements, they
+# aren't run by ctest.
+macro(create_benchmark PATH DEPS)
+
+	get_filename_component(NAME ${PATH} NAME_WE)
+	get_filename_component(FILENAME ${PATH} NAME)
+
+	add_executable(${NAME} ${FILENAME})
+	default_options(${NAME})
+	target_link_libraries(${NAME}
+		PRIVATE
+		"${DEPS}"
+	)
+	set_target_properties(${NAME}
+		PROPERTIES
+		LINK_DEPENDS_NO_SHARED true
+		RUNTIME_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}/bin/benchmark"
+	)
+
+endmacro()
+
+macro(create_benchmarks DEPS)
+
+	file(GLOB SOURCES  ${CMAKE_CURRENT_SOURCE_DIR}/*.cpp)
+
+	foreach(BENCHMARK ${SOURCES})
+
+		create_benchmark(${BENCHMARK} "${DEPS}")
+
+	endforeach()
+
+endmacro()
+
 macro(create_tests DEPS)
 
 	file(GLOB SOURCES  ${CMAKE_CURRENT_SOURCE_DIR}/*.cpp)
@@ -75,6 +75,7 @@ namespace utility {
     class FrameRateDuration;
     class JsonStore;
     class MediaReference;
+    class OccupancyBitmap;
     class PlaylistTree;
     class Timecode;
     class UuidActor;
@@ -107,6 +108,7 @@ namespace media_reader {
     class AudioBuffer;
     class AudioBufPtr;
     class ImageBufPtr;
+    class ImageBufferExport;
     class MediaReaderManager;
     class PixelInfo;
 } // namespace media_reader
@@ -251,6 +253,9 @@ CAF_BEGIN_TYPE_ID_BLOCK(xstudio_simple_types, first_custom_type_id)
 
     // **************** add new entries here ******************
     CAF_ADD_TYPE_ID(xstudio_simple_types, (xstudio::ui::viewport::GPUShaderPtr))
+    CAF_ADD_TYPE_ID(xstudio_simple_types, (xstudio::media_reader::BufferExportMode))
+    CAF_ADD_TYPE_ID(xstudio_simple_types, (xstudio::media_reader::ImageBufferExport))
+    CAF_ADD_TYPE_ID(xstudio_simple_types, (xstudio::utility::OccupancyBitmap))
 
 CAF_END_TYPE_ID_BLOCK(xstudio_simple_types)
 
@@ -334,6 +339,9 @@ CAF_BEGIN_TYPE_ID_BLOCK(xstudio_complex_types, xstudio_simple_types_last_type_id
 
     // **************** add new entries here ******************
     CAF_ADD_TYPE_ID(xstudio_complex_types, (std::pair<std::string, uintmax_t>))
+    CAF_ADD_TYPE_ID(xstudio_complex_types, (std::vector<xstudio::media_reader::ImageBufferExport>))
+    CAF_ADD_TYPE_ID(xstudio_complex_types, (std::vector<float>))
+    CAF_ADD_TYPE_ID(xstudio_complex_types, (std::vector<caf::message>))
 
 CAF_END_TYPE_ID_BLOCK(xstudio_complex_types)
 
@@ -428,6 +436,12 @@ CAF_BEGIN_TYPE_ID_BLOCK(xstudio_framework_atoms, xstudio_complex_types_last_type
     CAF_ADD_ATOM(xstudio_framework_atoms, xstudio::module, attribute_uuids_atom)
     CAF_ADD_ATOM(xstudio_framework_atoms, xstudio::global, get_actor_from_registry_atom)
     CAF_ADD_ATOM(xstudio_framework_atoms, xstudio::module, link_module_atom)
+    CAF_ADD_ATOM(xstudio_framework_atoms, xstudio::global, shm_transport_atom)
+    CAF_ADD_ATOM(xstudio_framework_atoms, xstudio::broadcast, broadcast_flush_atom)
+    CAF_ADD_ATOM(xstudio_framework_atoms, xstudio::broadcast, broadcast_stats_atom)
+    CAF_ADD_ATOM(xstudio_framework_atoms, xstudio::broadcast, supersede_broadcast_atom)
+    CAF_ADD_ATOM(xstudio_framework_atoms, xstudio::broadcast, broadcast_batch_atom)
+    CAF_ADD_ATOM(xstudio_framework_atoms, xstudio::global, startup_timings_atom)
 
 CAF_END_TYPE_ID_BLOCK(xstudio_framework_atoms)
 
@@ -490,6 +504,8 @@ CAF_BEGIN_TYPE_ID_BLOCK(xstudio_plugin_atoms, xstudio_framework_atoms_last_type_
     CAF_ADD_ATOM(xstudio_plugin_atoms, xstudio::shotgun_client, shotgun_attachment_atom)
 
     // **************** add new entries here ******************
+    CAF_ADD_ATOM(xstudio_plugin_atoms, xstudio::http_client, http_metrics_atom)
+    CAF_ADD_ATOM(xstudio_plugin_atoms, xstudio::shotgun_client, shotgun_query_cache_atom)
 
 CAF_END_TYPE_ID_BLOCK(xstudio_plugin_atoms)
 
@@ -598,6 +614,8 @@ CAF_BEGIN_TYPE_ID_BLOCK(xstudio_session_atoms, xstudio_plugin_atoms_last_type_id
     CAF_ADD_ATOM(xstudio_session_atoms, xstudio::media, relink_atom)
     CAF_ADD_ATOM(xstudio_session_atoms, xstudio::media, decompose_atom)
     CAF_ADD_ATOM(xstudio_session_atoms, xstudio::media, rescan_atom)
+    CAF_ADD_ATOM(xstudio_session_atoms, xstudio::playlist, materialise_atom)
+    CAF_ADD_ATOM(xstudio_session_atoms, xstudio::media_metadata, frame_metadata_atom)
 
 CAF_END_TYPE_ID_BLOCK(xstudio_session_atoms)
 
@@ -699,6 +717,12 @@ CAF_BEGIN_TYPE_ID_BLOCK(xstudio_playback_atoms, xstudio_session_atoms_last_type_
     CAF_ADD_ATOM(xstudio_playback_atoms, xstudio::colour_pipeline, get_thumbnail_colour_pipeline_atom)
     CAF_ADD_ATOM(xstudio_playback_atoms, xstudio::colour_pipeline, connect_to_viewport_atom)
     CAF_ADD_ATOM(xstudio_playback_atoms, xstudio::colour_pipeline, colour_operation_uniforms_atom)
+    CAF_ADD_ATOM(xstudio_playback_atoms, xstudio::media_reader, export_image_atom)
+    CAF_ADD_ATOM(xstudio_playback_atoms, xstudio::media_reader, pixel_statistics_atom)
+    CAF_ADD_ATOM(xstudio_playback_atoms, xstudio::media_cache, cache_occupancy_atom)
+    CAF_ADD_ATOM(xstudio_playback_atoms, xstudio::media_reader, precache_estimate_atom)
+    CAF_ADD_ATOM(xstudio_playback_atoms, xstudio::media_reader, decode_from_memory_atom)
+    CAF_ADD_ATOM(xstudio_playback_atoms, xstudio::media_reader, get_filmstrip_atom)
 
 
 CAF_END_TYPE_ID_BLOCK(xstudio_playback_atoms)
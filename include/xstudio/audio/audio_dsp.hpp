@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "xstudio/media_reader/audio_buffer.hpp"
+
+namespace xstudio::audio {
+
+/**
+ *  @brief Sample processing kernels for the float audio path. Buffers are
+ *  single channels of float samples (planar), kernels use SSE2 where the
+ *  build target has it with a scalar tail/fallback.
+ */
+namespace dsp {
+
+    /**
+     *  @brief dst[i] += src[i] * gain
+     */
+    void mix_add(float *dst, const float *src, const long n, const float gain);
+
+    /**
+     *  @brief dst[i] += src[i] * gain, gain moving linearly from 'from' (first
+     *  sample) towards 'to' (the sample after the last)
+     */
+    void mix_add_ramp(
+        float *dst, const float *src, const long n, const float from, const float to);
+
+    /**
+     *  @brief buf[i] *= gain
+     */
+    void apply_gain(float *buf, const long n, const float gain);
+
+    /**
+     *  @brief buf[i] *= gain, gain moving linearly from 'from' towards 'to'
+     */
+    void apply_gain_ramp(float *buf, const long n, const float from, const float to);
+
+    /**
+     *  @brief Interleave num_channels planar buffers of n samples into out
+     */
+    void interleave(
+        const std::vector<const float *> &channels, const long n, float *out);
+
+    /**
+     *  @brief Convert float samples (nominal range -1 to 1) to clamped int16
+     */
+    void float_to_int16(const float *in, int16_t *out, const long n);
+
+    /**
+     *  @brief Coefficients to mix in_channels into out_channels, row major
+     *  (out_channels rows of in_channels). Channel orders are FFmpeg's default
+     *  layouts for the channel count (mono, stereo, 3.0, 4.0, 5.0, 5.1, 6.1,
+     *  7.1). Matching speakers map directly, centre is split into left/right
+     *  at -3dB, surround channels fold into the front pair at -3dB and LFE is
+     *  dropped. Rows are normalised so a full scale input can't clip.
+     */
+    std::vector<float> downmix_matrix(const int in_channels, const int out_channels);
+
+    /**
+     *  @brief Polyphase Kaiser windowed sinc resampler.
+     *
+     *  @details Converts a block of num_in samples to num_out samples, i.e. it
+     *  handles both sample rate conversion and varispeed. When downsampling the
+     *  filter cutoff is lowered to the output Nyquist rate so that content
+     *  above it is attenuated rather than aliased. Samples beyond the ends of
+     *  the block are taken as the edge sample. The filter bank is cached and
+     *  only rebuilt when the cutoff changes.
+     *
+     *  stream() resamples consecutive blocks of a continuous signal. It keeps
+     *  the end of each channel's previous block so the filter runs across
+     *  block boundaries instead of extending the edges, at the cost of a
+     *  delay of latency() input samples.
+     */
+    class SincResampler {
+      public:
+        SincResampler(
+            const int half_taps = 16, const int phases = 256, const double beta = 8.0);
+
+        void process(const float *in, const long num_in, float *out, const long num_out);
+
+        void stream(
+            const int channel,
+            const float *in,
+            const long num_in,
+            float *out,
+            const long num_out);
+
+        // forget the history, the next stream() starts a new signal
+        void reset();
+
+        [[nodiscard]] int latency() const { return width_; }
+
+        // narrowest cutoff (as fraction of input Nyquist) the resampler will use
+        static constexpr double min_cutoff = 0.125;
+
+      private:
+        void build_filters(const double cutoff);
+        void update_filters(const long num_in, const long num_out);
+
+        const int half_taps_;
+        const int phases_;
+        const double beta_;
+
+        double cutoff_ = {0.0};
+        int width_     = {0};
+        std::vector<float> filters_;
+        std::vector<float> padded_;
+        std::vector<std::vector<float>> history_;
+    };
+
+} // namespace dsp
+
+/**
+ *  @brief Copy of an xstudio audio buffer as planar float samples. Returns the
+ *  input if it is already planar float.
+ */
+media_reader::AudioBufPtr to_planar_float(const media_reader::AudioBufPtr &in);
+
+/**
+ *  @brief Resample a planar float buffer to num_samples samples, leaving the
+ *  sample rate set to 'sample_rate'. The buffer is taken to follow on from the
+ *  last one given to the resampler.
+ */
+media_reader::AudioBufPtr resample_planar(
+    const media_reader::AudioBufPtr &in,
+    const long num_samples,
+    const long sample_rate,
+    dsp::SincResampler &resampler);
+
+/**
+ *  @brief Time reversed copy of a planar float buffer
+ */
+media_reader::AudioBufPtr reverse_planar(const media_reader::AudioBufPtr &in);
+
+} // namespace xstudio::audio
@@ -3,6 +3,8 @@
 
 #include <chrono>
 
+#include "xstudio/audio/audio_dsp.hpp"
+#include "xstudio/audio/audio_render.hpp"
 #include "xstudio/media_reader/media_reader.hpp"
 #include "xstudio/module/module.hpp"
 #include "xstudio/utility/chrono.hpp"
@@ -15,6 +17,11 @@ namespace xstudio::audio {
  *  @brief Class for delivering audio to soundcard by maintaining a smoothed
  *  measurment of the playhead position and re-sampling audio sources as
  *  required
+ *
+ *  @details Incoming audio is converted to planar float at the soundcard
+ *  sample rate (applying varispeed and reverse playback) and published to
+ *  the AudioRenderer, which mixes it down to the soundcard channel layout on
+ *  the soundcard thread.
  */
 
 class AudioOutputControl : public module::Module {
@@ -34,19 +41,6 @@ class AudioOutputControl : public module::Module {
      */
     ~AudioOutputControl() override = default;
 
-    /**
-     *  @brief Use steady clock combined with soundcard latency to fill a
-     *  buffer with sound samples, pulling samples from the queue of timestamped
-     *  audio frames.
-     *
-     */
-    void prepare_samples_for_soundcard(
-        std::vector<int16_t> &samples,
-        const long num_samps_to_push,
-        const long microseconds_delay,
-        const int num_channels,
-        const int sample_rate);
-
     /**
      *  @brief Set the audio volume in range 0-1
      */
@@ -76,27 +70,24 @@ class AudioOutputControl : public module::Module {
      */
     void clear_queued_samples();
 
-    enum Fade { NoFade = 0, DoFadeHead = 1, DoFadeTail = 2, DoFadeHeadAndTail = 3 };
+    /**
+     *   @brief The render core shared with the soundcard thread
+     */
+    [[nodiscard]] std::shared_ptr<AudioRenderer> renderer() const { return renderer_; }
 
-  private:
-    media_reader::AudioBufPtr
-    pick_audio_buffer(const utility::clock::time_point &tp, const bool drop_old_buffers);
+  protected:
+    void attribute_changed(const utility::Uuid &attr_uuid, const int role_id) override;
 
-    Fade check_if_buffer_is_contiguous_with_previous_and_next(
-        const media_reader::AudioBufPtr &current_buf,
-        const media_reader::AudioBufPtr &next_buf,
-        const media_reader::AudioBufPtr &previous_buf_);
+  private:
+    void update_renderer_settings();
 
     utility::JsonStore prefs_;
 
-    std::map<utility::time_point, media_reader::AudioBufPtr> sample_data_;
-    media_reader::AudioBufPtr current_buf_;
-    media_reader::AudioBufPtr previous_buf_;
-    long current_buf_pos_;
+    std::shared_ptr<AudioRenderer> renderer_;
+    dsp::SincResampler resampler_;
+    bool forwards_           = {true};
     float playback_velocity_ = {1.0f};
 
-    int fade_in_out_ = {NoFade};
-
     module::IntegerAttribute *audio_delay_millisecs_;
     module::BooleanAttribute *audio_repitch_;
     module::BooleanAttribute *audio_scrubbing_;
@@ -1,7 +1,9 @@
 // SPDX-License-Identifier: Apache-2.0
 #pragma once
 
+#include <atomic>
 #include <caf/all.hpp>
+#include <thread>
 
 #include "xstudio/audio/audio_output.hpp"
 #include "xstudio/audio/audio_output_device.hpp"
@@ -13,27 +15,38 @@ class AudioOutputDeviceActor : public caf::event_based_actor {
   public:
     AudioOutputDeviceActor(
         caf::actor_config &cfg,
-        caf::actor_addr audio_playback_manager,
+        std::shared_ptr<AudioRenderer> renderer,
         const std::string name = "AudioOutputDeviceActor");
 
     ~AudioOutputDeviceActor() override = default;
 
     caf::behavior make_behavior() override { return behavior_; }
 
+    void on_exit() override;
     const char *name() const override { return NAME.c_str(); }
 
   private:
     void open_output_device(const utility::JsonStore &prefs);
 
+    void start_render_thread();
+    void stop_render_thread();
+    void render_loop();
+
     std::unique_ptr<AudioOutputDevice> output_device_;
 
     inline static const std::string NAME = "AudioOutputDeviceActor";
 
     caf::behavior behavior_;
     std::string name_;
-    bool playing_;
-    caf::actor_addr audio_playback_manager_;
-    bool waiting_for_samples_;
+    std::shared_ptr<AudioRenderer> renderer_;
+    std::thread render_thread_;
+    std::atomic<bool> playing_ = {false};
+
+    // the soundcard request size the render thread allocates for, and
+    // requests above it that had to be split
+    std::atomic<long> max_request_     = {0};
+    std::atomic<long> largest_request_ = {0};
+    std::atomic<long> split_requests_  = {0};
 };
 
 
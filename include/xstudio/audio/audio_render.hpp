@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "xstudio/audio/audio_dsp.hpp"
+#include "xstudio/audio/audio_samples_fifo.hpp"
+#include "xstudio/media_reader/audio_buffer.hpp"
+#include "xstudio/utility/chrono.hpp"
+
+namespace xstudio::audio {
+
+/**
+ *  @brief Bounded lock-free queue for exactly one producer thread and one
+ *  consumer thread. Capacity is rounded up to a power of two.
+ */
+template <typename T> class SPSCQueue {
+  public:
+    SPSCQueue(const size_t capacity = 1024) {
+        size_t sz = 2;
+        while (sz < capacity)
+            sz <<= 1;
+        slots_.resize(sz);
+        mask_ = sz - 1;
+    }
+
+    SPSCQueue(const SPSCQueue &) = delete;
+    SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+    /**
+     *  @brief Producer side, returns false if the queue is full
+     */
+    bool try_push(T &&v) {
+        const auto w = write_.load(std::memory_order_relaxed);
+        if (w - read_.load(std::memory_order_acquire) > mask_)
+            return false;
+        slots_[w & mask_] = std::move(v);
+        write_.store(w + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     *  @brief Consumer side, returns false if the queue is empty
+     */
+    bool try_pop(T &v) {
+        const auto r = read_.load(std::memory_order_relaxed);
+        if (r == write_.load(std::memory_order_acquire))
+            return false;
+        v = std::move(slots_[r & mask_]);
+        release_slot(r & mask_);
+        read_.store(r + 1, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] size_t capacity() const { return slots_.size(); }
+
+  private:
+    // the popped value is copied out and the slot emptied here so that a
+    // copy-only type (like AudioBufPtr) isn't left holding a reference that
+    // the producer would later release
+    void release_slot(const size_t slot) { slots_[slot] = T(); }
+
+    std::vector<T> slots_;
+    size_t mask_ = {0};
+    alignas(64) std::atomic<size_t> write_{0};
+    alignas(64) std::atomic<size_t> read_{0};
+};
+
+/**
+ *  @brief Real-time side of audio output.
+ *
+ *  @details The render core is shared between the actor that decides what
+ *  audio to play (producer) and the soundcard thread (consumer). The producer
+ *  publishes timestamped, already converted (planar float at the device sample
+ *  rate) buffers through a lock-free queue. The soundcard thread mixes them
+ *  into a preallocated ring of interleaved samples and pulls soundcard sized
+ *  blocks from it. Nothing on the soundcard thread allocates, locks or sends
+ *  messages: buffers it has finished with are handed back through a second
+ *  queue so they are released on the producer side.
+ *
+ *  configure() must only be called while the soundcard thread isn't running.
+ */
+class AudioRenderer {
+  public:
+    enum Fade { NoFade = 0, DoFadeHead = 1, DoFadeTail = 2, DoFadeHeadAndTail = 3 };
+
+    AudioRenderer(
+        const size_t queue_capacity = 512,
+        const long block_size       = 256,
+        const int max_channels      = 8);
+
+    /**
+     *  @brief Set the soundcard format and preallocate for soundcard requests
+     *  of up to max_request samples. Resets all queued audio.
+     */
+    void configure(const long sample_rate, const int num_channels, const long max_request);
+
+    // Producer side
+
+    /**
+     *  @brief Queue a buffer to sound at the given time. Returns false if the
+     *  queue is full, the buffer is dropped. Buffers the soundcard thread is
+     *  done with are released first.
+     */
+    bool queue(
+        const utility::time_point &when,
+        const media_reader::AudioBufPtr &buf,
+        const float velocity = 1.0f);
+
+    /**
+     *  @brief Drop all queued audio, including anything in flight to the
+     *  soundcard thread. Never blocks or fails.
+     */
+    void clear() { clear_generation_.fetch_add(1, std::memory_order_acq_rel); }
+
+    /**
+     *  @brief Release buffers the soundcard thread is done with
+     */
+    void collect_garbage();
+
+    void set_volume(const float v) { volume_.store(v, std::memory_order_relaxed); }
+    void set_muted(const bool m) { muted_.store(m, std::memory_order_relaxed); }
+    void set_delay_millisecs(const int d) {
+        delay_millisecs_.store(d, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] long sample_rate() const { return sample_rate_.load(); }
+    [[nodiscard]] int num_channels() const { return num_channels_.load(); }
+
+    // Consumer (soundcard thread) side
+
+    /**
+     *  @brief Fill dest with num_samples interleaved samples for the soundcard.
+     *  microseconds_delay is the soundcard's own latency. dest must hold
+     *  num_samples * num_channels() floats.
+     */
+    void pull(float *dest, const long num_samples, const long microseconds_delay);
+
+    /**
+     *  @brief Number of buffers waiting to be played (soundcard thread only)
+     */
+    [[nodiscard]] size_t pending() const { return num_pending_; }
+
+  private:
+    struct Command {
+        utility::time_point when;
+        media_reader::AudioBufPtr buf;
+        float velocity      = {1.0f};
+        uint64_t generation = {0};
+    };
+
+    struct Pending {
+        utility::time_point when;
+        media_reader::AudioBufPtr buf;
+    };
+
+    void process_commands();
+    void insert_pending(const utility::time_point &when, media_reader::AudioBufPtr &buf);
+    void retire(media_reader::AudioBufPtr &buf);
+    void retire_all();
+
+    void render_block(const long microseconds_delay);
+
+    media_reader::AudioBufPtr
+    pick_audio_buffer(const utility::time_point &tp, const bool drop_old_buffers);
+
+    Fade check_if_buffer_is_contiguous_with_previous_and_next(
+        const media_reader::AudioBufPtr &current_buf,
+        const media_reader::AudioBufPtr &next_buf,
+        const media_reader::AudioBufPtr &previous_buf);
+
+    void mix(
+        const media_reader::AudioBufPtr &buf,
+        const long buf_position,
+        const long num_samples,
+        const long out_position);
+
+    SPSCQueue<Command> commands_;
+    SPSCQueue<media_reader::AudioBufPtr> retired_;
+
+    const long block_size_;
+    const int max_channels_;
+
+    std::atomic<long> sample_rate_{0};
+    std::atomic<int> num_channels_{0};
+    std::atomic<float> volume_{1.0f};
+    std::atomic<bool> muted_{false};
+    std::atomic<int> delay_millisecs_{0};
+    std::atomic<uint64_t> clear_generation_{0};
+
+    // soundcard thread state, sized in configure()
+    long max_request_ = {0};
+    std::vector<Pending> pending_;
+    size_t num_pending_       = {0};
+    uint64_t seen_generation_ = {0};
+    media_reader::AudioBufPtr current_buf_;
+    media_reader::AudioBufPtr previous_buf_;
+    long current_buf_pos_    = {0};
+    int fade_in_out_         = {NoFade};
+    float playback_velocity_ = {1.0f};
+    float last_volume_       = {-1.0f};
+
+    // downmix matrices indexed by source channel count
+    std::vector<std::vector<float>> downmix_;
+    std::vector<std::vector<float>> mix_buffer_;
+    std::vector<const float *> mix_channels_;
+    std::vector<float> block_;
+    AudioSampleDataFIFO<float> ring_;
+};
+
+} // namespace xstudio::audio
@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: Apache-2.0
 #pragma once
 #include <cmath>
+#include <cstring>
+#include <limits>
 #include <stdexcept>
 #include <vector>
 
@@ -72,6 +74,19 @@ template <typename T> class AudioSampleDataFIFO {
      */
     inline void pop(std::vector<T> &dest);
 
+    /**
+     *  @brief Remove up to count elements from the front of the buffer into dest
+     */
+    void pop(T *dest, const size_t count);
+
+    /**
+     *  @brief Empty the buffer
+     */
+    void clear() {
+        start_ = 0;
+        end_   = 0;
+    }
+
     /**
      *  @brief Return the total cumulative amount of elements that have passed through
      *  the ring buffer
@@ -173,31 +188,32 @@ void AudioSampleDataFIFO<T>::blended_push(
 }
 
 template <typename T> void AudioSampleDataFIFO<T>::pop(std::vector<T> &dest) {
+    pop(dest.data(), dest.size());
+}
+
+template <typename T> void AudioSampleDataFIFO<T>::pop(T *dest, const size_t count) {
 
     if (end_ < start_) {
 
         memcpy(
-            dest.data(),
+            dest,
             buffer_.data() + start_,
-            std::min(dest.size(), buffer_.size() - start_) * sizeof(T));
+            std::min(count, buffer_.size() - start_) * sizeof(T));
 
-        if (dest.size() > (buffer_.size() - start_)) {
+        if (count > (buffer_.size() - start_)) {
             memcpy(
-                dest.data() + (buffer_.size() - start_),
+                dest + (buffer_.size() - start_),
                 buffer_.data(),
-                std::min(dest.size() - (buffer_.size() - start_), end_) * sizeof(T));
-            start_ = std::min(dest.size() - (buffer_.size() - start_), end_);
+                std::min(count - (buffer_.size() - start_), end_) * sizeof(T));
+            start_ = std::min(count - (buffer_.size() - start_), end_);
         } else {
-            start_ += dest.size();
+            start_ += count;
         }
 
     } else {
 
-        memcpy(
-            dest.data(),
-            buffer_.data() + start_,
-            std::min(dest.size(), end_ - start_) * sizeof(T));
-        start_ += std::min(dest.size(), end_ - start_);
+        memcpy(dest, buffer_.data() + start_, std::min(count, end_ - start_) * sizeof(T));
+        start_ += std::min(count, end_ - start_);
     }
 }
 
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "xstudio/audio/audio_output_device.hpp"
+
+namespace xstudio::audio {
+
+/**
+ *  @brief Audio output device without a soundcard.
+ *
+ *  @details Consumes float samples at the configured rate, optionally writing
+ *  them to a WAV file. When realtime is set push_samples blocks for the
+ *  duration of the samples, like a soundcard would, otherwise it returns
+ *  immediately. Used for headless sessions and testing the render path.
+ */
+class NullAudioOutputDevice : public AudioOutputDevice {
+  public:
+    NullAudioOutputDevice(
+        const long sample_rate  = 48000,
+        const int num_channels  = 2,
+        const long buffer_size  = 2048,
+        const std::string &path = std::string(),
+        const bool realtime     = true);
+
+    ~NullAudioOutputDevice() override;
+
+    void connect_to_soundcard() override;
+
+    void disconnect_from_soundcard() override;
+
+    long desired_samples() override { return buffer_size_; }
+
+    void push_samples(const void *sample_data, const long num_samples) override;
+
+    long latency_microseconds() override { return 0; }
+
+    [[nodiscard]] long sample_rate() const override { return sample_rate_; }
+
+    [[nodiscard]] int num_channels() const override { return num_channels_; }
+
+    [[nodiscard]] SampleFormat sample_format() const override { return SampleFormat::FLOAT32; }
+
+    /**
+     *  @brief Total samples pushed since connecting
+     */
+    [[nodiscard]] long samples_pushed() const { return samples_pushed_; }
+
+  private:
+    void write_wav_header();
+
+    const long sample_rate_;
+    const int num_channels_;
+    const long buffer_size_;
+    const std::string path_;
+    const bool realtime_;
+
+    FILE *file_          = {nullptr};
+    long samples_pushed_ = {0};
+    std::chrono::steady_clock::time_point next_push_;
+};
+
+} // namespace xstudio::audio
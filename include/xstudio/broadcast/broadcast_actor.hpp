@@ -2,10 +2,25 @@
 #pragma once
 
 #include <caf/all.hpp>
+#include <map>
 #include <set>
+#include <string>
+#include <tuple>
+#include <vector>
 
 namespace xstudio {
 namespace broadcast {
+    /* Forwards every message it doesn't handle itself to its subscribers, as
+       if sent by the original sender.
+
+       Subscribers joining with a time window instead receive
+       (broadcast_batch_atom, std::vector<caf::message>) at most once per window
+       per sender. Messages whose type signature has been registered with
+       supersede_broadcast_atom only keep the latest instance per sender in a
+       batch, for things like position updates. Registering with the index of
+       a key element (a Uuid, actor, string or integer) keeps the latest
+       instance per sender and key instead.
+    */
     class BroadcastActor : public caf::event_based_actor {
       public:
         BroadcastActor(caf::actor_config &cfg, caf::actor owner = caf::actor());
@@ -16,16 +31,52 @@ namespace broadcast {
         static caf::message_handler default_event_handler();
 
       private:
+        struct Counters {
+            size_t in{0};
+            size_t out{0};
+            size_t superseded{0};
+        };
+
+        struct Pending {
+            caf::actor_addr sender;
+            caf::message msg;
+        };
+
+        // sender, type signature and key of a superseded message
+        using SupersedeKey = std::tuple<caf::actor_addr, caf::type_id_list, std::string>;
+
+        struct CoalescedSubscriber {
+            caf::timespan window;
+            bool flush_queued{false};
+            std::vector<Pending> pending;
+            // where the latest instance of each superseded message is in pending
+            std::map<SupersedeKey, size_t> latest;
+        };
+
         inline static const std::string NAME = "BroadcastActor";
         void init();
         caf::behavior make_behavior() override { return behavior_; }
 
         caf::skippable_result broadcast_message(caf::scheduled_actor *, caf::message &);
 
+        bool add_subscriber(const caf::actor &sub, const caf::timespan window = {});
+        bool remove_subscriber(const caf::actor &sub);
+        void queue_message(
+            const caf::actor_addr &subscriber,
+            CoalescedSubscriber &coalesced,
+            const caf::message &msg);
+        void flush(const caf::actor_addr &subscriber);
+
       private:
         caf::behavior behavior_;
         caf::actor_addr owner_;
         std::set<caf::actor_addr> subscribers_;
+        std::map<caf::actor_addr, CoalescedSubscriber> coalesced_;
+        // key element index of superseded signatures, -1 for no key
+        std::map<caf::type_id_list, int> supersede_;
+        std::map<caf::type_id_list, Counters> counters_;
+        size_t flushes_{0};
+        size_t batches_{0};
     };
 
 } // namespace broadcast
@@ -4,6 +4,7 @@
 #include <caf/actor_config.hpp>
 #include <caf/behavior.hpp>
 #include <caf/event_based_actor.hpp>
+#include <memory>
 
 #include "xstudio/global/enums.hpp"
 #include "xstudio/utility/exports.hpp"
@@ -14,11 +15,13 @@
 namespace xstudio {
 namespace global {
 
+    class ShmTransportServer;
+
     class DLL_PUBLIC GlobalActor : public caf::event_based_actor {
       public:
         GlobalActor(
             caf::actor_config &cfg, const utility::JsonStore &prefs = utility::JsonStore());
-        ~GlobalActor() override = default;
+        ~GlobalActor() override;
         const char *name() const override { return NAME.c_str(); }
         void on_exit() override;
 
@@ -50,6 +53,8 @@ namespace global {
         int port_maximum_;
         std::string bind_address_;
         bool connected_;
+        bool shm_transport_enabled_;
+        std::unique_ptr<ShmTransportServer> shm_transport_;
 
         bool sync_api_enabled_;
         int sync_port_minimum_;
@@ -65,7 +70,9 @@ namespace global {
         caf::uri session_autosave_path_{};
         int session_autosave_interval_{300};
         size_t session_autosave_hash_{0};
+        bool session_autosave_binary_{false};
         StatusType status_{StatusType::ST_NONE};
+        utility::JsonStore startup_timings_;
         std::set<caf::actor_addr> busy_;
     };
 } // namespace global
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <caf/actor.hpp>
+#include <caf/actor_system.hpp>
+#include <caf/binary_deserializer.hpp>
+#include <caf/binary_serializer.hpp>
+#include <caf/message.hpp>
+#include <caf/scoped_actor.hpp>
+
+#include "xstudio/utility/shm_channel.hpp"
+
+namespace xstudio {
+namespace global {
+
+    /* Frames exchanged over the channel are the caller's message id, the
+    destination actor id (zero for responses) and the message. They are
+    serialised without an actor system, which makes encoding fail for
+    anything holding actor handles - those have to go through the middleman. */
+    inline bool encode_shm_frame(
+        std::vector<std::byte> &buffer,
+        uint64_t message_id,
+        caf::actor_id destination,
+        caf::message &msg) {
+        buffer.clear();
+        caf::binary_serializer sink{nullptr, buffer};
+        return sink.apply(message_id) and sink.apply(destination) and sink.apply(msg);
+    }
+
+    inline bool decode_shm_frame(
+        const std::vector<std::byte> &buffer,
+        uint64_t &message_id,
+        caf::actor_id &destination,
+        caf::message &msg) {
+        caf::binary_deserializer source{nullptr, buffer};
+        return source.apply(message_id) and source.apply(destination) and source.apply(msg);
+    }
+
+    /* Same host fast path for the remote API. Clients that connected over
+    the middleman (TCP) may additionally open a ShmChannel through the unix
+    socket advertised by the GlobalActor (see shm_transport_atom).
+
+    Requests arriving over the channel carry the client's message id, the id
+    of the destination actor and the serialised message. They are dispatched
+    from a scoped actor and the responses are written back over the channel.
+    Anything that cannot be serialised without the middleman (i.e. responses
+    containing actor handles) is delivered to the client's actor through the
+    regular connection instead, with the original message id, so the client
+    doesn't need to care which way a response came. */
+    class ShmTransportServer {
+      public:
+        ShmTransportServer(
+            caf::actor_system &system,
+            const size_t capacity = utility::ShmChannel::default_capacity);
+        ~ShmTransportServer();
+
+        ShmTransportServer(const ShmTransportServer &) = delete;
+        ShmTransportServer &operator=(const ShmTransportServer &) = delete;
+
+        [[nodiscard]] const std::string &path() const { return listener_.path(); }
+
+        // pair the channel handed out with token to the client's actor
+        bool bind_client(const std::string &token, const caf::actor &client);
+
+      private:
+        struct Connection;
+
+        void accept_loop();
+        void request_loop(std::shared_ptr<Connection> connection);
+        void response_loop(std::shared_ptr<Connection> connection);
+        void reap_connections(const bool all = false);
+
+        caf::actor_system &system_;
+        utility::ShmChannelListener listener_;
+        std::thread accept_thread_;
+        std::mutex mutex_;
+        std::map<std::string, std::shared_ptr<Connection>> connections_;
+    };
+
+} // namespace global
+} // namespace xstudio
@@ -7,7 +7,15 @@
 #ifndef CPPHTTPLIB_ZLIB_SUPPORT
 #define CPPHTTPLIB_ZLIB_SUPPORT
 #endif
+#include <chrono>
 #include <cpp-httplib/httplib.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "xstudio/utility/json_store.hpp"
 
 namespace xstudio {
 namespace http_client {
@@ -16,5 +24,88 @@ namespace http_client {
         HTTPClient()          = default;
         virtual ~HTTPClient() = default;
     };
+
+    /**
+     *  @brief Keep-alive clients kept per scheme/host/port and shared by the
+     *  HTTP workers.
+     *
+     *  @details An httplib client can't run two requests at once, so each
+     *  request borrows an idle client for the host, or makes a new one, and
+     *  hands it back afterwards with its connection still open. A client
+     *  whose request failed is dropped instead. Responses are gzip or deflate
+     *  decoded.
+     */
+    class ConnectionPool {
+      public:
+        struct HostMetrics {
+            size_t requests = {0};
+            // requests that had to connect first
+            size_t connections = {0};
+            // requests sent on an already open connection
+            size_t reused = {0};
+            size_t errors = {0};
+            std::chrono::microseconds total_latency{0};
+            std::chrono::microseconds max_latency{0};
+        };
+
+        ConnectionPool(
+            time_t connection_timeout = CPPHTTPLIB_CONNECTION_TIMEOUT_SECOND,
+            time_t read_timeout       = CPPHTTPLIB_READ_TIMEOUT_SECOND,
+            time_t write_timeout      = CPPHTTPLIB_WRITE_TIMEOUT_SECOND,
+            size_t max_idle_per_host  = 8);
+        virtual ~ConnectionPool() = default;
+
+        /**
+         *  @brief Run func with a client for scheme_host_port, recording how
+         *  long it took and whether the connection was reused.
+         */
+        template <typename F>
+        httplib::Result send(const std::string &scheme_host_port, F &&func);
+
+        // adds Accept-Encoding, unless the caller asked for something else
+        static httplib::Headers accept_compressed(const httplib::Headers &headers);
+
+        [[nodiscard]] std::map<std::string, HostMetrics> host_metrics() const;
+        [[nodiscard]] utility::JsonStore metrics() const;
+        [[nodiscard]] size_t idle(const std::string &scheme_host_port) const;
+
+        // close all idle connections
+        void clear();
+
+      private:
+        std::unique_ptr<httplib::Client> acquire(const std::string &scheme_host_port);
+        void release(
+            const std::string &scheme_host_port,
+            std::unique_ptr<httplib::Client> client,
+            const bool reused,
+            const bool ok,
+            const std::chrono::steady_clock::duration latency);
+
+        time_t connection_timeout_;
+        time_t read_timeout_;
+        time_t write_timeout_;
+        size_t max_idle_per_host_;
+
+        mutable std::mutex mutex_;
+        std::map<std::string, std::vector<std::unique_ptr<httplib::Client>>> idle_;
+        std::map<std::string, HostMetrics> metrics_;
+    };
+
+    template <typename F>
+    httplib::Result ConnectionPool::send(const std::string &scheme_host_port, F &&func) {
+        auto client       = acquire(scheme_host_port);
+        const bool reused = client->is_socket_open() != 0;
+        const auto start  = std::chrono::steady_clock::now();
+
+        httplib::Result result = func(*client);
+
+        release(
+            scheme_host_port,
+            std::move(client),
+            reused,
+            result.error() == httplib::Error::Success,
+            std::chrono::steady_clock::now() - start);
+        return result;
+    }
 } // namespace http_client
 } // namespace xstudio
@@ -2,6 +2,10 @@
 #pragma once
 
 #include <caf/all.hpp>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
 
 #include "xstudio/http_client/http_client.hpp"
 #include "xstudio/utility/uuid.hpp"
@@ -11,11 +15,14 @@ namespace xstudio {
 namespace http_client {
     class HTTPClientActor : public caf::event_based_actor {
       public:
+        // max_per_host limits the requests to one host that are out at once,
+        // zero lets a single host use every worker.
         HTTPClientActor(
             caf::actor_config &cfg,
             time_t connection_timeout = CPPHTTPLIB_CONNECTION_TIMEOUT_SECOND,
             time_t read_timeout       = CPPHTTPLIB_READ_TIMEOUT_SECOND,
-            time_t write_timeout      = CPPHTTPLIB_WRITE_TIMEOUT_SECOND);
+            time_t write_timeout      = CPPHTTPLIB_WRITE_TIMEOUT_SECOND,
+            size_t max_per_host       = 0);
         ~HTTPClientActor() override = default;
 
         const char *name() const override { return NAME.c_str(); }
@@ -25,20 +32,38 @@ namespace http_client {
         void init();
         caf::behavior make_behavior() override { return behavior_; }
 
+        // Requests wait here until their host has a free slot, higher
+        // priority first, then in the order they arrived.
+        template <typename T, typename Atom, typename... Ts>
+        caf::result<T> schedule(
+            const int priority, Atom atom, const std::string &scheme_host_port, Ts... xs);
+        void dispatch();
+        void finished(const std::string &scheme_host_port);
+
+        struct Pending {
+            int priority;
+            std::string scheme_host_port;
+            std::function<void(caf::actor &)> send;
+        };
+
       private:
         caf::behavior behavior_;
         time_t connection_timeout_;
         time_t read_timeout_;
         time_t write_timeout_;
+        size_t max_per_host_;
+        size_t worker_count_ = {10};
+
+        caf::actor pool_;
+        std::shared_ptr<ConnectionPool> connections_;
+        std::list<Pending> pending_;
+        std::map<std::string, size_t> in_flight_;
+        size_t total_in_flight_ = {0};
     };
 
     class HTTPWorker : public caf::event_based_actor {
       public:
-        HTTPWorker(
-            caf::actor_config &cfg,
-            time_t connection_timeout = CPPHTTPLIB_CONNECTION_TIMEOUT_SECOND,
-            time_t read_timeout       = CPPHTTPLIB_READ_TIMEOUT_SECOND,
-            time_t write_timeout      = CPPHTTPLIB_WRITE_TIMEOUT_SECOND);
+        HTTPWorker(caf::actor_config &cfg, std::shared_ptr<ConnectionPool> connections);
         ~HTTPWorker() override = default;
 
         const char *name() const override { return NAME.c_str(); }
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "xstudio/utility/json_store.hpp"
+
+namespace xstudio {
+namespace media {
+
+    /**
+     *  @brief Per-frame header attributes of a source, held as a column per
+     *  attribute.
+     *
+     *  @details Readers that parse a frame's header to decode it can return
+     *  the attributes with the image, and the source collects them here, so
+     *  per-frame queries don't read the files again. Numbers and strings are
+     *  kept in typed arrays, anything else as json. An attribute whose type
+     *  differs between frames falls back to json.
+     *
+     *  Only frames that have been decoded are held, so the frames need not be
+     *  contiguous.
+     */
+    class FrameMetadata {
+      public:
+        enum ColumnType { CT_NUMBER, CT_STRING, CT_JSON };
+
+        FrameMetadata()          = default;
+        virtual ~FrameMetadata() = default;
+
+        // attributes is an object of attribute name to value, and replaces
+        // anything held for the frame
+        void add(const int frame, const nlohmann::json &attributes);
+        void clear();
+
+        [[nodiscard]] bool empty() const { return frames_.empty(); }
+        [[nodiscard]] const std::vector<int> &frames() const { return frames_; }
+        [[nodiscard]] bool has_frame(const int frame) const;
+        [[nodiscard]] std::vector<std::string> attributes() const;
+
+        // the attributes of one frame, null if it hasn't been captured
+        [[nodiscard]] nlohmann::json frame(const int frame) const;
+        // {"type", "frames", "values"}, null for an unknown attribute
+        [[nodiscard]] nlohmann::json column(const std::string &attribute) const;
+        // frames whose value differs from the frame captured before them
+        [[nodiscard]] std::vector<int> changes(const std::string &attribute) const;
+
+        [[nodiscard]] utility::JsonStore summary() const;
+
+      private:
+        struct Column {
+            ColumnType type = {CT_NUMBER};
+            std::vector<double> numbers;
+            std::vector<std::string> strings;
+            std::vector<nlohmann::json> json;
+            // whether each frame has the attribute
+            std::vector<bool> present;
+
+            void resize(const size_t size);
+            void insert(const size_t index);
+            void set(const size_t index, const nlohmann::json &value);
+            [[nodiscard]] nlohmann::json get(const size_t index) const;
+            [[nodiscard]] bool equal(const size_t a, const size_t b) const;
+        };
+
+        size_t row(const int frame);
+
+        std::vector<int> frames_;
+        std::map<std::string, Column> columns_;
+    };
+} // namespace media
+} // namespace xstudio
@@ -3,7 +3,9 @@
 
 #include <caf/all.hpp>
 #include <limits>
+#include <set>
 
+#include "xstudio/media/frame_metadata.hpp"
 #include "xstudio/media/media.hpp"
 #include "xstudio/utility/container.hpp"
 #include "xstudio/utility/json_store.hpp"
@@ -95,6 +97,8 @@ namespace media {
 
         const char *name() const override { return NAME.c_str(); }
 
+        void on_exit() override;
+
       private:
         void update_media_status();
 
@@ -126,6 +130,10 @@ namespace media {
         utility::Uuid parent_uuid_;
         caf::actor event_group_;
         std::vector<caf::typed_response_promise<bool>> pending_stream_detail_requests_;
+        // streams whose cache occupancy has been asked for
+        std::set<utility::Uuid> occupancy_streams_;
+        // header attributes the readers return with decoded frames
+        FrameMetadata frame_metadata_;
     };
 
     class MediaStreamActor : public caf::event_based_actor {
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <map>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "xstudio/media/media.hpp"
+#include "xstudio/utility/occupancy_bitmap.hpp"
+#include "xstudio/utility/uuid.hpp"
+
+namespace xstudio {
+namespace media_cache {
+
+    struct MediaKeyHash {
+        size_t operator()(const media::MediaKey &key) const {
+            const auto sv = to_string_view(key);
+            return std::hash<std::string_view>()(std::string_view(sv.data(), sv.size()));
+        }
+    };
+
+    /**
+     *  @brief Keeps occupancy bitmaps of cached frames up to date as the
+     *  cache changes.
+     *
+     *  @details Each tracked id (a media source stream, a playhead timeline)
+     *  registers the ordered keys of its frames once, after that stores and
+     *  erases only touch the bits of the frames they affect. Bitmaps that
+     *  changed are collected until take_dirty() so they can be broadcast in
+     *  one go.
+     */
+    class CacheOccupancy {
+      public:
+        CacheOccupancy() = default;
+
+        /**
+         *  @brief Track keys under id, replacing any earlier keys for it.
+         *  Bit n of the bitmap is keys[n], empty keys are never set.
+         */
+        const utility::OccupancyBitmap &
+        track(const utility::Uuid &id, const media::MediaKeyVector &keys);
+
+        void untrack(const utility::Uuid &id);
+
+        /**
+         *  @brief Apply a cache change, as reported by the cache change callback
+         */
+        void update(const media::MediaKeyVector &store, const media::MediaKeyVector &erase);
+
+        [[nodiscard]] const utility::OccupancyBitmap *bitmap(const utility::Uuid &id) const;
+
+        /**
+         *  @brief Ids whose bitmaps changed since the last call
+         */
+        std::vector<utility::Uuid> take_dirty();
+
+        [[nodiscard]] size_t tracked() const { return tracks_.size(); }
+        [[nodiscard]] bool cached(const media::MediaKey &key) const {
+            return present_.count(key) != 0;
+        }
+
+      private:
+        struct Track {
+            utility::Uuid id;
+            utility::OccupancyBitmap bitmap;
+            media::MediaKeyVector keys;
+            bool dirty = {false};
+        };
+
+        struct Slot {
+            Track *track;
+            size_t index;
+        };
+
+        void set(const media::MediaKey &key, const bool value);
+
+        std::map<utility::Uuid, Track> tracks_;
+        std::unordered_map<media::MediaKey, std::vector<Slot>, MediaKeyHash> slots_;
+        std::unordered_set<media::MediaKey, MediaKeyHash> present_;
+        std::vector<utility::Uuid> dirty_;
+    };
+
+} // namespace media_cache
+} // namespace xstudio
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace xstudio {
+namespace media_cache {
+
+    namespace fs = std::filesystem;
+
+    /* Second tier frame store on local disk. Entries are a key, a metadata
+    string and a block of (pixel) data, appended to large segment files in
+    the cache directory. Every record starts on a page boundary and its data
+    is page aligned too, so a read maps the data straight out of the segment
+    without copying it through a user space buffer.
+
+    The index lives in memory and is rebuilt from the record headers when
+    the cache is opened, so the cache survives restarts. Records are never
+    modified in place. Erasing or replacing an entry appends a tombstone or
+    the new record, and the space is reclaimed when the segment is
+    compacted.
+
+    An entry can name the file it was made from. The file's modification
+    time and size are recorded with it and checked again on retrieve, so a
+    frame that has been rendered again since isn't served from the cache.
+
+    When the data held goes over max_size the least recently used entries
+    are dropped. Segments that are mostly dead space have their live entries
+    copied forward into the newest segment and are deleted.
+
+    Not thread safe, expected to be owned by a single actor. */
+    class DiskFrameCache {
+      public:
+        struct Entry {
+            std::string metadata;
+            // read only mapping of the data, unmapped when the last copy goes
+            std::shared_ptr<const std::byte> data;
+            size_t size = {0};
+        };
+
+        DiskFrameCache(
+            const fs::path &path,
+            const size_t max_size     = std::numeric_limits<size_t>::max(),
+            const size_t segment_size = size_t(1024) * 1024 * 1024);
+        ~DiskFrameCache();
+
+        DiskFrameCache(const DiskFrameCache &)            = delete;
+        DiskFrameCache &operator=(const DiskFrameCache &) = delete;
+
+        bool store(
+            const std::string &key,
+            const std::string &metadata,
+            const std::byte *data,
+            const size_t size,
+            const fs::path &source = fs::path());
+
+        std::optional<Entry> retrieve(const std::string &key);
+
+        [[nodiscard]] bool contains(const std::string &key) const {
+            return index_.count(key) != 0;
+        }
+
+        [[nodiscard]] std::vector<std::string> keys() const;
+
+        bool erase(const std::string &key);
+        void clear();
+
+        // bytes on disk taken by live entries
+        [[nodiscard]] size_t size() const { return size_; }
+        [[nodiscard]] size_t count() const { return index_.size(); }
+        // bytes of segment files, live or not
+        [[nodiscard]] size_t disk_usage() const;
+        [[nodiscard]] size_t segment_count() const { return segments_.size(); }
+
+        [[nodiscard]] size_t max_size() const { return max_size_; }
+        void set_max_size(const size_t max_size);
+
+        [[nodiscard]] const fs::path &path() const { return path_; }
+
+      private:
+        struct Source {
+            std::string path;
+            int64_t mtime = {0};
+            uint64_t size = {0};
+        };
+
+        struct IndexEntry {
+            uint32_t segment   = {0};
+            uint64_t offset    = {0};
+            uint64_t length    = {0};
+            uint64_t data_at   = {0};
+            uint64_t data_size = {0};
+            uint32_t meta_size = {0};
+            uint64_t last_used = {0};
+            Source source;
+        };
+
+        struct Segment {
+            int fd        = {-1};
+            uint64_t size = {0}; // where the next record goes
+            uint64_t live = {0};
+            fs::path path;
+        };
+
+        void open_segments();
+        void scan_segment(const uint32_t id, Segment &segment);
+        // the newest segment, or a new one if that is full or sealed
+        Segment &writable_segment(
+            const uint64_t length, const std::optional<uint32_t> sealed = std::nullopt);
+        bool append(
+            const std::string &key,
+            const std::string &metadata,
+            const Source &source,
+            const std::byte *data,
+            const uint64_t size,
+            const bool tombstone,
+            const std::optional<uint32_t> sealed = std::nullopt);
+        void drop(const std::string &key);
+        void enforce_budget();
+        void compact(const uint32_t id);
+        void remove_segment(const uint32_t id);
+
+        fs::path path_;
+        size_t max_size_;
+        size_t segment_size_;
+        size_t size_        = {0};
+        uint64_t use_clock_ = {0};
+        int lock_fd_        = {-1};
+
+        std::unordered_map<std::string, IndexEntry> index_;
+        std::map<uint32_t, Segment> segments_;
+    };
+
+} // namespace media_cache
+} // namespace xstudio
@@ -2,10 +2,14 @@
 #pragma once
 
 #include <caf/all.hpp>
+#include <deque>
 #include <memory>
-#include <set>
 #include <string>
+#include <unordered_set>
 
+#include "xstudio/media_cache/cache_occupancy.hpp"
+#include "xstudio/media_cache/disk_frame_cache.hpp"
+#include "xstudio/media_cache/shared_frame_cache.hpp"
 #include "xstudio/media_reader/media_reader.hpp"
 #include "xstudio/utility/time_cache.hpp"
 
@@ -27,11 +31,83 @@ namespace media_cache {
         void
         update_changes(const media::MediaKeyVector &store, const media::MediaKeyVector &erase);
 
+        void update_disk_cache(const utility::JsonStore &prefs);
+        void update_shared_cache(const utility::JsonStore &prefs);
+        void remember_shader(const media_reader::ImageBufPtr &buf);
+        void demote(const media::MediaKey &key, const media_reader::ImageBufPtr &buf);
+        bool restore_shader(media_reader::ImageBufPtr &buf) const;
+        media_reader::ImageBufPtr promote(
+            const media::MediaKey &key,
+            media_reader::ImageBufPtr buf,
+            const utility::time_point &time,
+            const utility::Uuid &uuid);
+        void publish(const media::MediaKey &key, const media_reader::ImageBufPtr &buf);
+        media_reader::ImageBufPtr retrieve_shared(const media::MediaKey &key);
+        // whether another instance has published the frame, without mapping it
+        [[nodiscard]] bool in_shared_cache(const media::MediaKey &key) const;
+        caf::result<media_reader::ImageBufPtr> retrieve_or_promote(
+            const media::MediaKey &key,
+            const utility::time_point &time,
+            const utility::Uuid &uuid = utility::Uuid());
+        caf::result<bool> preserve_or_promote(
+            const media::MediaKey &key,
+            const utility::time_point &time,
+            const utility::Uuid &uuid);
+
         caf::behavior behavior_;
         utility::TimeCache<media::MediaKey, media_reader::ImageBufPtr> cache_;
-        std::set<media::MediaKey> new_keys_;
-        std::set<media::MediaKey> erased_keys_;
+        CacheOccupancy occupancy_;
+        size_t erased_count_ = {0};
         bool update_pending_;
+
+        // second tier, not spawned unless enabled in the preferences
+        caf::actor disk_cache_;
+        std::string disk_cache_path_;
+        size_t demoting_bytes_ = {0};
+        // Keys we have sent to the disk cache, so a miss doesn't have to ask
+        // it. The disk cache also drops entries itself to stay in budget,
+        // those are found on the next retrieve and removed.
+        std::unordered_set<media::MediaKey> on_disk_;
+        // shared with other xstudio processes, not used unless enabled
+        std::unique_ptr<SharedFrameCache> shared_cache_;
+        caf::actor shared_cache_writer_;
+        size_t publishing_bytes_ = {0};
+        // frames read back from disk or shared memory need the shader their
+        // reader attached
+        std::map<
+            utility::Uuid,
+            std::pair<ui::viewport::GPUShaderPtr, media_reader::ImageBuffer::PixelPickerFunc>>
+            shaders_;
+    };
+
+    /* Frames evicted from GlobalImageCacheActor are written to a DiskFrameCache
+    on local storage and read back from there on a miss, rather than being
+    read and decoded from the original media again. */
+    class ImageDiskCacheActor : public caf::event_based_actor {
+      public:
+        ImageDiskCacheActor(
+            caf::actor_config &cfg, const std::string &path, const size_t max_size);
+
+        ~ImageDiskCacheActor() override = default;
+
+        caf::behavior make_behavior() override { return behavior_; }
+
+        const char *name() const override { return NAME.c_str(); }
+
+      private:
+        inline static const std::string NAME = "ImageDiskCacheActor";
+
+        bool store(const media::MediaKey &key, const media_reader::ImageBufPtr &buf);
+
+        struct PendingWrite {
+            media::MediaKey key;
+            media_reader::ImageBufPtr buf;
+            caf::typed_response_promise<bool> rp;
+        };
+
+        caf::behavior behavior_;
+        std::unique_ptr<DiskFrameCache> cache_;
+        std::deque<PendingWrite> writes_;
     };
 
     class GlobalAudioCacheActor : public caf::event_based_actor {
@@ -52,8 +128,7 @@ namespace media_cache {
 
         caf::behavior behavior_;
         utility::TimeCache<media::MediaKey, media_reader::AudioBufPtr> cache_;
-        std::set<media::MediaKey> new_keys_;
-        std::set<media::MediaKey> erased_keys_;
+        CacheOccupancy occupancy_;
         bool update_pending_;
     };
 } // namespace media_cache
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace xstudio {
+namespace media_cache {
+
+    /* Frame store in a named POSIX shared memory arena, so that several
+    xstudio processes on one workstation can use frames that any of them has
+    decoded. Entries are a key, a metadata string and a block of (pixel)
+    data, the same as DiskFrameCache.
+
+    The arena holds a fixed size open addressed hash table of slots followed
+    by the data area. Lookups are lock free. A reader takes a reference on
+    the slot and the data is handed out in place, without copying, until the
+    last copy of the Entry is released. Stores take a process shared (robust)
+    mutex and allocate from the data area as a ring, evicting the oldest
+    entries in the way. Entries that are still referenced are never evicted,
+    the store fails instead.
+
+    The first process to open a given name creates the arena and the size it
+    asks for is used by all the others. Each process registers its pid in the
+    arena and references are recorded per process, so the references of a
+    process that dies are dropped by the next one that needs the slot. The
+    last process to detach unlinks the arena. unlink() is there to clean up
+    after a crash of the last one. A forked child must open its own handle
+    rather than use its parent's. */
+    class SharedFrameCache {
+      public:
+        struct Entry {
+            std::string metadata;
+            // holds a reference on the slot, released with the last copy
+            std::shared_ptr<const std::byte> data;
+            size_t size = {0};
+        };
+
+        SharedFrameCache(const std::string &name, const size_t size);
+        ~SharedFrameCache();
+
+        SharedFrameCache(const SharedFrameCache &)            = delete;
+        SharedFrameCache &operator=(const SharedFrameCache &) = delete;
+
+        bool store(
+            const std::string &key,
+            const std::string &metadata,
+            const std::byte *data,
+            const size_t size);
+
+        std::optional<Entry> retrieve(const std::string &key) const;
+        [[nodiscard]] bool contains(const std::string &key) const;
+
+        bool erase(const std::string &key);
+        // drops every entry that isn't in use, in every process
+        void clear();
+
+        // bytes of the data area used by live entries
+        [[nodiscard]] size_t size() const;
+        [[nodiscard]] size_t count() const;
+        [[nodiscard]] size_t capacity() const;
+
+        [[nodiscard]] const std::string &name() const { return name_; }
+
+        static void unlink(const std::string &name);
+
+      private:
+        struct Arena;
+        struct Slot;
+
+        [[nodiscard]] Slot *find(const std::string &key, const uint64_t hash) const;
+        bool evict(Slot &slot);
+
+        std::string name_;
+        std::shared_ptr<Arena> arena_;
+    };
+
+} // namespace media_cache
+} // namespace xstudio
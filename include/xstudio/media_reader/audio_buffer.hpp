@@ -24,43 +24,44 @@ namespace media_reader {
             num_samples_   = _num_samples;
             sample_format_ = _sample_format;
 
-            size_t samp_size = 1;
-            switch (_sample_format) {
+            Buffer::allocate(num_samples_ * num_channels_ * bytes_per_sample(sample_format_));
+        }
 
+        static size_t bytes_per_sample(const audio::SampleFormat format) {
+            switch (format) {
             case audio::SampleFormat::UINT8:
-                samp_size = 1;
-                break;
+                return 1;
             case audio::SampleFormat::INT16:
-                samp_size = 2;
-                break;
+                return 2;
             case audio::SampleFormat::INT32:
-                samp_size = 4;
-                break;
             case audio::SampleFormat::FLOAT32:
-                samp_size = 4;
-                break;
+                return 4;
             case audio::SampleFormat::INT64:
-                samp_size = 8;
-                break;
             case audio::SampleFormat::DOUBLE64:
-                samp_size = 8;
-                break;
+                return 8;
             default:
-                samp_size = 1;
+                return 1;
             }
+        }
 
-            Buffer::allocate(num_samples_ * num_channels_ * samp_size);
+        // bytes for one sample across all channels
+        [[nodiscard]] size_t frame_size() const {
+            return num_channels_ * bytes_per_sample(sample_format_);
         }
 
         void extend_size(size_t size_extension) { Buffer::resize(size() + size_extension); }
 
         void extend(const AudioBuffer &o) {
-            if (o.sample_format() != sample_format() || o.num_channels() != num_channels()) {
+            if (o.sample_format() != sample_format() || o.num_channels() != num_channels() ||
+                planar() || o.planar()) {
                 throw std::runtime_error(
                     "AudioBuffer::extend mistmatch in audio buffer formats.");
             }
-            extend_size(o.size());
-            memcpy(buffer() + num_samples() * num_channels() * 2, o.buffer(), o.size());
+            extend_size(o.num_samples() * o.frame_size());
+            memcpy(
+                buffer() + num_samples() * frame_size(),
+                o.buffer(),
+                o.num_samples() * o.frame_size());
             num_samples_ += o.num_samples();
         }
 
@@ -72,12 +73,15 @@ namespace media_reader {
             return sample_rate_ ? double(num_samples_) / double(sample_rate_) : 0.0;
         }
         [[nodiscard]] bool reversed() const { return reversed_; }
+        // samples stored channel after channel rather than interleaved
+        [[nodiscard]] bool planar() const { return planar_; }
         [[nodiscard]] std::chrono::microseconds time_delta_to_video_frame() const {
             return time_delta_to_video_frame_;
         }
 
         void set_num_samples(const size_t n) { num_samples_ = n; }
         void set_reversed(const bool r) { reversed_ = r; }
+        void set_planar(const bool p) { planar_ = p; }
         void set_time_delta_to_video_frame(const std::chrono::microseconds d) {
             time_delta_to_video_frame_ = d;
         }
@@ -92,6 +96,7 @@ namespace media_reader {
         audio::SampleFormat sample_format_ = {audio::SampleFormat::UNSET};
         media::MediaKey media_key_;
         bool reversed_                                       = {false};
+        bool planar_                                         = {false};
         std::chrono::microseconds time_delta_to_video_frame_ = {std::chrono::microseconds(0)};
     };
 
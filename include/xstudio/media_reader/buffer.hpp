@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 #pragma once
 
+#include "xstudio/media_reader/enums.hpp"
 #include "xstudio/utility/json_store.hpp"
 #include "xstudio/utility/uuid.hpp"
 #include "xstudio/utility/blind_data.hpp"
@@ -9,6 +10,7 @@
 #include <cstdint>
 #include <iostream>
 #include <malloc.h>
+#include <memory>
 #include <new>
 
 #define UNSET_DTS -1e6
@@ -43,12 +45,11 @@ namespace media_reader {
         [[nodiscard]] const utility::JsonStore &params() const { return params_; }
         utility::JsonStore &params() { return params_; }
         [[nodiscard]] size_t size() const { return size_; }
-        [[nodiscard]] byte *buffer() {
-            return buffer_ ? (byte *)(buffer_->data_.get()) : nullptr;
-        }
-        [[nodiscard]] const byte *buffer() const {
-            return buffer_ ? (const byte *)buffer_->data_.get() : nullptr;
-        }
+        // shared data is read only, asking for it to write to takes a private copy
+        [[nodiscard]] byte *buffer();
+        [[nodiscard]] const byte *buffer() const { return buffer_ ? buffer_->data() : nullptr; }
+        // read access without the copy, for when the buffer isn't const
+        [[nodiscard]] const byte *const_buffer() const { return buffer(); }
         [[nodiscard]] BufferErrorState error_state() const { return error_state_; }
         [[nodiscard]] const std::string &error_message() const { return error_message_; }
         [[nodiscard]] double display_timestamp_seconds() const { return dts_; }
@@ -56,6 +57,14 @@ namespace media_reader {
             return dts_ != UNSET_DTS;
         }
 
+        /* Use read only memory that belongs to something else, such as a slot in
+        a shared memory frame cache, instead of allocating. The owner is held
+        until the buffer is destroyed or reallocated, and the memory isn't
+        recycled. */
+        void
+        set_shared_data(const byte *data, const size_t size, std::shared_ptr<const void> owner);
+        [[nodiscard]] bool has_shared_data() const { return buffer_ and buffer_->owner_; }
+
         void set_display_timestamp_seconds(const double dts) { dts_ = dts; }
         void set_error(const std::string &err) {
             error_message_ = err;
@@ -65,8 +74,15 @@ namespace media_reader {
         struct BufferData {
             BufferData(byte *d) { data_.reset(d); }
             BufferData(size_t sz) { data_.reset(new (std::align_val_t(1024)) byte[sz]); }
+            BufferData(const byte *d, std::shared_ptr<const void> owner)
+                : shared_(d), owner_(std::move(owner)) {}
+
+            [[nodiscard]] const byte *data() const { return owner_ ? shared_ : data_.get(); }
+
             std::unique_ptr<byte> data_{
                 nullptr}; // using long long which should get result byte alignment
+            const byte *shared_ = {nullptr};
+            std::shared_ptr<const void> owner_;
         };
         typedef std::shared_ptr<BufferData> BufferDataPtr;
 
@@ -2,6 +2,8 @@
 #pragma once
 
 #include <caf/all.hpp>
+#include <deque>
+#include <functional>
 
 #include "xstudio/media/media.hpp"
 #include "xstudio/media_reader/media_reader.hpp"
@@ -17,11 +19,13 @@ namespace media_reader {
             caf::actor_config &cfg,
             const utility::Uuid &plugin_uuid,
             caf::actor image_cache = caf::actor(),
-            caf::actor audio_cache = caf::actor());
+            caf::actor audio_cache = caf::actor(),
+            caf::actor worker_pool = caf::actor());
         ~CachingMediaReaderActor() override = default;
 
         caf::behavior make_behavior() override { return behavior_; }
 
+        void on_exit() override;
         const char *name() const override { return NAME.c_str(); }
 
       private:
@@ -43,7 +47,30 @@ namespace media_reader {
             utility::time_point time_point_;
         };
 
+        struct PrecacheImageRequest {
+            media::AVFrameID mptr_;
+            caf::typed_response_promise<ImageBufPtr> rp_;
+        };
+
+        // A reader plugin instance, spawned the first time it's needed. Tasks
+        // that arrive while it's being spawned wait for it, and are given a
+        // null actor if it couldn't be.
+        using WorkerTask = std::function<void(caf::actor)>;
+        struct LazyWorker {
+            caf::actor actor_;
+            bool spawning_ = {false};
+            std::vector<WorkerTask> waiting_;
+        };
+
+        void with_worker(LazyWorker &worker, WorkerTask task);
+        void add_decode_worker(caf::actor worker);
         void do_urgent_get_image();
+        void update_pipeline_preferences(const utility::JsonStore &prefs);
+        void start_precache_reads();
+        void start_precache_decodes();
+        void decode_precache_image(caf::actor worker, const PrecacheImageRequest &request);
+        void decode_finished(caf::actor worker);
+        void reap_idle_decode_workers();
         void receive_image_buffer_request(
             const media::AVFrameID &mptr,
             caf::actor playhead,
@@ -58,12 +85,37 @@ namespace media_reader {
         // bool sequential_access_;
         caf::actor image_cache_;
         caf::actor audio_cache_;
+        caf::actor worker_pool_;
 
         bool urgent_worker_busy_ = {false};
 
-        caf::actor urgent_worker_;
-        caf::actor precache_worker_;
-        caf::actor audio_worker_;
+        LazyWorker urgent_worker_;
+        LazyWorker precache_worker_;
+        LazyWorker audio_worker_;
+
+        // Readers that can decode from memory precache through a two stage
+        // pipeline. FilePrefetcher reads the files, pausing while more than
+        // pipeline_max_bytes_ are waiting to be decoded, and a pool of up to
+        // decode_workers_max_ plugin actors decodes them. Workers past the
+        // precache worker count against a limit shared by every source, and
+        // exit once the pipeline has been idle for a while.
+        utility::Uuid plugin_uuid_;
+        utility::JsonStore prefs_;
+        bool plugin_decodes_from_memory_ = {false};
+        bool pipeline_enabled_           = {false};
+        size_t decode_workers_max_       = {1};
+        size_t pipeline_max_bytes_       = {0};
+        bool spawning_worker_            = {false};
+        uint64_t next_read_id_           = {0};
+        size_t extra_decode_workers_     = {0};
+        bool reap_scheduled_             = {false};
+        utility::time_point last_decode_;
+
+        std::deque<PrecacheImageRequest> read_queue_;
+        std::map<uint64_t, PrecacheImageRequest> reading_;
+        std::deque<PrecacheImageRequest> decode_queue_;
+        std::vector<caf::actor> decode_workers_;
+        std::vector<caf::actor> idle_decode_workers_;
     };
 } // namespace media_reader
 } // namespace xstudio
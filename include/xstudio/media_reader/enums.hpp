@@ -5,6 +5,15 @@ namespace xstudio {
 namespace media_reader {
     typedef enum { MRC_NO = 0, MRC_MAYBE, MRC_YES, MRC_FULLY, MRC_FORCE } MRCertainty;
     typedef enum { NO_ERROR = 0, HAS_ERROR } BufferErrorState;
+    typedef enum {
+        PDT_UNKNOWN = 0,
+        PDT_UINT8,
+        PDT_UINT16,
+        PDT_UINT32,
+        PDT_HALF,
+        PDT_FLOAT32
+    } PixelDataType;
+    typedef enum { BEM_INLINE = 0, BEM_SHARED_MEMORY, BEM_IN_PROCESS } BufferExportMode;
 
 } // namespace media_reader
 } // namespace xstudio
\ No newline at end of file
@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xstudio {
+namespace media_reader {
+
+    /* Reads whole files into memory on a pool of threads ahead of when a
+    reader plugin wants them, so the plugin decodes from memory instead of
+    waiting on the filesystem.
+
+    GlobalMediaReaderActor asks for the files behind the next frames in its
+    precache queue with prefetch(). A reader plugin that can decode from
+    memory calls take() for the file it's about to read. If the file is
+    still being read take() waits for it rather than starting a second
+    read, if it was never asked for take() returns nothing and the plugin
+    reads the file itself.
+
+    A CachingMediaReaderActor uses it as the I/O stage of its precache
+    pipeline, passing a callback that tells it when a file is in memory and
+    can be handed to a decoder.
+
+    Buffers are page aligned, and files can be read with O_DIRECT. Without
+    O_DIRECT the pages are dropped from the page cache after reading since
+    the decoded frames are cached by xstudio anyway. Files that are never
+    taken are discarded oldest first when the buffers go over max_bytes. */
+    class FilePrefetcher {
+      public:
+        struct File {
+            std::shared_ptr<const std::byte> data;
+            size_t size = {0};
+        };
+
+        // how a file is read, the default is read_file
+        using ReadFunc = std::function<std::optional<File>(const std::string &, bool)>;
+        // called once the file has been read, failed to read or been dropped
+        // from the queue. It runs on a reading thread, or the calling thread
+        // if the file was already read.
+        using Callback = std::function<void()>;
+
+        FilePrefetcher(
+            const size_t threads   = 4,
+            const size_t max_bytes = size_t(512) * 1024 * 1024,
+            ReadFunc read          = ReadFunc());
+        ~FilePrefetcher();
+
+        FilePrefetcher(const FilePrefetcher &)            = delete;
+        FilePrefetcher &operator=(const FilePrefetcher &) = delete;
+
+        // queue a read, unless the file is already read or queued
+        void prefetch(const std::string &path);
+        void prefetch(const std::string &path, Callback on_read);
+        std::optional<File> take(const std::string &path);
+        // forget everything that isn't being read right now
+        void clear();
+
+        void set_max_bytes(const size_t max_bytes);
+        void set_direct_io(const bool direct_io);
+        [[nodiscard]] size_t bytes() const;
+        [[nodiscard]] bool pending(const std::string &path) const;
+
+        static std::optional<File> read_file(const std::string &path, const bool direct_io);
+
+        // the instance shared by the reader actors and plugins
+        static FilePrefetcher &global();
+
+      private:
+        void run();
+        void enforce_budget();
+        std::vector<Callback> release(const std::string &path);
+
+        ReadFunc read_;
+        size_t max_bytes_;
+        bool direct_io_ = {false};
+        bool stop_      = {false};
+
+        mutable std::mutex mutex_;
+        std::condition_variable work_cv_;
+        std::condition_variable done_cv_;
+        std::deque<std::string> queue_;
+        std::set<std::string> pending_;
+        std::map<std::string, File> ready_;
+        std::list<std::string> ready_order_;
+        std::multimap<std::string, Callback> callbacks_;
+        size_t ready_bytes_ = {0};
+
+        std::vector<std::thread> threads_;
+    };
+
+} // namespace media_reader
+} // namespace xstudio
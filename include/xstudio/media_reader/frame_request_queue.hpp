@@ -10,6 +10,7 @@
 #include "xstudio/utility/uuid.hpp"
 
 #include <map>
+#include <set>
 #include <vector>
 
 namespace xstudio {
@@ -83,11 +84,22 @@ namespace media_reader {
         void prune_stale_frame_requests();
 
         /**
-         *   @brief Get the next ordered frame request
+         *   @brief Get the next ordered frame request, skipping playheads that
+         *   already have a request being read. Requests for pipelined_readers
+         *   can go ahead until the playhead has max_in_flight being read.
          *
          */
-        std::optional<FrameRequest>
-        pop_request(const std::map<utility::Uuid, int> &exclude_playheads);
+        std::optional<FrameRequest> pop_request(
+            const std::map<utility::Uuid, int> &in_flight,
+            const int max_in_flight                        = 1,
+            const std::set<std::string> &pipelined_readers = std::set<std::string>());
+
+        /**
+         *   @brief The frames that will be requested next, in order, without
+         *   taking them out of the queue
+         */
+        std::vector<std::shared_ptr<const media::AVFrameID>>
+        upcoming_frames(const size_t count) const;
 
         /**
          *   @brief Add a request to the queue
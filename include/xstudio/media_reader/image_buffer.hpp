@@ -5,8 +5,10 @@
 #include "xstudio/media_reader/buffer.hpp"
 #include "xstudio/media_reader/audio_buffer.hpp"
 #include "xstudio/media_reader/pixel_info.hpp"
+#include "xstudio/media_reader/pixel_layout.hpp"
 #include "xstudio/ui/viewport/shader.hpp"
 #include "xstudio/colour_pipeline/colour_pipeline.hpp"
+#include "xstudio/utility/shader_uniforms.hpp"
 
 namespace xstudio {
 namespace media_reader {
@@ -31,9 +33,18 @@ namespace media_reader {
         void set_shader(const ui::viewport::GPUShaderPtr &shader) { shader_ = shader; }
         [[nodiscard]] ui::viewport::GPUShaderPtr shader() const { return shader_; }
 
+        [[nodiscard]] const utility::Uuid &shader_id() const { return shader_id_; }
+
         void set_shader_params(const utility::JsonStore &params) { shader_params_ = params; }
         [[nodiscard]] const utility::JsonStore &shader_params() const { return shader_params_; }
 
+        // typed shader parameters, applied without going through json
+        void set_shader_uniforms(const utility::ShaderUniforms &u) { shader_uniforms_ = u; }
+        [[nodiscard]] utility::ShaderUniforms &shader_uniforms() { return shader_uniforms_; }
+        [[nodiscard]] const utility::ShaderUniforms &shader_uniforms() const {
+            return shader_uniforms_;
+        }
+
         [[nodiscard]] Imath::V2i image_size_in_pixels() const { return image_size_in_pixels_; }
         [[nodiscard]] Imath::Box2i image_pixels_bounding_box() const { return pixels_bounds_; }
         void set_image_dimensions(
@@ -61,10 +72,22 @@ namespace media_reader {
         [[nodiscard]] bool has_alpha() const { return has_alpha_; }
         void set_has_alpha(const bool b) { has_alpha_ = b; }
 
+        // optional description of the raw pixel data, filled in by readers
+        [[nodiscard]] const PixelLayout &pixel_layout() const { return pixel_layout_; }
+        void set_pixel_layout(const PixelLayout &layout) { pixel_layout_ = layout; }
+
+        // header attributes the reader parsed to decode the frame, as an object
+        // of attribute name to value. Empty unless the reader keeps them.
+        [[nodiscard]] const utility::JsonStore &frame_metadata() const {
+            return frame_metadata_;
+        }
+        void set_frame_metadata(const utility::JsonStore &m) { frame_metadata_ = m; }
+
         typedef std::function<PixelInfo(
             const ImageBuffer &buf, const Imath::V2i &pixel_location)>
             PixelPickerFunc;
         void set_pixel_picker_func(PixelPickerFunc func) { pixel_picker_ = func; }
+        [[nodiscard]] const PixelPickerFunc &pixel_picker_func() const { return pixel_picker_; }
 
         PixelInfo pixel_info(const Imath::V2i &pixel_location) const {
             if (pixel_picker_)
@@ -77,6 +100,7 @@ namespace media_reader {
       private:
         utility::Uuid shader_id_;
         utility::JsonStore shader_params_;
+        utility::ShaderUniforms shader_uniforms_;
         Imath::V2i image_size_in_pixels_;
         Imath::Box2i pixels_bounds_;
         float pixel_aspect_ = {1.0f};
@@ -85,6 +109,8 @@ namespace media_reader {
         int frame_num_         = -1;
         ui::viewport::GPUShaderPtr shader_;
         PixelPickerFunc pixel_picker_;
+        PixelLayout pixel_layout_;
+        utility::JsonStore frame_metadata_;
         bool has_alpha_ = false;
     };
 
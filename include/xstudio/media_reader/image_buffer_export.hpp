@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "xstudio/media/media.hpp"
+#include "xstudio/media_reader/image_buffer.hpp"
+#include "xstudio/media_reader/pixel_layout.hpp"
+#include "xstudio/utility/shared_memory.hpp"
+
+namespace xstudio {
+namespace media_reader {
+
+    /* A decoded image packaged for consumers outside of the playback engine
+    (chiefly the python API). The pixel data is delivered in one of three
+    ways, see BufferExportMode:
+
+    BEM_IN_PROCESS - the export keeps a reference to the cached ImageBufPtr
+    and data() points straight at its BufferData. Only valid when the
+    message never leaves the process (embedded python / connect_local).
+
+    BEM_SHARED_MEMORY - the pixels are copied once into a named POSIX shared
+    memory segment, only the segment name travels over the wire. The
+    receiver maps the segment on first access and unlinks the name.
+
+    BEM_INLINE - the pixels are serialised with the message. Works for any
+    remote client but costs a copy through the network stack. */
+    class ImageBufferExport {
+      public:
+        ImageBufferExport() = default;
+        explicit ImageBufferExport(
+            const ImageBufPtr &buf, const BufferExportMode mode = BEM_INLINE);
+
+        [[nodiscard]] const media::MediaKey &key() const { return key_; }
+        [[nodiscard]] const PixelLayout &planes() const { return planes_; }
+        [[nodiscard]] const std::vector<std::string> &channel_names() const {
+            return channel_names_;
+        }
+        [[nodiscard]] int width() const { return width_; }
+        [[nodiscard]] int height() const { return height_; }
+        [[nodiscard]] float pixel_aspect() const { return pixel_aspect_; }
+        [[nodiscard]] BufferExportMode mode() const { return mode_; }
+        [[nodiscard]] const std::string &error() const { return error_; }
+        [[nodiscard]] bool has_error() const { return not error_.empty(); }
+        [[nodiscard]] const std::string &shared_memory_name() const { return shm_name_; }
+
+        // raw pixel bytes, maps shared memory on first call if required.
+        [[nodiscard]] const std::byte *data() const {
+            switch (mode_) {
+            case BEM_IN_PROCESS:
+                return source_ ? reinterpret_cast<const std::byte *>(source_->const_buffer())
+                               : nullptr;
+            case BEM_SHARED_MEMORY:
+                if (not segment_ and not shm_name_.empty()) {
+                    segment_ = utility::SharedMemorySegment::open(shm_name_, true, size_);
+                    // we are the only reader, so the name can go now. The
+                    // memory is released when our mapping is dropped.
+                    segment_->unlink();
+                }
+                return segment_ ? segment_->data() : nullptr;
+            default:
+                return payload_.data();
+            }
+        }
+        [[nodiscard]] size_t size() const { return size_; }
+
+        void set_error(const std::string &error) { error_ = error; }
+        void set_key(const media::MediaKey &key) { key_ = key; }
+
+        template <class Inspector> friend bool inspect(Inspector &f, ImageBufferExport &x) {
+            return f.object(x).fields(
+                f.field("key", x.key_),
+                f.field("w", x.width_),
+                f.field("h", x.height_),
+                f.field("pa", x.pixel_aspect_),
+                f.field("pl", x.planes_),
+                f.field("cn", x.channel_names_),
+                f.field("m", x.mode_),
+                f.field("e", x.error_),
+                f.field("sz", x.size_),
+                f.field("shm", x.shm_name_),
+                f.field("d", x.payload_));
+        }
+
+      private:
+        media::MediaKey key_;
+        int width_{0};
+        int height_{0};
+        float pixel_aspect_{1.0f};
+        PixelLayout planes_;
+        std::vector<std::string> channel_names_;
+        BufferExportMode mode_{BEM_INLINE};
+        std::string error_;
+        size_t size_{0};
+        std::string shm_name_;
+        std::vector<std::byte> payload_;
+
+        // not serialised, keeps the source pixels or the mapping alive.
+        ImageBufPtr source_;
+        mutable utility::SharedMemorySegmentPtr segment_;
+    };
+
+} // namespace media_reader
+} // namespace xstudio
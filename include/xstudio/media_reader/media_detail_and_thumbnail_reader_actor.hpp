@@ -42,7 +42,9 @@ namespace media_reader {
             caf::actor &,
             const media::AVFrameID,
             const size_t,
-            caf::typed_response_promise<thumbnail::ThumbnailBufferPtr>);
+            caf::typed_response_promise<thumbnail::ThumbnailBufferPtr>,
+            const size_t filmstrip_count = 0,
+            const bool rgb24             = false);
         void continue_processing_queue();
 
       private:
@@ -68,12 +70,21 @@ namespace media_reader {
             ThumbnailRequest(
                 const media::AVFrameID media_pointer,
                 const size_t size,
-                caf::typed_response_promise<thumbnail::ThumbnailBufferPtr> rp)
-                : media_pointer_(std::move(media_pointer)), size_(size), rp_(std::move(rp)) {}
+                caf::typed_response_promise<thumbnail::ThumbnailBufferPtr> rp,
+                const size_t filmstrip_count = 0,
+                const bool rgb24             = false)
+                : media_pointer_(std::move(media_pointer)),
+                  size_(size),
+                  rp_(std::move(rp)),
+                  filmstrip_count_(filmstrip_count),
+                  rgb24_(rgb24) {}
 
             media::AVFrameID media_pointer_;
             size_t size_;
             caf::typed_response_promise<thumbnail::ThumbnailBufferPtr> rp_;
+            // non zero for a filmstrip of this many thumbnails
+            size_t filmstrip_count_ = {0};
+            bool rgb24_             = {false};
         };
 
       private:
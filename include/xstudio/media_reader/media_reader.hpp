@@ -1,7 +1,6 @@
 // SPDX-License-Identifier: Apache-2.0
 // reader needs to be very smart..
 // handle contention on devices.
-// separate IO from decompression?
 // handle reverse movie reading ?
 // handle audio streams
 // handle eager readahead
@@ -30,6 +29,7 @@
 #include "xstudio/media/caf_media_error.hpp"
 #include "xstudio/media/media_error.hpp"
 #include "xstudio/media_reader/audio_buffer.hpp"
+#include "xstudio/media_reader/file_prefetcher.hpp"
 #include "xstudio/media_reader/frame_request_queue.hpp"
 #include "xstudio/media_reader/image_buffer.hpp"
 #include "xstudio/media_reader/pixel_info.hpp"
@@ -57,6 +57,13 @@ namespace media_reader {
 
         virtual ImageBufPtr image(const media::AVFrameID &mptr);
 
+        // Readers that can decode a frame from its file already read into
+        // memory override both of these. Their precache reads are split into an
+        // I/O stage and a decode stage on a pool of workers.
+        virtual ImageBufPtr
+        decode_image(const media::AVFrameID &mptr, const FilePrefetcher::File &file);
+        [[nodiscard]] virtual bool can_decode_from_memory() const;
+
         virtual ImageBufPtr partial_image(
             const media::AVFrameID &mptr,
             ImageBufPtr &current_loaded,
@@ -69,6 +76,14 @@ namespace media_reader {
 
         virtual std::shared_ptr<thumbnail::ThumbnailBuffer>
         thumbnail(const media::AVFrameID &mptr, const size_t thumb_size);
+        // count evenly spaced thumbnails of the whole source side by side in
+        // one buffer, with "filmstrip" metadata giving the frame of each. rgb24
+        // asks for display ready 8 bit RGB where the reader can make it.
+        virtual std::shared_ptr<thumbnail::ThumbnailBuffer> filmstrip(
+            const media::AVFrameID &mptr,
+            const size_t count,
+            const size_t thumb_size,
+            const bool rgb24);
         [[nodiscard]] virtual media::MediaDetail detail(const caf::uri &uri) const;
         [[nodiscard]] virtual uint8_t maximum_readers(const caf::uri &uri) const;
         [[nodiscard]] virtual bool prefer_sequential_access(const caf::uri &uri) const;
@@ -144,11 +159,21 @@ namespace media_reader {
                     return mb;
                 },
 
+                [=](decode_from_memory_atom) -> bool {
+                    return media_reader_.can_decode_from_memory();
+                },
+
                 [=](get_image_atom, const media::AVFrameID &mptr) -> result<ImageBufPtr> {
                     ImageBufPtr mb;
                     try {
                         std::string path = utility::uri_to_posix_path(mptr.uri_);
-                        mb               = media_reader_.image(mptr);
+                        // the file may have been read already, by the precache
+                        // pipeline or by read ahead
+                        std::optional<FilePrefetcher::File> file;
+                        if (media_reader_.can_decode_from_memory())
+                            file = FilePrefetcher::global().take(path);
+                        mb = file ? media_reader_.decode_image(mptr, *file)
+                                  : media_reader_.image(mptr);
                         if (mb) {
                             mb->set_media_key(mptr.key_);
                             mb->set_pixel_picker_func(media_reader_.pixel_picker_func());
@@ -158,6 +183,15 @@ namespace media_reader {
                             mb->params()["path"]   = path;
                             mb->params()["frame"]  = mptr.frame_;
                             mb->params()["reader"] = media_reader_.name();
+
+                            // the source keeps the attributes, so they needn't be
+                            // read from the file again
+                            if (mptr.actor_addr_ and not mb->frame_metadata().empty())
+                                anon_send(
+                                    caf::actor_cast<caf::actor>(mptr.actor_addr_),
+                                    media_metadata::frame_metadata_atom_v,
+                                    mptr.frame_,
+                                    mb->frame_metadata());
                         }
                     } catch (const media_missing_error &e) {
                         return make_error(media::media_error::missing, e.what());
@@ -211,6 +245,27 @@ namespace media_reader {
                     return thumbnail::ThumbnailBufferPtr();
                 },
 
+                [=](media_reader::get_filmstrip_atom,
+                    const media::AVFrameID &mptr,
+                    const size_t count,
+                    const size_t thumb_size,
+                    const bool rgb24) -> result<thumbnail::ThumbnailBufferPtr> {
+                    try {
+                        return media_reader_.filmstrip(mptr, count, thumb_size, rgb24);
+                    } catch (const media_missing_error &e) {
+                        return make_error(media::media_error::missing, e.what());
+                    } catch (const media_corrupt_error &e) {
+                        return make_error(media::media_error::corrupt, e.what());
+                    } catch (const media_unsupported_error &e) {
+                        return make_error(media::media_error::unsupported, e.what());
+                    } catch (const media_unreadable_error &e) {
+                        return make_error(media::media_error::unreadable, e.what());
+                    } catch (const std::exception &e) {
+                        return make_error(xstudio_error::error, e.what());
+                    }
+                    return thumbnail::ThumbnailBufferPtr();
+                },
+
                 [=](media_reader::supported_atom,
                     const caf::uri &_uri,
                     const std::array<uint8_t, 16> &signature)
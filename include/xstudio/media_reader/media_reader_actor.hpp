@@ -2,9 +2,11 @@
 #pragma once
 
 #include <caf/all.hpp>
+#include <set>
 
 #include "xstudio/media/media.hpp"
 #include "xstudio/media_reader/media_reader.hpp"
+#include "xstudio/media_reader/precache_scheduler.hpp"
 #include "xstudio/utility/chrono.hpp"
 #include "xstudio/utility/uuid.hpp"
 
@@ -43,6 +45,8 @@ namespace media_reader {
         caf::actor get_reader(
             const caf::uri &_uri, const caf::actor_addr &_key, const std::string &hint = "");
         void do_precache();
+        void update_prefetch_preferences(const utility::JsonStore &prefs);
+        void prefetch_upcoming_files(const media::AVFrameID &current);
 
         void keep_cache_hot(
             const media::MediaKey &new_entry,
@@ -63,6 +67,8 @@ namespace media_reader {
 
         void continue_precacheing();
 
+        void clear_background_precache_requests(const utility::Uuid &playhead_uuid);
+
         void mark_playhead_waiting_for_precache_result(const utility::Uuid &playhead_uuid);
 
         void mark_playhead_received_precache_result(const utility::Uuid &playhead_uuid);
@@ -71,8 +77,14 @@ namespace media_reader {
 
         void process_get_media_detail_queue();
 
+        void release_exported_shared_memory(const bool all = false);
+
+        struct PixelStatisticsRange;
+        void request_pixel_statistics(const std::shared_ptr<PixelStatisticsRange> &range);
+
       private:
         caf::actor pool_;
+        caf::actor worker_pool_;
         caf::actor image_cache_;
         caf::actor audio_cache_;
         caf::behavior behavior_;
@@ -84,6 +96,10 @@ namespace media_reader {
         std::map<utility::Uuid, utility::time_point> background_cached_ref_timepoint_;
 
         std::map<utility::Uuid, int> playheads_with_precache_requests_in_flight_;
+        int precache_in_flight_max_ = {1};
+        // readers that can decode from memory, which precache through the
+        // decode pipeline and so may have more than one frame in flight
+        std::set<std::string> pipeline_readers_;
 
         std::vector<caf::actor> plugins_;
         std::map<std::string, utility::Uuid> plugins_map_;
@@ -93,6 +109,15 @@ namespace media_reader {
 
         FrameRequestQueue playback_precache_request_queue_;
         FrameRequestQueue background_precache_request_queue_;
+        PrecacheScheduler scheduler_;
+        size_t image_cache_max_size_ = {0};
+
+        // files for the next frames in the queues are read ahead, for readers
+        // that can decode from memory
+        size_t prefetch_read_ahead_ = {0};
+        std::set<std::string> prefetch_readers_;
+
+        std::map<std::string, utility::time_point> exported_shared_memory_;
     };
 
 } // namespace media_reader
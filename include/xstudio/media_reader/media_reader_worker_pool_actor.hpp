@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <caf/all.hpp>
+#include <map>
+#include <vector>
+
+#include "xstudio/utility/json_store.hpp"
+#include "xstudio/utility/uuid.hpp"
+
+// Creating a reader plugin instance means building the plugin's reader and
+// fetching the preferences, which is slow enough to hold up the first frame
+// of a newly opened source. Once a reader plugin has been asked for, this
+// actor keeps a few instances of it ready and hands them out in answer to the
+// same spawn_plugin_atom request the plugin manager takes, starting
+// replacements in the background. Plugins that are never used cost nothing.
+
+namespace xstudio {
+namespace media_reader {
+
+    class MediaReaderWorkerPoolActor : public caf::event_based_actor {
+      public:
+        MediaReaderWorkerPoolActor(caf::actor_config &cfg);
+        ~MediaReaderWorkerPoolActor() override = default;
+
+        caf::behavior make_behavior() override { return behavior_; }
+
+        const char *name() const override { return NAME.c_str(); }
+
+      private:
+        inline static const std::string NAME = "MediaReaderWorkerPoolActor";
+
+        void top_up(const utility::Uuid &plugin_uuid);
+        void update_preferences(const utility::JsonStore &prefs);
+
+        caf::behavior behavior_;
+        caf::actor plugin_manager_;
+        utility::JsonStore prefs_;
+        size_t spare_workers_ = {2};
+
+        std::map<utility::Uuid, std::vector<caf::actor>> spares_;
+        std::map<utility::Uuid, size_t> spawning_;
+    };
+} // namespace media_reader
+} // namespace xstudio
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "xstudio/media_reader/enums.hpp"
+
+namespace xstudio {
+namespace media_reader {
+
+    inline size_t pixel_data_type_size(const PixelDataType t) {
+        switch (t) {
+        case PDT_UINT8:
+            return 1;
+        case PDT_UINT16:
+        case PDT_HALF:
+            return 2;
+        case PDT_UINT32:
+        case PDT_FLOAT32:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    // format character as used by the python buffer protocol / struct module
+    inline std::string pixel_data_type_format(const PixelDataType t) {
+        switch (t) {
+        case PDT_UINT8:
+            return "B";
+        case PDT_UINT16:
+            return "H";
+        case PDT_UINT32:
+            return "I";
+        case PDT_HALF:
+            return "e";
+        case PDT_FLOAT32:
+            return "f";
+        default:
+            return "B";
+        }
+    }
+
+    /* Describes where one plane of pixel data lives inside an image buffer.
+    Interleaved images (EXR, PPM, RGB movie frames) are a single plane,
+    planar YUV frames have one plane per component. This is purely
+    descriptive - the shader attached to the buffer remains the authority on
+    how pixels are drawn - but it lets code outside the reader plugin (python
+    export, pixel statistics) walk the raw data without parsing shader
+    parameters. */
+    struct PixelPlane {
+        PixelPlane() = default;
+        PixelPlane(
+            std::string name,
+            const PixelDataType data_type,
+            const size_t width,
+            const size_t height,
+            const size_t channels,
+            const size_t byte_offset  = 0,
+            const size_t pixel_stride = 0,
+            const size_t row_stride   = 0)
+            : name_(std::move(name)),
+              data_type_(data_type),
+              width_(width),
+              height_(height),
+              channels_(channels),
+              byte_offset_(byte_offset),
+              pixel_stride_(
+                  pixel_stride ? pixel_stride : channels * pixel_data_type_size(data_type)),
+              row_stride_(row_stride ? row_stride : width * pixel_stride_) {}
+
+        [[nodiscard]] size_t item_size() const { return pixel_data_type_size(data_type_); }
+        [[nodiscard]] size_t byte_size() const { return row_stride_ * height_; }
+
+        bool operator==(const PixelPlane &o) const {
+            return name_ == o.name_ && data_type_ == o.data_type_ && width_ == o.width_ &&
+                   height_ == o.height_ && channels_ == o.channels_ &&
+                   byte_offset_ == o.byte_offset_ && pixel_stride_ == o.pixel_stride_ &&
+                   row_stride_ == o.row_stride_;
+        }
+
+        template <class Inspector> friend bool inspect(Inspector &f, PixelPlane &x) {
+            return f.object(x).fields(
+                f.field("name", x.name_),
+                f.field("type", x.data_type_),
+                f.field("w", x.width_),
+                f.field("h", x.height_),
+                f.field("c", x.channels_),
+                f.field("off", x.byte_offset_),
+                f.field("ps", x.pixel_stride_),
+                f.field("rs", x.row_stride_));
+        }
+
+        std::string name_;
+        PixelDataType data_type_{PDT_UNKNOWN};
+        size_t width_{0};
+        size_t height_{0};
+        size_t channels_{0};
+        size_t byte_offset_{0};
+        size_t pixel_stride_{0};
+        size_t row_stride_{0};
+    };
+
+    typedef std::vector<PixelPlane> PixelLayout;
+
+} // namespace media_reader
+} // namespace xstudio
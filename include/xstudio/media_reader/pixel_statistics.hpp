@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "xstudio/media_reader/buffer.hpp"
+#include "xstudio/media_reader/pixel_layout.hpp"
+#include "xstudio/utility/json_store.hpp"
+
+namespace xstudio {
+namespace media_reader {
+
+    class ImageBuffer;
+
+    struct PixelStatisticsOptions {
+        PixelStatisticsOptions() = default;
+        PixelStatisticsOptions(const utility::JsonStore &jsn);
+
+        [[nodiscard]] utility::JsonStore serialise() const;
+
+        size_t histogram_bins = {256};
+        // values outside the range are counted in the end bins
+        float histogram_min = {0.0f};
+        float histogram_max = {1.0f};
+        // columns of the luma waveform across the image, none if zero
+        size_t waveform_columns = {0};
+        size_t waveform_bins    = {128};
+        // sample every step'th pixel of every step'th row
+        size_t step = {1};
+        // zero uses a thread per core
+        size_t threads = {0};
+    };
+
+    struct ChannelStatistics {
+        [[nodiscard]] double mean() const { return count_ ? sum_ / double(count_) : 0.0; }
+        void merge(const ChannelStatistics &o);
+
+        std::string name_;
+        // over the finite values only
+        double min_       = {std::numeric_limits<double>::max()};
+        double max_       = {std::numeric_limits<double>::lowest()};
+        double sum_       = {0.0};
+        size_t count_     = {0};
+        size_t nan_count_ = {0};
+        size_t inf_count_ = {0};
+        std::vector<uint64_t> histogram_;
+    };
+
+    /**
+     *  @brief Histograms, min/max/mean, NaN/Inf counts and a luma waveform of
+     *  decoded pixels, computed on the CPU.
+     *
+     *  @details The pixels are walked using the buffer's PixelLayout, so any
+     *  reader that describes its planes is supported: half and float EXRs,
+     *  8 and 16 bit RGB(A) and packed or planar YUV from FFmpeg. Integer
+     *  values are normalised to 0-1 by the range of their type, so 10 and 12
+     *  bit video held in 16 bits reads low. Rows are split across threads.
+     *
+     *  Luma is the "y" plane where there is one, Rec.709 luminance of the
+     *  first three channels of an interleaved plane, or else the first
+     *  channel. Statistics of several frames are merged for a sequence.
+     */
+    class PixelStatistics {
+      public:
+        PixelStatistics(const PixelStatisticsOptions &options = PixelStatisticsOptions());
+        PixelStatistics(const utility::JsonStore &jsn);
+        virtual ~PixelStatistics() = default;
+
+        static PixelStatistics
+        compute(const ImageBuffer &buf, const PixelStatisticsOptions &options);
+
+        // channel_names name the channels of a single plane layout, the plane
+        // names are used otherwise
+        static PixelStatistics compute(
+            const byte *data,
+            const size_t size,
+            const PixelLayout &layout,
+            const std::vector<std::string> &channel_names,
+            const PixelStatisticsOptions &options);
+
+        // add the statistics of another frame, channels are matched by name
+        void merge(const PixelStatistics &o);
+
+        [[nodiscard]] const PixelStatisticsOptions &options() const { return options_; }
+        [[nodiscard]] const std::vector<ChannelStatistics> &channels() const {
+            return channels_;
+        }
+        // waveform_columns x waveform_bins counts, a column at a time
+        [[nodiscard]] const std::vector<uint64_t> &waveform() const { return waveform_; }
+        [[nodiscard]] size_t frames() const { return frames_; }
+
+        [[nodiscard]] utility::JsonStore serialise() const;
+
+      private:
+        PixelStatisticsOptions options_;
+        std::vector<ChannelStatistics> channels_;
+        std::vector<uint64_t> waveform_;
+        size_t frames_ = {0};
+    };
+
+} // namespace media_reader
+} // namespace xstudio
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "xstudio/utility/uuid.hpp"
+
+namespace xstudio {
+namespace media_reader {
+
+    /**
+     *  @brief Where a playhead is and where the user has been, in timeline
+     *  (logical) frames.
+     */
+    struct PrecacheHints {
+        int current_frame = {0};
+        int num_frames    = {0};
+        int loop_in       = {0};
+        int loop_out      = {-1}; // inclusive, negative means the last frame
+        bool forwards     = {true};
+        // inclusive frame ranges
+        std::vector<std::pair<int, int>> bookmarks;
+        // positions the playhead was parked on or scrubbed over, most recent last
+        std::vector<int> recent_frames;
+    };
+
+    /**
+     *  @brief Decides what background cacheing should read next and how long
+     *  it will take.
+     *
+     *  @details prioritise() orders timeline frames by how likely they are to
+     *  be needed soon. The frames the next play from the current position will
+     *  show come first, in the order it shows them, because a contiguous run
+     *  from the playhead is what makes that play drop-free. After them come
+     *  the frames just behind the playhead, bookmarked frames and frames near
+     *  recent scrub positions, then the rest by distance.
+     *
+     *  Read times are measured as reads complete. Decode cost is tracked per
+     *  reader plugin and read bandwidth per volume, so a reader or volume
+     *  that hasn't been used yet can still be estimated from the other. With
+     *  the frames still queued for each playhead this gives an estimate of the
+     *  time until they are all cached.
+     */
+    class PrecacheScheduler {
+      public:
+        PrecacheScheduler(
+            const std::chrono::microseconds default_frame_cost = std::chrono::milliseconds(40),
+            const double smoothing                             = 0.2);
+
+        /**
+         *  @brief Timeline frames in the order they should be cached, at most
+         *  max_frames of them.
+         */
+        static std::vector<int> prioritise(const PrecacheHints &hints, const size_t max_frames);
+
+        /**
+         *  @brief Volume a path is read from, the first two path components.
+         *  Frames on the same volume share read bandwidth.
+         */
+        static std::string volume(const std::string &path);
+
+        void record_read(
+            const std::string &reader,
+            const std::string &volume,
+            const size_t bytes,
+            const std::chrono::microseconds duration);
+
+        /**
+         *  @brief Expected time to read and decode one frame
+         */
+        [[nodiscard]] std::chrono::microseconds
+        frame_cost(const std::string &reader, const std::string &volume) const;
+
+        /**
+         *  @brief Smoothed size of a frame, 0 before anything was read
+         */
+        [[nodiscard]] size_t average_frame_bytes() const { return size_t(frame_bytes_); }
+
+        [[nodiscard]] double reader_frames_per_second(const std::string &reader) const;
+        [[nodiscard]] double volume_bytes_per_second(const std::string &volume) const;
+
+        void add_pending(
+            const utility::Uuid &playhead_uuid,
+            const std::string &reader,
+            const std::string &volume,
+            const size_t count = 1);
+        void remove_pending(
+            const utility::Uuid &playhead_uuid,
+            const std::string &reader,
+            const std::string &volume);
+        void clear_pending(const utility::Uuid &playhead_uuid);
+
+        [[nodiscard]] size_t pending(const utility::Uuid &playhead_uuid) const;
+
+        /**
+         *  @brief Estimated time until everything queued for the playhead is
+         *  cached. Reads for one playhead are made one after the other.
+         */
+        [[nodiscard]] std::chrono::microseconds
+        time_until_cached(const utility::Uuid &playhead_uuid) const;
+
+      private:
+        typedef std::pair<std::string, std::string> Source;
+
+        const std::chrono::microseconds default_frame_cost_;
+        const double smoothing_;
+
+        // seconds per frame
+        std::map<std::string, double> reader_cost_;
+        // bytes per second
+        std::map<std::string, double> volume_bandwidth_;
+        double frame_bytes_ = {0.0};
+
+        std::map<utility::Uuid, std::map<Source, size_t>> pending_;
+    };
+
+} // namespace media_reader
+} // namespace xstudio
@@ -10,6 +10,7 @@
 #include "xstudio/playhead/playhead.hpp"
 #include "xstudio/utility/edit_list.hpp"
 #include "xstudio/utility/json_store.hpp"
+#include "xstudio/utility/occupancy_bitmap.hpp"
 #include "xstudio/utility/timecode.hpp"
 #include "xstudio/utility/uuid.hpp"
 
@@ -63,9 +64,7 @@ namespace playhead {
         void move_playhead_to_media_source(const utility::Uuid &uuid = utility::Uuid());
         void jump_to_source(const utility::Uuid &media_uuid);
         void update_playback_rate();
-        void update_cached_frames_status(
-            const media::MediaKeyVector &new_keys    = media::MediaKeyVector(),
-            const media::MediaKeyVector &remove_keys = media::MediaKeyVector());
+        void update_cached_frames_status();
         void rebuild_cached_frames_status();
         void rebuild_bookmark_frames_ranges();
         void
@@ -121,9 +120,8 @@ namespace playhead {
         std::vector<std::pair<int, int>> cached_frames_ranges_;
         std::vector<std::tuple<utility::Uuid, std::string, int, int>> bookmark_frames_ranges_;
 
-        std::set<media::MediaKey> frames_cached_;
-
-        media::MediaKeyVector all_frames_keys_;
+        // one bit per timeline frame, kept up to date by the image cache
+        utility::OccupancyBitmap frames_cached_;
         bool updating_source_list_                      = {false};
         bool child_playhead_changed_                    = {false};
         timebase::flicks vid_refresh_sync_phase_adjust_ = timebase::flicks{0};
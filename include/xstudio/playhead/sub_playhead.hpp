@@ -106,8 +106,13 @@ namespace playhead {
         int precache_start_frame_ = {std::numeric_limits<int>::lowest()};
 
         int pre_cache_read_ahead_frames_                           = {32};
+        size_t static_cache_max_frames_                            = {2048};
         std::chrono::milliseconds static_cache_delay_milliseconds_ = {
             std::chrono::milliseconds(500)};
+
+        // hints for ordering the idle precache, logical frames
+        std::vector<int> recent_frames_;
+        std::vector<std::pair<int, int>> bookmark_frames_;
         caf::behavior behavior_;
         utility::Container base_;
         caf::actor pre_reader_;
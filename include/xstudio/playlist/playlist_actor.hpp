@@ -3,6 +3,8 @@
 
 #include <caf/all.hpp>
 #include <chrono>
+#include <map>
+#include <optional>
 
 #include "xstudio/playlist/playlist.hpp"
 #include "xstudio/utility/uuid.hpp"
@@ -17,10 +19,14 @@ namespace playlist {
 
     class PlaylistActor : public caf::event_based_actor {
       public:
+        // when lazy, media and containers are only spawned from the json once
+        // the playlist receives something other than basic queries (or
+        // materialise_atom).
         PlaylistActor(
             caf::actor_config &cfg,
             const utility::JsonStore &jsn,
-            const caf::actor &session = caf::actor());
+            const caf::actor &session = caf::actor(),
+            const bool lazy           = false);
         PlaylistActor(
             caf::actor_config &cfg,
             const std::string &name,
@@ -37,8 +43,12 @@ namespace playlist {
         inline static const std::string NAME = "PlaylistActor";
 
         void init();
+        void deserialise_actors(const utility::JsonStore &jsn);
+        void materialise();
+        [[nodiscard]] bool lazy_has_containers() const;
+        caf::behavior lazy_behavior();
 
-        caf::behavior make_behavior() override { return behavior_; }
+        caf::behavior make_behavior() override;
 
         void add_media(
             utility::UuidActor &ua,
@@ -87,6 +97,13 @@ namespace playlist {
         caf::actor playlist_broadcast_;
         caf::actor selection_actor_;
         bool auto_gather_sources_{false};
+        // serialised media and containers of a lazy playlist, reset once spawned.
+        std::optional<utility::JsonStore> lazy_actors_;
+        // and their playheads, written back as they were until then
+        std::optional<utility::JsonStore> lazy_playheads_;
+        // the latest update of each kind that arrived while lazy, replayed
+        // once spawned
+        std::map<caf::type_id_list, caf::message> lazy_updates_;
     };
 } // namespace playlist
 } // namespace xstudio
@@ -85,6 +85,12 @@ namespace plugin_manager {
         }
         size_t load_plugins();
 
+        // Where to cache the plugins each library provides. When set, a
+        // library that hasn't changed since it was cached isn't opened until
+        // one of its plugins is spawned.
+        void set_manifest_path(const std::string &path) { manifest_path_ = path; }
+        [[nodiscard]] bool loaded(const utility::Uuid &uuid) const;
+
         std::list<std::string> &plugin_paths() { return plugin_paths_; }
         std::vector<PluginDetail> plugin_detail() {
             std::vector<PluginDetail> details;
@@ -106,7 +112,12 @@ namespace plugin_manager {
         [[nodiscard]] std::string spawn_menu_ui(const utility::Uuid &uuid);
 
       private:
+        size_t add_factories(
+            const std::vector<std::shared_ptr<PluginFactory>> &factories,
+            const std::string &path);
+
         std::list<std::string> plugin_paths_;
+        std::string manifest_path_;
         std::map<utility::Uuid, PluginEntry> factories_;
         std::map<utility::Uuid, caf::actor_addr> singletons_;
     };
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <chrono>
+#include <set>
 
 #include <caf/all.hpp>
 
@@ -113,6 +114,8 @@ namespace session {
         [[nodiscard]] std::vector<caf::actor> playlists() const {
             return utility::map_value_to_vec(playlists_);
         }
+        // playlists in the order of the session tree
+        [[nodiscard]] std::vector<utility::UuidActor> ordered_playlists() const;
 
         void check_save_serialise_payload(
             std::shared_ptr<std::map<std::string, utility::JsonStore>> &payload,
@@ -130,6 +133,13 @@ namespace session {
         std::map<utility::Uuid, caf::actor> playlists_;
         caf::actor_addr current_playlist_;
         std::map<caf::actor_addr, std::string> serialise_targets_;
+        // last binary session written, source of unchanged chunks for the next save
+        std::string last_container_path_;
+        // playlists still holding their contents as json, until first used
+        // or reached by the background sweep
+        std::set<utility::Uuid> lazy_playlists_;
+        // pause between the sweep loading each playlist
+        std::chrono::milliseconds lazy_load_interval_ = {std::chrono::milliseconds(1000)};
         // std::map<utility::Uuid, caf::actor> players_;
     };
 } // namespace session
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string>
+
+#include "xstudio/utility/json_store.hpp"
+
+namespace xstudio {
+namespace shotgun_client {
+
+    /**
+     *  @brief Results of read queries, kept for a time that depends on the
+     *  entity.
+     *
+     *  @details Queries are keyed by the entity, the kind of query and the
+     *  query as JSON, joined into a string. JSON objects keep their keys
+     *  sorted, so two equal queries always have the same key, and the whole
+     *  key is compared so different queries never share one. Entity names are matched without
+     *  case and singular or plural, so "Version" and "versions" share
+     *  entries and invalidate each other.
+     *
+     *  An expired entry is kept with its ETag, if the server sent one, so it
+     *  can be revalidated rather than fetched again.
+     */
+    class QueryCache {
+      public:
+        using clock = std::chrono::system_clock;
+
+        struct Entry {
+            std::string entity;
+            utility::JsonStore value;
+            std::string etag;
+            clock::time_point stored;
+        };
+
+        QueryCache(
+            const std::chrono::seconds default_ttl = std::chrono::seconds(60),
+            const size_t max_entries               = 2000);
+        virtual ~QueryCache() = default;
+
+        static std::string
+        key(const std::string &entity, const std::string &kind, const nlohmann::json &query);
+        static std::string normalise_entity(const std::string &entity);
+
+        // a ttl of zero stops the entity being cached, an empty entity sets the default
+        void set_ttl(const std::string &entity, const std::chrono::seconds ttl);
+        [[nodiscard]] std::chrono::seconds ttl(const std::string &entity) const;
+
+        // an entry that hasn't expired, or nullptr
+        const Entry *get(const std::string &key, const clock::time_point now = clock::now());
+        // any entry, expired or not
+        [[nodiscard]] const Entry *find(const std::string &key) const;
+
+        void put(
+            const std::string &key,
+            const std::string &entity,
+            const utility::JsonStore &value,
+            const std::string &etag     = "",
+            const clock::time_point now = clock::now());
+        // the server says an expired entry is still current
+        void revalidated(const std::string &key, const clock::time_point now = clock::now());
+
+        void invalidate(const std::string &entity);
+        void clear();
+
+        [[nodiscard]] size_t size() const { return entries_.size(); }
+        [[nodiscard]] utility::JsonStore stats() const;
+
+        [[nodiscard]] utility::JsonStore serialise() const;
+        // expired entries without an etag are skipped
+        void deserialise(
+            const utility::JsonStore &jsn, const clock::time_point now = clock::now());
+
+        bool save(const std::string &path) const;
+        bool load(const std::string &path);
+
+      private:
+        [[nodiscard]] bool expired(const Entry &entry, const clock::time_point now) const;
+        void evict();
+
+        std::chrono::seconds default_ttl_;
+        size_t max_entries_;
+        std::map<std::string, std::chrono::seconds> ttls_;
+        std::map<std::string, Entry> entries_;
+
+        size_t hits_          = {0};
+        size_t misses_        = {0};
+        size_t revalidations_ = {0};
+        size_t invalidations_ = {0};
+    };
+} // namespace shotgun_client
+} // namespace xstudio
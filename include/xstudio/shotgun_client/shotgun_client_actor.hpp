@@ -2,8 +2,12 @@
 #pragma once
 
 #include <caf/all.hpp>
+#include <map>
 #include <queue>
+#include <set>
+#include <vector>
 
+#include "xstudio/shotgun_client/query_cache.hpp"
 #include "xstudio/shotgun_client/shotgun_client.hpp"
 #include "xstudio/utility/uuid.hpp"
 
@@ -15,6 +19,7 @@ namespace shotgun_client {
         ~ShotgunClientActor() override = default;
 
         const char *name() const override { return NAME.c_str(); }
+        void on_exit() override;
 
       private:
         inline static const std::string NAME = "ShotgunClientActor";
@@ -23,6 +28,27 @@ namespace shotgun_client {
 
         void acquire_token(caf::typed_response_promise<std::pair<std::string, std::string>> rp);
 
+        // Answers rp from the cache, or adds it to an identical request that
+        // is already running. Otherwise rp waits on the caller's request.
+        bool
+        from_cache(const std::string &key, caf::typed_response_promise<utility::JsonStore> rp);
+        httplib::Headers query_headers(const std::string &key) const;
+        void deliver_query(
+            const std::string &key,
+            const std::string &entity,
+            const utility::JsonStore &result,
+            const std::string &etag = "");
+        void deliver_query(const std::string &key, const caf::error &err);
+        std::vector<caf::typed_response_promise<utility::JsonStore>>
+        take_waiting(const std::string &key);
+        // fetch the page after a full one, unless it is a prefetch itself
+        bool should_prefetch(
+            const std::string &key,
+            const std::string &next_key,
+            const utility::JsonStore &result,
+            const int page,
+            const int page_size);
+
       private:
         std::queue<caf::typed_response_promise<std::pair<std::string, std::string>>>
             request_refresh_queue_;
@@ -34,6 +60,12 @@ namespace shotgun_client {
         caf::actor_addr secret_source_;
         caf::actor http_;
         caf::actor event_group_;
+
+        QueryCache cache_;
+        std::string cache_path_;
+        std::map<std::string, std::vector<caf::typed_response_promise<utility::JsonStore>>>
+            waiting_;
+        std::set<std::string> prefetching_;
     };
 } // namespace shotgun_client
 } // namespace xstudio
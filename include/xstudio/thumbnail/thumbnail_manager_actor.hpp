@@ -44,6 +44,8 @@ class ThumbnailManagerActor : public caf::event_based_actor {
     caf::actor mem_cache_;
     caf::actor dsk_cache_;
 
+    bool filmstrip_rgb24_ = {false};
+
     std::deque<std::tuple<
         caf::typed_response_promise<ThumbnailBufferPtr>,
         media::AVFrameID,
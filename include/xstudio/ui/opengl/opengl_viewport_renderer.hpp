@@ -7,6 +7,7 @@
 
 #include "xstudio/colour_pipeline/colour_pipeline.hpp"
 #include "xstudio/ui/viewport/viewport.hpp"
+#include "xstudio/utility/shader_uniforms.hpp"
 #include "xstudio/utility/uuid.hpp"
 #include <Imath/ImathMatrix.h>
 #include <caf/actor.hpp>
@@ -83,6 +84,7 @@ namespace ui {
             bool use_ssbo_;
 
             media_reader::ImageBufPtr onscreen_frame_;
+            utility::ShaderUniforms viewport_uniforms_;
 
             int viewport_index_;
             bool has_alpha_ = {false};
@@ -9,6 +9,7 @@
 // clang-format on
 
 #include "xstudio/utility/json_store.hpp"
+#include "xstudio/utility/shader_uniforms.hpp"
 #include "xstudio/media_reader/image_buffer.hpp"
 #include "xstudio/ui/viewport/shader.hpp"
 
@@ -42,17 +43,51 @@ namespace ui {
                 const std::vector<std::string> &colour_op_shaders,
                 const bool use_ssbo);
 
+            // frees the uniform block buffers, so needs the GL context current
+            virtual ~GLShaderProgram();
+
+            GLShaderProgram(const GLShaderProgram &)            = delete;
+            GLShaderProgram &operator=(const GLShaderProgram &) = delete;
+
             void inject_colour_op_shader(const std::string &colour_op_shader);
 
             void compile();
             void use() const;
             void stop_using() const;
             void set_shader_parameters(const utility::JsonStore &shader_params);
+            void set_shader_parameters(const utility::ShaderUniforms &uniforms);
             void set_shader_parameters(const media_reader::ImageBufPtr &image);
 
             GLuint program_ = {0};
 
           private:
+            // an active uniform, as reflected after linking
+            struct Uniform {
+                int location = {-1};
+                GLenum type  = {0};
+                int block    = {-1};
+                int offset   = {-1};
+            };
+
+            struct UniformBlock {
+                GLuint buffer = {0};
+                int members   = {0};
+                std::vector<std::byte> data;
+                bool dirty = {false};
+            };
+
+            // where each member of a ShaderUniforms layout goes, nullptr for
+            // members the program doesn't use. whole_block is set if the
+            // layout matches a uniform block exactly.
+            struct UniformTargets {
+                std::vector<const Uniform *> targets;
+                int whole_block = {-1};
+            };
+
+            void reflect();
+            const UniformTargets &uniform_targets(const utility::ShaderUniforms &uniforms);
+            void upload_uniform_blocks();
+
             [[nodiscard]] bool is_colour_op_shader_source(const std::string &shader_code) const;
 
             void inject_colour_ops(
@@ -60,7 +95,9 @@ namespace ui {
                 std::string main_display_shader);
 
             int get_param_location(const std::string &param_name);
-            std::map<std::string, int> locations_;
+            std::map<std::string, Uniform> uniforms_;
+            std::vector<UniformBlock> blocks_;
+            std::map<uint64_t, UniformTargets> uniform_targets_;
             std::vector<std::string> vertex_shaders_;
             std::vector<std::string> fragment_shaders_;
             int colour_operation_index_ = {1};
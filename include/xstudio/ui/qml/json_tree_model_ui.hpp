@@ -2,6 +2,7 @@
 #pragma once
 #include <caf/all.hpp>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 CAF_PUSH_WARNINGS
@@ -155,6 +156,14 @@ class JSONTreeModel : public QAbstractItemModel {
     nlohmann::json::json_pointer getIndexPath(const QModelIndex &index = QModelIndex()) const;
     QModelIndex getPathIndex(const nlohmann::json::json_pointer &path);
 
+    // roles searched through a hash index instead of walking the tree, mapped
+    // to the json field holding their value
+    void setIndexedRoles(const std::map<int, std::string> &roles);
+
+    // batch dataChanged signals, emitted once per frame
+    void queueDataChanged(const QModelIndex &index, const QVector<int> &roles = QVector<int>());
+    void flushDataChanged();
+
   protected:
     virtual QModelIndexList search_recursive_list_base(
         const QVariant &value,
@@ -164,10 +173,42 @@ class JSONTreeModel : public QAbstractItemModel {
         const int hits,
         const int depth = -1);
 
+    // must be called when indexed fields of a node change outside of
+    // setData, row inserts, removals and resets are followed automatically
+    void indexNode(utility::JsonTree *node, const bool recursive = true);
+    void unindexNode(utility::JsonTree *node, const bool recursive = true);
+
     std::string children_{"children"};
     std::string display_role_;
     std::vector<std::string> role_names_;
     utility::JsonTree data_;
+
+  private:
+    QModelIndexList search_recursive_list_base_scan(
+        const QVariant &value,
+        const int role,
+        const QModelIndex &parent,
+        const int start,
+        const int hits,
+        const int max_depth);
+    bool search_index(
+        const QVariant &value,
+        const int role,
+        const QModelIndex &parent,
+        const int start,
+        const int hits,
+        const int max_depth,
+        QModelIndexList &result);
+    void rebuild_index();
+
+    std::map<int, std::string> indexed_roles_;
+    std::map<int, std::unordered_map<std::string, std::vector<utility::JsonTree *>>>
+        role_index_;
+    std::unordered_map<utility::JsonTree *, std::vector<std::pair<int, std::string>>>
+        node_keys_;
+
+    std::map<QPersistentModelIndex, QVector<int>> pending_changes_;
+    bool flush_queued_{false};
 };
 
 class JSONTreeFilterModel : public QSortFilterProxyModel {
@@ -228,13 +228,6 @@ class SessionModel : public caf::mixin::actor_object<JSONTreeModel> {
     static nlohmann::json createEntry(const nlohmann::json &update = R"({})"_json);
 
   protected:
-    QModelIndexList search_recursive_list_base(
-        const QVariant &value,
-        const int role,
-        const QModelIndex &parent,
-        const int start,
-        const int hits,
-        const int depth = -1) override;
     // QModelIndexList search_recursive_fast(
     //     const nlohmann::json &searchValue,
     //     const std::string &searchKey,
@@ -250,9 +243,6 @@ class SessionModel : public caf::mixin::actor_object<JSONTreeModel> {
     //     const int hits) const;
 
   private:
-    bool isChildOf(const QModelIndex &parent, const QModelIndex &child) const;
-    int depthOfChild(const QModelIndex &parent, const QModelIndex &child) const;
-
     QModelIndexList insertRows(
         int row,
         int count,
@@ -307,10 +297,6 @@ class SessionModel : public caf::mixin::actor_object<JSONTreeModel> {
     QFuture<QList<QUuid>> handleOtherDropFuture(
         const int proposedAction, const utility::JsonStore &drop, const QModelIndex &index);
 
-    void add_uuid_lookup(const utility::Uuid &uuid, const QModelIndex &index);
-    void add_string_lookup(const std::string &str, const QModelIndex &index);
-    void add_lookup(const utility::JsonTree &tree, const QModelIndex &index);
-
   private:
     QString session_actor_addr_;
     QString bookmark_actor_addr_;
@@ -323,10 +309,6 @@ class SessionModel : public caf::mixin::actor_object<JSONTreeModel> {
 
     mutable std::set<std::tuple<QVariant, int, int>> in_flight_requests_;
     QThreadPool *request_handler_;
-
-
-    std::map<utility::Uuid, std::set<QPersistentModelIndex>> uuid_lookup_;
-    std::map<std::string, std::set<QPersistentModelIndex>> string_lookup_;
 };
 
 } // namespace xstudio::ui::qml
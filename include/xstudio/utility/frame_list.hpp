@@ -73,6 +73,7 @@ namespace utility {
         }
         void set_frame_groups(const std::vector<FrameGroup> &frame_groups) {
             frame_groups_ = frame_groups;
+            build_index();
         }
 
         [[nodiscard]] int start() const;
@@ -82,12 +83,26 @@ namespace utility {
         frame(const size_t index, const bool implied = false, const bool valid = false) const;
         [[nodiscard]] bool empty() const { return frame_groups_.empty(); }
         [[nodiscard]] size_t size() const { return frame_groups_.size(); }
-        void clear() { frame_groups_.clear(); }
+        void clear() {
+            frame_groups_.clear();
+            build_index();
+        }
 
         [[nodiscard]] std::vector<int> frames() const;
 
+        /*! Frames for count indexes from first, written into frames (which
+            is resized). Returns false if the range runs past the end.
+        */
+        bool frames(const size_t first, const size_t count, std::vector<int> &frames) const;
+
         template <class Inspector> friend bool inspect(Inspector &f, FrameList &x) {
-            return f.object(x).fields(f.field("groups", x.frame_groups_));
+            auto get_groups = [&x]() -> decltype(auto) { return x.frame_groups_; };
+            auto set_groups = [&x](std::vector<FrameGroup> value) {
+                x.frame_groups_ = std::move(value);
+                x.build_index();
+                return true;
+            };
+            return f.object(x).fields(f.field("groups", get_groups, set_groups));
         }
         bool operator==(const FrameList &other) const {
             if (frame_groups_.size() != other.size())
@@ -103,7 +118,13 @@ namespace utility {
         bool operator!=(const FrameList &other) const { return not(*this == other); }
 
       private:
+        void build_index();
+        [[nodiscard]] size_t group_for_index(const size_t index) const;
+
         std::vector<FrameGroup> frame_groups_;
+        // frames before each group, plus the total, for binary searching
+        // non-implied indexes
+        std::vector<size_t> group_offsets_{0};
     };
 
     extern std::vector<FrameGroup> frame_groups_from_sequence_spec(const caf::uri &from_path);
@@ -279,6 +279,12 @@ namespace utility {
         return path;
     }
 
+    inline std::string config_path(const std::string &append_path = "") {
+        auto root        = get_env("HOME");
+        std::string path = (root ? (*root) + "/.config/DNEG/xstudio/" + append_path : "");
+        return path;
+    }
+
     inline std::string preference_path(const std::string &append_path = "") {
         auto root = get_env("HOME");
         std::string path =
@@ -4,11 +4,13 @@
 
 #include <caf/uri.hpp>
 #include <limits>
+#include <memory>
 
 #include "xstudio/utility/edit_list.hpp"
 #include "xstudio/utility/frame_list.hpp"
 #include "xstudio/utility/json_store.hpp"
 #include "xstudio/utility/timecode.hpp"
+#include "xstudio/utility/uri_template.hpp"
 
 namespace xstudio {
 namespace utility {
@@ -50,6 +52,9 @@ namespace utility {
         [[nodiscard]] FrameRateDuration duration() const { return duration_; }
 
         [[nodiscard]] std::vector<std::pair<caf::uri, int>> uris() const;
+        // uris and file frames for count logical frames from logical_start
+        [[nodiscard]] std::vector<std::pair<caf::uri, int>>
+        uris(const int logical_start, const int count) const;
         [[nodiscard]] std::optional<caf::uri> uri_from_frame(const int sequence_frame) const;
         [[nodiscard]] std::optional<caf::uri>
         uri(const int logical_frame, int &file_frame) const;
@@ -94,6 +99,8 @@ namespace utility {
         }
 
       private:
+        [[nodiscard]] std::shared_ptr<const UriTemplate> uri_template() const;
+
         caf::uri uri_;
         bool container_;
         FrameRateDuration duration_;
@@ -101,6 +108,9 @@ namespace utility {
         Timecode timecode_;
 
         int offset_{0};
+
+        // compiled from uri_ on first use, rebuilt if uri_ changes
+        mutable std::shared_ptr<const UriTemplate> uri_template_;
     };
     inline std::string to_string(const MediaReference &v) {
         return to_string(v.uri_) + " " + to_string(v.duration_) + " " +
@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace xstudio {
+namespace utility {
+
+    /**
+     *  @brief One bit per frame record of which frames are present, e.g. in
+     *  a cache.
+     *
+     *  @details The version is bumped on every change so that receivers can
+     *  drop stale copies. When sent between actors only the run lengths are
+     *  serialised, a mostly cached or mostly empty 100k frame bitmap is a
+     *  handful of integers.
+     */
+    class OccupancyBitmap {
+      public:
+        OccupancyBitmap(const size_t size = 0) { resize(size); }
+
+        /**
+         *  @brief Build from alternating run lengths, the first run being
+         *  unset frames. Throws if the runs don't add up to size.
+         */
+        OccupancyBitmap(
+            const size_t size, const std::vector<uint32_t> &runs, const uint64_t version = 0);
+
+        bool operator==(const OccupancyBitmap &other) const {
+            return size_ == other.size_ and words_ == other.words_;
+        }
+
+        void resize(const size_t size);
+
+        /**
+         *  @brief Set or clear a frame, returns true if that changed anything
+         */
+        bool set(const size_t index, const bool value = true);
+
+        [[nodiscard]] bool test(const size_t index) const {
+            return index < size_ and (words_[index >> 6] & (uint64_t(1) << (index & 63)));
+        }
+
+        void clear();
+
+        [[nodiscard]] size_t size() const { return size_; }
+        [[nodiscard]] size_t count() const;
+        [[nodiscard]] uint64_t version() const { return version_; }
+        void set_version(const uint64_t version) { version_ = version; }
+
+        /**
+         *  @brief Alternating run lengths, starting with a (possibly empty)
+         *  run of unset frames.
+         */
+        [[nodiscard]] std::vector<uint32_t> runs() const;
+
+        /**
+         *  @brief Inclusive ranges of set frames. With a max_frames_per_range
+         *  above 1 frames are sampled at that stride, for drawing very long
+         *  timelines at screen resolution.
+         */
+        [[nodiscard]] std::vector<std::pair<int, int>>
+        ranges(const size_t max_frames_per_range = 1) const;
+
+        template <class Inspector> friend bool inspect(Inspector &f, OccupancyBitmap &x) {
+            auto get_runs = [&x]() -> decltype(auto) { return x.runs(); };
+            auto set_runs = [&x](std::vector<uint32_t> value) {
+                return x.assign_runs(value);
+            };
+            return f.object(x).fields(
+                f.field("size", x.size_),
+                f.field("ver", x.version_),
+                f.field("runs", get_runs, set_runs));
+        }
+
+      private:
+        bool assign_runs(const std::vector<uint32_t> &runs);
+
+        size_t size_      = {0};
+        uint64_t version_ = {0};
+        std::vector<uint64_t> words_;
+    };
+
+} // namespace utility
+} // namespace xstudio
@@ -5,6 +5,7 @@
 #include "xstudio/colour_pipeline/colour_pipeline.hpp"
 #include "xstudio/event/event.hpp"
 #include "xstudio/media/media.hpp"
+#include "xstudio/media_reader/image_buffer_export.hpp"
 #include "xstudio/plugin_manager/plugin_manager.hpp"
 #include "xstudio/shotgun_client/shotgun_client.hpp"
 #include "xstudio/tag/tag.hpp"
@@ -13,3 +14,4 @@
 #include "xstudio/ui/viewport/viewport.hpp"
 #include "xstudio/utility/caf_helpers.hpp"
 #include "xstudio/utility/frame_range.hpp"
+#include "xstudio/utility/occupancy_bitmap.hpp"
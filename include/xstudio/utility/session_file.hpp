@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace xstudio {
+namespace utility {
+
+    /* Binary session container (.xsz), an alternative to the plain JSON .xst
+    session file holding exactly the same document.
+
+    The session JSON is split into chunks at fixed points of the session
+    layout (each top level entry, each playlist, each media / timeline item in
+    a playlist and each bookmark). Every chunk is stored as zlib compressed
+    CBOR together with a CRC of its CBOR bytes. An index at the end of the
+    file lists the chunks by JSON pointer, the fixed size header at the start
+    points at the current index.
+
+    Writing can reuse the stored bytes of unchanged chunks, either from the
+    file being overwritten (changed chunks and a new index are appended, the
+    header is updated last so a failed save leaves the previous state
+    readable) or from another container such as the previous autosave. */
+
+    static const std::string session_container_extension = ".xsz";
+    static const std::string session_json_extension      = ".xst";
+
+    struct SessionContainerChunk {
+        std::string path;
+        uint64_t offset{0};
+        uint64_t stored_size{0};
+        uint64_t raw_size{0};
+        uint32_t crc{0};
+    };
+
+    struct SessionContainerWrite {
+        uint64_t hash{0};
+        bool written{false};
+        size_t chunks{0};
+        size_t chunks_written{0};
+        size_t bytes_written{0};
+        bool compacted{false};
+    };
+
+    class SessionContainerReader {
+      public:
+        // reads header and index, throws if path isn't a valid container.
+        explicit SessionContainerReader(const std::string &path);
+        ~SessionContainerReader();
+
+        SessionContainerReader(const SessionContainerReader &) = delete;
+        SessionContainerReader &operator=(const SessionContainerReader &) = delete;
+
+        [[nodiscard]] const std::vector<SessionContainerChunk> &chunks() const {
+            return chunks_;
+        }
+        [[nodiscard]] uint64_t hash() const { return hash_; }
+        [[nodiscard]] uint64_t file_size() const { return file_size_; }
+        [[nodiscard]] const std::string &path() const { return path_; }
+
+        // find chunk by JSON pointer, nullptr if there isn't one.
+        [[nodiscard]] const SessionContainerChunk *find(const std::string &path) const;
+
+        // compressed bytes as stored in the file
+        [[nodiscard]] std::vector<uint8_t> read_stored(const SessionContainerChunk &chunk) const;
+        [[nodiscard]] nlohmann::json read_chunk(const SessionContainerChunk &chunk) const;
+
+        // decode all chunks (in parallel) and reassemble the document.
+        [[nodiscard]] nlohmann::json read() const;
+
+      private:
+        std::string path_;
+        int fd_{-1};
+        uint64_t file_size_{0};
+        uint64_t hash_{0};
+        std::vector<SessionContainerChunk> chunks_;
+    };
+
+    // path has the container extension
+    bool is_session_container_path(const std::string &path);
+    // path has either session extension
+    bool is_session_file_path(const std::string &path);
+    // file starts with the container magic
+    bool is_session_container(const std::string &path);
+
+    // load a session, JSON or container, detected from the file contents.
+    nlohmann::json read_session_file(const std::string &path);
+
+    // hash of the container content write_session_container would produce.
+    uint64_t session_container_hash(const nlohmann::json &session);
+
+    /* Write session to path as a container. Nothing is written if the content
+    hash equals skip_hash. Unchanged chunks are taken from base (which may be
+    path itself) when it's a container. */
+    SessionContainerWrite write_session_container(
+        const std::string &path,
+        const nlohmann::json &session,
+        const uint64_t skip_hash = 0,
+        const std::string &base  = "");
+
+} // namespace utility
+} // namespace xstudio
@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <Imath/ImathMatrix.h>
+#include <Imath/ImathVec.h>
+
+#include "xstudio/utility/json_store.hpp"
+
+namespace xstudio {
+namespace utility {
+
+    /**
+     *  @brief Typed shader parameters, packed as a std140 uniform block.
+     *
+     *  @details Values are laid out in the order they are first set, following
+     *  the std140 rules. A GLSL uniform block that declares the same members in
+     *  the same order can be uploaded with one copy. Setting a value again
+     *  overwrites it in place, so a block that is refilled every draw doesn't
+     *  allocate. Shader programs look up where each member goes once per
+     *  layout, using layout_id(), rather than by name on every draw.
+     *
+     *  JSON in the [type, count, values...] form used for shader parameters
+     *  elsewhere is kept for serialisation. It doesn't keep the member order,
+     *  JSON objects are sorted by name.
+     */
+    class ShaderUniforms {
+      public:
+        enum class Type : uint8_t {
+            Bool,
+            Int,
+            UInt,
+            Float,
+            Vec2,
+            Vec3,
+            Vec4,
+            IVec2,
+            IVec3,
+            IVec4,
+            Mat3,
+            Mat4
+        };
+
+        struct Member {
+            std::string name;
+            Type type;
+            uint32_t offset;
+        };
+
+        ShaderUniforms() = default;
+
+        bool operator==(const ShaderUniforms &other) const {
+            return layout_id_ == other.layout_id_ and data_ == other.data_;
+        }
+
+        void set(const std::string &name, const bool value);
+        void set(const std::string &name, const int value);
+        void set(const std::string &name, const unsigned int value);
+        void set(const std::string &name, const float value);
+        void set(const std::string &name, const Imath::V2f &value);
+        void set(const std::string &name, const Imath::V3f &value);
+        void set(const std::string &name, const Imath::V4f &value);
+        void set(const std::string &name, const Imath::V2i &value);
+        void set(const std::string &name, const Imath::V3i &value);
+        void set(const std::string &name, const Imath::V4i &value);
+        void set(const std::string &name, const Imath::M33f &value);
+        void set(const std::string &name, const Imath::M44f &value);
+
+        /**
+         *  @brief The value of a scalar or vector member, or default_value if
+         *  there is no such member or it has a different type.
+         */
+        template <typename T>
+        [[nodiscard]] T value(const std::string &name, const T &default_value) const;
+
+        [[nodiscard]] const Member *find(const std::string &name) const;
+        [[nodiscard]] const std::vector<Member> &members() const { return members_; }
+        [[nodiscard]] const std::byte *data() const { return data_.data(); }
+        // padded to a multiple of 16 bytes, as a std140 block is
+        [[nodiscard]] size_t size() const { return data_.size(); }
+        [[nodiscard]] bool empty() const { return members_.empty(); }
+        // the same for any two blocks with the same members in the same order
+        [[nodiscard]] uint64_t layout_id() const { return layout_id_; }
+
+        void clear();
+
+        [[nodiscard]] JsonStore to_json() const;
+        /**
+         *  @brief Build from shader parameter JSON, throws std::runtime_error
+         *  on values that aren't a single scalar, vector or matrix.
+         */
+        static ShaderUniforms from_json(const nlohmann::json &json);
+
+        static size_t std140_alignment(const Type type);
+        static size_t std140_size(const Type type);
+        static const char *type_name(const Type type);
+
+      private:
+        void store(const std::string &name, const Type type, const void *value);
+
+        template <typename T> static constexpr bool typed_as(const Type type);
+
+        std::vector<Member> members_;
+        std::vector<std::byte> data_;
+        uint64_t layout_id_ = {0};
+    };
+
+    template <typename T> constexpr bool ShaderUniforms::typed_as(const Type type) {
+        if constexpr (std::is_same_v<T, bool>)
+            return type == Type::Bool;
+        else if constexpr (std::is_same_v<T, int>)
+            return type == Type::Int;
+        else if constexpr (std::is_same_v<T, unsigned int>)
+            return type == Type::UInt;
+        else if constexpr (std::is_same_v<T, float>)
+            return type == Type::Float;
+        else if constexpr (std::is_same_v<T, Imath::V2f>)
+            return type == Type::Vec2;
+        else if constexpr (std::is_same_v<T, Imath::V3f>)
+            return type == Type::Vec3;
+        else if constexpr (std::is_same_v<T, Imath::V4f>)
+            return type == Type::Vec4;
+        else if constexpr (std::is_same_v<T, Imath::V2i>)
+            return type == Type::IVec2;
+        else if constexpr (std::is_same_v<T, Imath::V3i>)
+            return type == Type::IVec3;
+        else if constexpr (std::is_same_v<T, Imath::V4i>)
+            return type == Type::IVec4;
+        else
+            return false;
+    }
+
+    template <typename T>
+    T ShaderUniforms::value(const std::string &name, const T &default_value) const {
+        const auto *member = find(name);
+        if (not member or not typed_as<T>(member->type))
+            return default_value;
+
+        if constexpr (std::is_same_v<T, bool>) {
+            uint32_t v;
+            std::memcpy(&v, data_.data() + member->offset, sizeof(v));
+            return v != 0;
+        } else {
+            T v;
+            std::memcpy(&v, data_.data() + member->offset, sizeof(v));
+            return v;
+        }
+    }
+
+} // namespace utility
+} // namespace xstudio
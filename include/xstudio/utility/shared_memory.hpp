@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace xstudio {
+namespace utility {
+
+    /* Thin RAII wrapper around a named POSIX shared memory object (shm_open +
+    mmap). Used to hand large payloads (pixels, serialised messages) to
+    another process on the same host without pushing them through a socket.
+
+    The creating side owns the name and, by default, unlinks it when the
+    segment is destroyed. The opening side maps an existing segment by name
+    and may unlink it once mapped, so the memory is released as soon as the
+    last mapping goes away. */
+    class SharedMemorySegment {
+      public:
+        SharedMemorySegment() = default;
+        ~SharedMemorySegment();
+
+        SharedMemorySegment(const SharedMemorySegment &) = delete;
+        SharedMemorySegment &operator=(const SharedMemorySegment &) = delete;
+
+        // create a new read/write segment of the given size. If name is empty
+        // a unique name is generated.
+        static std::shared_ptr<SharedMemorySegment>
+        create(const size_t size, const std::string &name = "");
+
+        // map an existing segment. If size is zero the size is taken from the
+        // shared memory object itself.
+        static std::shared_ptr<SharedMemorySegment>
+        open(const std::string &name, const bool read_only = true, const size_t size = 0);
+
+        [[nodiscard]] const std::string &name() const { return name_; }
+        [[nodiscard]] size_t size() const { return size_; }
+        [[nodiscard]] std::byte *data() { return static_cast<std::byte *>(addr_); }
+        [[nodiscard]] const std::byte *data() const {
+            return static_cast<const std::byte *>(addr_);
+        }
+        [[nodiscard]] bool owner() const { return owner_; }
+
+        // remove the name from the system, existing mappings stay valid.
+        void unlink();
+
+        // keep the name alive after this object is destroyed, ownership of
+        // the name passes to whoever opens it.
+        void release() { owner_ = false; }
+
+      private:
+        std::string name_;
+        void *addr_{nullptr};
+        size_t size_{0};
+        bool owner_{false};
+        bool unlinked_{false};
+    };
+
+    typedef std::shared_ptr<SharedMemorySegment> SharedMemorySegmentPtr;
+
+    // generate a name that is unique for this host, suitable for shm_open.
+    std::string unique_shared_memory_name(const std::string &prefix = "xstudio");
+
+} // namespace utility
+} // namespace xstudio
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "xstudio/utility/shared_memory.hpp"
+
+namespace xstudio {
+namespace utility {
+
+    /* Single producer / single consumer byte ring inside a shared memory
+    segment. Positions are free running 64 bit counters, so the ring never
+    needs a separate full/empty flag. The header also carries the state the
+    two ends of a ShmChannel use to avoid needless wake ups. */
+    class ShmRingBuffer {
+      public:
+        struct Header {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t capacity;
+            alignas(64) std::atomic<uint64_t> write_pos;
+            alignas(64) std::atomic<uint64_t> read_pos;
+            alignas(64) std::atomic<uint32_t> reader_waiting;
+            std::atomic<uint32_t> closed;
+            std::atomic<uint64_t> frames_written;
+            std::atomic<uint64_t> frames_acknowledged;
+        };
+
+        // bytes of shared memory needed for a ring of the given capacity.
+        static size_t segment_size(const size_t capacity);
+
+        // wrap segment, initialise is set by the side that created it.
+        ShmRingBuffer(SharedMemorySegmentPtr segment, const bool initialise);
+
+        [[nodiscard]] size_t capacity() const { return header_->capacity; }
+        [[nodiscard]] size_t readable() const;
+        [[nodiscard]] size_t writable() const;
+
+        // copy as much as fits / is available, returns bytes transferred.
+        size_t write_some(const std::byte *data, const size_t size);
+        size_t read_some(std::byte *data, const size_t size);
+
+        [[nodiscard]] Header &header() { return *header_; }
+        [[nodiscard]] const Header &header() const { return *header_; }
+        [[nodiscard]] const SharedMemorySegmentPtr &segment() const { return segment_; }
+
+      private:
+        SharedMemorySegmentPtr segment_;
+        Header *header_{nullptr};
+        std::byte *data_{nullptr};
+    };
+
+    /* Bidirectional message channel between two processes on the same host.
+    Each direction is a ShmRingBuffer, a connected unix domain socket is only
+    used to wake a sleeping reader and to notice when the peer goes away.
+
+    Frames are arbitrary byte blocks, frames larger than the ring are streamed
+    through it while the peer reads. send() may be called from any thread,
+    receive() from a single thread only. */
+    class ShmChannel {
+      public:
+        static constexpr size_t default_capacity = 8 * 1024 * 1024;
+
+        ShmChannel(
+            const int socket_fd,
+            SharedMemorySegmentPtr inbound,
+            SharedMemorySegmentPtr outbound,
+            const bool initialise,
+            std::string token);
+        ~ShmChannel();
+
+        ShmChannel(const ShmChannel &) = delete;
+        ShmChannel &operator=(const ShmChannel &) = delete;
+
+        // connect to a ShmChannelListener, throws on failure.
+        static std::shared_ptr<ShmChannel> connect(
+            const std::string &socket_path,
+            const std::chrono::milliseconds timeout = std::chrono::milliseconds(5000));
+
+        // blocks until the whole frame is in the ring, false if closed.
+        bool send(const std::byte *data, const size_t size);
+        bool send(const std::vector<std::byte> &frame) {
+            return send(frame.data(), frame.size());
+        }
+
+        // blocks until a frame arrives, false once the channel is closed.
+        bool receive(std::vector<std::byte> &frame);
+
+        // tell the sender we've finished acting on the last received frame.
+        void acknowledge();
+
+        // wait until the peer has acknowledged every frame we've sent.
+        bool wait_acknowledged(
+            const std::chrono::milliseconds timeout = std::chrono::milliseconds(5000));
+
+        void close();
+        [[nodiscard]] bool is_open() const;
+
+        // shared secret handed out during the handshake, used to pair the
+        // channel with the peer's actor on the regular connection.
+        [[nodiscard]] const std::string &token() const { return token_; }
+
+      private:
+        bool read_exact(std::byte *data, size_t size);
+        bool wait_for_data();
+        void notify_reader();
+
+        int socket_fd_{-1};
+        ShmRingBuffer inbound_;
+        ShmRingBuffer outbound_;
+        std::string token_;
+        std::mutex send_mutex_;
+        std::atomic<bool> closed_{false};
+    };
+
+    typedef std::shared_ptr<ShmChannel> ShmChannelPtr;
+
+    /* Listens on a unix domain socket and hands out ShmChannels. The socket
+    and the shared memory segments are only accessible to the current user. */
+    class ShmChannelListener {
+      public:
+        // an empty path picks one in $XDG_RUNTIME_DIR (or /tmp)
+        explicit ShmChannelListener(
+            const std::string &socket_path = "",
+            const size_t capacity          = ShmChannel::default_capacity);
+        ~ShmChannelListener();
+
+        ShmChannelListener(const ShmChannelListener &) = delete;
+        ShmChannelListener &operator=(const ShmChannelListener &) = delete;
+
+        // blocks until a client connects, nullptr once closed.
+        ShmChannelPtr accept();
+        void close();
+
+        [[nodiscard]] const std::string &path() const { return path_; }
+
+      private:
+        std::string path_;
+        size_t capacity_;
+        int socket_fd_{-1};
+        std::atomic<bool> closed_{false};
+    };
+
+} // namespace utility
+} // namespace xstudio
@@ -150,9 +150,15 @@ namespace utility {
                 change_callback_(store, erase);
         }
 
+        // called with entries released to make room, not ones erased on request
+        void bind_evict_callback(std::function<void(const K &key, const V &value)> fn) {
+            evict_callback_ = std::move(fn);
+        }
+
       private:
         std::function<void(const std::vector<K> &store, const std::vector<K> &erase)>
             change_callback_;
+        std::function<void(const K &key, const V &value)> evict_callback_;
 
         void clean_timepoints(const K &key);
         void add_timepoint_reference(
@@ -455,7 +461,9 @@ namespace utility {
         // valid key ?
         auto it = cache_.find(key);
         if (it != cache_.end()) {
-            ptr                 = it->second;
+            ptr = it->second;
+            if (evict_callback_)
+                evict_callback_(it->first, ptr);
             const auto &old_tps = timepoint_cache_[key];
             auto ms             = std::chrono::duration_cast<std::chrono::milliseconds>(
                           utility::clock::now() - *(old_tps.begin()))
@@ -502,6 +510,8 @@ namespace utility {
         auto it = cache_.find(key);
         if (it != cache_.end()) {
             ptr = it->second;
+            if (evict_callback_)
+                evict_callback_(it->first, ptr);
             erase(it);
         }
         return ptr;
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <caf/uri.hpp>
+
+namespace xstudio {
+namespace utility {
+
+    /*! Precompiled frame substitution for sequence uris.
+
+        A sequence uri holds a single fmt replacement field for the frame
+        number, e.g. file:///path/shot.{:04d}.exr. The uri is decoded, split
+        and re-encoded once so resolving a frame only formats the number
+        between the encoded prefix and suffix. Anything that isn't a single
+        plain field falls back to formatting the whole decoded uri, as before.
+    */
+    class UriTemplate {
+      public:
+        UriTemplate() = default;
+        UriTemplate(const caf::uri &uri);
+
+        [[nodiscard]] const caf::uri &source() const { return source_; }
+        [[nodiscard]] bool compiled() const { return compiled_; }
+
+        /*! Encoded uri string for frame, written into buffer which is
+            reused between calls to avoid allocating.
+        */
+        const std::string &encoded(const int frame, std::string &buffer) const;
+
+        [[nodiscard]] std::optional<caf::uri> uri(const int frame, std::string &buffer) const;
+        [[nodiscard]] std::optional<caf::uri> uri(const int frame) const;
+
+        /*! Uris for each of frames, invalid uris are returned empty.
+         */
+        [[nodiscard]] std::vector<caf::uri> uris(const std::vector<int> &frames) const;
+
+      private:
+        caf::uri source_;
+        bool compiled_ = {false};
+        std::string decoded_;
+        std::string prefix_;
+        std::string field_;
+        std::string suffix_;
+    };
+
+} // namespace utility
+} // namespace xstudio
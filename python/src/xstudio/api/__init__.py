@@ -1,11 +1,14 @@
 # SPDX-License-Identifier: Apache-2.0
+import json
 from xstudio.core import get_studio_atom, get_global_image_cache_atom, get_global_audio_cache_atom, get_global_thumbnail_atom
 from xstudio.core import get_global_store_atom, get_plugin_manager_atom, get_scanner_atom, exit_atom
+from xstudio.core import get_actor_from_registry_atom, startup_timings_atom
 from xstudio.common_api import CommonAPI
 from xstudio.api.studio import Studio
 from xstudio.api.intrinsic import GlobalStore
 from xstudio.api.intrinsic import Thumbnail
 from xstudio.api.intrinsic import MediaCache
+from xstudio.api.intrinsic import MediaReader
 from xstudio.api.intrinsic import PluginManager
 from xstudio.api.intrinsic import Scanner
 from xstudio.api.auxiliary.helpers import Filesize
@@ -25,6 +28,7 @@ class API(CommonAPI):
         self._app = None
         self._image_cache = None
         self._audio_cache = None
+        self._media_reader = None
         self._global_store = None
         self._thumbnail = None
         self._scanner = None
@@ -186,6 +190,25 @@ class API(CommonAPI):
 
         return self._image_cache
 
+    @property
+    def media_reader(self):
+        """Global media reader object.
+
+        Returns:
+            MediaReader(object): If connected, `None` otherwise
+        """
+        if self._media_reader is None:
+            self._media_reader = MediaReader(
+                self.connection,
+                self.connection.request_receive(
+                    self.connection.remote(),
+                    get_actor_from_registry_atom(),
+                    "MEDIAREADER"
+                )[0]
+            )
+
+        return self._media_reader
+
     @property
     def audio_cache(self):
         """Global audio cache object.
@@ -204,6 +227,19 @@ class API(CommonAPI):
 
         return self._audio_cache
 
+    def startup_timings(self):
+        """When each of the application's global actors was started, and how
+        long they took.
+
+        Returns:
+            timings(dict): Dict with per actor start and duration in seconds.
+        """
+        return json.loads(
+            self.connection.request_receive(
+                self.connection.remote(), startup_timings_atom()
+            )[0].dump()
+        )
+
     def status(self):
         """Return status of application
 
@@ -1,6 +1,7 @@
 # SPDX-License-Identifier: Apache-2.0
 from xstudio.api.intrinsic.global_store import GlobalStore
 from xstudio.api.intrinsic.media_cache import MediaCache
+from xstudio.api.intrinsic.media_reader import MediaReader
 from xstudio.api.intrinsic.thumbnail import Thumbnail
 from xstudio.api.intrinsic.plugin_manager import PluginManager
 from xstudio.api.intrinsic.history import History
@@ -0,0 +1,108 @@
+# SPDX-License-Identifier: Apache-2.0
+from xstudio.api.auxiliary import ActorConnection
+from xstudio.core import export_image_atom, pixel_statistics_atom, BufferExportMode, JsonStore
+
+import json
+
+class MediaReader(ActorConnection):
+    """Global media reader object, gives access to decoded frame buffers."""
+    def __init__(self, connection, remote):
+        """Create media reader object.
+
+        Args:
+            connection(Connection): Connection object.
+            remote(actor): Global media reader actor object.
+        """
+        ActorConnection.__init__(self, connection, remote)
+
+    def default_export_mode(self):
+        """Cheapest way of getting pixels to this client.
+
+        Returns:
+            mode(BufferExportMode): In-process, shared memory or inline.
+        """
+        if self.connection.local:
+            return BufferExportMode.BEM_IN_PROCESS
+        if self.connection.same_host:
+            return BufferExportMode.BEM_SHARED_MEMORY
+        return BufferExportMode.BEM_INLINE
+
+    def get_frame_buffer(self, media_pointer, mode=None):
+        """Get decoded frame, supports the buffer protocol
+        i.e. numpy.asarray(buf) gives a (height, width, channels) array of the
+        first pixel plane, buf.plane(n) gives access to the other planes.
+
+        Args:
+            media_pointer(AVFrameID): Frame to decode.
+
+        Kwargs:
+            mode(BufferExportMode): How pixels are transferred.
+
+        Returns:
+            buffer(ImageBufferExport): Frame buffer.
+        """
+        if mode is None:
+            mode = self.default_export_mode()
+
+        return self.connection.request_receive(
+            self.remote, export_image_atom(), media_pointer, mode
+        )[0]
+
+    def get_frame_buffers(self, media_source, first, last, mode=None):
+        """Get decoded frames for an inclusive range of logical frames.
+
+        Args:
+            media_source(actor): Media source actor.
+            first(int): First logical frame.
+            last(int): Last logical frame.
+
+        Kwargs:
+            mode(BufferExportMode): How pixels are transferred.
+
+        Returns:
+            buffers(list[ImageBufferExport]): Frame buffers.
+        """
+        if mode is None:
+            mode = self.default_export_mode()
+
+        return self.connection.request_receive(
+            self.remote, export_image_atom(), media_source, first, last, mode
+        )[0]
+
+    def get_pixel_statistics(self, media_pointer, options=None):
+        """Get histograms, min/max/mean, NaN/Inf counts and a luma waveform
+        of a decoded frame.
+
+        Args:
+            media_pointer(AVFrameID): Frame to measure.
+
+        Kwargs:
+            options(dict): histogram_bins, histogram_min, histogram_max,
+                waveform_columns, waveform_bins, step and threads.
+
+        Returns:
+            statistics(json): {"frames", "options", "channels", "waveform"}.
+        """
+        return json.loads(self.connection.request_receive(
+            self.remote, pixel_statistics_atom(), media_pointer, JsonStore(options or {})
+        )[0].dump())
+
+    def get_sequence_statistics(self, media_source, first, last, options=None):
+        """Get pixel statistics for an inclusive range of logical frames.
+
+        Args:
+            media_source(actor): Media source actor.
+            first(int): First logical frame.
+            last(int): Last logical frame.
+
+        Kwargs:
+            options(dict): See get_pixel_statistics.
+
+        Returns:
+            statistics(json): {"sequence", "frames"}, frames that failed
+                hold an "error".
+        """
+        return json.loads(self.connection.request_receive(
+            self.remote, pixel_statistics_atom(), media_source, first, last,
+            JsonStore(options or {})
+        )[0].dump())
@@ -165,6 +165,34 @@ class Media(Container):
         """
         return self.connection.request_receive(self.remote, get_media_pointer_atom(), media_type, logical_frame)[0]
 
+    def get_frame_buffer(self, logical_frame=0, mode=None):
+        """Get decoded frame, see MediaReader.get_frame_buffer.
+
+        Kwargs:
+            logical_frame(int): Frame to get.
+            mode(BufferExportMode): How pixels are transferred.
+
+        Returns:
+            buffer(ImageBufferExport): Frame buffer.
+        """
+        return self.connection.api.media_reader.get_frame_buffer(
+            self.get_media_pointer(logical_frame), mode
+        )
+
+    def get_pixel_statistics(self, logical_frame=0, options=None):
+        """Get pixel statistics of a frame, see MediaReader.get_pixel_statistics.
+
+        Kwargs:
+            logical_frame(int): Frame to measure.
+            options(dict): Statistics options.
+
+        Returns:
+            statistics(json): Frame statistics.
+        """
+        return self.connection.api.media_reader.get_pixel_statistics(
+            self.get_media_pointer(logical_frame), options
+        )
+
     def add_media_source(self, path, frame_list=None, frame_rate=None):
         """Add media source from path
 
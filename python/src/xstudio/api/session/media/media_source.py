@@ -132,6 +132,39 @@ class MediaSource(Container):
         """
         return self.connection.request_receive(self.remote, invalidate_cache_atom())[0]
 
+    def get_frame_buffers(self, first, last, mode=None):
+        """Get decoded frames, see MediaReader.get_frame_buffers.
+
+        Args:
+            first(int): First logical frame.
+            last(int): Last logical frame (inclusive).
+
+        Kwargs:
+            mode(BufferExportMode): How pixels are transferred.
+
+        Returns:
+            buffers(list[ImageBufferExport]): Frame buffers.
+        """
+        return self.connection.api.media_reader.get_frame_buffers(self.remote, first, last, mode)
+
+    def get_pixel_statistics(self, first, last, options=None):
+        """Get pixel statistics of frames, see
+        MediaReader.get_sequence_statistics.
+
+        Args:
+            first(int): First logical frame.
+            last(int): Last logical frame (inclusive).
+
+        Kwargs:
+            options(dict): Statistics options.
+
+        Returns:
+            statistics(json): {"sequence", "frames"}.
+        """
+        return self.connection.api.media_reader.get_sequence_statistics(
+            self.remote, first, last, options
+        )
+
     @property
     def metadata(self):
         """Get media metadata.
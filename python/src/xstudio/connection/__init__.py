@@ -15,6 +15,8 @@ from xstudio.core import RemoteSessionManager, remote_session_path
 import uuid
 import time
 import os
+import socket
+import ipaddress
 from pathlib import Path
 from threading import Thread
 
@@ -36,6 +38,7 @@ class Connection(object):
         """
         self.link = Link()
         self.connected = False
+        self.local = False
         self.api_type = None
         self.app_type = None
         self.app_version = None
@@ -263,10 +266,30 @@ class Connection(object):
         self.disconnect()
         connected = self.link.connect_local(actor)
         if connected:
+            self.local = True
             self.negotiate()
         else:
             raise RuntimeError("Failed to connect")
 
+    @property
+    def same_host(self):
+        """Is xStudio running on this machine.
+
+        Returns:
+            same_host(bool): Local or loopback connection.
+        """
+        if self.local or self.link.shared_memory():
+            return True
+
+        try:
+            host = self.link.host()
+            if not host or host == "localhost" or host == socket.gethostname():
+                return True
+            address = ipaddress.ip_address(socket.gethostbyname(host))
+            return address.is_loopback or str(address) == socket.gethostbyname(socket.gethostname())
+        except (OSError, ValueError):
+            return False
+
     def connect_remote_auto(self, session=None, sync_mode=False, sync_key_callback=None):
         """Connect to xStudio using session file.
 
@@ -285,7 +308,7 @@ class Connection(object):
             s = m.find(session)
         self.connect_remote(s.host(), s.port(), sync_mode, sync_key_callback)
 
-    def connect_remote(self, host, port, sync_mode=False, sync_key_callback=None):
+    def connect_remote(self, host, port, sync_mode=False, sync_key_callback=None, shared_memory=True):
         """Connect to xStudio using host/port.
 
         Args:
@@ -295,13 +318,15 @@ class Connection(object):
         Kwargs:
            sync_mode (bool): Sync API.
            sync_key_callback (func): Callback for sync key.
+           shared_memory (bool): Use shared memory for requests when xStudio is on this host.
         """
         if sync_key_callback is None:
             sync_key_callback = self.get_key_from_stdin
 
         self.disconnect()
-        connected = self.link.connect_remote(host, port)
+        connected = self.link.connect_remote(host, port, shared_memory)
         if connected:
+            self.local = False
             self.negotiate(sync_mode, sync_key_callback)
         else:
             raise RuntimeError("Failed to connect")
@@ -538,6 +563,7 @@ class Connection(object):
         self.app_version = None
         self._api = None
         self.connected = False
+        self.local = False
         self.stop_background_processing()
         self.link.disconnect()
 
@@ -0,0 +1,64 @@
+#!/bin/env python
+# SPDX-License-Identifier: Apache-2.0
+
+"""Compare request round trips over the middleman (TCP) and the same host
+shared memory transport.
+
+    benchmark_api_transport.py [session_name]
+"""
+
+import sys
+import time
+from xstudio.connection import Connection
+from xstudio.core import RemoteSessionManager, remote_session_path
+from xstudio.core import version_atom, get_json_atom
+
+def time_requests(connection, remote, count, *args):
+    """Time request/response round trips.
+
+        Args:
+           connection (Connection): Connection object.
+           remote (actor): Actor to ask.
+           count (int): Number of requests.
+           args (args): Message.
+
+        Returns:
+           (seconds_per_request, response)
+    """
+    response = connection.request_receive(remote, *args)
+    start = time.perf_counter()
+    for _ in range(count):
+        response = connection.request_receive(remote, *args)
+    return (time.perf_counter() - start) / count, response
+
+def benchmark(host, port, shared_memory, count=2000):
+    """Benchmark one transport.
+
+        Args:
+           host (str): Host name.
+           port (int): Port.
+           shared_memory (bool): Use shared memory transport.
+
+        Kwargs:
+           count (int): Requests per test.
+    """
+    connection = Connection()
+    connection.connect_remote(host, port, shared_memory=shared_memory)
+    transport = "shared memory" if connection.link.shared_memory() else "tcp"
+
+    small, _ = time_requests(connection, connection.remote(), count, version_atom())
+
+    store = connection.api.global_store
+    large, response = time_requests(connection, store.remote, max(1, count // 20), get_json_atom())
+    size = len(response[0].dump())
+
+    print("{:>14}: small {:8.1f} us/request, large ({} KiB) {:8.1f} us/request {:8.1f} MiB/s".format(
+        transport, small * 1e6, size // 1024, large * 1e6, size / large / (1024 * 1024)
+    ))
+    connection.disconnect()
+
+if __name__ == "__main__":
+    r = RemoteSessionManager(remote_session_path())
+    s = r.find(sys.argv[1]) if len(sys.argv) > 1 else r.first_api()
+    benchmark(s.host(), s.port(), False)
+    benchmark(s.host(), s.port(), True)
@@ -0,0 +1,19 @@
+# SPDX-License-Identifier: Apache-2.0
+import xstudio
+from xstudio.connection import Connection
+from xstudio.core import version_atom
+
+
+def test_api_transport(spawn):
+    assert spawn.link.shared_memory() == True
+
+    tcp = Connection()
+    tcp.connect_remote(spawn.host, spawn.port, shared_memory=False)
+    assert tcp.link.shared_memory() == False
+
+    # same answers either way, including responses holding actors
+    assert spawn.request_receive(spawn.remote(), version_atom())[0] == tcp.request_receive(tcp.remote(), version_atom())[0]
+    assert spawn.api.global_store.get() == tcp.api.global_store.get()
+    assert spawn.api.session.name == tcp.api.session.name
+
+    tcp.disconnect()
@@ -0,0 +1,26 @@
+# SPDX-License-Identifier: Apache-2.0
+import xstudio
+import os
+from xstudio.core import BufferExportMode
+
+
+def test_media_reader(spawn):
+    s = spawn.api.session
+    (pl_uuid, pl) = s.create_playlist("TEST")
+
+    m = pl.add_media(os.environ["TEST_RESOURCE"]+"/media/test.mov")
+
+    for mode in (BufferExportMode.BEM_INLINE, BufferExportMode.BEM_SHARED_MEMORY):
+        buf = m.get_frame_buffer(0, mode)
+        assert buf.has_error() == False
+        assert buf.plane_count() >= 1
+
+        view = memoryview(buf)
+        assert view.readonly == True
+        assert view.shape[0] == buf.height()
+
+    bufs = m.media_source().get_frame_buffers(0, 4)
+    assert len(bufs) == 5
+
+    assert pl.remove_media(m) == True
+    assert s.remove_container(pl_uuid) == True
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// CPU cost of processing one second of audio through varispeed resampling,
+// a stereo downmix, the volume ramp and int16 conversion, in buffers of one
+// 24fps frame.
+//
+// audio_dsp_benchmark [channels] [speed] [seconds]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "xstudio/audio/audio_dsp.hpp"
+
+using namespace xstudio::audio;
+
+int main(int argc, char *argv[]) {
+    const int channels = argc > 1 ? std::atoi(argv[1]) : 8;
+    const double speed = argc > 2 ? std::atof(argv[2]) : 1.5;
+    const int seconds  = argc > 3 ? std::atoi(argv[3]) : 10;
+    const long rate    = 48000;
+    const long frame   = rate / 24;
+    const long num_out = long(double(frame) / speed);
+    const auto matrix  = dsp::downmix_matrix(channels, 2);
+
+    std::vector<float> in(frame);
+    for (long i = 0; i < frame; ++i)
+        in[i] = float(std::sin(2.0 * M_PI * 440.0 * double(i) / double(rate)));
+
+    std::vector<float> resampled(num_out * channels);
+    std::vector<float> left(num_out), right(num_out), out(num_out * 2);
+    std::vector<int16_t> pcm(num_out * 2);
+    dsp::SincResampler resampler;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < seconds * 24; ++i) {
+        std::fill(left.begin(), left.end(), 0.0f);
+        std::fill(right.begin(), right.end(), 0.0f);
+        for (int c = 0; c < channels; ++c) {
+            float *r = resampled.data() + c * num_out;
+            resampler.stream(c, in.data(), frame, r, num_out);
+            dsp::mix_add(left.data(), r, num_out, matrix[c]);
+            dsp::mix_add(right.data(), r, num_out, matrix[channels + c]);
+        }
+        dsp::apply_gain_ramp(left.data(), num_out, 0.5f, 0.8f);
+        dsp::apply_gain_ramp(right.data(), num_out, 0.5f, 0.8f);
+        dsp::interleave({left.data(), right.data()}, num_out, out.data());
+        dsp::float_to_int16(out.data(), pcm.data(), num_out * 2);
+    }
+    const auto elapsed =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    std::printf(
+        "%d channels at %.2fx to stereo: %.3fms CPU per second of audio\n",
+        channels,
+        speed,
+        elapsed.count() / double(seconds));
+    return 0;
+}
@@ -0,0 +1,519 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "xstudio/audio/audio_dsp.hpp"
+
+using namespace xstudio::audio;
+using namespace xstudio::audio::dsp;
+using namespace xstudio;
+
+namespace {
+
+constexpr float minus_3db = 0.70710678f;
+
+enum Speaker { FL, FR, FC, LFE, BL, BR, BC, SL, SR, NumSpeakers };
+
+// FFmpeg's default channel layout for a given channel count
+std::vector<Speaker> default_layout(const int channels) {
+    switch (channels) {
+    case 1:
+        return {FC};
+    case 2:
+        return {FL, FR};
+    case 3:
+        return {FL, FR, FC};
+    case 4:
+        return {FL, FR, FC, BC};
+    case 5:
+        return {FL, FR, FC, BL, BR};
+    case 6:
+        return {FL, FR, FC, LFE, BL, BR};
+    case 7:
+        return {FL, FR, FC, LFE, BC, SL, SR};
+    default:
+        return {FL, FR, FC, LFE, BL, BR, SL, SR};
+    }
+}
+
+// where a speaker goes when the output layout doesn't have it, in order of
+// preference, with the gain for each destination.
+struct Fold {
+    std::vector<Speaker> speakers;
+    float gain;
+};
+
+std::vector<Fold> fold_targets(const Speaker s) {
+    switch (s) {
+    case FL:
+        return {{{FC}, minus_3db}};
+    case FR:
+        return {{{FC}, minus_3db}};
+    case FC:
+        return {{{FL, FR}, minus_3db}};
+    case BL:
+        return {{{SL}, 1.0f}, {{FL}, minus_3db}, {{FC}, minus_3db}};
+    case BR:
+        return {{{SR}, 1.0f}, {{FR}, minus_3db}, {{FC}, minus_3db}};
+    case SL:
+        return {{{BL}, 1.0f}, {{FL}, minus_3db}, {{FC}, minus_3db}};
+    case SR:
+        return {{{BR}, 1.0f}, {{FR}, minus_3db}, {{FC}, minus_3db}};
+    case BC:
+        return {
+            {{BL, BR}, minus_3db},
+            {{SL, SR}, minus_3db},
+            {{FL, FR}, 0.5f},
+            {{FC}, minus_3db}};
+    default:
+        return {};
+    }
+}
+
+double bessel_i0(const double x) {
+    double sum  = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+float dot(const float *a, const float *b, const int n) {
+    int i = 0;
+    float r;
+#if defined(__SSE2__)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+    r = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+    r = 0.0f;
+#endif
+    for (; i < n; ++i)
+        r += a[i] * b[i];
+    return r;
+}
+
+void copy_audio_metadata(const media_reader::AudioBuffer &from, media_reader::AudioBuffer &to) {
+    to.set_display_timestamp_seconds(from.display_timestamp_seconds());
+    to.set_media_key(from.media_key());
+    to.set_reversed(from.reversed());
+    to.set_time_delta_to_video_frame(from.time_delta_to_video_frame());
+}
+
+template <typename T> float sample_to_float(const T v) {
+    if constexpr (std::is_floating_point_v<T>)
+        return float(v);
+    else if constexpr (std::is_unsigned_v<T>)
+        return (float(v) - 128.0f) / 128.0f;
+    else
+        return float(double(v) / (double(std::numeric_limits<T>::max()) + 1.0));
+}
+
+template <typename T>
+void deinterleave_to_float(
+    const T *in,
+    float *out,
+    const long num_samples,
+    const int num_channels,
+    const bool planar) {
+    for (int c = 0; c < num_channels; ++c) {
+        float *o     = out + c * num_samples;
+        const T *i   = planar ? in + c * num_samples : in + c;
+        const long s = planar ? 1 : num_channels;
+        for (long n = 0; n < num_samples; ++n, i += s)
+            o[n] = sample_to_float(*i);
+    }
+}
+
+} // namespace
+
+void dsp::mix_add(float *dst, const float *src, const long n, const float gain) {
+    long i = 0;
+#if defined(__SSE2__)
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(
+            dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+#endif
+    for (; i < n; ++i)
+        dst[i] += src[i] * gain;
+}
+
+void dsp::mix_add_ramp(
+    float *dst, const float *src, const long n, const float from, const float to) {
+    if (n <= 0)
+        return;
+    const float step = (to - from) / float(n);
+    long i           = 0;
+#if defined(__SSE2__)
+    __m128 g           = _mm_setr_ps(from, from + step, from + 2.0f * step, from + 3.0f * step);
+    const __m128 step4 = _mm_set1_ps(4.0f * step);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(
+            dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+        g = _mm_add_ps(g, step4);
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] += src[i] * (from + step * float(i));
+}
+
+void dsp::apply_gain(float *buf, const long n, const float gain) {
+    long i = 0;
+#if defined(__SSE2__)
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(buf + i, _mm_mul_ps(_mm_loadu_ps(buf + i), g));
+#endif
+    for (; i < n; ++i)
+        buf[i] *= gain;
+}
+
+void dsp::apply_gain_ramp(float *buf, const long n, const float from, const float to) {
+    if (n <= 0)
+        return;
+    const float step = (to - from) / float(n);
+    long i           = 0;
+#if defined(__SSE2__)
+    __m128 g           = _mm_setr_ps(from, from + step, from + 2.0f * step, from + 3.0f * step);
+    const __m128 step4 = _mm_set1_ps(4.0f * step);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(buf + i, _mm_mul_ps(_mm_loadu_ps(buf + i), g));
+        g = _mm_add_ps(g, step4);
+    }
+#endif
+    for (; i < n; ++i)
+        buf[i] *= from + step * float(i);
+}
+
+void dsp::interleave(const std::vector<const float *> &channels, const long n, float *out) {
+    const int num_channels = int(channels.size());
+    long i                 = 0;
+#if defined(__SSE2__)
+    if (num_channels == 2) {
+        const float *l = channels[0];
+        const float *r = channels[1];
+        for (; i + 4 <= n; i += 4) {
+            const __m128 lv = _mm_loadu_ps(l + i);
+            const __m128 rv = _mm_loadu_ps(r + i);
+            _mm_storeu_ps(out + i * 2, _mm_unpacklo_ps(lv, rv));
+            _mm_storeu_ps(out + i * 2 + 4, _mm_unpackhi_ps(lv, rv));
+        }
+    }
+#endif
+    for (; i < n; ++i)
+        for (int c = 0; c < num_channels; ++c)
+            out[i * num_channels + c] = channels[c][i];
+}
+
+void dsp::float_to_int16(const float *in, int16_t *out, const long n) {
+    long i = 0;
+#if defined(__SSE2__)
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const __m128 hi    = _mm_set1_ps(1.0f);
+    const __m128 lo    = _mm_set1_ps(-1.0f);
+    for (; i + 8 <= n; i += 8) {
+        const __m128 a =
+            _mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(in + i), hi), lo), scale);
+        const __m128 b =
+            _mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(in + i + 4), hi), lo), scale);
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i *>(out + i),
+            _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+#endif
+    for (; i < n; ++i)
+        out[i] = int16_t(std::lrint(std::clamp(in[i], -1.0f, 1.0f) * 32767.0f));
+}
+
+std::vector<float> dsp::downmix_matrix(const int in_channels, const int out_channels) {
+
+    std::vector<float> m(size_t(in_channels * out_channels), 0.0f);
+    if (in_channels <= 0 || out_channels <= 0)
+        return m;
+
+    if (in_channels == out_channels) {
+        for (int c = 0; c < in_channels; ++c)
+            m[c * in_channels + c] = 1.0f;
+        return m;
+    }
+
+    const auto in_layout  = default_layout(in_channels);
+    const auto out_layout = default_layout(out_channels);
+
+    std::array<int, NumSpeakers> out_index;
+    out_index.fill(-1);
+    for (int c = 0; c < std::min(out_channels, int(out_layout.size())); ++c)
+        out_index[out_layout[c]] = c;
+
+    auto add = [&](const int in_c, const Speaker s, const float gain) {
+        m[out_index[s] * in_channels + in_c] += gain;
+    };
+
+    for (int in_c = 0; in_c < std::min(in_channels, int(in_layout.size())); ++in_c) {
+        const Speaker s = in_layout[in_c];
+
+        if (in_channels == 1 && out_index[FL] != -1 && out_index[FR] != -1) {
+            // mono source plays at full level on the front pair
+            add(in_c, FL, 1.0f);
+            add(in_c, FR, 1.0f);
+        } else if (out_index[s] != -1) {
+            add(in_c, s, 1.0f);
+        } else {
+            for (const auto &fold : fold_targets(s)) {
+                if (std::all_of(fold.speakers.begin(), fold.speakers.end(), [&](Speaker t) {
+                        return out_index[t] != -1;
+                    })) {
+                    for (const auto t : fold.speakers)
+                        add(in_c, t, fold.gain);
+                    break;
+                }
+            }
+        }
+    }
+
+    float max_sum = 0.0f;
+    for (int o = 0; o < out_channels; ++o) {
+        float sum = 0.0f;
+        for (int i = 0; i < in_channels; ++i)
+            sum += std::fabs(m[o * in_channels + i]);
+        max_sum = std::max(max_sum, sum);
+    }
+    if (max_sum > 1.0f)
+        for (auto &v : m)
+            v /= max_sum;
+
+    return m;
+}
+
+SincResampler::SincResampler(const int half_taps, const int phases, const double beta)
+    : half_taps_(half_taps), phases_(phases), beta_(beta) {}
+
+void SincResampler::build_filters(const double cutoff) {
+
+    cutoff_              = cutoff;
+    width_               = int(std::ceil(half_taps_ / cutoff));
+    const int taps       = width_ * 2;
+    const double i0_beta = bessel_i0(beta_);
+
+    filters_.resize(size_t((phases_ + 1) * taps));
+
+    for (int p = 0; p <= phases_; ++p) {
+        const double frac = double(p) / double(phases_);
+        float *f          = filters_.data() + p * taps;
+        double sum        = 0.0;
+        for (int k = 0; k < taps; ++k) {
+            // distance of this tap from the output sample position, in input samples
+            const double x = double(k - width_ + 1) - frac;
+            const double r = x / double(width_);
+            double w       = 0.0;
+            if (std::fabs(r) < 1.0) {
+                const double a    = M_PI * cutoff * x;
+                const double sinc = std::fabs(a) < 1e-9 ? 1.0 : std::sin(a) / a;
+                w = cutoff * sinc * bessel_i0(beta_ * std::sqrt(1.0 - r * r)) / i0_beta;
+            }
+            f[k] = float(w);
+            sum += w;
+        }
+        // unity gain at DC for every phase
+        for (int k = 0; k < taps; ++k)
+            f[k] = float(f[k] / sum);
+    }
+}
+
+void SincResampler::update_filters(const long num_in, const long num_out) {
+    // when reducing the number of samples the filter passband is narrowed to
+    // the new Nyquist rate. Quantised so small changes in ratio reuse the bank.
+    double cutoff = std::min(1.0, double(num_out) / double(num_in));
+    cutoff        = std::max(min_cutoff, std::floor(cutoff * 64.0) / 64.0);
+    if (cutoff != cutoff_)
+        build_filters(cutoff);
+}
+
+void SincResampler::process(
+    const float *in, const long num_in, float *out, const long num_out) {
+
+    if (num_out <= 0)
+        return;
+
+    if (num_in <= 0) {
+        std::fill(out, out + num_out, 0.0f);
+        return;
+    } else if (num_in == num_out) {
+        std::memcpy(out, in, num_out * sizeof(float));
+        return;
+    }
+
+    update_filters(num_in, num_out);
+    const int taps = width_ * 2;
+
+    // extend the block by its edge samples so every output sees a full filter
+    padded_.resize(size_t(num_in + taps + 1));
+    std::fill(padded_.begin(), padded_.begin() + width_, in[0]);
+    std::memcpy(padded_.data() + width_, in, num_in * sizeof(float));
+    std::fill(padded_.begin() + width_ + num_in, padded_.end(), in[num_in - 1]);
+
+    // centres of output samples mapped into input sample positions
+    const double step = double(num_in) / double(num_out);
+    for (long j = 0; j < num_out; ++j) {
+        const double t   = (double(j) + 0.5) * step - 0.5;
+        const double i0  = std::floor(t);
+        const int phase  = int(std::lround((t - i0) * phases_));
+        const float *src = padded_.data() + long(i0) + 1;
+        out[j]           = dot(src, filters_.data() + phase * taps, taps);
+    }
+}
+
+void SincResampler::stream(
+    const int channel, const float *in, const long num_in, float *out, const long num_out) {
+
+    if (num_out <= 0)
+        return;
+
+    if (num_in <= 0) {
+        std::fill(out, out + num_out, 0.0f);
+        return;
+    }
+
+    update_filters(num_in, num_out);
+
+    const int taps = width_ * 2;
+
+    // the input before this block. The first block of a stream is extended
+    // by its first sample, and if the filter has got wider since the last
+    // block the history is extended by its oldest sample.
+    if (history_.size() <= size_t(channel))
+        history_.resize(size_t(channel) + 1);
+    auto &history = history_[channel];
+    if (history.empty())
+        history.assign(size_t(taps), in[0]);
+    else if (history.size() > size_t(taps))
+        history.erase(history.begin(), history.end() - taps);
+    else if (history.size() < size_t(taps))
+        history.insert(history.begin(), taps - history.size(), history.front());
+
+    padded_.resize(size_t(num_in + taps));
+    std::copy(history.begin(), history.end(), padded_.begin());
+    std::memcpy(padded_.data() + taps, in, num_in * sizeof(float));
+
+    // as process() but with the output positions held back by width_ input
+    // samples, so the filter never reaches past the end of the block
+    const double step = double(num_in) / double(num_out);
+    for (long j = 0; j < num_out; ++j) {
+        const double t   = (double(j) + 0.5) * step - 0.5 - double(width_);
+        const double i0  = std::floor(t);
+        const int phase  = int(std::lround((t - i0) * phases_));
+        const float *src = padded_.data() + long(i0) + width_ + 1;
+        out[j]           = dot(src, filters_.data() + phase * taps, taps);
+    }
+
+    std::copy(padded_.end() - taps, padded_.end(), history.begin());
+}
+
+void SincResampler::reset() { history_.clear(); }
+
+media_reader::AudioBufPtr audio::to_planar_float(const media_reader::AudioBufPtr &in) {
+
+    if (!in || (in->planar() && in->sample_format() == SampleFormat::FLOAT32))
+        return in;
+
+    media_reader::AudioBufPtr result(new media_reader::AudioBuffer(in->params()));
+    result.when_to_display_ = in.when_to_display_;
+    result->allocate(
+        in->sample_rate(), in->num_channels(), in->num_samples(), SampleFormat::FLOAT32);
+    result->set_planar(true);
+    copy_audio_metadata(*in, *result);
+
+    auto *out       = reinterpret_cast<float *>(result->buffer());
+    const auto n    = in->num_samples();
+    const auto chns = in->num_channels();
+    const auto *src = in->buffer();
+
+    switch (in->sample_format()) {
+    case SampleFormat::UINT8:
+        deinterleave_to_float((const uint8_t *)src, out, n, chns, in->planar());
+        break;
+    case SampleFormat::INT16:
+        deinterleave_to_float((const int16_t *)src, out, n, chns, in->planar());
+        break;
+    case SampleFormat::INT32:
+        deinterleave_to_float((const int32_t *)src, out, n, chns, in->planar());
+        break;
+    case SampleFormat::FLOAT32:
+        deinterleave_to_float((const float *)src, out, n, chns, in->planar());
+        break;
+    case SampleFormat::INT64:
+        deinterleave_to_float((const int64_t *)src, out, n, chns, in->planar());
+        break;
+    case SampleFormat::DOUBLE64:
+        deinterleave_to_float((const double *)src, out, n, chns, in->planar());
+        break;
+    default:
+        throw std::runtime_error("Unsupported audio sample format.");
+    }
+
+    return result;
+}
+
+media_reader::AudioBufPtr audio::resample_planar(
+    const media_reader::AudioBufPtr &in,
+    const long num_samples,
+    const long sample_rate,
+    dsp::SincResampler &resampler) {
+
+    media_reader::AudioBufPtr result(new media_reader::AudioBuffer(in->params()));
+    result.when_to_display_ = in.when_to_display_;
+    result->allocate(sample_rate, in->num_channels(), num_samples, SampleFormat::FLOAT32);
+    result->set_planar(true);
+    copy_audio_metadata(*in, *result);
+
+    const auto *src = reinterpret_cast<const float *>(in->buffer());
+    auto *dst       = reinterpret_cast<float *>(result->buffer());
+    for (int c = 0; c < in->num_channels(); ++c)
+        resampler.stream(
+            c,
+            src + c * in->num_samples(),
+            in->num_samples(),
+            dst + c * num_samples,
+            num_samples);
+
+    return result;
+}
+
+media_reader::AudioBufPtr audio::reverse_planar(const media_reader::AudioBufPtr &in) {
+
+    media_reader::AudioBufPtr result(new media_reader::AudioBuffer(in->params()));
+    result.when_to_display_ = in.when_to_display_;
+    result->allocate(
+        in->sample_rate(), in->num_channels(), in->num_samples(), SampleFormat::FLOAT32);
+    result->set_planar(true);
+    copy_audio_metadata(*in, *result);
+    result->set_reversed(true);
+
+    const auto *src = reinterpret_cast<const float *>(in->buffer());
+    auto *dst       = reinterpret_cast<float *>(result->buffer());
+    const auto n    = in->num_samples();
+    for (int c = 0; c < in->num_channels(); ++c)
+        std::reverse_copy(src + c * n, src + (c + 1) * n, dst + c * n);
+
+    return result;
+}
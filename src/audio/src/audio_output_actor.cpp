@@ -1,10 +1,13 @@
 // SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
 #include <caf/policy/select_all.hpp>
 #include <cmath>
 #include <tuple>
 
 #include "xstudio/atoms.hpp"
+#include "xstudio/audio/audio_dsp.hpp"
 #include "xstudio/audio/audio_output_actor.hpp"
+#include "xstudio/audio/null_audio_output_device.hpp"
 #include "xstudio/global_store/global_store.hpp"
 #include "xstudio/media_reader/image_buffer.hpp"
 #include "xstudio/utility/edit_list.hpp"
@@ -27,12 +30,8 @@ using namespace xstudio::utility;
 using namespace xstudio;
 
 AudioOutputDeviceActor::AudioOutputDeviceActor(
-    caf::actor_config &cfg, caf::actor_addr audio_playback_manager, const std::string name)
-    : caf::event_based_actor(cfg),
-      name_(name),
-      playing_(false),
-      audio_playback_manager_(std::move(audio_playback_manager)),
-      waiting_for_samples_(false) {
+    caf::actor_config &cfg, std::shared_ptr<AudioRenderer> renderer, const std::string name)
+    : caf::event_based_actor(cfg), name_(name), renderer_(std::move(renderer)) {
 
     spdlog::debug("Created {} {}", NAME, name_);
     print_on_exit(this, "AudioOutputDeviceActor");
@@ -60,58 +59,129 @@ AudioOutputDeviceActor::AudioOutputDeviceActor(
             // TODO: restart soundcard connection with new prefs
         },
         [=](playhead::play_atom, const bool is_playing) {
+            if (!output_device_)
+                return;
             if (!is_playing) {
-                // this stops the loop pushing samples to the soundcard
-                playing_ = false;
+                stop_render_thread();
                 output_device_->disconnect_from_soundcard();
             } else if (is_playing && !playing_) {
-                // start loop
-                playing_ = true;
                 output_device_->connect_to_soundcard();
-                anon_send(actor_cast<caf::actor>(this), push_samples_atom_v);
+                start_render_thread();
             }
-        },
-        [=](push_samples_atom) {
-            // The 'waiting_for_samples_' flag allows us to ensure that we
-            // don't have multiple requests for samples to play in flight -
-            // since each response to a request then sends another
-            // 'push_samples_atom' atom (to keep playback running), having multiple
-            // requests in flight completely messes up the audio playback as
-            // essentially we have two loops running within the single actor.
-            if (waiting_for_samples_ || !playing_)
-                return;
-            waiting_for_samples_ = true;
-
-            const long num_samps_soundcard_wants = (long)output_device_->desired_samples();
-            auto tt                              = utility::clock::now();
-            request(
-                actor_cast<caf::actor>(audio_playback_manager_),
-                infinite,
-                get_samples_for_soundcard_atom_v,
-                num_samps_soundcard_wants,
-                (long)output_device_->latency_microseconds(),
-                (int)output_device_->num_channels(),
-                (int)output_device_->sample_rate())
-                .then(
-                    [=](const std::vector<int16_t> &samples_to_play) mutable {
-                        output_device_->push_samples(
-                            (const void *)samples_to_play.data(), num_samps_soundcard_wants);
-
-                        waiting_for_samples_ = false;
-
-                        if (playing_) {
-                            anon_send(actor_cast<caf::actor>(this), push_samples_atom_v);
-                        }
-                    },
-                    [=](caf::error &err) mutable { waiting_for_samples_ = false; });
-        }
+        });
+}
 
-    );
+void AudioOutputDeviceActor::on_exit() {
+    stop_render_thread();
+    if (output_device_)
+        output_device_->disconnect_from_soundcard();
+}
+
+void AudioOutputDeviceActor::start_render_thread() {
+    // allow for the largest request the soundcard has made so far
+    max_request_ = std::max(output_device_->desired_samples(), max_request_.load());
+    renderer_->configure(
+        output_device_->sample_rate(), output_device_->num_channels(), max_request_);
+    playing_       = true;
+    render_thread_ = std::thread(&AudioOutputDeviceActor::render_loop, this);
+}
+
+void AudioOutputDeviceActor::stop_render_thread() {
+    // the soundcard thread stops after its current push
+    playing_ = false;
+    if (render_thread_.joinable())
+        render_thread_.join();
+
+    // reported here rather than from the soundcard thread
+    const auto split = split_requests_.exchange(0);
+    if (split)
+        spdlog::warn(
+            "{} soundcard asked for up to {} samples, more than the {} allocated for. {} "
+            "requests were split, buffers will be larger next time.",
+            __PRETTY_FUNCTION__,
+            largest_request_.load(),
+            max_request_.load(),
+            split);
+    max_request_ = std::max(max_request_.load(), largest_request_.load());
+}
+
+void AudioOutputDeviceActor::render_loop() {
+
+    // The soundcard thread, pulls mixed samples from the render core and
+    // pushes them to the device, which blocks until it wants more. Buffers
+    // are allocated up front, the loop itself doesn't allocate.
+    const int num_channels = output_device_->num_channels();
+    const bool to_int16    = output_device_->sample_format() == SampleFormat::INT16;
+    const long max_request = max_request_;
+    std::vector<float> samples(max_request * num_channels);
+    std::vector<int16_t> samples_int16(to_int16 ? samples.size() : 0);
+
+    try {
+        while (playing_) {
+
+            const long num_samps_soundcard_wants = output_device_->desired_samples();
+
+            // more than we allocated for, it goes in pieces until the buffers
+            // are resized off this thread
+            if (num_samps_soundcard_wants > max_request) {
+                split_requests_++;
+                if (num_samps_soundcard_wants > largest_request_)
+                    largest_request_ = num_samps_soundcard_wants;
+            }
+
+            long done = 0;
+            while (done < num_samps_soundcard_wants) {
+
+                const long n = std::min(num_samps_soundcard_wants - done, max_request);
+
+                renderer_->pull(samples.data(), n, output_device_->latency_microseconds());
+
+                if (to_int16) {
+                    dsp::float_to_int16(
+                        samples.data(), samples_int16.data(), n * num_channels);
+                    output_device_->push_samples((const void *)samples_int16.data(), n);
+                } else {
+                    output_device_->push_samples((const void *)samples.data(), n);
+                }
+                done += n;
+            }
+        }
+    } catch (std::exception &e) {
+        spdlog::warn("{} {}", __PRETTY_FUNCTION__, e.what());
+    }
 }
 
 void AudioOutputDeviceActor::open_output_device(const utility::JsonStore &prefs) {
 
     try {
+        std::string device = "default";
+        try {
+            device = global_store::preference_value<std::string>(
+                prefs, "/core/audio/output_device");
+        } catch (...) {
+        }
+
+        if (device == "null") {
+            long sample_rate = 48000;
+            int channels     = 2;
+            long buffer_size = 2048;
+            std::string path;
+            try {
+                sample_rate = global_store::preference_value<int>(
+                    prefs, "/core/audio/pulse_audio_prefs/sample_rate");
+                channels = global_store::preference_value<int>(
+                    prefs, "/core/audio/pulse_audio_prefs/channels");
+                buffer_size = global_store::preference_value<int>(
+                    prefs, "/core/audio/pulse_audio_prefs/buffer_size");
+                path = global_store::preference_value<std::string>(
+                    prefs, "/core/audio/output_file");
+            } catch (...) {
+            }
+            output_device_ = std::make_unique<NullAudioOutputDevice>(
+                sample_rate, channels, buffer_size, path);
+            return;
+        }
+
 #ifdef __linux__
         output_device_ = std::make_unique<LinuxAudioOutputDevice>(prefs);
 #elif __APPLE__
@@ -138,30 +208,13 @@ void AudioOutputControlActor::init() {
 
     system().registry().put(audio_output_registry, this);
 
-    audio_output_device_ = spawn<AudioOutputDeviceActor>(actor_cast<caf::actor_addr>(this));
+    audio_output_device_ = spawn<AudioOutputDeviceActor>(renderer());
     link_to(audio_output_device_);
     set_parent_actor_addr(actor_cast<caf::actor_addr>(this));
 
     behavior_.assign(
         [=](xstudio::broadcast::broadcast_down_atom, const caf::actor_addr &) {},
 
-        [=](get_samples_for_soundcard_atom,
-            const long num_samps_to_push,
-            const long microseconds_delay,
-            const int num_channels,
-            const int sample_rate) -> result<std::vector<int16_t>> {
-            std::vector<int16_t> samples;
-            try {
-
-                prepare_samples_for_soundcard(
-                    samples, num_samps_to_push, microseconds_delay, num_channels, sample_rate);
-
-            } catch (std::exception &e) {
-
-                return caf::make_error(xstudio_error::error, e.what());
-            }
-            return samples;
-        },
         [=](playhead::play_atom, const bool is_playing) {
             if (!is_playing) {
                 clear_queued_samples();
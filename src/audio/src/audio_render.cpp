@@ -0,0 +1,458 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+#include <cmath>
+
+#include "xstudio/audio/audio_render.hpp"
+
+using namespace xstudio::audio;
+using namespace xstudio;
+
+namespace {
+
+// when blocks of audio samples aren't contiguous then to avoid a transient
+// at the border between the blocks we fade out samples at the tail of the
+// current block and the head of the next block. The window for this fade out
+// is defined here.
+constexpr long fade_samples = 64;
+
+float fade_gain(const long position, const long num_samples, const int fade_in_out) {
+    float g = 1.0f;
+    if ((fade_in_out & AudioRenderer::DoFadeHead) && position < fade_samples)
+        g *= float(position) / float(fade_samples);
+    if ((fade_in_out & AudioRenderer::DoFadeTail) && position > num_samples - fade_samples)
+        g *= float(std::max(num_samples - position, 0l)) / float(fade_samples);
+    return g;
+}
+
+} // namespace
+
+AudioRenderer::AudioRenderer(
+    const size_t queue_capacity, const long block_size, const int max_channels)
+    : commands_(queue_capacity),
+      // every buffer the soundcard thread can hold at once: the command
+      // queue, the pending list (sized to match) and the buffers in play.
+      // With the producer collecting before each queue() it can't fill.
+      retired_(commands_.capacity() * 2 + 8),
+      block_size_(block_size),
+      max_channels_(max_channels) {}
+
+void AudioRenderer::configure(
+    const long sample_rate, const int num_channels, const long max_request) {
+
+    sample_rate_  = sample_rate;
+    num_channels_ = num_channels;
+    max_request_  = std::max(max_request, 1l);
+
+    // anything still queued was meant for the previous playback
+    Command cmd;
+    while (commands_.try_pop(cmd))
+        cmd.buf.reset();
+    seen_generation_ = clear_generation_.load(std::memory_order_acquire);
+
+    pending_.assign(commands_.capacity(), Pending());
+    num_pending_ = 0;
+    current_buf_.reset();
+    previous_buf_.reset();
+    current_buf_pos_ = 0;
+    fade_in_out_     = NoFade;
+    last_volume_     = -1.0f;
+
+    downmix_.resize(max_channels_ + 1);
+    for (int c = 0; c <= max_channels_; ++c)
+        downmix_[c] = dsp::downmix_matrix(c, num_channels);
+
+    mix_buffer_.assign(num_channels, std::vector<float>(block_size_, 0.0f));
+    mix_channels_.clear();
+    for (const auto &chan : mix_buffer_)
+        mix_channels_.push_back(chan.data());
+
+    block_.assign(block_size_ * num_channels, 0.0f);
+
+    // room for a full soundcard request plus a block of overshoot, with
+    // headroom so the ring never fills completely
+    ring_ = AudioSampleDataFIFO<float>((max_request_ + block_size_) * num_channels * 2);
+    ring_.clear();
+}
+
+bool AudioRenderer::queue(
+    const utility::time_point &when,
+    const media_reader::AudioBufPtr &buf,
+    const float velocity) {
+    // keeps room in the garbage queue for everything the soundcard thread
+    // could hand back
+    collect_garbage();
+
+    Command cmd;
+    cmd.when       = when;
+    cmd.buf        = buf;
+    cmd.velocity   = velocity;
+    cmd.generation = clear_generation_.load(std::memory_order_acquire);
+    return commands_.try_push(std::move(cmd));
+}
+
+void AudioRenderer::collect_garbage() {
+    media_reader::AudioBufPtr buf;
+    while (retired_.try_pop(buf))
+        buf.reset();
+}
+
+void AudioRenderer::retire(media_reader::AudioBufPtr &buf) {
+    if (!buf)
+        return;
+    // released by the producer in collect_garbage(), the queue is sized so
+    // this can't fail
+    retired_.try_push(std::move(buf));
+    buf.reset();
+}
+
+void AudioRenderer::retire_all() {
+    for (size_t i = 0; i < num_pending_; ++i)
+        retire(pending_[i].buf);
+    num_pending_ = 0;
+    retire(current_buf_);
+    retire(previous_buf_);
+}
+
+void AudioRenderer::process_commands() {
+
+    const auto generation = clear_generation_.load(std::memory_order_acquire);
+    if (generation != seen_generation_) {
+        retire_all();
+        seen_generation_ = generation;
+    }
+
+    Command cmd;
+    while (commands_.try_pop(cmd)) {
+
+        if (cmd.generation < seen_generation_) {
+            // queued before a clear
+            retire(cmd.buf);
+            continue;
+        } else if (cmd.generation > seen_generation_) {
+            // a clear happened after we looked, this is the first buffer after it
+            retire_all();
+            seen_generation_ = cmd.generation;
+        }
+
+        playback_velocity_ = cmd.velocity;
+
+        // if the last audio buffer played is the same as the one we're
+        // receiving now we don't queue it for playing. This is because a
+        // viewport refresh (for e.g. exposure scrubbing) results in the same
+        // image frame being broadcast by the playhead
+        if ((previous_buf_ && previous_buf_->media_key() == cmd.buf->media_key()) ||
+            (current_buf_ && current_buf_->media_key() == cmd.buf->media_key())) {
+            retire(cmd.buf);
+            continue;
+        }
+
+        insert_pending(cmd.when, cmd.buf);
+    }
+}
+
+void AudioRenderer::insert_pending(
+    const utility::time_point &when, media_reader::AudioBufPtr &buf) {
+
+    // have we already got these audio samples in our queue? If so remove and
+    // add back in to update the time
+    for (size_t i = 0; i < num_pending_; ++i) {
+        if (pending_[i].buf->media_key() == buf->media_key()) {
+            retire(pending_[i].buf);
+            for (size_t j = i + 1; j < num_pending_; ++j)
+                pending_[j - 1] = pending_[j];
+            pending_[--num_pending_].buf.reset();
+            break;
+        }
+    }
+
+    size_t pos = 0;
+    while (pos < num_pending_ && pending_[pos].when < when)
+        pos++;
+
+    if (pos < num_pending_ && pending_[pos].when == when) {
+        retire(pending_[pos].buf);
+        pending_[pos].buf = buf;
+        buf.reset();
+        return;
+    }
+
+    if (num_pending_ == pending_.size()) {
+        // full, drop the earliest
+        if (pos == 0) {
+            retire(buf);
+            return;
+        }
+        retire(pending_[0].buf);
+        for (size_t j = 1; j < pos; ++j)
+            pending_[j - 1] = pending_[j];
+        pos--;
+        pending_[pos].buf.reset();
+    } else {
+        for (size_t j = num_pending_; j > pos; --j)
+            pending_[j] = pending_[j - 1];
+        num_pending_++;
+    }
+
+    pending_[pos].when = when;
+    pending_[pos].buf  = buf;
+    buf.reset();
+}
+
+void AudioRenderer::pull(float *dest, const long num_samples, const long microseconds_delay) {
+
+    const int channels = num_channels_.load(std::memory_order_relaxed);
+    const long rate    = sample_rate_.load(std::memory_order_relaxed);
+
+    if (channels <= 0 || rate <= 0) {
+        std::fill(dest, dest + num_samples * std::max(channels, 0), 0.0f);
+        return;
+    }
+
+    process_commands();
+
+    long done = 0;
+    while (done < num_samples) {
+
+        const size_t wanted = size_t(std::min(num_samples - done, max_request_) * channels);
+        while (ring_.size() < wanted) {
+            // samples already in the ring sound before the block we render now
+            const long queued = long(ring_.size()) / channels + done;
+            render_block(microseconds_delay + (queued * 1000000) / rate);
+            ring_.push(block_.data(), block_.size(), true);
+        }
+
+        ring_.pop(dest + done * channels, wanted);
+        done += long(wanted) / channels;
+    }
+}
+
+void AudioRenderer::render_block(const long microseconds_delay) {
+
+    const long rate = sample_rate_.load(std::memory_order_relaxed);
+
+    for (auto &chan : mix_buffer_)
+        std::fill(chan.begin(), chan.end(), 0.0f);
+
+    long num_samps_pushed = 0;
+
+    while (num_samps_pushed < block_size_) {
+
+        if (!current_buf_ && num_pending_) {
+
+            // when is the next sample that we copy into the buffer going to get played?
+            auto next_sample_play_time =
+                utility::clock::now() + std::chrono::microseconds(microseconds_delay) +
+                std::chrono::microseconds((num_samps_pushed * 1000000) / rate) -
+                std::chrono::milliseconds(delay_millisecs_.load(std::memory_order_relaxed));
+
+            current_buf_ = pick_audio_buffer(next_sample_play_time, true);
+
+            if (current_buf_) {
+
+                current_buf_pos_ = 0;
+
+                // is audio playback stable ? i.e. is the next sample buffer
+                // continuous with the one we are about to play?
+                auto next_buf = pick_audio_buffer(
+                    next_sample_play_time +
+                        std::chrono::microseconds(
+                            int(round(current_buf_->duration_seconds() * 1000000.0))),
+                    false);
+
+                fade_in_out_ = check_if_buffer_is_contiguous_with_previous_and_next(
+                    current_buf_, next_buf, previous_buf_);
+
+                // next_buf is still referenced from the pending list so
+                // releasing it here never frees anything
+
+            } else {
+                fade_in_out_ = DoFadeHeadAndTail;
+                break;
+            }
+
+        } else if (!current_buf_) {
+            break;
+        }
+
+        const long n = std::min(
+            block_size_ - num_samps_pushed, current_buf_->num_samples() - current_buf_pos_);
+
+        mix(current_buf_, current_buf_pos_, n, num_samps_pushed);
+
+        current_buf_pos_ += n;
+        num_samps_pushed += n;
+
+        if (current_buf_pos_ == current_buf_->num_samples()) {
+            // current buf is exhausted
+            retire(previous_buf_);
+            previous_buf_ = current_buf_;
+            current_buf_.reset();
+        }
+    }
+
+    const float vol =
+        muted_.load(std::memory_order_relaxed) ? 0.0f : volume_.load(std::memory_order_relaxed);
+    if (last_volume_ < 0.0f)
+        last_volume_ = vol;
+    for (auto &chan : mix_buffer_) {
+        if (last_volume_ != vol) {
+            dsp::apply_gain_ramp(chan.data(), block_size_, last_volume_, vol);
+        } else if (vol != 1.0f) {
+            dsp::apply_gain(chan.data(), block_size_, vol);
+        }
+    }
+    last_volume_ = vol;
+
+    dsp::interleave(mix_channels_, block_size_, block_.data());
+}
+
+void AudioRenderer::mix(
+    const media_reader::AudioBufPtr &buf,
+    const long buf_position,
+    const long num_samples,
+    const long out_position) {
+
+    const long buf_samples = buf->num_samples();
+    const int buf_channels = buf->num_channels();
+    if (buf_channels > max_channels_ || !buf->planar())
+        return;
+
+    const auto &matrix = downmix_[buf_channels];
+    const auto *src    = reinterpret_cast<const float *>(buf->buffer());
+    const int channels = int(mix_buffer_.size());
+
+    // split the range where the fade gain changes slope so each piece can be
+    // mixed with a linear gain ramp
+    long edges[4] = {buf_position, buf_position + num_samples, 0, 0};
+    int num_edges = 2;
+    if (fade_in_out_ != NoFade) {
+        for (const auto e : {fade_samples, buf_samples - fade_samples})
+            if (e > buf_position && e < buf_position + num_samples)
+                edges[num_edges++] = e;
+        std::sort(edges, edges + num_edges);
+    }
+
+    for (int e = 0; e + 1 < num_edges; ++e) {
+
+        const long start = edges[e];
+        const long n     = edges[e + 1] - start;
+        const float from = fade_gain(start, buf_samples, fade_in_out_);
+        const float to   = fade_gain(start + n, buf_samples, fade_in_out_);
+        const long out   = out_position + (start - buf_position);
+
+        for (int o = 0; o < channels; ++o) {
+            for (int i = 0; i < buf_channels; ++i) {
+                const float c = matrix[o * buf_channels + i];
+                if (c == 0.0f)
+                    continue;
+                const float *in = src + i * buf_samples + start;
+                if (from == to)
+                    dsp::mix_add(mix_buffer_[o].data() + out, in, n, c * from);
+                else
+                    dsp::mix_add_ramp(mix_buffer_[o].data() + out, in, n, c * from, c * to);
+            }
+        }
+    }
+}
+
+media_reader::AudioBufPtr AudioRenderer::pick_audio_buffer(
+    const utility::time_point &tp, const bool drop_old_buffers) {
+
+    size_t r = 0;
+    while (r < num_pending_ && pending_[r].when < tp)
+        r++;
+
+    if (r == num_pending_)
+        return media_reader::AudioBufPtr();
+
+    // get the audio buf with a 'show' time that is CLOSEST
+    // to now, need to look at the previous element to see if
+    // it's nearer
+    if (r != 0) {
+        const auto d2 = tp - pending_[r - 1].when;
+        const auto d1 = pending_[r].when - tp;
+        if (d1 > d2)
+            r--;
+    }
+
+    media_reader::AudioBufPtr v = pending_[r].buf;
+
+    if (drop_old_buffers) {
+        for (size_t i = 0; i <= r; ++i)
+            retire(pending_[i].buf);
+        for (size_t i = r + 1; i < num_pending_; ++i)
+            pending_[i - r - 1] = pending_[i];
+        for (size_t i = num_pending_ - r - 1; i < num_pending_; ++i)
+            pending_[i].buf.reset();
+        num_pending_ -= r + 1;
+    }
+    return v;
+}
+
+AudioRenderer::Fade AudioRenderer::check_if_buffer_is_contiguous_with_previous_and_next(
+    const media_reader::AudioBufPtr &current_buf,
+    const media_reader::AudioBufPtr &next_buf,
+    const media_reader::AudioBufPtr &previous_buf) {
+
+    int result = 0;
+    if (current_buf->reversed()) {
+
+        if (next_buf && next_buf->reversed()) {
+            const double delta = (current_buf->display_timestamp_seconds() -
+                                  next_buf->display_timestamp_seconds()) /
+                                     playback_velocity_ -
+                                 next_buf->duration_seconds();
+
+            if (fabs(delta) > 0.001) {
+                result |= DoFadeTail;
+            }
+        } else {
+            result |= DoFadeTail;
+        }
+
+        if (previous_buf && previous_buf->reversed()) {
+
+            const double delta = (previous_buf->display_timestamp_seconds() -
+                                  current_buf->display_timestamp_seconds()) /
+                                     playback_velocity_ -
+                                 current_buf->duration_seconds();
+
+            if (fabs(delta) > 0.001) {
+                result |= DoFadeHead;
+            }
+
+        } else {
+            result |= DoFadeHead;
+        }
+
+    } else {
+
+        if (next_buf && !next_buf->reversed()) {
+            const double delta = (next_buf->display_timestamp_seconds() -
+                                  current_buf->display_timestamp_seconds()) /
+                                     playback_velocity_ -
+                                 current_buf->duration_seconds();
+            if (fabs(delta) > 0.001) {
+                result |= DoFadeTail;
+            }
+        } else {
+            result |= DoFadeTail;
+        }
+
+        if (previous_buf && !previous_buf->reversed()) {
+
+            const double delta = (current_buf->display_timestamp_seconds() -
+                                  previous_buf->display_timestamp_seconds()) /
+                                     playback_velocity_ -
+                                 previous_buf->duration_seconds();
+            if (fabs(delta) > 0.001) {
+                result |= DoFadeHead;
+            }
+
+        } else {
+            result |= DoFadeHead;
+        }
+    }
+
+    return (AudioRenderer::Fade)result;
+}
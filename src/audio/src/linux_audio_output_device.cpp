@@ -42,7 +42,7 @@ void LinuxAudioOutputDevice::connect_to_soundcard() {
 
     /* The Sample format to use */
     pa_sample_spec pa_ss;
-    pa_ss.format   = PA_SAMPLE_S16LE;
+    pa_ss.format   = PA_SAMPLE_FLOAT32LE;
     pa_ss.rate     = (uint32_t)sample_rate_;
     pa_ss.channels = (uint8_t)num_channels_;
 
@@ -90,8 +90,11 @@ void LinuxAudioOutputDevice::push_samples(const void *sample_data, const long nu
 
     int error;
     if (playback_handle_ &&
-        pa_simple_write(playback_handle_, sample_data, (size_t)num_samples * 2 * 2, &error) <
-            0) {
+        pa_simple_write(
+            playback_handle_,
+            sample_data,
+            (size_t)num_samples * num_channels_ * sizeof(float),
+            &error) < 0) {
         std::stringstream ss;
         ss << __FILE__ ": pa_simple_write() failed: " << pa_strerror(error);
         throw std::runtime_error(ss.str().c_str());
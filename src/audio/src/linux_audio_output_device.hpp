@@ -41,7 +41,7 @@ namespace audio {
         long sample_rate_           = {44100};
         int num_channels_           = {2};
         long buffer_size_           = {2048};
-        SampleFormat sample_format_ = {SampleFormat::INT16};
+        SampleFormat sample_format_ = {SampleFormat::FLOAT32};
         pa_simple *playback_handle_ = {nullptr};
         const utility::JsonStore config_;
         const utility::JsonStore prefs_;
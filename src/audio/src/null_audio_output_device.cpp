@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+
+#include "xstudio/audio/null_audio_output_device.hpp"
+
+using namespace xstudio::audio;
+
+namespace {
+
+template <typename T> void write_le(FILE *f, const T v) { fwrite(&v, sizeof(T), 1, f); }
+
+} // namespace
+
+NullAudioOutputDevice::NullAudioOutputDevice(
+    const long sample_rate,
+    const int num_channels,
+    const long buffer_size,
+    const std::string &path,
+    const bool realtime)
+    : sample_rate_(sample_rate),
+      num_channels_(num_channels),
+      buffer_size_(buffer_size),
+      path_(path),
+      realtime_(realtime) {}
+
+NullAudioOutputDevice::~NullAudioOutputDevice() { disconnect_from_soundcard(); }
+
+void NullAudioOutputDevice::connect_to_soundcard() {
+
+    disconnect_from_soundcard();
+
+    samples_pushed_ = 0;
+    next_push_      = std::chrono::steady_clock::now();
+
+    if (!path_.empty()) {
+        file_ = fopen(path_.c_str(), "wb");
+        if (!file_)
+            throw std::runtime_error("Failed to open audio output file " + path_);
+        write_wav_header();
+    }
+}
+
+void NullAudioOutputDevice::disconnect_from_soundcard() {
+    if (file_) {
+        // sizes are only known now
+        write_wav_header();
+        fclose(file_);
+    }
+    file_ = nullptr;
+}
+
+void NullAudioOutputDevice::write_wav_header() {
+
+    const uint32_t data_bytes  = uint32_t(samples_pushed_ * num_channels_ * sizeof(float));
+    const uint16_t block_align = uint16_t(num_channels_ * sizeof(float));
+
+    fseek(file_, 0, SEEK_SET);
+    fwrite("RIFF", 1, 4, file_);
+    write_le<uint32_t>(file_, 36 + data_bytes);
+    fwrite("WAVEfmt ", 1, 8, file_);
+    write_le<uint32_t>(file_, 16);
+    write_le<uint16_t>(file_, 3); // IEEE float
+    write_le<uint16_t>(file_, uint16_t(num_channels_));
+    write_le<uint32_t>(file_, uint32_t(sample_rate_));
+    write_le<uint32_t>(file_, uint32_t(sample_rate_) * block_align);
+    write_le<uint16_t>(file_, block_align);
+    write_le<uint16_t>(file_, 32);
+    fwrite("data", 1, 4, file_);
+    write_le<uint32_t>(file_, data_bytes);
+    fseek(file_, 0, SEEK_END);
+}
+
+void NullAudioOutputDevice::push_samples(const void *sample_data, const long num_samples) {
+
+    if (file_ &&
+        fwrite(sample_data, sizeof(float) * num_channels_, num_samples, file_) !=
+            size_t(num_samples)) {
+        throw std::runtime_error("Failed to write audio output file " + path_);
+    }
+
+    samples_pushed_ += num_samples;
+
+    if (realtime_) {
+        // a soundcard would block until it had room for these samples
+        next_push_ += std::chrono::microseconds((num_samples * 1000000) / sample_rate_);
+        std::this_thread::sleep_until(next_push_);
+    }
+}
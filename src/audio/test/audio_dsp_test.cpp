@@ -0,0 +1,208 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <cmath>
+#include <gtest/gtest.h>
+
+#include "xstudio/audio/audio_dsp.hpp"
+
+using namespace xstudio;
+using namespace xstudio::audio;
+using namespace xstudio::media_reader;
+
+namespace {
+
+std::vector<float> sine(const double freq, const double rate, const long n) {
+    std::vector<float> r(n);
+    for (long i = 0; i < n; ++i)
+        r[i] = float(std::sin(2.0 * M_PI * freq * double(i) / rate));
+    return r;
+}
+
+// rms of the middle of a block, away from the edges of the filter
+double rms(const std::vector<float> &v) {
+    const size_t margin = v.size() / 8;
+    double sum          = 0.0;
+    for (size_t i = margin; i < v.size() - margin; ++i)
+        sum += double(v[i]) * double(v[i]);
+    return std::sqrt(sum / double(v.size() - 2 * margin));
+}
+
+double resampled_gain(
+    dsp::SincResampler &resampler, const double freq, const long num_in, const long num_out) {
+    const auto in = sine(freq, 48000.0, num_in);
+    std::vector<float> out(num_out);
+    resampler.process(in.data(), num_in, out.data(), num_out);
+    return rms(out) / rms(in);
+}
+
+} // namespace
+
+TEST(AudioDspKernelTest, Test) {
+    std::vector<float> dst(19, 1.0f);
+    std::vector<float> src(19, 2.0f);
+
+    dsp::mix_add(dst.data(), src.data(), 19, 0.5f);
+    for (const auto v : dst)
+        EXPECT_FLOAT_EQ(v, 2.0f);
+
+    dsp::apply_gain(dst.data(), 19, 0.25f);
+    for (const auto v : dst)
+        EXPECT_FLOAT_EQ(v, 0.5f);
+
+    std::fill(dst.begin(), dst.end(), 0.0f);
+    dsp::mix_add_ramp(dst.data(), src.data(), 19, 0.0f, 1.0f);
+    for (size_t i = 0; i < dst.size(); ++i)
+        EXPECT_NEAR(dst[i], 2.0f * float(i) / 19.0f, 1e-5);
+
+    std::fill(dst.begin(), dst.end(), 1.0f);
+    dsp::apply_gain_ramp(dst.data(), 19, 1.0f, 0.0f);
+    for (size_t i = 0; i < dst.size(); ++i)
+        EXPECT_NEAR(dst[i], 1.0f - float(i) / 19.0f, 1e-5);
+
+    std::vector<float> left  = {0, 1, 2, 3, 4};
+    std::vector<float> right = {10, 11, 12, 13, 14};
+    std::vector<float> interleaved(10);
+    dsp::interleave({left.data(), right.data()}, 5, interleaved.data());
+    EXPECT_EQ(interleaved, std::vector<float>({0, 10, 1, 11, 2, 12, 3, 13, 4, 14}));
+
+    std::vector<float> f = {0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 2.0f, -2.0f, 0.25f, 1.5f};
+    std::vector<int16_t> i16(f.size());
+    dsp::float_to_int16(f.data(), i16.data(), long(f.size()));
+    EXPECT_EQ(
+        i16,
+        std::vector<int16_t>({0, 16384, -16384, 32767, -32767, 32767, -32767, 8192, 32767}));
+}
+
+TEST(AudioDspDownmixTest, Test) {
+    // stereo passes straight through
+    auto m = dsp::downmix_matrix(2, 2);
+    EXPECT_EQ(m, std::vector<float>({1, 0, 0, 1}));
+
+    // mono to both speakers
+    m = dsp::downmix_matrix(1, 2);
+    EXPECT_EQ(m, std::vector<float>({1, 1}));
+
+    // 5.1 to stereo: FL FR FC LFE BL BR
+    m = dsp::downmix_matrix(6, 2);
+    ASSERT_EQ(m.size(), size_t(12));
+    EXPECT_FLOAT_EQ(m[0], m[7]);      // FL->L == FR->R
+    EXPECT_FLOAT_EQ(m[1], 0.0f);      // FR->L
+    EXPECT_FLOAT_EQ(m[3], 0.0f);      // LFE dropped
+    EXPECT_FLOAT_EQ(m[2], m[8]);      // centre to both sides
+    EXPECT_NEAR(m[2] / m[0], 0.7071f, 1e-4);
+    EXPECT_NEAR(m[4] / m[0], 0.7071f, 1e-4);
+    EXPECT_FLOAT_EQ(m[5], 0.0f);      // BR->L
+    float sum = 0.0f;
+    for (int i = 0; i < 6; ++i)
+        sum += m[i];
+    EXPECT_NEAR(sum, 1.0f, 1e-5);
+
+    // 7.1 to 5.1 folds sides into backs
+    m = dsp::downmix_matrix(8, 6);
+    EXPECT_GT(m[4 * 8 + 6], 0.0f); // SL->BL
+    EXPECT_GT(m[5 * 8 + 7], 0.0f); // SR->BR
+
+    // stereo to mono
+    m = dsp::downmix_matrix(2, 1);
+    EXPECT_FLOAT_EQ(m[0], m[1]);
+    EXPECT_LE(m[0] + m[1], 1.0f + 1e-6);
+}
+
+TEST(AudioDspResamplerFrequencyResponseTest, Test) {
+    dsp::SincResampler resampler;
+
+    // passband is preserved in both directions
+    for (const double freq : {100.0, 1000.0, 5000.0, 15000.0}) {
+        EXPECT_NEAR(resampled_gain(resampler, freq, 4800, 4410), 1.0, 0.02) << freq;
+        EXPECT_NEAR(resampled_gain(resampler, freq, 4410, 4800), 1.0, 0.02) << freq;
+        EXPECT_NEAR(resampled_gain(resampler, freq, 4800, 9600), 1.0, 0.02) << freq;
+    }
+
+    // at double speed the content above the new Nyquist rate (12kHz) is
+    // attenuated, not aliased back into the passband
+    EXPECT_NEAR(resampled_gain(resampler, 6000.0, 9600, 4800), 1.0, 0.02);
+    EXPECT_LT(resampled_gain(resampler, 16000.0, 9600, 4800), 0.01);
+    EXPECT_LT(resampled_gain(resampler, 20000.0, 9600, 4800), 0.01);
+
+    // a resampled sine is still a sine of the expected frequency and phase,
+    // output sample i is centred on input position 2i + 0.5
+    const long n  = 4800;
+    const auto in = sine(1000.0, 48000.0, n);
+    std::vector<float> out(n / 2);
+    resampler.process(in.data(), n, out.data(), n / 2);
+    for (long i = n / 8; i < n / 2 - n / 8; ++i)
+        EXPECT_NEAR(out[i], std::sin(2.0 * M_PI * 1000.0 * (2.0 * i + 0.5) / 48000.0), 0.005)
+            << i;
+
+    // DC
+    std::vector<float> dc(1000, 0.5f);
+    std::vector<float> dc_out(777);
+    resampler.process(dc.data(), 1000, dc_out.data(), 777);
+    for (const auto v : dc_out)
+        EXPECT_NEAR(v, 0.5f, 1e-4);
+}
+
+TEST(AudioDspBufferTest, Test) {
+    AudioBufPtr buf(new AudioBuffer());
+    buf->allocate(48000, 2, 4, SampleFormat::INT16);
+    auto *s = reinterpret_cast<int16_t *>(buf->buffer());
+    for (int i = 0; i < 8; ++i)
+        s[i] = int16_t(i % 2 ? -i * 4096 : i * 4096);
+
+    auto planar = to_planar_float(buf);
+    ASSERT_TRUE(planar->planar());
+    EXPECT_EQ(planar->sample_format(), SampleFormat::FLOAT32);
+    EXPECT_EQ(planar->num_samples(), 4);
+    auto *f = reinterpret_cast<const float *>(planar->buffer());
+    EXPECT_FLOAT_EQ(f[0], 0.0f);
+    EXPECT_FLOAT_EQ(f[1], 0.25f);
+    EXPECT_FLOAT_EQ(f[4], -0.125f);
+    EXPECT_FLOAT_EQ(f[5], -0.375f);
+    EXPECT_EQ(to_planar_float(planar).get(), planar.get());
+
+    auto reversed = reverse_planar(planar);
+    EXPECT_TRUE(reversed->reversed());
+    auto *r = reinterpret_cast<const float *>(reversed->buffer());
+    EXPECT_FLOAT_EQ(r[0], f[3]);
+    EXPECT_FLOAT_EQ(r[7], f[4]);
+
+    dsp::SincResampler resampler;
+    auto slower = resample_planar(planar, 8, 48000, resampler);
+    EXPECT_EQ(slower->num_samples(), 8);
+    EXPECT_EQ(slower->num_channels(), 2);
+    EXPECT_TRUE(slower->planar());
+}
+
+TEST(AudioDspResamplerStreamTest, Test) {
+    // a sine resampled a frame at a time is the same continuous sine, delayed
+    // by the resampler's latency, across the frame boundaries
+    const long frame = 48000 / 24;
+    const long n     = frame * 8;
+    const auto in    = sine(1000.0, 48000.0, n);
+    dsp::SincResampler resampler;
+
+    std::vector<float> out(n / 2);
+    for (long i = 0; i < n / frame; ++i)
+        resampler.stream(
+            0, in.data() + i * frame, frame, out.data() + i * frame / 2, frame / 2);
+
+    const int latency = resampler.latency();
+    EXPECT_GT(latency, 0);
+    for (long i = latency; i < n / 2; ++i)
+        EXPECT_NEAR(
+            out[i], std::sin(2.0 * M_PI * 1000.0 * (2.0 * i + 0.5 - latency) / 48000.0), 0.005)
+            << i;
+
+    // channels have their own history
+    std::vector<float> silence(frame, 0.0f), left(frame / 2), right(frame / 2);
+    resampler.stream(1, silence.data(), frame, right.data(), frame / 2);
+    resampler.stream(0, in.data(), frame, left.data(), frame / 2);
+    for (const auto v : right)
+        EXPECT_FLOAT_EQ(v, 0.0f);
+
+    // after a reset the first frame is extended by its first sample
+    resampler.reset();
+    std::vector<float> dc(frame, 0.5f), dc_out(frame / 2);
+    resampler.stream(0, dc.data(), frame, dc_out.data(), frame / 2);
+    for (const auto v : dc_out)
+        EXPECT_NEAR(v, 0.5f, 1e-4);
+}
@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "xstudio/audio/audio_render.hpp"
+#include "xstudio/audio/null_audio_output_device.hpp"
+
+using namespace xstudio;
+using namespace xstudio::audio;
+using namespace xstudio::media_reader;
+
+namespace {
+
+AudioBufPtr make_buffer(const std::string &key, const long num_samples, const float value) {
+    AudioBufPtr buf(new AudioBuffer());
+    buf->allocate(48000, 1, num_samples, SampleFormat::FLOAT32);
+    buf->set_planar(true);
+    buf->set_media_key(media::MediaKey(key));
+    auto *s = reinterpret_cast<float *>(buf->buffer());
+    std::fill(s, s + num_samples, value);
+    return buf;
+}
+
+} // namespace
+
+TEST(SPSCQueueTest, Test) {
+    SPSCQueue<int> q(5);
+    EXPECT_EQ(q.capacity(), size_t(8));
+
+    for (int i = 0; i < 8; ++i)
+        EXPECT_TRUE(q.try_push(int(i)));
+    EXPECT_FALSE(q.try_push(8));
+
+    int v = -1;
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_TRUE(q.try_pop(v));
+        EXPECT_EQ(v, i);
+    }
+    EXPECT_FALSE(q.try_pop(v));
+
+    // one producer, one consumer, everything arrives in order
+    SPSCQueue<long> big(64);
+    const long count = 10000;
+    std::thread producer([&]() {
+        for (long i = 0; i < count; ++i)
+            while (!big.try_push(long(i)))
+                std::this_thread::yield();
+    });
+    long expected = 0;
+    long got;
+    while (expected < count) {
+        if (big.try_pop(got)) {
+            ASSERT_EQ(got, expected);
+            expected++;
+        }
+    }
+    producer.join();
+}
+
+TEST(AudioRendererTest, Test) {
+    AudioRenderer renderer(64, 256);
+    renderer.configure(48000, 2, 1024);
+    EXPECT_EQ(renderer.sample_rate(), 48000);
+    EXPECT_EQ(renderer.num_channels(), 2);
+
+    std::vector<float> out(1024 * 2);
+
+    // nothing queued, silence
+    renderer.pull(out.data(), 1024, 0);
+    for (const auto v : out)
+        EXPECT_EQ(v, 0.0f);
+
+    // mono buffer due now plays on both channels
+    const auto soon = []() { return utility::clock::now() + std::chrono::milliseconds(5); };
+    auto buf        = make_buffer("a", 4800, 0.5f);
+    EXPECT_TRUE(renderer.queue(soon(), buf));
+    renderer.pull(out.data(), 1024, 0);
+    EXPECT_EQ(renderer.pending(), size_t(0));
+    // past the head fade
+    EXPECT_NEAR(out[200 * 2], 0.5f, 1e-5);
+    EXPECT_NEAR(out[200 * 2 + 1], 0.5f, 1e-5);
+    EXPECT_NEAR(out[1000 * 2], 0.5f, 1e-5);
+
+    // volume ramps rather than jumps
+    renderer.set_volume(0.5f);
+    renderer.pull(out.data(), 1024, 0);
+    EXPECT_GT(out[10 * 2], 0.25f);
+    EXPECT_NEAR(out[1000 * 2], 0.25f, 1e-5);
+
+    // played out, the same buffer again isn't replayed
+    for (int i = 0; i < 4; ++i)
+        renderer.pull(out.data(), 1024, 0);
+    EXPECT_EQ(out[1000 * 2], 0.0f);
+    renderer.queue(soon(), buf);
+    renderer.pull(out.data(), 1024, 0);
+    EXPECT_EQ(out[1000 * 2], 0.0f);
+
+    // buffers come back through the garbage queue to be released here
+    EXPECT_GT(buf.use_count(), 1);
+    renderer.clear();
+    renderer.pull(out.data(), 1024, 0);
+    renderer.collect_garbage();
+    EXPECT_EQ(buf.use_count(), 1);
+
+    // cleared before it was played
+    renderer.queue(soon(), make_buffer("b", 4800, 0.5f));
+    renderer.clear();
+    renderer.pull(out.data(), 1024, 0);
+    for (const auto v : out)
+        EXPECT_EQ(v, 0.0f);
+
+    // queued after a clear the render thread hasn't seen yet
+    renderer.clear();
+    renderer.queue(soon(), make_buffer("c", 4800, 0.5f));
+    renderer.pull(out.data(), 1024, 0);
+    EXPECT_NEAR(out[1000 * 2], 0.25f, 1e-5);
+
+    // muted
+    renderer.set_muted(true);
+    renderer.pull(out.data(), 1024, 0);
+    renderer.pull(out.data(), 1024, 0);
+    for (const auto v : out)
+        EXPECT_EQ(v, 0.0f);
+
+    // requests larger than configured are split
+    std::vector<float> large(4000 * 2);
+    renderer.pull(large.data(), 4000, 0);
+}
+
+TEST(AudioRendererTest, Retire) {
+    // Buffers the soundcard thread drops are held in the garbage queue until
+    // the producer side releases them, however many go through.
+    AudioRenderer renderer(8, 256);
+    renderer.configure(48000, 2, 256);
+    std::vector<float> out(256 * 2);
+
+    std::vector<std::vector<AudioBufPtr>> rounds;
+    for (int round = 0; round < 16; ++round) {
+        // each round pushes the last one out of the full pending list
+        rounds.emplace_back();
+        for (int i = 0; i < 8; ++i) {
+            rounds.back().push_back(make_buffer(std::to_string(round * 8 + i), 480, 0.5f));
+            renderer.queue(
+                utility::clock::now() + std::chrono::seconds(10 + round * 8 + i),
+                rounds.back().back());
+        }
+
+        // released by queueing, apart from the one playing and the one before
+        if (round > 1) {
+            const auto &old = rounds[round - 2];
+            EXPECT_GE(
+                std::count_if(
+                    old.begin(),
+                    old.end(),
+                    [](const AudioBufPtr &buf) { return buf.use_count() == 1; }),
+                long(old.size()) - 2);
+        }
+
+        renderer.pull(out.data(), 256, 0);
+
+        // pending, or dropped and waiting to be released, but not by pull()
+        for (size_t r = std::max(round - 1, 0); r < rounds.size(); ++r)
+            for (const auto &buf : rounds[r])
+                EXPECT_GT(buf.use_count(), 1);
+    }
+
+    renderer.clear();
+    renderer.pull(out.data(), 256, 0);
+    renderer.collect_garbage();
+    for (const auto &round : rounds)
+        for (const auto &buf : round)
+            EXPECT_EQ(buf.use_count(), 1);
+}
+
+TEST(NullAudioOutputDeviceTest, Test) {
+    const auto path =
+        (std::filesystem::temp_directory_path() / "xstudio_null_audio_test.wav").string();
+
+    AudioRenderer renderer;
+    NullAudioOutputDevice device(48000, 2, 512, path, false);
+
+    device.connect_to_soundcard();
+    renderer.configure(device.sample_rate(), device.num_channels(), device.desired_samples());
+    renderer.queue(
+        utility::clock::now() + std::chrono::milliseconds(5), make_buffer("a", 48000, 0.25f));
+
+    // a soundcard thread driving the device
+    std::vector<float> samples(device.desired_samples() * device.num_channels());
+    for (int i = 0; i < 20; ++i) {
+        renderer.pull(samples.data(), device.desired_samples(), device.latency_microseconds());
+        device.push_samples(samples.data(), device.desired_samples());
+    }
+    device.disconnect_from_soundcard();
+
+    EXPECT_EQ(device.samples_pushed(), 20 * 512);
+    EXPECT_EQ(std::filesystem::file_size(path), size_t(44 + 20 * 512 * 2 * sizeof(float)));
+    std::filesystem::remove(path);
+
+    // a real time device consumes everything it is given
+    NullAudioOutputDevice paced(48000, 2, 480);
+    paced.connect_to_soundcard();
+    for (int i = 0; i < 3; ++i)
+        paced.push_samples(samples.data(), 480);
+    EXPECT_EQ(paced.samples_pushed(), 3 * 480);
+}
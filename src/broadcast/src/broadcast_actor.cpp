@@ -3,6 +3,7 @@
 #include "xstudio/broadcast/broadcast_actor.hpp"
 #include "xstudio/atoms.hpp"
 #include "xstudio/utility/helpers.hpp"
+#include "xstudio/utility/json_store.hpp"
 #include "xstudio/utility/logging.hpp"
 #include "xstudio/utility/uuid.hpp"
 
@@ -14,6 +15,28 @@ using namespace caf;
 static std::atomic<int> count{0};
 static std::atomic<int> actor_count{0};
 
+namespace {
+// the key element of a superseded message as a string, empty if it isn't a
+// type we can compare
+std::string message_key(const caf::message &msg, const int index) {
+    if (index < 0 or size_t(index) >= msg.size())
+        return {};
+    if (msg.match_element<Uuid>(index))
+        return to_string(msg.get_as<Uuid>(index));
+    if (msg.match_element<caf::actor>(index))
+        return to_string(msg.get_as<caf::actor>(index));
+    if (msg.match_element<caf::actor_addr>(index))
+        return to_string(msg.get_as<caf::actor_addr>(index));
+    if (msg.match_element<std::string>(index))
+        return msg.get_as<std::string>(index);
+    if (msg.match_element<int>(index))
+        return std::to_string(msg.get_as<int>(index));
+    if (msg.match_element<int64_t>(index))
+        return std::to_string(msg.get_as<int64_t>(index));
+    return {};
+}
+} // namespace
+
 BroadcastActor::BroadcastActor(caf::actor_config &cfg, caf::actor owner)
     : caf::event_based_actor(cfg) {
     // count++;
@@ -38,43 +61,9 @@ void BroadcastActor::init() {
     // print_on_create(this, "BroadcastActor");
     // print_on_exit(this, "BroadcastActor");
 
-    set_default_handler(
-        [this](caf::scheduled_actor *, caf::message &msg) -> caf::skippable_result {
-            //  UNCOMMENT TO DEBUG UNEXPECT MESSAGES
-
-            // spdlog::warn("Got broadcast from {} {}", to_string(current_sender()),
-            //     to_string(msg)
-            // );
-
-            if (current_sender() == nullptr or not current_sender()) {
-                for (const auto &i : subscribers_) {
-                    // spdlog::warn("{} {} Anon Forward {}",
-                    // to_string(caf::actor_cast<caf::actor>(this)),
-                    // to_string(current_sender()), to_string(caf::actor_cast<caf::actor>(i)));
-                    try {
-                        send(caf::actor_cast<caf::actor>(i), msg);
-                    } catch (...) {
-                    }
-                }
-            } else {
-                for (const auto &i : subscribers_) {
-                    // we need to send as if we were delegating..
-                    try {
-                        // spdlog::warn("{} {} Forward to {}",
-                        // to_string(caf::actor_cast<caf::actor>(this)),
-                        // to_string(current_sender()),
-                        // to_string(caf::actor_cast<caf::actor>(i)));
-
-                        send_as(
-                            caf::actor_cast<caf::actor>(current_sender()),
-                            caf::actor_cast<caf::actor>(i),
-                            msg);
-                    } catch (...) {
-                    }
-                }
-            }
-            return message{};
-        });
+    set_default_handler([this](caf::scheduled_actor *self, caf::message &msg) {
+        return broadcast_message(self, msg);
+    });
 
     set_down_handler([=](down_msg &msg) {
         // owner gone time to die..
@@ -91,6 +80,7 @@ void BroadcastActor::init() {
             if (subscribers_.count(subscriber)) {
                 demonitor(msg.source);
                 subscribers_.erase(subscriber);
+                coalesced_.erase(subscriber);
                 // spdlog::warn("subscriber dead {} {}",
                 // to_string(caf::actor_cast<caf::actor>(this)),to_string(subscriber));
             }
@@ -100,51 +90,203 @@ void BroadcastActor::init() {
     behavior_.assign(
         [=](xstudio::broadcast::broadcast_down_atom, const caf::actor_addr &) {},
         [=](leave_broadcast_atom) -> bool {
-            auto subscriber = caf::actor_cast<caf::actor_addr>(current_sender());
-            if (subscribers_.count(subscriber)) {
-                demonitor(current_sender());
-                subscribers_.erase(subscriber);
-                // spdlog::warn("subscriber leaving {} {}",
-                // to_string(caf::actor_cast<caf::actor>(this)),to_string(current_sender()));
-            }
-            return true;
+            return remove_subscriber(caf::actor_cast<caf::actor>(current_sender()));
         },
-        [=](leave_broadcast_atom, caf::actor sub) -> bool {
-            auto subscriber = caf::actor_cast<caf::actor_addr>(sub);
-            if (subscribers_.count(subscriber)) {
-                demonitor(sub);
-                subscribers_.erase(subscriber);
-                // spdlog::warn("subscriber leaving {} {}",
-                // to_string(caf::actor_cast<caf::actor>(this)),to_string(sub));
-            }
+        [=](leave_broadcast_atom, caf::actor sub) -> bool { return remove_subscriber(sub); },
+        [=](join_broadcast_atom) -> bool {
+            return add_subscriber(caf::actor_cast<caf::actor>(current_sender()));
+        },
+        [=](join_broadcast_atom, caf::actor sub) -> bool { return add_subscriber(sub); },
+        [=](join_broadcast_atom, caf::actor sub, const caf::timespan window) -> bool {
+            return add_subscriber(sub, window);
+        },
+
+        // only the latest of these is delivered per window, msg is an example
+        [=](supersede_broadcast_atom, const caf::message &msg) -> bool {
+            supersede_[msg.types()] = -1;
             return true;
         },
-        [=](join_broadcast_atom) -> bool {
-            auto subscriber = caf::actor_cast<caf::actor_addr>(current_sender());
-            if (not subscribers_.count(subscriber)) {
-                monitor(current_sender());
-                subscribers_.insert(subscriber);
-                // spdlog::warn("new subscriber {} {} {}",
-                // to_string(caf::actor_cast<caf::actor>(this)), to_string(current_sender()),
-                // to_string(subscriber));
-            }
+
+        // the latest for each value of element key_index
+        [=](supersede_broadcast_atom, const caf::message &msg, const int key_index)
+            -> result<bool> {
+            if (message_key(msg, key_index).empty())
+                return caf::make_error(caf::sec::invalid_argument);
+            supersede_[msg.types()] = key_index;
             return true;
         },
-        [=](join_broadcast_atom, caf::actor sub) -> bool {
-            auto subscriber = caf::actor_cast<caf::actor_addr>(sub);
 
-            if (not subscribers_.count(subscriber)) {
+        [=](broadcast_flush_atom, const caf::actor_addr &subscriber) { flush(subscriber); },
 
-                monitor(sub);
-                subscribers_.insert(subscriber);
-                // spdlog::warn("new subscriber {} {} {}",
-                // to_string(caf::actor_cast<caf::actor>(this)), to_string(sub),
-                // to_string(subscriber));
+        [=](broadcast_stats_atom) -> JsonStore {
+            auto result = JsonStore(R"({"groups": {}})"_json);
+
+            result["subscribers"] = subscribers_.size();
+            result["coalesced"]   = coalesced_.size();
+            result["flushes"]     = flushes_;
+            result["batches"]     = batches_;
+
+            for (const auto &[types, counters] : counters_) {
+                result["groups"][to_string(types)] = {
+                    {"in", counters.in},
+                    {"out", counters.out},
+                    {"superseded", counters.superseded}};
             }
-            return true;
+
+            return result;
         });
 }
 
+bool BroadcastActor::add_subscriber(const caf::actor &sub, const caf::timespan window) {
+    auto subscriber = caf::actor_cast<caf::actor_addr>(sub);
+
+    if (not subscribers_.count(subscriber)) {
+        monitor(sub);
+        subscribers_.insert(subscriber);
+    }
+
+    // rejoining changes mode, anything pending goes out first
+    if (coalesced_.count(subscriber))
+        flush(subscriber);
+
+    if (window.count() > 0)
+        coalesced_[subscriber].window = window;
+    else
+        coalesced_.erase(subscriber);
+
+    return true;
+}
+
+bool BroadcastActor::remove_subscriber(const caf::actor &sub) {
+    auto subscriber = caf::actor_cast<caf::actor_addr>(sub);
+
+    if (subscribers_.count(subscriber)) {
+        demonitor(sub);
+        subscribers_.erase(subscriber);
+        coalesced_.erase(subscriber);
+    }
+
+    return true;
+}
+
+caf::skippable_result
+BroadcastActor::broadcast_message(caf::scheduled_actor *, caf::message &msg) {
+    //  UNCOMMENT TO DEBUG UNEXPECT MESSAGES
+
+    // spdlog::warn("Got broadcast from {} {}", to_string(current_sender()),
+    //     to_string(msg)
+    // );
+
+    auto &counters = counters_[msg.types()];
+    counters.in++;
+
+    const auto anonymous = current_sender() == nullptr or not current_sender();
+
+    for (const auto &i : subscribers_) {
+        auto coalesced = coalesced_.find(i);
+        if (coalesced != std::end(coalesced_)) {
+            queue_message(i, coalesced->second, msg);
+            continue;
+        }
+
+        counters.out++;
+
+        try {
+            if (anonymous)
+                send(caf::actor_cast<caf::actor>(i), msg);
+            else
+                // we need to send as if we were delegating..
+                send_as(
+                    caf::actor_cast<caf::actor>(current_sender()),
+                    caf::actor_cast<caf::actor>(i),
+                    msg);
+        } catch (...) {
+        }
+    }
+
+    return message{};
+}
+
+void BroadcastActor::queue_message(
+    const caf::actor_addr &subscriber,
+    CoalescedSubscriber &coalesced,
+    const caf::message &msg) {
+
+    const auto sender = caf::actor_cast<caf::actor_addr>(current_sender());
+
+    const auto supersede = supersede_.find(msg.types());
+    if (supersede != std::end(supersede_)) {
+        // drop the earlier instance, the new one goes on the end to keep
+        // ordering with other events.
+        auto [latest, inserted] = coalesced.latest.try_emplace(
+            SupersedeKey(sender, msg.types(), message_key(msg, supersede->second)),
+            coalesced.pending.size());
+        if (not inserted) {
+            counters_[msg.types()].superseded++;
+            coalesced.pending[latest->second].msg = caf::message();
+            latest->second = coalesced.pending.size();
+        }
+    }
+
+    coalesced.pending.push_back(Pending{sender, msg});
+
+    if (not coalesced.flush_queued) {
+        coalesced.flush_queued = true;
+        delayed_anon_send(this, coalesced.window, broadcast_flush_atom_v, subscriber);
+    }
+}
+
+void BroadcastActor::flush(const caf::actor_addr &subscriber) {
+    auto it = coalesced_.find(subscriber);
+    if (it == std::end(coalesced_))
+        return;
+
+    auto pending = std::move(it->second.pending);
+    it->second.pending.clear();
+    it->second.latest.clear();
+    it->second.flush_queued = false;
+
+    auto sub = caf::actor_cast<caf::actor>(subscriber);
+    if (not sub)
+        return;
+
+    // one batch per run of messages from the same sender, so the subscriber
+    // still sees who sent them.
+    std::vector<caf::message> batch;
+    caf::actor_addr sender;
+
+    auto send_batch = [&]() {
+        if (batch.empty())
+            return;
+
+        batches_++;
+        try {
+            if (auto from = caf::actor_cast<caf::actor>(sender))
+                send_as(from, sub, broadcast_batch_atom_v, std::move(batch));
+            else
+                anon_send(sub, broadcast_batch_atom_v, std::move(batch));
+        } catch (...) {
+        }
+        batch.clear();
+    };
+
+    for (auto &i : pending) {
+        if (i.msg.empty())
+            continue;
+
+        if (i.sender != sender) {
+            send_batch();
+            sender = i.sender;
+        }
+
+        counters_[i.msg.types()].out++;
+        batch.emplace_back(std::move(i.msg));
+    }
+
+    send_batch();
+    flushes_++;
+}
+
 void BroadcastActor::on_exit() {
     // spdlog::warn("notify subscribers or shutdown");
     for (const auto &i : subscribers_) {
@@ -156,6 +298,7 @@ void BroadcastActor::on_exit() {
         }
     }
     subscribers_.clear();
+    coalesced_.clear();
     // actor_count--;
     // spdlog::error("{} count {} actor_count {}", __PRETTY_FUNCTION__, count, actor_count);
 }
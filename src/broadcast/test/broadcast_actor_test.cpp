@@ -1,10 +1,13 @@
 // SPDX-License-Identifier: Apache-2.0
 #include <caf/all.hpp>
 #include <gtest/gtest.h>
+#include <map>
+#include <thread>
 
 #include "xstudio/atoms.hpp"
 #include "xstudio/broadcast/broadcast_actor.hpp"
 #include "xstudio/utility/helpers.hpp"
+#include "xstudio/utility/json_store.hpp"
 #include "xstudio/utility/uuid.hpp"
 
 using namespace xstudio;
@@ -87,3 +90,203 @@ TEST(BroadcastActorTest, Test) {
     f.self->anon_send(c, xstudio::broadcast::join_broadcast_atom_v);
     f.self->anon_send(b, xstudio::global_store::autosave_atom_v);
 }
+
+TEST(BroadcastActorTest, Coalesced) {
+    fixture f;
+    auto b = f.self->spawn<BroadcastActor>();
+
+    const auto sub = caf::actor_cast<caf::actor>(f.self);
+    const auto window = caf::timespan(std::chrono::milliseconds(16));
+    EXPECT_TRUE(request_receive<bool>(*(f.self), b, join_broadcast_atom_v, sub, window));
+
+    // only the latest change is wanted
+    EXPECT_TRUE(request_receive<bool>(
+        *(f.self),
+        b,
+        supersede_broadcast_atom_v,
+        make_message(utility::event_atom_v, utility::change_atom_v, 0)));
+
+    for (auto i = 0; i < 100; i++) {
+        f.self->send(b, utility::event_atom_v, utility::change_atom_v, i);
+        if (i % 10 == 0)
+            f.self->send(b, utility::event_atom_v, utility::name_atom_v, std::to_string(i));
+    }
+
+    // one batch, as if from us, with only the last change left
+    f.self->receive(
+        [&](broadcast_batch_atom, const std::vector<caf::message> &batch) {
+            ASSERT_EQ(batch.size(), size_t(11));
+            EXPECT_EQ(f.self->current_sender(), caf::actor_cast<caf::strong_actor_ptr>(sub));
+            EXPECT_EQ(batch.front().get_as<std::string>(2), "0");
+            EXPECT_EQ(batch[9].get_as<std::string>(2), "90");
+            EXPECT_EQ(batch.back().get_as<int>(2), 99);
+        },
+        caf::after(std::chrono::seconds(5)) >> [&]() { FAIL() << "No batch"; });
+
+    auto stats = request_receive<JsonStore>(*(f.self), b, broadcast_stats_atom_v);
+    EXPECT_EQ(stats["flushes"], 1);
+    EXPECT_EQ(stats["batches"], 1);
+    EXPECT_EQ(stats["coalesced"], 1);
+
+    const auto change = to_string(
+        make_message(utility::event_atom_v, utility::change_atom_v, 0).types());
+    EXPECT_EQ(stats["groups"][change]["in"], 100);
+    EXPECT_EQ(stats["groups"][change]["out"], 1);
+    EXPECT_EQ(stats["groups"][change]["superseded"], 99);
+
+    // back to direct delivery
+    EXPECT_TRUE(request_receive<bool>(*(f.self), b, join_broadcast_atom_v, sub));
+    f.self->send(b, utility::event_atom_v, utility::change_atom_v, 1);
+    f.self->receive(
+        [&](utility::event_atom, utility::change_atom, const int value) {
+            EXPECT_EQ(value, 1);
+        },
+        caf::after(std::chrono::seconds(5)) >> [&]() { FAIL() << "No event"; });
+
+    f.self->send_exit(b, caf::exit_reason::user_shutdown);
+}
+
+TEST(BroadcastActorTest, SupersedeByKey) {
+    fixture f;
+    auto b = f.self->spawn<BroadcastActor>();
+
+    const auto sub    = caf::actor_cast<caf::actor>(f.self);
+    const auto window = caf::timespan(std::chrono::milliseconds(16));
+    EXPECT_TRUE(request_receive<bool>(*(f.self), b, join_broadcast_atom_v, sub, window));
+
+    // the latest change per uuid is wanted
+    const auto example =
+        make_message(utility::event_atom_v, utility::change_atom_v, Uuid(), 0);
+    EXPECT_TRUE(
+        request_receive<bool>(*(f.self), b, supersede_broadcast_atom_v, example, 2));
+
+    // elements that can't be used as a key are refused
+    EXPECT_THROW(
+        request_receive<bool>(*(f.self), b, supersede_broadcast_atom_v, example, 0),
+        std::runtime_error);
+
+    const auto first  = Uuid::generate();
+    const auto second = Uuid::generate();
+    for (auto i = 0; i < 10; i++) {
+        f.self->send(b, utility::event_atom_v, utility::change_atom_v, first, i);
+        f.self->send(b, utility::event_atom_v, utility::change_atom_v, second, i + 100);
+    }
+
+    std::map<Uuid, int> latest;
+    f.self->receive(
+        [&](broadcast_batch_atom, const std::vector<caf::message> &batch) {
+            for (const auto &i : batch) {
+                const auto uuid = i.get_as<Uuid>(2);
+                EXPECT_EQ(latest.count(uuid), size_t(0));
+                latest[uuid] = i.get_as<int>(3);
+            }
+        },
+        caf::after(std::chrono::seconds(5)) >> [&]() { FAIL() << "No batch"; });
+    EXPECT_EQ(latest.size(), size_t(2));
+    EXPECT_EQ(latest[first], 9);
+    EXPECT_EQ(latest[second], 109);
+
+    auto stats = request_receive<JsonStore>(*(f.self), b, broadcast_stats_atom_v);
+    const auto change = to_string(example.types());
+    EXPECT_EQ(stats["groups"][change]["in"], 20);
+    EXPECT_EQ(stats["groups"][change]["out"], 2);
+    EXPECT_EQ(stats["groups"][change]["superseded"], 18);
+
+    f.self->send_exit(b, caf::exit_reason::user_shutdown);
+}
+
+TEST(BroadcastActorTest, Throughput) {
+    fixture f;
+    const size_t events      = 100000;
+    const size_t subscribers = 20;
+
+    struct Received {
+        std::atomic<size_t> messages{0};
+        std::atomic<size_t> batches{0};
+        // subscribers that were sent the last update
+        std::atomic<size_t> finished{0};
+    };
+
+    // 100k position updates fanned out to 20 subscribers, returns what each
+    // subscriber was sent
+    auto run = [&](const caf::timespan window, Received &received) {
+        auto b = f.self->spawn<BroadcastActor>();
+        EXPECT_TRUE(request_receive<bool>(
+            *(f.self),
+            b,
+            supersede_broadcast_atom_v,
+            make_message(utility::event_atom_v, utility::change_atom_v, 0)));
+
+        auto counts = &received;
+        std::vector<caf::actor> subs;
+        for (size_t i = 0; i < subscribers; i++) {
+            subs.push_back(f.self->spawn([counts](caf::event_based_actor *) -> caf::behavior {
+                return {
+                    [=](utility::event_atom, utility::change_atom, const int value) {
+                        counts->messages++;
+                        if (value == int(events - 1))
+                            counts->finished++;
+                    },
+                    [=](broadcast_batch_atom, const std::vector<caf::message> &batch) {
+                        counts->batches++;
+                        counts->messages += batch.size();
+                        if (batch.back().get_as<int>(2) == int(events - 1))
+                            counts->finished++;
+                    }};
+            }));
+            request_receive<bool>(*(f.self), b, join_broadcast_atom_v, subs.back(), window);
+        }
+
+        for (size_t i = 0; i < events; i++)
+            f.self->send(b, utility::event_atom_v, utility::change_atom_v, int(i));
+
+        // everything sent is in or out by the time this is answered, the
+        // final flush is a window later
+        auto stats = request_receive<JsonStore>(*(f.self), b, broadcast_stats_atom_v);
+        const auto group =
+            to_string(make_message(utility::event_atom_v, utility::change_atom_v, 0).types());
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+        while (stats["groups"][group]["out"].get<size_t>() +
+                       stats["groups"][group]["superseded"].get<size_t>() <
+                   events * subscribers and
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            stats = request_receive<JsonStore>(*(f.self), b, broadcast_stats_atom_v);
+        }
+
+        // and everything sent out has arrived
+        while (received.messages < stats["groups"][group]["out"].get<size_t>() and
+               std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        EXPECT_EQ(stats["groups"][group]["in"], events);
+        EXPECT_EQ(received.messages, stats["groups"][group]["out"].get<size_t>());
+        EXPECT_EQ(received.batches, stats["batches"].get<size_t>());
+
+        for (const auto &i : subs)
+            f.self->send_exit(i, caf::exit_reason::user_shutdown);
+        f.self->send_exit(b, caf::exit_reason::user_shutdown);
+
+        return stats["groups"][group];
+    };
+
+    // direct, every update reaches every subscriber
+    Received direct;
+    const auto direct_stats = run(caf::timespan(), direct);
+    EXPECT_EQ(direct.messages, events * subscribers);
+    EXPECT_EQ(direct.batches, size_t(0));
+    EXPECT_EQ(direct.finished, subscribers);
+    EXPECT_EQ(direct_stats["superseded"], 0);
+
+    // coalesced, each subscriber gets one update per batch, the last one
+    // being the latest
+    Received coalesced;
+    const auto coalesced_stats = run(caf::timespan(std::chrono::milliseconds(16)), coalesced);
+    EXPECT_GT(coalesced.batches, size_t(0));
+    EXPECT_EQ(coalesced.messages, coalesced.batches.load());
+    EXPECT_LT(coalesced.messages, events * subscribers / 100);
+    EXPECT_EQ(
+        coalesced_stats["out"].get<size_t>() + coalesced_stats["superseded"].get<size_t>(),
+        events * subscribers);
+    EXPECT_EQ(coalesced.finished, subscribers);
+}
@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: Apache-2.0
 #include <caf/io/all.hpp>
 #include <caf/policy/select_all.hpp>
+#include <functional>
+#include <future>
 #include <tuple>
 
 #include <fmt/chrono.h>
@@ -14,6 +16,7 @@
 #include "xstudio/colour_pipeline/colour_pipeline_actor.hpp"
 #include "xstudio/embedded_python/embedded_python_actor.hpp"
 #include "xstudio/global/global_actor.hpp"
+#include "xstudio/global/shm_transport.hpp"
 #include "xstudio/global_store/global_store.hpp"
 #include "xstudio/global_store/global_store_actor.hpp"
 #include "xstudio/media_cache/media_cache_actor.hpp"
@@ -29,8 +32,10 @@
 #include "xstudio/thumbnail/thumbnail_manager_actor.hpp"
 #include "xstudio/ui/model_data/model_data_actor.hpp"
 #include "xstudio/ui/viewport/keypress_monitor.hpp"
+#include "xstudio/utility/chrono.hpp"
 #include "xstudio/utility/helpers.hpp"
 #include "xstudio/utility/logging.hpp"
+#include "xstudio/utility/session_file.hpp"
 
 using namespace caf;
 using namespace xstudio;
@@ -38,11 +43,54 @@ using namespace xstudio::global;
 using namespace xstudio::utility;
 using namespace xstudio::global_store;
 
+namespace {
+// Spawns a stage of the global actors, each on its own thread so their
+// constructors overlap. Most of them spend their time waiting on the global
+// store and plugin manager.
+void spawn_stage(
+    const int stage,
+    const std::vector<std::pair<std::string, std::function<caf::actor()>>> &spawns,
+    const utility::time_point &startup,
+    std::map<std::string, caf::actor> &actors,
+    JsonStore &timings) {
+
+    const auto seconds = [](const utility::clock::duration &d) {
+        return std::chrono::duration<double>(d).count();
+    };
+
+    std::vector<std::future<std::pair<caf::actor, nlohmann::json>>> futures;
+    for (const auto &i : spawns) {
+        futures.emplace_back(std::async(std::launch::async, [=]() {
+            const auto start = utility::clock::now();
+            auto actor       = i.second();
+            const auto end   = utility::clock::now();
+            return std::make_pair(
+                actor,
+                nlohmann::json{
+                    {"name", i.first},
+                    {"stage", stage},
+                    {"start", seconds(start - startup)},
+                    {"duration", seconds(end - start)}});
+        }));
+    }
+
+    for (size_t i = 0; i < spawns.size(); i++) {
+        auto result             = futures[i].get();
+        actors[spawns[i].first] = result.first;
+        timings["actors"].push_back(result.second);
+        spdlog::debug(
+            "Started {} in {:.3f}s", spawns[i].first, result.second["duration"].get<double>());
+    }
+}
+} // namespace
+
 GlobalActor::GlobalActor(caf::actor_config &cfg, const utility::JsonStore &prefs)
     : caf::event_based_actor(cfg), rsm_(remote_session_path()) {
     init(prefs);
 }
 
+GlobalActor::~GlobalActor() = default;
+
 int GlobalActor::publish_port(
     const int minimum, const int maximum, const std::string &bind_address, caf::actor a) {
     int port = -1;
@@ -69,65 +117,122 @@ void GlobalActor::init(const utility::JsonStore &prefs) {
 
     system().registry().put(global_registry, this);
 
+    // The global actors are created in stages. An actor only depends on the
+    // ones in earlier stages, the actors within a stage are created at the
+    // same time. How long each took is kept for the startup report.
+    const auto startup = utility::clock::now();
+    startup_timings_   = JsonStore(nlohmann::json{{"actors", nlohmann::json::array()}});
+    std::map<std::string, caf::actor> actors;
+    int stage = 0;
+
     // spawning the 'GlobalModuleAttrEventsActor' first because subsequent
     // actors might want to connect with it on creation .. see Module::connect_to_ui()
-    auto attr_evs = spawn<module::GlobalModuleAttrEventsActor>();
-    auto gsa      = caf::actor();
-
-    if (prefs.is_null()) {
-        gsa = spawn<global_store::GlobalStoreActor>(
-            "GlobalStore",
-            global_store::global_store_builder(
-                std::vector<std::string>{xstudio_root("/preference")}));
-    } else {
-        gsa = spawn<global_store::GlobalStoreActor>("GlobalStore", prefs);
-    }
-
-    auto sga             = spawn<sync::SyncGatewayActor>();
-    auto sgma            = spawn<sync::SyncGatewayManagerActor>();
-    auto pm              = spawn<plugin_manager::PluginManagerActor>();
-    auto colour          = spawn<colour_pipeline::GlobalColourPipelineActor>();
-    auto gmma            = spawn<media_metadata::GlobalMediaMetadataActor>();
-    auto gica            = spawn<media_cache::GlobalImageCacheActor>();
-    auto gaca            = spawn<media_cache::GlobalAudioCacheActor>();
-    auto gmra            = spawn<media_reader::GlobalMediaReaderActor>();
-    auto gcca            = spawn<colour_pipeline::GlobalColourCacheActor>();
-    auto gmha            = spawn<media_hook::GlobalMediaHookActor>();
-    auto thumbnail       = spawn<thumbnail::ThumbnailManagerActor>();
-    auto keyboard_events = spawn<ui::keypress_monitor::KeypressMonitor>();
-    auto audio           = spawn<audio::AudioOutputControlActor>();
-    auto phev            = spawn<playhead::PlayheadGlobalEventsActor>();
-    auto pa              = spawn<embedded_python::EmbeddedPythonActor>("Python");
-    auto scanner         = spawn<scanner::ScannerActor>();
-    auto ui_models       = spawn<ui::model_data::GlobalUIModelData>();
-
-    link_to(colour);
-    link_to(sga);
-    link_to(sgma);
-    link_to(pm);
-    link_to(gsa);
-    link_to(gmma);
-    link_to(gmra);
-    link_to(gica);
-    link_to(gaca);
-    link_to(gcca);
-    link_to(gmha);
-    link_to(pa);
-    link_to(scanner);
-    link_to(audio);
-    link_to(thumbnail);
-    link_to(attr_evs);
-    link_to(keyboard_events);
-    link_to(phev);
-    link_to(ui_models);
-
-    python_enabled_ = false;
-    connected_      = false;
-    api_enabled_    = false;
-    port_           = -1;
-    port_minimum_   = 12345;
-    port_maximum_   = 12345;
-    bind_address_   = "127.0.0.1";
+    spawn_stage(
+        stage++,
+        {{"module_attr_events",
+          [=]() { return system().spawn<module::GlobalModuleAttrEventsActor>(); }}},
+        startup,
+        actors,
+        startup_timings_);
+
+    // preferences next, everything reads them
+    spawn_stage(
+        stage++,
+        {{"global_store",
+          [=]() {
+              if (prefs.is_null())
+                  return system().spawn<global_store::GlobalStoreActor>(
+                      "GlobalStore",
+                      global_store::global_store_builder(
+                          std::vector<std::string>{xstudio_root("/preference")}));
+              return system().spawn<global_store::GlobalStoreActor>("GlobalStore", prefs);
+          }}},
+        startup,
+        actors,
+        startup_timings_);
+
+    spawn_stage(
+        stage++,
+        {{"sync_gateway", [=]() { return system().spawn<sync::SyncGatewayActor>(); }},
+         {"sync_gateway_manager",
+          [=]() { return system().spawn<sync::SyncGatewayManagerActor>(); }},
+         {"plugin_manager",
+          [=]() { return system().spawn<plugin_manager::PluginManagerActor>(); }},
+         {"image_cache",
+          [=]() { return system().spawn<media_cache::GlobalImageCacheActor>(); }},
+         {"audio_cache",
+          [=]() { return system().spawn<media_cache::GlobalAudioCacheActor>(); }},
+         {"colour_cache",
+          [=]() { return system().spawn<colour_pipeline::GlobalColourCacheActor>(); }},
+         {"keyboard_events",
+          [=]() { return system().spawn<ui::keypress_monitor::KeypressMonitor>(); }},
+         {"playhead_events",
+          [=]() { return system().spawn<playhead::PlayheadGlobalEventsActor>(); }},
+         {"scanner", [=]() { return system().spawn<scanner::ScannerActor>(); }},
+         {"ui_models", [=]() { return system().spawn<ui::model_data::GlobalUIModelData>(); }}},
+        startup,
+        actors,
+        startup_timings_);
+
+    // these enumerate and spawn plugins
+    spawn_stage(
+        stage++,
+        {{"colour_pipeline",
+          [=]() { return system().spawn<colour_pipeline::GlobalColourPipelineActor>(); }},
+         {"media_metadata",
+          [=]() { return system().spawn<media_metadata::GlobalMediaMetadataActor>(); }},
+         {"media_hook", [=]() { return system().spawn<media_hook::GlobalMediaHookActor>(); }},
+         {"audio_output", [=]() { return system().spawn<audio::AudioOutputControlActor>(); }},
+         {"python",
+          [=]() { return system().spawn<embedded_python::EmbeddedPythonActor>("Python"); }}},
+        startup,
+        actors,
+        startup_timings_);
+
+    // wants the caches and the colour pipeline
+    spawn_stage(
+        stage++,
+        {{"media_reader",
+          [=]() { return system().spawn<media_reader::GlobalMediaReaderActor>(); }}},
+        startup,
+        actors,
+        startup_timings_);
+
+    // wants the media reader
+    spawn_stage(
+        stage++,
+        {{"thumbnail", [=]() { return system().spawn<thumbnail::ThumbnailManagerActor>(); }}},
+        startup,
+        actors,
+        startup_timings_);
+
+    for (const auto &i : actors)
+        link_to(i.second);
+
+    auto gsa       = actors.at("global_store");
+    auto sga       = actors.at("sync_gateway");
+    auto sgma      = actors.at("sync_gateway_manager");
+    auto pm        = actors.at("plugin_manager");
+    auto colour    = actors.at("colour_pipeline");
+    auto gica      = actors.at("image_cache");
+    auto gaca      = actors.at("audio_cache");
+    auto thumbnail = actors.at("thumbnail");
+    auto phev      = actors.at("playhead_events");
+    auto pa        = actors.at("python");
+    auto scanner   = actors.at("scanner");
+
+    startup_timings_["total"] =
+        std::chrono::duration<double>(utility::clock::now() - startup).count();
+    spdlog::info("Global actors started in {:.3f}s", startup_timings_["total"].get<double>());
+
+    python_enabled_        = false;
+    connected_             = false;
+    api_enabled_           = false;
+    port_                  = -1;
+    port_minimum_          = 12345;
+    port_maximum_          = 12345;
+    bind_address_          = "127.0.0.1";
+    shm_transport_enabled_ = true;
 
     sync_connected_    = false;
     sync_api_enabled_  = false;
@@ -189,6 +294,16 @@ void GlobalActor::init(const utility::JsonStore &prefs) {
             }
         },
 
+        [=](shm_transport_atom) -> std::string {
+            return shm_transport_ ? shm_transport_->path() : std::string();
+        },
+
+        [=](shm_transport_atom, const std::string &token, const caf::actor &client) -> bool {
+            return shm_transport_ and shm_transport_->bind_client(token, client);
+        },
+
+        [=](startup_timings_atom) -> JsonStore { return startup_timings_; },
+
         [=](status_atom) -> StatusType { return status_; },
 
         [=](status_atom, const StatusType field, const bool set) mutable -> StatusType {
@@ -248,9 +363,12 @@ void GlobalActor::init(const utility::JsonStore &prefs) {
 
                                                 // add timestamp+ext
                                                 auto session_fullname = std::string(fmt::format(
-                                                    "{}_{:%Y%m%d_%H%M%S}.xst",
+                                                    "{}_{:%Y%m%d_%H%M%S}{}",
                                                     session_name,
-                                                    fmt::localtime(std::time(nullptr))));
+                                                    fmt::localtime(std::time(nullptr)),
+                                                    session_autosave_binary_
+                                                        ? session_container_extension
+                                                        : session_json_extension));
 
                                                 // build path to autosave store.
                                                 auto fspath = fs::path(uri_to_posix_path(
@@ -381,6 +499,8 @@ void GlobalActor::init(const utility::JsonStore &prefs) {
                 port_minimum_   = preference_value<int>(j, "/core/api/port_minimum");
                 port_maximum_   = preference_value<int>(j, "/core/api/port_maximum");
                 bind_address_   = preference_value<std::string>(j, "/core/api/bind_address");
+                shm_transport_enabled_ =
+                    preference_value<bool>(j, "/core/api/shared_memory_transport");
 
                 sync_api_enabled_  = preference_value<bool>(j, "/core/sync/enabled");
                 sync_port_minimum_ = preference_value<int>(j, "/core/sync/port_minimum");
@@ -390,6 +510,8 @@ void GlobalActor::init(const utility::JsonStore &prefs) {
 
                 session_autosave_interval_ =
                     preference_value<int>(j, "/core/session/autosave/interval");
+                session_autosave_binary_ =
+                    preference_value<bool>(j, "/core/session/autosave/binary");
                 try {
                     session_autosave_path_ = posix_path_to_uri(expand_envvars(
                         preference_value<std::string>(j, "/core/session/autosave/path")));
@@ -458,6 +580,7 @@ void GlobalActor::on_exit() {
     auto prefs = global_store::GlobalStoreHelper(system());
     prefs.set_value("", "/core/session/autosave/last_auto_save", false);
     prefs.save("APPLICATION");
+    shm_transport_.reset();
     if (system().has_middleman()) {
         system().middleman().unpublish(actor_cast<actor>(this), port_);
         system().middleman().unpublish(actor_cast<actor>(this), sync_port_);
@@ -481,6 +604,16 @@ void GlobalActor::connect_api(const caf::actor &embedded_python) {
                 port_,
                 remote_api_session_name_);
             connected_ = true;
+
+            if (shm_transport_enabled_) {
+                try {
+                    shm_transport_ = std::make_unique<ShmTransportServer>(system());
+                    spdlog::debug("API shared memory transport on {}", shm_transport_->path());
+                } catch (const std::exception &err) {
+                    spdlog::warn("{} {}", __PRETTY_FUNCTION__, err.what());
+                }
+            }
+
             if (python_enabled_) {
                 // request(pa, infinite, connect_atom_v,
                 // actor_cast<actor>(this)).then(
@@ -552,6 +685,7 @@ void GlobalActor::disconnect_api(const caf::actor &embedded_python, const bool f
             send(event_group_, api_exit_atom_v);
 
             // wait..?
+            shm_transport_.reset();
             system().middleman().unpublish(actor_cast<actor>(this), port_);
             rsm_.remove_session(remote_api_session_name_);
             spdlog::info("API disabled on port {}", port_);
@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <caf/all.hpp>
+
+#include "xstudio/atoms.hpp"
+#include "xstudio/caf_error.hpp"
+#include "xstudio/global/shm_transport.hpp"
+#include "xstudio/utility/logging.hpp"
+
+using namespace caf;
+using namespace xstudio;
+using namespace xstudio::global;
+using namespace xstudio::utility;
+
+namespace {
+struct PendingRequest {
+    uint64_t client_id;
+    strong_actor_ptr destination;
+};
+} // namespace
+
+struct ShmTransportServer::Connection {
+    Connection(actor_system &system, ShmChannelPtr channel)
+        : channel_(std::move(channel)),
+          self_(system),
+          reply_to_(actor_cast<strong_actor_ptr>(self_)),
+          last_request_id_(self_->new_request_id(message_priority::normal).integer_value()) {}
+
+    // Requests go out in the name of self_ so the responses come back to it,
+    // but only the response thread touches it. The request thread numbers
+    // requests on from an id self_ gave us, which keeps its category bits.
+    message_id next_request_id() { return make_message_id(++last_request_id_); }
+
+    ShmChannelPtr channel_;
+    scoped_actor self_;
+    const strong_actor_ptr reply_to_;
+    std::atomic<uint64_t> last_request_id_;
+    actor client_;
+    std::mutex mutex_;
+    std::map<uint64_t, PendingRequest> pending_;
+    std::thread request_thread_;
+    std::thread response_thread_;
+    std::atomic<bool> running_{true};
+};
+
+ShmTransportServer::ShmTransportServer(actor_system &system, const size_t capacity)
+    : system_(system), listener_("", capacity) {
+    accept_thread_ = std::thread(&ShmTransportServer::accept_loop, this);
+}
+
+ShmTransportServer::~ShmTransportServer() {
+    listener_.close();
+    if (accept_thread_.joinable())
+        accept_thread_.join();
+    reap_connections(true);
+}
+
+bool ShmTransportServer::bind_client(const std::string &token, const caf::actor &client) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = connections_.find(token);
+    if (it == connections_.end())
+        return false;
+
+    std::lock_guard<std::mutex> conn_lock(it->second->mutex_);
+    it->second->client_ = client;
+    return true;
+}
+
+void ShmTransportServer::reap_connections(const bool all) {
+    std::vector<std::shared_ptr<Connection>> finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = connections_.begin(); it != connections_.end();) {
+            if (all or not it->second->running_) {
+                finished.push_back(it->second);
+                it = connections_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (auto &connection : finished) {
+        connection->running_ = false;
+        connection->channel_->close();
+        if (connection->request_thread_.joinable())
+            connection->request_thread_.join();
+        if (connection->response_thread_.joinable())
+            connection->response_thread_.join();
+    }
+}
+
+void ShmTransportServer::accept_loop() {
+    while (auto channel = listener_.accept()) {
+        reap_connections();
+
+        auto connection = std::make_shared<Connection>(system_, channel);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            connections_[channel->token()] = connection;
+        }
+        connection->request_thread_ =
+            std::thread(&ShmTransportServer::request_loop, this, connection);
+        connection->response_thread_ =
+            std::thread(&ShmTransportServer::response_loop, this, connection);
+
+        spdlog::debug("Shared memory API client connected");
+    }
+}
+
+void ShmTransportServer::request_loop(std::shared_ptr<Connection> connection) {
+    std::vector<std::byte> frame;
+    std::vector<std::byte> reply;
+
+    while (connection->channel_->receive(frame)) {
+        uint64_t client_id = 0;
+        actor_id dest_id   = 0;
+        message msg;
+
+        if (not decode_shm_frame(frame, client_id, dest_id, msg)) {
+            spdlog::warn("{} Failed to decode shared memory request", __PRETTY_FUNCTION__);
+            connection->channel_->acknowledge();
+            continue;
+        }
+
+        auto dest = system_.registry().get(dest_id);
+        if (not dest) {
+            auto err = make_message(make_error(xstudio_error::error, "Unknown actor"));
+            if (encode_shm_frame(reply, client_id, 0, err))
+                connection->channel_->send(reply);
+            connection->channel_->acknowledge();
+            continue;
+        }
+
+        const auto mid = connection->next_request_id();
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex_);
+            connection->pending_[mid.request_id().integer_value()] =
+                PendingRequest{client_id, dest};
+        }
+        dest->enqueue(
+            make_mailbox_element(connection->reply_to_, mid, {}, std::move(msg)),
+            nullptr);
+
+        // the request is in the destination's mailbox, anything the client
+        // sends through the middleman from now on can't overtake it.
+        connection->channel_->acknowledge();
+    }
+
+    connection->running_ = false;
+    spdlog::debug("Shared memory API client disconnected");
+}
+
+void ShmTransportServer::response_loop(std::shared_ptr<Connection> connection) {
+    std::vector<std::byte> reply;
+
+    while (connection->running_) {
+        if (not connection->self_->await_data(
+                std::chrono::system_clock::now() + std::chrono::milliseconds(100)))
+            continue;
+
+        auto element = connection->self_->next_message();
+        if (not element or not element->mid.is_response())
+            continue;
+
+        PendingRequest request;
+        actor client;
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex_);
+            auto it = connection->pending_.find(element->mid.request_id().integer_value());
+            if (it == connection->pending_.end())
+                continue;
+            request = it->second;
+            client  = connection->client_;
+            connection->pending_.erase(it);
+        }
+
+        auto &msg = element->content();
+        if (encode_shm_frame(reply, request.client_id, 0, msg)) {
+            connection->channel_->send(reply);
+        } else if (client) {
+            // holds actor handles, let the middleman deal with it.
+            client->enqueue(
+                make_mailbox_element(
+                    request.destination,
+                    make_message_id(request.client_id).response_id(),
+                    {},
+                    std::move(msg)),
+                nullptr);
+        } else {
+            auto err = make_message(make_error(
+                xstudio_error::error, "Response not serialisable, transport not bound"));
+            if (encode_shm_frame(reply, request.client_id, 0, err))
+                connection->channel_->send(reply);
+        }
+    }
+}
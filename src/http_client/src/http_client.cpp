@@ -5,3 +5,109 @@
 
 using namespace xstudio::http_client;
 using namespace xstudio::utility;
+
+ConnectionPool::ConnectionPool(
+    time_t connection_timeout,
+    time_t read_timeout,
+    time_t write_timeout,
+    size_t max_idle_per_host)
+    : connection_timeout_(connection_timeout),
+      read_timeout_(read_timeout),
+      write_timeout_(write_timeout),
+      max_idle_per_host_(max_idle_per_host) {}
+
+std::unique_ptr<httplib::Client>
+ConnectionPool::acquire(const std::string &scheme_host_port) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &idle = idle_[scheme_host_port];
+        if (not idle.empty()) {
+            auto client = std::move(idle.back());
+            idle.pop_back();
+            return client;
+        }
+    }
+
+    // https clients set up an SSL context, so not under the lock
+    auto client = std::make_unique<httplib::Client>(scheme_host_port.c_str());
+    client->set_follow_location(true);
+    client->set_keep_alive(true);
+    // otherwise small requests on a reused connection wait on delayed acks
+    client->set_tcp_nodelay(true);
+    client->set_decompress(true);
+    client->set_connection_timeout(connection_timeout_, 0);
+    client->set_read_timeout(read_timeout_, 0);
+    client->set_write_timeout(write_timeout_, 0);
+    return client;
+}
+
+void ConnectionPool::release(
+    const std::string &scheme_host_port,
+    std::unique_ptr<httplib::Client> client,
+    const bool reused,
+    const bool ok,
+    const std::chrono::steady_clock::duration latency) {
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto &m = metrics_[scheme_host_port];
+    m.requests++;
+    if (reused)
+        m.reused++;
+    else
+        m.connections++;
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency);
+    m.total_latency += us;
+    m.max_latency = std::max(m.max_latency, us);
+
+    // the connection may be in any state after an error, start again
+    if (not ok) {
+        m.errors++;
+        return;
+    }
+
+    auto &idle = idle_[scheme_host_port];
+    if (idle.size() < max_idle_per_host_)
+        idle.emplace_back(std::move(client));
+}
+
+httplib::Headers ConnectionPool::accept_compressed(const httplib::Headers &headers) {
+    auto result = headers;
+    if (result.find("Accept-Encoding") == result.end())
+        result.emplace("Accept-Encoding", "gzip, deflate");
+    return result;
+}
+
+std::map<std::string, ConnectionPool::HostMetrics> ConnectionPool::host_metrics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return metrics_;
+}
+
+JsonStore ConnectionPool::metrics() const {
+    JsonStore result(nlohmann::json::object());
+    for (const auto &[host, m] : host_metrics()) {
+        nlohmann::json j;
+        j["requests"]        = m.requests;
+        j["connections"]     = m.connections;
+        j["reused"]          = m.reused;
+        j["errors"]          = m.errors;
+        j["idle"]            = idle(host);
+        j["max_latency_ms"]  = m.max_latency.count() / 1000.0;
+        j["mean_latency_ms"] = 0.0;
+        if (m.requests)
+            j["mean_latency_ms"] = m.total_latency.count() / (1000.0 * m.requests);
+        result[host] = j;
+    }
+    return result;
+}
+
+size_t ConnectionPool::idle(const std::string &scheme_host_port) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = idle_.find(scheme_host_port);
+    return it == idle_.end() ? 0 : it->second.size();
+}
+
+void ConnectionPool::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_.clear();
+}
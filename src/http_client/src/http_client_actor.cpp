@@ -60,11 +60,7 @@ std::string HTTPWorker::get_error_string(const httplib::Error err) {
     return "Unknown";
 }
 
-HTTPWorker::HTTPWorker(
-    caf::actor_config &cfg,
-    time_t connection_timeout,
-    time_t read_timeout,
-    time_t write_timeout)
+HTTPWorker::HTTPWorker(caf::actor_config &cfg, std::shared_ptr<ConnectionPool> connections)
     : caf::event_based_actor(cfg) {
     behavior_.assign(
         [=](xstudio::broadcast::broadcast_down_atom, const caf::actor_addr &) {},
@@ -75,16 +71,12 @@ HTTPWorker::HTTPWorker(
             const std::string &body,
             const std::string &content_type) -> result<httplib::Response> {
             try {
-                httplib::Client cli(scheme_host_port.c_str());
-                cli.set_follow_location(true);
-                cli.set_connection_timeout(connection_timeout, 0);
-                cli.set_read_timeout(read_timeout, 0);
-                cli.set_write_timeout(write_timeout, 0);
-                auto res = [&]() -> httplib::Result {
+                auto res = connections->send(scheme_host_port, [&](httplib::Client &cli) {
+                    const auto h = ConnectionPool::accept_compressed(headers);
                     if (content_type.empty())
-                        return cli.Delete(path.c_str(), headers);
-                    return cli.Delete(path.c_str(), headers, body, content_type.c_str());
-                }();
+                        return cli.Delete(path.c_str(), h);
+                    return cli.Delete(path.c_str(), h, body, content_type.c_str());
+                });
 
                 if (res.error() != httplib::Error::Success)
                     return make_error(hce::rest_error, get_error_string(res.error()));
@@ -134,17 +126,14 @@ HTTPWorker::HTTPWorker(
             const httplib::Headers &headers,
             const httplib::Params &params) -> result<httplib::Response> {
             try {
-                httplib::Client cli(scheme_host_port.c_str());
-                cli.set_follow_location(true);
-                cli.set_connection_timeout(connection_timeout, 0);
-                cli.set_read_timeout(read_timeout, 0);
-                cli.set_write_timeout(write_timeout, 0);
-
                 // cli.set_logger([](const auto& req, const auto& res) {
                 //     spdlog::warn("{}", req.);
                 // });
 
-                auto result = cli.Get(path.c_str(), params, headers);
+                auto result = connections->send(scheme_host_port, [&](httplib::Client &cli) {
+                    return cli.Get(
+                        path.c_str(), params, ConnectionPool::accept_compressed(headers));
+                });
 
                 if (result.error() != httplib::Error::Success) {
                     auto error = get_error_string(result.error());
@@ -203,16 +192,12 @@ HTTPWorker::HTTPWorker(
             const std::string &body,
             const std::string &content_type) -> result<httplib::Response> {
             try {
-                httplib::Client cli(scheme_host_port.c_str());
-                cli.set_follow_location(true);
-                cli.set_connection_timeout(connection_timeout, 0);
-                cli.set_read_timeout(read_timeout, 0);
-                cli.set_write_timeout(write_timeout, 0);
-                auto res = [&]() -> httplib::Result {
+                auto res = connections->send(scheme_host_port, [&](httplib::Client &cli) {
+                    const auto h = ConnectionPool::accept_compressed(headers);
                     if (content_type.empty())
-                        return cli.Post(path.c_str(), headers, params);
-                    return cli.Post(path.c_str(), headers, body, content_type.c_str());
-                }();
+                        return cli.Post(path.c_str(), h, params);
+                    return cli.Post(path.c_str(), h, body, content_type.c_str());
+                });
 
                 if (res.error() != httplib::Error::Success)
                     return make_error(hce::rest_error, get_error_string(res.error()));
@@ -266,16 +251,12 @@ HTTPWorker::HTTPWorker(
             const std::string &body,
             const std::string &content_type) -> result<httplib::Response> {
             try {
-                httplib::Client cli(scheme_host_port.c_str());
-                cli.set_follow_location(true);
-                cli.set_connection_timeout(connection_timeout, 0);
-                cli.set_read_timeout(read_timeout, 0);
-                cli.set_write_timeout(write_timeout, 0);
-                auto res = [&]() -> httplib::Result {
+                auto res = connections->send(scheme_host_port, [&](httplib::Client &cli) {
+                    const auto h = ConnectionPool::accept_compressed(headers);
                     if (content_type.empty())
-                        return cli.Put(path.c_str(), headers, params);
-                    return cli.Put(path.c_str(), headers, body, content_type.c_str());
-                }();
+                        return cli.Put(path.c_str(), h, params);
+                    return cli.Put(path.c_str(), h, body, content_type.c_str());
+                });
 
                 if (res.error() != httplib::Error::Success)
                     return make_error(hce::rest_error, get_error_string(res.error()));
@@ -326,16 +307,42 @@ HTTPClientActor::HTTPClientActor(
     caf::actor_config &cfg,
     time_t connection_timeout,
     time_t read_timeout,
-    time_t write_timeout)
+    time_t write_timeout,
+    size_t max_per_host)
     : caf::event_based_actor(cfg),
       connection_timeout_(connection_timeout),
       read_timeout_(read_timeout),
-      write_timeout_(write_timeout) {
+      write_timeout_(write_timeout),
+      max_per_host_(max_per_host) {
+    if (not max_per_host_)
+        max_per_host_ = worker_count_;
     init();
 }
 
+template <typename T, typename Atom, typename... Ts>
+caf::result<T> HTTPClientActor::schedule(
+    const int priority, Atom atom, const std::string &scheme_host_port, Ts... xs) {
+    auto rp = make_response_promise<T>();
+
+    auto send = [=](caf::actor &worker) mutable {
+        request(worker, infinite, atom, scheme_host_port, xs...)
+            .then(
+                [=](const T &response) mutable {
+                    rp.deliver(response);
+                    finished(scheme_host_port);
+                },
+                [=](error &err) mutable {
+                    rp.deliver(std::move(err));
+                    finished(scheme_host_port);
+                });
+    };
+    pending_.emplace_back(Pending{priority, scheme_host_port, send});
+    dispatch();
+
+    return rp;
+}
+
 void HTTPClientActor::init() {
-    size_t worker_count = 10;
     spdlog::debug("Created HTTPClientActor");
     print_on_exit(this, "HTTPClientActor");
 
@@ -346,29 +353,45 @@ void HTTPClientActor::init() {
     // 	worker_count = preference_value<size_t>(j, "/core/media_hook/max_worker_count");
     // } catch(...) {
     // }
-    auto pool = caf::actor_pool::make(
+    connections_ =
+        std::make_shared<ConnectionPool>(connection_timeout_, read_timeout_, write_timeout_);
+
+    pool_ = caf::actor_pool::make(
         system().dummy_execution_unit(),
-        worker_count,
-        [&] {
-            return system().spawn<HTTPWorker>(
-                connection_timeout_, read_timeout_, write_timeout_);
-        },
+        worker_count_,
+        [&] { return system().spawn<HTTPWorker>(connections_); },
         caf::actor_pool::round_robin());
-    link_to(pool);
+    link_to(pool_);
 
     behavior_.assign(
         [=](xstudio::broadcast::broadcast_down_atom, const caf::actor_addr &) {},
+
+        [=](http_metrics_atom) -> JsonStore {
+            std::map<std::string, size_t> queued;
+            for (const auto &i : pending_)
+                queued[i.scheme_host_port]++;
+
+            auto result = connections_->metrics();
+            for (const auto &i : in_flight_)
+                result[i.first]["in_flight"] = i.second;
+            for (const auto &i : queued)
+                result[i.first]["queued"] = i.second;
+            return result;
+        },
+
         [=](http_delete_atom atom,
             const std::string &scheme_host_port,
             const std::string &path) {
-            return delegate(pool, atom, scheme_host_port, path, httplib::Headers(), "", "");
+            return schedule<httplib::Response>(
+                0, atom, scheme_host_port, path, httplib::Headers(), "", "");
         },
 
         [=](http_delete_atom atom,
             const std::string &scheme_host_port,
             const std::string &path,
             const httplib::Headers &headers) {
-            return delegate(pool, atom, scheme_host_port, path, headers, "", "");
+            return schedule<httplib::Response>(
+                0, atom, scheme_host_port, path, headers, "", "");
         },
 
         [=](http_delete_atom atom,
@@ -377,20 +400,33 @@ void HTTPClientActor::init() {
             const httplib::Headers &headers,
             const std::string &body,
             const std::string &content_type) {
-            return delegate(pool, atom, scheme_host_port, path, headers, body, content_type);
+            return schedule<httplib::Response>(
+                0, atom, scheme_host_port, path, headers, body, content_type);
+        },
+
+        [=](http_delete_atom atom,
+            const std::string &scheme_host_port,
+            const std::string &path,
+            const httplib::Headers &headers,
+            const std::string &body,
+            const std::string &content_type,
+            const int priority) {
+            return schedule<httplib::Response>(
+                priority, atom, scheme_host_port, path, headers, body, content_type);
         },
 
         [=](http_delete_simple_atom atom,
             const std::string &scheme_host_port,
             const std::string &path) {
-            return delegate(pool, atom, scheme_host_port, path, httplib::Headers(), "", "");
+            return schedule<std::string>(
+                0, atom, scheme_host_port, path, httplib::Headers(), "", "");
         },
 
         [=](http_delete_simple_atom atom,
             const std::string &scheme_host_port,
             const std::string &path,
             const httplib::Headers &headers) {
-            return delegate(pool, atom, scheme_host_port, path, headers, "", "");
+            return schedule<std::string>(0, atom, scheme_host_port, path, headers, "", "");
         },
 
         [=](http_delete_simple_atom atom,
@@ -399,19 +435,32 @@ void HTTPClientActor::init() {
             const httplib::Headers &headers,
             const std::string &body,
             const std::string &content_type) {
-            return delegate(pool, atom, scheme_host_port, path, headers, body, content_type);
+            return schedule<std::string>(
+                0, atom, scheme_host_port, path, headers, body, content_type);
+        },
+
+        [=](http_delete_simple_atom atom,
+            const std::string &scheme_host_port,
+            const std::string &path,
+            const httplib::Headers &headers,
+            const std::string &body,
+            const std::string &content_type,
+            const int priority) {
+            return schedule<std::string>(
+                priority, atom, scheme_host_port, path, headers, body, content_type);
         },
 
         [=](http_get_atom atom, const std::string &scheme_host_port, const std::string &path) {
-            return delegate(
-                pool, atom, scheme_host_port, path, httplib::Headers(), httplib::Params());
+            return schedule<httplib::Response>(
+                0, atom, scheme_host_port, path, httplib::Headers(), httplib::Params());
         },
 
         [=](http_get_atom atom,
             const std::string &scheme_host_port,
             const std::string &path,
             const httplib::Headers &headers) {
-            return delegate(pool, atom, scheme_host_port, path, headers, httplib::Params());
+            return schedule<httplib::Response>(
+                0, atom, scheme_host_port, path, headers, httplib::Params());
         },
 
         [=](http_get_atom atom,
@@ -419,21 +468,33 @@ void HTTPClientActor::init() {
             const std::string &path,
             const httplib::Headers &headers,
             const httplib::Params &params) {
-            return delegate(pool, atom, scheme_host_port, path, headers, params);
+            return schedule<httplib::Response>(
+                0, atom, scheme_host_port, path, headers, params);
+        },
+
+        [=](http_get_atom atom,
+            const std::string &scheme_host_port,
+            const std::string &path,
+            const httplib::Headers &headers,
+            const httplib::Params &params,
+            const int priority) {
+            return schedule<httplib::Response>(
+                priority, atom, scheme_host_port, path, headers, params);
         },
 
         [=](http_get_simple_atom atom,
             const std::string &scheme_host_port,
             const std::string &path) {
-            return delegate(
-                pool, atom, scheme_host_port, path, httplib::Headers(), httplib::Params());
+            return schedule<std::string>(
+                0, atom, scheme_host_port, path, httplib::Headers(), httplib::Params());
         },
 
         [=](http_get_simple_atom atom,
             const std::string &scheme_host_port,
             const std::string &path,
             const httplib::Headers &headers) {
-            return delegate(pool, atom, scheme_host_port, path, headers, httplib::Params());
+            return schedule<std::string>(
+                0, atom, scheme_host_port, path, headers, httplib::Params());
         },
 
         [=](http_get_simple_atom atom,
@@ -441,27 +502,30 @@ void HTTPClientActor::init() {
             const std::string &path,
             const httplib::Headers &headers,
             const httplib::Params &params) {
-            return delegate(pool, atom, scheme_host_port, path, headers, params);
+            return schedule<std::string>(0, atom, scheme_host_port, path, headers, params);
+        },
+
+        [=](http_get_simple_atom atom,
+            const std::string &scheme_host_port,
+            const std::string &path,
+            const httplib::Headers &headers,
+            const httplib::Params &params,
+            const int priority) {
+            return schedule<std::string>(
+                priority, atom, scheme_host_port, path, headers, params);
         },
 
         [=](http_post_atom atom, const std::string &scheme_host_port, const std::string &path) {
-            return delegate(
-                pool,
-                atom,
-                scheme_host_port,
-                path,
-                httplib::Headers(),
-                httplib::Params(),
-                "",
-                "");
+            return schedule<httplib::Response>(
+                0, atom, scheme_host_port, path, httplib::Headers(), httplib::Params(), "", "");
         },
 
         [=](http_post_atom atom,
             const std::string &scheme_host_port,
             const std::string &path,
             const httplib::Headers &headers) {
-            return delegate(
-                pool, atom, scheme_host_port, path, headers, httplib::Params(), "", "");
+            return schedule<httplib::Response>(
+                0, atom, scheme_host_port, path, headers, httplib::Params(), "", "");
         },
 
         [=](http_post_atom atom,
@@ -469,7 +533,8 @@ void HTTPClientActor::init() {
             const std::string &path,
             const httplib::Headers &headers,
             const httplib::Params &params) {
-            return delegate(pool, atom, scheme_host_port, path, headers, params, "", "");
+            return schedule<httplib::Response>(
+                0, atom, scheme_host_port, path, headers, params, "", "");
         },
 
         [=](http_post_atom atom,
@@ -478,8 +543,8 @@ void HTTPClientActor::init() {
             const httplib::Headers &headers,
             const std::string &body,
             const std::string &content_type) {
-            return delegate(
-                pool,
+            return schedule<httplib::Response>(
+                0,
                 atom,
                 scheme_host_port,
                 path,
@@ -489,26 +554,31 @@ void HTTPClientActor::init() {
                 content_type);
         },
 
+        [=](http_post_atom atom,
+            const std::string &scheme_host_port,
+            const std::string &path,
+            const httplib::Headers &headers,
+            const httplib::Params &params,
+            const std::string &body,
+            const std::string &content_type,
+            const int priority) {
+            return schedule<httplib::Response>(
+                priority, atom, scheme_host_port, path, headers, params, body, content_type);
+        },
+
         [=](http_post_simple_atom atom,
             const std::string &scheme_host_port,
             const std::string &path) {
-            return delegate(
-                pool,
-                atom,
-                scheme_host_port,
-                path,
-                httplib::Headers(),
-                httplib::Params(),
-                "",
-                "");
+            return schedule<std::string>(
+                0, atom, scheme_host_port, path, httplib::Headers(), httplib::Params(), "", "");
         },
 
         [=](http_post_simple_atom atom,
             const std::string &scheme_host_port,
             const std::string &path,
             const httplib::Headers &headers) {
-            return delegate(
-                pool, atom, scheme_host_port, path, headers, httplib::Params(), "", "");
+            return schedule<std::string>(
+                0, atom, scheme_host_port, path, headers, httplib::Params(), "", "");
         },
 
         [=](http_post_simple_atom atom,
@@ -516,7 +586,8 @@ void HTTPClientActor::init() {
             const std::string &path,
             const httplib::Headers &headers,
             const httplib::Params &params) {
-            return delegate(pool, atom, scheme_host_port, path, headers, params, "", "");
+            return schedule<std::string>(
+                0, atom, scheme_host_port, path, headers, params, "", "");
         },
 
         [=](http_post_simple_atom atom,
@@ -525,8 +596,8 @@ void HTTPClientActor::init() {
             const httplib::Headers &headers,
             const std::string &body,
             const std::string &content_type) {
-            return delegate(
-                pool,
+            return schedule<std::string>(
+                0,
                 atom,
                 scheme_host_port,
                 path,
@@ -536,24 +607,29 @@ void HTTPClientActor::init() {
                 content_type);
         },
 
+        [=](http_post_simple_atom atom,
+            const std::string &scheme_host_port,
+            const std::string &path,
+            const httplib::Headers &headers,
+            const httplib::Params &params,
+            const std::string &body,
+            const std::string &content_type,
+            const int priority) {
+            return schedule<std::string>(
+                priority, atom, scheme_host_port, path, headers, params, body, content_type);
+        },
+
         [=](http_put_atom atom, const std::string &scheme_host_port, const std::string &path) {
-            return delegate(
-                pool,
-                atom,
-                scheme_host_port,
-                path,
-                httplib::Headers(),
-                httplib::Params(),
-                "",
-                "");
+            return schedule<httplib::Response>(
+                0, atom, scheme_host_port, path, httplib::Headers(), httplib::Params(), "", "");
         },
 
         [=](http_put_atom atom,
             const std::string &scheme_host_port,
             const std::string &path,
             const httplib::Headers &headers) {
-            return delegate(
-                pool, atom, scheme_host_port, path, headers, httplib::Params(), "", "");
+            return schedule<httplib::Response>(
+                0, atom, scheme_host_port, path, headers, httplib::Params(), "", "");
         },
 
         [=](http_put_atom atom,
@@ -561,7 +637,8 @@ void HTTPClientActor::init() {
             const std::string &path,
             const httplib::Headers &headers,
             const httplib::Params &params) {
-            return delegate(pool, atom, scheme_host_port, path, headers, params, "", "");
+            return schedule<httplib::Response>(
+                0, atom, scheme_host_port, path, headers, params, "", "");
         },
 
         [=](http_put_atom atom,
@@ -570,8 +647,8 @@ void HTTPClientActor::init() {
             const httplib::Headers &headers,
             const std::string &body,
             const std::string &content_type) {
-            return delegate(
-                pool,
+            return schedule<httplib::Response>(
+                0,
                 atom,
                 scheme_host_port,
                 path,
@@ -581,26 +658,31 @@ void HTTPClientActor::init() {
                 content_type);
         },
 
+        [=](http_put_atom atom,
+            const std::string &scheme_host_port,
+            const std::string &path,
+            const httplib::Headers &headers,
+            const httplib::Params &params,
+            const std::string &body,
+            const std::string &content_type,
+            const int priority) {
+            return schedule<httplib::Response>(
+                priority, atom, scheme_host_port, path, headers, params, body, content_type);
+        },
+
         [=](http_put_simple_atom atom,
             const std::string &scheme_host_port,
             const std::string &path) {
-            return delegate(
-                pool,
-                atom,
-                scheme_host_port,
-                path,
-                httplib::Headers(),
-                httplib::Params(),
-                "",
-                "");
+            return schedule<std::string>(
+                0, atom, scheme_host_port, path, httplib::Headers(), httplib::Params(), "", "");
         },
 
         [=](http_put_simple_atom atom,
             const std::string &scheme_host_port,
             const std::string &path,
             const httplib::Headers &headers) {
-            return delegate(
-                pool, atom, scheme_host_port, path, headers, httplib::Params(), "", "");
+            return schedule<std::string>(
+                0, atom, scheme_host_port, path, headers, httplib::Params(), "", "");
         },
 
         [=](http_put_simple_atom atom,
@@ -608,7 +690,8 @@ void HTTPClientActor::init() {
             const std::string &path,
             const httplib::Headers &headers,
             const httplib::Params &params) {
-            return delegate(pool, atom, scheme_host_port, path, headers, params, "", "");
+            return schedule<std::string>(
+                0, atom, scheme_host_port, path, headers, params, "", "");
         },
 
         [=](http_put_simple_atom atom,
@@ -617,8 +700,8 @@ void HTTPClientActor::init() {
             const httplib::Headers &headers,
             const std::string &body,
             const std::string &content_type) {
-            return delegate(
-                pool,
+            return schedule<std::string>(
+                0,
                 atom,
                 scheme_host_port,
                 path,
@@ -626,5 +709,45 @@ void HTTPClientActor::init() {
                 httplib::Params(),
                 body,
                 content_type);
+        },
+
+        [=](http_put_simple_atom atom,
+            const std::string &scheme_host_port,
+            const std::string &path,
+            const httplib::Headers &headers,
+            const httplib::Params &params,
+            const std::string &body,
+            const std::string &content_type,
+            const int priority) {
+            return schedule<std::string>(
+                priority, atom, scheme_host_port, path, headers, params, body, content_type);
         });
 }
+
+void HTTPClientActor::dispatch() {
+    // Only as many requests as there are workers go out at once, the rest
+    // wait here where they can be reordered.
+    while (total_in_flight_ < worker_count_) {
+        auto next = pending_.end();
+        for (auto i = pending_.begin(); i != pending_.end(); ++i) {
+            if (in_flight_[i->scheme_host_port] < max_per_host_ and
+                (next == pending_.end() or i->priority > next->priority))
+                next = i;
+        }
+        if (next == pending_.end())
+            break;
+
+        in_flight_[next->scheme_host_port]++;
+        total_in_flight_++;
+        next->send(pool_);
+        pending_.erase(next);
+    }
+}
+
+void HTTPClientActor::finished(const std::string &scheme_host_port) {
+    auto it = in_flight_.find(scheme_host_port);
+    if (it != in_flight_.end() and not --(it->second))
+        in_flight_.erase(it);
+    total_in_flight_--;
+    dispatch();
+}
@@ -1,6 +1,12 @@
 // SPDX-License-Identifier: Apache-2.0
 #include <caf/all.hpp>
+#include <chrono>
+#include <condition_variable>
 #include <gtest/gtest.h>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
 
 #include "xstudio/atoms.hpp"
 #include "xstudio/http_client/http_client_actor.hpp"
@@ -29,3 +35,91 @@ TEST(HTTPClientActorTest, Test) {
     //     std::cerr << err.what() << std::endl;
     // }
 }
+
+namespace {
+
+// a local server that holds every request until it is opened, so the client
+// has a queue to reorder.
+struct SlowServer {
+    SlowServer() {
+        server.Get(R"(/(\d+))", [&](const httplib::Request &req, httplib::Response &res) {
+            std::unique_lock<std::mutex> lock(mutex);
+            served.push_back(req.matches[1].str());
+            opened.wait(lock, [&] { return open; });
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            res.set_content(req.matches[1].str(), "text/plain");
+        });
+        port   = server.bind_to_any_port("127.0.0.1");
+        thread = std::thread([&]() { server.listen_after_bind(); });
+        while (not server.is_running())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    ~SlowServer() {
+        release();
+        server.stop();
+        thread.join();
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            open = true;
+        }
+        opened.notify_all();
+    }
+
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(port); }
+
+    httplib::Server server;
+    std::thread thread;
+    int port;
+    std::mutex mutex;
+    std::condition_variable opened;
+    bool open = false;
+    std::vector<std::string> served;
+};
+
+} // namespace
+
+TEST(HTTPClientActorTest, Priority) {
+    fixture f;
+    SlowServer server;
+    auto client = f.self->spawn<HTTPClientActor>(
+        CPPHTTPLIB_CONNECTION_TIMEOUT_SECOND,
+        CPPHTTPLIB_READ_TIMEOUT_SECOND,
+        CPPHTTPLIB_WRITE_TIMEOUT_SECOND,
+        1);
+
+    // the first request goes straight out and holds the only slot, the rest
+    // queue behind it.
+    const std::vector<int> priorities = {0, 1, 5, 3, 5, 2};
+    for (size_t i = 0; i < priorities.size(); i++)
+        f.self->send(
+            client,
+            http_get_simple_atom_v,
+            server.url(),
+            "/" + std::to_string(i),
+            httplib::Headers(),
+            httplib::Params(),
+            priorities[i]);
+
+    auto metrics = request_receive<JsonStore>(*(f.self), client, http_metrics_atom_v);
+    EXPECT_EQ(metrics[server.url()]["in_flight"], 1);
+    EXPECT_EQ(metrics[server.url()]["queued"], priorities.size() - 1);
+
+    server.release();
+
+    std::set<std::string> replies;
+    for (size_t i = 0; i < priorities.size(); i++)
+        f.self->receive(
+            [&](const std::string &body) { replies.insert(body); },
+            caf::after(std::chrono::seconds(10)) >> [&]() { FAIL() << "No response"; });
+    EXPECT_EQ(replies.size(), priorities.size());
+
+    // highest priority first, equal priorities in the order they were sent.
+    std::lock_guard<std::mutex> lock(server.mutex);
+    EXPECT_EQ(server.served, std::vector<std::string>({"0", "2", "4", "3", "5", "1"}));
+
+    f.self->send_exit(client, caf::exit_reason::user_shutdown);
+}
@@ -1,5 +1,8 @@
 // SPDX-License-Identifier: Apache-2.0
+#include <chrono>
 #include <gtest/gtest.h>
+#include <mutex>
+#include <thread>
 
 #include "xstudio/http_client/http_client.hpp"
 #include "xstudio/utility/helpers.hpp"
@@ -16,3 +19,104 @@ TEST(HttpClientTest, Test) {
     cli.set_write_timeout(5, 0);
     auto res = cli.Get("", httplib::Params(), httplib::Headers());
 }
+
+namespace {
+
+// a local server to stand in for a REST api
+struct LocalServer {
+    LocalServer() {
+        server.set_keep_alive_max_count(1000);
+        server.set_tcp_nodelay(true);
+        server.Get("/json", [&](const httplib::Request &req, httplib::Response &res) {
+            std::lock_guard<std::mutex> lock(mutex);
+            accept_encoding = req.get_header_value("Accept-Encoding");
+            res.set_content(body(), "application/json");
+        });
+        port   = server.bind_to_any_port("127.0.0.1");
+        thread = std::thread([&]() { server.listen_after_bind(); });
+        while (not server.is_running())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    ~LocalServer() {
+        server.stop();
+        thread.join();
+    }
+
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(port); }
+
+    static std::string body() {
+        std::string result = "[";
+        for (int i = 0; i < 2000; i++)
+            result += R"({"type": "Version", "id": )" + std::to_string(i) + "},";
+        result.back() = ']';
+        return result;
+    }
+
+    httplib::Server server;
+    std::thread thread;
+    int port;
+    std::mutex mutex;
+    std::string accept_encoding;
+};
+
+} // namespace
+
+TEST(HttpClientTest, ConnectionPool) {
+    LocalServer server;
+    ConnectionPool pool(5, 5, 5);
+    const auto url = server.url();
+
+    auto get = [&]() {
+        return pool.send(url, [&](httplib::Client &cli) {
+            return cli.Get("/json", ConnectionPool::accept_compressed(httplib::Headers()));
+        });
+    };
+
+    const int count = 50;
+    for (int i = 0; i < count; i++) {
+        auto res = get();
+        ASSERT_TRUE(res);
+        EXPECT_EQ(res->status, 200);
+        // compressed by the server and decoded for us
+        EXPECT_EQ(res->get_header_value("Content-Encoding"), "gzip");
+        EXPECT_EQ(res->body, LocalServer::body());
+    }
+
+    EXPECT_EQ(server.accept_encoding, "gzip, deflate");
+
+    auto metrics = pool.host_metrics()[url];
+    EXPECT_EQ(metrics.requests, size_t(count));
+    EXPECT_EQ(metrics.connections, size_t(1));
+    EXPECT_EQ(metrics.reused, size_t(count - 1));
+    EXPECT_EQ(metrics.errors, size_t(0));
+    EXPECT_EQ(pool.idle(url), size_t(1));
+
+    // concurrent requests each get their own connection, then share them
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 10; i++)
+                get();
+        });
+    for (auto &t : threads)
+        t.join();
+
+    metrics = pool.host_metrics()[url];
+    EXPECT_EQ(metrics.requests, size_t(count + 40));
+    EXPECT_LE(metrics.connections, size_t(4));
+    EXPECT_LE(pool.idle(url), size_t(4));
+
+    const auto js = pool.metrics();
+    EXPECT_EQ(js[url]["requests"], count + 40);
+
+    // failed connections aren't kept
+    const auto closed = std::string("http://127.0.0.1:1");
+    auto res          = pool.send(closed, [&](httplib::Client &cli) { return cli.Get("/"); });
+    EXPECT_FALSE(res);
+    EXPECT_EQ(pool.host_metrics()[closed].errors, size_t(1));
+    EXPECT_EQ(pool.idle(closed), size_t(0));
+
+    pool.clear();
+    EXPECT_EQ(pool.idle(url), size_t(0));
+}
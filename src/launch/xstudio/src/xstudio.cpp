@@ -43,6 +43,7 @@
 #include "xstudio/utility/logging.hpp"
 #include "xstudio/utility/remote_session_file.hpp"
 #include "xstudio/utility/serialise_headers.hpp"
+#include "xstudio/utility/session_file.hpp"
 #include "xstudio/utility/string_helpers.hpp"
 
 CAF_PUSH_WARNINGS
@@ -277,7 +278,7 @@ struct Launcher {
                 actions["set_play_rate"] = static_cast<double>(args::get(cli_args.play_rate));
 
             if (args::get(cli_args.media_paths).size() == 1 and
-                ends_with(args::get(cli_args.media_paths)[0], ".xst")) {
+                is_session_file_path(args::get(cli_args.media_paths)[0])) {
                 actions["open_session"]      = true;
                 actions["open_session_path"] = args::get(cli_args.media_paths)[0];
             } else {
@@ -339,9 +340,8 @@ struct Launcher {
         // check for session file ..
         if (actions["open_session"]) {
             try {
-                JsonStore js;
-                std::ifstream i(actions["open_session_path"].get<std::string>());
-                i >> js;
+                JsonStore js(
+                    read_session_file(actions["open_session_path"].get<std::string>()));
 
                 if (actions["new_instance"]) {
                     spdlog::stopwatch sw;
@@ -0,0 +1,220 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+
+#include "xstudio/media/frame_metadata.hpp"
+
+using namespace xstudio::media;
+using namespace xstudio::utility;
+
+namespace {
+
+FrameMetadata::ColumnType column_type(const nlohmann::json &value) {
+    if (value.is_number())
+        return FrameMetadata::CT_NUMBER;
+    if (value.is_string())
+        return FrameMetadata::CT_STRING;
+    return FrameMetadata::CT_JSON;
+}
+
+std::string column_type_name(const FrameMetadata::ColumnType type) {
+    switch (type) {
+    case FrameMetadata::CT_NUMBER:
+        return "number";
+    case FrameMetadata::CT_STRING:
+        return "string";
+    case FrameMetadata::CT_JSON:
+        break;
+    }
+    return "json";
+}
+
+} // namespace
+
+void FrameMetadata::Column::resize(const size_t size) {
+    present.resize(size, false);
+    switch (type) {
+    case CT_NUMBER:
+        numbers.resize(size, 0.0);
+        break;
+    case CT_STRING:
+        strings.resize(size);
+        break;
+    case CT_JSON:
+        json.resize(size);
+        break;
+    }
+}
+
+void FrameMetadata::Column::insert(const size_t index) {
+    present.insert(present.begin() + index, false);
+    switch (type) {
+    case CT_NUMBER:
+        numbers.insert(numbers.begin() + index, 0.0);
+        break;
+    case CT_STRING:
+        strings.insert(strings.begin() + index, std::string());
+        break;
+    case CT_JSON:
+        json.insert(json.begin() + index, nlohmann::json());
+        break;
+    }
+}
+
+void FrameMetadata::Column::set(const size_t index, const nlohmann::json &value) {
+    if (type != CT_JSON and column_type(value) != type) {
+        // mixed types, keep the column as json from now on
+        std::vector<nlohmann::json> converted(present.size());
+        for (size_t i = 0; i < present.size(); i++)
+            converted[i] = get(i);
+        numbers.clear();
+        strings.clear();
+        json = std::move(converted);
+        type = CT_JSON;
+    }
+
+    present[index] = true;
+    switch (type) {
+    case CT_NUMBER:
+        numbers[index] = value.get<double>();
+        break;
+    case CT_STRING:
+        strings[index] = value.get<std::string>();
+        break;
+    case CT_JSON:
+        json[index] = value;
+        break;
+    }
+}
+
+nlohmann::json FrameMetadata::Column::get(const size_t index) const {
+    if (not present[index])
+        return nlohmann::json();
+
+    switch (type) {
+    case CT_NUMBER:
+        return numbers[index];
+    case CT_STRING:
+        return strings[index];
+    case CT_JSON:
+        break;
+    }
+    return json[index];
+}
+
+bool FrameMetadata::Column::equal(const size_t a, const size_t b) const {
+    if (present[a] != present[b])
+        return false;
+    if (not present[a])
+        return true;
+
+    switch (type) {
+    case CT_NUMBER:
+        return numbers[a] == numbers[b];
+    case CT_STRING:
+        return strings[a] == strings[b];
+    case CT_JSON:
+        break;
+    }
+    return json[a] == json[b];
+}
+
+size_t FrameMetadata::row(const int frame) {
+    auto it          = std::lower_bound(frames_.begin(), frames_.end(), frame);
+    const auto index = static_cast<size_t>(std::distance(frames_.begin(), it));
+
+    if (it == frames_.end() or *it != frame) {
+        frames_.insert(it, frame);
+        for (auto &i : columns_)
+            i.second.insert(index);
+    } else {
+        for (auto &i : columns_)
+            i.second.present[index] = false;
+    }
+
+    return index;
+}
+
+void FrameMetadata::add(const int frame, const nlohmann::json &attributes) {
+    if (not attributes.is_object())
+        return;
+
+    const auto index = row(frame);
+    for (const auto &[name, value] : attributes.items()) {
+        auto it = columns_.find(name);
+        if (it == columns_.end()) {
+            Column column;
+            column.type = column_type(value);
+            column.resize(frames_.size());
+            it = columns_.emplace(name, std::move(column)).first;
+        }
+        it->second.set(index, value);
+    }
+}
+
+void FrameMetadata::clear() {
+    frames_.clear();
+    columns_.clear();
+}
+
+bool FrameMetadata::has_frame(const int frame) const {
+    return std::binary_search(frames_.begin(), frames_.end(), frame);
+}
+
+std::vector<std::string> FrameMetadata::attributes() const {
+    std::vector<std::string> result;
+    for (const auto &i : columns_)
+        result.push_back(i.first);
+    return result;
+}
+
+nlohmann::json FrameMetadata::frame(const int frame) const {
+    auto it = std::lower_bound(frames_.begin(), frames_.end(), frame);
+    if (it == frames_.end() or *it != frame)
+        return nlohmann::json();
+
+    const auto index      = static_cast<size_t>(std::distance(frames_.begin(), it));
+    nlohmann::json result = nlohmann::json::object();
+    for (const auto &[name, column] : columns_) {
+        if (column.present[index])
+            result[name] = column.get(index);
+    }
+    return result;
+}
+
+nlohmann::json FrameMetadata::column(const std::string &attribute) const {
+    auto it = columns_.find(attribute);
+    if (it == columns_.end())
+        return nlohmann::json();
+
+    nlohmann::json result;
+    result["type"]   = column_type_name(it->second.type);
+    result["frames"] = frames_;
+    result["values"] = nlohmann::json::array();
+    for (size_t i = 0; i < frames_.size(); i++)
+        result["values"].push_back(it->second.get(i));
+    return result;
+}
+
+std::vector<int> FrameMetadata::changes(const std::string &attribute) const {
+    std::vector<int> result;
+    auto it = columns_.find(attribute);
+    if (it == columns_.end())
+        return result;
+
+    for (size_t i = 1; i < frames_.size(); i++) {
+        if (not it->second.equal(i - 1, i))
+            result.push_back(frames_[i]);
+    }
+    return result;
+}
+
+JsonStore FrameMetadata::summary() const {
+    JsonStore result;
+    result["frames"]     = frames_.size();
+    result["first"]      = frames_.empty() ? nlohmann::json() : nlohmann::json(frames_.front());
+    result["last"]       = frames_.empty() ? nlohmann::json() : nlohmann::json(frames_.back());
+    result["attributes"] = nlohmann::json::object();
+    for (const auto &[name, column] : columns_)
+        result["attributes"][name] = column_type_name(column.type);
+    return result;
+}
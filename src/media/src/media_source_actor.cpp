@@ -12,6 +12,7 @@
 #include "xstudio/playhead/sub_playhead.hpp"
 #include "xstudio/utility/helpers.hpp"
 #include "xstudio/utility/logging.hpp"
+#include "xstudio/utility/occupancy_bitmap.hpp"
 #include "xstudio/utility/uuid.hpp"
 #include "xstudio/thumbnail/thumbnail.hpp"
 
@@ -759,6 +760,7 @@ void MediaSourceActor::init() {
 
         [=](media_reference_atom, const MediaReference &mr) -> bool {
             base_.set_media_reference(mr);
+            frame_metadata_.clear();
             // update state..
             update_media_status();
             base_.send_changed(event_group_, this);
@@ -878,6 +880,29 @@ void MediaSourceActor::init() {
             return rp;
         },
 
+        [=](media_cache::cache_occupancy_atom,
+            const MediaType media_type) -> caf::result<utility::OccupancyBitmap> {
+            // bit n of the bitmap is frame n of the current stream, the cache
+            // broadcasts changes to it keyed on the stream uuid
+            auto cache = system().registry().template get<caf::actor>(
+                media_type == MT_IMAGE ? image_cache_registry : audio_cache_registry);
+            auto stream = base_.current(media_type);
+
+            if (not cache or stream.is_null())
+                return make_error(xstudio_error::error, "No cache or stream for MediaType");
+
+            auto rp = make_response_promise<utility::OccupancyBitmap>();
+            request(
+                caf::actor_cast<actor>(this), infinite, media_cache::keys_atom_v, media_type)
+                .then(
+                    [=](const MediaKeyVector &keys) mutable {
+                        occupancy_streams_.insert(stream);
+                        rp.delegate(cache, media_cache::cache_occupancy_atom_v, stream, keys);
+                    },
+                    [=](error &err) mutable { rp.deliver(std::move(err)); });
+            return rp;
+        },
+
         [=](media_cache::keys_atom) -> caf::result<MediaKeyVector> {
             auto rp = make_response_promise<MediaKeyVector>();
             deliver_frames_media_keys(rp, MT_IMAGE, std::vector<int>());
@@ -1053,6 +1078,33 @@ void MediaSourceActor::init() {
             return rp;
         },
 
+        // sent by readers with the header attributes of a frame they've decoded,
+        // frames are file frames as in /metadata/media/@<frame>
+        [=](media_metadata::frame_metadata_atom, const int frame, const JsonStore &attributes) {
+            frame_metadata_.add(frame, attributes);
+        },
+
+        [=](media_metadata::frame_metadata_atom) -> JsonStore {
+            return frame_metadata_.summary();
+        },
+
+        [=](media_metadata::frame_metadata_atom, const int frame) -> result<JsonStore> {
+            auto jsn = frame_metadata_.frame(frame);
+            if (jsn.is_null())
+                return make_error(xstudio_error::error, "Frame hasn't been decoded");
+            return JsonStore(jsn);
+        },
+
+        // the attribute over all the decoded frames, with the frames it changes on
+        [=](media_metadata::frame_metadata_atom,
+            const std::string &attribute) -> result<JsonStore> {
+            auto jsn = frame_metadata_.column(attribute);
+            if (jsn.is_null())
+                return make_error(xstudio_error::error, "No such attribute " + attribute);
+            jsn["changes"] = frame_metadata_.changes(attribute);
+            return JsonStore(jsn);
+        },
+
         [=](media_metadata::get_metadata_atom, const int sequence_frame) -> caf::result<bool> {
             if (base_.media_reference().container())
                 return make_error(xstudio_error::error, "Media has no frames");
@@ -1403,6 +1455,19 @@ void MediaSourceActor::deliver_frames_media_keys(
             [=](error &err) mutable { rp.deliver(std::move(err)); });
 }
 
+void MediaSourceActor::on_exit() {
+    if (occupancy_streams_.empty())
+        return;
+
+    for (const auto &registry : {image_cache_registry, audio_cache_registry}) {
+        auto cache = system().registry().template get<caf::actor>(registry);
+        if (cache) {
+            for (const auto &stream : occupancy_streams_)
+                anon_send(cache, media_cache::cache_occupancy_atom_v, stream, MediaKeyVector());
+        }
+    }
+}
+
 void MediaSourceActor::update_stream_media_reference(
     StreamDetail &stream_detail,
     const utility::Uuid &stream_uuid,
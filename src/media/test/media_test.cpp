@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 #include <gtest/gtest.h>
 
+#include "xstudio/media/frame_metadata.hpp"
 #include "xstudio/media/media.hpp"
 #include "xstudio/utility/frame_list.hpp"
 #include "xstudio/utility/helpers.hpp"
@@ -77,3 +78,54 @@ TEST(MediaSourceTest, Test) {
 }
 
 TEST(MediaStreamTest, Test) {}
+
+TEST(FrameMetadataTest, Test) {
+    FrameMetadata fm;
+    EXPECT_TRUE(fm.empty());
+
+    // out of order, as frames are decoded
+    fm.add(1003, R"({"exposure": 1.5, "camera": "A"})"_json);
+    fm.add(1001, R"({"exposure": 1.0, "camera": "A"})"_json);
+    fm.add(1002, R"({"exposure": 1.0, "camera": "A", "lens": [35, 50]})"_json);
+    fm.add(1004, R"({"exposure": 1.5, "camera": "B"})"_json);
+
+    EXPECT_EQ(fm.frames(), std::vector<int>({1001, 1002, 1003, 1004}));
+    EXPECT_TRUE(fm.has_frame(1002));
+    EXPECT_FALSE(fm.has_frame(1005));
+    EXPECT_EQ(fm.attributes(), std::vector<std::string>({"camera", "exposure", "lens"}));
+
+    EXPECT_EQ(fm.frame(1003)["exposure"].get<double>(), 1.5);
+    EXPECT_FALSE(fm.frame(1003).contains("lens"));
+    EXPECT_EQ(fm.frame(1002)["lens"][1].get<int>(), 50);
+    EXPECT_TRUE(fm.frame(999).is_null());
+
+    EXPECT_EQ(fm.changes("exposure"), std::vector<int>({1003}));
+    EXPECT_EQ(fm.changes("camera"), std::vector<int>({1004}));
+    // appearing and disappearing are changes
+    EXPECT_EQ(fm.changes("lens"), std::vector<int>({1002, 1003}));
+
+    auto exposure = fm.column("exposure");
+    EXPECT_EQ(exposure["type"], "number");
+    EXPECT_EQ(exposure["values"].size(), size_t(4));
+    EXPECT_EQ(fm.column("lens")["type"], "json");
+    EXPECT_TRUE(fm.column("missing").is_null());
+
+    // a frame read again replaces what was held
+    fm.add(1004, R"({"exposure": 2.0})"_json);
+    EXPECT_FALSE(fm.frame(1004).contains("camera"));
+
+    // mixed types fall back to json, keeping the values
+    fm.add(1005, R"({"exposure": "bright"})"_json);
+    EXPECT_EQ(fm.column("exposure")["type"], "json");
+    EXPECT_EQ(fm.frame(1001)["exposure"].get<double>(), 1.0);
+    EXPECT_EQ(fm.frame(1005)["exposure"], "bright");
+
+    auto summary = fm.summary();
+    EXPECT_EQ(summary["frames"], 5);
+    EXPECT_EQ(summary["first"], 1001);
+    EXPECT_EQ(summary["attributes"]["camera"], "string");
+
+    fm.clear();
+    EXPECT_TRUE(fm.empty());
+    EXPECT_TRUE(fm.attributes().empty());
+}
@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Two instances playing the same sequence, each in its own process, with and
+// without a shared frame cache between them, both at once and the second
+// after the first. A frame that isn't cached is "decoded" by filling it and
+// waiting out the decode time, then stored.
+//
+// shared_frame_cache_benchmark [frames] [frame_mb] [decode_ms]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "xstudio/media_cache/shared_frame_cache.hpp"
+
+using namespace xstudio::media_cache;
+
+namespace {
+
+struct Result {
+    int hits       = {0};
+    int misses     = {0};
+    double seconds = {0.0};
+};
+
+Result play(
+    const std::string &name,
+    const size_t arena_size,
+    const int frames,
+    const size_t frame_size,
+    const int decode_ms,
+    const int start_pipe) {
+
+    SharedFrameCache cache(name, arena_size);
+    std::vector<std::byte> decoded(frame_size);
+
+    // wait to be started
+    char go = 0;
+    if (read(start_pipe, &go, 1) != 1)
+        std::exit(1);
+
+    Result result;
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        const auto key = "sequence/" + std::to_string(frame);
+        if (auto entry = cache.retrieve(key)) {
+            result.hits++;
+            continue;
+        }
+
+        result.misses++;
+        const auto decode_end =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(decode_ms);
+        for (size_t i = 0; i < frame_size; i++)
+            decoded[i] = std::byte((i * 31 + frame) & 0xff);
+        while (std::chrono::steady_clock::now() < decode_end)
+            ;
+        cache.store(key, "", decoded.data(), decoded.size());
+    }
+    result.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// runs two instances, on the same arena or one each
+void run(
+    const bool shared,
+    const bool together,
+    const int frames,
+    const size_t frame_size,
+    const int decode_ms) {
+
+    const auto arena_size = frame_size * frames * 5 / 4;
+    const auto base       = "xstudio_shared_frame_cache_benchmark_" + std::to_string(getpid());
+
+    int start_pipe[2];
+    int result_pipe[2];
+    if (pipe(start_pipe) or pipe(result_pipe))
+        std::exit(1);
+
+    std::vector<pid_t> children;
+    for (int instance = 0; instance < 2; ++instance) {
+        const auto name = shared ? base : base + "_" + std::to_string(instance);
+        SharedFrameCache::unlink(name);
+
+        const auto pid = fork();
+        if (pid == 0) {
+            close(start_pipe[1]);
+            const auto result =
+                play(name, arena_size, frames, frame_size, decode_ms, start_pipe[0]);
+            if (write(result_pipe[1], &result, sizeof(result)) != sizeof(result))
+                _exit(1);
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+
+    // give both time to open the arena, then start them
+    usleep(200000);
+    const char go[2] = {1, 1};
+    if (write(start_pipe[1], go, together ? 2 : 1) != (together ? 2 : 1))
+        std::exit(1);
+
+    std::printf(
+        "%s cache, %s\n", shared ? "shared" : "private", together ? "together" : "after");
+    for (size_t i = 0; i < children.size(); ++i) {
+        Result result;
+        if (read(result_pipe[0], &result, sizeof(result)) != sizeof(result))
+            std::exit(1);
+        std::printf(
+            "  instance: %d decoded, %d from the cache, %.3fs, %.1f fps\n",
+            result.misses,
+            result.hits,
+            result.seconds,
+            frames / result.seconds);
+        if (not together and i == 0 and write(start_pipe[1], go, 1) != 1)
+            std::exit(1);
+    }
+    for (const auto pid : children)
+        waitpid(pid, nullptr, 0);
+
+    close(start_pipe[0]);
+    close(start_pipe[1]);
+    close(result_pipe[0]);
+    close(result_pipe[1]);
+    for (int instance = 0; instance < 2; ++instance)
+        SharedFrameCache::unlink(shared ? base : base + "_" + std::to_string(instance));
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const int frames      = argc > 1 ? std::atoi(argv[1]) : 48;
+    const size_t frame_mb = argc > 2 ? std::atoi(argv[2]) : 8;
+    const int decode_ms   = argc > 3 ? std::atoi(argv[3]) : 20;
+
+    std::printf(
+        "2 instances, %d frames of %zuMB, %dms to decode a frame\n",
+        frames,
+        frame_mb,
+        decode_ms);
+
+    for (const auto together : {true, false}) {
+        run(false, together, frames, frame_mb * 1024 * 1024, decode_ms);
+        run(true, together, frames, frame_mb * 1024 * 1024, decode_ms);
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+
+#include "xstudio/media_cache/cache_occupancy.hpp"
+
+using namespace xstudio;
+using namespace xstudio::media_cache;
+using namespace xstudio::utility;
+
+const OccupancyBitmap &
+CacheOccupancy::track(const Uuid &id, const media::MediaKeyVector &keys) {
+    // versions carry on from the previous keys so receivers can tell
+    // updates for them from updates for these
+    uint64_t version = 0;
+    if (const auto previous = bitmap(id))
+        version = previous->version() + 1;
+    untrack(id);
+
+    auto &t = tracks_[id];
+    t.id    = id;
+    t.keys  = keys;
+    t.bitmap.resize(keys.size());
+    t.bitmap.set_version(version);
+
+    const media::MediaKey empty;
+    for (size_t i = 0; i < t.keys.size(); i++) {
+        const auto &key = t.keys[i];
+        if (key == empty)
+            continue;
+        slots_[key].push_back(Slot{&t, i});
+        if (present_.count(key))
+            t.bitmap.set(i);
+    }
+
+    return t.bitmap;
+}
+
+void CacheOccupancy::untrack(const Uuid &id) {
+    auto t = tracks_.find(id);
+    if (t == std::end(tracks_))
+        return;
+
+    Track *track = &(t->second);
+    for (const auto &key : track->keys) {
+        auto s = slots_.find(key);
+        if (s == std::end(slots_))
+            continue;
+        auto &v = s->second;
+        v.erase(
+            std::remove_if(
+                v.begin(), v.end(), [track](const Slot &slot) { return slot.track == track; }),
+            v.end());
+        if (v.empty())
+            slots_.erase(s);
+    }
+
+    dirty_.erase(std::remove(dirty_.begin(), dirty_.end(), id), dirty_.end());
+    tracks_.erase(t);
+}
+
+void CacheOccupancy::set(const media::MediaKey &key, const bool value) {
+    auto s = slots_.find(key);
+    if (s == std::end(slots_))
+        return;
+
+    for (const auto &slot : s->second) {
+        if (slot.track->bitmap.set(slot.index, value) and not slot.track->dirty) {
+            slot.track->dirty = true;
+            dirty_.push_back(slot.track->id);
+        }
+    }
+}
+
+void CacheOccupancy::update(
+    const media::MediaKeyVector &store, const media::MediaKeyVector &erase) {
+    for (const auto &key : store) {
+        if (present_.insert(key).second)
+            set(key, true);
+    }
+
+    for (const auto &key : erase) {
+        if (present_.erase(key))
+            set(key, false);
+    }
+}
+
+const OccupancyBitmap *CacheOccupancy::bitmap(const Uuid &id) const {
+    auto t = tracks_.find(id);
+    if (t == std::end(tracks_))
+        return nullptr;
+    return &(t->second.bitmap);
+}
+
+std::vector<Uuid> CacheOccupancy::take_dirty() {
+    std::vector<Uuid> result;
+    result.swap(dirty_);
+    for (const auto &id : result) {
+        auto t = tracks_.find(id);
+        if (t != std::end(tracks_))
+            t->second.dirty = false;
+    }
+    return result;
+}
@@ -0,0 +1,510 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fmt/format.h>
+#include <stdexcept>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "xstudio/media_cache/disk_frame_cache.hpp"
+
+using namespace xstudio::media_cache;
+
+namespace {
+
+constexpr uint32_t k_magic     = 0x43465358; // XSFC
+constexpr uint32_t k_version   = 2;
+constexpr uint32_t k_tombstone = 1;
+constexpr uint64_t k_align     = 4096;
+
+// Fixed size header at the start of every record, followed by the key,
+// metadata and source path. The data starts at the next aligned offset.
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t flags;
+    uint32_t key_size;
+    uint32_t meta_size;
+    uint32_t source_size;
+    int64_t source_mtime;
+    uint64_t source_bytes;
+    uint64_t data_at;
+    uint64_t data_size;
+    uint64_t length;
+    uint64_t checksum;
+};
+
+uint64_t round_up(const uint64_t v) { return (v + k_align - 1) & ~(k_align - 1); }
+
+uint64_t fnv1a(const void *data, const size_t size, uint64_t hash = 14695981039346656037ULL) {
+    const auto *p = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t checksum(RecordHeader header, const std::string &key) {
+    header.checksum = 0;
+    return fnv1a(key.data(), key.size(), fnv1a(&header, sizeof(header)));
+}
+
+bool write_all(const int fd, const void *data, size_t size, uint64_t offset) {
+    const auto *p = static_cast<const char *>(data);
+    while (size) {
+        const auto n = pwrite(fd, p, size, offset);
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+bool read_all(const int fd, void *data, size_t size, uint64_t offset) {
+    auto *p = static_cast<char *>(data);
+    while (size) {
+        const auto n = pread(fd, p, size, offset);
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+std::shared_ptr<const std::byte> map_data(const int fd, const uint64_t at, const uint64_t size) {
+    // the mapping has to start on a page, which need not be the record
+    // alignment on every platform
+    static const uint64_t page = sysconf(_SC_PAGESIZE);
+    const uint64_t base        = at - (at % page);
+    const uint64_t length      = size + (at - base);
+
+    void *addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, base);
+    if (addr == MAP_FAILED)
+        return nullptr;
+    madvise(addr, length, MADV_WILLNEED);
+
+    std::shared_ptr<std::byte> mapping(
+        static_cast<std::byte *>(addr), [length](std::byte *p) { munmap(p, length); });
+    return std::shared_ptr<const std::byte>(mapping, mapping.get() + (at - base));
+}
+
+// modification time in nanoseconds and size of a file, false if it's gone
+bool stat_file(const std::string &path, int64_t &mtime, uint64_t &size) {
+    struct stat st = {};
+    if (stat(path.c_str(), &st) != 0)
+        return false;
+    mtime = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    size  = st.st_size;
+    return true;
+}
+
+// failing to trim only leaves bytes that the next scan stops at
+void trim(const int fd, const uint64_t size) {
+    [[maybe_unused]] const auto result = ftruncate(fd, size);
+}
+
+std::string segment_name(const uint32_t id) { return fmt::format("segment_{:08d}.xsfc", id); }
+
+} // namespace
+
+DiskFrameCache::DiskFrameCache(
+    const fs::path &path, const size_t max_size, const size_t segment_size)
+    : path_(path), max_size_(max_size), segment_size_(segment_size) {
+
+    std::error_code ec;
+    fs::create_directories(path_, ec);
+    if (ec)
+        throw std::runtime_error(
+            fmt::format("Failed to create frame cache {} {}", path_.string(), ec.message()));
+
+    // a second process sharing the directory would corrupt both indexes
+    lock_fd_ = open((path_ / "lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lock_fd_ < 0 or flock(lock_fd_, LOCK_EX | LOCK_NB)) {
+        if (lock_fd_ >= 0)
+            close(lock_fd_);
+        throw std::runtime_error(
+            fmt::format("Frame cache {} is in use by another process", path_.string()));
+    }
+
+    open_segments();
+    enforce_budget();
+}
+
+DiskFrameCache::~DiskFrameCache() {
+    for (auto &i : segments_)
+        close(i.second.fd);
+    if (lock_fd_ >= 0)
+        close(lock_fd_);
+}
+
+void DiskFrameCache::open_segments() {
+    std::vector<uint32_t> ids;
+    for (const auto &i : fs::directory_iterator(path_)) {
+        unsigned int id = 0;
+        if (i.is_regular_file() and
+            sscanf(i.path().filename().c_str(), "segment_%08u.xsfc", &id) == 1 and
+            i.path().filename() == segment_name(id))
+            ids.push_back(id);
+    }
+
+    // oldest first, so later records replace earlier ones
+    std::sort(ids.begin(), ids.end());
+    for (const auto id : ids) {
+        Segment segment;
+        segment.path = path_ / segment_name(id);
+        segment.fd   = open(segment.path.c_str(), O_RDWR | O_CLOEXEC);
+        if (segment.fd < 0)
+            continue;
+        segments_[id] = segment;
+        scan_segment(id, segments_[id]);
+    }
+}
+
+void DiskFrameCache::scan_segment(const uint32_t id, Segment &segment) {
+    const uint64_t file_size = lseek(segment.fd, 0, SEEK_END);
+    uint64_t offset          = 0;
+
+    while (offset < file_size) {
+        RecordHeader header;
+        std::string key;
+        bool valid = read_all(segment.fd, &header, sizeof(header), offset) and
+                     header.magic == k_magic and header.version == k_version and
+                     header.length >= header.data_at + header.data_size and
+                     header.data_at >= sizeof(header) + header.key_size + header.meta_size +
+                                           header.source_size;
+
+        // the padding after the last record isn't written
+        const auto end =
+            header.data_size
+                ? header.data_at + header.data_size
+                : sizeof(header) + header.key_size + header.meta_size + header.source_size;
+        valid = valid and offset + end <= file_size;
+        if (valid) {
+            key.resize(header.key_size);
+            valid = read_all(segment.fd, key.data(), key.size(), offset + sizeof(header)) and
+                    checksum(header, key) == header.checksum;
+        }
+
+        Source source;
+        if (valid and header.source_size) {
+            source.path.resize(header.source_size);
+            source.mtime = header.source_mtime;
+            source.size  = header.source_bytes;
+            valid        = read_all(
+                segment.fd,
+                source.path.data(),
+                source.path.size(),
+                offset + sizeof(header) + header.key_size + header.meta_size);
+        }
+
+        if (not valid) {
+            // a record that was being written when we went away, anything
+            // after it can't be trusted either
+            trim(segment.fd, offset);
+            break;
+        }
+
+        drop(key);
+        if (not(header.flags & k_tombstone)) {
+            IndexEntry entry;
+            entry.segment   = id;
+            entry.offset    = offset;
+            entry.length    = header.length;
+            entry.data_at   = header.data_at;
+            entry.data_size = header.data_size;
+            entry.meta_size = header.meta_size;
+            entry.last_used = ++use_clock_;
+            entry.source    = std::move(source);
+            index_[key]     = entry;
+            segment.live += entry.length;
+            size_ += entry.length;
+        }
+        offset += header.length;
+    }
+    segment.size = round_up(offset);
+}
+
+DiskFrameCache::Segment &
+DiskFrameCache::writable_segment(const uint64_t length, const std::optional<uint32_t> sealed) {
+    if (not segments_.empty() and segments_.rbegin()->first != sealed) {
+        auto &last = segments_.rbegin()->second;
+        if (not last.size or last.size + length <= segment_size_)
+            return last;
+    }
+
+    const uint32_t id = segments_.empty() ? 0 : segments_.rbegin()->first + 1;
+    Segment segment;
+    segment.path = path_ / segment_name(id);
+    segment.fd   = open(segment.path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (segment.fd < 0)
+        throw std::runtime_error(
+            fmt::format("Failed to create {} {}", segment.path.string(), strerror(errno)));
+    segments_[id] = segment;
+    return segments_[id];
+}
+
+bool DiskFrameCache::append(
+    const std::string &key,
+    const std::string &metadata,
+    const Source &source,
+    const std::byte *data,
+    const uint64_t size,
+    const bool tombstone,
+    const std::optional<uint32_t> sealed) {
+
+    RecordHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic     = k_magic;
+    header.version   = k_version;
+    header.flags     = tombstone ? k_tombstone : 0;
+    header.key_size     = key.size();
+    header.meta_size    = metadata.size();
+    header.source_size  = source.path.size();
+    header.source_mtime = source.mtime;
+    header.source_bytes = source.size;
+    header.data_at =
+        round_up(sizeof(header) + key.size() + metadata.size() + source.path.size());
+    header.data_size = size;
+    header.length    = header.data_at + round_up(size);
+    header.checksum  = checksum(header, key);
+
+    Segment *segment = nullptr;
+    try {
+        segment = &writable_segment(header.length, sealed);
+    } catch (...) {
+        return false;
+    }
+    const auto offset = segment->size;
+    const auto id     = segments_.rbegin()->first;
+
+    std::vector<char> prefix(
+        sizeof(header) + key.size() + metadata.size() + source.path.size());
+    auto *p = prefix.data();
+    std::memcpy(p, &header, sizeof(header));
+    std::memcpy(p += sizeof(header), key.data(), key.size());
+    std::memcpy(p += key.size(), metadata.data(), metadata.size());
+    std::memcpy(p += metadata.size(), source.path.data(), source.path.size());
+
+    // header goes last, a record cut short never looks valid
+    if (not write_all(segment->fd, data, size, offset + header.data_at) or
+        not write_all(segment->fd, prefix.data(), prefix.size(), offset)) {
+        trim(segment->fd, offset);
+        return false;
+    }
+    segment->size = offset + header.length;
+
+    drop(key);
+    if (not tombstone) {
+        IndexEntry entry;
+        entry.segment   = id;
+        entry.offset    = offset;
+        entry.length    = header.length;
+        entry.data_at   = header.data_at;
+        entry.data_size = size;
+        entry.meta_size = metadata.size();
+        entry.last_used = ++use_clock_;
+        entry.source    = source;
+        index_[key]     = entry;
+        segment->live += entry.length;
+        size_ += entry.length;
+    }
+    return true;
+}
+
+bool DiskFrameCache::store(
+    const std::string &key,
+    const std::string &metadata,
+    const std::byte *data,
+    const size_t size,
+    const fs::path &source) {
+
+    if (size > max_size_)
+        return false;
+
+    Source stamp;
+    if (not source.empty()) {
+        stamp.path = source.string();
+        if (not stat_file(stamp.path, stamp.mtime, stamp.size))
+            return false;
+    }
+
+    if (not append(key, metadata, stamp, data, size, false))
+        return false;
+    enforce_budget();
+    return contains(key);
+}
+
+std::optional<DiskFrameCache::Entry> DiskFrameCache::retrieve(const std::string &key) {
+    auto it = index_.find(key);
+    if (it == std::end(index_))
+        return {};
+
+    auto &entry = it->second;
+
+    // the source has been written again since, or has gone
+    if (not entry.source.path.empty()) {
+        int64_t mtime = 0;
+        uint64_t size = 0;
+        if (not stat_file(entry.source.path, mtime, size) or mtime != entry.source.mtime or
+            size != entry.source.size) {
+            erase(key);
+            return {};
+        }
+    }
+
+    const auto &segment = segments_.at(entry.segment);
+
+    Entry result;
+    result.metadata.resize(entry.meta_size);
+    if (not read_all(
+            segment.fd,
+            result.metadata.data(),
+            entry.meta_size,
+            entry.offset + sizeof(RecordHeader) + key.size()))
+        return {};
+
+    if (entry.data_size) {
+        result.data = map_data(segment.fd, entry.offset + entry.data_at, entry.data_size);
+        if (not result.data)
+            return {};
+    }
+    result.size     = entry.data_size;
+    entry.last_used = ++use_clock_;
+    return result;
+}
+
+std::vector<std::string> DiskFrameCache::keys() const {
+    std::vector<std::string> result;
+    result.reserve(index_.size());
+    for (const auto &i : index_)
+        result.push_back(i.first);
+    return result;
+}
+
+bool DiskFrameCache::erase(const std::string &key) {
+    if (not contains(key))
+        return false;
+    // without a tombstone the record would be back after a restart
+    if (not append(key, std::string(), Source(), nullptr, 0, true))
+        drop(key);
+    return true;
+}
+
+void DiskFrameCache::clear() {
+    while (not segments_.empty())
+        remove_segment(segments_.begin()->first);
+    index_.clear();
+    size_ = 0;
+}
+
+size_t DiskFrameCache::disk_usage() const {
+    size_t result = 0;
+    for (const auto &i : segments_)
+        result += i.second.size;
+    return result;
+}
+
+void DiskFrameCache::set_max_size(const size_t max_size) {
+    max_size_ = max_size;
+    enforce_budget();
+}
+
+void DiskFrameCache::drop(const std::string &key) {
+    auto it = index_.find(key);
+    if (it == std::end(index_))
+        return;
+    auto s = segments_.find(it->second.segment);
+    if (s != std::end(segments_))
+        s->second.live -= it->second.length;
+    size_ -= it->second.length;
+    index_.erase(it);
+}
+
+void DiskFrameCache::enforce_budget() {
+    if (size_ > max_size_) {
+        // least recently used first, down to 90% so we aren't doing this on
+        // every store
+        std::vector<std::pair<uint64_t, std::string>> lru;
+        lru.reserve(index_.size());
+        for (const auto &i : index_)
+            lru.emplace_back(i.second.last_used, i.first);
+        std::sort(lru.begin(), lru.end());
+
+        const auto target = max_size_ - max_size_ / 10;
+        for (const auto &i : lru) {
+            if (size_ <= target)
+                break;
+            drop(i.second);
+        }
+    }
+
+    // Reclaim dead space oldest segment first. Compacting in write order
+    // means a tombstone is never removed while the record it hides is still
+    // on disk. Each segment is visited at most once per call.
+    auto passes = segments_.size();
+    while (passes-- and disk_usage() > max_size_) {
+        const auto oldest = segments_.begin()->first;
+        if (segments_.begin()->second.live)
+            compact(oldest);
+        remove_segment(oldest);
+    }
+}
+
+void DiskFrameCache::compact(const uint32_t id) {
+    const auto fd = segments_[id].fd;
+
+    std::vector<std::string> keys;
+    for (const auto &i : index_)
+        if (i.second.segment == id)
+            keys.push_back(i.first);
+
+    for (const auto &key : keys) {
+        const auto entry = index_[key];
+        std::string metadata(entry.meta_size, '\0');
+        std::shared_ptr<const std::byte> data;
+        if (entry.data_size)
+            data = map_data(fd, entry.offset + entry.data_at, entry.data_size);
+
+        if (read_all(
+                fd,
+                metadata.data(),
+                metadata.size(),
+                entry.offset + sizeof(RecordHeader) + key.size()) and
+            (data or not entry.data_size) and
+            append(key, metadata, entry.source, data.get(), entry.data_size, false, id)) {
+            // moving it doesn't make it any more recently used
+            index_[key].last_used = entry.last_used;
+        } else {
+            drop(key);
+        }
+    }
+}
+
+void DiskFrameCache::remove_segment(const uint32_t id) {
+    auto it = segments_.find(id);
+    if (it == std::end(segments_))
+        return;
+
+    for (auto i = std::begin(index_); i != std::end(index_);) {
+        if (i->second.segment == id) {
+            size_ -= i->second.length;
+            i = index_.erase(i);
+        } else {
+            ++i;
+        }
+    }
+
+    close(it->second.fd);
+    std::error_code ec;
+    fs::remove(it->second.path, ec);
+    segments_.erase(it);
+}
@@ -1,5 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <functional>
 #include <malloc.h>
 
@@ -43,6 +45,131 @@ TrimActor::TrimActor(caf::actor_config &cfg) : caf::event_based_actor(cfg) {
     });
 }
 
+namespace {
+
+// Everything needed to rebuild the ImageBuffer around the pixels, except the
+// shader which can't be serialised and is looked up again by its uuid.
+std::string
+disk_metadata(const media::MediaKey &key, const media_reader::ImageBufPtr &buf) {
+    nlohmann::json j;
+    const auto size   = buf->image_size_in_pixels();
+    const auto bounds = buf->image_pixels_bounding_box();
+
+    j["key"]             = to_string(key);
+    j["shader"]          = buf->shader()->shader_id();
+    j["shader_params"]   = buf->shader_params();
+    j["shader_uniforms"] = buf->shader_uniforms().to_json();
+    j["params"]          = buf->params();
+    j["size"]            = {size.x, size.y};
+    j["bounds"]          = {bounds.min.x, bounds.min.y, bounds.max.x, bounds.max.y};
+    j["pixel_aspect"]    = buf->pixel_aspect();
+    j["duration"]        = buf->duration_seconds();
+    j["frame_num"]       = buf->decoder_frame_number();
+    j["has_alpha"]       = buf->has_alpha();
+    if (buf->display_timestamp_seconds_is_set())
+        j["dts"] = buf->display_timestamp_seconds();
+
+    j["layout"] = nlohmann::json::array();
+    for (const auto &plane : buf->pixel_layout()) {
+        j["layout"].push_back(
+            {{"name", plane.name_},
+             {"type", int(plane.data_type_)},
+             {"w", plane.width_},
+             {"h", plane.height_},
+             {"c", plane.channels_},
+             {"off", plane.byte_offset_},
+             {"ps", plane.pixel_stride_},
+             {"rs", plane.row_stride_}});
+    }
+
+    return j.dump();
+}
+
+// The ImageBuffer described by disk_metadata, without its pixels
+media_reader::ImageBufPtr restore_image(const std::string &metadata) {
+    const auto j = nlohmann::json::parse(metadata);
+
+    media_reader::ImageBufPtr buf(new media_reader::ImageBuffer(
+        j.at("shader").get<Uuid>(),
+        JsonStore(j.at("shader_params")),
+        JsonStore(j.at("params"))));
+
+    const auto &size   = j.at("size");
+    const auto &bounds = j.at("bounds");
+    buf->set_image_dimensions(
+        Imath::V2i(size[0].get<int>(), size[1].get<int>()),
+        Imath::Box2i(
+            Imath::V2i(bounds[0].get<int>(), bounds[1].get<int>()),
+            Imath::V2i(bounds[2].get<int>(), bounds[3].get<int>())));
+    buf->set_pixel_aspect(j.at("pixel_aspect").get<float>());
+    buf->set_duration_seconds(j.at("duration").get<double>());
+    buf->set_decoder_frame_number(j.at("frame_num").get<int>());
+    buf->set_has_alpha(j.at("has_alpha").get<bool>());
+    if (j.contains("shader_uniforms"))
+        buf->set_shader_uniforms(ShaderUniforms::from_json(j.at("shader_uniforms")));
+    buf->set_media_key(media::MediaKey(j.at("key").get<std::string>()));
+    if (j.contains("dts"))
+        buf->set_display_timestamp_seconds(j.at("dts").get<double>());
+
+    media_reader::PixelLayout layout;
+    for (const auto &plane : j.at("layout")) {
+        layout.emplace_back(
+            plane.at("name").get<std::string>(),
+            media_reader::PixelDataType(plane.at("type").get<int>()),
+            plane.at("w").get<size_t>(),
+            plane.at("h").get<size_t>(),
+            plane.at("c").get<size_t>(),
+            plane.at("off").get<size_t>(),
+            plane.at("ps").get<size_t>(),
+            plane.at("rs").get<size_t>());
+    }
+    buf->set_pixel_layout(layout);
+
+    return buf;
+}
+
+} // namespace
+
+// Copies frames into the shared memory cache, off the image cache's thread
+class SharedCacheWriterActor : public caf::event_based_actor {
+  public:
+    SharedCacheWriterActor(caf::actor_config &cfg, const std::string &name, const size_t size);
+    ~SharedCacheWriterActor() override = default;
+
+    const char *name() const override { return NAME.c_str(); }
+
+  private:
+    inline static const std::string NAME = "SharedCacheWriterActor";
+    caf::behavior make_behavior() override { return behavior_; }
+
+  private:
+    caf::behavior behavior_;
+    std::unique_ptr<SharedFrameCache> cache_;
+};
+
+SharedCacheWriterActor::SharedCacheWriterActor(
+    caf::actor_config &cfg, const std::string &name, const size_t size)
+    : caf::event_based_actor(cfg) {
+
+    try {
+        cache_ = std::make_unique<SharedFrameCache>(name, size);
+    } catch (const std::exception &err) {
+        spdlog::warn("{} {} {}", __PRETTY_FUNCTION__, name, err.what());
+    }
+
+    behavior_.assign(
+        [=](store_atom, const media::MediaKey &key, const media_reader::ImageBufPtr &buf)
+            -> bool {
+            if (not cache_ or cache_->contains(to_string(key)))
+                return false;
+            return cache_->store(
+                to_string(key),
+                disk_metadata(key, buf),
+                reinterpret_cast<const std::byte *>(buf->const_buffer()),
+                buf->size());
+        });
+}
+
 GlobalImageCacheActor::GlobalImageCacheActor(caf::actor_config &cfg)
     : caf::event_based_actor(cfg), update_pending_(false) {
     print_on_exit(this, "GlobalImageCacheActor");
@@ -57,6 +184,8 @@ GlobalImageCacheActor::GlobalImageCacheActor(caf::actor_config &cfg)
         join_broadcast(this, prefs.get_group(j));
         max_count = preference_value<size_t>(j, "/core/image_cache/max_count");
         max_size  = preference_value<size_t>(j, "/core/image_cache/max_size") * 1024 * 1024;
+        update_disk_cache(j);
+        update_shared_cache(j);
     } catch (...) {
     }
 
@@ -65,6 +194,10 @@ GlobalImageCacheActor::GlobalImageCacheActor(caf::actor_config &cfg)
     cache_.bind_change_callback([this](auto &&PH1, auto &&PH2) {
         update_changes(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2));
     });
+    cache_.bind_evict_callback(
+        [this](const media::MediaKey &key, const media_reader::ImageBufPtr &buf) {
+            demote(key, buf);
+        });
 
     auto event_group_ = spawn<broadcast::BroadcastActor>(this);
     link_to(event_group_);
@@ -76,18 +209,55 @@ GlobalImageCacheActor::GlobalImageCacheActor(caf::actor_config &cfg)
         [=](xstudio::broadcast::broadcast_down_atom, const caf::actor_addr &) {},
         [=](clear_atom) -> bool {
             cache_.clear();
+            on_disk_.clear();
+            if (disk_cache_)
+                anon_send(disk_cache_, clear_atom_v);
+            if (shared_cache_)
+                shared_cache_->clear();
             return true;
         },
 
+        [=](cache_occupancy_atom, const utility::Uuid &id) -> caf::result<OccupancyBitmap> {
+            const auto bitmap = occupancy_.bitmap(id);
+            if (not bitmap)
+                return make_error(xstudio_error::error, "Not tracking cache occupancy");
+            return *bitmap;
+        },
+
+        [=](cache_occupancy_atom, const utility::Uuid &id, const media::MediaKeyVector &keys)
+            -> OccupancyBitmap {
+            if (keys.empty()) {
+                occupancy_.untrack(id);
+                return OccupancyBitmap();
+            }
+            return occupancy_.track(id, keys);
+        },
+
         [=](count_atom) -> size_t { return cache_.count(); },
 
-        [=](erase_atom, const media::MediaKey &key) { cache_.erase(key); },
+        [=](erase_atom, const media::MediaKey &key) {
+            cache_.erase(key);
+            on_disk_.erase(key);
+            if (disk_cache_)
+                anon_send(disk_cache_, erase_atom_v, media::MediaKeyVector({key}));
+            if (shared_cache_)
+                shared_cache_->erase(to_string(key));
+        },
 
         [=](erase_atom, const media::MediaKey &key, const utility::Uuid &uuid) {
             cache_.erase(key, uuid);
         },
 
         [=](erase_atom, const media::MediaKeyVector &keys) -> media::MediaKeyVector {
+            // the source changed, what's on disk is out of date too
+            for (const auto &key : keys)
+                on_disk_.erase(key);
+            if (disk_cache_)
+                anon_send(disk_cache_, erase_atom_v, keys);
+            if (shared_cache_) {
+                for (const auto &key : keys)
+                    shared_cache_->erase(to_string(key));
+            }
             return cache_.erase(keys);
         },
 
@@ -112,6 +282,8 @@ GlobalImageCacheActor::GlobalImageCacheActor(caf::actor_config &cfg)
                     cache_.set_max_size(new_size);
                 if (cache_.max_count() != new_count)
                     cache_.set_max_count(new_count);
+                update_disk_cache(js);
+                update_shared_cache(js);
             } catch (const std::exception &err) {
                 spdlog::warn("{} {}", __PRETTY_FUNCTION__, err.what());
             }
@@ -120,21 +292,19 @@ GlobalImageCacheActor::GlobalImageCacheActor(caf::actor_config &cfg)
         [=](keys_atom) -> media::MediaKeyVector { return cache_.keys(); },
 
         [=](keys_atom, bool) {
-            if (not erased_keys_.empty() or not new_keys_.empty()) {
-                // force purge of memory..
-                if (not erased_keys_.empty())
-                    anon_send(trim, unpreserve_atom_v, erased_keys_.size());
+            // force purge of memory..
+            if (erased_count_)
+                anon_send(trim, unpreserve_atom_v, erased_count_);
 
+            for (const auto &id : occupancy_.take_dirty())
                 send(
                     event_group_,
                     utility::event_atom_v,
-                    media_cache::keys_atom_v,
-                    media::MediaKeyVector(new_keys_.begin(), new_keys_.end()),
-                    media::MediaKeyVector(erased_keys_.begin(), erased_keys_.end()));
-            }
+                    cache_occupancy_atom_v,
+                    id,
+                    *(occupancy_.bitmap(id)));
 
-            new_keys_.clear();
-            erased_keys_.clear();
+            erased_count_   = 0;
             update_pending_ = false;
         },
 
@@ -150,7 +320,7 @@ GlobalImageCacheActor::GlobalImageCacheActor(caf::actor_config &cfg)
         },
 
         [=](preserve_atom, const media::MediaKey &key, const time_point &time, const Uuid &uuid)
-            -> bool { return cache_.preserve(key, time, uuid); },
+            -> caf::result<bool> { return preserve_or_promote(key, time, uuid); },
 
         // given a list of frame pointers, check which frames are in the cache
         // and return a list of those that *aren't* in the cache
@@ -159,7 +329,8 @@ GlobalImageCacheActor::GlobalImageCacheActor(caf::actor_config &cfg)
             const Uuid &uuid) -> media::AVFrameIDsAndTimePoints {
             media::AVFrameIDsAndTimePoints result;
             for (const auto &p : mpts) {
-                if (!cache_.preserve(p.second->key_, p.first, uuid)) {
+                if (!cache_.preserve(p.second->key_, p.first, uuid) and
+                    !in_shared_cache(p.second->key_)) {
                     result.push_back(p);
                 }
             }
@@ -173,8 +344,9 @@ GlobalImageCacheActor::GlobalImageCacheActor(caf::actor_config &cfg)
             return true;
         },
 
-        [=](retrieve_atom, const media::MediaKey &key) -> media_reader::ImageBufPtr {
-            return cache_.retrieve(key);
+        [=](retrieve_atom, const media::MediaKey &key)
+            -> caf::result<media_reader::ImageBufPtr> {
+            return retrieve_or_promote(key, utility::clock::now());
         },
 
         [=](retrieve_atom, const media::AVFrameIDsAndTimePoints &mptr_and_timepoints)
@@ -182,7 +354,9 @@ GlobalImageCacheActor::GlobalImageCacheActor(caf::actor_config &cfg)
             std::vector<media_reader::ImageBufPtr> result(mptr_and_timepoints.size());
             auto r = result.begin();
             for (const auto &p : mptr_and_timepoints) {
-                *r                    = cache_.retrieve(p.second->key_, p.first);
+                *r = cache_.retrieve(p.second->key_, p.first);
+                if (not *r)
+                    *r = retrieve_shared(p.second->key_);
                 (*r).when_to_display_ = p.first;
                 r++;
             }
@@ -190,27 +364,39 @@ GlobalImageCacheActor::GlobalImageCacheActor(caf::actor_config &cfg)
         },
 
         [=](retrieve_atom, const media::MediaKey &key, const time_point &time)
-            -> media_reader::ImageBufPtr { return cache_.retrieve(key, time); },
+            -> caf::result<media_reader::ImageBufPtr> {
+            return retrieve_or_promote(key, time);
+        },
 
         [=](retrieve_atom, const media::MediaKey &key, const time_point &time, const Uuid &uuid)
-            -> media_reader::ImageBufPtr { return cache_.retrieve(key, time, uuid); },
+            -> caf::result<media_reader::ImageBufPtr> {
+            return retrieve_or_promote(key, time, uuid);
+        },
 
         [=](size_atom) -> size_t { return cache_.size(); },
 
         [=](store_atom, const media::MediaKey &key, media_reader::ImageBufPtr buf) -> bool {
+            remember_shader(buf);
+            publish(key, buf);
             return cache_.store(key, buf);
         },
 
         [=](store_atom,
             const media::MediaKey &key,
             const media_reader::ImageBufPtr &buf,
-            const time_point &when) -> bool { return cache_.store(key, buf, when); },
+            const time_point &when) -> bool {
+            remember_shader(buf);
+            publish(key, buf);
+            return cache_.store(key, buf, when);
+        },
 
         [=](store_atom,
             const media::MediaKey &key,
             const media_reader::ImageBufPtr &buf,
             const time_point &when,
             const utility::Uuid &uuid) -> bool {
+            remember_shader(buf);
+            publish(key, buf);
             return cache_.store(key, buf, when, false, uuid);
         },
 
@@ -219,6 +405,8 @@ GlobalImageCacheActor::GlobalImageCacheActor(caf::actor_config &cfg)
             const media_reader::ImageBufPtr &buf,
             const time_point &when,
             const utility::Uuid &uuid) -> bool {
+            remember_shader(buf);
+            publish(key, buf);
             return cache_.store(key, buf, when, false, uuid);
         },
         [=](store_atom,
@@ -227,6 +415,8 @@ GlobalImageCacheActor::GlobalImageCacheActor(caf::actor_config &cfg)
             const time_point &when,
             const utility::Uuid &uuid,
             const time_point &cache_out_date_tp) -> bool {
+            remember_shader(buf);
+            publish(key, buf);
             return cache_.store(key, buf, when, uuid, cache_out_date_tp);
         },
 
@@ -235,16 +425,10 @@ GlobalImageCacheActor::GlobalImageCacheActor(caf::actor_config &cfg)
 
 void GlobalImageCacheActor::update_changes(
     const media::MediaKeyVector &store, const media::MediaKeyVector &erase) {
-    for (const auto &i : store) {
-        new_keys_.insert(i);
-        erased_keys_.erase(i);
-    }
+    occupancy_.update(store, erase);
+    erased_count_ += erase.size();
 
-    for (const auto &i : erase) {
-        new_keys_.erase(i);
-        erased_keys_.insert(i);
-    }
-    if (not update_pending_ and (not new_keys_.empty() or not erased_keys_.empty())) {
+    if (not update_pending_ and (not store.empty() or not erase.empty())) {
         update_pending_ = true;
         delayed_anon_send(this, std::chrono::milliseconds(250), keys_atom_v, true);
     }
@@ -252,6 +436,359 @@ void GlobalImageCacheActor::update_changes(
 
 void GlobalImageCacheActor::on_exit() { system().registry().erase(image_cache_registry); }
 
+void GlobalImageCacheActor::update_disk_cache(const JsonStore &prefs) {
+    const auto enabled =
+        preference_value<bool>(prefs, "/core/image_cache/disk_cache/enabled");
+    const auto path = expand_envvars(
+        preference_value<std::string>(prefs, "/core/image_cache/disk_cache/path"));
+    const auto max_size =
+        preference_value<size_t>(prefs, "/core/image_cache/disk_cache/max_size") * 1024 *
+        1024;
+
+    if (disk_cache_ and (not enabled or path != disk_cache_path_)) {
+        unlink_from(disk_cache_);
+        send_exit(disk_cache_, caf::exit_reason::user_shutdown);
+        disk_cache_ = caf::actor();
+        disk_cache_path_.clear();
+        on_disk_.clear();
+        shaders_.clear();
+    }
+
+    if (not enabled)
+        return;
+
+    if (disk_cache_) {
+        anon_send(disk_cache_, size_atom_v, max_size);
+    } else {
+        disk_cache_      = spawn<ImageDiskCacheActor>(path, max_size);
+        disk_cache_path_ = path;
+        link_to(disk_cache_);
+
+        // what was left on disk last time
+        request(disk_cache_, infinite, keys_atom_v)
+            .then(
+                [=](const std::vector<std::string> &keys) {
+                    for (const auto &key : keys)
+                        on_disk_.insert(media::MediaKey(key));
+                },
+                [=](const caf::error &) {});
+    }
+}
+
+void GlobalImageCacheActor::remember_shader(const media_reader::ImageBufPtr &buf) {
+    if ((disk_cache_ or shared_cache_) and buf and buf->shader() and
+        not shaders_.count(buf->shader()->shader_id())) {
+        shaders_[buf->shader()->shader_id()] =
+            std::make_pair(buf->shader(), buf->pixel_picker_func());
+    }
+}
+
+void GlobalImageCacheActor::demote(
+    const media::MediaKey &key, const media_reader::ImageBufPtr &buf) {
+    // only frames we know how to draw again are worth keeping
+    if (not disk_cache_ or not buf or buf->error_state() != media_reader::NO_ERROR or
+        not buf->size() or not buf->shader())
+        return;
+
+    // if the disk can't keep up we let frames go rather than holding on to
+    // the memory that has just been freed
+    const auto size = buf->size();
+    if (demoting_bytes_ + size > cache_.max_size() / 4)
+        return;
+
+    remember_shader(buf);
+    demoting_bytes_ += size;
+    on_disk_.insert(key);
+    request(disk_cache_, infinite, store_atom_v, key, buf)
+        .then(
+            [=](const bool stored) {
+                demoting_bytes_ -= size;
+                if (not stored)
+                    on_disk_.erase(key);
+            },
+            [=](const caf::error &) {
+                demoting_bytes_ -= size;
+                on_disk_.erase(key);
+            });
+}
+
+bool GlobalImageCacheActor::restore_shader(media_reader::ImageBufPtr &buf) const {
+    const auto shader = shaders_.find(buf->shader_id());
+    if (shader == shaders_.end())
+        return false;
+
+    buf->set_shader(shader->second.first);
+    buf->set_pixel_picker_func(shader->second.second);
+    return true;
+}
+
+media_reader::ImageBufPtr GlobalImageCacheActor::promote(
+    const media::MediaKey &key,
+    media_reader::ImageBufPtr buf,
+    const time_point &time,
+    const Uuid &uuid) {
+
+    // it may have been read again while we were waiting on the disk
+    auto result = cache_.retrieve(key, time, uuid);
+    if (result or not buf or not restore_shader(buf))
+        return result;
+
+    cache_.store(key, buf, time, false, uuid);
+    return buf;
+}
+
+void GlobalImageCacheActor::update_shared_cache(const JsonStore &prefs) {
+    const auto enabled =
+        preference_value<bool>(prefs, "/core/image_cache/shared_cache/enabled");
+    const auto name =
+        preference_value<std::string>(prefs, "/core/image_cache/shared_cache/name");
+    const auto size =
+        preference_value<size_t>(prefs, "/core/image_cache/shared_cache/max_size") * 1024 *
+        1024;
+
+    // the size is fixed by whichever process creates it, only the name matters
+    if (shared_cache_ and enabled and name == shared_cache_->name())
+        return;
+
+    if (shared_cache_writer_) {
+        unlink_from(shared_cache_writer_);
+        send_exit(shared_cache_writer_, caf::exit_reason::user_shutdown);
+        shared_cache_writer_ = caf::actor();
+    }
+    shared_cache_.reset();
+
+    if (not enabled)
+        return;
+
+    try {
+        shared_cache_        = std::make_unique<SharedFrameCache>(name, size);
+        shared_cache_writer_ = spawn<SharedCacheWriterActor>(name, size);
+        link_to(shared_cache_writer_);
+    } catch (const std::exception &err) {
+        spdlog::warn("{} {} {}", __PRETTY_FUNCTION__, name, err.what());
+    }
+}
+
+void GlobalImageCacheActor::publish(
+    const media::MediaKey &key, const media_reader::ImageBufPtr &buf) {
+    // frames that came from the shared cache are already there
+    if (not shared_cache_writer_ or not buf or buf->has_shared_data() or
+        buf->error_state() != media_reader::NO_ERROR or not buf->size() or not buf->shader())
+        return;
+
+    const auto size = buf->size();
+    if (publishing_bytes_ + size > cache_.max_size() / 4)
+        return;
+
+    publishing_bytes_ += size;
+    request(shared_cache_writer_, infinite, store_atom_v, key, buf)
+        .then(
+            [=](const bool) { publishing_bytes_ -= size; },
+            [=](const caf::error &) { publishing_bytes_ -= size; });
+}
+
+media_reader::ImageBufPtr GlobalImageCacheActor::retrieve_shared(const media::MediaKey &key) {
+    if (not shared_cache_ or shaders_.empty())
+        return media_reader::ImageBufPtr();
+
+    try {
+        auto entry = shared_cache_->retrieve(to_string(key));
+        if (not entry)
+            return media_reader::ImageBufPtr();
+
+        // The pixels stay where they are and the buffer holds the slot until
+        // whoever asked for the frame lets go of it. It isn't put in our own
+        // cache, which would pin the slot against stores from every process.
+        auto buf = restore_image(entry->metadata);
+        buf->set_shared_data(
+            reinterpret_cast<const media_reader::byte *>(entry->data.get()),
+            entry->size,
+            entry->data);
+        if (restore_shader(buf))
+            return buf;
+    } catch (const std::exception &err) {
+        spdlog::warn("{} {} {}", __PRETTY_FUNCTION__, to_string(key), err.what());
+    }
+    return media_reader::ImageBufPtr();
+}
+
+bool GlobalImageCacheActor::in_shared_cache(const media::MediaKey &key) const {
+    if (not shared_cache_ or shaders_.empty())
+        return false;
+
+    try {
+        return shared_cache_->contains(to_string(key));
+    } catch (const std::exception &err) {
+        spdlog::warn("{} {} {}", __PRETTY_FUNCTION__, to_string(key), err.what());
+    }
+    return false;
+}
+
+caf::result<media_reader::ImageBufPtr> GlobalImageCacheActor::retrieve_or_promote(
+    const media::MediaKey &key, const time_point &time, const Uuid &uuid) {
+    auto buf = cache_.retrieve(key, time, uuid);
+    if (not buf)
+        buf = retrieve_shared(key);
+    if (buf or not disk_cache_ or not on_disk_.count(key))
+        return buf;
+
+    auto rp = make_response_promise<media_reader::ImageBufPtr>();
+    request(disk_cache_, infinite, retrieve_atom_v, key)
+        .then(
+            [=](const media_reader::ImageBufPtr &disk_buf) mutable {
+                if (not disk_buf)
+                    on_disk_.erase(key);
+                rp.deliver(promote(key, disk_buf, time, uuid));
+            },
+            [=](const caf::error &) mutable { rp.deliver(cache_.retrieve(key, time, uuid)); });
+    return rp;
+}
+
+caf::result<bool> GlobalImageCacheActor::preserve_or_promote(
+    const media::MediaKey &key, const time_point &time, const Uuid &uuid) {
+    if (cache_.preserve(key, time, uuid) or in_shared_cache(key))
+        return true;
+    if (not disk_cache_ or not on_disk_.count(key))
+        return false;
+
+    auto rp = make_response_promise<bool>();
+    request(disk_cache_, infinite, retrieve_atom_v, key)
+        .then(
+            [=](const media_reader::ImageBufPtr &disk_buf) mutable {
+                if (not disk_buf)
+                    on_disk_.erase(key);
+                rp.deliver(bool(promote(key, disk_buf, time, uuid)));
+            },
+            [=](const caf::error &) mutable { rp.deliver(cache_.preserve(key, time, uuid)); });
+    return rp;
+}
+
+ImageDiskCacheActor::ImageDiskCacheActor(
+    caf::actor_config &cfg, const std::string &path, const size_t max_size)
+    : caf::event_based_actor(cfg) {
+    print_on_exit(this, "ImageDiskCacheActor");
+
+    try {
+        cache_ = std::make_unique<DiskFrameCache>(
+            path,
+            max_size,
+            std::clamp(
+                max_size / 16, size_t(64) * 1024 * 1024, size_t(1024) * 1024 * 1024));
+    } catch (const std::exception &err) {
+        spdlog::warn("{} {} {}", __PRETTY_FUNCTION__, path, err.what());
+    }
+
+    behavior_.assign(
+        [=](clear_atom) -> bool {
+            for (auto &write : writes_)
+                write.rp.deliver(false);
+            writes_.clear();
+            if (cache_)
+                cache_->clear();
+            return true;
+        },
+
+        [=](count_atom) -> size_t { return cache_ ? cache_->count() : 0; },
+
+        [=](erase_atom, const media::MediaKeyVector &keys) {
+            for (const auto &key : keys) {
+                auto write = std::find_if(writes_.begin(), writes_.end(), [&](const auto &w) {
+                    return w.key == key;
+                });
+                if (write != writes_.end()) {
+                    write->rp.deliver(false);
+                    writes_.erase(write);
+                }
+                if (cache_)
+                    cache_->erase(to_string(key));
+            }
+        },
+
+        [=](keys_atom) -> std::vector<std::string> {
+            return cache_ ? cache_->keys() : std::vector<std::string>();
+        },
+
+        [=](retrieve_atom, const media::MediaKey &key) -> media_reader::ImageBufPtr {
+            // still waiting to be written, the frame is right here
+            for (const auto &write : writes_) {
+                if (write.key == key)
+                    return write.buf;
+            }
+
+            if (cache_) {
+                try {
+                    if (auto entry = cache_->retrieve(to_string(key))) {
+                        auto buf = restore_image(entry->metadata);
+                        if (entry->size)
+                            std::memcpy(
+                                buf->allocate(entry->size), entry->data.get(), entry->size);
+                        return buf;
+                    }
+                } catch (const std::exception &err) {
+                    spdlog::warn("{} {} {}", __PRETTY_FUNCTION__, to_string(key), err.what());
+                    cache_->erase(to_string(key));
+                }
+            }
+            return media_reader::ImageBufPtr();
+        },
+
+        [=](size_atom) -> size_t { return cache_ ? cache_->size() : 0; },
+
+        [=](size_atom, const size_t new_size) {
+            if (cache_)
+                cache_->set_max_size(new_size);
+        },
+
+        // Writes are queued and done one per message, so a retrieve waits
+        // for at most one of them rather than for everything demoted before
+        // it.
+        [=](store_atom, const media::MediaKey &key, const media_reader::ImageBufPtr &buf)
+            -> caf::result<bool> {
+            if (not cache_ or not buf)
+                return false;
+
+            auto rp = make_response_promise<bool>();
+            writes_.push_back(PendingWrite{key, buf, rp});
+            if (writes_.size() == 1)
+                send(this, store_atom_v);
+            return rp;
+        },
+
+        [=](store_atom) {
+            if (writes_.empty())
+                return;
+
+            auto write = writes_.front();
+            writes_.pop_front();
+            if (not writes_.empty())
+                send(this, store_atom_v);
+
+            write.rp.deliver(store(write.key, write.buf));
+        });
+}
+
+bool ImageDiskCacheActor::store(
+    const media::MediaKey &key, const media_reader::ImageBufPtr &buf) {
+    if (not cache_)
+        return false;
+    // evicted again after being promoted, it's still on disk
+    if (cache_->contains(to_string(key)))
+        return true;
+
+    // readers record the file a frame came from, so a frame that has been
+    // rendered again since isn't read back
+    std::string source;
+    if (buf->params().contains("path") and buf->params()["path"].is_string())
+        source = buf->params()["path"].get<std::string>();
+
+    return cache_->store(
+        to_string(key),
+        disk_metadata(key, buf),
+        reinterpret_cast<const std::byte *>(buf->const_buffer()),
+        buf->size(),
+        source);
+}
+
 
 GlobalAudioCacheActor::GlobalAudioCacheActor(caf::actor_config &cfg)
     : caf::event_based_actor(cfg), update_pending_(false) {
@@ -285,6 +822,22 @@ GlobalAudioCacheActor::GlobalAudioCacheActor(caf::actor_config &cfg)
             return true;
         },
 
+        [=](cache_occupancy_atom, const utility::Uuid &id) -> caf::result<OccupancyBitmap> {
+            const auto bitmap = occupancy_.bitmap(id);
+            if (not bitmap)
+                return make_error(xstudio_error::error, "Not tracking cache occupancy");
+            return *bitmap;
+        },
+
+        [=](cache_occupancy_atom, const utility::Uuid &id, const media::MediaKeyVector &keys)
+            -> OccupancyBitmap {
+            if (keys.empty()) {
+                occupancy_.untrack(id);
+                return OccupancyBitmap();
+            }
+            return occupancy_.track(id, keys);
+        },
+
         [=](count_atom) -> size_t { return cache_.count(); },
 
         [=](erase_atom, const media::MediaKey &key) { cache_.erase(key); },
@@ -323,16 +876,14 @@ GlobalAudioCacheActor::GlobalAudioCacheActor(caf::actor_config &cfg)
         [=](keys_atom) -> media::MediaKeyVector { return cache_.keys(); },
 
         [=](keys_atom, bool) {
-            if (not erased_keys_.empty() or not new_keys_.empty())
+            for (const auto &id : occupancy_.take_dirty())
                 send(
                     event_group_,
                     utility::event_atom_v,
-                    media_cache::keys_atom_v,
-                    media::MediaKeyVector(new_keys_.begin(), new_keys_.end()),
-                    media::MediaKeyVector(erased_keys_.begin(), erased_keys_.end()));
+                    cache_occupancy_atom_v,
+                    id,
+                    *(occupancy_.bitmap(id)));
 
-            new_keys_.clear();
-            erased_keys_.clear();
             update_pending_ = false;
         },
 
@@ -418,16 +969,9 @@ void GlobalAudioCacheActor::on_exit() { system().registry().erase(audio_cache_re
 
 void GlobalAudioCacheActor::update_changes(
     const media::MediaKeyVector &store, const media::MediaKeyVector &erase) {
-    for (const auto &i : store) {
-        new_keys_.insert(i);
-        erased_keys_.erase(i);
-    }
+    occupancy_.update(store, erase);
 
-    for (const auto &i : erase) {
-        new_keys_.erase(i);
-        erased_keys_.insert(i);
-    }
-    if (not update_pending_ and (not new_keys_.empty() or not erased_keys_.empty())) {
+    if (not update_pending_ and (not store.empty() or not erase.empty())) {
         update_pending_ = true;
         delayed_anon_send(this, std::chrono::milliseconds(250), keys_atom_v, true);
     }
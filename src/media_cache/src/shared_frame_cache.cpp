@@ -0,0 +1,483 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fmt/format.h>
+#include <mutex>
+#include <pthread.h>
+#include <signal.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "xstudio/media_cache/shared_frame_cache.hpp"
+
+using namespace xstudio::media_cache;
+
+namespace {
+
+constexpr uint32_t k_magic   = 0x43485358; // XSHC
+constexpr uint32_t k_version = 2;
+constexpr uint64_t k_align   = 4096;
+// how far along the table a key can be from its hash, which bounds the cost
+// of a miss
+constexpr uint32_t k_max_probe = 32;
+// one bit each in a slot's holders
+constexpr uint32_t k_max_attachers = 64;
+
+enum SlotState : uint32_t { SS_EMPTY = 0, SS_WRITING, SS_READY, SS_EVICTING, SS_DEAD };
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t mapped_size;
+    uint64_t data_at;
+    uint64_t capacity;
+    uint32_t slot_count;
+    std::atomic<uint32_t> ready;
+    pthread_mutex_t mutex;
+    // the rest are only written with the mutex held
+    uint64_t head;
+    std::atomic<uint64_t> used;
+    std::atomic<uint64_t> count;
+    // set by the last process to detach, just before it unlinks the arena
+    std::atomic<uint32_t> closed;
+    // pid of each attached process, 0 when free
+    std::atomic<int32_t> attachers[k_max_attachers];
+};
+
+uint64_t round_up(const uint64_t v) { return (v + k_align - 1) & ~(k_align - 1); }
+
+uint64_t fnv1a(const std::string &key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const auto c : key) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string shm_name(const std::string &name) { return "/" + name; }
+
+} // namespace
+
+struct SharedFrameCache::Slot {
+    std::atomic<uint32_t> state;
+    // a bit for each attached process that holds references on the slot
+    std::atomic<uint64_t> holders;
+    std::atomic<uint64_t> hash;
+    // the rest are only valid while the slot is SS_READY
+    uint64_t offset;
+    uint64_t length;
+    uint64_t data_at;
+    uint64_t data_size;
+    uint32_t key_size;
+    uint32_t meta_size;
+};
+
+struct SharedFrameCache::Arena {
+    ~Arena();
+
+    // false if the arena was closed by the last process while we opened it
+    bool open(const size_t size);
+    void lock();
+    void unlock() { pthread_mutex_unlock(&header->mutex); }
+    // drop the references of processes that died without detaching, with the
+    // lock held
+    void reap();
+
+    void acquire(Slot &slot);
+    void release(Slot &slot);
+
+    std::string name;
+    void *base         = {MAP_FAILED};
+    size_t mapped_size = {0};
+    Header *header     = {nullptr};
+    Slot *slots        = {nullptr};
+    std::byte *data    = {nullptr};
+    int attacher       = {-1};
+
+    // this process's references on each slot, the holders bit is set while
+    // there are any
+    std::mutex refs_mutex;
+    std::vector<uint32_t> refs;
+};
+
+SharedFrameCache::Arena::~Arena() {
+    if (attacher >= 0) {
+        lock();
+        header->attachers[attacher].store(0);
+        reap();
+
+        auto last = true;
+        for (uint32_t i = 0; i < k_max_attachers and last; i++)
+            last = header->attachers[i].load() == 0;
+        if (last) {
+            header->closed.store(1);
+            shm_unlink(shm_name(name).c_str());
+        }
+        unlock();
+    }
+
+    if (base != MAP_FAILED)
+        munmap(base, mapped_size);
+}
+
+bool SharedFrameCache::Arena::open(const size_t size) {
+    bool create = true;
+    int fd      = shm_open(shm_name(name).c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 and errno == EEXIST) {
+        create = false;
+        fd     = shm_open(shm_name(name).c_str(), O_RDWR, 0600);
+    }
+    if (fd < 0)
+        throw std::runtime_error(
+            fmt::format("Failed to open shared memory {} {}", name, std::strerror(errno)));
+
+    const auto slot_count = std::clamp<uint64_t>(size / (512 * 1024), 1024, 65536);
+    const auto data_at    = round_up(sizeof(Header) + slot_count * sizeof(Slot));
+    const auto capacity   = size & ~(k_align - 1);
+
+    if (create) {
+        // fresh pages are zero, which leaves every slot SS_EMPTY
+        if (ftruncate(fd, data_at + capacity) != 0) {
+            const auto err = std::strerror(errno);
+            close(fd);
+            shm_unlink(shm_name(name).c_str());
+            throw std::runtime_error(
+                fmt::format("Failed to size shared memory {} {}", name, err));
+        }
+        mapped_size = data_at + capacity;
+    } else {
+        // the creator may not have sized it yet
+        struct stat st = {};
+        for (int i = 0; i < 1000; i++) {
+            if (fstat(fd, &st) == 0 and size_t(st.st_size) > sizeof(Header))
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        mapped_size = st.st_size;
+    }
+
+    if (mapped_size > sizeof(Header))
+        base = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        throw std::runtime_error(fmt::format("Failed to map shared memory {}", name));
+
+    header = static_cast<Header *>(base);
+
+    if (create) {
+        header->magic       = k_magic;
+        header->version     = k_version;
+        header->mapped_size = mapped_size;
+        header->data_at     = data_at;
+        header->capacity    = capacity;
+        header->slot_count  = slot_count;
+
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&header->mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+
+        header->ready.store(1);
+    } else {
+        for (int i = 0; i < 1000 and not header->ready.load(); i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        if (not header->ready.load() or header->magic != k_magic or
+            header->version != k_version or header->mapped_size != mapped_size)
+            throw std::runtime_error(fmt::format(
+                "Shared memory {} isn't a frame cache, or is from another version", name));
+    }
+
+    slots = reinterpret_cast<Slot *>(static_cast<std::byte *>(base) + sizeof(Header));
+    data  = static_cast<std::byte *>(base) + header->data_at;
+    refs.resize(header->slot_count, 0);
+
+    // register ourselves, so the last one out can remove the arena
+    lock();
+    if (header->closed.load()) {
+        unlock();
+        return false;
+    }
+    reap();
+    const int32_t pid = getpid();
+    for (uint32_t i = 0; i < k_max_attachers and attacher < 0; i++) {
+        int32_t expected = 0;
+        if (header->attachers[i].compare_exchange_strong(expected, pid))
+            attacher = i;
+    }
+    unlock();
+
+    if (attacher < 0)
+        throw std::runtime_error(
+            fmt::format("Too many processes attached to shared memory {}", name));
+
+    return true;
+}
+
+void SharedFrameCache::Arena::lock() {
+    const auto result = pthread_mutex_lock(&header->mutex);
+    if (result == EOWNERDEAD) {
+        // a process died holding the lock, throw away whatever it was writing
+        for (uint32_t i = 0; i < header->slot_count; i++) {
+            auto &slot = slots[i];
+            if (slot.state.load() == SS_WRITING)
+                slot.state.store(SS_DEAD);
+            else if (slot.state.load() == SS_EVICTING)
+                slot.state.store(SS_READY);
+        }
+        pthread_mutex_consistent(&header->mutex);
+    } else if (result != 0) {
+        throw std::runtime_error(
+            fmt::format("Failed to lock shared memory {} {}", name, std::strerror(result)));
+    }
+}
+
+void SharedFrameCache::Arena::reap() {
+    // pids are checked rather than leased, so this relies on the processes
+    // sharing a pid namespace, and on a reused pid being rare
+    for (uint32_t i = 0; i < k_max_attachers; i++) {
+        const auto pid = header->attachers[i].load();
+        if (pid == 0 or int(i) == attacher or kill(pid, 0) == 0 or errno != ESRCH)
+            continue;
+
+        const auto mask = ~(uint64_t(1) << i);
+        for (uint32_t s = 0; s < header->slot_count; s++)
+            slots[s].holders.fetch_and(mask);
+        header->attachers[i].store(0);
+    }
+}
+
+void SharedFrameCache::Arena::acquire(Slot &slot) {
+    std::lock_guard<std::mutex> guard(refs_mutex);
+    if (refs[&slot - slots]++ == 0)
+        slot.holders.fetch_or(uint64_t(1) << attacher);
+}
+
+void SharedFrameCache::Arena::release(Slot &slot) {
+    std::lock_guard<std::mutex> guard(refs_mutex);
+    if (--refs[&slot - slots] == 0)
+        slot.holders.fetch_and(~(uint64_t(1) << attacher));
+}
+
+SharedFrameCache::SharedFrameCache(const std::string &name, const size_t size) : name_(name) {
+
+    if (name.empty() or name.find('/') != std::string::npos)
+        throw std::runtime_error(fmt::format("Invalid shared frame cache name \"{}\"", name));
+
+    // if the last process detaches between our open and our attach, the name
+    // is gone and we go round again to make a new arena
+    for (int i = 0; i < 100 and not arena_; i++) {
+        auto arena  = std::make_shared<Arena>();
+        arena->name = name;
+        if (arena->open(size))
+            arena_ = arena;
+    }
+    if (not arena_)
+        throw std::runtime_error(fmt::format("Failed to attach to shared memory {}", name));
+}
+
+SharedFrameCache::~SharedFrameCache() = default;
+
+void SharedFrameCache::unlink(const std::string &name) { shm_unlink(shm_name(name).c_str()); }
+
+SharedFrameCache::Slot *
+SharedFrameCache::find(const std::string &key, const uint64_t hash) const {
+    const auto &arena = *arena_;
+    const auto n      = arena.header->slot_count;
+
+    for (uint32_t i = 0; i < k_max_probe; i++) {
+        auto &slot       = arena.slots[(hash + i) % n];
+        const auto state = slot.state.load();
+        if (state == SS_EMPTY)
+            break;
+        if (state != SS_READY or slot.hash.load() != hash)
+            continue;
+
+        // Take a reference then check it's still the entry we want. Eviction
+        // marks the slot before it looks at the references, so either it
+        // sees ours or we see its mark.
+        arena_->acquire(slot);
+        if (slot.state.load() == SS_READY and slot.hash.load() == hash and
+            slot.key_size == key.size() and
+            std::memcmp(arena.data + slot.offset, key.data(), key.size()) == 0)
+            return &slot;
+        arena_->release(slot);
+    }
+
+    return nullptr;
+}
+
+bool SharedFrameCache::evict(Slot &slot) {
+    slot.state.store(SS_EVICTING);
+    if (slot.holders.load() != 0) {
+        // the holder may be a process that has gone
+        arena_->reap();
+        if (slot.holders.load() != 0) {
+            slot.state.store(SS_READY);
+            return false;
+        }
+    }
+    slot.state.store(SS_DEAD);
+    arena_->header->used -= slot.length;
+    arena_->header->count -= 1;
+    return true;
+}
+
+bool SharedFrameCache::store(
+    const std::string &key,
+    const std::string &metadata,
+    const std::byte *data,
+    const size_t size) {
+
+    auto &arena           = *arena_;
+    auto &header          = *arena.header;
+    const auto hash       = fnv1a(key);
+    const auto data_at    = round_up(key.size() + metadata.size());
+    const uint64_t length = data_at + round_up(size);
+
+    if (length > header.capacity)
+        return false;
+
+    arena.lock();
+
+    if (auto *existing = find(key, hash)) {
+        arena.release(*existing);
+        arena.unlock();
+        return true;
+    }
+
+    // The data area is used as a ring, so what is in the way is the oldest
+    // data. Anything still in use stops us, and the next store starts after
+    // it rather than waiting for it.
+    uint64_t offset = header.head;
+    if (offset + length > header.capacity)
+        offset = 0;
+
+    for (uint32_t i = 0; i < header.slot_count; i++) {
+        auto &slot = arena.slots[i];
+        if (slot.state.load() != SS_READY or slot.offset >= offset + length or
+            slot.offset + slot.length <= offset)
+            continue;
+        if (not evict(slot)) {
+            header.head = slot.offset + slot.length;
+            arena.unlock();
+            return false;
+        }
+    }
+
+    // first free slot near the hash, or failing that the first one not in use
+    Slot *target = nullptr;
+    for (uint32_t i = 0; i < k_max_probe and not target; i++) {
+        auto &slot = arena.slots[(hash + i) % header.slot_count];
+        if (slot.state.load() == SS_EMPTY or slot.state.load() == SS_DEAD)
+            target = &slot;
+    }
+    for (uint32_t i = 0; i < k_max_probe and not target; i++) {
+        auto &slot = arena.slots[(hash + i) % header.slot_count];
+        if (evict(slot))
+            target = &slot;
+    }
+    if (not target) {
+        arena.unlock();
+        return false;
+    }
+
+    target->state.store(SS_WRITING);
+    target->offset    = offset;
+    target->length    = length;
+    target->data_at   = data_at;
+    target->data_size = size;
+    target->key_size  = key.size();
+    target->meta_size = metadata.size();
+
+    std::memcpy(arena.data + offset, key.data(), key.size());
+    std::memcpy(arena.data + offset + key.size(), metadata.data(), metadata.size());
+    if (size)
+        std::memcpy(arena.data + offset + data_at, data, size);
+
+    target->hash.store(hash);
+    target->state.store(SS_READY);
+
+    header.head = offset + length;
+    header.used += length;
+    header.count += 1;
+
+    arena.unlock();
+    return true;
+}
+
+std::optional<SharedFrameCache::Entry>
+SharedFrameCache::retrieve(const std::string &key) const {
+    auto *slot = find(key, fnv1a(key));
+    if (not slot)
+        return {};
+
+    const auto *record = arena_->data + slot->offset;
+
+    Entry entry;
+    entry.metadata.assign(
+        reinterpret_cast<const char *>(record) + slot->key_size, slot->meta_size);
+    entry.size = slot->data_size;
+    // the arena stays mapped for as long as the data is held
+    entry.data = std::shared_ptr<const std::byte>(
+        record + slot->data_at,
+        [arena = arena_, slot](const std::byte *) { arena->release(*slot); });
+
+    return entry;
+}
+
+bool SharedFrameCache::contains(const std::string &key) const {
+    auto *slot = find(key, fnv1a(key));
+    if (slot)
+        arena_->release(*slot);
+    return slot != nullptr;
+}
+
+bool SharedFrameCache::erase(const std::string &key) {
+    arena_->lock();
+    auto *slot  = find(key, fnv1a(key));
+    auto result = false;
+    if (slot) {
+        arena_->release(*slot);
+        result = evict(*slot);
+    }
+    arena_->unlock();
+    return result;
+}
+
+void SharedFrameCache::clear() {
+    auto &header = *arena_->header;
+
+    arena_->lock();
+    for (uint32_t i = 0; i < header.slot_count; i++) {
+        if (arena_->slots[i].state.load() == SS_READY)
+            evict(arena_->slots[i]);
+    }
+
+    // with nothing left the dead slots can go too, which keeps lookups short
+    if (header.count.load() == 0) {
+        for (uint32_t i = 0; i < header.slot_count; i++)
+            arena_->slots[i].state.store(SS_EMPTY);
+        header.head = 0;
+    }
+    arena_->unlock();
+}
+
+size_t SharedFrameCache::size() const { return arena_->header->used.load(); }
+
+size_t SharedFrameCache::count() const { return arena_->header->count.load(); }
+
+size_t SharedFrameCache::capacity() const { return arena_->header->capacity; }
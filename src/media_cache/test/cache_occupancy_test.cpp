@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <gtest/gtest.h>
+
+#include "xstudio/media_cache/cache_occupancy.hpp"
+
+using namespace xstudio;
+using namespace xstudio::media;
+using namespace xstudio::media_cache;
+using namespace xstudio::utility;
+
+namespace {
+
+MediaKeyVector make_keys(const std::string &name, const int count) {
+    MediaKeyVector result;
+    for (int i = 0; i < count; i++)
+        result.emplace_back(MediaKey(name + "@" + std::to_string(i)));
+    return result;
+}
+
+} // namespace
+
+TEST(CacheOccupancyTest, Test) {
+    CacheOccupancy occupancy;
+    const auto a = make_keys("a", 10);
+    const auto b = make_keys("b", 10);
+
+    // cached before anyone tracked it
+    occupancy.update({a[0], a[1]}, {});
+    EXPECT_TRUE(occupancy.cached(a[0]));
+
+    const Uuid source = Uuid::generate();
+    EXPECT_EQ(occupancy.track(source, a).runs(), std::vector<uint32_t>({0, 2, 8}));
+    EXPECT_TRUE(occupancy.take_dirty().empty());
+
+    // a timeline made of the back half of a then the front half of b
+    MediaKeyVector timeline_keys(a.begin() + 5, a.end());
+    timeline_keys.insert(timeline_keys.end(), b.begin(), b.begin() + 5);
+    timeline_keys.emplace_back(MediaKey());
+    const Uuid timeline = Uuid::generate();
+    occupancy.track(timeline, timeline_keys);
+    EXPECT_EQ(occupancy.tracked(), size_t(2));
+
+    occupancy.update({a[5], b[0], b[9]}, {a[0]});
+    auto dirty = occupancy.take_dirty();
+    EXPECT_EQ(dirty.size(), size_t(2));
+    EXPECT_TRUE(occupancy.take_dirty().empty());
+
+    EXPECT_FALSE(occupancy.bitmap(source)->test(0));
+    EXPECT_TRUE(occupancy.bitmap(source)->test(5));
+    EXPECT_TRUE(occupancy.bitmap(timeline)->test(0));
+    EXPECT_TRUE(occupancy.bitmap(timeline)->test(5));
+    EXPECT_EQ(occupancy.bitmap(timeline)->count(), size_t(2));
+
+    // b[9] isn't in either, storing it again changes nothing
+    occupancy.update({b[9]}, {});
+    EXPECT_TRUE(occupancy.take_dirty().empty());
+
+    // retracking carries the version on
+    const auto version = occupancy.bitmap(timeline)->version();
+    EXPECT_GT(occupancy.track(timeline, b).version(), version);
+    EXPECT_EQ(occupancy.bitmap(timeline)->runs(), std::vector<uint32_t>({0, 1, 8, 1}));
+
+    occupancy.untrack(source);
+    occupancy.update({}, {a[5]});
+    EXPECT_TRUE(occupancy.take_dirty().empty());
+    EXPECT_EQ(occupancy.bitmap(source), nullptr);
+    EXPECT_EQ(occupancy.tracked(), size_t(1));
+}
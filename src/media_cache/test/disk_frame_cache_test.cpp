@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <cstring>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "xstudio/media_cache/disk_frame_cache.hpp"
+
+using namespace xstudio::media_cache;
+
+namespace {
+
+class TempDir {
+  public:
+    TempDir() {
+        char tmpl[] = "/tmp/xstudio_disk_frame_cache_XXXXXX";
+        path_       = mkdtemp(tmpl);
+    }
+    ~TempDir() { fs::remove_all(path_); }
+    const fs::path &path() const { return path_; }
+
+  private:
+    fs::path path_;
+};
+
+std::vector<std::byte> make_data(const size_t size, const int seed) {
+    std::vector<std::byte> result(size);
+    for (size_t i = 0; i < size; i++)
+        result[i] = std::byte((i * 31 + seed) & 0xff);
+    return result;
+}
+
+bool matches(const DiskFrameCache::Entry &entry, const std::vector<std::byte> &data) {
+    return entry.size == data.size() and
+           std::memcmp(entry.data.get(), data.data(), data.size()) == 0;
+}
+
+} // namespace
+
+TEST(DiskFrameCacheTest, Test) {
+    TempDir dir;
+    const auto a = make_data(100000, 1);
+    const auto b = make_data(5000, 2);
+
+    {
+        DiskFrameCache cache(dir.path());
+        EXPECT_TRUE(cache.store("a", "{\"w\":10}", a.data(), a.size()));
+        EXPECT_TRUE(cache.store("b", "", b.data(), b.size()));
+        EXPECT_EQ(cache.count(), size_t(2));
+        EXPECT_EQ(cache.keys().size(), size_t(2));
+        EXPECT_GE(cache.size(), a.size() + b.size());
+        EXPECT_EQ(cache.size(), cache.disk_usage());
+
+        auto entry = cache.retrieve("a");
+        ASSERT_TRUE(entry);
+        EXPECT_EQ(entry->metadata, "{\"w\":10}");
+        EXPECT_TRUE(matches(*entry, a));
+        EXPECT_FALSE(cache.retrieve("c"));
+
+        // only one process at a time
+        EXPECT_THROW(DiskFrameCache(dir.path()), std::runtime_error);
+
+        // replaced and erased entries stay that way after a restart
+        EXPECT_TRUE(cache.store("b", "2", a.data(), a.size()));
+        EXPECT_TRUE(cache.erase("a"));
+        EXPECT_FALSE(cache.erase("a"));
+
+        // the mapping outlives the entry
+        EXPECT_TRUE(matches(*entry, a));
+    }
+
+    {
+        DiskFrameCache cache(dir.path());
+        EXPECT_EQ(cache.count(), size_t(1));
+        EXPECT_FALSE(cache.contains("a"));
+        auto entry = cache.retrieve("b");
+        ASSERT_TRUE(entry);
+        EXPECT_EQ(entry->metadata, "2");
+        EXPECT_TRUE(matches(*entry, a));
+
+        cache.clear();
+        EXPECT_EQ(cache.count(), size_t(0));
+        EXPECT_EQ(cache.disk_usage(), size_t(0));
+    }
+
+    EXPECT_EQ(DiskFrameCache(dir.path()).count(), size_t(0));
+}
+
+TEST(DiskFrameCacheTest, TornWrite) {
+    TempDir dir;
+    const auto a = make_data(10000, 3);
+    {
+        DiskFrameCache cache(dir.path());
+        cache.store("a", "", a.data(), a.size());
+        cache.store("b", "", a.data(), a.size());
+    }
+
+    // chop the end off the last record
+    const auto segment = dir.path() / "segment_00000000.xsfc";
+    fs::resize_file(segment, fs::file_size(segment) - 100);
+
+    DiskFrameCache cache(dir.path());
+    EXPECT_TRUE(cache.contains("a"));
+    EXPECT_FALSE(cache.contains("b"));
+
+    // and we carry on writing where the good records end
+    EXPECT_TRUE(cache.store("c", "", a.data(), a.size()));
+    EXPECT_TRUE(matches(*cache.retrieve("c"), a));
+}
+
+TEST(DiskFrameCacheTest, Budget) {
+    TempDir dir;
+    const auto frame = make_data(40960, 4);
+
+    // room for 10 frames, 3 to a segment
+    DiskFrameCache cache(dir.path(), 460000, 140000);
+    for (int i = 0; i < 10; i++)
+        cache.store(std::to_string(i), "", frame.data(), frame.size());
+    EXPECT_EQ(cache.count(), size_t(10));
+
+    // keep 0 in use, the others age
+    for (int i = 10; i < 20; i++) {
+        cache.retrieve("0");
+        cache.store(std::to_string(i), "", frame.data(), frame.size());
+    }
+
+    EXPECT_LE(cache.size(), cache.max_size());
+    EXPECT_LE(cache.disk_usage(), cache.max_size());
+    EXPECT_TRUE(cache.contains("0"));
+    EXPECT_TRUE(cache.contains("19"));
+    EXPECT_FALSE(cache.contains("1"));
+    EXPECT_TRUE(matches(*cache.retrieve("0"), frame));
+
+    // 0 was copied out of the first segment before it was deleted
+    EXPECT_FALSE(fs::exists(dir.path() / "segment_00000000.xsfc"));
+
+    // only the most recently used is left, and the space it shared is freed
+    cache.set_max_size(100000);
+    EXPECT_LE(cache.disk_usage(), size_t(100000));
+    EXPECT_EQ(cache.count(), size_t(1));
+    EXPECT_TRUE(matches(*cache.retrieve("0"), frame));
+
+    EXPECT_FALSE(cache.store("big", "", frame.data(), 200000));
+}
+
+TEST(DiskFrameCacheTest, Source) {
+    TempDir dir;
+    const auto a      = make_data(10000, 5);
+    const auto source = dir.path() / "frame.0001.exr";
+    std::ofstream(source) << "first render";
+
+    {
+        DiskFrameCache cache(dir.path() / "cache");
+        EXPECT_TRUE(cache.store("a", "", a.data(), a.size(), source));
+        EXPECT_TRUE(cache.store("b", "", a.data(), a.size(), source));
+        EXPECT_FALSE(cache.store("c", "", a.data(), a.size(), dir.path() / "missing.exr"));
+        EXPECT_TRUE(cache.retrieve("a"));
+    }
+
+    // the source is remembered across a restart
+    DiskFrameCache cache(dir.path() / "cache");
+    EXPECT_TRUE(matches(*cache.retrieve("a"), a));
+
+    // rendered again, same size but newer
+    fs::last_write_time(source, fs::last_write_time(source) + std::chrono::seconds(1));
+    EXPECT_FALSE(cache.retrieve("a"));
+    EXPECT_FALSE(cache.contains("a"));
+
+    // and a different size
+    std::ofstream(source) << "second render, longer";
+    EXPECT_FALSE(cache.retrieve("b"));
+    EXPECT_EQ(cache.count(), size_t(0));
+}
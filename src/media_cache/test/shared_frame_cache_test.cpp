@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "xstudio/media_cache/shared_frame_cache.hpp"
+
+using namespace xstudio::media_cache;
+
+namespace {
+
+class SharedName {
+  public:
+    SharedName() : name_("xstudio_shared_frame_cache_test_" + std::to_string(getpid())) {
+        SharedFrameCache::unlink(name_);
+    }
+    ~SharedName() { SharedFrameCache::unlink(name_); }
+    const std::string &name() const { return name_; }
+
+  private:
+    std::string name_;
+};
+
+std::vector<std::byte> make_data(const size_t size, const int seed) {
+    std::vector<std::byte> result(size);
+    for (size_t i = 0; i < size; i++)
+        result[i] = std::byte((i * 31 + seed) & 0xff);
+    return result;
+}
+
+bool exists(const std::string &name) {
+    const auto fd = shm_open(("/" + name).c_str(), O_RDONLY, 0600);
+    if (fd >= 0)
+        close(fd);
+    return fd >= 0;
+}
+
+bool matches(const SharedFrameCache::Entry &entry, const std::vector<std::byte> &data) {
+    return entry.size == data.size() and
+           std::memcmp(entry.data.get(), data.data(), data.size()) == 0;
+}
+
+} // namespace
+
+TEST(SharedFrameCacheTest, Test) {
+    SharedName name;
+    const auto a = make_data(100000, 1);
+    const auto b = make_data(5000, 2);
+
+    SharedFrameCache cache(name.name(), 16 * 1024 * 1024);
+    EXPECT_EQ(cache.capacity(), size_t(16 * 1024 * 1024));
+    EXPECT_TRUE(cache.store("a", "{\"w\":10}", a.data(), a.size()));
+    EXPECT_TRUE(cache.store("b", "", b.data(), b.size()));
+    EXPECT_EQ(cache.count(), size_t(2));
+    EXPECT_GE(cache.size(), a.size() + b.size());
+
+    auto entry = cache.retrieve("a");
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(entry->metadata, "{\"w\":10}");
+    EXPECT_TRUE(matches(*entry, a));
+    EXPECT_FALSE(cache.retrieve("c"));
+
+    // a second handle on the same arena sees the same memory, no copies
+    SharedFrameCache other(name.name(), 1);
+    EXPECT_EQ(other.capacity(), cache.capacity());
+    auto other_entry = other.retrieve("a");
+    ASSERT_TRUE(other_entry);
+    EXPECT_TRUE(matches(*other_entry, a));
+
+    // in use, so it stays
+    EXPECT_FALSE(cache.erase("a"));
+    entry.reset();
+    other_entry.reset();
+    EXPECT_TRUE(cache.erase("a"));
+    EXPECT_FALSE(other.contains("a"));
+    EXPECT_TRUE(other.contains("b"));
+
+    cache.clear();
+    EXPECT_EQ(other.count(), size_t(0));
+    EXPECT_EQ(other.size(), size_t(0));
+
+    EXPECT_THROW(SharedFrameCache("a/b", 1024), std::runtime_error);
+}
+
+TEST(SharedFrameCacheTest, Ring) {
+    SharedName name;
+    const auto frame = make_data(1024 * 1024, 3);
+
+    // room for 3 frames with their keys
+    SharedFrameCache cache(name.name(), 3 * (1024 * 1024 + 4096));
+    for (int i = 0; i < 3; i++)
+        EXPECT_TRUE(cache.store(std::to_string(i), "", frame.data(), frame.size()));
+    EXPECT_EQ(cache.count(), size_t(3));
+
+    // the oldest goes first
+    EXPECT_TRUE(cache.store("3", "", frame.data(), frame.size()));
+    EXPECT_FALSE(cache.contains("0"));
+    EXPECT_TRUE(cache.contains("1"));
+    EXPECT_TRUE(cache.contains("3"));
+
+    // unless something is using it, then the store fails and the next one
+    // goes after it
+    auto held = cache.retrieve("1");
+    EXPECT_FALSE(cache.store("4", "", frame.data(), frame.size()));
+    EXPECT_TRUE(cache.store("5", "", frame.data(), frame.size()));
+    EXPECT_TRUE(matches(*held, frame));
+    EXPECT_TRUE(cache.contains("1"));
+    EXPECT_FALSE(cache.contains("2"));
+    EXPECT_TRUE(cache.contains("5"));
+
+    EXPECT_FALSE(cache.store("big", "", frame.data(), 4 * frame.size()));
+}
+
+TEST(SharedFrameCacheTest, Processes) {
+    // One process decodes, the other plays. Frames the first has stored are
+    // read in place by the second instead of being decoded again.
+    SharedName name;
+    const int frames = 48;
+    const auto frame = make_data(2 * 1024 * 1024, 4);
+
+    SharedFrameCache cache(name.name(), size_t(frames + 1) * (frame.size() + 4096));
+
+    const auto child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        SharedFrameCache producer(name.name(), 0);
+        for (int i = 0; i < frames; i++)
+            producer.store(std::to_string(i), "", frame.data(), frame.size());
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+
+    int hits = 0;
+    for (int i = 0; i < frames; i++) {
+        auto entry = cache.retrieve(std::to_string(i));
+        if (entry and matches(*entry, frame))
+            hits++;
+    }
+
+    EXPECT_EQ(hits, frames);
+}
+
+TEST(SharedFrameCacheTest, Unlink) {
+    SharedName name;
+    const auto a = make_data(1000, 5);
+
+    std::optional<SharedFrameCache::Entry> entry;
+    {
+        SharedFrameCache cache(name.name(), 1024 * 1024);
+        {
+            SharedFrameCache other(name.name(), 0);
+            EXPECT_TRUE(other.store("a", "", a.data(), a.size()));
+        }
+        EXPECT_TRUE(exists(name.name()));
+        entry = cache.retrieve("a");
+    }
+
+    // an entry keeps the arena mapped, and attached
+    ASSERT_TRUE(entry);
+    EXPECT_TRUE(matches(*entry, a));
+    EXPECT_TRUE(exists(name.name()));
+    entry.reset();
+    EXPECT_FALSE(exists(name.name()));
+
+    // and the next one starts afresh
+    SharedFrameCache cache(name.name(), 1024 * 1024);
+    EXPECT_EQ(cache.count(), size_t(0));
+}
+
+TEST(SharedFrameCacheTest, Reap) {
+    // a process that dies holding entries doesn't pin them for ever
+    SharedName name;
+    const auto a = make_data(1000, 6);
+
+    SharedFrameCache cache(name.name(), 1024 * 1024);
+    EXPECT_TRUE(cache.store("a", "", a.data(), a.size()));
+
+    int pipe_fds[2];
+    ASSERT_EQ(pipe(pipe_fds), 0);
+
+    const auto child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        SharedFrameCache consumer(name.name(), 0);
+        auto held     = consumer.retrieve("a");
+        const char ok = held ? 1 : 0;
+        if (write(pipe_fds[1], &ok, 1) != 1)
+            _exit(1);
+        // wait to be killed
+        char c;
+        [[maybe_unused]] auto r = read(pipe_fds[0], &c, 1);
+        _exit(0);
+    }
+
+    char ok = 0;
+    ASSERT_EQ(read(pipe_fds[0], &ok, 1), 1);
+    ASSERT_EQ(ok, 1);
+    EXPECT_FALSE(cache.erase("a"));
+
+    kill(child, SIGKILL);
+    int status = 0;
+    waitpid(child, &status, 0);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+
+    EXPECT_TRUE(cache.erase("a"));
+    EXPECT_FALSE(cache.contains("a"));
+}
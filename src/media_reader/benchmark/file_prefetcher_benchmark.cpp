@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Reading a frame sequence through the FilePrefetcher as a reader plugin
+// would, with and without reading ahead. Once from tmpfs (or /tmp), where
+// reads are cheap, and once through a read that waits out a fixed latency
+// first, standing in for slow network storage. Each frame is "decoded" by
+// sleeping for the decode time.
+//
+// file_prefetcher_benchmark [frames] [frame_mb] [decode_ms] [latency_ms] [read_ahead]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+#include "xstudio/media_reader/file_prefetcher.hpp"
+
+using namespace xstudio::media_reader;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Result {
+    int hits       = {0};
+    double seconds = {0.0};
+};
+
+// Takes the files in order, prefetching the ones after the current one first
+// and reading the file itself when the prefetcher doesn't have it.
+Result read_sequence(
+    FilePrefetcher &prefetcher,
+    const std::vector<std::string> &paths,
+    const FilePrefetcher::ReadFunc &read,
+    const size_t read_ahead,
+    const std::chrono::milliseconds decode) {
+    Result result;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < paths.size(); i++) {
+        for (size_t j = i; j < std::min(paths.size(), i + read_ahead); j++)
+            prefetcher.prefetch(paths[j]);
+        auto file = prefetcher.take(paths[i]);
+        if (file)
+            result.hits++;
+        else
+            file = read(paths[i], false);
+        if (not file)
+            std::exit(1);
+        std::this_thread::sleep_for(decode);
+    }
+    result.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void report(
+    const char *storage,
+    FilePrefetcher &prefetcher,
+    const std::vector<std::string> &paths,
+    const FilePrefetcher::ReadFunc &read,
+    const size_t read_ahead,
+    const std::chrono::milliseconds decode) {
+    for (const auto ahead : {size_t(0), read_ahead}) {
+        const auto result = read_sequence(prefetcher, paths, read, ahead, decode);
+        std::printf(
+            "  %s, read ahead %zu: %d/%zu from the prefetcher, %.3fs, %.1f fps\n",
+            storage,
+            ahead,
+            result.hits,
+            paths.size(),
+            result.seconds,
+            double(paths.size()) / result.seconds);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const int frames        = argc > 1 ? std::atoi(argv[1]) : 48;
+    const size_t frame_mb   = argc > 2 ? std::atoi(argv[2]) : 8;
+    const auto decode       = std::chrono::milliseconds(argc > 3 ? std::atoi(argv[3]) : 10);
+    const auto latency      = std::chrono::milliseconds(argc > 4 ? std::atoi(argv[4]) : 20);
+    const size_t read_ahead = argc > 5 ? std::atoi(argv[5]) : 4;
+
+    const auto dir = fs::path(fs::exists("/dev/shm") ? "/dev/shm" : "/tmp") /
+                     ("xstudio_file_prefetcher_benchmark_" + std::to_string(getpid()));
+    fs::create_directories(dir);
+
+    std::vector<std::string> paths;
+    std::vector<char> data(frame_mb * 1024 * 1024);
+    for (int i = 0; i < frames; i++) {
+        for (size_t j = 0; j < data.size(); j++)
+            data[j] = char((j * 31 + i) & 0xff);
+        paths.push_back(dir / std::to_string(i));
+        std::ofstream(paths.back(), std::ios::binary).write(data.data(), data.size());
+    }
+
+    std::printf(
+        "%d frames of %zuMB in %s, %ldms to decode a frame\n",
+        frames,
+        frame_mb,
+        dir.parent_path().c_str(),
+        long(decode.count()));
+
+    const FilePrefetcher::ReadFunc local = &FilePrefetcher::read_file;
+    FilePrefetcher local_prefetcher(4, size_t(512) * 1024 * 1024, local);
+    report("local", local_prefetcher, paths, local, read_ahead, decode);
+
+    const FilePrefetcher::ReadFunc throttled = [=](const std::string &path, bool direct_io) {
+        std::this_thread::sleep_for(latency);
+        return FilePrefetcher::read_file(path, direct_io);
+    };
+    FilePrefetcher throttled_prefetcher(4, size_t(512) * 1024 * 1024, throttled);
+    const auto storage = std::to_string(latency.count()) + "ms latency";
+    report(storage.c_str(), throttled_prefetcher, paths, throttled, read_ahead, decode);
+
+    fs::remove_all(dir);
+    return 0;
+}
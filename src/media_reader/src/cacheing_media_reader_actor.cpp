@@ -1,7 +1,12 @@
 // SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include "xstudio/media_reader/cacheing_media_reader_actor.hpp"
 #include "xstudio/global_store/global_store.hpp"
 #include "xstudio/atoms.hpp"
+#include "xstudio/media_reader/file_prefetcher.hpp"
 #include "xstudio/utility/helpers.hpp"
 #include "xstudio/utility/json_store.hpp"
 #include "xstudio/utility/time_cache.hpp"
@@ -13,39 +18,55 @@ using namespace xstudio::json_store;
 using namespace xstudio::utility;
 using namespace xstudio::global_store;
 
+namespace {
+// Decode workers beyond each source's precache worker are shared out across
+// every source, so that many sources precaching at once don't spawn a plugin
+// instance per core each.
+std::atomic<size_t> s_extra_decode_workers = {0};
+
+bool reserve_extra_decode_worker() {
+    const size_t max = std::max(1u, std::thread::hardware_concurrency());
+    auto count       = s_extra_decode_workers.load();
+    while (count < max) {
+        if (s_extra_decode_workers.compare_exchange_weak(count, count + 1))
+            return true;
+    }
+    return false;
+}
+
+// how long extra decode workers are kept once the pipeline has gone quiet
+constexpr auto k_decode_worker_idle_time = std::chrono::seconds(5);
+} // namespace
 
 CachingMediaReaderActor::CachingMediaReaderActor(
     caf::actor_config &cfg,
     const utility::Uuid &media_reader_plugin_uuid,
     caf::actor image_cache,
-    caf::actor audio_cache)
+    caf::actor audio_cache,
+    caf::actor worker_pool)
     : caf::event_based_actor(cfg),
       image_cache_(std::move(image_cache)),
-      audio_cache_(std::move(audio_cache)) {
+      audio_cache_(std::move(audio_cache)),
+      worker_pool_(std::move(worker_pool)),
+      plugin_uuid_(media_reader_plugin_uuid) {
 
     print_on_exit(this, "CachingMediaReaderActor");
     spdlog::debug("Created CachingMediaReaderActor.");
 
-    // create plugins..
     {
         auto prefs = GlobalStoreHelper(system());
         JsonStore js;
-        prefs.get_group(js);
-
-        auto pm = system().registry().template get<caf::actor>(plugin_manager_registry);
-        scoped_actor sys{system()};
-
-        precache_worker_ = request_receive<caf::actor>(
-            *sys, pm, plugin_manager::spawn_plugin_atom_v, media_reader_plugin_uuid, js);
-        link_to(precache_worker_);
-        urgent_worker_ = request_receive<caf::actor>(
-            *sys, pm, plugin_manager::spawn_plugin_atom_v, media_reader_plugin_uuid, js);
-        link_to(urgent_worker_);
-        audio_worker_ = request_receive<caf::actor>(
-            *sys, pm, plugin_manager::spawn_plugin_atom_v, media_reader_plugin_uuid, js);
-        link_to(audio_worker_);
+        join_broadcast(this, prefs.get_group(js));
+        update_pipeline_preferences(js);
     }
 
+    // The reader plugin instances are spawned when they are first needed, so
+    // opening a source doesn't wait for them and an image sequence never
+    // makes an audio worker. They come from the global reader's pool of
+    // spares, or from the plugin manager if we weren't given one.
+    if (not worker_pool_)
+        worker_pool_ = system().registry().template get<caf::actor>(plugin_manager_registry);
+
     if (not image_cache_)
         image_cache_ = system().registry().template get<caf::actor>(image_cache_registry);
     if (not audio_cache_)
@@ -73,45 +94,48 @@ CachingMediaReaderActor::CachingMediaReaderActor(
                         if (buf) {
                             rp.deliver(buf);
                         } else {
-                            request(urgent_worker_, infinite, get_image_atom_v, mptr)
-                                .then(
-                                    [=](media_reader::ImageBufPtr buf) mutable {
-                                        rp.deliver(buf);
-                                        // store the image in our cache
-                                        anon_send<message_priority::high>(
-                                            image_cache_,
-                                            media_cache::store_atom_v,
-                                            mptr.key_,
-                                            buf,
-                                            utility::clock::now() +
-                                                (pin ? std::chrono::minutes(10)
-                                                     : std::chrono::minutes(0)),
-                                            playhead_uuid);
-                                    },
-                                    [=](const caf::error &err) mutable {
-                                        // make an empty image buffer that holds the error
-                                        // message
-                                        std::stringstream err_msg;
-                                        std::string caf_error_string = to_string(err);
-                                        // strip the caf error formatting
-                                        if (caf_error_string.find("error(\"") !=
-                                            std::string::npos) {
-                                            caf_error_string = std::string(caf_error_string, 7);
-                                            // strip off the ") at the end too
-                                            caf_error_string = std::string(
-                                                caf_error_string,
-                                                0,
-                                                caf_error_string.length() - 2);
-                                        }
-
-                                        err_msg << "Error loading file \""
-                                                << to_string(mptr.uri_)
-                                                << "\": " << caf_error_string;
-
-                                        media_reader::ImageBufPtr buf(
-                                            new media_reader::ImageBuffer(err_msg.str()));
-                                        rp.deliver(buf);
-                                    });
+                            with_worker(urgent_worker_, [=](caf::actor worker) mutable {
+                                request(worker, infinite, get_image_atom_v, mptr)
+                                    .then(
+                                        [=](media_reader::ImageBufPtr buf) mutable {
+                                            rp.deliver(buf);
+                                            // store the image in our cache
+                                            anon_send<message_priority::high>(
+                                                image_cache_,
+                                                media_cache::store_atom_v,
+                                                mptr.key_,
+                                                buf,
+                                                utility::clock::now() +
+                                                    (pin ? std::chrono::minutes(10)
+                                                         : std::chrono::minutes(0)),
+                                                playhead_uuid);
+                                        },
+                                        [=](const caf::error &err) mutable {
+                                            // make an empty image buffer that holds the error
+                                            // message
+                                            std::stringstream err_msg;
+                                            std::string caf_error_string = to_string(err);
+                                            // strip the caf error formatting
+                                            if (caf_error_string.find("error(\"") !=
+                                                std::string::npos) {
+                                                caf_error_string =
+                                                    std::string(caf_error_string, 7);
+                                                // strip off the ") at the end too
+                                                caf_error_string = std::string(
+                                                    caf_error_string,
+                                                    0,
+                                                    caf_error_string.length() - 2);
+                                            }
+
+                                            err_msg << "Error loading file \""
+                                                    << to_string(mptr.uri_)
+                                                    << "\": " << caf_error_string;
+
+                                            media_reader::ImageBufPtr buf(
+                                                new media_reader::ImageBuffer(err_msg.str()));
+                                            rp.deliver(buf);
+                                        });
+                            });
                         }
                     },
                     [=](const caf::error &err) mutable { rp.deliver(err); });
@@ -130,25 +154,27 @@ CachingMediaReaderActor::CachingMediaReaderActor(
                         if (buf) {
                             rp.deliver(buf);
                         } else {
-                            request(urgent_worker_, infinite, get_audio_atom_v, mptr)
-                                .then(
-                                    [=](media_reader::AudioBufPtr buf) mutable {
-                                        rp.deliver(buf);
-                                        // store the image in our cache
-                                        anon_send(
-                                            audio_cache_,
-                                            media_cache::store_atom_v,
-                                            mptr.key_,
-                                            buf,
-                                            utility::clock::now() +
-                                                (pin ? std::chrono::minutes(10)
-                                                     : std::chrono::minutes(0)),
-                                            playhead_uuid);
-                                    },
-                                    [=](const caf::error &) mutable {
-                                        // deliver an empty buffer
-                                        rp.deliver(buf);
-                                    });
+                            with_worker(audio_worker_, [=](caf::actor worker) mutable {
+                                request(worker, infinite, get_audio_atom_v, mptr)
+                                    .then(
+                                        [=](media_reader::AudioBufPtr buf) mutable {
+                                            rp.deliver(buf);
+                                            // store the image in our cache
+                                            anon_send(
+                                                audio_cache_,
+                                                media_cache::store_atom_v,
+                                                mptr.key_,
+                                                buf,
+                                                utility::clock::now() +
+                                                    (pin ? std::chrono::minutes(10)
+                                                         : std::chrono::minutes(0)),
+                                                playhead_uuid);
+                                        },
+                                        [=](const caf::error &) mutable {
+                                            // deliver an empty buffer
+                                            rp.deliver(buf);
+                                        });
+                            });
                         }
                     },
                     [=](const caf::error &err) mutable { rp.deliver(err); });
@@ -167,31 +193,284 @@ CachingMediaReaderActor::CachingMediaReaderActor(
             // note the caller (GlobalMediaReaderActor) handles the cacheing
             // of this image buffer
             auto rp = make_response_promise<media_reader::ImageBufPtr>();
-            request(precache_worker_, infinite, get_image_atom_v, mptr)
-                .then(
-                    [=](media_reader::ImageBufPtr buf) mutable { rp.deliver(buf); },
-                    [=](const caf::error &err) mutable { rp.deliver(err); });
+            if (pipeline_enabled_) {
+                read_queue_.push_back(PrecacheImageRequest{mptr, rp});
+                start_precache_reads();
+                return rp;
+            }
+            with_worker(precache_worker_, [=](caf::actor worker) mutable {
+                request(worker, infinite, get_image_atom_v, mptr)
+                    .then(
+                        [=](media_reader::ImageBufPtr buf) mutable { rp.deliver(buf); },
+                        [=](const caf::error &err) mutable { rp.deliver(err); });
+            });
             return rp;
         },
 
+        [=](media_reader::decode_from_memory_atom, const uint64_t read_id) {
+            // the file has been read (or couldn't be, in which case the
+            // decoder reads it itself)
+            auto p = reading_.find(read_id);
+            if (p != reading_.end()) {
+                decode_queue_.push_back(p->second);
+                reading_.erase(p);
+            }
+            start_precache_decodes();
+            start_precache_reads();
+        },
+
         [=](read_precache_audio_atom, const media::AVFrameID &mptr) -> result<AudioBufPtr> {
             // note the caller (GlobalMediaReaderActor) handles the cacheing
             // of this image buffer
             auto rp = make_response_promise<media_reader::AudioBufPtr>();
-            request(precache_worker_, infinite, get_audio_atom_v, mptr)
-                .then(
-                    [=](media_reader::AudioBufPtr buf) mutable { rp.deliver(buf); },
-                    [=](const caf::error &err) mutable { rp.deliver(err); });
+            with_worker(audio_worker_, [=](caf::actor worker) mutable {
+                request(worker, infinite, get_audio_atom_v, mptr)
+                    .then(
+                        [=](media_reader::AudioBufPtr buf) mutable { rp.deliver(buf); },
+                        [=](const caf::error &err) mutable { rp.deliver(err); });
+            });
             return rp;
         },
 
-        [=](get_media_detail_atom atom, const caf::uri &_uri) {
-            delegate(urgent_worker_, atom, _uri);
+        [=](get_media_detail_atom atom, const caf::uri &_uri) -> result<media::MediaDetail> {
+            auto rp = make_response_promise<media::MediaDetail>();
+            with_worker(urgent_worker_, [=](caf::actor worker) mutable {
+                rp.delegate(worker, atom, _uri);
+            });
+            return rp;
+        },
+
+        [=](json_store::update_atom,
+            const JsonStore & /*change*/,
+            const std::string & /*path*/,
+            const JsonStore &full) {
+            delegate(actor_cast<caf::actor>(this), json_store::update_atom_v, full);
+        },
+
+        [=](json_store::update_atom, const JsonStore &js) { update_pipeline_preferences(js); },
+
+        [=](retire_readers_atom) {
+            reap_scheduled_ = false;
+            reap_idle_decode_workers();
         }
 
     );
 }
 
+void CachingMediaReaderActor::on_exit() {
+    for (auto &worker : decode_workers_) {
+        if (worker != precache_worker_.actor_)
+            send_exit(worker, caf::exit_reason::user_shutdown);
+    }
+    s_extra_decode_workers -= extra_decode_workers_;
+    extra_decode_workers_ = 0;
+}
+
+void CachingMediaReaderActor::with_worker(LazyWorker &worker, WorkerTask task) {
+
+    if (worker.actor_) {
+        task(worker.actor_);
+        return;
+    }
+
+    worker.waiting_.push_back(std::move(task));
+    if (worker.spawning_)
+        return;
+
+    worker.spawning_ = true;
+    auto w           = &worker;
+    request(worker_pool_, infinite, plugin_manager::spawn_plugin_atom_v, plugin_uuid_, prefs_)
+        .then(
+            [=](caf::actor actor) {
+                link_to(actor);
+                w->actor_    = actor;
+                w->spawning_ = false;
+                // the precache worker is the first of the decode workers
+                if (w == &precache_worker_)
+                    add_decode_worker(actor);
+                auto waiting = std::move(w->waiting_);
+                w->waiting_.clear();
+                for (auto &t : waiting)
+                    t(actor);
+            },
+            [=](const caf::error &err) {
+                spdlog::warn("{} {}", __PRETTY_FUNCTION__, to_string(err));
+                // the requests to a null actor fail, and the next task tries
+                // again
+                w->spawning_ = false;
+                auto waiting = std::move(w->waiting_);
+                w->waiting_.clear();
+                for (auto &t : waiting)
+                    t(caf::actor());
+            });
+}
+
+void CachingMediaReaderActor::add_decode_worker(caf::actor worker) {
+
+    decode_workers_.push_back(worker);
+    idle_decode_workers_.push_back(worker);
+
+    if (decode_workers_.size() == 1) {
+        // now we can ask whether the plugin can decode files read by the
+        // pipeline
+        request(worker, infinite, media_reader::decode_from_memory_atom_v)
+            .then(
+                [=](const bool decodes_from_memory) {
+                    plugin_decodes_from_memory_ = decodes_from_memory;
+                    update_pipeline_preferences(prefs_);
+                },
+                [=](const caf::error &err) {
+                    spdlog::warn("{} {}", __PRETTY_FUNCTION__, to_string(err));
+                });
+    }
+    start_precache_decodes();
+}
+
+void CachingMediaReaderActor::update_pipeline_preferences(const utility::JsonStore &prefs) {
+    try {
+        pipeline_enabled_ =
+            plugin_decodes_from_memory_ and
+            preference_value<bool>(prefs, "/core/media_reader/pipeline/enabled");
+        const auto workers =
+            preference_value<size_t>(prefs, "/core/media_reader/pipeline/decode_workers");
+        decode_workers_max_ =
+            workers ? workers : std::max(1u, std::thread::hardware_concurrency());
+        pipeline_max_bytes_ =
+            preference_value<size_t>(prefs, "/core/media_reader/pipeline/max_size") * 1024 *
+            1024;
+        prefs_ = prefs;
+    } catch (const std::exception &err) {
+        spdlog::warn("{} {}", __PRETTY_FUNCTION__, err.what());
+    }
+}
+
+void CachingMediaReaderActor::start_precache_reads() {
+
+    auto &prefetcher = FilePrefetcher::global();
+    const auto self  = caf::actor_cast<caf::actor_addr>(this);
+
+    while (not read_queue_.empty() and reading_.size() < decode_workers_max_) {
+
+        // wait for the decoders to catch up if too much has been read. If we
+        // have nothing in the pipeline the memory is held by someone else, so
+        // read one anyway rather than stall
+        const bool idle = reading_.empty() and decode_queue_.empty() and
+                          idle_decode_workers_.size() == decode_workers_.size();
+        if (not idle and prefetcher.bytes() >= pipeline_max_bytes_)
+            break;
+
+        const auto read_id = next_read_id_++;
+        const auto path    = uri_to_posix_path(read_queue_.front().mptr_.uri_);
+        reading_.emplace(read_id, read_queue_.front());
+        read_queue_.pop_front();
+
+        // called from one of the prefetcher's threads
+        prefetcher.prefetch(path, [self, read_id]() {
+            if (auto actor = caf::actor_cast<caf::actor>(self))
+                anon_send(actor, media_reader::decode_from_memory_atom_v, read_id);
+        });
+    }
+}
+
+void CachingMediaReaderActor::start_precache_decodes() {
+
+    while (not decode_queue_.empty()) {
+
+        if (idle_decode_workers_.empty()) {
+            if (not spawning_worker_ and decode_workers_.size() < decode_workers_max_ and
+                reserve_extra_decode_worker()) {
+                spawning_worker_ = true;
+                request(
+                    worker_pool_,
+                    infinite,
+                    plugin_manager::spawn_plugin_atom_v,
+                    plugin_uuid_,
+                    prefs_)
+                    .then(
+                        [=](caf::actor worker) {
+                            spawning_worker_ = false;
+                            extra_decode_workers_++;
+                            link_to(worker);
+                            add_decode_worker(worker);
+                        },
+                        [=](const caf::error &err) {
+                            // make do with the workers we have
+                            spawning_worker_    = false;
+                            decode_workers_max_ = decode_workers_.size();
+                            s_extra_decode_workers--;
+                            spdlog::warn("{} {}", __PRETTY_FUNCTION__, to_string(err));
+                        });
+            }
+            break;
+        }
+
+        auto worker = idle_decode_workers_.back();
+        idle_decode_workers_.pop_back();
+        decode_precache_image(worker, decode_queue_.front());
+        decode_queue_.pop_front();
+    }
+}
+
+void CachingMediaReaderActor::decode_precache_image(
+    caf::actor worker, const PrecacheImageRequest &image_request) {
+
+    auto rp = image_request.rp_;
+    request(worker, infinite, get_image_atom_v, image_request.mptr_)
+        .then(
+            [=](media_reader::ImageBufPtr buf) mutable {
+                rp.deliver(buf);
+                decode_finished(worker);
+            },
+            [=](const caf::error &err) mutable {
+                rp.deliver(err);
+                decode_finished(worker);
+            });
+}
+
+void CachingMediaReaderActor::decode_finished(caf::actor worker) {
+
+    idle_decode_workers_.push_back(worker);
+    last_decode_ = utility::clock::now();
+    start_precache_decodes();
+    start_precache_reads();
+
+    if (extra_decode_workers_ and not reap_scheduled_) {
+        reap_scheduled_ = true;
+        delayed_send(this, k_decode_worker_idle_time, retire_readers_atom_v);
+    }
+}
+
+void CachingMediaReaderActor::reap_idle_decode_workers() {
+
+    const auto quiet = utility::clock::now() - last_decode_;
+    if (quiet < k_decode_worker_idle_time) {
+        reap_scheduled_ = true;
+        delayed_send(
+            this,
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                k_decode_worker_idle_time - quiet),
+            retire_readers_atom_v);
+        return;
+    }
+
+    // the precache worker stays, it's the urgent worker's spare
+    for (auto i = idle_decode_workers_.begin(); i != idle_decode_workers_.end();) {
+        if (*i == precache_worker_.actor_) {
+            ++i;
+            continue;
+        }
+        auto worker = *i;
+        i           = idle_decode_workers_.erase(i);
+        decode_workers_.erase(
+            std::remove(decode_workers_.begin(), decode_workers_.end(), worker),
+            decode_workers_.end());
+        unlink_from(worker);
+        send_exit(worker, caf::exit_reason::user_shutdown);
+        extra_decode_workers_--;
+        s_extra_decode_workers--;
+    }
+}
+
 void CachingMediaReaderActor::do_urgent_get_image() {
 
     auto p                      = pending_get_image_requests_.begin();
@@ -202,48 +481,50 @@ void CachingMediaReaderActor::do_urgent_get_image() {
     pending_get_image_requests_.erase(p);
 
     urgent_worker_busy_ = true;
-    request(urgent_worker_, infinite, get_image_atom_v, mptr)
-        .then(
-            [=](media_reader::ImageBufPtr buf) mutable {
-                // send the image back to the playhead that requested it
-                send(playhead, push_image_atom_v, buf, mptr, tp);
-
-                // store the image in our cache
-                anon_send<message_priority::high>(
-                    image_cache_,
-                    media_cache::store_atom_v,
-                    mptr.key_,
-                    buf,
-                    utility::clock::now(),
-                    playhead_uuid);
-
-                // perhaps more urgent requests are now pending
-                urgent_worker_busy_ = false;
-                anon_send(this, get_image_atom_v);
-            },
-            [=](const caf::error &err) mutable {
-                std::stringstream err_msg;
-                std::string caf_error_string = to_string(err);
-                // strip the caf error formatting
-                if (caf_error_string.find("error(\"") != std::string::npos) {
-                    caf_error_string = std::string(caf_error_string, 7);
-                    // strip off the ") at the end too
-                    caf_error_string =
-                        std::string(caf_error_string, 0, caf_error_string.length() - 2);
-                }
+    with_worker(urgent_worker_, [=](caf::actor worker) mutable {
+        request(worker, infinite, get_image_atom_v, mptr)
+            .then(
+                [=](media_reader::ImageBufPtr buf) mutable {
+                    // send the image back to the playhead that requested it
+                    send(playhead, push_image_atom_v, buf, mptr, tp);
 
-                err_msg << "Error loading file \"" << to_string(mptr.uri_)
-                        << "\": " << caf_error_string;
+                    // store the image in our cache
+                    anon_send<message_priority::high>(
+                        image_cache_,
+                        media_cache::store_atom_v,
+                        mptr.key_,
+                        buf,
+                        utility::clock::now(),
+                        playhead_uuid);
 
-                // make an empty image buffer that holds the error message
-                media_reader::ImageBufPtr buf(new media_reader::ImageBuffer(err_msg.str()));
+                    // perhaps more urgent requests are now pending
+                    urgent_worker_busy_ = false;
+                    anon_send(this, get_image_atom_v);
+                },
+                [=](const caf::error &err) mutable {
+                    std::stringstream err_msg;
+                    std::string caf_error_string = to_string(err);
+                    // strip the caf error formatting
+                    if (caf_error_string.find("error(\"") != std::string::npos) {
+                        caf_error_string = std::string(caf_error_string, 7);
+                        // strip off the ") at the end too
+                        caf_error_string =
+                            std::string(caf_error_string, 0, caf_error_string.length() - 2);
+                    }
 
-                // send the image back to the playhead that requested it
-                send(playhead, push_image_atom_v, buf, mptr, tp);
+                    err_msg << "Error loading file \"" << to_string(mptr.uri_)
+                            << "\": " << caf_error_string;
 
-                urgent_worker_busy_ = false;
-                anon_send(this, get_image_atom_v);
-            });
+                    // make an empty image buffer that holds the error message
+                    media_reader::ImageBufPtr buf(new media_reader::ImageBuffer(err_msg.str()));
+
+                    // send the image back to the playhead that requested it
+                    send(playhead, push_image_atom_v, buf, mptr, tp);
+
+                    urgent_worker_busy_ = false;
+                    anon_send(this, get_image_atom_v);
+                });
+    });
 }
 
 void CachingMediaReaderActor::receive_image_buffer_request(
@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "xstudio/media_reader/file_prefetcher.hpp"
+
+using namespace xstudio::media_reader;
+
+namespace {
+
+constexpr size_t k_align = 4096;
+
+// how many reads can be waiting, older requests are dropped first as the
+// playhead has probably moved on from them
+constexpr size_t k_max_queued = 256;
+
+std::shared_ptr<std::byte> aligned_buffer(const size_t size) {
+    void *p = nullptr;
+    if (posix_memalign(&p, k_align, std::max(size, k_align)) != 0)
+        throw std::bad_alloc();
+    return std::shared_ptr<std::byte>(static_cast<std::byte *>(p), [](std::byte *d) {
+        free(d);
+    });
+}
+
+} // namespace
+
+FilePrefetcher::FilePrefetcher(const size_t threads, const size_t max_bytes, ReadFunc read)
+    : read_(std::move(read)), max_bytes_(max_bytes) {
+    if (not read_)
+        read_ = &FilePrefetcher::read_file;
+
+    for (size_t i = 0; i < std::max(threads, size_t(1)); i++)
+        threads_.emplace_back([this]() { run(); });
+}
+
+FilePrefetcher::~FilePrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto &t : threads_)
+        t.join();
+}
+
+FilePrefetcher &FilePrefetcher::global() {
+    static FilePrefetcher s_prefetcher;
+    return s_prefetcher;
+}
+
+std::optional<FilePrefetcher::File>
+FilePrefetcher::read_file(const std::string &path, const bool direct_io) {
+
+    auto fd = direct_io ? open(path.c_str(), O_RDONLY | O_DIRECT) : -1;
+    // not every filesystem does O_DIRECT (tmpfs doesn't), fall back to
+    // normal reads
+    const auto direct = fd >= 0;
+    if (not direct)
+        fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return {};
+
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 or not S_ISREG(st.st_mode)) {
+        close(fd);
+        return {};
+    }
+
+    const auto size = size_t(st.st_size);
+    // O_DIRECT reads have to be whole blocks into aligned memory
+    const auto capacity = (size + k_align - 1) & ~(k_align - 1);
+    auto data           = aligned_buffer(capacity);
+
+    size_t done = 0;
+    while (done < size) {
+        const auto n = pread(fd, data.get() + done, capacity - done, done);
+        if (n < 0 and errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        done += n;
+    }
+
+    if (not direct)
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+
+    if (done < size)
+        return {};
+
+    File file;
+    file.data = data;
+    file.size = size;
+    return file;
+}
+
+void FilePrefetcher::prefetch(const std::string &path) { prefetch(path, Callback()); }
+
+void FilePrefetcher::prefetch(const std::string &path, Callback on_read) {
+    std::vector<Callback> done;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ready_.count(path)) {
+            if (on_read)
+                done.push_back(std::move(on_read));
+        } else {
+            if (not pending_.count(path)) {
+                if (queue_.size() >= k_max_queued) {
+                    done = release(queue_.front());
+                    pending_.erase(queue_.front());
+                    queue_.pop_front();
+                }
+                queue_.push_back(path);
+                pending_.insert(path);
+                work_cv_.notify_one();
+            }
+            if (on_read)
+                callbacks_.emplace(path, std::move(on_read));
+        }
+    }
+    for (auto &callback : done)
+        callback();
+}
+
+std::optional<FilePrefetcher::File> FilePrefetcher::take(const std::string &path) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // still queued, no point waiting, the caller can read it just as fast
+    const auto queued = std::find(queue_.begin(), queue_.end(), path);
+    if (queued != queue_.end()) {
+        queue_.erase(queued);
+        pending_.erase(path);
+        auto done = release(path);
+        lock.unlock();
+        for (auto &callback : done)
+            callback();
+        return {};
+    }
+
+    done_cv_.wait(lock, [&]() { return not pending_.count(path); });
+
+    const auto p = ready_.find(path);
+    if (p == ready_.end())
+        return {};
+
+    auto file = p->second;
+    ready_bytes_ -= file.size;
+    ready_.erase(p);
+    ready_order_.remove(path);
+    return file;
+}
+
+void FilePrefetcher::clear() {
+    std::vector<Callback> done;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &path : queue_) {
+            pending_.erase(path);
+            for (auto &callback : release(path))
+                done.push_back(std::move(callback));
+        }
+        queue_.clear();
+        ready_.clear();
+        ready_order_.clear();
+        ready_bytes_ = 0;
+    }
+    for (auto &callback : done)
+        callback();
+}
+
+void FilePrefetcher::set_max_bytes(const size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_bytes_ = max_bytes;
+    enforce_budget();
+}
+
+void FilePrefetcher::set_direct_io(const bool direct_io) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    direct_io_ = direct_io;
+}
+
+size_t FilePrefetcher::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ready_bytes_;
+}
+
+bool FilePrefetcher::pending(const std::string &path) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_.count(path) != 0;
+}
+
+void FilePrefetcher::enforce_budget() {
+    while (ready_bytes_ > max_bytes_ and not ready_order_.empty()) {
+        const auto p = ready_.find(ready_order_.front());
+        ready_bytes_ -= p->second.size;
+        ready_.erase(p);
+        ready_order_.pop_front();
+    }
+}
+
+std::vector<FilePrefetcher::Callback> FilePrefetcher::release(const std::string &path) {
+    std::vector<Callback> result;
+    const auto range = callbacks_.equal_range(path);
+    for (auto p = range.first; p != range.second; p++)
+        result.push_back(std::move(p->second));
+    callbacks_.erase(range.first, range.second);
+    return result;
+}
+
+void FilePrefetcher::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_cv_.wait(lock, [this]() { return stop_ or not queue_.empty(); });
+        if (stop_)
+            break;
+
+        const auto path      = queue_.front();
+        const auto direct_io = direct_io_;
+        queue_.pop_front();
+
+        lock.unlock();
+        std::optional<File> file;
+        try {
+            file = read_(path, direct_io);
+        } catch (...) {
+        }
+        lock.lock();
+
+        // cleared or given up on while we were reading
+        if (not pending_.count(path))
+            continue;
+
+        pending_.erase(path);
+        if (file) {
+            ready_[path] = *file;
+            ready_order_.push_back(path);
+            ready_bytes_ += file->size;
+            enforce_budget();
+        }
+        done_cv_.notify_all();
+
+        auto done = release(path);
+        if (not done.empty()) {
+            lock.unlock();
+            for (auto &callback : done)
+                callback();
+            lock.lock();
+        }
+    }
+}
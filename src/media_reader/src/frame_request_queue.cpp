@@ -59,12 +59,18 @@ void FrameRequestQueue::add_frame_requests(
             -> bool { return a->required_by_ < b->required_by_; });
 }
 
-std::optional<FrameRequest>
-FrameRequestQueue::pop_request(const std::map<utility::Uuid, int> &exclude_playheads) {
+std::optional<FrameRequest> FrameRequestQueue::pop_request(
+    const std::map<utility::Uuid, int> &in_flight,
+    const int max_in_flight,
+    const std::set<std::string> &pipelined_readers) {
     std::optional<FrameRequest> rt = {};
 
     for (auto p = queue_.begin(); p != queue_.end(); p++) {
-        if (!exclude_playheads.count((*p)->requesting_playhead_uuid_)) {
+        const auto busy  = in_flight.find((*p)->requesting_playhead_uuid_);
+        const auto limit = pipelined_readers.count((*p)->requested_frame_->reader_)
+                               ? max_in_flight
+                               : 1;
+        if (busy == in_flight.end() or busy->second < limit) {
             rt = *(*p);
             queue_.erase(p);
             break;
@@ -73,6 +79,14 @@ FrameRequestQueue::pop_request(const std::map<utility::Uuid, int> &exclude_playh
     return rt;
 }
 
+std::vector<std::shared_ptr<const media::AVFrameID>>
+FrameRequestQueue::upcoming_frames(const size_t count) const {
+    std::vector<std::shared_ptr<const media::AVFrameID>> result;
+    for (auto p = queue_.begin(); p != queue_.end() and result.size() < count; p++)
+        result.push_back((*p)->requested_frame_);
+    return result;
+}
+
 void FrameRequestQueue::prune_stale_frame_requests() {
 
     auto now = utility::clock::now();
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <cstring>
+
+#include "xstudio/media_reader/image_buffer_export.hpp"
+
+using namespace xstudio;
+using namespace xstudio::media_reader;
+
+ImageBufferExport::ImageBufferExport(const ImageBufPtr &buf, const BufferExportMode mode)
+    : mode_(mode) {
+
+    if (not buf) {
+        error_ = "Empty image buffer";
+        return;
+    }
+
+    if (buf->error_state() == HAS_ERROR) {
+        error_ = buf->error_message();
+        return;
+    }
+
+    key_          = buf->media_key();
+    width_        = buf->image_size_in_pixels().x;
+    height_       = buf->image_size_in_pixels().y;
+    pixel_aspect_ = buf->pixel_aspect();
+    planes_       = buf->pixel_layout();
+    size_         = buf->size();
+
+    const auto names = buf->params().find("channel_names");
+    if (names != buf->params().end() and names->is_array())
+        channel_names_ = names->get<std::vector<std::string>>();
+
+    // reader didn't describe its pixels, so expose the buffer as flat bytes
+    if (planes_.empty())
+        planes_.emplace_back("bytes", PDT_UINT8, size_, 1, 1);
+
+    switch (mode_) {
+    case BEM_IN_PROCESS:
+        // share the decoded pixels, nothing is copied
+        source_ = buf;
+        break;
+
+    case BEM_SHARED_MEMORY: {
+        auto segment = utility::SharedMemorySegment::create(size_);
+        if (size_)
+            std::memcpy(segment->data(), buf->const_buffer(), size_);
+        // the receiver takes ownership of the name and unlinks it once it
+        // has mapped the segment.
+        segment->release();
+        shm_name_ = segment->name();
+    } break;
+
+    default:
+        payload_.resize(size_);
+        if (size_)
+            std::memcpy(payload_.data(), buf->const_buffer(), size_);
+        break;
+    }
+}
@@ -9,6 +9,7 @@
 #include "xstudio/media/caf_media_error.hpp"
 #include "xstudio/media_reader/media_reader_actor.hpp"
 #include "xstudio/media_reader/media_detail_and_thumbnail_reader_actor.hpp"
+#include "xstudio/media_reader/pixel_statistics.hpp"
 #include "xstudio/plugin_manager/plugin_manager.hpp"
 #include "xstudio/thumbnail/thumbnail.hpp"
 #include "xstudio/utility/chrono.hpp"
@@ -125,6 +126,32 @@ MediaDetailAndThumbnailReaderActor::MediaDetailAndThumbnailReaderActor(
             return rp;
         },
 
+        [=](get_filmstrip_atom,
+            const media::AVFrameID &mptr,
+            const size_t count,
+            const size_t size,
+            const bool rgb24) -> result<thumbnail::ThumbnailBufferPtr> {
+            bool start = queues_empty();
+            auto rp    = make_response_promise<thumbnail::ThumbnailBufferPtr>();
+            thumbnail_request_queue_.emplace(mptr, size, rp, count, rgb24);
+            if (start)
+                anon_send(caf::actor_cast<caf::actor>(this), get_media_detail_atom_v);
+            return rp;
+        },
+
+        [=](pixel_statistics_atom,
+            const ImageBufPtr &buf,
+            const JsonStore &options) -> result<JsonStore> {
+            if (not buf)
+                return make_error(xstudio_error::error, "No image");
+            try {
+                return PixelStatistics::compute(*buf, PixelStatisticsOptions(options))
+                    .serialise();
+            } catch (const std::exception &err) {
+                return make_error(xstudio_error::error, err.what());
+            }
+        },
+
         [=](utility::uuid_atom) -> Uuid { return uuid_; });
 }
 
@@ -141,6 +168,8 @@ void MediaDetailAndThumbnailReaderActor::process_get_thumbnail_queue() {
     media::AVFrameID mptr = thumbnail_request.media_pointer_;
     const size_t size     = thumbnail_request.size_;
     caf::typed_response_promise<thumbnail::ThumbnailBufferPtr> rp = thumbnail_request.rp_;
+    const size_t filmstrip_count = thumbnail_request.filmstrip_count_;
+    const bool rgb24             = thumbnail_request.rgb24_;
 
     try {
         fan_out_request<policy::select_all>(
@@ -167,7 +196,12 @@ void MediaDetailAndThumbnailReaderActor::process_get_thumbnail_queue() {
                         continue_processing_queue();
                     } else {
                         get_thumbnail_from_reader_plugin(
-                            plugins_map_[best_reader_plugin_uuid], mptr, size, rp);
+                            plugins_map_[best_reader_plugin_uuid],
+                            mptr,
+                            size,
+                            rp,
+                            filmstrip_count,
+                            rgb24);
                     }
                 },
                 [=](const caf::error &err) mutable {
@@ -186,33 +220,60 @@ void MediaDetailAndThumbnailReaderActor::get_thumbnail_from_reader_plugin(
     caf::actor &reader_plugin,
     const media::AVFrameID mptr,
     const size_t size,
-    caf::typed_response_promise<thumbnail::ThumbnailBufferPtr> rp) {
+    caf::typed_response_promise<thumbnail::ThumbnailBufferPtr> rp,
+    const size_t filmstrip_count,
+    const bool rgb24) {
 
     auto colour_pipe_manager = system().registry().get<caf::actor>(colour_pipeline_registry);
-    request(reader_plugin, infinite, get_thumbnail_atom_v, mptr, size)
-        .then(
-            [=](const thumbnail::ThumbnailBufferPtr &buf) mutable {
-                if (buf && buf->format() == thumbnail::THUMBNAIL_FORMAT::TF_RGB24)
-                    rp.deliver(buf);
-                else if (buf) {
-                    // send to colour pipeline..
-                    rp.delegate(colour_pipe_manager, process_thumbnail_atom_v, mptr, buf);
-                } else {
-                    if (mptr.actor_addr_) {
-                        auto dest = caf::actor_cast<caf::actor>(mptr.actor_addr_);
-                        if (dest)
-                            anon_send(dest, media_status_atom_v, MediaStatus::MS_UNSUPPORTED);
-                    }
-                    rp.deliver(make_error(
-                        media_error::corrupt, "thumbnail loaded returned empty buffer."));
-                }
-                continue_processing_queue();
-            },
-            [=](const caf::error &err) mutable {
-                spdlog::error("{} {}", err.category(), to_string(err));
-                rp.deliver(err);
-                continue_processing_queue();
-            });
+
+    auto on_buffer = [=](const thumbnail::ThumbnailBufferPtr &buf) mutable {
+        if (buf && buf->format() == thumbnail::THUMBNAIL_FORMAT::TF_RGB24)
+            rp.deliver(buf);
+        else if (buf && filmstrip_count) {
+            // the colour pipeline makes a new buffer, keep the filmstrip layout
+            const auto metadata = buf->metadata();
+            request(colour_pipe_manager, infinite, process_thumbnail_atom_v, mptr, buf)
+                .then(
+                    [=](thumbnail::ThumbnailBufferPtr &processed) mutable {
+                        if (processed)
+                            processed->metadata() = metadata;
+                        rp.deliver(processed);
+                    },
+                    [=](const caf::error &err) mutable { rp.deliver(err); });
+        } else if (buf) {
+            // send to colour pipeline..
+            rp.delegate(colour_pipe_manager, process_thumbnail_atom_v, mptr, buf);
+        } else {
+            if (mptr.actor_addr_) {
+                auto dest = caf::actor_cast<caf::actor>(mptr.actor_addr_);
+                if (dest)
+                    anon_send(dest, media_status_atom_v, MediaStatus::MS_UNSUPPORTED);
+            }
+            rp.deliver(
+                make_error(media_error::corrupt, "thumbnail loaded returned empty buffer."));
+        }
+        continue_processing_queue();
+    };
+
+    auto on_error = [=](const caf::error &err) mutable {
+        spdlog::error("{} {}", err.category(), to_string(err));
+        rp.deliver(err);
+        continue_processing_queue();
+    };
+
+    if (filmstrip_count)
+        request(
+            reader_plugin,
+            infinite,
+            get_filmstrip_atom_v,
+            mptr,
+            filmstrip_count,
+            size,
+            rgb24)
+            .then(on_buffer, on_error);
+    else
+        request(reader_plugin, infinite, get_thumbnail_atom_v, mptr, size)
+            .then(on_buffer, on_error);
 }
 
 void MediaDetailAndThumbnailReaderActor::process_get_media_detail_queue() {
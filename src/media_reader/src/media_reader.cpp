@@ -109,10 +109,14 @@ class ImageBufferRecyclerCache {
 
 static ImageBufferRecyclerCache s_buffer_recycler_;
 
-Buffer::~Buffer() { s_buffer_recycler_.store_unwanted_buffer(buffer_, size_); }
+Buffer::~Buffer() {
+    if (not has_shared_data())
+        s_buffer_recycler_.store_unwanted_buffer(buffer_, size_);
+}
 
 xstudio::media_reader::byte *Buffer::allocate(const size_t size) {
-    if (size_ != size) {
+    // shared memory is read only as far as we're concerned
+    if (size_ != size or has_shared_data()) {
 
         buffer_ = s_buffer_recycler_.fetch_recycled_buffer(size);
         if (!buffer_) {
@@ -123,16 +127,31 @@ xstudio::media_reader::byte *Buffer::allocate(const size_t size) {
     return buffer();
 }
 
+xstudio::media_reader::byte *Buffer::buffer() {
+    if (has_shared_data())
+        resize(size_);
+    return buffer_ ? buffer_->data_.get() : nullptr;
+}
+
 void Buffer::resize(const size_t size) {
     auto old_buffer = buffer_;
     auto old_size   = size_;
     allocate(size);
     if (old_buffer) {
-        memcpy(buffer(), old_buffer->data_.get(), std::min(old_size, size_));
-        s_buffer_recycler_.store_unwanted_buffer(old_buffer, old_size);
+        memcpy(buffer(), old_buffer->data(), std::min(old_size, size_));
+        if (not old_buffer->owner_)
+            s_buffer_recycler_.store_unwanted_buffer(old_buffer, old_size);
     }
 }
 
+void Buffer::set_shared_data(
+    const byte *data, const size_t size, std::shared_ptr<const void> owner) {
+    if (buffer_ and not has_shared_data())
+        s_buffer_recycler_.store_unwanted_buffer(buffer_, size_);
+    buffer_ = std::make_shared<BufferData>(data, std::move(owner));
+    size_   = size;
+}
+
 
 xstudio::media_reader::byte *ImageBuffer::allocate(const size_t _size) {
 
@@ -159,6 +178,11 @@ std::string MediaReader::name() const { return name_; }
 
 ImageBufPtr MediaReader::image(const media::AVFrameID &) { return ImageBufPtr(); }
 
+ImageBufPtr
+MediaReader::decode_image(const media::AVFrameID &mptr, const FilePrefetcher::File &) {
+    return image(mptr);
+}
+
 AudioBufPtr MediaReader::audio(const media::AVFrameID &) { return AudioBufPtr(); }
 
 thumbnail::ThumbnailBufferPtr MediaReader::thumbnail(const media::AVFrameID &mp, const size_t) {
@@ -167,6 +191,12 @@ thumbnail::ThumbnailBufferPtr MediaReader::thumbnail(const media::AVFrameID &mp,
     return thumbnail::ThumbnailBufferPtr();
 }
 
+thumbnail::ThumbnailBufferPtr MediaReader::filmstrip(
+    const media::AVFrameID &mp, const size_t, const size_t, const bool) {
+    throw std::runtime_error("Filmstrips not supported for this format. " + mp.reader_);
+    return thumbnail::ThumbnailBufferPtr();
+}
+
 MRCertainty MediaReader::supported(const caf::uri &, const std::array<uint8_t, 16> &) {
     return MRC_NO;
 }
@@ -184,3 +214,5 @@ bool MediaReader::prefer_sequential_access(const caf::uri &) const { return true
 bool MediaReader::can_decode_audio() const { return false; }
 
 bool MediaReader::can_do_partial_frames() const { return false; }
+
+bool MediaReader::can_decode_from_memory() const { return false; }
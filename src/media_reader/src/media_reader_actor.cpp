@@ -2,14 +2,21 @@
 #include <caf/sec.hpp>
 #include <caf/policy/select_all.hpp>
 #include <limits>
+#include <sys/mman.h>
+#include <thread>
 
 
 #include "xstudio/atoms.hpp"
 #include "xstudio/global_store/global_store.hpp"
 #include "xstudio/media/caf_media_error.hpp"
 #include "xstudio/media_reader/cacheing_media_reader_actor.hpp"
+#include "xstudio/media_reader/file_prefetcher.hpp"
+#include "xstudio/media_reader/image_buffer_export.hpp"
 #include "xstudio/media_reader/media_detail_and_thumbnail_reader_actor.hpp"
 #include "xstudio/media_reader/media_reader_actor.hpp"
+#include "xstudio/media_reader/media_reader_worker_pool_actor.hpp"
+#include "xstudio/media_reader/pixel_statistics.hpp"
+#include "xstudio/media_reader/precache_scheduler.hpp"
 #include "xstudio/plugin_manager/plugin_manager.hpp"
 #include "xstudio/thumbnail/thumbnail.hpp"
 #include "xstudio/utility/chrono.hpp"
@@ -32,15 +39,54 @@ using namespace xstudio::media_cache;
 namespace {
 using map_addr_timepoint = std::map<std::string, utility::time_point>;
 using workers_t          = std::list<std::shared_ptr<std::pair<caf::actor, int>>>;
+
+// How many precache reads a playhead can have in flight at once for readers
+// that go through the decode pipeline, enough to keep every decode worker
+// busy. Other readers read one frame at a time.
+int precache_in_flight(const JsonStore &prefs) {
+    if (not preference_value<bool>(prefs, "/core/media_reader/pipeline/enabled"))
+        return 1;
+    const auto workers =
+        preference_value<int>(prefs, "/core/media_reader/pipeline/decode_workers");
+    return workers > 0 ? workers : std::max(1, int(std::thread::hardware_concurrency()));
+}
+
+// the media detail and thumbnail readers, which also scan pixel statistics. A
+// frame range is scanned this many frames at a time so it keeps them all busy
+// without decoding the whole range into memory.
+constexpr size_t k_detail_readers = 4;
 } // namespace
 
+// A frame range being scanned for pixel statistics. Each frame's statistics
+// are merged into the sequence when they arrive and its image is released.
+struct GlobalMediaReaderActor::PixelStatisticsRange {
+    PixelStatisticsRange(
+        media::AVFrameIDs frames,
+        const JsonStore &options,
+        caf::typed_response_promise<JsonStore> promise)
+        : mptrs(std::move(frames)),
+          options(options),
+          sequence(PixelStatisticsOptions(options)),
+          frame_stats(mptrs.size()),
+          rp(std::move(promise)) {}
+
+    media::AVFrameIDs mptrs;
+    JsonStore options;
+    PixelStatistics sequence;
+    std::vector<nlohmann::json> frame_stats;
+    size_t next        = {0};
+    size_t outstanding = {0};
+    caf::typed_response_promise<JsonStore> rp;
+};
+
 
 class ReaderHelper : public caf::event_based_actor {
   public:
     ReaderHelper(
         caf::actor_config &cfg,
         std::vector<caf::actor> plugins,
-        std::map<std::string, utility::Uuid> plugin_map);
+        std::map<std::string, utility::Uuid> plugin_map,
+        caf::actor worker_pool);
     ~ReaderHelper() override = default;
 
     const char *name() const override { return NAME.c_str(); }
@@ -53,15 +99,18 @@ class ReaderHelper : public caf::event_based_actor {
     caf::behavior behavior_;
     std::vector<caf::actor> plugins_;
     std::map<std::string, utility::Uuid> plugin_map_;
+    caf::actor worker_pool_;
 };
 
 ReaderHelper::ReaderHelper(
     caf::actor_config &cfg,
     std::vector<caf::actor> plugins,
-    std::map<std::string, utility::Uuid> plugin_map)
+    std::map<std::string, utility::Uuid> plugin_map,
+    caf::actor worker_pool)
     : caf::event_based_actor(cfg),
       plugins_(std::move(plugins)),
-      plugin_map_(std::move(plugin_map)) {
+      plugin_map_(std::move(plugin_map)),
+      worker_pool_(std::move(worker_pool)) {
 
     behavior_.assign(
         [=](xstudio::broadcast::broadcast_down_atom, const caf::actor_addr &) {},
@@ -78,7 +127,8 @@ ReaderHelper::ReaderHelper(
                     return spawn<CachingMediaReaderActor>(
                         uuid,
                         system().registry().template get<caf::actor>(image_cache_registry),
-                        system().registry().template get<caf::actor>(audio_cache_registry));
+                        system().registry().template get<caf::actor>(audio_cache_registry),
+                        worker_pool_);
                 } catch (...) {
                     // shutting down
                     return make_error(sec::runtime_error, "Shutting down");
@@ -118,7 +168,8 @@ ReaderHelper::ReaderHelper(
                                         system().registry().template get<caf::actor>(
                                             image_cache_registry),
                                         system().registry().template get<caf::actor>(
-                                            audio_cache_registry)));
+                                            audio_cache_registry),
+                                        worker_pool_));
                                 } catch (...) {
                                     // shutting down
                                     return rp.deliver(
@@ -155,6 +206,10 @@ GlobalMediaReaderActor::GlobalMediaReaderActor(
             max_source_count_ =
                 preference_value<size_t>(js, "/core/media_reader/max_source_count");
             max_source_age_ = preference_value<size_t>(js, "/core/media_reader/max_source_age");
+            image_cache_max_size_ =
+                preference_value<size_t>(js, "/core/image_cache/max_size") * 1024 * 1024;
+            update_prefetch_preferences(js);
+            precache_in_flight_max_ = precache_in_flight(js);
         } catch (...) {
         }
 
@@ -170,14 +225,28 @@ GlobalMediaReaderActor::GlobalMediaReaderActor(
                 link_to(actor);
                 plugins_.push_back(actor);
                 plugins_map_[i.name_] = i.uuid_;
+
+                // CachingMediaReaderActor precaches these through its pipeline
+                try {
+                    if (request_receive<bool>(
+                            *sys, actor, media_reader::decode_from_memory_atom_v))
+                        pipeline_readers_.insert(i.name_);
+                } catch (const std::exception &err) {
+                    spdlog::warn("{} {}", __PRETTY_FUNCTION__, err.what());
+                }
             }
         }
+
+        // reader plugin instances for the sources we open, made ahead of time
+        // once each reader has been used
+        worker_pool_ = spawn<MediaReaderWorkerPoolActor>();
+        link_to(worker_pool_);
     }
 
     pool_ = caf::actor_pool::make(
         system().dummy_execution_unit(),
         5,
-        [&] { return system().spawn<ReaderHelper>(plugins_, plugins_map_); },
+        [&] { return system().spawn<ReaderHelper>(plugins_, plugins_map_, worker_pool_); },
         caf::actor_pool::round_robin());
     link_to(pool_);
 
@@ -190,7 +259,7 @@ GlobalMediaReaderActor::GlobalMediaReaderActor(
 
     auto media_detail_and_thumbnail_reader_pool = caf::actor_pool::make(
         system().dummy_execution_unit(),
-        4, // hardcoding to 4 media detail fetchers
+        k_detail_readers,
         [&] { return system().spawn<MediaDetailAndThumbnailReaderActor>(); },
         caf::actor_pool::round_robin());
     link_to(media_detail_and_thumbnail_reader_pool);
@@ -200,7 +269,7 @@ GlobalMediaReaderActor::GlobalMediaReaderActor(
 
         [=](clear_precache_queue_atom, const Uuid &playhead_uuid) -> bool {
             playback_precache_request_queue_.clear_pending_requests(playhead_uuid);
-            background_precache_request_queue_.clear_pending_requests(playhead_uuid);
+            clear_background_precache_requests(playhead_uuid);
 
             // this marks all cache entries for this playhead as 'stale' by
             // moving their timestamps to 1 hour in the past - hence they
@@ -219,7 +288,7 @@ GlobalMediaReaderActor::GlobalMediaReaderActor(
             for (const auto &playhead_uuid : playhead_uuids) {
 
                 playback_precache_request_queue_.clear_pending_requests(playhead_uuid);
-                background_precache_request_queue_.clear_pending_requests(playhead_uuid);
+                clear_background_precache_requests(playhead_uuid);
                 // this marks all cache entries for this playhead as 'stale' by
                 // moving their timestamps to 1 hour in the past - hence they
                 // will be dropped if the cache fills up
@@ -399,6 +468,141 @@ GlobalMediaReaderActor::GlobalMediaReaderActor(
                     });
         },
 
+        [=](export_image_atom,
+            const media::AVFrameID &mptr,
+            const BufferExportMode mode) -> result<ImageBufferExport> {
+            // fetch from the cache, or decode on a miss, and package the
+            // pixels for a client outside of the playback engine
+            auto rp = make_response_promise<ImageBufferExport>();
+            request(
+                caf::actor_cast<caf::actor>(this),
+                infinite,
+                get_image_atom_v,
+                mptr,
+                false,
+                utility::Uuid())
+                .then(
+                    [=](const ImageBufPtr &buf) mutable {
+                        try {
+                            ImageBufferExport result(buf, mode);
+                            if (result.key().empty())
+                                result.set_key(mptr.key_);
+                            if (not result.shared_memory_name().empty())
+                                exported_shared_memory_[result.shared_memory_name()] =
+                                    utility::clock::now();
+                            rp.deliver(result);
+                        } catch (const std::exception &err) {
+                            rp.deliver(make_error(xstudio_error::error, err.what()));
+                        }
+                    },
+                    [=](const caf::error &err) mutable {
+                        ImageBufferExport result;
+                        result.set_key(mptr.key_);
+                        result.set_error(to_string(err));
+                        rp.deliver(result);
+                    });
+            return rp;
+        },
+
+        [=](export_image_atom,
+            const caf::actor &media_source,
+            const int first_frame,
+            const int last_frame,
+            const BufferExportMode mode) -> result<std::vector<ImageBufferExport>> {
+            // batch export of a frame range, frames that fail to load are
+            // returned with their error set rather than failing the batch.
+            auto rp = make_response_promise<std::vector<ImageBufferExport>>();
+            request(
+                media_source,
+                infinite,
+                get_media_pointers_atom_v,
+                media::MediaType::MT_IMAGE,
+                media::LogicalFrameRanges{{first_frame, last_frame}})
+                .then(
+                    [=](const media::AVFrameIDs &mptrs) mutable {
+                        if (mptrs.empty()) {
+                            rp.deliver(std::vector<ImageBufferExport>());
+                            return;
+                        }
+
+                        auto results =
+                            std::make_shared<std::vector<ImageBufferExport>>(mptrs.size());
+                        auto outstanding = std::make_shared<size_t>(mptrs.size());
+
+                        for (size_t i = 0; i < mptrs.size(); ++i) {
+                            request(
+                                caf::actor_cast<caf::actor>(this),
+                                infinite,
+                                export_image_atom_v,
+                                *(mptrs[i]),
+                                mode)
+                                .then(
+                                    [=](const ImageBufferExport &result) mutable {
+                                        (*results)[i] = result;
+                                        if (not --(*outstanding))
+                                            rp.deliver(*results);
+                                    },
+                                    [=](const caf::error &err) mutable {
+                                        (*results)[i].set_key(mptrs[i]->key_);
+                                        (*results)[i].set_error(to_string(err));
+                                        if (not --(*outstanding))
+                                            rp.deliver(*results);
+                                    });
+                        }
+                    },
+                    [=](const caf::error &err) mutable { rp.deliver(err); });
+            return rp;
+        },
+
+        [=](pixel_statistics_atom,
+            const media::AVFrameID &mptr,
+            const JsonStore &options) -> result<JsonStore> {
+            // fetch from the cache, or decode on a miss, and scan the pixels
+            // on the detail readers so playback requests aren't held up
+            auto rp = make_response_promise<JsonStore>();
+            request(
+                caf::actor_cast<caf::actor>(this),
+                infinite,
+                get_image_atom_v,
+                mptr,
+                false,
+                utility::Uuid())
+                .then(
+                    [=](const ImageBufPtr &buf) mutable {
+                        rp.delegate(
+                            media_detail_and_thumbnail_reader_pool,
+                            pixel_statistics_atom_v,
+                            buf,
+                            options);
+                    },
+                    [=](const caf::error &err) mutable { rp.deliver(err); });
+            return rp;
+        },
+
+        [=](pixel_statistics_atom,
+            const caf::actor &media_source,
+            const int first_frame,
+            const int last_frame,
+            const JsonStore &options) -> result<JsonStore> {
+            // statistics of each frame of a range and of the whole range,
+            // merged as the frames arrive. Frames that fail are listed with
+            // their error and left out of the sequence.
+            auto rp = make_response_promise<JsonStore>();
+            request(
+                media_source,
+                infinite,
+                get_media_pointers_atom_v,
+                media::MediaType::MT_IMAGE,
+                media::LogicalFrameRanges{{first_frame, last_frame}})
+                .then(
+                    [=](const media::AVFrameIDs &mptrs) mutable {
+                        request_pixel_statistics(
+                            std::make_shared<PixelStatisticsRange>(mptrs, options, rp));
+                    },
+                    [=](const caf::error &err) mutable { rp.deliver(err); });
+            return rp;
+        },
+
         [=](get_media_detail_atom _get_media_detail_atom,
             const caf::uri &_uri,
             const caf::actor_addr &key) {
@@ -409,6 +613,14 @@ GlobalMediaReaderActor::GlobalMediaReaderActor(
             delegate(media_detail_and_thumbnail_reader_pool, atom, mptr, size);
         },
 
+        [=](get_filmstrip_atom atom,
+            const media::AVFrameID &mptr,
+            const size_t count,
+            const size_t size,
+            const bool rgb24) {
+            delegate(media_detail_and_thumbnail_reader_pool, atom, mptr, count, size, rgb24);
+        },
+
         [=](json_store::update_atom,
             const JsonStore & /*change*/,
             const std::string & /*path*/,
@@ -421,6 +633,10 @@ GlobalMediaReaderActor::GlobalMediaReaderActor(
                 preference_value<size_t>(json, "/core/media_reader/max_source_count");
             max_source_age_ =
                 preference_value<size_t>(json, "/core/media_reader/max_source_age");
+            image_cache_max_size_ =
+                preference_value<size_t>(json, "/core/image_cache/max_size") * 1024 * 1024;
+            update_prefetch_preferences(json);
+            precache_in_flight_max_ = precache_in_flight(json);
             // mmm_->update_preferences(json);
             prune_readers();
         },
@@ -467,8 +683,7 @@ GlobalMediaReaderActor::GlobalMediaReaderActor(
                                         // clear all pending requests
                                         playback_precache_request_queue_.clear_pending_requests(
                                             playhead_uuid);
-                                        background_precache_request_queue_
-                                            .clear_pending_requests(playhead_uuid);
+                                        clear_background_precache_requests(playhead_uuid);
 
                                         playback_precache_request_queue_.add_frame_requests(
                                             media_ptrs_not_in_image_cache, playhead_uuid);
@@ -489,11 +704,23 @@ GlobalMediaReaderActor::GlobalMediaReaderActor(
         },
 
         [=](static_precache_atom,
-            const media::AVFrameIDsAndTimePoints mptrs,
+            media::AVFrameIDsAndTimePoints mptrs,
             const Uuid playhead_uuid) -> result<bool> {
             auto rp = make_response_promise<bool>();
             auto tt = utility::clock::now();
 
+            // the request is in priority order, anything past what the cache
+            // can hold would only evict the frames queued before it. The first
+            // frame is always kept, even if frames are bigger than the cache.
+            const auto frame_bytes = scheduler_.average_frame_bytes();
+            if (frame_bytes and image_cache_max_size_ and not mptrs.empty() and
+                mptrs.front().second->media_type_ == media::MediaType::MT_IMAGE) {
+                const auto frames =
+                    std::max(image_cache_max_size_ / frame_bytes, static_cast<size_t>(1));
+                if (mptrs.size() > frames)
+                    mptrs.resize(frames);
+            }
+
             // we've been told to start background cacheing, so assume playback
             // read-ahead can be cancelled. Keep a note of the timepoint of the
             // first frame in the request queue - anything with an older time
@@ -502,12 +729,18 @@ GlobalMediaReaderActor::GlobalMediaReaderActor(
                 request(image_cache_, infinite, media_cache::unpreserve_atom_v, playhead_uuid)
                     .then(
                         [=](bool) mutable {
-                            background_precache_request_queue_.clear_pending_requests(
-                                playhead_uuid);
+                            clear_background_precache_requests(playhead_uuid);
                             playback_precache_request_queue_.clear_pending_requests(
                                 playhead_uuid);
                             background_precache_request_queue_.add_frame_requests(
                                 mptrs, playhead_uuid);
+                            for (const auto &i : mptrs) {
+                                scheduler_.add_pending(
+                                    playhead_uuid,
+                                    i.second->reader_,
+                                    PrecacheScheduler::volume(
+                                        uri_to_posix_path(i.second->uri_)));
+                            }
                             background_cached_ref_timepoint_[playhead_uuid] =
                                 mptrs.front().first;
                             continue_precacheing();
@@ -515,14 +748,25 @@ GlobalMediaReaderActor::GlobalMediaReaderActor(
                         },
                         [=](const caf::error &err) mutable { rp.deliver(err); });
             } else {
-                background_precache_request_queue_.clear_pending_requests(playhead_uuid);
+                clear_background_precache_requests(playhead_uuid);
                 rp.deliver(false);
             }
             return rp;
         },
 
+        [=](precache_estimate_atom, const Uuid &playhead_uuid) -> JsonStore {
+            JsonStore result;
+            result["frames"]  = scheduler_.pending(playhead_uuid);
+            result["seconds"] = std::chrono::duration_cast<std::chrono::duration<double>>(
+                                    scheduler_.time_until_cached(playhead_uuid))
+                                    .count();
+            result["average_frame_bytes"] = scheduler_.average_frame_bytes();
+            return result;
+        },
+
         [=](retire_readers_atom) {
             prune_readers();
+            release_exported_shared_memory();
             delayed_anon_send(
                 this, std::chrono::seconds(max_source_age_), retire_readers_atom_v);
         },
@@ -637,7 +881,65 @@ void GlobalMediaReaderActor::prune_readers() {
     }
 }
 
-void GlobalMediaReaderActor::on_exit() { system().registry().erase(media_reader_registry); }
+void GlobalMediaReaderActor::on_exit() {
+    release_exported_shared_memory(true);
+    system().registry().erase(media_reader_registry);
+}
+
+void GlobalMediaReaderActor::request_pixel_statistics(
+    const std::shared_ptr<PixelStatisticsRange> &range) {
+
+    // a sliding window, the next frame is requested as each one finishes
+    while (range->next < range->mptrs.size() and range->outstanding < k_detail_readers) {
+        const auto i = range->next++;
+        range->outstanding++;
+        request(
+            caf::actor_cast<caf::actor>(this),
+            infinite,
+            pixel_statistics_atom_v,
+            *(range->mptrs[i]),
+            range->options)
+            .then(
+                [=](const JsonStore &stats) {
+                    try {
+                        range->sequence.merge(PixelStatistics(stats));
+                        range->frame_stats[i] = static_cast<const nlohmann::json &>(stats);
+                    } catch (const std::exception &err) {
+                        range->frame_stats[i]["error"] = err.what();
+                    }
+                    range->outstanding--;
+                    request_pixel_statistics(range);
+                },
+                [=](const caf::error &err) {
+                    range->frame_stats[i]["error"] = to_string(err);
+                    range->outstanding--;
+                    request_pixel_statistics(range);
+                });
+    }
+
+    if (not range->outstanding) {
+        JsonStore result;
+        result["sequence"] = static_cast<const nlohmann::json &>(range->sequence.serialise());
+        result["frames"] = range->frame_stats;
+        range->rp.deliver(result);
+    }
+}
+
+void GlobalMediaReaderActor::release_exported_shared_memory(const bool all) {
+    // Clients unlink shared memory exports as soon as they map them. This
+    // catches the ones that were never collected (client went away) so they
+    // don't outlive us.
+    auto now = utility::clock::now();
+    auto it  = exported_shared_memory_.begin();
+    while (it != exported_shared_memory_.end()) {
+        if (all or now - it->second > std::chrono::seconds(60)) {
+            shm_unlink(it->first.c_str());
+            it = exported_shared_memory_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
 
 void GlobalMediaReaderActor::do_precache() {
 
@@ -648,23 +950,33 @@ void GlobalMediaReaderActor::do_precache() {
     // reading frames is slow) - we would then be in a situation where the CAF
     // mailbox is full of requests to precache frames
     std::optional<FrameRequest> fr = playback_precache_request_queue_.pop_request(
-        playheads_with_precache_requests_in_flight_);
+        playheads_with_precache_requests_in_flight_,
+        precache_in_flight_max_,
+        pipeline_readers_);
 
     // when putting new images in the cache, images older than this timepoint can
     // be discarded
     bool is_background_cache = false;
     if (not fr) {
         fr = background_precache_request_queue_.pop_request(
-            playheads_with_precache_requests_in_flight_);
+            playheads_with_precache_requests_in_flight_,
+            precache_in_flight_max_,
+            pipeline_readers_);
 
 
         if (not fr) {
             return; // global reader is saying pre-cache queue for this reader is empty
         }
         is_background_cache = true;
+        scheduler_.remove_pending(
+            fr->requesting_playhead_uuid_,
+            fr->requested_frame_->reader_,
+            PrecacheScheduler::volume(uri_to_posix_path(fr->requested_frame_->uri_)));
     }
 
     const std::shared_ptr<const media::AVFrameID> mptr = fr->requested_frame_;
+    if (mptr->media_type_ == media::MediaType::MT_IMAGE)
+        prefetch_upcoming_files(*mptr);
 
     const time_point &predicted_time   = fr->required_by_;
     const utility::Uuid &playhead_uuid = fr->requesting_playhead_uuid_;
@@ -689,6 +1001,11 @@ void GlobalMediaReaderActor::do_precache() {
         mptr->media_type_ == media::MediaType::MT_IMAGE ? image_cache_ : audio_cache_;
     mark_playhead_waiting_for_precache_result(playhead_uuid);
 
+    // keep going until every playhead has as many reads in flight as the
+    // readers can work on at once
+    if (precache_in_flight_max_ > 1 and pipeline_readers_.count(mptr->reader_))
+        continue_precacheing();
+
     request(
         cache_actor,
         std::chrono::milliseconds(500),
@@ -749,6 +1066,49 @@ void GlobalMediaReaderActor::do_precache() {
             });
 }
 
+void GlobalMediaReaderActor::update_prefetch_preferences(const utility::JsonStore &prefs) {
+    prefetch_read_ahead_ =
+        preference_value<size_t>(prefs, "/core/media_reader/prefetch/read_ahead");
+    prefetch_readers_ =
+        preference_value<std::set<std::string>>(prefs, "/core/media_reader/prefetch/readers");
+
+    auto &prefetcher = FilePrefetcher::global();
+    prefetcher.set_max_bytes(
+        preference_value<size_t>(prefs, "/core/media_reader/prefetch/max_size") * 1024 * 1024);
+    prefetcher.set_direct_io(
+        preference_value<bool>(prefs, "/core/media_reader/prefetch/direct_io"));
+    if (not prefetch_read_ahead_)
+        prefetcher.clear();
+}
+
+void GlobalMediaReaderActor::prefetch_upcoming_files(const media::AVFrameID &current) {
+    if (not prefetch_read_ahead_)
+        return;
+
+    // the frame we're about to read, then whatever comes after it
+    auto frames = playback_precache_request_queue_.upcoming_frames(prefetch_read_ahead_);
+    if (frames.size() < prefetch_read_ahead_) {
+        const auto more = background_precache_request_queue_.upcoming_frames(
+            prefetch_read_ahead_ - frames.size());
+        frames.insert(frames.end(), more.begin(), more.end());
+    }
+
+    auto &prefetcher = FilePrefetcher::global();
+    if (prefetch_readers_.count(current.reader_))
+        prefetcher.prefetch(uri_to_posix_path(current.uri_));
+    for (const auto &frame : frames) {
+        if (frame->media_type_ == media::MediaType::MT_IMAGE and
+            prefetch_readers_.count(frame->reader_))
+            prefetcher.prefetch(uri_to_posix_path(frame->uri_));
+    }
+}
+
+void GlobalMediaReaderActor::clear_background_precache_requests(
+    const utility::Uuid &playhead_uuid) {
+    background_precache_request_queue_.clear_pending_requests(playhead_uuid);
+    scheduler_.clear_pending(playhead_uuid);
+}
+
 void GlobalMediaReaderActor::keep_cache_hot(
     const media::MediaKey &new_entry,
     const utility::time_point &tp,
@@ -771,9 +1131,19 @@ void GlobalMediaReaderActor::read_and_cache_image(
     const time_point predicted_time                    = fr.required_by_;
     const utility::Uuid playhead_uuid                  = fr.requesting_playhead_uuid_;
 
+    const auto read_start = utility::clock::now();
+
     request(reader, std::chrono::seconds(60), read_precache_image_atom_v, *mptr)
         .then(
             [=](media_reader::ImageBufPtr buf) mutable {
+                if (buf)
+                    scheduler_.record_read(
+                        mptr->reader_,
+                        PrecacheScheduler::volume(uri_to_posix_path(mptr->uri_)),
+                        buf->size(),
+                        std::chrono::duration_cast<std::chrono::microseconds>(
+                            utility::clock::now() - read_start));
+
                 // store the image in our cache. We use a different store message
                 // if background cacheing
                 if (is_background_cache) {
@@ -792,8 +1162,7 @@ void GlobalMediaReaderActor::read_and_cache_image(
 
                                 if (!stored) {
                                     // cache is full ... stop background cacheing
-                                    background_precache_request_queue_.clear_pending_requests(
-                                        playhead_uuid);
+                                    clear_background_precache_requests(playhead_uuid);
                                 } else {
                                     // still might have work to do
                                     continue_precacheing();
@@ -818,8 +1187,7 @@ void GlobalMediaReaderActor::read_and_cache_image(
                                     // woops, cache is full. Stop pre-reading.
                                     playback_precache_request_queue_.clear_pending_requests(
                                         playhead_uuid);
-                                    background_precache_request_queue_.clear_pending_requests(
-                                        playhead_uuid);
+                                    clear_background_precache_requests(playhead_uuid);
                                 }
                                 mark_playhead_received_precache_result(playhead_uuid);
 
@@ -874,8 +1242,7 @@ void GlobalMediaReaderActor::read_and_cache_audio(
 
                             if (!stored && is_background_cache) {
                                 // cache is full ... stop background cacheing
-                                background_precache_request_queue_.clear_pending_requests(
-                                    playhead_uuid);
+                                clear_background_precache_requests(playhead_uuid);
                             } else {
                                 continue_precacheing();
                                 if (is_background_cache) {
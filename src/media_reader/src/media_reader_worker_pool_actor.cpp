@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "xstudio/media_reader/media_reader_worker_pool_actor.hpp"
+#include "xstudio/atoms.hpp"
+#include "xstudio/global_store/global_store.hpp"
+#include "xstudio/utility/helpers.hpp"
+#include "xstudio/utility/logging.hpp"
+
+using namespace xstudio::media_reader;
+using namespace xstudio::json_store;
+using namespace xstudio::utility;
+using namespace xstudio::global_store;
+
+
+MediaReaderWorkerPoolActor::MediaReaderWorkerPoolActor(caf::actor_config &cfg)
+    : caf::event_based_actor(cfg) {
+
+    print_on_exit(this, "MediaReaderWorkerPoolActor");
+
+    {
+        auto prefs = GlobalStoreHelper(system());
+        JsonStore js;
+        join_broadcast(this, prefs.get_group(js));
+        update_preferences(js);
+    }
+
+    plugin_manager_ = system().registry().template get<caf::actor>(plugin_manager_registry);
+
+    behavior_.assign(
+        [=](xstudio::broadcast::broadcast_down_atom, const caf::actor_addr &) {},
+
+        [=](plugin_manager::spawn_plugin_atom,
+            const utility::Uuid &plugin_uuid,
+            const utility::JsonStore &js) -> result<caf::actor> {
+            auto &spares = spares_[plugin_uuid];
+            if (not spares.empty()) {
+                auto worker = spares.back();
+                spares.pop_back();
+                unlink_from(worker);
+                top_up(plugin_uuid);
+                return worker;
+            }
+
+            // none ready, the caller waits for this one. Spares are only kept
+            // for plugins that have been asked for.
+            auto rp = make_response_promise<caf::actor>();
+            request(
+                plugin_manager_,
+                infinite,
+                plugin_manager::spawn_plugin_atom_v,
+                plugin_uuid,
+                js)
+                .then(
+                    [=](caf::actor worker) mutable { rp.deliver(worker); },
+                    [=](const caf::error &err) mutable { rp.deliver(err); });
+            top_up(plugin_uuid);
+            return rp;
+        },
+
+        [=](json_store::update_atom,
+            const JsonStore & /*change*/,
+            const std::string & /*path*/,
+            const JsonStore &full) {
+            delegate(actor_cast<caf::actor>(this), json_store::update_atom_v, full);
+        },
+
+        [=](json_store::update_atom, const JsonStore &js) { update_preferences(js); });
+}
+
+void MediaReaderWorkerPoolActor::update_preferences(const utility::JsonStore &prefs) {
+    try {
+        spare_workers_ = preference_value<size_t>(prefs, "/core/media_reader/spare_workers");
+    } catch (const std::exception &err) {
+        spdlog::warn("{} {}", __PRETTY_FUNCTION__, err.what());
+    }
+    prefs_ = prefs;
+
+    // the spares follow preference changes themselves, but there may now be
+    // too many or too few of them
+    for (auto &p : spares_) {
+        while (p.second.size() > spare_workers_) {
+            unlink_from(p.second.back());
+            send_exit(p.second.back(), caf::exit_reason::user_shutdown);
+            p.second.pop_back();
+        }
+        top_up(p.first);
+    }
+}
+
+void MediaReaderWorkerPoolActor::top_up(const utility::Uuid &plugin_uuid) {
+
+    if (not plugin_manager_)
+        return;
+
+    while (spares_[plugin_uuid].size() + spawning_[plugin_uuid] < spare_workers_) {
+        spawning_[plugin_uuid]++;
+        request(
+            plugin_manager_,
+            infinite,
+            plugin_manager::spawn_plugin_atom_v,
+            plugin_uuid,
+            prefs_)
+            .then(
+                [=](caf::actor worker) {
+                    spawning_[plugin_uuid]--;
+                    if (spares_[plugin_uuid].size() < spare_workers_) {
+                        link_to(worker);
+                        spares_[plugin_uuid].push_back(worker);
+                    } else {
+                        send_exit(worker, caf::exit_reason::user_shutdown);
+                    }
+                },
+                [=](const caf::error &err) {
+                    spawning_[plugin_uuid]--;
+                    spdlog::warn("{} {}", __PRETTY_FUNCTION__, to_string(err));
+                });
+    }
+}
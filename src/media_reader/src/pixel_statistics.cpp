@@ -0,0 +1,425 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#include "xstudio/media_reader/image_buffer.hpp"
+#include "xstudio/media_reader/pixel_statistics.hpp"
+
+using namespace xstudio::media_reader;
+using namespace xstudio::utility;
+
+namespace {
+
+float half_to_float(const uint16_t h) {
+    const uint32_t sign = uint32_t(h & 0x8000) << 16;
+    const uint32_t exp  = (h >> 10) & 0x1f;
+    uint32_t mant       = h & 0x3ff;
+    uint32_t bits       = sign;
+
+    if (exp == 0x1f) {
+        bits |= 0x7f800000 | (mant << 13);
+    } else if (exp) {
+        bits |= ((exp + 127 - 15) << 23) | (mant << 13);
+    } else if (mant) {
+        // subnormal, normalise the mantissa
+        uint32_t e = 0;
+        while (not(mant & 0x400)) {
+            mant <<= 1;
+            e++;
+        }
+        bits |= ((127 - 14 - e) << 23) | ((mant & 0x3ff) << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+const std::vector<float> &half_table() {
+    static const std::vector<float> table = []() {
+        std::vector<float> t(65536);
+        for (size_t i = 0; i < t.size(); i++)
+            t[i] = half_to_float(uint16_t(i));
+        return t;
+    }();
+    return table;
+}
+
+template <typename T> float read_integer(const byte *p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return float(v) * (1.0f / float(std::numeric_limits<T>::max()));
+}
+
+float read_half(const byte *p) {
+    uint16_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return half_table()[v];
+}
+
+float read_float(const byte *p) {
+    float v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+std::string channel_name(const PixelPlane &plane, const size_t channel) {
+    if (plane.channels_ == 1)
+        return plane.name_;
+    // "rgb", "yuv" etc. name a channel a letter
+    if (plane.name_.size() == plane.channels_)
+        return std::string(1, plane.name_[channel]);
+    return plane.name_ + "." + std::to_string(channel);
+}
+
+struct PlaneScan {
+    const byte *data = {nullptr};
+    PixelPlane plane;
+    // rows that fit in the buffer
+    size_t height = {0};
+    // index of the plane's first channel in the statistics
+    size_t first_channel = {0};
+    // luma from this plane, either channel 0 or Rec.709 of channels 0-2
+    bool luma   = {false};
+    bool rec709 = {false};
+};
+
+struct Accumulator {
+    std::vector<ChannelStatistics> channels;
+    std::vector<uint64_t> waveform;
+};
+
+class Binner {
+  public:
+    Binner(const float min, const float max, const size_t bins)
+        : min_(min), scale_(max > min ? float(bins) / (max - min) : 0.0f), last_(bins - 1) {}
+
+    size_t operator()(const float v) const {
+        return size_t(std::clamp((v - min_) * scale_, 0.0f, last_));
+    }
+
+  private:
+    float min_;
+    float scale_;
+    float last_;
+};
+
+inline void accumulate(ChannelStatistics &c, const float v, const Binner &bin) {
+    if (std::isnan(v)) {
+        c.nan_count_++;
+    } else if (std::isinf(v)) {
+        c.inf_count_++;
+    } else {
+        c.min_ = std::min(c.min_, double(v));
+        c.max_ = std::max(c.max_, double(v));
+        c.sum_ += v;
+        c.count_++;
+        c.histogram_[bin(v)]++;
+    }
+}
+
+template <float (*Read)(const byte *)>
+void scan_rows(
+    const PlaneScan &p,
+    const size_t row_begin,
+    const size_t row_end,
+    const PixelStatisticsOptions &options,
+    Accumulator &acc) {
+
+    const Binner bin(options.histogram_min, options.histogram_max, options.histogram_bins);
+    const Binner luma_bin(options.histogram_min, options.histogram_max, options.waveform_bins);
+    const auto &plane      = p.plane;
+    const auto item_size   = plane.item_size();
+    const bool waveform    = p.luma and options.waveform_columns;
+    ChannelStatistics *out = acc.channels.data() + p.first_channel;
+
+    for (size_t y = row_begin; y < row_end; y += options.step) {
+        const byte *row = p.data + y * plane.row_stride_;
+        for (size_t x = 0; x < plane.width_; x += options.step) {
+            const byte *pixel = row + x * plane.pixel_stride_;
+            for (size_t c = 0; c < plane.channels_; c++)
+                accumulate(out[c], Read(pixel + c * item_size), bin);
+
+            if (waveform) {
+                float luma = Read(pixel);
+                if (p.rec709)
+                    luma = 0.2126f * luma + 0.7152f * Read(pixel + item_size) +
+                           0.0722f * Read(pixel + 2 * item_size);
+                if (std::isfinite(luma)) {
+                    const size_t column = x * options.waveform_columns / plane.width_;
+                    acc.waveform[column * options.waveform_bins + luma_bin(luma)]++;
+                }
+            }
+        }
+    }
+}
+
+void scan_plane(
+    const PlaneScan &p,
+    const size_t row_begin,
+    const size_t row_end,
+    const PixelStatisticsOptions &options,
+    Accumulator &acc) {
+    switch (p.plane.data_type_) {
+    case PDT_UINT8:
+        scan_rows<read_integer<uint8_t>>(p, row_begin, row_end, options, acc);
+        break;
+    case PDT_UINT16:
+        scan_rows<read_integer<uint16_t>>(p, row_begin, row_end, options, acc);
+        break;
+    case PDT_UINT32:
+        scan_rows<read_integer<uint32_t>>(p, row_begin, row_end, options, acc);
+        break;
+    case PDT_HALF:
+        scan_rows<read_half>(p, row_begin, row_end, options, acc);
+        break;
+    case PDT_FLOAT32:
+        scan_rows<read_float>(p, row_begin, row_end, options, acc);
+        break;
+    default:
+        break;
+    }
+}
+
+} // namespace
+
+PixelStatisticsOptions::PixelStatisticsOptions(const JsonStore &jsn) {
+    if (not jsn.is_object())
+        return;
+
+    histogram_bins   = jsn.value("histogram_bins", histogram_bins);
+    histogram_min    = jsn.value("histogram_min", histogram_min);
+    histogram_max    = jsn.value("histogram_max", histogram_max);
+    waveform_columns = jsn.value("waveform_columns", waveform_columns);
+    waveform_bins    = jsn.value("waveform_bins", waveform_bins);
+    step             = jsn.value("step", step);
+    threads          = jsn.value("threads", threads);
+
+    histogram_bins = std::max(histogram_bins, size_t(1));
+    waveform_bins  = std::max(waveform_bins, size_t(1));
+    step           = std::max(step, size_t(1));
+}
+
+JsonStore PixelStatisticsOptions::serialise() const {
+    JsonStore jsn;
+    jsn["histogram_bins"]   = histogram_bins;
+    jsn["histogram_min"]    = histogram_min;
+    jsn["histogram_max"]    = histogram_max;
+    jsn["waveform_columns"] = waveform_columns;
+    jsn["waveform_bins"]    = waveform_bins;
+    jsn["step"]             = step;
+    jsn["threads"]          = threads;
+    return jsn;
+}
+
+void ChannelStatistics::merge(const ChannelStatistics &o) {
+    min_ = std::min(min_, o.min_);
+    max_ = std::max(max_, o.max_);
+    sum_ += o.sum_;
+    count_ += o.count_;
+    nan_count_ += o.nan_count_;
+    inf_count_ += o.inf_count_;
+
+    if (histogram_.empty())
+        histogram_ = o.histogram_;
+    else if (histogram_.size() == o.histogram_.size())
+        std::transform(
+            histogram_.begin(),
+            histogram_.end(),
+            o.histogram_.begin(),
+            histogram_.begin(),
+            std::plus<uint64_t>());
+}
+
+PixelStatistics::PixelStatistics(const PixelStatisticsOptions &options) : options_(options) {}
+
+PixelStatistics::PixelStatistics(const JsonStore &jsn)
+    : options_(JsonStore(jsn.at("options"))), frames_(jsn.at("frames").get<size_t>()) {
+    for (const auto &i : jsn.at("channels")) {
+        ChannelStatistics c;
+        c.name_      = i.at("name").get<std::string>();
+        c.sum_       = i.at("sum").get<double>();
+        c.count_     = i.at("count").get<size_t>();
+        c.nan_count_ = i.at("nan_count").get<size_t>();
+        c.inf_count_ = i.at("inf_count").get<size_t>();
+        c.histogram_ = i.at("histogram").get<std::vector<uint64_t>>();
+        if (c.count_) {
+            c.min_ = i.at("min").get<double>();
+            c.max_ = i.at("max").get<double>();
+        }
+        channels_.push_back(c);
+    }
+    waveform_ = jsn.at("waveform").get<std::vector<uint64_t>>();
+}
+
+PixelStatistics
+PixelStatistics::compute(const ImageBuffer &buf, const PixelStatisticsOptions &options) {
+    std::vector<std::string> channel_names;
+    if (buf.params().contains("channel_names") and buf.params()["channel_names"].is_array())
+        channel_names = buf.params()["channel_names"].get<std::vector<std::string>>();
+
+    return compute(buf.buffer(), buf.size(), buf.pixel_layout(), channel_names, options);
+}
+
+PixelStatistics PixelStatistics::compute(
+    const byte *data,
+    const size_t size,
+    const PixelLayout &layout,
+    const std::vector<std::string> &channel_names,
+    const PixelStatisticsOptions &options) {
+
+    PixelStatistics result(options);
+    result.frames_ = 1;
+
+    // where luma comes from, a "y" plane or the first interleaved RGB(A)
+    int luma_plane = -1;
+    bool luma_is_y = false;
+    for (size_t i = 0; i < layout.size() and luma_plane == -1; i++) {
+        if (not layout[i].name_.empty() and std::tolower(layout[i].name_[0]) == 'y') {
+            luma_plane = int(i);
+            luma_is_y  = true;
+        }
+    }
+    for (size_t i = 0; i < layout.size() and luma_plane == -1; i++) {
+        if (layout[i].channels_ >= 3)
+            luma_plane = int(i);
+    }
+    if (luma_plane == -1 and not layout.empty())
+        luma_plane = 0;
+
+    std::vector<PlaneScan> planes;
+    for (size_t i = 0; i < layout.size(); i++) {
+        const auto &plane = layout[i];
+        if (not data or not plane.width_ or not plane.height_ or not plane.channels_ or
+            not plane.item_size())
+            continue;
+
+        // the last row needs only its pixels, not the whole stride
+        const size_t row_bytes = plane.width_ * plane.pixel_stride_;
+        if (plane.byte_offset_ + row_bytes > size)
+            continue;
+
+        PlaneScan p;
+        p.data          = data + plane.byte_offset_;
+        p.plane         = plane;
+        p.height        = std::min(
+            plane.height_,
+            plane.row_stride_ ? (size - plane.byte_offset_ - row_bytes) / plane.row_stride_ + 1
+                              : size_t(1));
+        p.first_channel = result.channels_.size();
+        p.luma          = int(i) == luma_plane;
+        p.rec709        = p.luma and not luma_is_y and plane.channels_ >= 3;
+        planes.push_back(p);
+
+        for (size_t c = 0; c < plane.channels_; c++) {
+            ChannelStatistics stats;
+            stats.name_ = layout.size() == 1 and channel_names.size() == plane.channels_
+                              ? channel_names[c]
+                              : channel_name(plane, c);
+            stats.histogram_.resize(options.histogram_bins);
+            result.channels_.push_back(stats);
+        }
+    }
+
+    if (options.waveform_columns)
+        result.waveform_.resize(options.waveform_columns * options.waveform_bins);
+
+    size_t rows = 0;
+    for (const auto &p : planes)
+        rows = std::max(rows, p.height / options.step);
+
+    // small images aren't worth the threads
+    size_t n_threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+    n_threads        = std::max(size_t(1), std::min(n_threads, rows / 64));
+
+    std::vector<Accumulator> accumulators(n_threads);
+    for (auto &acc : accumulators) {
+        acc.channels = result.channels_;
+        acc.waveform = result.waveform_;
+    }
+
+    // each thread takes the sampled rows in its share of every plane
+    auto work = [&](const size_t t) {
+        for (const auto &p : planes) {
+            const size_t begin = (p.height * t / n_threads + options.step - 1) /
+                                 options.step * options.step;
+            const size_t end   = p.height * (t + 1) / n_threads;
+            scan_plane(p, begin, end, options, accumulators[t]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < n_threads; t++)
+        threads.emplace_back(work, t);
+    work(0);
+    for (auto &t : threads)
+        t.join();
+
+    for (size_t c = 0; c < result.channels_.size(); c++) {
+        ChannelStatistics merged;
+        merged.name_ = result.channels_[c].name_;
+        for (const auto &acc : accumulators)
+            merged.merge(acc.channels[c]);
+        result.channels_[c] = merged;
+    }
+    for (const auto &acc : accumulators) {
+        for (size_t i = 0; i < result.waveform_.size(); i++)
+            result.waveform_[i] += acc.waveform[i];
+    }
+
+    return result;
+}
+
+void PixelStatistics::merge(const PixelStatistics &o) {
+    if (not frames_) {
+        *this = o;
+        return;
+    }
+
+    for (const auto &oc : o.channels_) {
+        auto it = std::find_if(channels_.begin(), channels_.end(), [&](const auto &c) {
+            return c.name_ == oc.name_;
+        });
+        if (it == channels_.end())
+            channels_.push_back(oc);
+        else
+            it->merge(oc);
+    }
+
+    if (waveform_.empty())
+        waveform_ = o.waveform_;
+    else if (waveform_.size() == o.waveform_.size())
+        std::transform(
+            waveform_.begin(),
+            waveform_.end(),
+            o.waveform_.begin(),
+            waveform_.begin(),
+            std::plus<uint64_t>());
+
+    frames_ += o.frames_;
+}
+
+JsonStore PixelStatistics::serialise() const {
+    JsonStore jsn;
+    jsn["frames"]   = frames_;
+    jsn["options"]  = static_cast<const nlohmann::json &>(options_.serialise());
+    jsn["channels"] = nlohmann::json::array();
+    for (const auto &c : channels_) {
+        nlohmann::json j;
+        j["name"]      = c.name_;
+        j["min"]       = c.count_ ? nlohmann::json(c.min_) : nlohmann::json();
+        j["max"]       = c.count_ ? nlohmann::json(c.max_) : nlohmann::json();
+        j["mean"]      = c.mean();
+        j["sum"]       = c.sum_;
+        j["count"]     = c.count_;
+        j["nan_count"] = c.nan_count_;
+        j["inf_count"] = c.inf_count_;
+        j["histogram"] = c.histogram_;
+        jsn["channels"].push_back(j);
+    }
+    jsn["waveform"] = waveform_;
+    return jsn;
+}
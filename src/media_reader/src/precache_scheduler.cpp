@@ -0,0 +1,208 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#include "xstudio/media_reader/precache_scheduler.hpp"
+
+using namespace xstudio;
+using namespace xstudio::media_reader;
+
+namespace {
+
+// Frame scores, higher is cached sooner. Everything the next play will show
+// scores above everything else, bar the few frames right behind the playhead
+// which are as likely to be scrubbed back to as the far end of the loop.
+constexpr double k_play_max     = 1.0;
+constexpr double k_play_min     = 0.5;
+constexpr double k_behind_max   = 0.75;
+constexpr double k_bookmark     = 0.6;
+constexpr double k_scrub_max    = 0.55;
+constexpr double k_remainder    = 0.45;
+constexpr int k_behind_frames   = 24;
+constexpr int k_bookmark_margin = 12;
+constexpr int k_scrub_frames    = 24;
+
+double ramp(const double top, const double bottom, const int distance, const int range) {
+    return top - (top - bottom) * (double(distance) / double(range));
+}
+
+} // namespace
+
+PrecacheScheduler::PrecacheScheduler(
+    const std::chrono::microseconds default_frame_cost, const double smoothing)
+    : default_frame_cost_(default_frame_cost), smoothing_(smoothing) {}
+
+std::vector<int>
+PrecacheScheduler::prioritise(const PrecacheHints &hints, const size_t max_frames) {
+
+    const int n = hints.num_frames;
+    if (n <= 0 or not max_frames)
+        return std::vector<int>();
+
+    const int loop_out = hints.loop_out < 0 ? n - 1 : std::min(hints.loop_out, n - 1);
+    const int loop_in  = std::max(0, std::min(hints.loop_in, loop_out));
+    const int loop_len = loop_out - loop_in + 1;
+    const int current  = std::max(0, std::min(hints.current_frame, n - 1));
+
+    // playing from outside the loop jumps into it
+    const int start = std::max(loop_in, std::min(current, loop_out));
+
+    std::vector<double> score(n);
+    for (int f = 0; f < n; f++) {
+        double s = k_remainder * (1.0 - double(std::abs(f - current)) / double(n));
+
+        if (f >= loop_in and f <= loop_out) {
+            // distance along the loop in the play direction
+            const int d = ((hints.forwards ? f - start : start - f) + loop_len) % loop_len;
+
+            s = std::max(s, ramp(k_play_max, k_play_min, d, loop_len));
+        }
+
+        const int behind = hints.forwards ? current - f : f - current;
+        if (behind > 0 and behind <= k_behind_frames)
+            s = std::max(s, ramp(k_behind_max, k_play_min, behind, k_behind_frames + 1));
+
+        score[f] = s;
+    }
+
+    for (const auto &b : hints.bookmarks) {
+        const int first = std::max(0, b.first - k_bookmark_margin);
+        const int last  = std::min(n - 1, b.second + k_bookmark_margin);
+        for (int f = first; f <= last; f++) {
+            const int outside = std::max(0, std::max(b.first - f, f - b.second));
+            score[f]          = std::max(
+                score[f], ramp(k_bookmark, k_remainder, outside, k_bookmark_margin + 1));
+        }
+    }
+
+    // older positions count for less
+    double weight = 1.0;
+    for (auto r = hints.recent_frames.rbegin(); r != hints.recent_frames.rend(); ++r) {
+        const int first = std::max(0, *r - k_scrub_frames);
+        const int last  = std::min(n - 1, *r + k_scrub_frames);
+        for (int f = first; f <= last; f++) {
+            score[f] = std::max(
+                score[f],
+                weight *
+                    ramp(k_scrub_max, k_remainder, std::abs(f - *r), k_scrub_frames + 1));
+        }
+        weight *= 0.9;
+    }
+
+    std::vector<int> result(n);
+    for (int f = 0; f < n; f++)
+        result[f] = f;
+
+    auto higher = [&score](const int a, const int b) {
+        return score[a] > score[b] or (score[a] == score[b] and a < b);
+    };
+    const auto count = std::min(size_t(n), max_frames);
+    std::partial_sort(result.begin(), result.begin() + count, result.end(), higher);
+    result.resize(count);
+
+    return result;
+}
+
+std::string PrecacheScheduler::volume(const std::string &path) {
+    size_t pos = 0;
+    for (int i = 0; i < 2; i++) {
+        pos = path.find('/', pos + 1);
+        if (pos == std::string::npos)
+            return path;
+    }
+    return path.substr(0, pos);
+}
+
+void PrecacheScheduler::record_read(
+    const std::string &reader,
+    const std::string &volume,
+    const size_t bytes,
+    const std::chrono::microseconds duration) {
+
+    const double seconds = std::max(
+        1e-6, std::chrono::duration_cast<std::chrono::duration<double>>(duration).count());
+
+    auto smooth = [this](double &value, const double sample) {
+        value = value > 0.0 ? value + smoothing_ * (sample - value) : sample;
+    };
+
+    smooth(reader_cost_[reader], seconds);
+    if (bytes) {
+        smooth(volume_bandwidth_[volume], double(bytes) / seconds);
+        smooth(frame_bytes_, double(bytes));
+    }
+}
+
+std::chrono::microseconds
+PrecacheScheduler::frame_cost(const std::string &reader, const std::string &volume) const {
+
+    auto r = reader_cost_.find(reader);
+    if (r != std::end(reader_cost_))
+        return std::chrono::microseconds(int64_t(r->second * 1e6));
+
+    // never used this reader, assume reading the bytes is what takes the time
+    auto v = volume_bandwidth_.find(volume);
+    if (v != std::end(volume_bandwidth_) and frame_bytes_ > 0.0)
+        return std::chrono::microseconds(int64_t(frame_bytes_ / v->second * 1e6));
+
+    return default_frame_cost_;
+}
+
+double PrecacheScheduler::reader_frames_per_second(const std::string &reader) const {
+    auto r = reader_cost_.find(reader);
+    return r == std::end(reader_cost_) ? 0.0 : 1.0 / r->second;
+}
+
+double PrecacheScheduler::volume_bytes_per_second(const std::string &volume) const {
+    auto v = volume_bandwidth_.find(volume);
+    return v == std::end(volume_bandwidth_) ? 0.0 : v->second;
+}
+
+void PrecacheScheduler::add_pending(
+    const utility::Uuid &playhead_uuid,
+    const std::string &reader,
+    const std::string &volume,
+    const size_t count) {
+    pending_[playhead_uuid][Source(reader, volume)] += count;
+}
+
+void PrecacheScheduler::remove_pending(
+    const utility::Uuid &playhead_uuid, const std::string &reader, const std::string &volume) {
+
+    auto p = pending_.find(playhead_uuid);
+    if (p == std::end(pending_))
+        return;
+
+    auto s = p->second.find(Source(reader, volume));
+    if (s != std::end(p->second) and not --(s->second))
+        p->second.erase(s);
+
+    if (p->second.empty())
+        pending_.erase(p);
+}
+
+void PrecacheScheduler::clear_pending(const utility::Uuid &playhead_uuid) {
+    pending_.erase(playhead_uuid);
+}
+
+size_t PrecacheScheduler::pending(const utility::Uuid &playhead_uuid) const {
+    size_t result = 0;
+    auto p        = pending_.find(playhead_uuid);
+    if (p != std::end(pending_)) {
+        for (const auto &s : p->second)
+            result += s.second;
+    }
+    return result;
+}
+
+std::chrono::microseconds
+PrecacheScheduler::time_until_cached(const utility::Uuid &playhead_uuid) const {
+    std::chrono::microseconds result(0);
+    auto p = pending_.find(playhead_uuid);
+    if (p != std::end(pending_)) {
+        for (const auto &s : p->second)
+            result += frame_cost(s.first.first, s.first.second) * int64_t(s.second);
+    }
+    return result;
+}
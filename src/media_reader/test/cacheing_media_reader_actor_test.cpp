@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <caf/all.hpp>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "xstudio/atoms.hpp"
+#include "xstudio/global_store/global_store.hpp"
+#include "xstudio/global_store/global_store_actor.hpp"
+#include "xstudio/media/media.hpp"
+#include "xstudio/media_reader/cacheing_media_reader_actor.hpp"
+#include "xstudio/media_reader/file_prefetcher.hpp"
+#include "xstudio/media_reader/image_buffer.hpp"
+#include "xstudio/utility/helpers.hpp"
+
+using namespace xstudio;
+using namespace xstudio::utility;
+using namespace xstudio::media_reader;
+using namespace xstudio::global_store;
+
+using namespace caf;
+
+namespace fs = std::filesystem;
+
+#include "xstudio/utility/serialise_headers.hpp"
+
+ACTOR_TEST_SETUP()
+
+namespace {
+
+struct Counters {
+    std::atomic<int> spawned   = {0};
+    std::atomic<int> decoded   = {0};
+    std::atomic<int> from_file = {0};
+};
+
+// Stands in for a reader plugin that can decode files the pipeline has read.
+// It says whether each frame came from the prefetcher in the buffer's params.
+caf::behavior fake_reader(caf::event_based_actor *, std::shared_ptr<Counters> counters) {
+    return {
+        [=](media_reader::decode_from_memory_atom) { return true; },
+        [=](media_reader::get_image_atom, const media::AVFrameID &mptr) -> ImageBufPtr {
+            const auto path = uri_to_posix_path(mptr.uri_);
+            const auto file = FilePrefetcher::global().take(path);
+            if (not file)
+                counters->from_file++;
+            counters->decoded++;
+
+            ImageBufPtr buf(new ImageBuffer());
+            buf->params()["path"]       = path;
+            buf->params()["prefetched"] = bool(file);
+            return buf;
+        }};
+}
+
+caf::behavior
+fake_worker_pool(caf::event_based_actor *self, std::shared_ptr<Counters> counters) {
+    return {
+        [=](plugin_manager::spawn_plugin_atom,
+            const utility::Uuid &,
+            const utility::JsonStore &) -> caf::actor {
+            counters->spawned++;
+            return self->spawn(fake_reader, counters);
+        }};
+}
+
+} // namespace
+
+TEST(CachingMediaReaderActorTest, Pipeline) {
+    fixture f;
+
+    auto store = f.self->spawn<GlobalStoreActor>(
+        "test",
+        std::vector<GlobalStoreDef>{
+            {"/core/media_reader/pipeline/enabled", true, "bool", ""},
+            {"/core/media_reader/pipeline/decode_workers", 3, "int", ""},
+            {"/core/media_reader/pipeline/max_size", 64, "int", ""}});
+
+    auto tmpl = std::string("/tmp/xstudio_cacheing_media_reader_XXXXXX");
+    const fs::path dir(mkdtemp(tmpl.data()));
+    std::vector<std::string> paths;
+    for (int i = 0; i < 32; i++) {
+        paths.push_back(dir / std::to_string(i));
+        std::ofstream(paths.back(), std::ios::binary) << std::string(64 * 1024, char(i));
+    }
+
+    auto counters = std::make_shared<Counters>();
+    auto pool     = f.self->spawn(fake_worker_pool, counters);
+    auto reader   = f.self->spawn<CachingMediaReaderActor>(
+        utility::Uuid::generate(), caf::actor(), caf::actor(), pool);
+
+    const auto precache = [&](const std::string &path) {
+        return f.self->request(
+            reader,
+            std::chrono::seconds(10),
+            read_precache_image_atom_v,
+            media::AVFrameID(posix_path_to_uri(path)));
+    };
+
+    // the first frame is read by the worker as we don't yet know whether it
+    // can decode from memory
+    precache(paths.front())
+        .receive(
+            [&](const ImageBufPtr &buf) {
+                ASSERT_TRUE(buf);
+                EXPECT_EQ(buf->params()["path"].get<std::string>(), paths.front());
+                EXPECT_FALSE(buf->params()["prefetched"].get<bool>());
+            },
+            [&](const caf::error &err) { FAIL() << to_string(err); });
+
+    // the rest are read by the prefetcher and decoded by the pool of workers.
+    // Each request gets its own frame, whatever order they're decoded in.
+    std::vector<decltype(precache(paths.front()))> requests;
+    for (size_t i = 1; i < paths.size(); i++)
+        requests.push_back(precache(paths[i]));
+
+    for (size_t i = 1; i < paths.size(); i++) {
+        requests[i - 1].receive(
+            [&](const ImageBufPtr &buf) {
+                ASSERT_TRUE(buf);
+                EXPECT_EQ(buf->params()["path"].get<std::string>(), paths[i]);
+                EXPECT_TRUE(buf->params()["prefetched"].get<bool>());
+            },
+            [&](const caf::error &err) { FAIL() << to_string(err); });
+    }
+
+    EXPECT_EQ(counters->decoded, int(paths.size()));
+    EXPECT_EQ(counters->from_file, 1);
+    EXPECT_GE(counters->spawned, 1);
+    EXPECT_LE(counters->spawned, 3);
+
+    // nothing read is left behind
+    for (const auto &path : paths)
+        EXPECT_FALSE(FilePrefetcher::global().pending(path));
+    EXPECT_EQ(FilePrefetcher::global().bytes(), 0u);
+
+    f.self->send_exit(reader, caf::exit_reason::user_shutdown);
+    f.self->send_exit(pool, caf::exit_reason::user_shutdown);
+    f.self->send_exit(store, caf::exit_reason::user_shutdown);
+    fs::remove_all(dir);
+}
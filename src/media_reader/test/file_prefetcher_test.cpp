@@ -0,0 +1,268 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+#include "xstudio/media_reader/file_prefetcher.hpp"
+
+using namespace xstudio::media_reader;
+using namespace std::chrono_literals;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class TempDir {
+  public:
+    TempDir(const std::string &parent = "/tmp") {
+        auto tmpl = parent + "/xstudio_file_prefetcher_XXXXXX";
+        path_     = mkdtemp(tmpl.data());
+    }
+    ~TempDir() { fs::remove_all(path_); }
+    const fs::path &path() const { return path_; }
+
+  private:
+    fs::path path_;
+};
+
+std::vector<char> write_file(const fs::path &path, const size_t size, const int seed) {
+    std::vector<char> data(size);
+    for (size_t i = 0; i < size; i++)
+        data[i] = char((i * 31 + seed) & 0xff);
+    std::ofstream(path, std::ios::binary).write(data.data(), data.size());
+    return data;
+}
+
+bool matches(const FilePrefetcher::File &file, const std::vector<char> &data) {
+    return file.size == data.size() and
+           std::memcmp(file.data.get(), data.data(), data.size()) == 0;
+}
+
+// A ReadFunc that blocks until it is opened, so the tests know which reads
+// have started without sleeping.
+class GatedRead {
+  public:
+    ~GatedRead() { open(); }
+
+    FilePrefetcher::ReadFunc func() {
+        return [this](const std::string &path, const bool direct_io) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                started_.push_back(path);
+                cv_.notify_all();
+                cv_.wait(lock, [&]() { return open_; });
+            }
+            return FilePrefetcher::read_file(path, direct_io);
+        };
+    }
+
+    void wait_started(const std::string &path) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&]() {
+            return std::find(started_.begin(), started_.end(), path) != started_.end();
+        });
+    }
+
+    size_t started() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return started_.size();
+    }
+
+    std::vector<std::string> order() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return started_;
+    }
+
+    void open() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = true;
+        cv_.notify_all();
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::string> started_;
+    bool open_ = {false};
+};
+
+} // namespace
+
+TEST(FilePrefetcherTest, Test) {
+    TempDir dir;
+    const auto a = write_file(dir.path() / "a.exr", 100000, 1);
+    const auto b = write_file(dir.path() / "b.exr", 5000, 2);
+
+    auto file = FilePrefetcher::read_file(dir.path() / "a.exr", false);
+    ASSERT_TRUE(file);
+    EXPECT_TRUE(matches(*file, a));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(file->data.get()) % 4096, uintptr_t(0));
+    EXPECT_FALSE(FilePrefetcher::read_file(dir.path() / "c.exr", false));
+    EXPECT_FALSE(FilePrefetcher::read_file(dir.path(), false));
+
+    // O_DIRECT, or a normal read if the filesystem can't
+    file = FilePrefetcher::read_file(dir.path() / "b.exr", true);
+    ASSERT_TRUE(file);
+    EXPECT_TRUE(matches(*file, b));
+
+    FilePrefetcher prefetcher(2);
+    prefetcher.prefetch(dir.path() / "a.exr");
+    prefetcher.prefetch(dir.path() / "b.exr");
+    prefetcher.prefetch(dir.path() / "c.exr");
+
+    while (prefetcher.pending(dir.path() / "b.exr"))
+        std::this_thread::sleep_for(1ms);
+
+    file = prefetcher.take(dir.path() / "a.exr");
+    ASSERT_TRUE(file);
+    EXPECT_TRUE(matches(*file, a));
+    // only once
+    EXPECT_FALSE(prefetcher.take(dir.path() / "a.exr"));
+    EXPECT_FALSE(prefetcher.take(dir.path() / "c.exr"));
+    EXPECT_TRUE(matches(*prefetcher.take(dir.path() / "b.exr"), b));
+    EXPECT_EQ(prefetcher.bytes(), size_t(0));
+
+    // asking for one that hasn't been started yet takes it out of the queue
+    // and leaves the caller to read it
+    GatedRead gate;
+    FilePrefetcher slow(1, size_t(1024) * 1024, gate.func());
+    slow.prefetch(dir.path() / "a.exr");
+    slow.prefetch(dir.path() / "b.exr");
+    // the one thread is busy with a.exr
+    gate.wait_started(dir.path() / "a.exr");
+    EXPECT_FALSE(slow.take(dir.path() / "b.exr"));
+    EXPECT_FALSE(slow.pending(dir.path() / "b.exr"));
+    EXPECT_TRUE(slow.pending(dir.path() / "a.exr"));
+    // but waits for one being read
+    gate.open();
+    file = slow.take(dir.path() / "a.exr");
+    ASSERT_TRUE(file);
+    EXPECT_TRUE(matches(*file, a));
+    EXPECT_EQ(gate.started(), size_t(1));
+}
+
+TEST(FilePrefetcherTest, Budget) {
+    TempDir dir;
+    FilePrefetcher prefetcher(1, 250000);
+    for (int i = 0; i < 4; i++) {
+        const auto path = dir.path() / std::to_string(i);
+        write_file(path, 100000, i);
+        prefetcher.prefetch(path);
+    }
+    while (prefetcher.pending(dir.path() / "3"))
+        std::this_thread::sleep_for(1ms);
+
+    // the oldest unused reads went
+    EXPECT_LE(prefetcher.bytes(), size_t(250000));
+    EXPECT_FALSE(prefetcher.take(dir.path() / "0"));
+    EXPECT_TRUE(prefetcher.take(dir.path() / "3"));
+
+    prefetcher.clear();
+    EXPECT_EQ(prefetcher.bytes(), size_t(0));
+}
+
+TEST(FilePrefetcherTest, ThrottledStorage) {
+    // A stand in for slow network storage, reads don't finish until the gate
+    // opens. Reading ahead has a read in flight on every thread at once, so
+    // the next frames are read while the current one decodes.
+    TempDir dir;
+    std::vector<std::string> paths;
+    std::vector<std::vector<char>> data;
+    for (int i = 0; i < 4; i++) {
+        paths.push_back(dir.path() / std::to_string(i));
+        data.push_back(write_file(paths.back(), 1024 * 1024, i));
+    }
+
+    GatedRead gate;
+    FilePrefetcher prefetcher(4, size_t(64) * 1024 * 1024, gate.func());
+    for (const auto &path : paths)
+        prefetcher.prefetch(path);
+    for (const auto &path : paths)
+        gate.wait_started(path);
+    EXPECT_EQ(gate.started(), paths.size());
+
+    // and they are served from memory
+    gate.open();
+    for (size_t i = 0; i < paths.size(); i++) {
+        const auto file = prefetcher.take(paths[i]);
+        ASSERT_TRUE(file);
+        EXPECT_TRUE(matches(*file, data[i]));
+    }
+    EXPECT_EQ(gate.started(), paths.size());
+    EXPECT_EQ(prefetcher.bytes(), size_t(0));
+}
+
+TEST(FilePrefetcherTest, Ordering) {
+    // Files are read in the order they were asked for, once each, however
+    // often the playhead asks again, and every one is then a hit.
+    TempDir dir;
+    std::vector<std::string> paths;
+    std::vector<std::vector<char>> data;
+    for (int i = 0; i < 6; i++) {
+        paths.push_back(dir.path() / std::to_string(i));
+        data.push_back(write_file(paths.back(), 100000, i));
+    }
+
+    GatedRead gate;
+    FilePrefetcher prefetcher(1, size_t(64) * 1024 * 1024, gate.func());
+    for (const auto &path : paths)
+        prefetcher.prefetch(path);
+    gate.wait_started(paths[0]);
+
+    // being read, queued, and queued again after the last
+    prefetcher.prefetch(paths[0]);
+    prefetcher.prefetch(paths[3]);
+    prefetcher.prefetch(paths[5]);
+    gate.open();
+    while (prefetcher.pending(paths.back()))
+        std::this_thread::sleep_for(1ms);
+
+    EXPECT_EQ(gate.order(), paths);
+    EXPECT_EQ(prefetcher.bytes(), size_t(100000) * paths.size());
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        const auto file = prefetcher.take(paths[i]);
+        ASSERT_TRUE(file) << paths[i];
+        EXPECT_TRUE(matches(*file, data[i]));
+    }
+    EXPECT_EQ(gate.started(), paths.size());
+    EXPECT_EQ(prefetcher.bytes(), size_t(0));
+}
+
+TEST(FilePrefetcherTest, Callback) {
+    TempDir dir;
+    const auto a = write_file(dir.path() / "a.exr", 100000, 1);
+
+    FilePrefetcher prefetcher(2);
+    std::atomic<int> called = {0};
+    prefetcher.prefetch(dir.path() / "a.exr", [&]() { called++; });
+    prefetcher.prefetch(dir.path() / "c.exr", [&]() { called++; });
+    while (called < 2)
+        std::this_thread::sleep_for(1ms);
+    EXPECT_TRUE(matches(*prefetcher.take(dir.path() / "a.exr"), a));
+
+    // already read, called straight away
+    prefetcher.prefetch(dir.path() / "a.exr");
+    while (prefetcher.pending(dir.path() / "a.exr"))
+        std::this_thread::sleep_for(1ms);
+    prefetcher.prefetch(dir.path() / "a.exr", [&]() { called++; });
+    EXPECT_EQ(called, 3);
+
+    // and when a read is dropped from the queue
+    GatedRead gate;
+    FilePrefetcher slow(1, size_t(1024) * 1024, gate.func());
+    slow.prefetch(dir.path() / "a.exr");
+    gate.wait_started(dir.path() / "a.exr");
+    slow.prefetch(dir.path() / "b.exr", [&]() { called++; });
+    slow.clear();
+    EXPECT_EQ(called, 4);
+    gate.open();
+}
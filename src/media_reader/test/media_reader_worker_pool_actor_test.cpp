@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <caf/all.hpp>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <map>
+#include <mutex>
+
+#include "xstudio/atoms.hpp"
+#include "xstudio/global_store/global_store.hpp"
+#include "xstudio/global_store/global_store_actor.hpp"
+#include "xstudio/media_reader/media_reader_worker_pool_actor.hpp"
+#include "xstudio/utility/helpers.hpp"
+
+using namespace xstudio;
+using namespace xstudio::utility;
+using namespace xstudio::media_reader;
+using namespace xstudio::global_store;
+
+using namespace caf;
+
+#include "xstudio/utility/serialise_headers.hpp"
+
+ACTOR_TEST_SETUP()
+
+namespace {
+
+struct Spawned {
+    std::mutex mutex;
+    std::map<Uuid, std::vector<caf::actor>> workers;
+
+    std::vector<caf::actor> get(const Uuid &uuid) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return workers[uuid];
+    }
+};
+
+// Stands in for the plugin manager, keeping every worker it makes.
+caf::behavior
+fake_plugin_manager(caf::event_based_actor *self, std::shared_ptr<Spawned> spawned) {
+    return {
+        [=](plugin_manager::spawn_plugin_atom,
+            const utility::Uuid &uuid,
+            const utility::JsonStore &) -> caf::actor {
+            auto worker = self->spawn([](caf::event_based_actor *) -> caf::behavior {
+                return {[](utility::name_atom) -> std::string { return "worker"; }};
+            });
+            std::lock_guard<std::mutex> lock(spawned->mutex);
+            spawned->workers[uuid].push_back(worker);
+            return worker;
+        },
+        // answered after any spawn requests already queued
+        [=](utility::detail_atom, const utility::Uuid &uuid) -> int {
+            std::lock_guard<std::mutex> lock(spawned->mutex);
+            return int(spawned->workers[uuid].size());
+        }};
+}
+
+} // namespace
+
+TEST(MediaReaderWorkerPoolActorTest, SparesAfterFirstUse) {
+    fixture f;
+
+    auto store = f.self->spawn<GlobalStoreActor>(
+        "test",
+        std::vector<GlobalStoreDef>{{"/core/media_reader/spare_workers", 2, "int", ""}});
+
+    auto spawned = std::make_shared<Spawned>();
+    auto manager = f.self->spawn(fake_plugin_manager, spawned);
+    f.system.registry().put(plugin_manager_registry, manager);
+
+    const auto used   = Uuid::generate();
+    const auto unused = Uuid::generate();
+    const auto count  = [&](const Uuid &uuid) {
+        return request_receive<int>(*(f.self), manager, utility::detail_atom_v, uuid);
+    };
+
+    // nothing is made until a plugin is asked for
+    auto pool = f.self->spawn<MediaReaderWorkerPoolActor>();
+    EXPECT_EQ(count(used), 0);
+    EXPECT_EQ(count(unused), 0);
+
+    // the first caller waits for its own worker, the spares follow it
+    const auto first = request_receive<caf::actor>(
+        *(f.self), pool, plugin_manager::spawn_plugin_atom_v, used, JsonStore());
+    EXPECT_EQ(first, spawned->get(used).front());
+    EXPECT_EQ(count(used), 3);
+    EXPECT_EQ(count(unused), 0);
+
+    // the next caller is handed a spare, which is replaced
+    const auto second = request_receive<caf::actor>(
+        *(f.self), pool, plugin_manager::spawn_plugin_atom_v, used, JsonStore());
+    const auto made = spawned->get(used);
+    EXPECT_NE(second, first);
+    EXPECT_NE(std::find(made.begin() + 1, made.begin() + 3, second), made.begin() + 3);
+    EXPECT_EQ(count(used), 4);
+    EXPECT_EQ(count(unused), 0);
+
+    f.self->send_exit(pool, caf::exit_reason::user_shutdown);
+    f.system.registry().erase(plugin_manager_registry);
+    for (const auto &i : spawned->get(used))
+        f.self->send_exit(i, caf::exit_reason::user_shutdown);
+    f.self->send_exit(manager, caf::exit_reason::user_shutdown);
+    f.self->send_exit(store, caf::exit_reason::user_shutdown);
+}
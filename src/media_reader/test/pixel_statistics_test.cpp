@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <cmath>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <limits>
+#include <numeric>
+
+#include "xstudio/media_reader/pixel_statistics.hpp"
+
+using namespace xstudio;
+using namespace xstudio::media_reader;
+using namespace xstudio::utility;
+
+TEST(PixelStatisticsTest, Float) {
+    // red ramps across, green is constant, blue has a NaN and an Inf
+    const size_t w = 256, h = 256;
+    std::vector<float> pixels(w * h * 3);
+    for (size_t y = 0; y < h; y++) {
+        for (size_t x = 0; x < w; x++) {
+            auto *p = &pixels[(y * w + x) * 3];
+            p[0]    = float(x) / float(w - 1);
+            p[1]    = 0.5f;
+            p[2]    = 0.25f;
+        }
+    }
+    pixels[2]         = std::numeric_limits<float>::quiet_NaN();
+    pixels[5]         = std::numeric_limits<float>::infinity();
+    const auto layout = PixelLayout({PixelPlane("rgb", PDT_FLOAT32, w, h, 3)});
+
+    PixelStatisticsOptions options;
+    options.histogram_bins   = 4;
+    options.waveform_columns = 8;
+    options.waveform_bins    = 16;
+    options.threads          = 4;
+
+    auto stats = PixelStatistics::compute(
+        reinterpret_cast<const byte *>(pixels.data()),
+        pixels.size() * sizeof(float),
+        layout,
+        {},
+        options);
+
+    ASSERT_EQ(stats.channels().size(), size_t(3));
+    const auto &r = stats.channels()[0];
+    const auto &g = stats.channels()[1];
+    const auto &b = stats.channels()[2];
+    EXPECT_EQ(r.name_, "r");
+    EXPECT_EQ(b.name_, "b");
+
+    EXPECT_EQ(r.count_, w * h);
+    EXPECT_DOUBLE_EQ(r.min_, 0.0);
+    EXPECT_DOUBLE_EQ(r.max_, 1.0);
+    EXPECT_NEAR(r.mean(), 0.5, 1e-6);
+    // the ramp spreads evenly over the bins
+    EXPECT_EQ(r.histogram_, std::vector<uint64_t>(4, w * h / 4));
+    EXPECT_EQ(g.histogram_[2], w * h);
+
+    EXPECT_EQ(b.nan_count_, size_t(1));
+    EXPECT_EQ(b.inf_count_, size_t(1));
+    EXPECT_EQ(b.count_, w * h - 2);
+    EXPECT_DOUBLE_EQ(b.max_, 0.25);
+
+    // every finite pixel lands in the waveform once, luma rises across the columns
+    ASSERT_EQ(stats.waveform().size(), size_t(8 * 16));
+    EXPECT_EQ(
+        std::accumulate(stats.waveform().begin(), stats.waveform().end(), uint64_t(0)),
+        w * h - 2);
+    auto peak = [&](const size_t column) {
+        auto begin = stats.waveform().begin() + column * 16;
+        return std::distance(begin, std::max_element(begin, begin + 16));
+    };
+    EXPECT_LT(peak(0), peak(7));
+
+    // the same with one thread
+    options.threads = 1;
+    auto single     = PixelStatistics::compute(
+        reinterpret_cast<const byte *>(pixels.data()),
+        pixels.size() * sizeof(float),
+        layout,
+        {},
+        options);
+    EXPECT_EQ(single.serialise()["channels"], stats.serialise()["channels"]);
+    EXPECT_EQ(single.waveform(), stats.waveform());
+
+    // sampling every other pixel of every other row
+    options.step = 2;
+    auto sampled = PixelStatistics::compute(
+        reinterpret_cast<const byte *>(pixels.data()),
+        pixels.size() * sizeof(float),
+        layout,
+        {},
+        options);
+    EXPECT_EQ(sampled.channels()[0].count_, w * h / 4);
+}
+
+TEST(PixelStatisticsTest, HalfAndYUV) {
+    // 1.0, 0.5, -2.0 and 65504 as halfs, with names as an EXR reader gives them
+    const std::vector<uint16_t> halfs({0x3c00, 0x3800, 0xc000, 0x7bff});
+    auto stats = PixelStatistics::compute(
+        reinterpret_cast<const byte *>(halfs.data()),
+        halfs.size() * 2,
+        {PixelPlane("RGBA", PDT_HALF, 1, 1, 4)},
+        {"R", "G", "B", "A"},
+        PixelStatisticsOptions());
+    ASSERT_EQ(stats.channels().size(), size_t(4));
+    EXPECT_EQ(stats.channels()[3].name_, "A");
+    EXPECT_DOUBLE_EQ(stats.channels()[0].min_, 1.0);
+    EXPECT_DOUBLE_EQ(stats.channels()[1].min_, 0.5);
+    EXPECT_DOUBLE_EQ(stats.channels()[2].min_, -2.0);
+    EXPECT_DOUBLE_EQ(stats.channels()[3].min_, 65504.0);
+    // out of range values go in the end bins
+    EXPECT_EQ(stats.channels()[2].histogram_.front(), uint64_t(1));
+    EXPECT_EQ(stats.channels()[3].histogram_.back(), uint64_t(1));
+
+    // planar 4:2:0, 8 bit, with padded rows
+    const size_t w = 4, h = 4, stride = 8;
+    std::vector<uint8_t> yuv(stride * h + 2 * stride * h / 2, 0);
+    for (size_t y = 0; y < h; y++)
+        std::memset(&yuv[y * stride], 255, w);
+    std::memset(&yuv[stride * h], 128, stride * h);
+    const PixelLayout layout({
+        PixelPlane("y", PDT_UINT8, w, h, 1, 0, 1, stride),
+        PixelPlane("u", PDT_UINT8, w / 2, h / 2, 1, stride * h, 1, stride),
+        PixelPlane("v", PDT_UINT8, w / 2, h / 2, 1, stride * h * 3 / 2, 1, stride),
+    });
+
+    PixelStatisticsOptions options;
+    options.waveform_columns = 2;
+    options.waveform_bins    = 4;
+    auto video               = PixelStatistics::compute(
+        reinterpret_cast<const byte *>(yuv.data()), yuv.size(), layout, {}, options);
+    ASSERT_EQ(video.channels().size(), size_t(3));
+    EXPECT_EQ(video.channels()[0].name_, "y");
+    EXPECT_EQ(video.channels()[0].count_, w * h);
+    EXPECT_DOUBLE_EQ(video.channels()[0].min_, 1.0);
+    EXPECT_EQ(video.channels()[1].count_, w * h / 4);
+    EXPECT_NEAR(video.channels()[2].mean(), 128.0 / 255.0, 1e-6);
+    // all the luma is at the top of each column
+    EXPECT_EQ(video.waveform(), std::vector<uint64_t>({0, 0, 0, 8, 0, 0, 0, 8}));
+}
+
+TEST(PixelStatisticsTest, Sequence) {
+    PixelStatisticsOptions options;
+    options.histogram_bins = 2;
+
+    const std::vector<float> dark({0.1f, 0.2f}), bright({0.9f, 0.6f});
+    const PixelLayout layout({PixelPlane("Y", PDT_FLOAT32, 2, 1, 1)});
+    auto frame = [&](const std::vector<float> &pixels) {
+        return PixelStatistics::compute(
+            reinterpret_cast<const byte *>(pixels.data()), 8, layout, {}, options);
+    };
+
+    PixelStatistics sequence;
+    sequence.merge(frame(dark));
+    sequence.merge(frame(bright));
+    EXPECT_EQ(sequence.frames(), size_t(2));
+    EXPECT_EQ(sequence.channels()[0].count_, size_t(4));
+    EXPECT_NEAR(sequence.channels()[0].min_, 0.1, 1e-6);
+    EXPECT_NEAR(sequence.channels()[0].max_, 0.9, 1e-6);
+    EXPECT_EQ(sequence.channels()[0].histogram_, std::vector<uint64_t>({2, 2}));
+
+    // sent between actors as json
+    PixelStatistics restored(sequence.serialise());
+    EXPECT_EQ(restored.serialise(), sequence.serialise());
+    EXPECT_EQ(restored.options().histogram_bins, size_t(2));
+}
@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <set>
+
+#include "xstudio/media_reader/precache_scheduler.hpp"
+
+using namespace xstudio;
+using namespace xstudio::media_reader;
+using namespace std::chrono_literals;
+
+namespace {
+
+// A reader with a fixed cost per frame. Frames in cache_order are read while
+// the playhead is idle, then the user plays from start_frame. Anything not
+// cached is read in play order as it plays. Returns the frames that weren't
+// ready in time.
+int simulate_dropped_frames(
+    const std::vector<int> &cache_order,
+    const std::chrono::microseconds read_cost,
+    const std::chrono::microseconds idle_time,
+    const int start_frame,
+    const int play_frames,
+    const std::chrono::microseconds frame_period) {
+
+    std::set<int> cached;
+    auto t = std::chrono::microseconds(0);
+    for (const auto f : cache_order) {
+        t += read_cost;
+        if (t > idle_time)
+            break;
+        cached.insert(f);
+    }
+
+    int dropped    = 0;
+    auto reader_at = std::chrono::microseconds(0);
+    for (int i = 0; i < play_frames; i++) {
+        if (cached.count(start_frame + i))
+            continue;
+        reader_at += read_cost;
+        if (reader_at > frame_period * i)
+            dropped++;
+    }
+    return dropped;
+}
+
+} // namespace
+
+TEST(PrecacheSchedulerTest, Prioritise) {
+    PrecacheHints hints;
+    hints.num_frames    = 100;
+    hints.current_frame = 40;
+
+    auto order = PrecacheScheduler::prioritise(hints, 100);
+    ASSERT_EQ(order.size(), size_t(100));
+    // everything in play order until it's further away than the frame behind
+    for (int i = 0; i < 52; i++)
+        EXPECT_EQ(order[i], 40 + i);
+    EXPECT_EQ(order[52], 39);
+
+    // every frame once
+    std::set<int> unique(order.begin(), order.end());
+    EXPECT_EQ(unique.size(), size_t(100));
+
+    // backwards from outside the loop starts at the loop and wraps
+    hints.loop_in       = 20;
+    hints.loop_out      = 60;
+    hints.current_frame = 10;
+    hints.forwards      = false;
+    order               = PrecacheScheduler::prioritise(hints, 3);
+    EXPECT_EQ(order, std::vector<int>({20, 60, 59}));
+
+    // then bookmarks, then where the user was scrubbing
+    hints               = PrecacheHints();
+    hints.num_frames    = 1000;
+    hints.current_frame = 5;
+    hints.loop_in       = 0;
+    hints.loop_out      = 9;
+    hints.bookmarks     = {{500, 510}};
+    hints.recent_frames = {100, 800};
+    order               = PrecacheScheduler::prioritise(hints, 1000);
+    std::vector<int> rank(1000);
+    for (int i = 0; i < 1000; i++)
+        rank[order[i]] = i;
+
+    EXPECT_EQ(order[0], 5);
+    EXPECT_LT(*std::max_element(order.begin(), order.begin() + 10), 10);
+    EXPECT_EQ(rank[500], 10);
+    EXPECT_LT(rank[510], rank[800]);
+    // the most recent scrub position counts for more
+    EXPECT_LT(rank[800], rank[100]);
+    EXPECT_LT(rank[100], rank[300]);
+    // near the playhead before far away
+    EXPECT_LT(rank[20], rank[900]);
+
+    EXPECT_EQ(PrecacheScheduler::prioritise(hints, 23).size(), size_t(23));
+    EXPECT_TRUE(PrecacheScheduler::prioritise(PrecacheHints(), 10).empty());
+}
+
+TEST(PrecacheSchedulerTest, Volume) {
+    EXPECT_EQ(PrecacheScheduler::volume("/mnt/projects/shot/a.0001.exr"), "/mnt/projects");
+    EXPECT_EQ(PrecacheScheduler::volume("/tmp"), "/tmp");
+}
+
+TEST(PrecacheSchedulerTest, Throughput) {
+    PrecacheScheduler scheduler(40ms, 0.5);
+    const auto playhead = utility::Uuid::generate();
+
+    EXPECT_EQ(scheduler.frame_cost("exr", "/mnt/a"), 40ms);
+
+    scheduler.add_pending(playhead, "exr", "/mnt/a", 10);
+    scheduler.add_pending(playhead, "ffmpeg", "/mnt/b", 10);
+    EXPECT_EQ(scheduler.pending(playhead), size_t(20));
+    EXPECT_EQ(scheduler.time_until_cached(playhead), 800ms);
+
+    // a simulated reader taking 20ms a frame for 8MB frames
+    for (int i = 0; i < 5; i++) {
+        scheduler.record_read("exr", "/mnt/a", 8000000, 20ms);
+        scheduler.remove_pending(playhead, "exr", "/mnt/a");
+    }
+    EXPECT_EQ(scheduler.frame_cost("exr", "/mnt/a"), 20ms);
+    EXPECT_NEAR(scheduler.reader_frames_per_second("exr"), 50.0, 1e-6);
+    EXPECT_NEAR(scheduler.volume_bytes_per_second("/mnt/a"), 4e8, 1.0);
+    EXPECT_EQ(scheduler.average_frame_bytes(), size_t(8000000));
+
+    // an unused reader on a known volume is estimated from its bandwidth
+    EXPECT_EQ(scheduler.frame_cost("ffmpeg", "/mnt/a"), 20ms);
+    EXPECT_EQ(scheduler.pending(playhead), size_t(15));
+    EXPECT_EQ(scheduler.time_until_cached(playhead), 5 * 20ms + 10 * 40ms);
+
+    // it slows down, the estimate follows
+    scheduler.record_read("exr", "/mnt/a", 8000000, 60ms);
+    EXPECT_NEAR(scheduler.frame_cost("exr", "/mnt/a").count(), 40000, 1);
+
+    scheduler.clear_pending(playhead);
+    EXPECT_EQ(scheduler.pending(playhead), size_t(0));
+    EXPECT_EQ(scheduler.time_until_cached(playhead), 0ms);
+}
+
+TEST(PrecacheSchedulerTest, DropFree) {
+    // A reader slower than playback has a second of idle time before the user
+    // plays from frame 500. Cacheing outward from the playhead in play order
+    // plays more frames on time than cacheing the timeline from the start.
+    const auto read_cost    = std::chrono::microseconds(60000);
+    const auto frame_period = std::chrono::microseconds(41667);
+    const auto idle         = std::chrono::microseconds(1000000);
+
+    PrecacheHints hints;
+    hints.num_frames    = 2000;
+    hints.current_frame = 500;
+    hints.recent_frames = {1500};
+
+    auto scheduled = PrecacheScheduler::prioritise(hints, 2000);
+    std::vector<int> from_start(2000);
+    std::iota(from_start.begin(), from_start.end(), 0);
+
+    const auto scheduled_drops =
+        simulate_dropped_frames(scheduled, read_cost, idle, 500, 48, frame_period);
+    const auto from_start_drops =
+        simulate_dropped_frames(from_start, read_cost, idle, 500, 48, frame_period);
+
+    EXPECT_LT(scheduled_drops, from_start_drops);
+
+    // and with enough idle time the next play doesn't drop at all
+    EXPECT_EQ(
+        simulate_dropped_frames(
+            scheduled, read_cost, std::chrono::microseconds(3000000), 500, 48, frame_period),
+        0);
+}
@@ -100,6 +100,12 @@ void PlayheadActor::init() {
 
     set_exit_handler([=](scheduled_actor *a, caf::exit_msg &m) {
         disconnect_from_ui();
+        if (image_cache_)
+            anon_send(
+                image_cache_,
+                media_cache::cache_occupancy_atom_v,
+                uuid(),
+                media::MediaKeyVector());
         audio_output_actor_ = caf::actor();
         empty_clip_         = caf::actor();
         image_cache_        = caf::actor();
@@ -854,10 +860,14 @@ void PlayheadActor::init() {
         },
 
         [=](utility::event_atom,
-            media_cache::keys_atom,
-            const media::MediaKeyVector new_keys,
-            const media::MediaKeyVector remove_keys) {
-            update_cached_frames_status(new_keys, remove_keys);
+            media_cache::cache_occupancy_atom,
+            const utility::Uuid &id,
+            const utility::OccupancyBitmap &bitmap) {
+            // versions only go up, anything older is from a previous timeline
+            if (id == uuid() and bitmap.version() > frames_cached_.version()) {
+                frames_cached_ = bitmap;
+                update_cached_frames_status();
+            }
         },
 
         [=](utility::event_atom,
@@ -1677,43 +1687,11 @@ void PlayheadActor::rebuild_bookmark_frames_ranges() {
 }
 
 
-void PlayheadActor::update_cached_frames_status(
-    const media::MediaKeyVector &new_keys, const media::MediaKeyVector &remove_keys) {
-
-    for (auto key : new_keys) {
-        if (not frames_cached_.count(key))
-            frames_cached_.insert(key);
-    }
-
-    for (auto key : remove_keys) {
-        if (frames_cached_.count(key))
-            frames_cached_.erase(key);
-    }
-
-    cached_frames_ranges_.clear();
-    bool in_cache = false;
-    std::pair<int, int> r;
-
-    auto count = static_cast<int>(all_frames_keys_.size());
-    auto scale = (count / 2048) + 1;
+void PlayheadActor::update_cached_frames_status() {
 
-    for (auto i = 0; i < count; i += scale) {
-        if (frames_cached_.count(all_frames_keys_[i]) != in_cache) {
-            if (in_cache == false) {
-                in_cache = true;
-                r.first  = i;
-            } else {
-                in_cache = false;
-                r.second = i - 1;
-                cached_frames_ranges_.push_back(r);
-            }
-        }
-    }
-
-    if (in_cache) {
-        r.second = count - 1;
-        cached_frames_ranges_.push_back(r);
-    }
+    // sampled down to roughly screen resolution
+    const auto scale      = (frames_cached_.size() / 2048) + 1;
+    cached_frames_ranges_ = frames_cached_.ranges(scale);
 
     send(
         event_group_,
@@ -1729,16 +1707,17 @@ void PlayheadActor::rebuild_cached_frames_status() {
             .then(
 
                 [=](const media::MediaKeyVector &keys) mutable {
-                    all_frames_keys_ = keys;
-
-                    // now fetch the full list of keys for frames that are in the cache
-                    request(image_cache_, infinite, media_cache::keys_atom_v)
+                    // the cache keeps our bitmap up to date from here on, an
+                    // empty timeline stops it tracking
+                    request(
+                        image_cache_,
+                        infinite,
+                        media_cache::cache_occupancy_atom_v,
+                        uuid(),
+                        keys)
                         .then(
-                            [=](const media::MediaKeyVector &cached_frames_keys) mutable {
-                                spdlog::stopwatch sw;
-                                frames_cached_.clear();
-                                frames_cached_.insert(
-                                    cached_frames_keys.begin(), cached_frames_keys.end());
+                            [=](const utility::OccupancyBitmap &bitmap) mutable {
+                                frames_cached_ = bitmap;
                                 update_cached_frames_status();
                             },
                             [=](const error &err) {
@@ -1749,8 +1728,13 @@ void PlayheadActor::rebuild_cached_frames_status() {
                     spdlog::warn("B {} {}", __PRETTY_FUNCTION__, to_string(err));
                 });
     } else {
-        all_frames_keys_.clear();
-        frames_cached_.clear();
+        if (image_cache_)
+            anon_send(
+                image_cache_,
+                media_cache::cache_occupancy_atom_v,
+                uuid(),
+                media::MediaKeyVector());
+        frames_cached_ = utility::OccupancyBitmap();
         update_cached_frames_status();
     }
 }
@@ -9,6 +9,7 @@
 #include "xstudio/broadcast/broadcast_actor.hpp"
 #include "xstudio/global_store/global_store.hpp"
 #include "xstudio/media_reader/media_reader_actor.hpp"
+#include "xstudio/media_reader/precache_scheduler.hpp"
 #include "xstudio/playhead/sub_playhead.hpp"
 #include "xstudio/utility/edit_list.hpp"
 #include "xstudio/utility/helpers.hpp"
@@ -63,6 +64,8 @@ void SubPlayhead::init() {
         pre_cache_read_ahead_frames_ = preference_value<size_t>(j, "/core/playhead/read_ahead");
         static_cache_delay_milliseconds_ = std::chrono::milliseconds(
             preference_value<size_t>(j, "/core/playhead/static_cache_delay_milliseconds"));
+        static_cache_max_frames_ =
+            preference_value<size_t>(j, "/core/playhead/static_cache_max_frames");
 
     } catch (std::exception &e) {
         spdlog::warn("{} {}", __PRETTY_FUNCTION__, e.what());
@@ -185,6 +188,8 @@ void SubPlayhead::init() {
                 static_cache_delay_milliseconds_ =
                     std::chrono::milliseconds(preference_value<size_t>(
                         full, "/core/playhead/static_cache_delay_milliseconds"));
+                static_cache_max_frames_ =
+                    preference_value<size_t>(full, "/core/playhead/static_cache_max_frames");
 
             } catch (std::exception &e) {
                 spdlog::warn("{} {}", __PRETTY_FUNCTION__, e.what());
@@ -401,6 +406,10 @@ void SubPlayhead::init() {
             -> std::vector<std::tuple<utility::Uuid, std::string, int, int>> {
             std::vector<std::tuple<utility::Uuid, std::string, int, int>> r;
             get_bookmark_ranges(bookmark_details, r);
+
+            bookmark_frames_.clear();
+            for (const auto &i : r)
+                bookmark_frames_.emplace_back(std::get<2>(i), std::get<3>(i));
             return r;
         },
 
@@ -589,6 +598,13 @@ void SubPlayhead::set_position(
         const bool frame_changed = logical_frame_ != logical_frame;
         logical_frame_           = logical_frame;
 
+        if (!playing && frame_changed) {
+            // where the user scrubs to is a hint for what to cache when idle
+            recent_frames_.push_back(logical_frame_);
+            if (recent_frames_.size() > 16)
+                recent_frames_.erase(recent_frames_.begin());
+        }
+
         auto now = utility::clock::now();
 
         // get the image from the image readers or cache and also request the
@@ -924,14 +940,40 @@ void SubPlayhead::make_static_precache_request(
     // by just sending an empty request to the pre-reader
     if (start_precache) {
 
-#pragma message                                                                                \
-    "This needs fixing - for now, hardcoding fetch max 2048 frames for idle precache"
-
         media::AVFrameIDsAndTimePoints requests;
-        get_lookahead_frame_pointers(
-            requests, 2048
-            // std::numeric_limits<int>::max() // this will fetch *ALL* frames in the source
-        );
+
+        // the last entry in full_timeline_frames_ marks the end of the
+        // last frame, it isn't a frame itself
+        if (full_timeline_frames_.size() > 1) {
+            std::vector<media::FrameTimeMap::iterator> frames;
+            frames.reserve(full_timeline_frames_.size() - 1);
+            const auto end = std::prev(full_timeline_frames_.end());
+            for (auto p = full_timeline_frames_.begin(); p != end; ++p)
+                frames.push_back(p);
+
+            media_reader::PrecacheHints hints;
+            hints.current_frame = logical_frame_;
+            hints.num_frames    = static_cast<int>(frames.size());
+            hints.loop_in =
+                static_cast<int>(std::distance(full_timeline_frames_.begin(), in_frame_));
+            hints.loop_out =
+                static_cast<int>(std::distance(full_timeline_frames_.begin(), out_frame_));
+            hints.forwards      = playing_forwards_;
+            hints.bookmarks     = bookmark_frames_;
+            hints.recent_frames = recent_frames_;
+
+            // requests are queued by time, so give them increasing times in the
+            // order the scheduler wants them read
+            auto tt = utility::clock::now();
+            for (const auto f :
+                 media_reader::PrecacheScheduler::prioritise(hints, static_cache_max_frames_)) {
+                const auto &frame = frames[f];
+                tt += std::chrono::duration_cast<std::chrono::microseconds>(
+                    (std::next(frame)->first - frame->first) / playback_velocity_);
+                if (frame->second && !frame->second->source_uuid_.is_null())
+                    requests.emplace_back(tt, frame->second);
+            }
+        }
 
         make_prefetch_requests_for_colour_pipeline(requests);
 
@@ -160,7 +160,10 @@ void blocking_loader(
 
 
 PlaylistActor::PlaylistActor(
-    caf::actor_config &cfg, const utility::JsonStore &jsn, const caf::actor &session)
+    caf::actor_config &cfg,
+    const utility::JsonStore &jsn,
+    const caf::actor &session,
+    const bool lazy)
     : caf::event_based_actor(cfg),
       base_(JsonStore(jsn.at("base"))),
       session_(caf::actor_cast<caf::actor_addr>(session)) {
@@ -179,10 +182,25 @@ PlaylistActor::PlaylistActor(
 
     link_to(json_store_);
 
+    if (lazy) {
+        lazy_actors_    = JsonStore(jsn.at("actors"));
+        lazy_playheads_ = jsn.count("playheads") ? JsonStore(jsn.at("playheads"))
+                                                 : JsonStore(nlohmann::json::object());
+    } else
+        deserialise_actors(JsonStore(jsn.at("actors")));
+
+    selection_actor_ = spawn<playhead::PlayheadSelectionActor>(
+        "PlaylistPlayheadSelectionActor", caf::actor_cast<caf::actor>(this));
+    link_to(selection_actor_);
+
+    init();
+}
+
+void PlaylistActor::deserialise_actors(const utility::JsonStore &jsn) {
     // media needs to exist before we can deserialise containers.
     // spdlog::stopwatch sw;
 
-    for (const auto &[key, value] : jsn.at("actors").items()) {
+    for (const auto &[key, value] : jsn.items()) {
         if (value.at("base").at("container").at("type") == "Media") {
             try {
                 auto actor =
@@ -197,7 +215,7 @@ PlaylistActor::PlaylistActor(
     }
     // spdlog::info("media loaded in {:.3} seconds.", sw);
     // deserialise containers
-    for (const auto &[key, value] : jsn.at("actors").items()) {
+    for (const auto &[key, value] : jsn.items()) {
         if (value.at("base").at("container").at("type") == "Subset") {
             try {
                 auto actor = system().spawn<subset::SubsetActor>(
@@ -232,12 +250,6 @@ PlaylistActor::PlaylistActor(
             }
         }
     }
-
-    selection_actor_ = spawn<playhead::PlayheadSelectionActor>(
-        "PlaylistPlayheadSelectionActor", caf::actor_cast<caf::actor>(this));
-    link_to(selection_actor_);
-
-    init();
 }
 
 PlaylistActor::PlaylistActor(
@@ -286,6 +298,126 @@ caf::message_handler PlaylistActor::default_event_handler() {
 }
 
 
+caf::behavior PlaylistActor::make_behavior() {
+    if (lazy_actors_)
+        return lazy_behavior();
+    return behavior_;
+}
+
+caf::behavior PlaylistActor::lazy_behavior() {
+    // anything not handled here needs the media / containers, spawn them and
+    // retry the message against the full behaviour. Events don't force that,
+    // there is nothing below us they can be about, so they're dropped. Only
+    // the latest preference / store update of each kind is kept, to replay
+    // once spawned, so neither builds up in the mailbox while we're lazy.
+    set_default_handler(
+        [](caf::scheduled_actor *self, caf::message &msg) -> caf::skippable_result {
+            auto playlist = static_cast<PlaylistActor *>(self);
+            if (not msg.empty() and msg.match_element<utility::event_atom>(0))
+                return caf::message{};
+            if (not msg.empty() and msg.match_element<json_store::update_atom>(0)) {
+                playlist->lazy_updates_[msg.types()] = msg;
+                return caf::message{};
+            }
+            playlist->materialise();
+            return caf::skip;
+        });
+
+    return {
+        [=](xstudio::broadcast::broadcast_down_atom, const caf::actor_addr &) {},
+        base_.make_set_name_handler(event_group_, this),
+        base_.make_get_name_handler(),
+        base_.make_last_changed_getter(),
+        base_.make_last_changed_setter(event_group_, this),
+        base_.make_last_changed_event_handler(event_group_, this),
+        base_.make_get_uuid_handler(),
+        base_.make_get_type_handler(),
+        base_.make_ignore_error_handler(),
+        make_get_event_group_handler(event_group_),
+        base_.make_get_detail_handler(this, event_group_),
+
+        [=](broadcast::join_broadcast_atom) -> caf::actor { return playlist_broadcast_; },
+
+        [=](get_container_atom) -> PlaylistTree { return base_.containers(); },
+
+        [=](get_container_atom, const bool) -> result<std::vector<UuidActor>> {
+            if (not lazy_has_containers())
+                return std::vector<UuidActor>();
+            auto rp = make_response_promise<std::vector<UuidActor>>();
+            materialise();
+            rp.delegate(caf::actor_cast<caf::actor>(this), get_container_atom_v, true);
+            return rp;
+        },
+
+        // the media list the UI shows for every playlist. Answering it would
+        // spawn the media and have the UI fetch their details and thumbnails,
+        // so it's empty until first use, which then announces the media.
+        [=](get_media_atom, const bool) -> std::vector<ContainerDetail> { return {}; },
+
+        [=](materialise_atom) -> bool {
+            materialise();
+            return true;
+        },
+
+        [=](utility::serialise_atom) -> result<JsonStore> {
+            // nothing below us can have changed, hand back what we were given.
+            auto rp = make_response_promise<JsonStore>();
+            request(json_store_, infinite, json_store::get_json_atom_v, "")
+                .then(
+                    [=](const JsonStore &meta) mutable {
+                        if (not lazy_actors_) {
+                            rp.delegate(
+                                caf::actor_cast<caf::actor>(this), utility::serialise_atom_v);
+                            return;
+                        }
+
+                        JsonStore jsn;
+                        jsn["store"]     = meta;
+                        jsn["base"]      = base_.serialise();
+                        jsn["playheads"] = *lazy_playheads_;
+                        jsn["actors"]    = *lazy_actors_;
+                        rp.deliver(jsn);
+                    },
+                    [=](error &err) mutable { rp.deliver(std::move(err)); });
+            return rp;
+        }};
+}
+
+void PlaylistActor::materialise() {
+    if (not lazy_actors_)
+        return;
+
+    // spdlog::stopwatch sw;
+    auto actors = std::move(*lazy_actors_);
+    lazy_actors_.reset();
+    lazy_playheads_.reset();
+    deserialise_actors(actors);
+    // spdlog::info("playlist {} materialised in {:.3} seconds.", base_.name(), sw);
+
+    set_default_handler(caf::print_and_drop);
+    become(behavior_);
+
+    for (auto &[types, msg] : lazy_updates_)
+        anon_send(caf::actor_cast<caf::actor>(this), std::move(msg));
+    lazy_updates_.clear();
+
+    // we looked empty until now
+    for (const auto &[uuid, actor] : media_)
+        send(event_group_, utility::event_atom_v, add_media_atom_v, UuidActor(uuid, actor));
+    notify_tree(base_.containers());
+
+    if (auto session = caf::actor_cast<caf::actor>(session_))
+        anon_send(session, materialise_atom_v, base_.uuid());
+}
+
+bool PlaylistActor::lazy_has_containers() const {
+    if (lazy_actors_)
+        for (const auto &[key, value] : lazy_actors_->items())
+            if (value.at("base").at("container").at("type") != "Media")
+                return true;
+    return false;
+}
+
 void PlaylistActor::init() {
     print_on_create(this, base_);
     print_on_exit(this, base_);
@@ -1092,6 +1224,8 @@ void PlaylistActor::init() {
 
         [=](get_container_atom) -> PlaylistTree { return base_.containers(); },
 
+        [=](materialise_atom) -> bool { return true; },
+
         // unused..// [=](get_container_atom, const utility::Uuid &uuid) -> result<caf::actor>
         // {// if(container_.count(uuid))// 		return container_[uuid];// 	return
         // make_error(xstudio_error::error, "Invalid uuid");// },
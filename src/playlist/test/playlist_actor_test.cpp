@@ -97,6 +97,38 @@ TEST(PlaylistActorTest, Test) {
         .receive(
             [&](const std::string &name) { EXPECT_EQ(name, "Test2"); },
             [&](const caf::error &err) { EXPECT_TRUE(false) << to_string(err); });
+
+    // lazy, serialises without spawning media, spawns on first use.
+    auto lazy = f.self->spawn<PlaylistActor>(serial, caf::actor(), true);
+
+    f.self->request(lazy, infinite, serialise_atom_v)
+        .receive(
+            [&](const JsonStore &jsn) {
+                EXPECT_EQ(jsn["actors"], serial["actors"]);
+                // the same shape as once it's loaded
+                EXPECT_EQ(jsn.count("playheads"), serial.count("playheads"));
+                EXPECT_EQ(jsn["playheads"], serial["playheads"]);
+            },
+            [&](const caf::error &err) { EXPECT_TRUE(false) << to_string(err); });
+
+    // events are dropped without loading it, nor does the UI's media list
+    f.self->send(lazy, utility::event_atom_v, change_atom_v);
+    f.self->request(lazy, infinite, get_media_atom_v, true)
+        .receive(
+            [&](const std::vector<ContainerDetail> &media) { EXPECT_TRUE(media.empty()); },
+            [&](const caf::error &err) { EXPECT_TRUE(false) << to_string(err); });
+
+    f.self->request(lazy, std::chrono::seconds(10), get_media_atom_v)
+        .receive(
+            [&](const std::vector<UuidActor> &media) { EXPECT_EQ(media.size(), size_t(2)); },
+            [&](const caf::error &err) { EXPECT_TRUE(false) << to_string(err); });
+
+    f.self->request(lazy, infinite, get_media_atom_v, true)
+        .receive(
+            [&](const std::vector<ContainerDetail> &media) {
+                EXPECT_EQ(media.size(), size_t(2));
+            },
+            [&](const caf::error &err) { EXPECT_TRUE(false) << to_string(err); });
 }
 #pragma message "This needs fixing"
 
@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+
+#include "pixel_statistics_hud.hpp"
+#include "xstudio/plugin_manager/plugin_base.hpp"
+#include "xstudio/media_reader/image_buffer.hpp"
+#include "xstudio/media_reader/pixel_statistics.hpp"
+#include "xstudio/global_store/global_store.hpp"
+#include "xstudio/utility/blind_data.hpp"
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+using namespace xstudio;
+using namespace xstudio::ui::viewport;
+
+namespace {
+
+const utility::Uuid plugin_uuid("e266a800-cb18-11f1-ab28-02fc00000001");
+
+// corner of the viewport the graph is drawn in, in normalised device coords
+const float graph_left   = -0.97f;
+const float graph_bottom = -0.95f;
+const float graph_width  = 0.5f;
+const float graph_height = 0.4f;
+
+class HudData : public utility::BlindDataObject {
+  public:
+    HudData(media_reader::PixelStatistics stats, const bool waveform)
+        : stats_(std::move(stats)), waveform_(waveform) {}
+    ~HudData() override = default;
+
+    const media_reader::PixelStatistics stats_;
+    const bool waveform_;
+};
+
+utility::ColourTriplet channel_colour(const std::string &name) {
+    if (name == "R" or name == "r" or name == "red")
+        return utility::ColourTriplet(1.0f, 0.3f, 0.3f);
+    if (name == "G" or name == "g" or name == "green")
+        return utility::ColourTriplet(0.3f, 1.0f, 0.3f);
+    if (name == "B" or name == "b" or name == "blue")
+        return utility::ColourTriplet(0.4f, 0.4f, 1.0f);
+    return utility::ColourTriplet(0.9f, 0.9f, 0.9f);
+}
+
+class PixelStatisticsRenderer : public plugin::ViewportOverlayRenderer {
+
+  public:
+    void render_opengl(
+        const Imath::M44f & /*transform_window_to_viewport_space*/,
+        const Imath::M44f & /*transform_viewport_to_image_space*/,
+        const float /*viewport_du_dpixel*/,
+        const xstudio::media_reader::ImageBufPtr &frame,
+        const bool /*have_alpha_buffer*/) override {
+
+        utility::BlindDataObjectPtr render_data = frame.plugin_blind_data(plugin_uuid);
+        const auto *data = dynamic_cast<const HudData *>(render_data.get());
+        if (not data)
+            return;
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glBlendEquation(GL_FUNC_ADD);
+        glDisable(GL_DEPTH_TEST);
+        glUseProgram(0);
+
+        glColor4f(0.0f, 0.0f, 0.0f, 0.6f);
+        glBegin(GL_QUADS);
+        glVertex2f(graph_left, graph_bottom);
+        glVertex2f(graph_left + graph_width, graph_bottom);
+        glVertex2f(graph_left + graph_width, graph_bottom + graph_height);
+        glVertex2f(graph_left, graph_bottom + graph_height);
+        glEnd();
+
+        if (data->waveform_)
+            render_waveform(data->stats_);
+        else
+            render_histogram(data->stats_);
+    }
+
+  private:
+    void render_histogram(const media_reader::PixelStatistics &stats) {
+        glLineWidth(1.0f);
+        for (const auto &channel : stats.channels()) {
+            const auto &histogram = channel.histogram_;
+            if (histogram.size() < 2)
+                continue;
+
+            const auto peak = *std::max_element(histogram.begin(), histogram.end());
+            if (not peak)
+                continue;
+
+            const auto c = channel_colour(channel.name_);
+            glColor4f(c.r, c.g, c.b, 0.8f);
+            glBegin(GL_LINE_STRIP);
+            for (size_t i = 0; i < histogram.size(); i++) {
+                glVertex2f(
+                    graph_left + graph_width * float(i) / float(histogram.size() - 1),
+                    graph_bottom + graph_height * float(histogram[i]) / float(peak));
+            }
+            glEnd();
+        }
+    }
+
+    void render_waveform(const media_reader::PixelStatistics &stats) {
+        const auto &waveform = stats.waveform();
+        const auto columns   = stats.options().waveform_columns;
+        const auto bins      = stats.options().waveform_bins;
+        if (waveform.empty() or waveform.size() != columns * bins)
+            return;
+
+        const auto peak = *std::max_element(waveform.begin(), waveform.end());
+        if (not peak)
+            return;
+
+        const float du = graph_width / float(columns);
+        const float dv = graph_height / float(bins);
+
+        glBegin(GL_QUADS);
+        for (size_t x = 0; x < columns; x++) {
+            for (size_t y = 0; y < bins; y++) {
+                const auto count = waveform[x * bins + y];
+                if (not count)
+                    continue;
+                // brighten sparse bins so outliers stay visible
+                const float a = std::min(1.0f, 0.2f + 4.0f * float(count) / float(peak));
+                const float u = graph_left + du * float(x);
+                const float v = graph_bottom + dv * float(y);
+                glColor4f(0.5f, 1.0f, 0.5f, a);
+                glVertex2f(u, v);
+                glVertex2f(u + du, v);
+                glVertex2f(u + du, v + dv);
+                glVertex2f(u, v + dv);
+            }
+        }
+        glEnd();
+    }
+};
+} // namespace
+
+PixelStatisticsHUD::PixelStatisticsHUD(
+    caf::actor_config &cfg, const utility::JsonStore &init_settings)
+    : HUDPluginBase(cfg, "Pixel Statistics", init_settings) {
+
+    enabled_->set_preference_path("/plugin/pixel_statistics/enabled");
+    enabled_->set_role_data(module::Attribute::ToolbarPosition, 3.0f);
+
+    mode_ = add_string_choice_attribute(
+        "Display", "Display", "Histogram", {"Histogram", "Waveform"});
+    mode_->set_preference_path("/plugin/pixel_statistics/mode");
+    add_hud_settings_attribute(mode_);
+
+    // only every step'th pixel of every step'th row is read, so the cost
+    // falls with the square of the step
+    step_ = add_integer_attribute("Sample Step", "Step", 8, 1, 32);
+    step_->set_preference_path("/plugin/pixel_statistics/step");
+    add_hud_settings_attribute(step_);
+}
+
+plugin::ViewportOverlayRendererPtr PixelStatisticsHUD::make_overlay_renderer(const int) {
+    return plugin::ViewportOverlayRendererPtr(new PixelStatisticsRenderer());
+}
+
+PixelStatisticsHUD::~PixelStatisticsHUD() = default;
+
+utility::BlindDataObjectPtr PixelStatisticsHUD::prepare_render_data(
+    const media_reader::ImageBufPtr &image, const bool offscreen) const {
+
+    auto r = utility::BlindDataObjectPtr();
+
+    try {
+        if (image && visible() && not offscreen) {
+            const bool waveform = mode_->value() == "Waveform";
+
+            media_reader::PixelStatisticsOptions options;
+            options.histogram_bins = 128;
+            options.step           = static_cast<size_t>(std::max(1, step_->value()));
+            if (waveform) {
+                options.waveform_columns = 128;
+                options.waveform_bins    = 64;
+            }
+
+            r.reset(new HudData(
+                media_reader::PixelStatistics::compute(*image, options), waveform));
+        }
+
+    } catch (std::exception &e) {
+        spdlog::warn("{} {}", __PRETTY_FUNCTION__, e.what());
+    }
+
+    return r;
+}
+
+void PixelStatisticsHUD::attribute_changed(
+    const utility::Uuid &attribute_uuid, const int /*role*/
+) {
+
+    redraw_viewport();
+}
+
+extern "C" {
+plugin_manager::PluginFactoryCollection *plugin_factory_collection_ptr() {
+    return new plugin_manager::PluginFactoryCollection(
+        std::vector<std::shared_ptr<plugin_manager::PluginFactory>>(
+            {std::make_shared<plugin_manager::PluginFactoryTemplate<PixelStatisticsHUD>>(
+                plugin_uuid,
+                "PixelStatisticsHUD",
+                plugin_manager::PluginType::PT_HEAD_UP_DISPLAY,
+                true,
+                "xStudio",
+                "Viewport HUD Plugin")}));
+}
+}
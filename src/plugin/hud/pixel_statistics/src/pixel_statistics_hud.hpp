@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include "xstudio/plugin_manager/plugin_base.hpp"
+#include "xstudio/ui/opengl/shader_program_base.hpp"
+#include "xstudio/ui/viewport/hud_plugin.hpp"
+
+namespace xstudio {
+namespace ui {
+    namespace viewport {
+
+        class PixelStatisticsHUD : public HUDPluginBase {
+          public:
+            PixelStatisticsHUD(caf::actor_config &cfg, const utility::JsonStore &init_settings);
+
+            ~PixelStatisticsHUD();
+
+            void attribute_changed(
+                const utility::Uuid &attribute_uuid, const int /*role*/
+                ) override;
+
+          protected:
+            utility::BlindDataObjectPtr prepare_render_data(
+                const media_reader::ImageBufPtr &, const bool /*offscreen*/) const override;
+
+            plugin::ViewportOverlayRendererPtr make_overlay_renderer(const int) override;
+
+          private:
+            module::StringChoiceAttribute *mode_ = nullptr;
+            module::IntegerAttribute *step_      = nullptr;
+        };
+
+    } // namespace viewport
+} // namespace ui
+} // namespace xstudio
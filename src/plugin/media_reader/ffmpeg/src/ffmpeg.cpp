@@ -401,6 +401,18 @@ FFMpegMediaReader::thumbnail(const media::AVFrameID &mptr, const size_t thumb_si
     }
 }
 
+std::shared_ptr<thumbnail::ThumbnailBuffer> FFMpegMediaReader::filmstrip(
+    const media::AVFrameID &mptr,
+    const size_t count,
+    const size_t thumb_size,
+    const bool rgb24) {
+
+    // a decoder of its own, decoding at a reduced resolution where it can
+    FFMpegDecoder filmstrip_decoder(
+        uri_to_posix_path(mptr.uri_), soundcard_sample_rate_, mptr.stream_id_, thumb_size);
+    return filmstrip_decoder.decode_filmstrip(count, thumb_size, rgb24);
+}
+
 #define ALPHA_UNSET -1e6f
 
 PixelInfo FFMpegMediaReader::ffmpeg_buffer_pixel_picker(
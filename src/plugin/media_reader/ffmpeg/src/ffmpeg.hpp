@@ -29,6 +29,11 @@ namespace media_reader {
         bool can_decode_audio() const override { return true; }
         std::shared_ptr<thumbnail::ThumbnailBuffer>
         thumbnail(const media::AVFrameID &mptr, const size_t thumb_size) override;
+        std::shared_ptr<thumbnail::ThumbnailBuffer> filmstrip(
+            const media::AVFrameID &mptr,
+            const size_t count,
+            const size_t thumb_size,
+            const bool rgb24) override;
 
         [[nodiscard]] utility::Uuid plugin_uuid() const override;
 
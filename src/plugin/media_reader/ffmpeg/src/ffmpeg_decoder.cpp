@@ -1,4 +1,5 @@
 // SPDX-License-Identifier: Apache-2.0
+#include <cstring>
 #include <iostream>
 
 
@@ -21,14 +22,18 @@ std::string make_stream_id(const int stream_index) {
 int FFMpegDecoder::ffmpeg_threads = 8;
 
 FFMpegDecoder::FFMpegDecoder(
-    std::string path, const int soundcard_sample_rate, std::string stream_id)
+    std::string path,
+    const int soundcard_sample_rate,
+    std::string stream_id,
+    const size_t thumbnail_size)
     : movie_file_path_(std::move(path)),
       last_requested_frame_(-100),
       avc_packet_(nullptr),
       av_format_ctx_(nullptr),
       soundcard_sample_rate_(soundcard_sample_rate),
       last_decoded_frame_(-100),
-      stream_id_(std::move(stream_id))
+      stream_id_(std::move(stream_id)),
+      thumbnail_size_(thumbnail_size)
 
 {
     open_handles();
@@ -59,7 +64,8 @@ void FFMpegDecoder::open_handles() {
                 av_format_ctx_->streams[i],
                 i,
                 ffmpeg_threads,
-                movie_file_path_);
+                movie_file_path_,
+                thumbnail_size_);
 
         } catch (std::exception &e) {
         }
@@ -276,6 +282,7 @@ int64_t FFMpegDecoder::decode_next_frame() {
                 AVC_CHECK_THROW(rx, "avcodec_send_packet");
             return decode_stream_->receive_frame();
         }
+        av_packet_unref(avc_packet_);
 
     } else {
 
@@ -547,6 +554,125 @@ FFMpegDecoder::decode_thumbnail_frame(const int64_t frame_num, const size_t size
     return rt;
 }
 
+std::shared_ptr<thumbnail::ThumbnailBuffer> FFMpegDecoder::decode_filmstrip(
+    const size_t count, const size_t size_hint, const bool rgb24) {
+
+    std::shared_ptr<thumbnail::ThumbnailBuffer> rt;
+    if (!decode_stream_ || !count)
+        return rt;
+
+    // Only keyframes are decoded. The targets are visited in order, reading
+    // on through the file while the next one is close and seeking forward
+    // when it's further than a seek is worth, so the file is read in one
+    // pass. 'current' is the last keyframe at or before the target and
+    // 'ahead' the first keyframe decoded after it.
+    using Keyframe = std::pair<int64_t, std::shared_ptr<thumbnail::ThumbnailBuffer>>;
+    Keyframe current(-1, nullptr);
+    Keyframe ahead(-1, nullptr);
+    bool at_end = false;
+
+    const int64_t duration = std::max(int64_t(1), duration_frames_);
+    std::vector<Keyframe> picked(count);
+
+    auto decode_keyframe = [&]() -> Keyframe {
+        while (true) {
+            const auto result = decode_next_frame();
+            if (decode_stream_->have_frame()) {
+                decode_stream_->set_current_frame_unknown();
+                return Keyframe(
+                    decode_stream_->current_frame(),
+                    decode_stream_->convert_av_frame_to_thumbnail(size_hint, rgb24));
+            }
+            if (result == AVERROR_EOF)
+                return Keyframe(-1, nullptr);
+        }
+    };
+
+    try {
+        decode_stream_->set_keyframes_only(true);
+
+        for (size_t i = 0; i < count; ++i) {
+            const int64_t target =
+                std::min(duration - 1, (int64_t(i) * 2 + 1) * duration / (int64_t(count) * 2));
+
+            if (ahead.second && ahead.first <= target) {
+                current = ahead;
+                ahead   = Keyframe(-1, nullptr);
+            }
+
+            bool sought = false;
+            while (!ahead.second && !at_end) {
+                if (!sought && !decode_stream_->is_single_frame() &&
+                    (!current.second ||
+                     target - current.first > MIN_SEEK_FORWARD_FRAMES * 4)) {
+                    do_seek(int(target), true);
+                    sought = true;
+                }
+
+                auto keyframe = decode_keyframe();
+                if (!keyframe.second)
+                    at_end = true;
+                else if (keyframe.first <= target || !current.second)
+                    current = keyframe;
+                else
+                    ahead = keyframe;
+
+                if (decode_stream_->is_single_frame())
+                    at_end = true;
+                // a seek lands on the keyframe at or before the target
+                if (sought && current.second && current.first <= target)
+                    break;
+            }
+
+            picked[i] = current.second ? current : ahead;
+        }
+
+        decode_stream_->set_keyframes_only(false);
+
+    } catch (std::exception &e) {
+
+        decode_stream_->set_keyframes_only(false);
+        // some error has occurred ... force a fresh seek on next try
+        last_requested_frame_ = -100;
+        throw;
+    }
+
+    // lay the thumbnails out left to right
+    std::shared_ptr<thumbnail::ThumbnailBuffer> first;
+    for (const auto &p : picked) {
+        if (p.second) {
+            first = p.second;
+            break;
+        }
+    }
+    if (!first)
+        return rt;
+
+    const size_t width      = first->width();
+    const size_t height     = first->height();
+    const size_t line_bytes = first->size() / height;
+
+    rt = std::make_shared<thumbnail::ThumbnailBuffer>(width * count, height, first->format());
+
+    nlohmann::json frames = nlohmann::json::array();
+    for (size_t i = 0; i < count; ++i) {
+        const auto &thumb = picked[i].second ? picked[i].second : first;
+        frames.push_back(picked[i].second ? picked[i].first : -1);
+        if (thumb->width() != width || thumb->height() != height)
+            continue;
+        for (size_t y = 0; y < height; ++y)
+            std::memcpy(
+                rt->data().data() + (y * count + i) * line_bytes,
+                thumb->data().data() + y * line_bytes,
+                line_bytes);
+    }
+
+    rt->metadata()["filmstrip"] = {
+        {"count", count}, {"width", width}, {"height", height}, {"frames", frames}};
+
+    return rt;
+}
+
 bool FFMpegDecoder::have_video(const int frame_num) const {
     auto p = video_frame_mini_cache_.find(frame_num);
     if (p != video_frame_mini_cache_.end()) {
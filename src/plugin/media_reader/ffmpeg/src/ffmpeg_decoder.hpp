@@ -11,8 +11,13 @@ namespace media_reader {
 
         class FFMpegDecoder {
           public:
+            // thumbnail_size is for decoders only used for thumbnails, video is
+            // decoded at a reduced resolution if the codec can.
             FFMpegDecoder(
-                std::string path, const int soundcard_sample_rate, std::string stream_id = "");
+                std::string path,
+                const int soundcard_sample_rate,
+                std::string stream_id       = "",
+                const size_t thumbnail_size = 0);
 
             ~FFMpegDecoder();
 
@@ -29,6 +34,11 @@ namespace media_reader {
             std::shared_ptr<thumbnail::ThumbnailBuffer>
             decode_thumbnail_frame(const int64_t frame_num, const size_t size_hint);
 
+            // count evenly spaced thumbnails side by side in one buffer, each
+            // from the keyframe at or before its frame
+            std::shared_ptr<thumbnail::ThumbnailBuffer> decode_filmstrip(
+                const size_t count, const size_t size_hint, const bool rgb24 = false);
+
             const std::string &path() const { return movie_file_path_; }
             int64_t duration_frames() const { return duration_frames_; }
             utility::FrameRate frame_rate(unsigned int stream_idx = UINT_MAX) const;
@@ -79,6 +89,7 @@ namespace media_reader {
             const int soundcard_sample_rate_;
             int64_t duration_frames_;
             const std::string stream_id_;
+            const size_t thumbnail_size_;
         };
     } // namespace ffmpeg
 } // namespace media_reader
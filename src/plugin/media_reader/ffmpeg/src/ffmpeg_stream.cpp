@@ -1,4 +1,5 @@
 // SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <sstream>
@@ -181,6 +182,67 @@ void set_shader_pix_format_info(
 }
 
 
+// describe the planes of a decoded frame so the pixels can be used outside
+// of the GPU shader (python export, pixel statistics etc.)
+PixelLayout pixel_layout_for_frame(
+    const xstudio::utility::JsonStore &jsn,
+    AVPixelFormat pix_fmt,
+    const int width,
+    const int height) {
+
+    PixelLayout layout;
+    const AVPixFmtDescriptor *pixel_desc = av_pix_fmt_desc_get(pix_fmt);
+    if (!pixel_desc)
+        return layout;
+
+    static const std::array<std::string, 4> plane_keys = {"y", "u", "v", "a"};
+    const bool is_rgb = pixel_desc->flags & AV_PIX_FMT_FLAG_RGB;
+    const std::array<std::string, 4> plane_names =
+        is_rgb ? std::array<std::string, 4>{"g", "b", "r", "a"} : plane_keys;
+
+    const PixelDataType data_type = pixel_desc->comp[0].depth > 8 ? PDT_UINT16 : PDT_UINT8;
+
+    if (!(pixel_desc->flags & AV_PIX_FMT_FLAG_PLANAR)) {
+        // packed format, everything is interleaved in the first plane
+        layout.emplace_back(
+            is_rgb ? "rgb" : "yuv",
+            data_type,
+            width,
+            height,
+            pixel_desc->nb_components,
+            jsn.value("y_plane_bytes_offset", size_t(0)),
+            pixel_desc->comp[0].step,
+            jsn.value("y_linesize", size_t(0)));
+        return layout;
+    }
+
+    for (int plane = 0; plane < 4; ++plane) {
+        int channels = 0;
+        int step     = 0;
+        for (int c = 0; c < pixel_desc->nb_components; ++c) {
+            if (pixel_desc->comp[c].plane == plane) {
+                channels++;
+                step = pixel_desc->comp[c].step;
+            }
+        }
+        const auto linesize = jsn.value(plane_keys[plane] + "_linesize", size_t(0));
+        if (!channels || !linesize)
+            continue;
+
+        const bool chroma = !is_rgb && (plane == 1 || plane == 2);
+        layout.emplace_back(
+            plane_names[plane],
+            data_type,
+            chroma ? AV_CEIL_RSHIFT(width, pixel_desc->log2_chroma_w) : width,
+            chroma ? AV_CEIL_RSHIFT(height, pixel_desc->log2_chroma_h) : height,
+            channels,
+            jsn.value(plane_keys[plane] + "_plane_bytes_offset", size_t(0)),
+            step,
+            linesize);
+    }
+    return layout;
+}
+
 #define STRIDE_ALIGN 64
 /*
  * The following function replaces avcodec_default_get_buffer2 and update_frame_pool
@@ -390,6 +452,8 @@ ImageBufPtr FFMpegStream::get_ffmpeg_frame_as_xstudio_image() {
         frame->colorspace);
 
     image_buffer->set_shader_params(jsn);
+    image_buffer->set_pixel_layout(pixel_layout_for_frame(
+        jsn, (AVPixelFormat)ffmpeg_pixel_format, frame->width, frame->height));
 
     image_buffer->set_display_timestamp_seconds(
         double(frame->pts) * double(avc_stream_->time_base.num) /
@@ -430,11 +494,12 @@ ImageBufPtr FFMpegStream::get_ffmpeg_frame_as_xstudio_image() {
 }
 
 std::shared_ptr<thumbnail::ThumbnailBuffer>
-FFMpegStream::convert_av_frame_to_thumbnail(const size_t size_hint) {
+FFMpegStream::convert_av_frame_to_thumbnail(const size_t size_hint, const bool rgb24) {
 
     // to make the thumbnail image we use sws api to rescale the image into an unsigned 16 bit
     // int RGB buffer, which we convert to floating point. xstudio then uses the colour pipeline
-    // to process the image into a display space as appropriate
+    // to process the image into a display space as appropriate. With rgb24 sws writes 8 bit
+    // RGB straight into the thumbnail, for sources that need no colour processing.
 
     if (!frame->height || !frame->width)
         return std::shared_ptr<thumbnail::ThumbnailBuffer>();
@@ -456,11 +521,12 @@ FFMpegStream::convert_av_frame_to_thumbnail(const size_t size_hint) {
         frame->height > frame->width ? size_hint : (size_hint * frame->height) / frame->width;
 
     auto thumb = std::make_shared<thumbnail::ThumbnailBuffer>(
-        thumb_width, thumb_height, thumbnail::TF_RGBF96);
+        thumb_width, thumb_height, rgb24 ? thumbnail::TF_RGB24 : thumbnail::TF_RGBF96);
 
-    std::vector<uint8_t> t_data(thumb_width * thumb_height * 3 * 2);
+    std::vector<uint8_t> t_data(rgb24 ? 0 : thumb_width * thumb_height * 3 * 2);
 
-    auto d      = reinterpret_cast<uint8_t *>(t_data.data());
+    auto d      = rgb24 ? reinterpret_cast<uint8_t *>(thumb->data().data())
+                        : reinterpret_cast<uint8_t *>(t_data.data());
     auto buffer = static_cast<uint8_t *const *>(&d);
 
     sws_context_ = sws_getCachedContext(
@@ -470,13 +536,13 @@ FFMpegStream::convert_av_frame_to_thumbnail(const size_t size_hint) {
         (AVPixelFormat)ffmpeg_pixel_format,
         thumb_width,
         thumb_height,
-        AV_PIX_FMT_RGB48, // 16 bits per channel
+        rgb24 ? AV_PIX_FMT_RGB24 : AV_PIX_FMT_RGB48, // 8 or 16 bits per channel
         0,
         nullptr,
         nullptr,
         nullptr);
 
-    const std::array<int, 1> out_linesize({3 * 2 * thumb_width});
+    const std::array<int, 1> out_linesize({3 * (rgb24 ? 1 : 2) * thumb_width});
 
     sws_scale(
         sws_context_,
@@ -487,6 +553,9 @@ FFMpegStream::convert_av_frame_to_thumbnail(const size_t size_hint) {
         buffer,
         out_linesize.data());
 
+    if (rgb24)
+        return thumb;
+
     // now convert from 16 bit to float:
     auto s = reinterpret_cast<uint16_t *>(t_data.data());
     auto f = reinterpret_cast<float *>(thumb->data().data());
@@ -501,16 +570,18 @@ FFMpegStream::convert_av_frame_to_thumbnail(const size_t size_hint) {
 
 AudioBufPtr FFMpegStream::get_ffmpeg_frame_as_xstudio_audio(const int soundcard_sample_rate) {
 
+    // keep the source channels (up to 7.1), mixing down to the soundcard layout
+    // happens at playback
     AudioBufPtr audio_buffer(new AudioBuffer());
     audio_buffer->allocate(
-        soundcard_sample_rate,     // sample rate
-        2,                         // num channels
-        0,                         // num samples ... don't know yet
-        audio::SampleFormat::INT16 // format
+        soundcard_sample_rate,             // sample rate
+        std::clamp(frame->channels, 1, 8), // num channels
+        0,                                 // num samples ... don't know yet
+        audio::SampleFormat::FLOAT32       // format
     );
 
-    // N.B. We aren't supporting 'planar' audio data in xstudio (yet) - if a source codec_
-    // supplies planar audio ffmpeg will convert to interleaved which is what soundcards want
+    // N.B. if a source codec_ supplies planar audio ffmpeg will convert to
+    // interleaved, the audio output converts to its own planar layout
     switch (audio_buffer->sample_format()) {
     case audio::SampleFormat::UINT8:
         target_sample_format_ = AV_SAMPLE_FMT_U8;
@@ -548,7 +619,12 @@ AudioBufPtr FFMpegStream::get_ffmpeg_frame_as_xstudio_audio(const int soundcard_
 static int asd = 0;
 
 FFMpegStream::FFMpegStream(
-    AVFormatContext *fmt_ctx, AVStream *stream, int index, int thread_count, std::string path)
+    AVFormatContext *fmt_ctx,
+    AVStream *stream,
+    int index,
+    int thread_count,
+    std::string path,
+    const size_t thumbnail_size)
     : stream_index_(index),
       codec_context_(nullptr),
       format_context_(fmt_ctx),
@@ -594,6 +670,17 @@ FFMpegStream::FFMpegStream(
         AVC_CHECK_THROW(
             avcodec_parameters_to_context(codec_context_, avc_stream_->codecpar),
             "avcodec_parameters_to_context");
+
+        if (thumbnail_size) {
+            // each lowres step halves the decoded width and height
+            const int size =
+                std::max(avc_stream_->codecpar->width, avc_stream_->codecpar->height);
+            int lowres = 0;
+            while (lowres < codec_->max_lowres && (size >> (lowres + 1)) >= int(thumbnail_size))
+                lowres++;
+            codec_context_->lowres = lowres;
+        }
+
         AVC_CHECK_THROW(avcodec_open2(codec_context_, codec_, nullptr), "avcodec_open2");
 
         frame->width  = avc_stream_->codecpar->width;
@@ -683,7 +770,7 @@ size_t FFMpegStream::resample_audio(
     AVFrame *frame, AudioBufPtr &audio_buffer, int offset_into_output_buffer) {
 
     // N.B. this method is based loosely on the audio resampling in ffplay.c in ffmpeg source
-    const int64_t target_channel_layout = av_get_default_channel_layout(2);
+    const int64_t target_channel_layout = av_get_default_channel_layout(target_audio_channels_);
 
     av_samples_get_buffer_size(
         nullptr, frame->channels, frame->nb_samples, (AVSampleFormat)frame->format, 1);
@@ -698,7 +785,8 @@ size_t FFMpegStream::resample_audio(
 
     if (!audio_resampler_ctx_ || frame->format != src_audio_fmt_ ||
         frame->sample_rate != src_audio_sample_rate_ ||
-        dec_channel_layout != src_audio_channel_layout_) {
+        dec_channel_layout != src_audio_channel_layout_ ||
+        target_channel_layout != dst_audio_channel_layout_) {
 
         swr_free(&audio_resampler_ctx_);
         audio_resampler_ctx_ = swr_alloc_set_opts(
@@ -735,6 +823,7 @@ size_t FFMpegStream::resample_audio(
         src_audio_fmt_            = (AVSampleFormat)frame->format;
         src_audio_sample_rate_    = frame->sample_rate;
         src_audio_channel_layout_ = dec_channel_layout;
+        dst_audio_channel_layout_ = target_channel_layout;
     }
 
     const auto in       = (const uint8_t **)frame->extended_data;
@@ -751,7 +840,8 @@ size_t FFMpegStream::resample_audio(
         // automatically extend the buffer the exact required amount
         // size_t sz = audio_buffer->size();
         audio_buffer->extend_size(target_out_size);
-        out = (uint8_t *)(audio_buffer->buffer() + audio_buffer->num_samples() * 2 * 2);
+        out = (uint8_t *)(audio_buffer->buffer() +
+                          audio_buffer->num_samples() * audio_buffer->frame_size());
 
     } else {
 
@@ -787,7 +877,8 @@ int64_t FFMpegStream::receive_frame() {
 
     av_frame_unref(frame);
 
-    int rt = avcodec_receive_frame(codec_context_, frame);
+    int rt      = avcodec_receive_frame(codec_context_, frame);
+    have_frame_ = rt == 0;
 
     // we have decoded a frame, increment the frame counter
     // if our frame counter is set.
@@ -817,6 +908,10 @@ int FFMpegStream::send_packet(AVPacket *avc_packet_) {
 
 void FFMpegStream::flush_buffers() { avcodec_flush_buffers(codec_context_); }
 
+void FFMpegStream::set_keyframes_only(const bool keyframes_only) {
+    codec_context_->skip_frame = keyframes_only ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT;
+}
+
 double FFMpegStream::duration_seconds() const {
 
     if (avc_stream_->time_base.num &&
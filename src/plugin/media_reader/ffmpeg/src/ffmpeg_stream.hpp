@@ -63,12 +63,15 @@ namespace media_reader {
         class FFMpegStream {
 
           public:
+            // A non zero thumbnail_size lets codecs that support it decode
+            // video at a reduced resolution that's still at least that size.
             FFMpegStream(
                 AVFormatContext *fmt_ctx,
                 AVStream *stream,
                 int index,
                 int thread_count,
-                std::string path);
+                std::string path,
+                const size_t thumbnail_size = 0);
 
             virtual ~FFMpegStream();
 
@@ -84,10 +87,16 @@ namespace media_reader {
             AudioBufPtr get_ffmpeg_frame_as_xstudio_audio(const int soundcard_sample_rate);
 
             std::shared_ptr<thumbnail::ThumbnailBuffer>
-            convert_av_frame_to_thumbnail(const size_t size_hint);
+            convert_av_frame_to_thumbnail(const size_t size_hint, const bool rgb24 = false);
 
             int64_t receive_frame();
 
+            // whether the last receive_frame() produced a frame
+            [[nodiscard]] bool have_frame() const { return have_frame_; }
+
+            // have the codec drop everything but keyframes
+            void set_keyframes_only(const bool keyframes_only);
+
             void send_flush_packet();
 
             int send_packet(AVPacket *avc_packet_);
@@ -147,6 +156,7 @@ namespace media_reader {
             bool format_conversion_warning_issued = {false};
             bool using_own_frame_allocation       = {false};
             bool nothing_decoded_yet_             = {true};
+            bool have_frame_                      = {false};
             int current_frame_                    = {CURRENT_FRAME_UNKNOWN};
 
             // for video rescaling
@@ -159,6 +169,7 @@ namespace media_reader {
             AVSampleFormat src_audio_fmt_        = {AV_SAMPLE_FMT_NONE};
             int src_audio_sample_rate_           = {0};
             int src_audio_channel_layout_        = {0};
+            int64_t dst_audio_channel_layout_    = {0};
             SwrContext *audio_resampler_ctx_     = {0};
 
             utility::FrameRate frame_rate_;
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Thumbnail throughput on a generated sequence of multi-layer EXRs, scanline
+// and mipmapped. The thumbnail path against decoding the whole frame and
+// sampling that, as thumbnails without an embedded preview used to be made.
+//
+// openexr_thumbnail_benchmark [frames] [width] [height] [thumbnail_size]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <unistd.h>
+
+#include <ImfChannelList.h>
+#include <ImfOutputFile.h>
+#include <ImfTiledOutputFile.h>
+
+#include "openexr.hpp"
+#include "simple_exr_sampler.hpp"
+#include "xstudio/media/media.hpp"
+#include "xstudio/utility/helpers.hpp"
+
+using namespace xstudio;
+using namespace xstudio::utility;
+using namespace xstudio::media_reader;
+
+namespace {
+
+// RGBA and two more layers, red on the left half and green on the right
+void write_exr(const std::string &path, const int width, const int height, const bool tiled) {
+    const std::vector<std::string> channels = {
+        "R",
+        "G",
+        "B",
+        "A",
+        "diffuse.R",
+        "diffuse.G",
+        "diffuse.B",
+        "specular.R",
+        "specular.G",
+        "specular.B"};
+
+    Imf::Header header(width, height);
+    header.compression() = tiled ? Imf::ZIP_COMPRESSION : Imf::ZIPS_COMPRESSION;
+    for (const auto &channel : channels)
+        header.channels().insert(channel, Imf::Channel(Imf::HALF));
+
+    std::vector<half> pixels;
+    auto frame_buffer = [&](const int w, const int h) {
+        pixels.resize(size_t(w) * h * channels.size());
+        auto p = pixels.begin();
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                *(p++) = x < w / 2 ? 1.0f : 0.0f;
+                *(p++) = x < w / 2 ? 0.0f : 1.0f;
+                *(p++) = float(y) / float(h);
+                for (size_t c = 3; c < channels.size(); ++c)
+                    *(p++) = 1.0f;
+            }
+        }
+
+        Imf::FrameBuffer fb;
+        const size_t pixel_stride = sizeof(half) * channels.size();
+        for (size_t c = 0; c < channels.size(); ++c)
+            fb.insert(
+                channels[c],
+                Imf::Slice(
+                    Imf::HALF, (char *)(pixels.data() + c), pixel_stride, pixel_stride * w));
+        return fb;
+    };
+
+    if (tiled) {
+        header.setTileDescription(Imf::TileDescription(64, 64, Imf::MIPMAP_LEVELS));
+        Imf::TiledOutputFile out(path.c_str(), header);
+        for (int l = 0; l < out.numLevels(); ++l) {
+            out.setFrameBuffer(frame_buffer(out.levelWidth(l), out.levelHeight(l)));
+            out.writeTiles(0, out.numXTiles(l) - 1, 0, out.numYTiles(l) - 1, l);
+        }
+    } else {
+        Imf::OutputFile out(path.c_str(), header);
+        out.setFrameBuffer(frame_buffer(width, height));
+        out.writePixels(height);
+    }
+}
+
+double ms_per_frame(const std::chrono::steady_clock::duration elapsed, const int frames) {
+    return std::chrono::duration<double, std::milli>(elapsed).count() / double(frames);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const int frames = argc > 1 ? std::atoi(argv[1]) : 24;
+    const int width  = argc > 2 ? std::atoi(argv[2]) : 4096;
+    const int height = argc > 3 ? std::atoi(argv[3]) : 2160;
+    const int size   = argc > 4 ? std::atoi(argv[4]) : 256;
+
+    const auto dir = std::filesystem::temp_directory_path() /
+                     ("xstudio_openexr_thumbnail_benchmark_" + std::to_string(getpid()));
+    std::filesystem::create_directories(dir);
+
+    std::printf("%d frames of %dx%d to %dpx thumbnails\n", frames, width, height, size);
+
+    OpenEXRMediaReader reader;
+    for (const auto tiled : {false, true}) {
+        std::vector<caf::uri> sequence;
+        for (int i = 0; i < frames; ++i) {
+            const auto path =
+                dir / ((tiled ? "tiled." : "scanline.") + std::to_string(1001 + i) + ".exr");
+            write_exr(path.string(), width, height, tiled);
+            sequence.push_back(posix_path_to_uri(path.string()));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (const auto &uri : sequence)
+            reader.thumbnail(media::AVFrameID(uri), size);
+        const auto thumbnails = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        for (const auto &uri : sequence) {
+            auto image = reader.image(media::AVFrameID(uri));
+            auto thumb = std::make_shared<thumbnail::ThumbnailBuffer>(
+                size, size * height / width, thumbnail::TF_RGBF96);
+            SimpleExrSampler(image, thumb).fill_output();
+        }
+        const auto full = std::chrono::steady_clock::now() - start;
+
+        std::printf(
+            "  %s: thumbnail %.2fms per frame, full decode %.2fms per frame\n",
+            tiled ? "tiled, mipmapped" : "scanline",
+            ms_per_frame(thumbnails, frames),
+            ms_per_frame(full, frames));
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
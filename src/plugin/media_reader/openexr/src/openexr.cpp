@@ -2,6 +2,8 @@
 #include <filesystem>
 #include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <functional>
 
 #include <Iex.h>
 #include <IexErrnoExc.h>
@@ -12,13 +14,20 @@
 #include <ImfMultiPartInputFile.h>
 #include <ImfMultiView.h>
 #include <ImfPreviewImage.h>
+#include <ImfCompressor.h>
+#include <ImfTiledInputPart.h>
+#include <ImfDoubleAttribute.h>
+#include <ImfFloatAttribute.h>
 #include <ImfRationalAttribute.h>
 #include <ImfRgbaFile.h>
+#include <ImfStringAttribute.h>
 #include <ImfTimeCodeAttribute.h>
 #include <ImfIntAttribute.h>
+#include <ImfIO.h>
 #include <ImfVecAttribute.h>
 
 #include "xstudio/media/media_error.hpp"
+#include "xstudio/media_reader/file_prefetcher.hpp"
 #include "xstudio/media_reader/media_reader.hpp"
 #include "xstudio/utility/helpers.hpp"
 #include "xstudio/utility/logging.hpp"
@@ -201,6 +210,170 @@ plugin_manager::PluginFactoryCollection *plugin_factory_collection_ptr() {
 
 static ui::viewport::GPUShaderPtr
     openexr_shader(new ui::opengl::OpenGLShader(openexr_shader_uuid, shader));
+
+// An EXR file that FilePrefetcher has already read into memory. It says it's
+// memory mapped so the library reads chunks straight out of the buffer
+// rather than copying them.
+class PrefetchedIStream : public Imf::IStream {
+  public:
+    PrefetchedIStream(const std::string &path, FilePrefetcher::File file)
+        : Imf::IStream(path.c_str()), file_(std::move(file)) {}
+
+    bool isMemoryMapped() const override { return true; }
+
+    bool read(char c[], int n) override {
+        std::memcpy(c, readMemoryMapped(n), n);
+        return pos_ < file_.size;
+    }
+
+    char *readMemoryMapped(int n) override {
+        if (n < 0 or pos_ + n > file_.size)
+            throw Iex::InputExc(std::string("Unexpected end of file ") + fileName());
+        auto *result =
+            reinterpret_cast<char *>(const_cast<std::byte *>(file_.data.get())) + pos_;
+        pos_ += n;
+        return result;
+    }
+
+    uint64_t tellg() override { return pos_; }
+    void seekg(uint64_t pos) override { pos_ = pos; }
+
+  private:
+    FilePrefetcher::File file_;
+    uint64_t pos_ = {0};
+};
+
+/* Nearest neighbour sampling of the display window into a thumbnail.
+
+window is the data window of the image being read, which is smaller than
+data_window for a mip level. read_rows is asked for whole blocks of
+block_height rows (a scanline block or a row of tiles), and only for the
+blocks that hold a sampled row, into a buffer of float RGB or luminance
+pixels for the given channels. */
+void sample_rows(
+    thumbnail::ThumbnailBuffer &thumb,
+    const Imath::Box2i &display_window,
+    const Imath::Box2i &data_window,
+    const Imath::Box2i &window,
+    const int block_height,
+    const std::vector<std::string> &channels,
+    const std::function<void(Imf::FrameBuffer &, const int, const int)> &read_rows) {
+
+    const int thumb_width     = int(thumb.width());
+    const int thumb_height    = int(thumb.height());
+    const int display_width   = display_window.size().x + 1;
+    const int display_height  = display_window.size().y + 1;
+    const int data_width      = data_window.size().x + 1;
+    const int data_height     = data_window.size().y + 1;
+    const int width           = window.size().x + 1;
+    const int height          = window.size().y + 1;
+    const size_t num_channels = channels.size();
+    const size_t pixel_stride = num_channels * sizeof(float);
+    const size_t line_stride  = width * pixel_stride;
+
+    // the column in window of each thumbnail column, -1 outside the data window
+    std::vector<int> columns(thumb_width);
+    for (int tx = 0; tx < thumb_width; ++tx) {
+        const int x = display_window.min.x +
+                      int((int64_t(tx) * 2 + 1) * display_width / (int64_t(thumb_width) * 2));
+        columns[tx] = x < data_window.min.x || x > data_window.max.x
+                          ? -1
+                          : int(int64_t(x - data_window.min.x) * width / data_width);
+    }
+
+    std::vector<float> rows(size_t(block_height) * width * num_channels);
+    int block_y0 = 0;
+    int block    = -1;
+
+    auto out = reinterpret_cast<float *>(thumb.data().data());
+
+    for (int ty = 0; ty < thumb_height; ++ty) {
+        const int y = display_window.min.y +
+                      int((int64_t(ty) * 2 + 1) * display_height / (int64_t(thumb_height) * 2));
+
+        if (y < data_window.min.y || y > data_window.max.y) {
+            std::fill(out, out + thumb_width * 3, 0.0f);
+            out += thumb_width * 3;
+            continue;
+        }
+
+        const int row = int(int64_t(y - data_window.min.y) * height / data_height);
+        if (row / block_height != block) {
+            block    = row / block_height;
+            block_y0 = window.min.y + block * block_height;
+
+            char *base = reinterpret_cast<char *>(rows.data()) -
+                         std::ptrdiff_t(window.min.x) * std::ptrdiff_t(pixel_stride) -
+                         std::ptrdiff_t(block_y0) * std::ptrdiff_t(line_stride);
+            Imf::FrameBuffer fb;
+            for (const auto &channel : channels) {
+                fb.insert(
+                    channel.c_str(),
+                    Imf::Slice(Imf::FLOAT, base, pixel_stride, line_stride, 1, 1, 0.0));
+                base += sizeof(float);
+            }
+            read_rows(fb, block_y0, std::min(block_y0 + block_height - 1, window.max.y));
+        }
+
+        const float *line =
+            rows.data() + size_t(window.min.y + row - block_y0) * width * num_channels;
+        for (int tx = 0; tx < thumb_width; ++tx, out += 3) {
+            if (columns[tx] == -1) {
+                out[0] = out[1] = out[2] = 0.0f;
+            } else {
+                const float *pix = line + columns[tx] * num_channels;
+                out[0]           = pix[0];
+                out[1]           = pix[num_channels == 3 ? 1 : 0];
+                out[2]           = pix[num_channels == 3 ? 2 : 0];
+            }
+        }
+    }
+}
+
+// The same gamma encoded 8 bit RGB an embedded EXR preview holds
+thumbnail::ThumbnailBufferPtr to_preview(thumbnail::ThumbnailBuffer &thumb) {
+    auto preview = std::make_shared<thumbnail::ThumbnailBuffer>(
+        thumb.width(), thumb.height(), thumbnail::TF_RGB24);
+
+    const auto *in = reinterpret_cast<const float *>(thumb.data().data());
+    auto *out      = reinterpret_cast<uint8_t *>(preview->data().data());
+    size_t sz      = thumb.width() * thumb.height() * 3;
+    while (sz--) {
+        const float v = std::pow(std::max(*(in++), 0.0f), 1.0f / 2.2f);
+        *(out++)      = uint8_t(std::round(std::min(v * 255.0f, 255.0f)));
+    }
+    return preview;
+}
+
+// The header attributes that are plain values, for the source to keep per
+// frame. Anything else is left to the metadata plugin.
+nlohmann::json header_attributes(const Imf::Header &header) {
+    auto result = nlohmann::json::object();
+    for (auto it = header.begin(); it != header.end(); ++it) {
+        const Imf::Attribute *attr = &it.attribute();
+        if (auto a = dynamic_cast<const Imf::IntAttribute *>(attr)) {
+            result[it.name()] = a->value();
+        } else if (auto a = dynamic_cast<const Imf::FloatAttribute *>(attr)) {
+            result[it.name()] = a->value();
+        } else if (auto a = dynamic_cast<const Imf::DoubleAttribute *>(attr)) {
+            result[it.name()] = a->value();
+        } else if (auto a = dynamic_cast<const Imf::StringAttribute *>(attr)) {
+            result[it.name()] = a->value();
+        } else if (auto a = dynamic_cast<const Imf::RationalAttribute *>(attr)) {
+            result[it.name()] = double(a->value());
+        } else if (auto a = dynamic_cast<const Imf::TimeCodeAttribute *>(attr)) {
+            const auto &tc    = a->value();
+            result[it.name()] = fmt::format(
+                "{:02}:{:02}:{:02}:{:02}", tc.hours(), tc.minutes(), tc.seconds(), tc.frame());
+        } else if (auto a = dynamic_cast<const Imf::V2iAttribute *>(attr)) {
+            result[it.name()] = {a->value().x, a->value().y};
+        } else if (auto a = dynamic_cast<const Imf::V2fAttribute *>(attr)) {
+            result[it.name()] = {a->value().x, a->value().y};
+        }
+    }
+    return result;
+}
+
 } // namespace
 
 OpenEXRMediaReader::OpenEXRMediaReader(const utility::JsonStore &prefs)
@@ -208,6 +381,8 @@ OpenEXRMediaReader::OpenEXRMediaReader(const utility::JsonStore &prefs)
     Imf::setGlobalThreadCount(16);
     max_exr_overscan_percent_ = 5.0f;
     readers_per_source_       = 1;
+    preview_thumbnails_       = false;
+    frame_metadata_           = true;
 
     update_preferences(prefs);
 }
@@ -227,16 +402,47 @@ void OpenEXRMediaReader::update_preferences(const utility::JsonStore &prefs) {
     } catch (const std::exception &e) {
         spdlog::warn("{} {}", __PRETTY_FUNCTION__, e.what());
     }
+    try {
+        preview_thumbnails_ =
+            preference_value<bool>(prefs, "/plugin/media_reader/OpenEXR/preview_thumbnails");
+    } catch (const std::exception &e) {
+        spdlog::warn("{} {}", __PRETTY_FUNCTION__, e.what());
+    }
+    try {
+        frame_metadata_ =
+            preference_value<bool>(prefs, "/plugin/media_reader/OpenEXR/frame_metadata");
+    } catch (const std::exception &e) {
+        spdlog::warn("{} {}", __PRETTY_FUNCTION__, e.what());
+    }
 }
 
 ImageBufPtr OpenEXRMediaReader::image(const media::AVFrameID &mptr) {
+    return read_image(mptr, {});
+}
+
+ImageBufPtr OpenEXRMediaReader::decode_image(
+    const media::AVFrameID &mptr, const FilePrefetcher::File &file) {
+    return read_image(mptr, file);
+}
+
+ImageBufPtr OpenEXRMediaReader::read_image(
+    const media::AVFrameID &mptr, const std::optional<FilePrefetcher::File> &file) {
     try {
 
         std::string path = uri_to_posix_path(mptr.uri_);
 
         // DebugTimer dd(path);
 
-        Imf::MultiPartInputFile input(path.c_str());
+        // decode from memory if the file has already been read
+        std::unique_ptr<PrefetchedIStream> stream;
+        std::unique_ptr<Imf::MultiPartInputFile> input_file;
+        if (file) {
+            stream     = std::make_unique<PrefetchedIStream>(path, *file);
+            input_file = std::make_unique<Imf::MultiPartInputFile>(*stream);
+        } else {
+            input_file = std::make_unique<Imf::MultiPartInputFile>(path.c_str());
+        }
+        auto &input = *input_file;
         int parts    = input.parts();
         int part_idx = -1;
         Imf::PixelType pix_type;
@@ -302,12 +508,9 @@ ImageBufPtr OpenEXRMediaReader::image(const media::AVFrameID &mptr) {
         // const size_t padded_buf_size = (buf_size & (gl_line_size-1)) ?
         // ((buf_size/gl_line_size) + 1)*gl_line_size : buf_size;
 
-        JsonStore jsn;
-        jsn["num_channels"] = exr_channels_to_load.size();
-        jsn["pix_type"]     = int(pix_type);
-        // jsn["path"] = to_string(mptr.uri_);
-
-        ImageBufPtr buf(new ImageBuffer(openexr_shader_uuid, jsn));
+        ImageBufPtr buf(new ImageBuffer(openexr_shader_uuid));
+        buf->shader_uniforms().set("num_channels", int(exr_channels_to_load.size()));
+        buf->shader_uniforms().set("pix_type", int(pix_type));
         buf->allocate(buf_size);
         buf->set_pixel_aspect(in.header().pixelAspectRatio());
 
@@ -324,6 +527,16 @@ ImageBufPtr OpenEXRMediaReader::image(const media::AVFrameID &mptr) {
         buf->params()["path"]          = to_string(mptr.uri_);
         buf->params()["channel_names"] = exr_channels_to_load;
         buf->params()["stream_id"]     = mptr.stream_id_;
+        if (frame_metadata_)
+            buf->set_frame_metadata(JsonStore(header_attributes(in.header())));
+        buf->set_pixel_layout({PixelPlane(
+            mptr.stream_id_,
+            pix_type == Imf::PixelType::HALF
+                ? PDT_HALF
+                : (pix_type == Imf::PixelType::FLOAT ? PDT_FLOAT32 : PDT_UINT32),
+            data_window.size().x + 1,
+            data_window.size().y + 1,
+            exr_channels_to_load.size())});
 
         if (cropped_data_window) {
             // if we are not loading the whole data window, we need to provide a temporary
@@ -621,46 +834,126 @@ xstudio::media::MediaDetail OpenEXRMediaReader::detail(const caf::uri &uri) cons
 thumbnail::ThumbnailBufferPtr
 OpenEXRMediaReader::thumbnail(const media::AVFrameID &mptr, const size_t thumb_size) {
 
-    Imf::RgbaInputFile file(uri_to_posix_path(mptr.uri_).c_str());
+    const std::string path = uri_to_posix_path(mptr.uri_);
 
-    if (file.header().hasPreviewImage()) {
-        const Imf::PreviewImage &preview = file.header().previewImage();
-        auto thumb                       = std::make_shared<thumbnail::ThumbnailBuffer>(
-            preview.width(), preview.height(), thumbnail::TF_RGB24);
+    try {
+        Imf::MultiPartInputFile input(path.c_str());
+        const Imf::Header &header = input.header(0);
 
-        auto b = &(thumb->data()[0]);
+        if (header.hasPreviewImage()) {
+            const Imf::PreviewImage &preview = header.previewImage();
+            auto thumb = std::make_shared<thumbnail::ThumbnailBuffer>(
+                preview.width(), preview.height(), thumbnail::TF_RGB24);
 
-        for (unsigned int i = 0; i < preview.width() * preview.height(); ++i) {
-            b[0] = std::byte{preview.pixels()[i].r};
-            b[1] = std::byte{preview.pixels()[i].g};
-            b[2] = std::byte{preview.pixels()[i].b};
-            b += 3;
-        }
-        return thumb;
-    } else {
+            auto b = &(thumb->data()[0]);
 
-        ImageBufPtr full_image_buffer = image(mptr);
+            for (unsigned int i = 0; i < preview.width() * preview.height(); ++i) {
+                b[0] = std::byte{preview.pixels()[i].r};
+                b[1] = std::byte{preview.pixels()[i].g};
+                b[2] = std::byte{preview.pixels()[i].b};
+                b += 3;
+            }
+            return thumb;
+        }
 
-        int exr_width     = full_image_buffer->image_size_in_pixels().x;
-        int exr_height    = full_image_buffer->image_size_in_pixels().y;
-        int adj_exr_width = (int)round(float(exr_width) * full_image_buffer->pixel_aspect());
+        auto thumb = subsampled_thumbnail(input, thumb_size);
+        if (preview_thumbnails_)
+            thumb = to_preview(*thumb);
+        return thumb;
 
-        int thumb_width =
-            adj_exr_width > exr_height ? thumb_size : (thumb_size * adj_exr_width) / exr_height;
-        int thumb_height =
-            exr_height > adj_exr_width ? thumb_size : (thumb_size * exr_height) / adj_exr_width;
+    } catch (const std::exception &e) {
+        throw media_corrupt_error(
+            "Failed to read thumbnail " + path + " " + std::string(e.what()));
+    }
+}
 
-        auto thumb = std::make_shared<thumbnail::ThumbnailBuffer>(
-            thumb_width, thumb_height, thumbnail::TF_RGBF96);
+thumbnail::ThumbnailBufferPtr OpenEXRMediaReader::subsampled_thumbnail(
+    Imf::MultiPartInputFile &input, const size_t thumb_size) const {
+
+    // Only the first stream of the first part, normally RGBA, and only as
+    // much of it as the thumbnail samples.
+    const Imf::Header &header = input.header(0);
+    std::vector<std::string> stream_ids;
+    stream_ids_from_exr_part(header, stream_ids);
+    if (stream_ids.empty())
+        throw std::runtime_error("No readable layer in part 0");
+
+    std::vector<std::string> channels;
+    pick_exr_channels_from_stream_id(header, stream_ids[0], channels);
+    // RGB, or luminance
+    channels.resize(channels.size() >= 3 ? 3 : 1);
+
+    const Imath::Box2i data_window    = header.dataWindow();
+    const Imath::Box2i display_window = header.displayWindow();
+    const int exr_width               = display_window.size().x + 1;
+    const int exr_height              = display_window.size().y + 1;
+    const int adj_exr_width = (int)round(float(exr_width) * header.pixelAspectRatio());
+
+    const int size          = int(thumb_size);
+
+    const int thumb_width = std::max(
+        1, adj_exr_width > exr_height ? size : (size * adj_exr_width) / exr_height);
+    const int thumb_height = std::max(
+        1, exr_height > adj_exr_width ? size : (size * exr_height) / adj_exr_width);
+
+    auto thumb = std::make_shared<thumbnail::ThumbnailBuffer>(
+        thumb_width, thumb_height, thumbnail::TF_RGBF96);
+
+    if (header.hasTileDescription()) {
+
+        Imf::TiledInputPart in(input, 0);
+        const Imf::TileDescription &tiles = header.tileDescription();
+
+        // the smallest level that still has a pixel for each thumbnail pixel
+        int level = 0;
+        if (tiles.mode != Imf::ONE_LEVEL) {
+            const int levels = tiles.mode == Imf::MIPMAP_LEVELS
+                                   ? in.numLevels()
+                                   : std::min(in.numXLevels(), in.numYLevels());
+            for (int l = 1; l < levels; ++l) {
+                const auto level_window = in.dataWindowForLevel(l, l);
+                if ((level_window.size().x + 1) * exr_width <
+                        thumb_width * (data_window.size().x + 1) or
+                    (level_window.size().y + 1) * exr_height <
+                        thumb_height * (data_window.size().y + 1))
+                    break;
+                level = l;
+            }
+        }
 
-        // auto d = reinterpret_cast<uint8_t *>(thumb->data().data());
+        sample_rows(
+            *thumb,
+            display_window,
+            data_window,
+            in.dataWindowForLevel(level, level),
+            tiles.ySize,
+            channels,
+            [&](Imf::FrameBuffer &fb, const int y0, const int) {
+                const int tile_row = (y0 - data_window.min.y) / tiles.ySize;
+                in.setFrameBuffer(fb);
+                in.readTiles(0, in.numXTiles(level) - 1, tile_row, tile_row, level, level);
+            });
 
-        SimpleExrSampler ss(full_image_buffer, thumb);
-        ss.fill_output();
+    } else {
 
-        return thumb;
+        Imf::InputPart in(input, 0);
+
+        // Scanlines are compressed in blocks, a thumbnail row costs the
+        // block it's in and blocks between sampled rows aren't read.
+        sample_rows(
+            *thumb,
+            display_window,
+            data_window,
+            data_window,
+            Imf::numLinesInBuffer(header.compression()),
+            channels,
+            [&](Imf::FrameBuffer &fb, const int y0, const int y1) {
+                in.setFrameBuffer(fb);
+                in.readPixels(y0, y1);
+            });
     }
-    throw media_corrupt_error("Failed to read preview " + uri_to_posix_path(mptr.uri_));
+
+    return thumb;
 }
 
 /*
@@ -672,8 +965,8 @@ PixelInfo OpenEXRMediaReader::exr_buffer_pixel_picker(
     const ImageBuffer &buf, const Imath::V2i &pixel_location) {
     int width                         = buf.image_size_in_pixels().x;
     int height                        = buf.image_size_in_pixels().y;
-    int num_channels                  = buf.shader_params().value("num_channels", 0);
-    int pix_type                      = buf.shader_params().value("pix_type", 0);
+    int num_channels                  = buf.shader_uniforms().value("num_channels", 0);
+    int pix_type                      = buf.shader_uniforms().value("pix_type", 0);
     const Imath::V2i image_bounds_min = buf.image_pixels_bounding_box().min;
     const Imath::V2i image_bounds_max = buf.image_pixels_bounding_box().max;
 
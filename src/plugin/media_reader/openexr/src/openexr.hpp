@@ -8,6 +8,7 @@
 #include "xstudio/utility/helpers.hpp"
 #include <ImfChannelList.h>
 #include <ImfHeader.h> // staticInitialize
+#include <ImfMultiPartInputFile.h>
 
 namespace xstudio {
 namespace media_reader {
@@ -24,6 +25,9 @@ namespace media_reader {
         supported(const caf::uri &uri, const std::array<uint8_t, 16> &signature) override;
 
         ImageBufPtr image(const media::AVFrameID &mptr) override;
+        ImageBufPtr
+        decode_image(const media::AVFrameID &mptr, const FilePrefetcher::File &file) override;
+        bool can_decode_from_memory() const override { return true; }
         media::MediaDetail detail(const caf::uri &uri) const override;
         thumbnail::ThumbnailBufferPtr
         thumbnail(const media::AVFrameID &mpr, const size_t thumb_size) override;
@@ -34,6 +38,14 @@ namespace media_reader {
         }
 
       private:
+        ImageBufPtr read_image(
+            const media::AVFrameID &mptr, const std::optional<FilePrefetcher::File> &file);
+
+        // reads only the pixels the thumbnail samples, from the smallest mip
+        // level or the scanline blocks that hold them
+        thumbnail::ThumbnailBufferPtr
+        subsampled_thumbnail(Imf::MultiPartInputFile &input, const size_t thumb_size) const;
+
         static PixelInfo
         exr_buffer_pixel_picker(const ImageBuffer &buf, const Imath::V2i &pixel_location);
 
@@ -51,6 +63,9 @@ namespace media_reader {
 
         float max_exr_overscan_percent_;
         int readers_per_source_;
+        bool preview_thumbnails_;
+        // return the header attributes with each frame
+        bool frame_metadata_;
     };
 } // namespace media_reader
 } // namespace xstudio
@@ -11,8 +11,8 @@ namespace media_reader {
             : exr_buf_(exr_buf), thumbuf_(buf) {
             exr_size     = exr_buf->image_size_in_pixels();
             exr_data_win = exr_buf->image_pixels_bounding_box();
-            exr_chans    = exr_buf->shader_params()["num_channels"].get<int>();
-            pix_type     = exr_buf->shader_params()["pix_type"].get<int>();
+            exr_chans    = exr_buf->shader_uniforms().value("num_channels", 0);
+            pix_type     = exr_buf->shader_uniforms().value("pix_type", 0);
 
             exr_bytes_per_pixel = exr_chans * (pix_type == Imf::PixelType::HALF ? 2 : 4);
             exr_bytes_per_line =
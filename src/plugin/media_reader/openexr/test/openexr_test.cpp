@@ -1,4 +1,11 @@
 // SPDX-License-Identifier: Apache-2.0
+#include <filesystem>
+#include <tuple>
+
+#include <ImfChannelList.h>
+#include <ImfOutputFile.h>
+#include <ImfRgbaFile.h>
+#include <ImfTiledOutputFile.h>
 
 #include "openexr.hpp"
 #include "xstudio/media/media.hpp"
@@ -13,6 +20,69 @@ using namespace xstudio::media_reader;
 
 ACTOR_TEST_MINIMAL()
 
+namespace {
+
+// RGBA and two more layers, red on the left half and green on the right. Blue
+// is 0.5 at full size and 0.5 more for each mip level below it.
+void write_test_exr(
+    const std::string &path, const int width, const int height, const bool tiled) {
+    const std::vector<std::string> channels = {
+        "R",
+        "G",
+        "B",
+        "A",
+        "diffuse.R",
+        "diffuse.G",
+        "diffuse.B",
+        "specular.R",
+        "specular.G",
+        "specular.B"};
+
+    Imf::Header header(width, height);
+    header.compression() = tiled ? Imf::ZIP_COMPRESSION : Imf::ZIPS_COMPRESSION;
+    for (const auto &channel : channels)
+        header.channels().insert(channel, Imf::Channel(Imf::HALF));
+
+    std::vector<half> pixels;
+    auto frame_buffer = [&](const int w, const int h, const int level) {
+        pixels.resize(size_t(w) * h * channels.size());
+        auto p = pixels.begin();
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                *(p++) = x < w / 2 ? 1.0f : 0.0f;
+                *(p++) = x < w / 2 ? 0.0f : 1.0f;
+                *(p++) = 0.5f * float(level + 1);
+                for (size_t c = 3; c < channels.size(); ++c)
+                    *(p++) = 1.0f;
+            }
+        }
+
+        Imf::FrameBuffer fb;
+        const size_t pixel_stride = sizeof(half) * channels.size();
+        for (size_t c = 0; c < channels.size(); ++c)
+            fb.insert(
+                channels[c],
+                Imf::Slice(
+                    Imf::HALF, (char *)(pixels.data() + c), pixel_stride, pixel_stride * w));
+        return fb;
+    };
+
+    if (tiled) {
+        header.setTileDescription(Imf::TileDescription(64, 64, Imf::MIPMAP_LEVELS));
+        Imf::TiledOutputFile out(path.c_str(), header);
+        for (int l = 0; l < out.numLevels(); ++l) {
+            out.setFrameBuffer(frame_buffer(out.levelWidth(l), out.levelHeight(l), l));
+            out.writeTiles(0, out.numXTiles(l) - 1, 0, out.numYTiles(l) - 1, l);
+        }
+    } else {
+        Imf::OutputFile out(path.c_str(), header);
+        out.setFrameBuffer(frame_buffer(width, height, 0));
+        out.writePixels(height);
+    }
+}
+
+} // namespace
+
 TEST(OpenEXRMediaReaderTest, Test) {
     OpenEXRMediaReader mr;
     caf::uri good = posix_path_to_uri(TEST_RESOURCE "/media/test.0001.exr");
@@ -35,3 +105,41 @@ TEST(OpenEXRMediaReaderTest, Test) {
 
     EXPECT_TRUE(got_image) << "Should be supported";
 }
+
+TEST(OpenEXRMediaReaderTest, Thumbnail) {
+    OpenEXRMediaReader mr;
+    const auto dir = std::filesystem::temp_directory_path() / "xstudio_openexr_thumbnail_test";
+    std::filesystem::create_directories(dir);
+
+    write_test_exr((dir / "scanline.1001.exr").string(), 2048, 1152, false);
+    write_test_exr((dir / "tiled.1001.exr").string(), 2048, 1152, true);
+    const auto scanline = posix_path_to_uri((dir / "scanline.1001.exr").string());
+    const auto tiled    = posix_path_to_uri((dir / "tiled.1001.exr").string());
+
+    // the thumbnail size, and the blue of the level it should be read from:
+    // full size for scanlines, the smallest mip level at least as big for
+    // tiles (2048 / 256 is level 3, 2048 / 128 level 4)
+    const std::vector<std::tuple<caf::uri, size_t, size_t, float>> cases = {
+        {scanline, 256, 144, 0.5f},
+        {scanline, 128, 72, 0.5f},
+        {tiled, 256, 144, 2.0f},
+        {tiled, 128, 72, 2.5f}};
+
+    for (const auto &[uri, width, height, blue] : cases) {
+        auto thumb = mr.thumbnail(media::AVFrameID(uri), width);
+        ASSERT_TRUE(thumb);
+        EXPECT_EQ(thumb->width(), width);
+        EXPECT_EQ(thumb->height(), height);
+        EXPECT_EQ(thumb->format(), thumbnail::TF_RGBF96);
+
+        const auto *left  = reinterpret_cast<const float *>(thumb->data().data());
+        const auto *right = left + (width - 1) * 3;
+        EXPECT_EQ(left[0], 1.0f);
+        EXPECT_EQ(left[1], 0.0f);
+        EXPECT_EQ(left[2], blue) << to_string(uri) << " " << width;
+        EXPECT_EQ(right[0], 0.0f);
+        EXPECT_EQ(right[1], 1.0f);
+    }
+
+    std::filesystem::remove_all(dir);
+}
@@ -111,6 +111,8 @@ ImageBufPtr PPMMediaReader::image(const media::AVFrameID &mptr) {
         buf->allocate(size * bytes_per_pixel);
         buf->set_shader(ppm_shader);
         buf->set_image_dimensions(Imath::V2i(width, height));
+        buf->set_pixel_layout({PixelPlane(
+            "rgb", bytes_per_channel == 2 ? PDT_UINT16 : PDT_UINT8, width, height, 3)});
 
         byte *buffer = buf->buffer();
         inp.read((char *)buffer, size * bytes_per_pixel);
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 #include "annotation.hpp"
 
+#include <atomic>
 #include <utility>
 #include "annotation_serialiser.hpp"
 #include "annotations_tool.hpp"
@@ -8,6 +9,13 @@
 using namespace xstudio::ui::viewport;
 using namespace xstudio;
 
+namespace {
+uint64_t next_vertices_id() {
+    static std::atomic<uint64_t> id{0};
+    return ++id;
+}
+} // namespace
+
 Annotation::Annotation(
     std::map<std::string, std::shared_ptr<SDFBitmapFont>> &fonts, bool is_laser_annotatio)
     : bookmark::AnnotationBase(), fonts_(fonts), is_laser_annotation_(is_laser_annotatio) {}
@@ -209,7 +217,11 @@ void Annotation::start_erase_stroke(const float thickness) {
 void Annotation::add_point_to_current_stroke(const Imath::V2f pt) {
     if (current_stroke_) {
         current_stroke_->add_point(pt);
-        update_render_data();
+        // only the current stroke needs rebuilding while it's drawn
+        if (committed_stroke_count_ == strokes_.size())
+            update_current_stroke_render_data();
+        else
+            update_render_data();
     }
 }
 
@@ -219,13 +231,11 @@ AnnotationRenderDataPtr Annotation::render_data(const bool is_edited_annotation)
 
 void Annotation::update_render_data() {
 
-    auto t0 = utility::clock::now();
-    cached_render_data_.reset();
-
     // each stroke is drawn at a slightly increasing depth so that
     // strokes layer ontop of each other
     render_data_.clear();
-    float depth = 0.0f;
+    render_data_.vertices_id_ = next_vertices_id();
+    float depth               = 0.0f;
     for (auto &stroke : strokes_) {
 
         depth += 0.001;
@@ -269,10 +279,26 @@ void Annotation::update_render_data() {
         }
     }
 
+    committed_vertex_count_ = render_data_.pen_stroke_vertices_.size();
+    committed_stroke_count_ = render_data_.stroke_info_.size();
+    committed_depth_        = depth;
+
+    update_current_stroke_render_data();
+}
+
+void Annotation::update_current_stroke_render_data() {
+
+    render_data_.pen_stroke_vertices_.erase(
+        render_data_.pen_stroke_vertices_.begin() + committed_vertex_count_,
+        render_data_.pen_stroke_vertices_.end());
+    render_data_.stroke_info_.erase(
+        render_data_.stroke_info_.begin() + committed_stroke_count_,
+        render_data_.stroke_info_.end());
+
     if (current_stroke_) {
 
-        depth += 0.001;
-        auto &stroke = *current_stroke_.get();
+        const float depth = committed_depth_ + 0.001;
+        auto &stroke      = *current_stroke_.get();
 
         AnnotationRenderData::StrokeInfo info;
 
@@ -326,8 +352,11 @@ Annotation::font(const std::shared_ptr<Caption> &caption) const {
     return fonts_.begin()->second;
 }
 
-void Annotation::finished_current_stroke() {
+StrokeSimplification Annotation::finished_current_stroke(const float simplify_tolerance) {
+    StrokeSimplification result;
     if (current_stroke_) {
+        result = current_stroke_->simplify(simplify_tolerance);
+        simplification_ += result;
         undo_stack_.emplace_back(
             static_cast<UndoRedo *>(new UndoRedoStroke(*current_stroke_.get())));
         redo_stack_.clear();
@@ -351,6 +380,7 @@ void Annotation::finished_current_stroke() {
         copy_of_edited_caption_.reset();
         update_render_data();
     }
+    return result;
 }
 
 bool Annotation::fade_strokes(const float selected_opacity) {
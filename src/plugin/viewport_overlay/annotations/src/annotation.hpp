@@ -19,6 +19,11 @@ namespace ui {
             utility::Uuid uuid_;
             std::vector<Imath::V2f> pen_stroke_vertices_;
 
+            // Render data with the same id only differ by vertices appended
+            // to the stroke being drawn (and its end cap), so the renderer
+            // only has to upload the new ones. Any other change gets a new id.
+            uint64_t vertices_id_ = {0};
+
             struct StrokeInfo {
                 int stroke_point_count_;
                 utility::ColourTriplet brush_colour_;
@@ -132,7 +137,8 @@ namespace ui {
 
             void add_point_to_current_stroke(const Imath::V2f pt);
 
-            void finished_current_stroke();
+            // the finished stroke is simplified to within simplify_tolerance
+            StrokeSimplification finished_current_stroke(const float simplify_tolerance = 0.0f);
 
             [[nodiscard]] utility::JsonStore
             serialise(utility::Uuid &plugin_uuid) const override;
@@ -150,6 +156,11 @@ namespace ui {
 
             void update_render_data();
 
+            // totals over the strokes simplified by finished_current_stroke
+            [[nodiscard]] const StrokeSimplification &simplification() const {
+                return simplification_;
+            }
+
             bool fade_strokes(const float selected_opacity);
 
             std::shared_ptr<PenStroke> current_stroke_;
@@ -196,6 +207,7 @@ namespace ui {
 
           private:
             bool no_fonts() const { return fonts_.empty(); }
+            void update_current_stroke_render_data();
             std::shared_ptr<SDFBitmapFont> font(const std::shared_ptr<Caption> &caption) const;
 
             friend class UndoRedoStroke;
@@ -213,6 +225,14 @@ namespace ui {
 
             AnnotationRenderData render_data_;
 
+            // how much of render_data_ comes from strokes_ and captions_, the
+            // rest is the current stroke
+            size_t committed_vertex_count_ = {0};
+            size_t committed_stroke_count_ = {0};
+            float committed_depth_         = {0.0f};
+
+            StrokeSimplification simplification_;
+
             std::vector<UndoRedoPtr> undo_stack_;
             std::vector<UndoRedoPtr> redo_stack_;
 
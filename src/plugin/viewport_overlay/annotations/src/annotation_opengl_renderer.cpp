@@ -238,6 +238,8 @@ void AnnotationsRenderer::render_opengl(
     if (!shader_)
         init_overlay_opengl();
 
+    vertex_buffer_.begin_frame();
+
     std::lock_guard<std::mutex> lock(immediate_data_gate_);
     utility::BlindDataObjectPtr render_data =
         frame.plugin_blind_data(utility::Uuid("46f386a0-cb9a-4820-8e99-fb53f6c019eb"));
@@ -303,26 +305,25 @@ void AnnotationsRenderer::render_annotation_to_screen(
 
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo_id_);
 
-    const auto sz = static_cast<unsigned int>(round(std::pow(
-        2.0f,
-        std::ceil(
-            std::log(render_data->pen_stroke_vertices_.size() * sizeof(Imath::V2f)) /
-            std::log(2.0f)))));
-
-    if (sz > ssbo_size_) {
-
-        ssbo_size_ = sz;
-        glNamedBufferData(ssbo_id_, ssbo_size_, nullptr, GL_DYNAMIC_DRAW);
+    // the vertices of every annotation stay in the buffer between redraws,
+    // only those added or changed since the last upload are copied
+    const auto placement = vertex_buffer_.place(
+        render_data->vertices_id_, render_data->pen_stroke_vertices_.size());
+
+    if (placement.reallocate) {
+        glNamedBufferData(
+            ssbo_id_,
+            vertex_buffer_.capacity() * sizeof(Imath::V2f),
+            nullptr,
+            GL_DYNAMIC_DRAW);
     }
 
-    if (last_data_ != render_data->pen_stroke_vertices_.data()) {
-        last_data_          = render_data->pen_stroke_vertices_.data();
-        auto *buffer_io_ptr = (uint8_t *)glMapNamedBuffer(ssbo_id_, GL_WRITE_ONLY);
-        memcpy(
-            buffer_io_ptr,
-            render_data->pen_stroke_vertices_.data(),
-            render_data->pen_stroke_vertices_.size() * sizeof(Imath::V2f));
-        glUnmapNamedBuffer(ssbo_id_);
+    if (placement.count) {
+        glNamedBufferSubData(
+            ssbo_id_,
+            (placement.offset + placement.first) * sizeof(Imath::V2f),
+            placement.count * sizeof(Imath::V2f),
+            render_data->pen_stroke_vertices_.data() + placement.first);
     }
 
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, ssbo_id_);
@@ -332,7 +333,8 @@ void AnnotationsRenderer::render_annotation_to_screen(
     utility::JsonStore shader_params3;
     shader_params3["do_soft_edge"] = true;
 
-    GLint offset = 0;
+    const auto base_offset = static_cast<GLint>(placement.offset);
+    GLint offset           = base_offset;
 
     if (do_erase_strokes_first) {
         glDepthFunc(GL_GREATER);
@@ -353,7 +355,7 @@ void AnnotationsRenderer::render_annotation_to_screen(
             offset += (stroke_info.stroke_point_count_);
         }
     }
-    offset = 0;
+    offset = base_offset;
     for (const auto &stroke_info : render_data->stroke_info_) {
 
         if (do_erase_strokes_first && stroke_info.is_erase_stroke_) {
@@ -5,6 +5,7 @@
 #include "xstudio/ui/opengl/shader_program_base.hpp"
 #include "xstudio/ui/opengl/opengl_text_rendering.hpp"
 #include "annotation.hpp"
+#include "stroke_vertex_buffer.hpp"
 
 namespace xstudio {
 namespace ui {
@@ -77,12 +78,11 @@ namespace ui {
             std::map<std::string, FontRenderer> text_renderers_;
 
             GLuint ssbo_id_;
-            GLuint ssbo_size_ = {0};
+            StrokeVertexBuffer vertex_buffer_;
 
             std::mutex immediate_data_gate_;
             utility::BlindDataObjectPtr immediate_data_;
             AnnotationRenderDataPtr current_edited_annotation_render_data_;
-            const void *last_data_ = {nullptr};
             Imath::Box2f under_mouse_caption_bdb_, current_caption_bdb_;
             Imath::V2f cursor_position_[2];
             Caption::HoverState caption_hover_state_ = {Caption::NotHovered};
@@ -67,6 +67,12 @@ AnnotationsButton {
     pen_opacity_->set_preference_path("/plugin/annotations/pen_opacity");
     pen_colour_->set_preference_path("/plugin/annotations/pen_colour");
 
+    // finished strokes drop points closer than this many screen pixels to
+    // the line through their neighbours
+    simplify_tolerance_ = add_float_attribute(
+        "Stroke Simplify Tolerance", "Simplify", 0.5f, 0.0f, 10.0f, 0.1f, 1);
+    simplify_tolerance_->set_preference_path("/plugin/annotations/stroke_simplify_tolerance");
+
     // we can register a preference path with each of these attributes. xStudio
     // will then automatically intialised the attribute values from preference
     // file(s) and also, if the attribute is changed, the new value will be
@@ -310,6 +316,7 @@ bool AnnotationsTool::pointer_event(const ui::PointerEvent &e) {
         (active_tool_->value() == "Draw" || active_tool_->value() == "Erase")) {
 
         if (e.type() == ui::Signature::EventType::ButtonDown) {
+            stroke_pixel_scale_ = e.viewport_pixel_scale();
             start_freehand_pen_stroke(pointer_pos);
         } else if (e.type() == ui::Signature::EventType::Drag) {
             freehand_pen_stroke_point(pointer_pos);
@@ -320,6 +327,7 @@ bool AnnotationsTool::pointer_event(const ui::PointerEvent &e) {
         e.buttons() == ui::Signature::Button::Left && active_tool_->value() == "Shapes") {
 
         if (e.type() == ui::Signature::EventType::ButtonDown) {
+            stroke_pixel_scale_ = e.viewport_pixel_scale();
             start_shape_placement(pointer_pos);
         } else if (e.type() == ui::Signature::EventType::Drag) {
             update_shape_placement(pointer_pos);
@@ -574,7 +582,16 @@ void AnnotationsTool::end_stroke(const Imath::V2f &) {
 
     if (current_edited_annotation_) {
 
-        current_edited_annotation_->finished_current_stroke();
+        const auto simplified = current_edited_annotation_->finished_current_stroke(
+            simplify_tolerance_->value() * stroke_pixel_scale_);
+        if (simplified.points_before) {
+            spdlog::debug(
+                "Stroke simplified from {} to {} points, {} to {} bytes serialised",
+                simplified.points_before,
+                simplified.points_after,
+                simplified.serialised_size_before,
+                simplified.serialised_size_after);
+        }
 
         // update annotation data attached to bookmark
         if (!is_laser_mode()) {
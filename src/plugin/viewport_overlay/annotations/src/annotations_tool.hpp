@@ -113,12 +113,13 @@ namespace ui {
 
             module::StringChoiceAttribute *active_tool_;
 
-            module::IntegerAttribute *draw_pen_size_   = {nullptr};
-            module::IntegerAttribute *shapes_pen_size_ = {nullptr};
-            module::IntegerAttribute *erase_pen_size_  = {nullptr};
-            module::IntegerAttribute *text_size_       = {nullptr};
-            module::IntegerAttribute *pen_opacity_     = {nullptr};
-            module::ColourAttribute *pen_colour_       = {nullptr};
+            module::IntegerAttribute *draw_pen_size_    = {nullptr};
+            module::IntegerAttribute *shapes_pen_size_  = {nullptr};
+            module::IntegerAttribute *erase_pen_size_   = {nullptr};
+            module::IntegerAttribute *text_size_        = {nullptr};
+            module::IntegerAttribute *pen_opacity_      = {nullptr};
+            module::ColourAttribute *pen_colour_        = {nullptr};
+            module::FloatAttribute *simplify_tolerance_ = {nullptr};
 
             module::BooleanAttribute *text_cursor_blink_attr_ = {nullptr};
             module::BooleanAttribute *tool_is_active_         = {nullptr};
@@ -156,6 +157,10 @@ namespace ui {
 
             bool playhead_is_playing_ = {false};
 
+            // size of a screen pixel in viewport coordinates when the current
+            // stroke was started
+            float stroke_pixel_scale_ = {0.0f};
+
             std::vector<AnnotationsRenderer *> renderers_;
 
             std::map<std::string, std::shared_ptr<SDFBitmapFont>> fonts_;
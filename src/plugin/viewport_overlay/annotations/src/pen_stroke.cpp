@@ -1,4 +1,6 @@
 // SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+
 #include "pen_stroke.hpp"
 
 using namespace xstudio::ui::viewport;
@@ -44,6 +46,16 @@ static const struct CircPts {
 
 } s_circ_pts(48);
 
+// distance from p to the segment a-b
+float segment_distance(const Imath::V2f &p, const Imath::V2f &a, const Imath::V2f &b) {
+    const Imath::V2f ab = b - a;
+    const float len2    = ab.dot(ab);
+    if (len2 == 0.0f)
+        return (p - a).length();
+    const float t = std::max(0.0f, std::min(1.0f, (p - a).dot(ab) / len2));
+    return (p - (a + ab * t)).length();
+}
+
 } // namespace
 
 PenStroke::PenStroke(
@@ -62,6 +74,69 @@ void PenStroke::add_point(const Imath::V2f &pt) {
     }
 }
 
+StrokeSimplification PenStroke::simplify(const float tolerance) {
+
+    StrokeSimplification result;
+    result.points_before          = points_.size();
+    result.serialised_size_before = serialised_points_size();
+
+    if (tolerance > 0.0f && points_.size() > 2) {
+
+        // iterative rather than recursive, strokes can have many thousands
+        // of points
+        std::vector<bool> keep(points_.size(), false);
+        std::vector<std::pair<size_t, size_t>> spans;
+        keep.front() = true;
+        keep.back()  = true;
+        spans.emplace_back(0, points_.size() - 1);
+
+        while (!spans.empty()) {
+            const auto [first, last] = spans.back();
+            spans.pop_back();
+
+            float max_dist   = 0.0f;
+            size_t max_index = first;
+            for (size_t i = first + 1; i < last; ++i) {
+                const float d = segment_distance(points_[i], points_[first], points_[last]);
+                if (d > max_dist) {
+                    max_dist  = d;
+                    max_index = i;
+                }
+            }
+
+            if (max_dist > tolerance) {
+                keep[max_index] = true;
+                if (max_index - first > 1)
+                    spans.emplace_back(first, max_index);
+                if (last - max_index > 1)
+                    spans.emplace_back(max_index, last);
+            }
+        }
+
+        size_t n = 0;
+        for (size_t i = 0; i < points_.size(); ++i) {
+            if (keep[i])
+                points_[n++] = points_[i];
+        }
+        points_.resize(n);
+    }
+
+    result.points_after          = points_.size();
+    result.serialised_size_after = serialised_points_size();
+    return result;
+}
+
+size_t PenStroke::serialised_points_size() const {
+    // matches the flat x,y array written by the annotation serialiser
+    std::vector<float> pts;
+    pts.reserve(points_.size() * 2);
+    for (const auto &pt : points_) {
+        pts.push_back(pt.x);
+        pts.push_back(pt.y);
+    }
+    return nlohmann::json(pts).dump().size();
+}
+
 inline float cross(const Imath::V3f &a, const Imath::V3f &b) { return a.x * b.y - b.x * a.y; }
 
 inline float dot(const Imath::V3f &a, const Imath::V3f &b) { return a.x * b.x + b.y * a.y; }
@@ -13,6 +13,23 @@ namespace xstudio {
 namespace ui {
     namespace viewport {
 
+        // point counts and size of the serialised points of a stroke, before
+        // and after simplification
+        struct StrokeSimplification {
+            size_t points_before          = {0};
+            size_t points_after           = {0};
+            size_t serialised_size_before = {0};
+            size_t serialised_size_after  = {0};
+
+            StrokeSimplification &operator+=(const StrokeSimplification &o) {
+                points_before += o.points_before;
+                points_after += o.points_after;
+                serialised_size_before += o.serialised_size_before;
+                serialised_size_after += o.serialised_size_after;
+                return *this;
+            }
+        };
+
         class PenStroke {
 
           public:
@@ -35,6 +52,15 @@ namespace ui {
 
             void add_point(const Imath::V2f &pt);
 
+            // Drop points that lie within tolerance of the line through their
+            // neighbours (Ramer-Douglas-Peucker). Tolerance is in the units of
+            // the points, pass the size of a screen pixel to keep the stroke
+            // visually unchanged at the zoom it was drawn at.
+            StrokeSimplification simplify(const float tolerance);
+
+            // bytes taken by the points when serialised as json
+            [[nodiscard]] size_t serialised_points_size() const;
+
             int fetch_render_data(std::vector<Imath::V2f> &vertices);
 
             void make_square(const Imath::V2f &corner1, const Imath::V2f &corner2);
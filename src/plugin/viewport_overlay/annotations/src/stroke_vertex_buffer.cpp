@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+
+#include "stroke_vertex_buffer.hpp"
+
+using namespace xstudio::ui::viewport;
+
+namespace {
+size_t next_power_of_two(const size_t n) {
+    size_t r = 1;
+    while (r < n)
+        r <<= 1;
+    return r;
+}
+} // namespace
+
+StrokeVertexBuffer::Placement
+StrokeVertexBuffer::place(const uint64_t id, const size_t vertex_count) {
+
+    Placement result;
+    if (!vertex_count)
+        return result;
+
+    auto p = ranges_.find(id);
+    if (p != ranges_.end() && vertex_count <= p->second.size) {
+
+        auto &range   = p->second;
+        range.frame   = frame_;
+        result.offset = range.offset;
+        if (vertex_count > range.uploaded) {
+            // the old end cap is overwritten by the next stroke point
+            result.first = range.uploaded ? range.uploaded - 1 : 0;
+            result.count = vertex_count - result.first;
+        } else if (vertex_count < range.uploaded) {
+            // shouldn't happen under the same id, upload it all
+            result.count = vertex_count;
+        }
+        range.uploaded = vertex_count;
+        return result;
+    }
+
+    if (p != ranges_.end()) {
+        // out of room, the old range is left unused until the next layout
+        ranges_.erase(p);
+    }
+
+    // leave room for a stroke that is being drawn to grow
+    const size_t size = next_power_of_two(vertex_count);
+
+    if (top_ + size > capacity_) {
+        // ranges that aren't being drawn may belong to annotations that have
+        // since been edited, so only size the buffer for what is in use
+        size_t in_use = size;
+        for (const auto &i : ranges_) {
+            if (i.second.frame + 1 >= frame_)
+                in_use += i.second.size;
+        }
+
+        const size_t capacity =
+            std::max(std::max(capacity_, min_capacity_), next_power_of_two(in_use * 2));
+        result.reallocate = capacity != capacity_;
+        capacity_         = capacity;
+        ranges_.clear();
+        top_ = 0;
+    }
+
+    Range range;
+    range.offset   = top_;
+    range.size     = size;
+    range.uploaded = vertex_count;
+    range.frame    = frame_;
+    ranges_[id]    = range;
+    top_ += size;
+
+    result.offset = range.offset;
+    result.count  = vertex_count;
+    return result;
+}
+
+void StrokeVertexBuffer::clear() {
+    ranges_.clear();
+    capacity_ = 0;
+    top_      = 0;
+}
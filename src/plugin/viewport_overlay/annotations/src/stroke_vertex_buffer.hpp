@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace xstudio {
+namespace ui {
+    namespace viewport {
+
+        /*  Keeps track of where the vertices of each annotation live in the
+        persistent vertex buffer the renderer draws from, and which of them
+        need uploading, without touching GL so it can be tested on its own.
+
+        Each set of vertices gets a range of the buffer that is reused while
+        the set keeps the same id. Vertices under one id must only ever be
+        appended to, apart from the final vertex (the end cap of the stroke
+        being drawn), so only the tail is uploaded as a stroke grows. Ranges
+        have room to grow, and move to the end of the buffer when they run
+        out. When the buffer is full everything is laid out again as it is
+        next drawn, and the buffer grows if what was drawn over the last two
+        redraws takes more than half of it.
+
+        Sizes and offsets are in vertices. */
+        class StrokeVertexBuffer {
+
+          public:
+            struct Placement {
+                // start of the annotation's range in the buffer
+                size_t offset = {0};
+                // vertices [first, first + count) of the annotation need
+                // copying to offset + first
+                size_t first = {0};
+                size_t count = {0};
+                // the buffer must be reallocated at capacity() first
+                bool reallocate = {false};
+            };
+
+            StrokeVertexBuffer(const size_t min_capacity = 4096)
+                : min_capacity_(min_capacity) {}
+
+            // call at the start of each redraw
+            void begin_frame() { frame_++; }
+
+            Placement place(const uint64_t id, const size_t vertex_count);
+
+            void clear();
+
+            [[nodiscard]] size_t capacity() const { return capacity_; }
+            [[nodiscard]] size_t used() const { return top_; }
+            [[nodiscard]] size_t ranges() const { return ranges_.size(); }
+
+          private:
+            struct Range {
+                size_t offset   = {0};
+                size_t size     = {0};
+                size_t uploaded = {0};
+                uint64_t frame  = {0};
+            };
+
+            const size_t min_capacity_;
+            size_t capacity_ = {0};
+            size_t top_      = {0};
+            uint64_t frame_  = {0};
+            std::map<uint64_t, Range> ranges_;
+        };
+
+    } // end namespace viewport
+} // end namespace ui
+} // end namespace xstudio
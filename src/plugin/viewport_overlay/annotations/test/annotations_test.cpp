@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <cmath>
+#include <gtest/gtest.h>
+
+#include "pen_stroke.hpp"
+#include "stroke_vertex_buffer.hpp"
+
+using namespace xstudio;
+using namespace xstudio::ui::viewport;
+
+TEST(PenStrokeTest, Simplify) {
+    // a densely sampled straight line with a corner half way
+    PenStroke stroke(utility::ColourTriplet(1.0f, 0.0f, 0.0f), 0.01f, 1.0f);
+    for (int i = 0; i <= 1000; ++i)
+        stroke.add_point(Imath::V2f(float(i) * 0.001f, 0.0f));
+    for (int i = 1; i <= 1000; ++i)
+        stroke.add_point(Imath::V2f(1.0f, float(i) * 0.001f));
+
+    auto copy = stroke;
+    EXPECT_EQ(copy.simplify(0.0f).points_after, 2001) << "Zero tolerance keeps everything";
+
+    const auto result = stroke.simplify(0.0005f);
+    EXPECT_EQ(result.points_before, 2001);
+    EXPECT_EQ(result.points_after, 3);
+    EXPECT_EQ(stroke.points_.front(), Imath::V2f(0.0f, 0.0f));
+    EXPECT_EQ(stroke.points_[1], Imath::V2f(1.0f, 0.0f));
+    EXPECT_EQ(stroke.points_.back(), Imath::V2f(1.0f, 1.0f));
+    EXPECT_LT(result.serialised_size_after, result.serialised_size_before / 100);
+    EXPECT_EQ(result.serialised_size_after, stroke.serialised_points_size());
+
+    // a wobble smaller than the tolerance goes, a bigger one stays
+    PenStroke wobble(utility::ColourTriplet(1.0f, 0.0f, 0.0f), 0.01f, 1.0f);
+    for (int i = 0; i <= 100; ++i)
+        wobble.add_point(Imath::V2f(float(i) * 0.01f, 0.0001f * std::sin(float(i))));
+    wobble.add_point(Imath::V2f(1.01f, 0.1f));
+    wobble.add_point(Imath::V2f(1.02f, 0.0f));
+    wobble.simplify(0.001f);
+    EXPECT_EQ(wobble.points_.size(), 4);
+    EXPECT_EQ(wobble.points_[2], Imath::V2f(1.01f, 0.1f));
+
+    // closed shapes keep their corners
+    PenStroke square(utility::ColourTriplet(1.0f, 0.0f, 0.0f), 0.01f, 1.0f);
+    square.make_square(Imath::V2f(0.0f, 0.0f), Imath::V2f(1.0f, 1.0f));
+    EXPECT_EQ(square.simplify(0.001f).points_after, 5);
+
+    PenStroke circle(utility::ColourTriplet(1.0f, 0.0f, 0.0f), 0.01f, 1.0f);
+    circle.make_circle(Imath::V2f(0.0f, 0.0f), 1.0f);
+    const auto circle_result = circle.simplify(0.05f);
+    EXPECT_LT(circle_result.points_after, circle_result.points_before);
+    EXPECT_GT(circle_result.points_after, 8);
+
+    EXPECT_LT(result.points_after, result.points_before);
+}
+
+TEST(StrokeVertexBufferTest, Place) {
+    StrokeVertexBuffer buffer(64);
+
+    // first placement allocates the buffer and uploads everything
+    auto p = buffer.place(1, 10);
+    EXPECT_TRUE(p.reallocate);
+    EXPECT_EQ(p.offset, 0);
+    EXPECT_EQ(p.first, 0);
+    EXPECT_EQ(p.count, 10);
+    EXPECT_EQ(buffer.capacity(), 64);
+
+    // unchanged, nothing to upload
+    p = buffer.place(1, 10);
+    EXPECT_FALSE(p.reallocate);
+    EXPECT_EQ(p.count, 0);
+
+    // stroke grew by two points, the old end cap and the new vertices
+    p = buffer.place(1, 12);
+    EXPECT_EQ(p.offset, 0);
+    EXPECT_EQ(p.first, 9);
+    EXPECT_EQ(p.count, 3);
+
+    // a second annotation gets its own range
+    p = buffer.place(2, 5);
+    EXPECT_EQ(p.offset, 16);
+    EXPECT_EQ(p.count, 5);
+
+    // outgrowing its range moves an annotation, uploading it all
+    buffer.begin_frame();
+    p = buffer.place(1, 20);
+    EXPECT_EQ(p.first, 0);
+    EXPECT_EQ(p.count, 20);
+    EXPECT_EQ(p.offset, 24);
+    EXPECT_FALSE(p.reallocate);
+
+    // running out of room lays everything out again, growing the buffer
+    // for what has been drawn recently
+    buffer.begin_frame();
+    buffer.begin_frame();
+    p = buffer.place(3, 64);
+    EXPECT_EQ(p.offset, 0);
+    EXPECT_TRUE(p.reallocate);
+    EXPECT_EQ(buffer.capacity(), 128);
+    EXPECT_EQ(buffer.ranges(), 1);
+    p = buffer.place(2, 5);
+    EXPECT_EQ(p.count, 5) << "Annotation uploaded again after a new layout";
+
+    EXPECT_EQ(buffer.place(4, 0).count, 0);
+}
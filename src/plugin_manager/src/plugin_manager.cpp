@@ -1,9 +1,11 @@
 // SPDX-License-Identifier: Apache-2.0
 #include <dlfcn.h>
+#include <chrono>
 #include <filesystem>
 
 #include <fstream>
 #include <iostream>
+#include <optional>
 
 #include "xstudio/plugin_manager/plugin_manager.hpp"
 #include "xstudio/utility/helpers.hpp"
@@ -14,10 +16,145 @@ using namespace xstudio::utility;
 namespace fs = std::filesystem;
 
 
+namespace {
+
+// Opens a plugin library and returns its factories, or nothing if it can't be
+// opened. A library without the entry point has no factories.
+std::optional<std::vector<std::shared_ptr<PluginFactory>>>
+open_library(const std::string &path) {
+
+    // clear any errors..
+    dlerror();
+
+    void *hndl = dlopen(path.c_str(), RTLD_NOW);
+    if (hndl == nullptr) {
+        spdlog::warn("{} {}", __PRETTY_FUNCTION__, dlerror());
+        return {};
+    }
+
+    std::vector<std::shared_ptr<PluginFactory>> result;
+
+    plugin_factory_collection_ptr pfcp;
+    *(void **)(&pfcp) = dlsym(hndl, "plugin_factory_collection_ptr");
+    if (pfcp == nullptr) {
+        spdlog::debug("{} {}", __PRETTY_FUNCTION__, dlerror());
+        dlclose(hndl);
+        return result;
+    }
+
+    PluginFactoryCollection *pfc = nullptr;
+    bool failed                  = false;
+    try {
+        pfc    = pfcp();
+        result = pfc->factories();
+    } catch (const std::exception &err) {
+        spdlog::warn(
+            "{} Failed to init plugin {} {}", __PRETTY_FUNCTION__, path.c_str(), err.what());
+        failed = true;
+    }
+    if (pfc)
+        delete pfc;
+
+    if (failed)
+        return {};
+    return result;
+}
+
+nlohmann::json describe(PluginFactory &factory) {
+    return nlohmann::json{
+        {"uuid", to_string(factory.uuid())},
+        {"name", factory.name()},
+        {"type", int(factory.type())},
+        {"resident", factory.resident()},
+        {"author", factory.author()},
+        {"description", factory.description()},
+        {"version", factory.version().to_string()},
+        {"widget_ui", factory.spawn_widget_ui()},
+        {"menu_ui", factory.spawn_menu_ui()}};
+}
+
+// what the manifest knows a library by, so a rebuilt library is opened again
+nlohmann::json library_stamp(const fs::path &path) {
+    return nlohmann::json{
+        {"size", fs::file_size(path)},
+        {"modified", fs::last_write_time(path).time_since_epoch().count()}};
+}
+
+// A plugin described by the manifest, its library is opened the first time
+// it's spawned.
+class ManifestPluginFactory : public PluginFactory {
+  public:
+    ManifestPluginFactory(nlohmann::json detail, std::string path)
+        : detail_(std::move(detail)), path_(std::move(path)) {}
+    ~ManifestPluginFactory() override = default;
+
+    [[nodiscard]] std::string name() const override { return detail_.at("name"); }
+    [[nodiscard]] Uuid uuid() const override {
+        return Uuid(detail_.at("uuid").get<std::string>());
+    }
+    [[nodiscard]] PluginType type() const override {
+        return PluginType(detail_.at("type").get<int>());
+    }
+    [[nodiscard]] bool resident() const override { return detail_.at("resident"); }
+    [[nodiscard]] std::string author() const override { return detail_.at("author"); }
+    [[nodiscard]] std::string description() const override {
+        return detail_.at("description");
+    }
+    [[nodiscard]] semver::version version() const override {
+        return semver::version(detail_.at("version").get<std::string>());
+    }
+    [[nodiscard]] std::string spawn_widget_ui() override { return detail_.at("widget_ui"); }
+    [[nodiscard]] std::string spawn_menu_ui() override { return detail_.at("menu_ui"); }
+
+    [[nodiscard]] caf::actor
+    spawn(caf::blocking_actor &sys, const JsonStore &json) override {
+        if (not factory_) {
+            const auto start = std::chrono::steady_clock::now();
+            if (auto factories = open_library(path_)) {
+                for (const auto &i : *factories) {
+                    if (i->uuid() == uuid())
+                        factory_ = i;
+                }
+            }
+            if (not factory_)
+                throw std::runtime_error("Plugin missing from " + path_);
+            spdlog::debug(
+                "Loaded plugin {} {} {:.3f}s",
+                name(),
+                path_,
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                    .count());
+        }
+        return factory_->spawn(sys, json);
+    }
+
+    [[nodiscard]] bool loaded() const { return bool(factory_); }
+
+  private:
+    nlohmann::json detail_;
+    std::string path_;
+    std::shared_ptr<PluginFactory> factory_;
+};
+
+} // namespace
+
 PluginManager::PluginManager(std::list<std::string> plugin_paths)
     : plugin_paths_(std::move(plugin_paths)) {}
 
 size_t PluginManager::load_plugins() {
+
+    nlohmann::json manifest = nlohmann::json::object();
+    bool manifest_changed   = false;
+    if (not manifest_path_.empty()) {
+        try {
+            std::ifstream i(manifest_path_);
+            if (i.good())
+                manifest = nlohmann::json::parse(i);
+        } catch (const std::exception &err) {
+            spdlog::warn("{} {} {}", __PRETTY_FUNCTION__, manifest_path_, err.what());
+        }
+    }
+
     // scan for .so for each path.
     size_t loaded = 0;
     for (const auto &path : plugin_paths_) {
@@ -28,63 +165,80 @@ size_t PluginManager::load_plugins() {
                     not(entry.path().extension() == ".so"))
                     continue;
 
-                // only want .so
-                // clear any errors..
-                dlerror();
+                const auto library = entry.path().string();
 
-                // open .so
-                void *hndl = dlopen(entry.path().c_str(), RTLD_NOW);
-                if (hndl == nullptr) {
-                    spdlog::warn("{} {}", __PRETTY_FUNCTION__, dlerror());
-                    continue;
+                if (not manifest_path_.empty()) {
+                    const auto stamp = library_stamp(entry.path());
+                    const auto p     = manifest.find(library);
+                    if (p != manifest.end() and p->value("stamp", nlohmann::json()) == stamp) {
+                        std::vector<std::shared_ptr<PluginFactory>> factories;
+                        for (const auto &detail : p->at("plugins"))
+                            factories.emplace_back(
+                                std::make_shared<ManifestPluginFactory>(detail, library));
+                        loaded += add_factories(factories, library);
+                        continue;
+                    }
                 }
 
-
-                plugin_factory_collection_ptr pfcp;
-                *(void **)(&pfcp) = dlsym(hndl, "plugin_factory_collection_ptr");
-                if (pfcp == nullptr) {
-                    spdlog::debug("{} {}", __PRETTY_FUNCTION__, dlerror());
-                    dlclose(hndl);
+                auto factories = open_library(library);
+                if (not factories)
                     continue;
-                }
+                loaded += add_factories(*factories, library);
 
-                PluginFactoryCollection *pfc = nullptr;
-                try {
-                    pfc = pfcp();
-                    for (const auto &i : pfc->factories()) {
-                        if (not factories_.count(i->uuid())) {
-                            // new plugin..
-                            loaded++;
-                            factories_.emplace(i->uuid(), PluginEntry(i, entry.path()));
-                            spdlog::debug(
-                                "Add plugin {} {} {}",
-                                to_string(i->uuid()),
-                                i->name(),
-                                entry.path().string());
-                        } else {
-                            spdlog::warn(
-                                "Ignore duplicate plugin {} {}",
-                                i->name(),
-                                entry.path().string());
-                        }
-                    }
-                } catch (const std::exception &err) {
-                    spdlog::warn(
-                        "{} Failed to init plugin {} {}",
-                        __PRETTY_FUNCTION__,
-                        entry.path().c_str(),
-                        err.what());
+                if (not manifest_path_.empty()) {
+                    auto plugins = nlohmann::json::array();
+                    for (const auto &i : *factories)
+                        plugins.push_back(describe(*i));
+                    manifest[library] = {
+                        {"stamp", library_stamp(entry.path())}, {"plugins", plugins}};
+                    manifest_changed = true;
                 }
-                if (pfc)
-                    delete pfc;
             }
         } catch (const std::exception &err) {
             spdlog::warn("{} {}", __PRETTY_FUNCTION__, err.what());
         }
     }
+
+    if (manifest_changed) {
+        try {
+            fs::create_directories(fs::path(manifest_path_).parent_path());
+            // written whole then moved into place, another instance may be
+            // reading it
+            const auto tmp = manifest_path_ + ".tmp";
+            std::ofstream(tmp) << manifest.dump(1);
+            fs::rename(tmp, manifest_path_);
+        } catch (const std::exception &err) {
+            spdlog::warn("{} {} {}", __PRETTY_FUNCTION__, manifest_path_, err.what());
+        }
+    }
+
     return loaded;
 }
 
+size_t PluginManager::add_factories(
+    const std::vector<std::shared_ptr<PluginFactory>> &factories, const std::string &path) {
+    size_t added = 0;
+    for (const auto &i : factories) {
+        if (not factories_.count(i->uuid())) {
+            // new plugin..
+            added++;
+            factories_.emplace(i->uuid(), PluginEntry(i, path));
+            spdlog::debug("Add plugin {} {} {}", to_string(i->uuid()), i->name(), path);
+        } else {
+            spdlog::warn("Ignore duplicate plugin {} {}", i->name(), path);
+        }
+    }
+    return added;
+}
+
+bool PluginManager::loaded(const utility::Uuid &uuid) const {
+    const auto p = factories_.find(uuid);
+    if (p == factories_.end())
+        return false;
+    const auto *lazy = dynamic_cast<const ManifestPluginFactory *>(p->second.factory());
+    return not lazy or lazy->loaded();
+}
+
 caf::actor PluginManager::spawn(
     caf::blocking_actor &sys,
     const utility::Uuid &uuid,
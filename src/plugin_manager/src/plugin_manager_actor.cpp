@@ -24,16 +24,21 @@ PluginManagerActor::PluginManagerActor(caf::actor_config &cfg) : caf::event_base
 
 
     manager_.emplace_front_path(xstudio_root("/plugin"));
-    manager_.load_plugins();
 
+    JsonStore js;
     try {
         auto prefs = GlobalStoreHelper(system());
-        JsonStore js;
         join_broadcast(this, prefs.get_group(js));
-        update_from_preferences(js);
+        // libraries are only opened when their plugins are first needed
+        if (preference_value<bool>(js, "/core/plugin_manager/lazy_load"))
+            manager_.set_manifest_path(config_path("plugin_manifest.json"));
     } catch (...) {
     }
 
+    manager_.load_plugins();
+    if (not js.is_null())
+        update_from_preferences(js);
+
     auto event_group_ = spawn<broadcast::BroadcastActor>(this);
     link_to(event_group_);
 
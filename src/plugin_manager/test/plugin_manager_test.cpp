@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: Apache-2.0
 #include <caf/all.hpp>
+#include <filesystem>
 #include <gtest/gtest.h>
 
 #include "xstudio/atoms.hpp"
@@ -17,6 +18,7 @@ using namespace caf;
 using namespace xstudio;
 using namespace xstudio::utility;
 using namespace xstudio::plugin_manager;
+namespace fs = std::filesystem;
 
 ACTOR_TEST_SETUP()
 
@@ -56,3 +58,34 @@ TEST(PluginManagerTest, Test) {
         EXPECT_EQ(name, "hello");
     }
 }
+
+TEST(PluginManagerTest, Manifest) {
+    fixture f;
+
+    const auto manifest =
+        (fs::temp_directory_path() / "xstudio_plugin_manifest_test.json").string();
+    fs::remove(manifest);
+    utility::Uuid test_uuid1("17e4323c-8ee7-4d9c-b74a-57ba805c10e8");
+
+    {
+        // no manifest yet, everything is opened and recorded
+        PluginManager pm(std::list<std::string>({{PLUGIN_DIR}}));
+        pm.set_manifest_path(manifest);
+        EXPECT_TRUE(pm.load_plugins());
+        EXPECT_TRUE(pm.loaded(test_uuid1));
+    }
+
+    PluginManager pm(std::list<std::string>({{PLUGIN_DIR}}));
+    pm.set_manifest_path(manifest);
+    EXPECT_TRUE(pm.load_plugins());
+
+    // described by the manifest, but not opened until it's needed
+    EXPECT_FALSE(pm.loaded(test_uuid1));
+    EXPECT_EQ(pm.factories().at(test_uuid1).factory()->name(), "hello");
+
+    auto actor1 = pm.spawn(*(f.self), test_uuid1);
+    EXPECT_TRUE(actor1);
+    EXPECT_TRUE(pm.loaded(test_uuid1));
+
+    fs::remove(manifest);
+}
@@ -54,6 +54,9 @@ void py_config::add_atoms() {
     ADD_ATOM(xstudio::broadcast, join_broadcast_atom);
     ADD_ATOM(xstudio::broadcast, leave_broadcast_atom);
     ADD_ATOM(xstudio::broadcast, broadcast_down_atom);
+    ADD_ATOM(xstudio::broadcast, broadcast_batch_atom);
+    ADD_ATOM(xstudio::broadcast, broadcast_stats_atom);
+    ADD_ATOM(xstudio::broadcast, supersede_broadcast_atom);
     ADD_ATOM(xstudio::sync, authorise_connection_atom);
     ADD_ATOM(xstudio::sync, get_sync_atom);
     ADD_ATOM(xstudio::sync, request_connection_atom);
@@ -105,6 +108,7 @@ void py_config::add_atoms() {
     ADD_ATOM(xstudio::playlist, get_playhead_atom);
     ADD_ATOM(xstudio::playlist, insert_container_atom);
     ADD_ATOM(xstudio::playlist, loading_media_atom);
+    ADD_ATOM(xstudio::playlist, materialise_atom);
     ADD_ATOM(xstudio::playlist, media_content_changed_atom);
     ADD_ATOM(xstudio::playlist, move_container_atom);
     ADD_ATOM(xstudio::playlist, move_container_to_atom);
@@ -135,10 +139,14 @@ void py_config::add_atoms() {
     ADD_ATOM(xstudio::session, export_atom);
     ADD_ATOM(xstudio::media_reader, clear_precache_queue_atom);
     ADD_ATOM(xstudio::media_reader, get_image_atom);
+    ADD_ATOM(xstudio::media_reader, export_image_atom);
+    ADD_ATOM(xstudio::media_reader, pixel_statistics_atom);
+    ADD_ATOM(xstudio::media_reader, get_filmstrip_atom);
     ADD_ATOM(xstudio::media_reader, get_thumbnail_atom);
     ADD_ATOM(xstudio::media_reader, process_thumbnail_atom);
     ADD_ATOM(xstudio::media_reader, get_media_detail_atom);
     ADD_ATOM(xstudio::media_reader, precache_audio_atom);
+    ADD_ATOM(xstudio::media_reader, precache_estimate_atom);
     ADD_ATOM(xstudio::media_reader, playback_precache_atom);
     ADD_ATOM(xstudio::media_reader, read_precache_image_atom);
     ADD_ATOM(xstudio::media_reader, do_precache_work_atom);
@@ -146,6 +154,7 @@ void py_config::add_atoms() {
     ADD_ATOM(xstudio::media_reader, push_image_atom);
     ADD_ATOM(xstudio::media_reader, retire_readers_atom);
     ADD_ATOM(xstudio::media_reader, supported_atom);
+    ADD_ATOM(xstudio::media_cache, cache_occupancy_atom);
     ADD_ATOM(xstudio::media_cache, cached_frames_atom);
     ADD_ATOM(xstudio::media_cache, count_atom);
     ADD_ATOM(xstudio::media_cache, erase_atom);
@@ -197,6 +206,7 @@ void py_config::add_atoms() {
     ADD_ATOM(xstudio::global, get_studio_atom);
     ADD_ATOM(xstudio::global, get_scanner_atom);
     ADD_ATOM(xstudio::global, remote_session_name_atom);
+    ADD_ATOM(xstudio::global, startup_timings_atom);
     ADD_ATOM(xstudio::global, status_atom);
     ADD_ATOM(xstudio::global, get_actor_from_registry_atom);
 
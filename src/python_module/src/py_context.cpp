@@ -1,10 +1,17 @@
 // SPDX-License-Identifier: Apache-2.0
 #pragma GCC diagnostic ignored "-Wattributes"
 
+#include <cstring>
+#include <ifaddrs.h>
+#include <netdb.h>
+#include <netinet/in.h>
+
+#include "xstudio/atoms.hpp"
 #include "xstudio/utility/logging.hpp"
 #include "xstudio/utility/caf_helpers.hpp"
 #include "xstudio/utility/helpers.hpp"
 #include "xstudio/global/global_actor.hpp"
+#include "xstudio/global/shm_transport.hpp"
 
 #include "py_opaque.hpp"
 #include "py_config.hpp"
@@ -27,6 +34,52 @@ template <class... Ts> void set_py_exception(Ts &&...xs) {
     throw std::runtime_error(oss.str().c_str());
 }
 
+namespace {
+bool same_address(const sockaddr *a, const sockaddr *b) {
+    if (a->sa_family != b->sa_family)
+        return false;
+    if (a->sa_family == AF_INET)
+        return reinterpret_cast<const sockaddr_in *>(a)->sin_addr.s_addr ==
+               reinterpret_cast<const sockaddr_in *>(b)->sin_addr.s_addr;
+    if (a->sa_family == AF_INET6)
+        return std::memcmp(
+                   &reinterpret_cast<const sockaddr_in6 *>(a)->sin6_addr,
+                   &reinterpret_cast<const sockaddr_in6 *>(b)->sin6_addr,
+                   sizeof(in6_addr)) == 0;
+    return false;
+}
+
+// does host resolve to loopback or one of our own interfaces
+bool is_local_host(const std::string &host) {
+    addrinfo hints{};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *resolved = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &resolved) != 0)
+        return false;
+
+    ifaddrs *interfaces = nullptr;
+    getifaddrs(&interfaces);
+
+    bool result = false;
+    for (auto i = resolved; i and not result; i = i->ai_next) {
+        if (i->ai_family == AF_INET)
+            result = (ntohl(reinterpret_cast<sockaddr_in *>(i->ai_addr)->sin_addr.s_addr) >>
+                      24) == 127;
+        else if (i->ai_family == AF_INET6)
+            result = IN6_IS_ADDR_LOOPBACK(&reinterpret_cast<sockaddr_in6 *>(i->ai_addr)->sin6_addr);
+
+        for (auto j = interfaces; j and not result; j = j->ifa_next)
+            result = j->ifa_addr and same_address(i->ai_addr, j->ifa_addr);
+    }
+
+    if (interfaces)
+        freeifaddrs(interfaces);
+    freeaddrinfo(resolved);
+    return result;
+}
+} // namespace
+
 py_context::py_context(int argc, char **argv)
     : py_config(argc, argv),
       py_local_system_(*this),
@@ -65,8 +118,10 @@ void py_context::py_send(const py::args &xs) {
     auto i    = xs.begin();
     auto dest = (*i).cast<actor>();
     auto msg  = py_build_message(xs);
-    if (msg)
+    if (msg) {
+        shm_before_middleman();
         self_->send(dest, *msg);
+    }
 }
 
 caf::actor py_context::py_spawn(const py::args &xs) {
@@ -109,6 +164,7 @@ void py_context::py_join(const py::args &xs) {
     auto grp = (*i).cast<group>();
 
     if (grp) {
+        shm_before_middleman();
         self_->join(grp);
         // spdlog::warn("{}", self_->joined_groups().size());
     }
@@ -174,6 +230,10 @@ uint64_t py_context::py_request(const py::args &xs) {
     auto dest = (*i).cast<actor>();
     auto msg  = py_build_message(xs);
     if (msg) {
+        if (auto id = shm_request(dest, *msg))
+            return id;
+
+        shm_before_middleman();
         auto reqhan = self_->request(dest, caf::infinite, *msg);
         return reqhan.id().request_id().integer_value();
     }
@@ -188,6 +248,7 @@ void py_context::py_send_exit(const py::args &xs) {
     auto i    = xs.begin();
     auto dest = (*i).cast<actor>();
     ++i;
+    shm_before_middleman();
     self_->send_exit(dest, caf::exit_reason::user_shutdown);
 }
 
@@ -223,14 +284,16 @@ py::tuple py_context::tuple_from_message(
             return py::tuple{};
         }
     }
-    if (mid.is_response())
+    if (mid.is_response()) {
+        shm_forget(mid);
         PyTuple_SetItem(
             result.ptr(), msg.size(), PyLong_FromSize_t(mid.request_id().integer_value()));
-    else if (mid.is_async())
+    } else if (mid.is_async()) {
         PyTuple_SetItem(
             result.ptr(), msg.size(), PyLong_FromSize_t(mid.response_id().integer_value()));
-    else
+    } else {
         PyTuple_SetItem(result.ptr(), msg.size(), PyLong_FromSize_t(0));
+    }
 
     PyTuple_SetItem(
         result.ptr(),
@@ -274,22 +337,155 @@ py_context::py_dequeue_with_timeout(xstudio::utility::absolute_receive_timeout t
 }
 
 void py_context::disconnect() {
+    disconnect_shared_memory();
     host_   = "";
     port_   = 0;
     remote_ = actor();
 }
 
-bool py_context::connect_remote(std::string host, uint16_t port) {
+bool py_context::connect_remote(std::string host, uint16_t port, bool shared_memory) {
     disconnect();
     auto actor = system_.middleman().remote_actor(host, port);
     if (actor) {
         remote_ = *actor;
         host_   = host;
         port_   = port;
+
+        if (shared_memory and is_local_host(host))
+            connect_shared_memory();
     }
     return static_cast<bool>(actor);
 }
 
+bool py_context::connect_shared_memory() {
+    // older servers, or ones with the transport disabled, answer with an
+    // error or an empty path and we stay on the middleman.
+    scoped_actor control{system_};
+    std::string path;
+    control->request(remote_, std::chrono::seconds(5), xstudio::global::shm_transport_atom_v)
+        .receive([&](const std::string &p) { path = p; }, [&](const error &) {});
+    if (path.empty())
+        return false;
+
+    xstudio::utility::ShmChannelPtr channel;
+    try {
+        channel = xstudio::utility::ShmChannel::connect(path);
+    } catch (const std::exception &err) {
+        spdlog::debug("{} {}", __PRETTY_FUNCTION__, err.what());
+        return false;
+    }
+
+    // responses that can't use the channel are sent to self_ directly
+    bool bound = false;
+    control
+        ->request(
+            remote_,
+            std::chrono::seconds(5),
+            xstudio::global::shm_transport_atom_v,
+            channel->token(),
+            caf::actor(self_))
+        .receive([&](const bool result) { bound = result; }, [&](const error &) {});
+    if (not bound)
+        return false;
+
+    shm_channel_ = channel;
+    shm_thread_  = std::thread(&py_context::shm_receive, this, channel);
+    return true;
+}
+
+void py_context::disconnect_shared_memory() {
+    if (shm_channel_) {
+        shm_channel_->close();
+        if (shm_thread_.joinable())
+            shm_thread_.join();
+        shm_channel_.reset();
+    }
+
+    std::lock_guard<std::mutex> lock(shm_mutex_);
+    shm_pending_.clear();
+    shm_fence_ = false;
+}
+
+uint64_t py_context::shm_request(const actor &dest, message &msg) {
+    auto channel = shm_channel_;
+    if (not channel or not channel->is_open() or not dest or dest.node() != remote_.node())
+        return 0;
+
+    auto mid = self_->new_request_id(message_priority::normal);
+    std::vector<std::byte> frame;
+    if (not xstudio::global::encode_shm_frame(frame, mid.integer_value(), dest.id(), msg))
+        return 0; // references actors, needs the middleman
+
+    if (shm_fence_.exchange(false)) {
+        // a round trip on the middleman connection guarantees everything we
+        // sent through it before has been delivered, so this can't overtake.
+        scoped_actor control{system_};
+        control
+            ->request(
+                remote_,
+                std::chrono::seconds(5),
+                xstudio::global::shm_transport_atom_v,
+                channel->token(),
+                caf::actor(self_))
+            .receive([](const bool) {}, [](const error &) {});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(shm_mutex_);
+        shm_pending_[mid.request_id().integer_value()] = actor_cast<strong_actor_ptr>(dest);
+    }
+
+    if (not channel->send(frame)) {
+        std::lock_guard<std::mutex> lock(shm_mutex_);
+        shm_pending_.erase(mid.request_id().integer_value());
+        return 0;
+    }
+
+    return mid.request_id().integer_value();
+}
+
+void py_context::shm_before_middleman() {
+    if (auto channel = shm_channel_) {
+        // let the server dispatch what's already in the ring first.
+        channel->wait_acknowledged();
+        shm_fence_ = true;
+    }
+}
+
+void py_context::shm_receive(xstudio::utility::ShmChannelPtr channel) {
+    std::vector<std::byte> frame;
+    while (channel->receive(frame)) {
+        uint64_t id         = 0;
+        actor_id unused_aid = 0;
+        message msg;
+
+        if (xstudio::global::decode_shm_frame(frame, id, unused_aid, msg)) {
+            auto mid = make_message_id(id);
+            strong_actor_ptr sender;
+            {
+                std::lock_guard<std::mutex> lock(shm_mutex_);
+                auto it = shm_pending_.find(mid.request_id().integer_value());
+                if (it != shm_pending_.end()) {
+                    sender = it->second;
+                    shm_pending_.erase(it);
+                }
+            }
+            self_->enqueue(
+                make_mailbox_element(sender, mid.response_id(), {}, std::move(msg)), nullptr);
+        } else {
+            spdlog::warn("{} Failed to decode shared memory response", __PRETTY_FUNCTION__);
+        }
+        channel->acknowledge();
+    }
+}
+
+void py_context::shm_forget(const message_id mid) {
+    if (shm_channel_) {
+        std::lock_guard<std::mutex> lock(shm_mutex_);
+        shm_pending_.erase(mid.request_id().integer_value());
+    }
+}
+
 bool py_context::connect_local(caf::actor actor) {
     disconnect();
     remote_ = actor;
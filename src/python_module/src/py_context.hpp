@@ -16,7 +16,13 @@ CAF_PUSH_WARNINGS
 #include <pybind11/chrono.h>
 CAF_POP_WARNINGS
 
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
 #include "xstudio/utility/caf_helpers.hpp"
+#include "xstudio/utility/shm_channel.hpp"
 
 namespace caf::python {
 
@@ -55,10 +61,11 @@ class py_context : public py_config {
     // xstudio::utility::version_atom_v;
     // }
 
-    bool connect_remote(std::string host, uint16_t port);
+    bool connect_remote(std::string host, uint16_t port, bool shared_memory = true);
     bool connect_local(caf::actor actor);
     std::string host() { return host_; }
     uint16_t port() { return port_; }
+    bool shared_memory() { return shm_channel_ and shm_channel_->is_open(); }
 
   public:
     std::string host_;
@@ -84,6 +91,25 @@ class py_context : public py_config {
 
     scoped_actor self_;
     actor remote_;
+
+  private:
+    // same host fast path, see xstudio::global::ShmTransportServer
+    bool connect_shared_memory();
+    void disconnect_shared_memory();
+    uint64_t shm_request(const actor &dest, message &msg);
+    void shm_before_middleman();
+    void shm_receive(xstudio::utility::ShmChannelPtr channel);
+    void shm_forget(const message_id mid);
+
+    xstudio::utility::ShmChannelPtr shm_channel_;
+    std::thread shm_thread_;
+    std::mutex shm_mutex_;
+    std::map<uint64_t, strong_actor_ptr> shm_pending_;
+    // a message went through the middleman since the last shared memory
+    // request, the next one has to wait for it to be delivered.
+    std::atomic<bool> shm_fence_{false};
+
+  public:
     py::function my_func;
     std::thread my_thread;
 };
@@ -23,7 +23,12 @@ namespace py = pybind11;
 void py_link(py::module_ &m) {
     py::class_<caf::python::py_context>(m, "Link")
         .def(py::init<>())
-        .def("connect_remote", &caf::python::py_context::connect_remote)
+        .def(
+            "connect_remote",
+            &caf::python::py_context::connect_remote,
+            py::arg("host"),
+            py::arg("port"),
+            py::arg("shared_memory") = true)
         .def("connect_local", &caf::python::py_context::connect_local)
         .def("disconnect", &caf::python::py_context::disconnect)
         .def("send", &caf::python::py_context::py_send, "Sends a message to an actor")
@@ -55,5 +60,9 @@ void py_link(py::module_ &m) {
         .def("remote", &caf::python::py_context::py_remote, "Returns the remote handle")
         .def("set_remote", &caf::python::py_context::py_set_remote, "Set the remote handle")
         .def("host", &caf::python::py_context::host, "Remote host")
-        .def("port", &caf::python::py_context::port, "Remote port");
+        .def("port", &caf::python::py_context::port, "Remote port")
+        .def(
+            "shared_memory",
+            &caf::python::py_context::shared_memory,
+            "Requests use the same host shared memory transport");
 }
\ No newline at end of file
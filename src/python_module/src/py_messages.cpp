@@ -8,6 +8,7 @@
 #include "py_opaque.hpp"
 
 #include "xstudio/global_store/global_store.hpp"
+#include "xstudio/media_reader/image_buffer_export.hpp"
 #include "xstudio/playhead/playhead.hpp"
 #include "xstudio/playlist/playlist.hpp"
 #include "xstudio/ui/mouse.hpp"
@@ -31,6 +32,7 @@ extern void register_plugindetail_class(py::module &m, const std::string &name);
 extern void register_playlisttree_class(py::module &m, const std::string &name);
 extern void register_thumbnailbuffer_class(py::module &m, const std::string &name);
 extern void register_streamdetail_class(py::module &m, const std::string &name);
+extern void register_imagebufferexport_class(py::module &m, const std::string &name);
 extern void register_timecode_class(py::module &m, const std::string &name);
 extern void register_mediareference_class(py::module &m, const std::string &name);
 extern void register_bookmark_detail_class(py::module &m, const std::string &name);
@@ -144,6 +146,17 @@ void py_config::add_messages() {
         "xstudio::thumbnail::ThumbnailBuffer",
         &register_thumbnailbuffer_class);
 
+    add_message_type<media_reader::BufferExportMode>(
+        "BufferExportMode", "xstudio::media_reader::BufferExportMode", nullptr);
+
+    add_message_type<media_reader::ImageBufferExport>(
+        "ImageBufferExport",
+        "xstudio::media_reader::ImageBufferExport",
+        &register_imagebufferexport_class);
+
+    add_message_type<std::vector<media_reader::ImageBufferExport>>(
+        "ImageBufferExportVec", "std::vector<xstudio::media_reader::ImageBufferExport>", nullptr);
+
     add_message_type<xstudio::timeline::Item>(
         "Item", "xstudio::timeline::Item", &register_item_class);
 
@@ -44,6 +44,12 @@ void py_playhead(py::module_ &m) {
         .value("MS_UNREADABLE", media::MediaStatus::MS_UNREADABLE)
         .export_values();
 
+    py::enum_<media_reader::BufferExportMode>(m, "BufferExportMode")
+        .value("BEM_INLINE", media_reader::BufferExportMode::BEM_INLINE)
+        .value("BEM_SHARED_MEMORY", media_reader::BufferExportMode::BEM_SHARED_MEMORY)
+        .value("BEM_IN_PROCESS", media_reader::BufferExportMode::BEM_IN_PROCESS)
+        .export_values();
+
     py::enum_<playhead::OverflowMode>(m, "OverflowMode")
         .value("OM_FAIL", playhead::OverflowMode::OM_FAIL)
         .value("OM_NULL", playhead::OverflowMode::OM_NULL)
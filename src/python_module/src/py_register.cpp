@@ -20,6 +20,7 @@ CAF_POP_WARNINGS
 
 #include "xstudio/bookmark/bookmark.hpp"
 #include "xstudio/global_store/global_store.hpp"
+#include "xstudio/media_reader/image_buffer_export.hpp"
 #include "xstudio/playlist/playlist.hpp"
 #include "xstudio/plugin_manager/plugin_manager.hpp"
 #include "xstudio/thumbnail/thumbnail.hpp"
@@ -145,6 +146,79 @@ void register_thumbnailbuffer_class(py::module &m, const std::string &name) {
         .def("data", &thumbnail::ThumbnailBuffer::data);
 }
 
+// a single plane of an ImageBufferExport, exposed through the buffer protocol
+// so numpy.asarray() / memoryview() share the exported pixels
+struct ImageBufferPlaneView {
+    const media_reader::ImageBufferExport *parent_;
+    size_t index_;
+};
+
+py::buffer_info image_buffer_plane_info(const ImageBufferPlaneView &view) {
+    if (view.parent_->has_error())
+        throw std::runtime_error(view.parent_->error());
+    if (view.index_ >= view.parent_->planes().size())
+        throw py::index_error("Plane index out of range");
+
+    const auto &plane = view.parent_->planes()[view.index_];
+    const auto *data  = view.parent_->data();
+    if (not data)
+        throw std::runtime_error("Image buffer has no pixel data");
+
+    return py::buffer_info(
+        const_cast<std::byte *>(data + plane.byte_offset_),
+        static_cast<py::ssize_t>(plane.item_size()),
+        media_reader::pixel_data_type_format(plane.data_type_),
+        3,
+        {static_cast<py::ssize_t>(plane.height_),
+         static_cast<py::ssize_t>(plane.width_),
+         static_cast<py::ssize_t>(plane.channels_)},
+        {static_cast<py::ssize_t>(plane.row_stride_),
+         static_cast<py::ssize_t>(plane.pixel_stride_),
+         static_cast<py::ssize_t>(plane.item_size())},
+        true);
+}
+
+void register_imagebufferexport_class(py::module &m, const std::string &name) {
+    py::class_<ImageBufferPlaneView>(m, (name + "Plane").c_str(), py::buffer_protocol())
+        .def_buffer(&image_buffer_plane_info)
+        .def(
+            "name",
+            [](const ImageBufferPlaneView &x) {
+                return x.parent_->planes().at(x.index_).name_;
+            })
+        .def("shape", [](const ImageBufferPlaneView &x) {
+            const auto &plane = x.parent_->planes().at(x.index_);
+            return std::vector<size_t>({plane.height_, plane.width_, plane.channels_});
+        });
+
+    py::class_<media_reader::ImageBufferExport>(m, name.c_str(), py::buffer_protocol())
+        .def(py::init<>())
+        .def_buffer([](const media_reader::ImageBufferExport &x) {
+            return image_buffer_plane_info(ImageBufferPlaneView{&x, 0});
+        })
+        .def("key", [](const media_reader::ImageBufferExport &x) { return to_string(x.key()); })
+        .def("width", &media_reader::ImageBufferExport::width)
+        .def("height", &media_reader::ImageBufferExport::height)
+        .def("pixel_aspect", &media_reader::ImageBufferExport::pixel_aspect)
+        .def("channel_names", &media_reader::ImageBufferExport::channel_names)
+        .def("error", &media_reader::ImageBufferExport::error)
+        .def("has_error", &media_reader::ImageBufferExport::has_error)
+        .def("size", &media_reader::ImageBufferExport::size)
+        .def("mode", &media_reader::ImageBufferExport::mode)
+        .def(
+            "plane_count",
+            [](const media_reader::ImageBufferExport &x) { return x.planes().size(); })
+        .def(
+            "plane",
+            [](const media_reader::ImageBufferExport &x, const size_t index) {
+                if (index >= x.planes().size())
+                    throw py::index_error("Plane index out of range");
+                return ImageBufferPlaneView{&x, index};
+            },
+            py::keep_alive<0, 1>(),
+            py::arg("index") = 0);
+}
+
 void register_streamdetail_class(py::module &m, const std::string &name) {
     auto str_impl = [](const media::StreamDetail &x) { return to_string(x); };
     py::class_<media::StreamDetail>(m, name.c_str())
@@ -16,6 +16,7 @@
 #include "xstudio/tag/tag_actor.hpp"
 #include "xstudio/utility/helpers.hpp"
 #include "xstudio/utility/logging.hpp"
+#include "xstudio/utility/session_file.hpp"
 #include "xstudio/thumbnail/thumbnail.hpp"
 
 using namespace xstudio;
@@ -314,7 +315,7 @@ bool LoadUrisActor::load_uris(const bool single_playlist) {
                 [=](UuidUuidActor playlist) {
                     for (const auto &i : uris_) {
                         fs::path p(uri_to_posix_path(i));
-                        if (p.extension() != ".xst")
+                        if (not is_session_file_path(p.string()))
                             anon_send(
                                 playlist.second.actor(),
                                 playlist::add_media_atom_v,
@@ -347,7 +348,7 @@ bool LoadUrisActor::load_uris(const bool single_playlist) {
                         });
 
             } else {
-                if (p.extension() == ".xst")
+                if (is_session_file_path(p.string()))
                     anon_send(session_, merge_session_atom_v, i);
                 else
                     has_files = true;
@@ -360,7 +361,7 @@ bool LoadUrisActor::load_uris(const bool single_playlist) {
                     [=](UuidUuidActor playlist) {
                         for (const auto &i : uris_) {
                             fs::path p(uri_to_posix_path(i));
-                            if (!fs::is_directory(p) and p.extension() != ".xst")
+                            if (!fs::is_directory(p) and not is_session_file_path(p.string()))
                                 anon_send(
                                     playlist.second.actor(),
                                     playlist::add_media_atom_v,
@@ -416,13 +417,28 @@ SessionActor::SessionActor(
     join_event_group(this, tags_);
     link_to(tags_);
 
+    // lazy playlists only spawn their media when first used, the rest are
+    // filled in one at a time in the background.
+    auto lazy = false;
+    try {
+        auto prefs          = GlobalStoreHelper(system());
+        lazy                = prefs.value<bool>("/core/session/lazy_load");
+        lazy_load_interval_ = std::chrono::milliseconds(
+            prefs.value<int>("/core/session/lazy_load_interval"));
+    } catch (...) {
+    }
+
     for (const auto &[key, value] : jsn["actors"].items()) {
         if (value["base"]["container"]["type"] == "Playlist") {
             try {
                 playlists_[key] = spawn<playlist::PlaylistActor>(
-                    static_cast<utility::JsonStore>(value), caf::actor_cast<caf::actor>(this));
+                    static_cast<utility::JsonStore>(value),
+                    caf::actor_cast<caf::actor>(this),
+                    lazy);
                 link_to(playlists_[key]);
                 join_event_group(this, playlists_[key]);
+                if (lazy)
+                    lazy_playlists_.insert(Uuid(key));
             } catch (const std::exception &e) {
                 spdlog::error("{}", e.what());
             }
@@ -431,6 +447,12 @@ SessionActor::SessionActor(
 
     init();
 
+    if (not lazy_playlists_.empty())
+        delayed_anon_send(
+            caf::actor_cast<caf::actor>(this),
+            lazy_load_interval_,
+            playlist::materialise_atom_v);
+
     check_media_hook_plugin_version(jsn, path);
 }
 
@@ -621,34 +643,52 @@ caf::message_handler SessionActor::message_handler() {
             return caf::actor();
         },
 
+        [=](playlist::materialise_atom) {
+            // spawn the contents of the next lazy playlist, in session order,
+            // one at a time and spaced out so the UI stays responsive.
+            for (const auto &i : ordered_playlists()) {
+                if (lazy_playlists_.count(i.uuid())) {
+                    auto next = [=]() {
+                        lazy_playlists_.erase(i.uuid());
+                        delayed_anon_send(
+                            caf::actor_cast<caf::actor>(this),
+                            lazy_load_interval_,
+                            playlist::materialise_atom_v);
+                    };
+                    request(i.actor(), infinite, playlist::materialise_atom_v)
+                        .then(
+                            [=](const bool) mutable { next(); },
+                            [=](const error &err) mutable {
+                                spdlog::warn("{} {}", __PRETTY_FUNCTION__, to_string(err));
+                                next();
+                            });
+                    return;
+                }
+            }
+            lazy_playlists_.clear();
+        },
+
+        [=](playlist::materialise_atom, const utility::Uuid &uuid) {
+            // a lazy playlist has spawned its media, on first use or from the
+            // sweep above, which can have bookmarks now.
+            lazy_playlists_.erase(uuid);
+            if (not playlists_.count(uuid))
+                return;
+            request(playlists_[uuid], infinite, playlist::get_media_atom_v)
+                .then(
+                    [=](const UuidActorVector &media) {
+                        anon_send(bookmarks_, bookmark::associate_bookmark_atom_v, media);
+                    },
+                    [=](const error &err) {
+                        spdlog::warn("{} {}", __PRETTY_FUNCTION__, to_string(err));
+                    });
+        },
+
         [=](get_playlists_atom) -> std::vector<UuidActor> {
             // We use this method to build a list of playlist names for secondary UI playlist
             // menus and so-on. We want out list of playlists in these menus to match the order
             // of playlists in the session tree view.
-
-            // flatten the tree of containers to a straight (ordered) list of
-            // value uuids
-            std::function<void(const PlaylistTree &, std::vector<Uuid> &)> flatten_tree;
-            flatten_tree = [&flatten_tree](const PlaylistTree &tree, std::vector<Uuid> &rt) {
-                rt.push_back(tree.value_uuid());
-                for (auto i : tree.children_ref()) {
-                    flatten_tree(i, rt);
-                }
-            };
-
-            std::vector<Uuid> ordered_uuids;
-            flatten_tree(base_.containers(), ordered_uuids);
-
-            // make a list of the playlist actors that reflects their order
-            // in the tree
-            std::vector<UuidActor> actors;
-            for (const auto &i : ordered_uuids) {
-                auto p = playlists_.find(i);
-                if (p != playlists_.end()) {
-                    actors.emplace_back(p->first, p->second);
-                }
-            }
-            return actors;
+            return ordered_playlists();
         },
 
         [=](global_store::save_atom atom) {
@@ -875,9 +915,7 @@ caf::message_handler SessionActor::message_handler() {
             auto rp = make_response_promise<UuidVector>();
 
             try {
-                JsonStore js;
-                std::ifstream i(uri_to_posix_path(path));
-                i >> js;
+                JsonStore js(read_session_file(uri_to_posix_path(path)));
                 auto session = spawn<session::SessionActor>(js, path);
                 rp.delegate(actor_cast<caf::actor>(this), merge_session_atom_v, session);
             } catch (const std::exception &err) {
@@ -1866,17 +1904,8 @@ void SessionActor::save_json_to(
     size_t new_hash = 0;
 
     try {
-        auto data = js.dump(2);
-
         auto resolve_link = false;
-        new_hash          = std::hash<std::string>{}(data);
-
-        // no change in hash, so skip save (autosave)
-        if (new_hash == hash) {
-            return rp.deliver(new_hash);
-        }
-
-        auto ppath = utility::posix_path_to_uri(utility::uri_to_posix_path(path));
+        auto ppath        = utility::posix_path_to_uri(utility::uri_to_posix_path(path));
 
         // try and save, we are already looking at this file
         if (update_path) {
@@ -1884,29 +1913,50 @@ void SessionActor::save_json_to(
             resolve_link = true;
         }
 
-
         auto save_path = uri_to_posix_path(ppath);
         if (resolve_link && fs::exists(save_path) && fs::is_symlink(save_path))
             save_path = fs::canonical(save_path);
 
-        // this maybe a symlink in which case we should resolve it.
-        std::ofstream o(save_path + ".tmp");
-        try {
-            o.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-            // if(not o.is_open())
-            //     throw std::runtime_error();
-            o << std::setw(4) << data << std::endl;
-            o.close();
-        } catch (const std::exception &) {
-            // remove failed file
-            if (o.is_open()) {
+        if (is_session_container_path(save_path)) {
+            // binary session, only chunks that changed since the last save
+            // are compressed and written.
+            auto base   = fs::exists(save_path) ? save_path : last_container_path_;
+            auto result = write_session_container(save_path, js, hash, base);
+            new_hash    = result.hash;
+
+            // no change in hash, so skip save (autosave)
+            if (not result.written)
+                return rp.deliver(new_hash);
+
+            last_container_path_ = save_path;
+        } else {
+            auto data = js.dump(2);
+            new_hash  = std::hash<std::string>{}(data);
+
+            // no change in hash, so skip save (autosave)
+            if (new_hash == hash) {
+                return rp.deliver(new_hash);
+            }
+
+            // this maybe a symlink in which case we should resolve it.
+            std::ofstream o(save_path + ".tmp");
+            try {
+                o.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+                // if(not o.is_open())
+                //     throw std::runtime_error();
+                o << std::setw(4) << data << std::endl;
                 o.close();
-                fs::remove(save_path + ".tmp");
+            } catch (const std::exception &) {
+                // remove failed file
+                if (o.is_open()) {
+                    o.close();
+                    fs::remove(save_path + ".tmp");
+                }
+                throw std::runtime_error("Failed to open file");
             }
-            throw std::runtime_error("Failed to open file");
+            // rename tmp to final name
+            fs::rename(save_path + ".tmp", save_path);
         }
-        // rename tmp to final name
-        fs::rename(save_path + ".tmp", save_path);
 
         if (update_path) {
             base_.set_filepath(path);
@@ -1925,8 +1975,43 @@ void SessionActor::save_json_to(
     rp.deliver(new_hash);
 }
 
+std::vector<UuidActor> SessionActor::ordered_playlists() const {
+    // flatten the tree of containers to a straight (ordered) list of
+    // value uuids
+    std::function<void(const PlaylistTree &, std::vector<Uuid> &)> flatten_tree;
+    flatten_tree = [&flatten_tree](const PlaylistTree &tree, std::vector<Uuid> &rt) {
+        rt.push_back(tree.value_uuid());
+        for (auto i : tree.children_ref()) {
+            flatten_tree(i, rt);
+        }
+    };
+
+    std::vector<Uuid> ordered_uuids;
+    flatten_tree(base_.containers(), ordered_uuids);
+
+    // make a list of the playlist actors that reflects their order
+    // in the tree
+    std::vector<UuidActor> actors;
+    for (const auto &i : ordered_uuids) {
+        auto p = playlists_.find(i);
+        if (p != playlists_.end()) {
+            actors.emplace_back(p->first, p->second);
+        }
+    }
+    return actors;
+}
+
 void SessionActor::associate_bookmarks(caf::typed_response_promise<int> &rp) {
-    fan_out_request<policy::select_all>(playlists(), infinite, playlist::get_media_atom_v)
+    // lazy playlists have no media to associate yet, don't wake them up.
+    std::vector<caf::actor> loaded;
+    for (const auto &[uuid, actor] : playlists_)
+        if (not lazy_playlists_.count(uuid))
+            loaded.push_back(actor);
+
+    if (loaded.empty())
+        return rp.deliver(0);
+
+    fan_out_request<policy::select_all>(loaded, infinite, playlist::get_media_atom_v)
         .then(
             [=](std::vector<std::vector<UuidActor>> media_ua) mutable {
                 // turn into single vector..
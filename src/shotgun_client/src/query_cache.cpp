@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+
+#include "xstudio/shotgun_client/query_cache.hpp"
+#include "xstudio/utility/helpers.hpp"
+#include "xstudio/utility/logging.hpp"
+
+using namespace xstudio::shotgun_client;
+using namespace xstudio::utility;
+
+QueryCache::QueryCache(const std::chrono::seconds default_ttl, const size_t max_entries)
+    : default_ttl_(default_ttl), max_entries_(max_entries) {}
+
+std::string QueryCache::normalise_entity(const std::string &entity) {
+    auto result = entity;
+    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) {
+        return std::tolower(c);
+    });
+    if (result.size() > 1 and result.back() == 's')
+        result.pop_back();
+    return result;
+}
+
+std::string QueryCache::key(
+    const std::string &entity, const std::string &kind, const nlohmann::json &query) {
+    return normalise_entity(entity) + "/" + kind + "/" + query.dump();
+}
+
+void QueryCache::set_ttl(const std::string &entity, const std::chrono::seconds ttl) {
+    if (entity.empty())
+        default_ttl_ = ttl;
+    else
+        ttls_[normalise_entity(entity)] = ttl;
+}
+
+std::chrono::seconds QueryCache::ttl(const std::string &entity) const {
+    auto it = ttls_.find(normalise_entity(entity));
+    return it == ttls_.end() ? default_ttl_ : it->second;
+}
+
+bool QueryCache::expired(const Entry &entry, const clock::time_point now) const {
+    return entry.stored + ttl(entry.entity) <= now;
+}
+
+const QueryCache::Entry *QueryCache::get(const std::string &key, const clock::time_point now) {
+    auto it = entries_.find(key);
+    if (it == entries_.end() or expired(it->second, now)) {
+        misses_++;
+        return nullptr;
+    }
+    hits_++;
+    return &(it->second);
+}
+
+const QueryCache::Entry *QueryCache::find(const std::string &key) const {
+    auto it = entries_.find(key);
+    return it == entries_.end() ? nullptr : &(it->second);
+}
+
+void QueryCache::put(
+    const std::string &key,
+    const std::string &entity,
+    const JsonStore &value,
+    const std::string &etag,
+    const clock::time_point now) {
+    if (ttl(entity).count() <= 0)
+        return;
+
+    entries_[key] = Entry{normalise_entity(entity), value, etag, now};
+    evict();
+}
+
+void QueryCache::revalidated(const std::string &key, const clock::time_point now) {
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        it->second.stored = now;
+        revalidations_++;
+    }
+}
+
+void QueryCache::invalidate(const std::string &entity) {
+    const auto name = normalise_entity(entity);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.entity == name) {
+            it = entries_.erase(it);
+            invalidations_++;
+        } else
+            ++it;
+    }
+}
+
+void QueryCache::clear() { entries_.clear(); }
+
+void QueryCache::evict() {
+    // oldest first
+    while (entries_.size() > max_entries_) {
+        auto oldest = std::min_element(
+            entries_.begin(), entries_.end(), [](const auto &a, const auto &b) {
+                return a.second.stored < b.second.stored;
+            });
+        entries_.erase(oldest);
+    }
+}
+
+JsonStore QueryCache::stats() const {
+    JsonStore result;
+    result["entries"]       = entries_.size();
+    result["hits"]          = hits_;
+    result["misses"]        = misses_;
+    result["revalidations"] = revalidations_;
+    result["invalidations"] = invalidations_;
+    return result;
+}
+
+JsonStore QueryCache::serialise() const {
+    JsonStore result(nlohmann::json::array());
+    for (const auto &[key, entry] : entries_) {
+        nlohmann::json j;
+        j["key"]    = key;
+        j["entity"] = entry.entity;
+        j["value"]  = static_cast<const nlohmann::json &>(entry.value);
+        j["etag"]   = entry.etag;
+        j["stored"] = std::chrono::duration_cast<std::chrono::seconds>(
+                          entry.stored.time_since_epoch())
+                          .count();
+        result.push_back(j);
+    }
+    return result;
+}
+
+void QueryCache::deserialise(const JsonStore &jsn, const clock::time_point now) {
+    for (const auto &j : jsn) {
+        Entry entry{
+            j.at("entity").get<std::string>(),
+            JsonStore(j.at("value")),
+            j.at("etag").get<std::string>(),
+            clock::time_point(std::chrono::seconds(j.at("stored").get<int64_t>()))};
+
+        // skip expired entries we can't revalidate, and keys from older caches
+        if ((entry.etag.empty() and expired(entry, now)) or not j.at("key").is_string())
+            continue;
+        entries_[j.at("key").get<std::string>()] = std::move(entry);
+    }
+    evict();
+}
+
+bool QueryCache::save(const std::string &path) const {
+    try {
+        std::ofstream o(path);
+        o.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        o << serialise().dump() << std::endl;
+        o.close();
+        return true;
+    } catch (const std::exception &err) {
+        spdlog::warn("{} {} {}", __PRETTY_FUNCTION__, path, err.what());
+    }
+    return false;
+}
+
+bool QueryCache::load(const std::string &path) {
+    try {
+        std::ifstream i(path);
+        if (not i.is_open())
+            return false;
+        deserialise(JsonStore(nlohmann::json::parse(i)));
+        return true;
+    } catch (const std::exception &err) {
+        spdlog::warn("{} {} {}", __PRETTY_FUNCTION__, path, err.what());
+    }
+    return false;
+}
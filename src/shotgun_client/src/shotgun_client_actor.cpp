@@ -187,6 +187,7 @@ void ShotgunClientActor::init() {
             const JsonStore &body) -> result<JsonStore> {
             auto rp = make_response_promise<JsonStore>();
             // spdlog::warn("shotgun_update_entity_atom");
+            cache_.invalidate(entity);
             request(
                 http_,
                 infinite,
@@ -198,6 +199,8 @@ void ShotgunClientActor::init() {
                 base_.content_type_json())
                 .then(
                     [=](const httplib::Response &response) mutable {
+                        // reads that ran alongside the write may have cached old values
+                        cache_.invalidate(entity);
                         try {
                             auto jsn = nlohmann::json::parse(response.body);
 
@@ -247,6 +250,7 @@ void ShotgunClientActor::init() {
             const JsonStore &body) -> result<JsonStore> {
             // spdlog::warn("shotgun_create_entity_atom");
             auto rp = make_response_promise<JsonStore>();
+            cache_.invalidate(entity);
             request(
                 http_,
                 infinite,
@@ -258,6 +262,8 @@ void ShotgunClientActor::init() {
                 base_.content_type_json())
                 .then(
                     [=](const httplib::Response &response) mutable {
+                        // reads that ran alongside the write may have cached old values
+                        cache_.invalidate(entity);
                         try {
                             auto jsn = nlohmann::json::parse(response.body);
 
@@ -493,16 +499,54 @@ void ShotgunClientActor::init() {
                     */
                     // requires authentication..
 
+                    const auto query = nlohmann::json{
+                        {"filter", filter},
+                        {"fields", fields},
+                        {"sort", sort},
+                        {"page", page},
+                        {"page_size", page_size}};
+                    const auto key = QueryCache::key(entity, "filter", query);
+                    if (from_cache(key, rp))
+                        return rp;
+
+                    auto next           = query;
+                    next["page"]        = page + 1;
+                    const auto next_key = QueryCache::key(entity, "filter", next);
+
+                    // warm the cache with the next page, the result is dropped
+                    const auto prefetch_next = [=](const JsonStore &result) {
+                        if (should_prefetch(key, next_key, result, page, page_size))
+                            request(
+                                actor_cast<caf::actor>(this),
+                                infinite,
+                                shotgun_entity_filter_atom_v,
+                                entity,
+                                filter,
+                                fields,
+                                sort,
+                                page + 1,
+                                page_size)
+                                .then([=](const JsonStore &) {}, [=](const error &) {});
+                    };
+
                     request(
                         http_,
                         infinite,
                         http_get_atom_v,
                         base_.scheme_host_port(),
                         std::string("/api/v1/entity/" + entity),
-                        base_.get_auth_headers(),
+                        query_headers(key),
                         params)
                         .then(
                             [=](const httplib::Response &response) mutable {
+                                if (response.status == 304 and cache_.find(key)) {
+                                    cache_.revalidated(key);
+                                    const auto result = cache_.find(key)->value;
+                                    deliver_query(key, entity, result, cache_.find(key)->etag);
+                                    prefetch_next(result);
+                                    return;
+                                }
+
                                 try {
                                     auto jsn = nlohmann::json::parse(response.body);
 
@@ -510,6 +554,7 @@ void ShotgunClientActor::init() {
                                         if (not jsn["errors"][0]["status"].is_null() and
                                             jsn["errors"][0]["status"].get<int>() == 401) {
                                             // try and authorise..
+                                            auto waiting = take_waiting(key);
                                             request(
                                                 actor_cast<caf::actor>(this),
                                                 infinite,
@@ -518,36 +563,45 @@ void ShotgunClientActor::init() {
                                                     [=](const std::pair<
                                                         std::string,
                                                         std::string>) mutable {
-                                                        rp.delegate(
-                                                            actor_cast<caf::actor>(this),
-                                                            shotgun_entity_filter_atom_v,
-                                                            entity,
-                                                            filter,
-                                                            fields,
-                                                            sort,
-                                                            page,
-                                                            page_size);
+                                                        for (auto &w : waiting)
+                                                            w.delegate(
+                                                                actor_cast<caf::actor>(this),
+                                                                shotgun_entity_filter_atom_v,
+                                                                entity,
+                                                                filter,
+                                                                fields,
+                                                                sort,
+                                                                page,
+                                                                page_size);
                                                     },
                                                     [=](error &err) mutable {
                                                         spdlog::warn(
                                                             "{} {}",
                                                             __PRETTY_FUNCTION__,
                                                             to_string(err));
-                                                        rp.deliver(JsonStore(std::move(jsn)));
+                                                        for (auto &w : waiting)
+                                                            w.deliver(JsonStore(jsn));
                                                     });
+                                            prefetching_.erase(key);
                                             return;
                                         }
 
                                     } catch (const std::exception &err) {
                                         spdlog::warn("{} {}", __PRETTY_FUNCTION__, err.what());
                                     }
-                                    rp.deliver(JsonStore(std::move(jsn)));
+                                    const auto result = JsonStore(std::move(jsn));
+                                    deliver_query(
+                                        key, entity, result, response.get_header_value("ETag"));
+
+                                    prefetch_next(result);
                                 } catch (const std::exception &err) {
-                                    rp.deliver(make_error(
-                                        sce::response_error, err.what() + response.body));
+                                    deliver_query(
+                                        key,
+                                        make_error(
+                                            sce::response_error, err.what() + response.body));
                                 }
                             },
-                            [=](error &err) mutable { rp.deliver(std::move(err)); });
+                            [=](error &err) mutable { deliver_query(key, err); });
                 } catch (const std::exception &err) {
                     return make_error(sce::args_error, err.what());
                 }
@@ -609,6 +663,30 @@ void ShotgunClientActor::init() {
 
                 // spdlog::warn("{}", jsn.dump(2));
 
+                const auto key = QueryCache::key(entity, "search", jsn);
+                if (from_cache(key, rp))
+                    return rp;
+
+                auto next              = jsn;
+                next["page"]["number"] = page + 1;
+                const auto next_key    = QueryCache::key(entity, "search", next);
+
+                // warm the cache with the next page, the result is dropped
+                const auto prefetch_next = [=](const JsonStore &result) {
+                    if (should_prefetch(key, next_key, result, page, page_size))
+                        request(
+                            actor_cast<caf::actor>(this),
+                            infinite,
+                            shotgun_entity_search_atom_v,
+                            entity,
+                            conditions,
+                            fields,
+                            sort,
+                            page + 1,
+                            page_size)
+                            .then([=](const JsonStore &) {}, [=](const error &) {});
+                };
+
                 // requires authentication..
                 request(
                     http_,
@@ -616,11 +694,19 @@ void ShotgunClientActor::init() {
                     http_post_atom_v,
                     base_.scheme_host_port(),
                     std::string("/api/v1/entity/" + entity + "/_search"),
-                    base_.get_auth_headers(),
+                    query_headers(key),
                     jsn.dump(),
                     base_.content_type_hash())
                     .then(
                         [=](const httplib::Response &response) mutable {
+                            if (response.status == 304 and cache_.find(key)) {
+                                cache_.revalidated(key);
+                                const auto result = cache_.find(key)->value;
+                                deliver_query(key, entity, result, cache_.find(key)->etag);
+                                prefetch_next(result);
+                                return;
+                            }
+
                             try {
                                 // validate / authentication error.
                                 auto jsn = nlohmann::json::parse(response.body);
@@ -629,6 +715,7 @@ void ShotgunClientActor::init() {
                                     if (not jsn["errors"][0]["status"].is_null() and
                                         jsn["errors"][0]["status"].get<int>() == 401) {
                                         // try and authorise..
+                                        auto waiting = take_waiting(key);
                                         request(
                                             actor_cast<caf::actor>(this),
                                             infinite,
@@ -637,36 +724,42 @@ void ShotgunClientActor::init() {
                                                 [=](const std::pair<
                                                     std::string,
                                                     std::string>) mutable {
-                                                    rp.delegate(
-                                                        actor_cast<caf::actor>(this),
-                                                        shotgun_entity_search_atom_v,
-                                                        entity,
-                                                        conditions,
-                                                        fields,
-                                                        sort,
-                                                        page,
-                                                        page_size);
+                                                    for (auto &w : waiting)
+                                                        w.delegate(
+                                                            actor_cast<caf::actor>(this),
+                                                            shotgun_entity_search_atom_v,
+                                                            entity,
+                                                            conditions,
+                                                            fields,
+                                                            sort,
+                                                            page,
+                                                            page_size);
                                                 },
                                                 [=](error &err) mutable {
                                                     spdlog::warn(
                                                         "{} {}",
                                                         __PRETTY_FUNCTION__,
                                                         to_string(err));
-                                                    rp.deliver(JsonStore(std::move(jsn)));
+                                                    for (auto &w : waiting)
+                                                        w.deliver(JsonStore(jsn));
                                                 });
+                                        prefetching_.erase(key);
                                         return;
                                     }
 
                                 } catch (const std::exception &err) {
                                     spdlog::warn("{} {}", __PRETTY_FUNCTION__, err.what());
                                 }
-                                rp.deliver(JsonStore(std::move(jsn)));
+                                const auto result = JsonStore(std::move(jsn));
+                                deliver_query(
+                                    key, entity, result, response.get_header_value("ETag"));
 
+                                prefetch_next(result);
                             } catch (const std::exception &err) {
-                                rp.deliver(make_error(sce::response_error, err.what()));
+                                deliver_query(key, make_error(sce::response_error, err.what()));
                             }
                         },
-                        [=](error &err) mutable { rp.deliver(std::move(err)); });
+                        [=](error &err) mutable { deliver_query(key, err); });
             }
             return rp;
         },
@@ -674,9 +767,32 @@ void ShotgunClientActor::init() {
         [=](shotgun_host_atom) -> std::string { return base_.scheme_host_port(); },
 
         [=](shotgun_host_atom, const std::string &scheme_host_port) {
+            if (scheme_host_port != base_.scheme_host_port())
+                cache_.clear();
             base_.set_scheme_host_port(scheme_host_port);
         },
 
+        [=](shotgun_query_cache_atom) -> JsonStore {
+            auto result           = cache_.stats();
+            result["in_flight"]   = waiting_.size();
+            result["prefetching"] = prefetching_.size();
+            return result;
+        },
+
+        // seconds to keep query results for an entity, or for any entity
+        // without its own setting when entity is empty.
+        [=](shotgun_query_cache_atom, const std::string &entity, const int ttl) {
+            cache_.set_ttl(entity, std::chrono::seconds(ttl));
+        },
+
+        // keep results between sessions
+        [=](shotgun_query_cache_atom, const caf::uri &path) -> bool {
+            cache_path_ = uri_to_posix_path(path);
+            return cache_.load(cache_path_);
+        },
+
+        [=](shotgun_query_cache_atom, utility::clear_atom) { cache_.clear(); },
+
         [=](shotgun_credential_atom, const shotgun_client::AuthenticateShotgun &auth) {
             base_.set_credentials_method(auth);
         },
@@ -1593,3 +1709,80 @@ void ShotgunClientActor::acquire_token(
                 }
             });
 }
+
+void ShotgunClientActor::on_exit() {
+    if (not cache_path_.empty())
+        cache_.save(cache_path_);
+    caf::event_based_actor::on_exit();
+}
+
+bool ShotgunClientActor::from_cache(
+    const std::string &key, caf::typed_response_promise<JsonStore> rp) {
+    const auto *entry = cache_.get(key);
+    if (entry) {
+        rp.deliver(entry->value);
+        return true;
+    }
+
+    auto &waiting = waiting_[key];
+    waiting.push_back(rp);
+    return waiting.size() > 1;
+}
+
+httplib::Headers ShotgunClientActor::query_headers(const std::string &key) const {
+    auto headers      = base_.get_auth_headers();
+    const auto *entry = cache_.find(key);
+    if (entry and not entry->etag.empty())
+        headers.emplace("If-None-Match", entry->etag);
+    return headers;
+}
+
+std::vector<caf::typed_response_promise<JsonStore>>
+ShotgunClientActor::take_waiting(const std::string &key) {
+    std::vector<caf::typed_response_promise<JsonStore>> result;
+    auto it = waiting_.find(key);
+    if (it != waiting_.end()) {
+        result = std::move(it->second);
+        waiting_.erase(it);
+    }
+    return result;
+}
+
+void ShotgunClientActor::deliver_query(
+    const std::string &key,
+    const std::string &entity,
+    const JsonStore &result,
+    const std::string &etag) {
+    // errors aren't cached
+    if (not result.count("errors"))
+        cache_.put(key, entity, result, etag);
+
+    for (auto &rp : take_waiting(key))
+        rp.deliver(result);
+}
+
+void ShotgunClientActor::deliver_query(const std::string &key, const caf::error &err) {
+    prefetching_.erase(key);
+    for (auto &rp : take_waiting(key))
+        rp.deliver(err);
+}
+
+bool ShotgunClientActor::should_prefetch(
+    const std::string &key,
+    const std::string &next_key,
+    const JsonStore &result,
+    const int page,
+    const int page_size) {
+    if (prefetching_.erase(key))
+        return false;
+
+    if (not page or not result.count("data") or not result["data"].is_array() or
+        result["data"].size() != static_cast<size_t>(page_size))
+        return false;
+
+    if (cache_.find(next_key) or waiting_.count(next_key) or prefetching_.count(next_key))
+        return false;
+
+    prefetching_.insert(next_key);
+    return true;
+}
@@ -1,6 +1,9 @@
 // SPDX-License-Identifier: Apache-2.0
+#include <atomic>
 #include <caf/all.hpp>
+#include <chrono>
 #include <gtest/gtest.h>
+#include <thread>
 
 #include "xstudio/atoms.hpp"
 #include "xstudio/shotgun_client/shotgun_client_actor.hpp"
@@ -105,3 +108,133 @@ TEST(ShotgunClientActorTest, Test) {
     // std::endl; } catch(const std::exception &err) { 	std::cerr << err.what() << std::endl;
     // }
 }
+
+namespace {
+
+// stands in for ShotGrid, counting the searches it is sent
+struct MockShotgun {
+    MockShotgun() {
+        server.Post(
+            "/api/v1/auth/access_token",
+            [&](const httplib::Request &, httplib::Response &res) {
+                res.set_content(
+                    R"({"token_type": "Bearer", "access_token": "a", )"
+                    R"("refresh_token": "r", "expires_in": 600})",
+                    "application/json");
+            });
+        server.Post(
+            "/api/v1/entity/versions/_search",
+            [&](const httplib::Request &req, httplib::Response &res) {
+                const auto query = nlohmann::json::parse(req.body);
+                const auto page  = query["page"]["number"].get<int>();
+                const auto size  = query["page"]["size"].get<int>();
+                if (page == 1)
+                    page_one++;
+                else
+                    other_pages++;
+                // slow enough for identical requests to overlap
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+                auto data = nlohmann::json::array();
+                for (int i = 0; i < (page == 1 ? size : size / 2); i++)
+                    data.push_back({{"type", "Version"}, {"id", (page - 1) * size + i}});
+                res.set_content(nlohmann::json{{"data", data}}.dump(), "application/json");
+            });
+        server.Put(
+            R"(/api/v1/entity/Version/(\d+))",
+            [&](const httplib::Request &, httplib::Response &res) {
+                res.set_content(R"({"data": {"type": "Version"}})", "application/json");
+            });
+
+        port   = server.bind_to_any_port("127.0.0.1");
+        thread = std::thread([&]() { server.listen_after_bind(); });
+        while (not server.is_running())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    ~MockShotgun() {
+        server.stop();
+        thread.join();
+    }
+
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(port); }
+
+    httplib::Server server;
+    std::thread thread;
+    int port;
+    std::atomic<int> page_one    = {0};
+    std::atomic<int> other_pages = {0};
+};
+
+} // namespace
+
+TEST(ShotgunClientActorTest, QueryCache) {
+    MockShotgun mock;
+    fixture f;
+    auto sg = f.self->spawn<ShotgunClientActor>();
+
+    f.self->send(sg, shotgun_host_atom_v, mock.url());
+    AuthenticateShotgun auth;
+    auth.set_authentication_method(AM_SCRIPT);
+    auth.set_client_id("id");
+    auth.set_client_secret("secret");
+    request_receive<std::pair<std::string, std::string>>(
+        *(f.self), sg, shotgun_authenticate_atom_v, auth);
+
+    const auto conditions = JsonStore(static_cast<nlohmann::json>(FilterBy()));
+    const std::vector<std::string> fields({"code"});
+    auto search = [&](const int page) {
+        return request_receive<JsonStore>(
+            *(f.self),
+            sg,
+            shotgun_entity_search_atom_v,
+            "versions",
+            conditions,
+            fields,
+            std::vector<std::string>(),
+            page,
+            10);
+    };
+
+    // identical requests made together go out once
+    std::vector<caf::scoped_actor> clients;
+    for (int i = 0; i < 5; i++)
+        clients.emplace_back(f.system);
+    for (auto &client : clients)
+        client->send(
+            sg,
+            shotgun_entity_search_atom_v,
+            "versions",
+            conditions,
+            fields,
+            std::vector<std::string>(),
+            1,
+            10);
+    for (auto &client : clients)
+        client->receive([&](const JsonStore &result) {
+            EXPECT_EQ(result["data"].size(), size_t(10));
+        });
+    EXPECT_EQ(mock.page_one, 1);
+
+    // then come from the cache
+    EXPECT_EQ(search(1)["data"].size(), size_t(10));
+    EXPECT_EQ(mock.page_one, 1);
+
+    // a full page fetches the next one in the background
+    for (int i = 0; i < 100 and mock.other_pages == 0; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(search(2)["data"].size(), size_t(5));
+    EXPECT_EQ(mock.other_pages, 1);
+
+    // writing to versions invalidates them
+    request_receive<JsonStore>(
+        *(f.self), sg, shotgun_update_entity_atom_v, "Version", 1, JsonStore(R"({})"_json));
+    search(1);
+    EXPECT_EQ(mock.page_one, 2);
+
+    auto stats = request_receive<JsonStore>(*(f.self), sg, shotgun_query_cache_atom_v);
+    EXPECT_GE(stats["hits"].get<int>(), 2);
+
+    f.self->send_exit(sg, caf::exit_reason::user_shutdown);
+}
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 #include <gtest/gtest.h>
 
+#include "xstudio/shotgun_client/query_cache.hpp"
 #include "xstudio/shotgun_client/shotgun_client.hpp"
 #include "xstudio/utility/helpers.hpp"
 #include "xstudio/utility/uuid.hpp"
@@ -111,6 +112,98 @@ TEST(ShotgunClientTest, TestFilters) {
 }
 
 
+TEST(ShotgunClientTest, QueryCache) {
+    using namespace std::chrono_literals;
+    QueryCache cache(60s, 3);
+    const auto now = QueryCache::clock::now();
+
+    // equal queries share a key whatever order they were built in
+    auto a      = R"({"page": {"number": 1, "size": 10}, "fields": ["code"]})"_json;
+    auto b      = nlohmann::json::object();
+    b["fields"] = {"code"};
+    b["page"]   = {{"size", 10}, {"number", 1}};
+
+    const auto key = QueryCache::key("Versions", "search", a);
+    EXPECT_EQ(key, QueryCache::key("version", "search", b));
+    EXPECT_NE(key, QueryCache::key("Versions", "filter", a));
+    EXPECT_NE(key, QueryCache::key("Shots", "search", a));
+    auto c              = a;
+    c["page"]["number"] = 2;
+    EXPECT_NE(key, QueryCache::key("Versions", "search", c));
+
+    EXPECT_FALSE(cache.get(key, now));
+    cache.put(key, "Versions", JsonStore(R"({"data": [1, 2]})"_json), "", now);
+    ASSERT_TRUE(cache.get(key, now + 30s));
+    EXPECT_EQ(cache.get(key, now + 30s)->value["data"].size(), size_t(2));
+    EXPECT_FALSE(cache.get(key, now + 61s));
+    // still there to revalidate
+    EXPECT_TRUE(cache.find(key));
+    cache.revalidated(key, now + 61s);
+    EXPECT_TRUE(cache.get(key, now + 100s));
+
+    // per entity lifetimes, zero isn't cached
+    cache.set_ttl("Shots", 10s);
+    cache.set_ttl("notes", 0s);
+    const auto shot_key = QueryCache::key("Shots", "search", a);
+    const auto note_key = QueryCache::key("Notes", "search", a);
+    cache.put(shot_key, "Shots", JsonStore(R"({"data": []})"_json), "", now);
+    cache.put(note_key, "Notes", JsonStore(R"({"data": []})"_json), "", now);
+    EXPECT_TRUE(cache.get(shot_key, now + 5s));
+    EXPECT_FALSE(cache.get(shot_key, now + 11s));
+    EXPECT_FALSE(cache.find(note_key));
+
+    // writes to an entity invalidate it under any of its names
+    cache.invalidate("Version");
+    EXPECT_FALSE(cache.find(key));
+    EXPECT_TRUE(cache.find(shot_key));
+
+    // the oldest go first
+    for (int i = 0; i < 4; i++)
+        cache.put(
+            QueryCache::key("Versions", "search", i),
+            "Versions",
+            JsonStore(nlohmann::json{{"data", {i}}}),
+            "",
+            now + std::chrono::seconds(i));
+    EXPECT_EQ(cache.size(), size_t(3));
+    EXPECT_FALSE(cache.find(shot_key));
+    EXPECT_FALSE(cache.find(QueryCache::key("Versions", "search", 0)));
+
+    // persisted, keeping only what is still usable
+    QueryCache persisted(60s, 10);
+    const auto old_key = QueryCache::key("Versions", "search", 1);
+    persisted.put(key, "Versions", JsonStore(R"({"data": [3]})"_json), "", now);
+    persisted.put(old_key, "Versions", JsonStore(R"({"data": []})"_json), "", now - 1h);
+    persisted.put(shot_key, "Shots", JsonStore(R"({"data": []})"_json), "\"etag\"", now - 1h);
+
+    QueryCache restored;
+    restored.deserialise(persisted.serialise(), now + 2s);
+    EXPECT_EQ(restored.size(), size_t(2));
+    ASSERT_TRUE(restored.find(key));
+    EXPECT_EQ(restored.find(key)->value["data"][0].get<int>(), 3);
+    EXPECT_FALSE(restored.find(old_key));
+    // expired, but kept for its etag
+    ASSERT_TRUE(restored.find(shot_key));
+    EXPECT_EQ(restored.find(shot_key)->etag, "\"etag\"");
+
+    // entries from caches keyed by hash are dropped
+    auto legacy      = persisted.serialise();
+    legacy[0]["key"] = size_t(42);
+    QueryCache upgraded;
+    upgraded.deserialise(legacy, now + 2s);
+    EXPECT_EQ(upgraded.size(), size_t(1));
+
+    const auto path = (fs::temp_directory_path() / "xstudio_query_cache_test.json").string();
+    EXPECT_TRUE(persisted.save(path));
+    QueryCache loaded;
+    EXPECT_TRUE(loaded.load(path));
+    EXPECT_EQ(loaded.size(), size_t(2));
+    fs::remove(path);
+
+    EXPECT_EQ(cache.stats()["hits"], 4);
+}
+
+
 // std::cerr << FilterBy()
 // std::cerr << Is() << std::endl;
 // FilterBy f();.or(Checkbox("name").is(true)).or().and();
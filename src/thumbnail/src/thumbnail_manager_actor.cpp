@@ -182,6 +182,57 @@ ThumbnailManagerActor::ThumbnailManagerActor(caf::actor_config &cfg)
             return rp;
         },
 
+        // sprite sheet of count thumbnails across a movie, memory cache only
+        [=](media_reader::get_filmstrip_atom atom,
+            const media::AVFrameID &mptr,
+            const size_t count,
+            const size_t thumb_size) -> result<ThumbnailBufferPtr> {
+            auto rp = make_response_promise<ThumbnailBufferPtr>();
+            // the pixel format is part of the key, the preference can change
+            const auto rgb24 = filmstrip_rgb24_;
+            const auto name  = fmt::format(
+                "{}/{}/filmstrip/{}/{}",
+                to_string(mptr.uri_),
+                mptr.stream_id_,
+                count,
+                rgb24 ? "rgb24" : "rgbf96");
+            const auto key = ThumbnailKey(name, thumb_size).hash();
+
+            request(mem_cache_, infinite, media_cache::retrieve_atom_v, key)
+                .then(
+                    [=](const ThumbnailBufferPtr &buf) mutable {
+                        if (buf) {
+                            rp.deliver(buf);
+                            return;
+                        }
+                        auto global_reader =
+                            system().registry().template get<caf::actor>(media_reader_registry);
+                        if (not global_reader) {
+                            rp.deliver(
+                                make_error(xstudio_error::error, "No readers available"));
+                            return;
+                        }
+                        request(
+                            global_reader,
+                            infinite,
+                            atom,
+                            mptr,
+                            count,
+                            thumb_size,
+                            rgb24)
+                            .then(
+                                [=](const ThumbnailBufferPtr &buf) mutable {
+                                    if (buf)
+                                        anon_send(
+                                            mem_cache_, media_cache::store_atom_v, key, buf);
+                                    rp.deliver(buf);
+                                },
+                                [=](const caf::error &err) mutable { rp.deliver(err); });
+                    },
+                    [=](const caf::error &err) mutable { rp.deliver(err); });
+            return rp;
+        },
+
         // convert to jpg
         [=](media_reader::get_thumbnail_atom, const ThumbnailBufferPtr &buffer) {
             delegate(dsk_cache_, media_reader::get_thumbnail_atom_v, buffer);
@@ -266,6 +317,9 @@ ThumbnailManagerActor::ThumbnailManagerActor(caf::actor_config &cfg)
                 if (thumb_size_ != new_size_t) {
                     thumb_size_ = new_size_t;
                 }
+
+                filmstrip_rgb24_ =
+                    preference_value<bool>(js, "/core/thumbnail/filmstrip_rgb24");
             } catch (...) {
             }
         },
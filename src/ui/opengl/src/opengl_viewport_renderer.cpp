@@ -297,14 +297,14 @@ void OpenGLViewportRenderer::render(
                     image_pix_to_screen_pix > 1.00001f; // filter_mode_ == BilinearWhenZoomedOut
         }
 
-        // coordinate system set-up
-        utility::JsonStore shader_params;
-        shader_params["to_coord_system"]        = transform_viewport_to_image_space;
-        shader_params["to_canvas"]              = to_scene_matrix;
-        shader_params["use_bilinear_filtering"] = use_bilinear_filtering;
-        shader_params["pixel_aspect"] =
-            onscreen_frame_ ? onscreen_frame_->pixel_aspect() : 1.0f;
-        active_shader_program_->set_shader_parameters(shader_params);
+        // coordinate system set-up, in the order of the ViewportParameters
+        // block so it goes to the GPU in one copy
+        viewport_uniforms_.set("to_coord_system", transform_viewport_to_image_space);
+        viewport_uniforms_.set("to_canvas", to_scene_matrix);
+        viewport_uniforms_.set(
+            "pixel_aspect", onscreen_frame_ ? onscreen_frame_->pixel_aspect() : 1.0f);
+        viewport_uniforms_.set("use_bilinear_filtering", use_bilinear_filtering);
+        active_shader_program_->set_shader_parameters(viewport_uniforms_);
 
         // The quad that we draw simply fills the viewport area. Note the projection and model
         // matrices are identity at draw time.
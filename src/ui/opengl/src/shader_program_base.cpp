@@ -1,4 +1,6 @@
 // SPDX-License-Identifier: Apache-2.0
+#include <array>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -8,6 +10,7 @@
 #include "xstudio/utility/string_helpers.hpp"
 
 using namespace xstudio::ui::opengl;
+using xstudio::utility::ShaderUniforms;
 
 namespace {
 
@@ -61,14 +64,110 @@ void set_gl_uniform_matrix(
 }
 
 
+// can a ShaderUniforms value be set on a uniform of this GL type
+bool compatible(const ShaderUniforms::Type type, const GLenum gl_type) {
+    switch (type) {
+    case ShaderUniforms::Type::Bool:
+    case ShaderUniforms::Type::Int:
+        // glUniform1i also sets bools and samplers
+        switch (gl_type) {
+        case GL_FLOAT:
+        case GL_FLOAT_VEC2:
+        case GL_FLOAT_VEC3:
+        case GL_FLOAT_VEC4:
+        case GL_FLOAT_MAT3:
+        case GL_FLOAT_MAT4:
+        case GL_INT_VEC2:
+        case GL_INT_VEC3:
+        case GL_INT_VEC4:
+        case GL_UNSIGNED_INT:
+            return false;
+        default:
+            return true;
+        }
+    case ShaderUniforms::Type::UInt:
+        return gl_type == GL_UNSIGNED_INT;
+    case ShaderUniforms::Type::Float:
+        return gl_type == GL_FLOAT;
+    case ShaderUniforms::Type::Vec2:
+        return gl_type == GL_FLOAT_VEC2;
+    case ShaderUniforms::Type::Vec3:
+        return gl_type == GL_FLOAT_VEC3;
+    case ShaderUniforms::Type::Vec4:
+        return gl_type == GL_FLOAT_VEC4;
+    case ShaderUniforms::Type::IVec2:
+        return gl_type == GL_INT_VEC2;
+    case ShaderUniforms::Type::IVec3:
+        return gl_type == GL_INT_VEC3;
+    case ShaderUniforms::Type::IVec4:
+        return gl_type == GL_INT_VEC4;
+    case ShaderUniforms::Type::Mat3:
+        return gl_type == GL_FLOAT_MAT3;
+    case ShaderUniforms::Type::Mat4:
+        return gl_type == GL_FLOAT_MAT4;
+    }
+    return false;
+}
+
+// set a uniform that isn't in a block from its std140 packed value
+void set_gl_uniform(const int location, const ShaderUniforms::Type type, const std::byte *v) {
+    const auto *f = reinterpret_cast<const GLfloat *>(v);
+    const auto *i = reinterpret_cast<const GLint *>(v);
+    switch (type) {
+    case ShaderUniforms::Type::Bool:
+    case ShaderUniforms::Type::Int:
+        glUniform1iv(location, 1, i);
+        break;
+    case ShaderUniforms::Type::UInt:
+        glUniform1uiv(location, 1, reinterpret_cast<const GLuint *>(v));
+        break;
+    case ShaderUniforms::Type::Float:
+        glUniform1fv(location, 1, f);
+        break;
+    case ShaderUniforms::Type::Vec2:
+        glUniform2fv(location, 1, f);
+        break;
+    case ShaderUniforms::Type::Vec3:
+        glUniform3fv(location, 1, f);
+        break;
+    case ShaderUniforms::Type::Vec4:
+        glUniform4fv(location, 1, f);
+        break;
+    case ShaderUniforms::Type::IVec2:
+        glUniform2iv(location, 1, i);
+        break;
+    case ShaderUniforms::Type::IVec3:
+        glUniform3iv(location, 1, i);
+        break;
+    case ShaderUniforms::Type::IVec4:
+        glUniform4iv(location, 1, i);
+        break;
+    case ShaderUniforms::Type::Mat3: {
+        // drop the std140 column padding
+        std::array<GLfloat, 9> m;
+        for (int c = 0; c < 3; ++c)
+            for (int r = 0; r < 3; ++r)
+                m[c * 3 + r] = f[c * 4 + r];
+        glUniformMatrix3fv(location, 1, GL_FALSE, m.data());
+    } break;
+    case ShaderUniforms::Type::Mat4:
+        glUniformMatrix4fv(location, 1, GL_FALSE, f);
+        break;
+    }
+}
+
 const char *vertex_shader_base = R"(
 #version 330 core
 layout (location = 0) in vec4 aPos;
 out vec2 texPosition;
 uniform ivec2 image_dims;
-uniform mat4 to_coord_system;
-uniform mat4 to_canvas;
-uniform float pixel_aspect;
+// the per draw parameters, uploaded in one go by OpenGLViewportRenderer
+layout (std140) uniform ViewportParameters {
+    mat4 to_coord_system;
+    mat4 to_canvas;
+    float pixel_aspect;
+    bool use_bilinear_filtering;
+};
 
 vec2 calc_pixel_coordinate(vec2 viewport_coordinate);
 
@@ -90,7 +189,12 @@ uniform ivec2 image_dims;
 uniform ivec2 image_bounds_min;
 uniform ivec2 image_bounds_max;
 
-uniform bool use_bilinear_filtering;
+layout (std140) uniform ViewportParameters {
+    mat4 to_coord_system;
+    mat4 to_canvas;
+    float pixel_aspect;
+    bool use_bilinear_filtering;
+};
 
 uniform usampler2DRect the_tex;
 uniform ivec2 tex_dims;
@@ -307,7 +411,12 @@ uniform ivec2 image_dims;
 uniform ivec2 image_bounds_min;
 uniform ivec2 image_bounds_max;
 
-uniform bool use_bilinear_filtering;
+layout (std140) uniform ViewportParameters {
+    mat4 to_coord_system;
+    mat4 to_canvas;
+    float pixel_aspect;
+    bool use_bilinear_filtering;
+};
 
 layout (std430, binding = 0) buffer ssboObject {
     uint data[];
@@ -611,6 +720,11 @@ GLShaderProgram::GLShaderProgram(
     }
 }
 
+GLShaderProgram::~GLShaderProgram() {
+    for (auto &block : blocks_)
+        glDeleteBuffers(1, &block.buffer);
+}
+
 bool GLShaderProgram::is_colour_op_shader_source(const std::string &shader_code) const {
 
     // colour op shaders implement a specific signature function that we can look for.
@@ -731,19 +845,142 @@ void GLShaderProgram::compile() {
     // Always detach shaders after a successful link.
     std::for_each(
         shaders.begin(), shaders.end(), [&](GLuint shdr) { glDetachShader(program_, shdr); });
+
+    reflect();
+}
+
+void GLShaderProgram::reflect() {
+
+    uniforms_.clear();
+    uniform_targets_.clear();
+    for (auto &block : blocks_)
+        glDeleteBuffers(1, &block.buffer);
+    blocks_.clear();
+
+    // each block gets a buffer, bound to the binding point of the same index
+    GLint count = 0;
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        GLint size    = 0;
+        GLint members = 0;
+        glGetActiveUniformBlockiv(program_, i, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+        glGetActiveUniformBlockiv(program_, i, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &members);
+        glUniformBlockBinding(program_, i, i);
+
+        UniformBlock block;
+        block.members = members;
+        block.data.resize(size);
+        glGenBuffers(1, &block.buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, block.buffer);
+        glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+        blocks_.push_back(block);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    GLint max_length = 0;
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+    std::vector<GLchar> name(max_length + 1);
+
+    for (GLuint i = 0; i < GLuint(count); ++i) {
+        GLsizei length = 0;
+        GLint size     = 0;
+        Uniform uniform;
+        glGetActiveUniform(
+            program_, i, GLsizei(name.size()), &length, &size, &uniform.type, name.data());
+        glGetActiveUniformsiv(program_, 1, &i, GL_UNIFORM_BLOCK_INDEX, &uniform.block);
+        glGetActiveUniformsiv(program_, 1, &i, GL_UNIFORM_OFFSET, &uniform.offset);
+
+        std::string uniform_name(name.data(), length);
+        // arrays are reported by their first element
+        if (uniform_name.size() > 3 and
+            uniform_name.compare(uniform_name.size() - 3, 3, "[0]") == 0)
+            uniform_name.resize(uniform_name.size() - 3);
+
+        if (uniform.block == -1)
+            uniform.location = glGetUniformLocation(program_, uniform_name.c_str());
+        uniforms_[uniform_name] = uniform;
+    }
 }
 
-void GLShaderProgram::use() const { glUseProgram(program_); }
+void GLShaderProgram::use() const {
+    glUseProgram(program_);
+    // binding points are shared by all programs, so claim ours again
+    for (size_t i = 0; i < blocks_.size(); ++i)
+        glBindBufferBase(GL_UNIFORM_BUFFER, GLuint(i), blocks_[i].buffer);
+}
 
 void GLShaderProgram::stop_using() const { glUseProgram(0); }
 
 int GLShaderProgram::get_param_location(const std::string &param_name) {
-    const auto p = locations_.find(param_name);
-    if (p != locations_.end())
+    const auto p = uniforms_.find(param_name);
+    if (p != uniforms_.end())
+        return p->second.location;
+    // not an active uniform, or an element of an array
+    Uniform uniform;
+    uniform.location      = glGetUniformLocation(program_, param_name.c_str());
+    uniforms_[param_name] = uniform;
+    return uniform.location;
+}
+
+const GLShaderProgram::UniformTargets &
+GLShaderProgram::uniform_targets(const utility::ShaderUniforms &uniforms) {
+
+    const auto p = uniform_targets_.find(uniforms.layout_id());
+    if (p != uniform_targets_.end())
         return p->second;
-    const int loc          = glGetUniformLocation(program_, param_name.c_str());
-    locations_[param_name] = loc;
-    return loc;
+
+    UniformTargets result;
+    int block       = -1;
+    bool same_layout = true;
+
+    for (const auto &member : uniforms.members()) {
+        get_param_location(member.name);
+        const Uniform *target = &uniforms_[member.name];
+
+        if (target->location == -1 and target->block == -1) {
+            target = nullptr;
+        } else if (target->type and not compatible(member.type, target->type)) {
+            spdlog::warn(
+                "GLShaderProgram::set_shader_parameters: shader uniform \"{}\" can't be set "
+                "from a {}.",
+                member.name,
+                ShaderUniforms::type_name(member.type));
+            target = nullptr;
+        } else if (
+            target->block != -1 and
+            target->offset + ShaderUniforms::std140_size(member.type) >
+                blocks_[target->block].data.size()) {
+            target = nullptr;
+        }
+
+        if (block == -1 and target)
+            block = target->block;
+        same_layout = same_layout and target and target->block == block and
+                      uint32_t(target->offset) == member.offset;
+        result.targets.push_back(target);
+    }
+
+    // the block is exactly what we have, it can be copied in one go
+    if (same_layout and block != -1 and blocks_[block].members == int(result.targets.size()) and
+        uniforms.size() <= blocks_[block].data.size())
+        result.whole_block = block;
+
+    return uniform_targets_[uniforms.layout_id()] = result;
+}
+
+void GLShaderProgram::upload_uniform_blocks() {
+    bool bound = false;
+    for (auto &block : blocks_) {
+        if (block.dirty) {
+            glBindBuffer(GL_UNIFORM_BUFFER, block.buffer);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, block.data.size(), block.data.data());
+            block.dirty = false;
+            bound       = true;
+        }
+    }
+    if (bound)
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 void GLShaderProgram::set_shader_parameters(const media_reader::ImageBufPtr &image) {
@@ -762,21 +999,62 @@ void GLShaderProgram::set_shader_parameters(const media_reader::ImageBufPtr &ima
             location,
             image->image_pixels_bounding_box().min.x,
             image->image_pixels_bounding_box().min.y);
-        set_shader_parameters(image->shader_params());
+        if (not image->shader_uniforms().empty())
+            set_shader_parameters(image->shader_uniforms());
+        if (not image->shader_params().is_null())
+            set_shader_parameters(image->shader_params());
     }
 }
 
+void GLShaderProgram::set_shader_parameters(const utility::ShaderUniforms &uniforms) {
+
+    use();
+    const auto &targets = uniform_targets(uniforms);
+
+    if (targets.whole_block != -1) {
+        auto &block = blocks_[targets.whole_block];
+        std::memcpy(block.data.data(), uniforms.data(), uniforms.size());
+        block.dirty = true;
+    } else {
+        const auto &members = uniforms.members();
+        for (size_t i = 0; i < members.size(); ++i) {
+            const auto *target = targets.targets[i];
+            const auto *value  = uniforms.data() + members[i].offset;
+            if (not target) {
+                continue;
+            } else if (target->block != -1) {
+                auto &block = blocks_[target->block];
+                std::memcpy(
+                    block.data.data() + target->offset,
+                    value,
+                    ShaderUniforms::std140_size(members[i].type));
+                block.dirty = true;
+            } else {
+                set_gl_uniform(target->location, members[i].type, value);
+            }
+        }
+    }
+
+    upload_uniform_blocks();
+}
+
 void GLShaderProgram::set_shader_parameters(const utility::JsonStore &shader_params) {
 
     use();
     auto params = shader_params;
+    // values for members of uniform blocks, which have no location
+    nlohmann::json block_params;
 
     for (nlohmann::json::const_iterator it = params.begin(); it != params.end(); ++it) {
 
         const std::string param_name = it.key();
         int location                 = get_param_location(param_name);
 
-        if (location == -1) {
+        if (location == -1 and uniforms_[param_name].block != -1) {
+
+            block_params[param_name] = it.value();
+
+        } else if (location == -1) {
 
             /*spdlog::debug(
                 "GLShaderProgram::set_shader_parameter: Request for shader uniform attr \"{}\" "
@@ -842,4 +1120,12 @@ void GLShaderProgram::set_shader_parameters(const utility::JsonStore &shader_par
             }
         }
     }
+
+    if (not block_params.is_null()) {
+        try {
+            set_shader_parameters(ShaderUniforms::from_json(block_params));
+        } catch (const std::exception &e) {
+            spdlog::warn("GLShaderProgram::set_shader_parameters: {}", e.what());
+        }
+    }
 }
\ No newline at end of file
@@ -235,7 +235,7 @@ void GLBlindRGBA8bitTex::pixel_upload() {
     std::vector<std::thread> memcpy_threads;
     size_t sz   = std::min(tex_size_bytes(), new_source_frame_->size());
     size_t step = ((sz / n_threads) / 4096) * 4096;
-    auto *dst   = (uint8_t *)new_source_frame_->buffer();
+    auto *dst   = (const uint8_t *)new_source_frame_->const_buffer();
 
     uint8_t *ioPtrY = buffer_io_ptr_;
 
@@ -654,7 +654,7 @@ void GLSsboTex::pixel_upload() {
     std::vector<std::thread> memcpy_threads;
     size_t sz   = std::min(tex_size_bytes(), new_source_frame_->size());
     size_t step = ((sz / n_threads) / 4096) * 4096;
-    auto *dst   = (uint8_t *)new_source_frame_->buffer();
+    auto *dst   = (const uint8_t *)new_source_frame_->const_buffer();
 
     uint8_t *ioPtrY = buffer_io_ptr_;
 
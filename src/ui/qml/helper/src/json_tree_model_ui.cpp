@@ -1,4 +1,5 @@
 // SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
 #include <set>
 #include <nlohmann/json.hpp>
 
@@ -7,6 +8,10 @@
 #include "xstudio/utility/logging.hpp"
 #include "xstudio/ui/qml/helper_ui.hpp"
 
+CAF_PUSH_WARNINGS
+#include <QTimer>
+CAF_POP_WARNINGS
+
 using namespace xstudio::utility;
 using namespace xstudio::ui::qml;
 using namespace std::chrono_literals;
@@ -37,10 +42,44 @@ std::set<std::string> get_all_keys(const nlohmann::json &data) {
     return keys;
 }
 
+std::string index_key(const nlohmann::json &value) {
+    return value.is_string() ? value.get<std::string>() : value.dump();
+}
+
+// about one frame
+constexpr auto data_changed_interval = 16ms;
 
 } // namespace
 
-JSONTreeModel::JSONTreeModel(QObject *parent) : QAbstractItemModel(parent) {}
+JSONTreeModel::JSONTreeModel(QObject *parent) : QAbstractItemModel(parent) {
+    // keep the role index in step with every row change, including those made
+    // directly by subclasses, so it never holds a destroyed node.
+    connect(
+        this,
+        &QAbstractItemModel::rowsAboutToBeRemoved,
+        this,
+        [this](const QModelIndex &parent_index, int first, int last) {
+            auto node = parent_index.isValid() ? indexToTree(parent_index) : &data_;
+            auto it   = std::next(node->begin(), first);
+            for (auto i = first; i <= last and it != node->end(); i++, ++it)
+                unindexNode(&(*it));
+        });
+    connect(
+        this,
+        &QAbstractItemModel::rowsInserted,
+        this,
+        [this](const QModelIndex &parent_index, int first, int last) {
+            auto node = parent_index.isValid() ? indexToTree(parent_index) : &data_;
+            auto it   = std::next(node->begin(), first);
+            for (auto i = first; i <= last and it != node->end(); i++, ++it)
+                indexNode(&(*it));
+        });
+    connect(this, &QAbstractItemModel::modelAboutToBeReset, this, [this]() {
+        role_index_.clear();
+        node_keys_.clear();
+    });
+    connect(this, &QAbstractItemModel::modelReset, this, [this]() { rebuild_index(); });
+}
 
 nlohmann::json JSONTreeModel::modelData() const {
     // build json from tree..
@@ -207,6 +246,32 @@ QModelIndexList JSONTreeModel::search_recursive_list_base(
 
     START_SLOW_WATCHER()
 
+    QModelIndexList result;
+
+    if (not indexed_roles_.count(role) or
+        not search_index(value, role, parent, start, hits, max_depth, result)) {
+        result = search_recursive_list_base_scan(value, role, parent, start, hits, max_depth);
+
+        // not indexed yet, add what we found
+        if (indexed_roles_.count(role)) {
+            for (const auto &i : result)
+                indexNode(indexToTree(i), false);
+        }
+    }
+
+    CHECK_SLOW_WATCHER()
+
+    return result;
+}
+
+QModelIndexList JSONTreeModel::search_recursive_list_base_scan(
+    const QVariant &value,
+    const int role,
+    const QModelIndex &parent,
+    const int start,
+    const int hits,
+    const int max_depth) {
+
     QModelIndexList result = QAbstractItemModel::match(
         index(start, 0, parent),
         role,
@@ -218,7 +283,7 @@ QModelIndexList JSONTreeModel::search_recursive_list_base(
         for (int i = start; i < rowCount(parent); i++) {
             auto chd = index(i, 0, parent);
             if (hasChildren(chd)) {
-                auto more_result = search_recursive_list(
+                auto more_result = search_recursive_list_base_scan(
                     value, role, chd, 0, hits == -1 ? -1 : hits - result.size(), max_depth - 1);
                 result.append(more_result);
                 if (hits != -1 and result.size() >= hits)
@@ -227,11 +292,190 @@ QModelIndexList JSONTreeModel::search_recursive_list_base(
         }
     }
 
-    CHECK_SLOW_WATCHER()
-
     return result;
 }
 
+bool JSONTreeModel::search_index(
+    const QVariant &value,
+    const int role,
+    const QModelIndex &parent,
+    const int start,
+    const int hits,
+    const int max_depth,
+    QModelIndexList &result) {
+
+    const auto jvalue = mapFromValue(value);
+    if (jvalue.is_null())
+        return false;
+
+    // unset uuids are stored as null, so a null uuid only matches what the
+    // index holds and a miss is final, a scan would walk the tree for nothing.
+    const auto null_uuid = value.userType() == QMetaType::QUuid and value.toUuid().isNull();
+
+    const auto key   = index_key(jvalue);
+    const auto field = indexed_roles_.at(role);
+
+    auto &bucket = role_index_[role];
+    auto nodes   = bucket.find(key);
+    if (nodes == std::end(bucket))
+        return null_uuid;
+
+    const JsonTree *root = parent.isValid() ? indexToTree(parent) : &data_;
+    const auto rows      = static_cast<int>(root->size());
+
+    // order hits as the scan would, children of parent first from start,
+    // wrapping, then the subtrees of rows from start on, depth first.
+    std::vector<std::pair<std::vector<int>, JsonTree *>> found;
+
+    for (auto *node : nodes->second) {
+        // changed behind our back, ignore.
+        const auto &j = node->data();
+        if (not j.count(field) or j.at(field).is_null() or index_key(j.at(field)) != key)
+            continue;
+
+        // must live under parent, within depth
+        std::vector<int> path;
+        auto n = node;
+        while (n->parent() and n->parent() != root) {
+            path.push_back(static_cast<int>(n->index()));
+            n = n->parent();
+        }
+
+        const auto depth = static_cast<int>(path.size());
+        if (not n->parent() or (max_depth != -1 and depth > max_depth))
+            continue;
+
+        const auto row = static_cast<int>(n->index());
+        if (depth and row < start)
+            continue;
+
+        std::vector<int> order;
+        if (depth) {
+            order.insert(order.end(), {1, row});
+            for (auto i = path.rbegin(); i != std::prev(path.rend()); ++i)
+                order.insert(order.end(), {1, *i});
+            order.insert(order.end(), {0, path.front()});
+        } else {
+            order.insert(order.end(), {0, ((row - start) % rows + rows) % rows});
+        }
+
+        found.emplace_back(std::move(order), node);
+    }
+
+    std::sort(found.begin(), found.end());
+    for (const auto &[order, node] : found) {
+        if (hits != -1 and result.size() >= hits)
+            break;
+        result.push_back(createIndex(static_cast<int>(node->index()), 0, (void *)node));
+    }
+
+    return null_uuid or not result.empty();
+}
+
+void JSONTreeModel::setIndexedRoles(const std::map<int, std::string> &roles) {
+    indexed_roles_ = roles;
+    rebuild_index();
+}
+
+void JSONTreeModel::rebuild_index() {
+    role_index_.clear();
+    node_keys_.clear();
+
+    if (not indexed_roles_.empty()) {
+        for (auto &i : data_)
+            indexNode(&i, true);
+    }
+}
+
+void JSONTreeModel::indexNode(JsonTree *node, const bool recursive) {
+    if (indexed_roles_.empty())
+        return;
+
+    unindexNode(node, false);
+
+    std::vector<std::pair<int, std::string>> keys;
+    const auto &j = node->data();
+
+    for (const auto &[role, field] : indexed_roles_) {
+        auto it = j.find(field);
+        if (it != std::end(j) and not it->is_null()) {
+            auto key = index_key(*it);
+            role_index_[role][key].push_back(node);
+            keys.emplace_back(role, std::move(key));
+        }
+    }
+
+    if (not keys.empty())
+        node_keys_[node] = std::move(keys);
+
+    if (recursive) {
+        for (auto &i : *node)
+            indexNode(&i, true);
+    }
+}
+
+void JSONTreeModel::unindexNode(JsonTree *node, const bool recursive) {
+    if (indexed_roles_.empty())
+        return;
+
+    // remove using the keys it was indexed with, the data may have changed
+    auto keys = node_keys_.find(node);
+    if (keys != std::end(node_keys_)) {
+        for (const auto &[role, key] : keys->second) {
+            auto &bucket = role_index_[role];
+            auto nodes   = bucket.find(key);
+            if (nodes != std::end(bucket)) {
+                auto &v = nodes->second;
+                v.erase(std::remove(v.begin(), v.end(), node), v.end());
+                if (v.empty())
+                    bucket.erase(nodes);
+            }
+        }
+        node_keys_.erase(keys);
+    }
+
+    if (recursive) {
+        for (auto &i : *node)
+            unindexNode(&i, true);
+    }
+}
+
+void JSONTreeModel::queueDataChanged(const QModelIndex &index, const QVector<int> &roles) {
+    if (not index.isValid())
+        return;
+
+    // empty roles means all roles
+    auto it = pending_changes_.find(QPersistentModelIndex(index));
+    if (it == std::end(pending_changes_)) {
+        pending_changes_.emplace(QPersistentModelIndex(index), roles);
+    } else if (not it->second.empty()) {
+        if (roles.empty())
+            it->second.clear();
+        else {
+            for (const auto i : roles)
+                if (not it->second.contains(i))
+                    it->second.push_back(i);
+        }
+    }
+
+    if (not flush_queued_) {
+        flush_queued_ = true;
+        QTimer::singleShot(data_changed_interval, this, &JSONTreeModel::flushDataChanged);
+    }
+}
+
+void JSONTreeModel::flushDataChanged() {
+    flush_queued_ = false;
+
+    auto pending = std::move(pending_changes_);
+    pending_changes_.clear();
+
+    for (const auto &[index, roles] : pending) {
+        if (index.isValid())
+            emit dataChanged(index, index, roles);
+    }
+}
+
 QModelIndexList JSONTreeModel::search_recursive_list(
     const QVariant &value,
     const int role,
@@ -442,12 +686,14 @@ bool JSONTreeModel::setData(const QModelIndex &index, const QVariant &value, int
             // we now need to update / replace the TreeNode..
             auto new_node = json_to_tree(jval, children_);
             auto old_node = indexToTree(index);
+            unindexNode(old_node);
             // remove old children
             old_node->clear();
             // replace data..
             old_node->data() = new_node.data();
             // copy children
             old_node->splice(old_node->end(), new_node.base());
+            indexNode(old_node);
 
             result = true;
             roles.clear();
@@ -464,6 +710,7 @@ bool JSONTreeModel::setData(const QModelIndex &index, const QVariant &value, int
             j[field] = mapFromValue(value);
             result   = true;
             //}
+            indexNode(indexToTree(index), false);
 
         } break;
         }
@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "xstudio/ui/qml/helper_ui.hpp"
+#include "xstudio/ui/qml/json_tree_model_ui.hpp"
+#include "xstudio/utility/uuid.hpp"
+
+#include <gtest/gtest.h>
+
+CAF_PUSH_WARNINGS
+#include <QCoreApplication>
+CAF_POP_WARNINGS
+
+using namespace xstudio::utility;
+using namespace xstudio::ui::qml;
+
+namespace {
+
+// playlists of media, ids are their position
+nlohmann::json make_data(const int playlists, const int media) {
+    auto data = R"([])"_json;
+
+    for (auto i = 0; i < playlists; i++) {
+        auto playlist =
+            nlohmann::json({{"id", std::to_string(i)}, {"name", "playlist"}, {"children", {}}});
+        for (auto ii = 0; ii < media; ii++)
+            playlist["children"].push_back(
+                {{"id", std::to_string(i) + "-" + std::to_string(ii)}, {"name", "media"}});
+        data.push_back(playlist);
+    }
+
+    return data;
+}
+
+// changes rows directly, as SessionModel does
+class DirectModel : public JSONTreeModel {
+  public:
+    void append(const nlohmann::json &data) {
+        const auto row = static_cast<int>(data_.size());
+        beginInsertRows(QModelIndex(), row, row);
+        data_.insert(data_.end(), json_to_tree(data, children_));
+        endInsertRows();
+    }
+
+    void pop_front() {
+        beginRemoveRows(QModelIndex(), 0, 0);
+        data_.erase(data_.begin());
+        endRemoveRows();
+    }
+};
+
+std::vector<std::string> paths(const JSONTreeModel &model, const QModelIndexList &indexes) {
+    std::vector<std::string> result;
+    for (const auto &i : indexes)
+        result.push_back(model.getIndexPath(i).to_string());
+    return result;
+}
+
+} // namespace
+
+class JSONTreeModelTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+        if (not QCoreApplication::instance())
+            app_ = std::make_unique<QCoreApplication>(argc_, nullptr);
+    }
+
+    int argc_ = 0;
+    std::unique_ptr<QCoreApplication> app_;
+};
+
+TEST_F(JSONTreeModelTest, IndexedSearch) {
+    JSONTreeModel model;
+    model.setRoleNames(std::vector<std::string>({"id", "name"}));
+    model.setModelData(make_data(10, 10));
+
+    const auto id_role   = model.roleId("id");
+    const auto name_role = model.roleId("name");
+    model.setIndexedRoles({{id_role, "id"}});
+
+    auto index = model.search_recursive(QString("3-4"), id_role);
+    ASSERT_TRUE(index.isValid());
+    EXPECT_EQ(index.row(), 4);
+    EXPECT_EQ(index.parent().row(), 3);
+
+    // respects parent and depth
+    EXPECT_FALSE(model.search_recursive(QString("3-4"), id_role, model.index(2, 0)).isValid());
+    EXPECT_TRUE(model.search_recursive(QString("3-4"), id_role, model.index(3, 0)).isValid());
+    EXPECT_FALSE(model.search_list(QString("3-4"), id_role, QModelIndex(), 0, 1).size());
+
+    // follows changes to the indexed field
+    EXPECT_TRUE(model.setData(index, QString("moved"), id_role));
+    EXPECT_FALSE(model.search_recursive(QString("3-4"), id_role).isValid());
+    EXPECT_EQ(model.search_recursive(QString("moved"), id_role), index);
+
+    // removed rows aren't found
+    EXPECT_TRUE(model.removeRows(0, 2, model.index(3, 0)));
+    EXPECT_FALSE(model.search_recursive(QString("3-0"), id_role).isValid());
+    EXPECT_EQ(model.search_recursive(QString("moved"), id_role).row(), 2);
+
+    // inserted rows are
+    EXPECT_TRUE(model.insertRows(0, 1, model.index(3, 0), R"({"id": "new"})"_json));
+    EXPECT_EQ(model.search_recursive(QString("new"), id_role).row(), 0);
+
+    // moved rows still resolve
+    model.moveRows(model.index(3, 0), 0, 1, model.index(5, 0), 0);
+    index = model.search_recursive(QString("new"), id_role);
+    EXPECT_EQ(index.parent().row(), 5);
+    EXPECT_EQ(model.data(index, name_role), QVariant());
+
+    // replacing a subtree reindexes it
+    model.setModelData(make_data(2, 2));
+    EXPECT_FALSE(model.search_recursive(QString("new"), id_role).isValid());
+    EXPECT_TRUE(model.search_recursive(QString("1-1"), id_role).isValid());
+}
+
+TEST_F(JSONTreeModelTest, CoalescedDataChanged) {
+    JSONTreeModel model;
+    model.setRoleNames(std::vector<std::string>({"id", "name"}));
+    model.setModelData(make_data(1, 100));
+
+    auto signals_emitted = 0;
+    QObject::connect(
+        &model,
+        &QAbstractItemModel::dataChanged,
+        [&signals_emitted](
+            const QModelIndex &, const QModelIndex &, const QVector<int> &roles) {
+            signals_emitted++;
+            EXPECT_EQ(roles.size(), 2);
+        });
+
+    const auto parent = model.index(0, 0);
+    for (auto i = 0; i < 10; i++) {
+        for (auto ii = 0; ii < 100; ii++)
+            model.queueDataChanged(model.index(ii, 0, parent), {ii % 2 ? 1 : 2});
+        for (auto ii = 0; ii < 100; ii++)
+            model.queueDataChanged(model.index(ii, 0, parent), {3});
+    }
+    EXPECT_EQ(signals_emitted, 0);
+
+    model.flushDataChanged();
+    EXPECT_EQ(signals_emitted, 100);
+}
+
+TEST_F(JSONTreeModelTest, IndexedUpdates) {
+    const auto media = 10000;
+
+    JSONTreeModel model;
+    model.setRoleNames(std::vector<std::string>({"id", "name"}));
+    model.setModelData(make_data(1, media));
+
+    const auto id_role   = model.roleId("id");
+    const auto name_role = model.roleId("name");
+    const auto id        = [&](const int i) {
+        return QString::fromStdString("0-" + std::to_string((i * 7919) % media));
+    };
+
+    // a full scan per search, so only sample it
+    std::vector<QModelIndex> scanned;
+    for (auto i = 0; i < 100; i++) {
+        scanned.push_back(model.search_recursive(id(i), id_role));
+        ASSERT_TRUE(scanned.back().isValid());
+    }
+
+    // the index finds the same rows, and every update through it lands
+    model.setIndexedRoles({{id_role, "id"}});
+    for (auto i = 0; i < media; i++) {
+        auto index = model.search_recursive(id(i), id_role);
+        ASSERT_TRUE(index.isValid());
+        if (i < 100)
+            EXPECT_EQ(index, scanned[i]);
+        model.setData(index, QString("updated"), name_role);
+    }
+
+    for (const auto &index : scanned)
+        EXPECT_EQ(model.data(index, name_role), QVariant(QString("updated")));
+    EXPECT_EQ(
+        model.data(model.search_recursive(QString("0-9999"), id_role), name_role),
+        QVariant(QString("updated")));
+}
+
+TEST_F(JSONTreeModelTest, IndexedSearchOrder) {
+    auto data = make_data(10, 3);
+    for (const auto &i :
+         {"/2/id", "/7/id", "/1/children/2/id", "/4/children/1/id", "/8/children/0/id"})
+        data[nlohmann::json::json_pointer(i)] = "dup";
+
+    JSONTreeModel scanned;
+    scanned.setRoleNames(std::vector<std::string>({"id", "name"}));
+    scanned.setModelData(data);
+
+    JSONTreeModel indexed;
+    indexed.setRoleNames(std::vector<std::string>({"id", "name"}));
+    indexed.setModelData(data);
+    const auto id_role = indexed.roleId("id");
+    indexed.setIndexedRoles({{id_role, "id"}});
+
+    // same rows in the same order as a scan, whatever row it starts from
+    for (auto start = 0; start < 10; start++) {
+        for (const auto hits : {-1, 1, 2}) {
+            EXPECT_EQ(
+                paths(
+                    indexed,
+                    indexed.search_recursive_list(
+                        QString("dup"), id_role, QModelIndex(), start, hits)),
+                paths(
+                    scanned,
+                    scanned.search_recursive_list(
+                        QString("dup"), id_role, QModelIndex(), start, hits)))
+                << "start " << start << " hits " << hits;
+        }
+    }
+
+    EXPECT_EQ(
+        paths(
+            indexed,
+            indexed.search_recursive_list(QString("dup"), id_role, QModelIndex(), 5, -1)),
+        std::vector<std::string>({"/7", "/2", "/8/children/0"}));
+}
+
+TEST_F(JSONTreeModelTest, IndexedNullUuid) {
+    auto data = R"([])"_json;
+    for (auto i = 0; i < 10; i++)
+        data.push_back({{"id", Uuid::generate()}, {"name", "playlist"}});
+    data.push_back({{"id", nullptr}, {"name", "placeholder"}});
+
+    JSONTreeModel model;
+    model.setRoleNames(std::vector<std::string>({"id", "name"}));
+    model.setModelData(data);
+    const auto id_role = model.roleId("id");
+    model.setIndexedRoles({{id_role, "id"}});
+
+    EXPECT_FALSE(model.search_recursive(QUuid(), id_role).isValid());
+    EXPECT_TRUE(model.search_list(QUuid(), id_role, QModelIndex(), 0, -1).empty());
+    EXPECT_EQ(
+        model.search_recursive(QUuidFromUuid(data[3]["id"].get<Uuid>()), id_role).row(), 3);
+}
+
+TEST_F(JSONTreeModelTest, IndexedDirectChanges) {
+    DirectModel model;
+    model.setRoleNames(std::vector<std::string>({"id", "name"}));
+    model.setModelData(make_data(2, 2));
+    const auto id_role = model.roleId("id");
+    model.setIndexedRoles({{id_role, "id"}});
+
+    // rows added and removed without going through insertRows / removeRows
+    model.append(R"({"id": "2", "children": [{"id": "2-0"}]})"_json);
+    auto index = model.search_recursive(QString("2-0"), id_role);
+    ASSERT_TRUE(index.isValid());
+    EXPECT_EQ(index.parent().row(), 2);
+
+    model.pop_front();
+    EXPECT_FALSE(model.search_recursive(QString("0-1"), id_role).isValid());
+    EXPECT_EQ(model.search_recursive(QString("2-0"), id_role).parent().row(), 1);
+    EXPECT_EQ(model.search_recursive(QString("1"), id_role).row(), 0);
+}
@@ -35,133 +35,16 @@ SessionModel::SessionModel(QObject *parent) : super(parent) {
         {"thumbnailURLRole"},  {"typeRole"},        {"uuidRole"},
     }));
 
-    request_handler_ = new QThreadPool(this);
-}
-
-
-QModelIndexList SessionModel::search_recursive_list_base(
-    const QVariant &value,
-    const int role,
-    const QModelIndex &parent,
-    const int start,
-    const int hits,
-    const int depth) {
-
-    QModelIndexList results;
-
-    if (role == idRole or role == actorUuidRole or role == containerUuidRole) {
-        auto uuid = UuidFromQUuid(value.toUuid());
-        if (uuid.is_null()) {
-            return QModelIndexList();
-        }
-
-        if (role == idRole or role == actorUuidRole) {
-            auto it = uuid_lookup_.find(uuid);
-            if (it != std::end(uuid_lookup_)) {
-                for (auto iit = std::begin(it->second); iit != std::end(it->second);) {
-                    if (iit->isValid()) {
-                        results.push_back(*iit);
-                        iit++;
-                    } else {
-                        iit = it->second.erase(iit);
-                    }
-                }
-            } else {
-                results = JSONTreeModel::search_recursive_list_base(
-                    value, role, parent, start, hits, depth);
-                for (const auto &i : results) {
-                    add_uuid_lookup(uuid, i);
-                }
-            }
-        }
-    } else if (role == actorRole) {
-        auto str = StdFromQString(value.toString());
-
-        if (str.empty())
-            return QModelIndexList();
-
-        auto it = string_lookup_.find(str);
-        if (it != std::end(string_lookup_)) {
-            for (auto iit = std::begin(it->second); iit != std::end(it->second);) {
-                if (iit->isValid()) {
-                    results.push_back(*iit);
-                    iit++;
-                } else {
-                    iit = it->second.erase(iit);
-                }
-            }
-        } else {
-            //  back populate..
-            results = JSONTreeModel::search_recursive_list_base(
-                value, role, parent, start, hits, depth);
-            for (const auto &i : results) {
-                add_string_lookup(str, i);
-            }
-        }
-    } else {
-        // spdlog::error("No lookup {}", StdFromQString(roleName(role)));
-    }
-
-    if (results.empty())
-        results =
-            JSONTreeModel::search_recursive_list_base(value, role, parent, start, hits, depth);
-    else {
-        // make sure results exist under parent..
-        if (parent.isValid()) {
-            for (auto it = results.begin(); it != results.end();) {
-                if (not isChildOf(parent, *it)) {
-                    it = results.erase(it);
-                } else
-                    it++;
-            }
-        }
-
-        if (depth != -1) {
-            for (auto it = results.begin(); it != results.end();) {
-                if (depthOfChild(parent, *it) > depth) {
-                    it = results.erase(it);
-                } else
-                    it++;
-            }
-        }
-    }
-
-    return results;
-}
-
-int SessionModel::depthOfChild(const QModelIndex &parent, const QModelIndex &child) const {
-    auto depth = 0;
-
-    auto p = child.parent();
-    while (p.isValid()) {
-        if (p == parent)
-            return depth;
-        p = p.parent();
-        depth++;
-    }
-
-    if (not parent.isValid())
-        return depth;
+    setIndexedRoles(
+        {{idRole, "id"},
+         {actorUuidRole, "actor_uuid"},
+         {containerUuidRole, "container_uuid"},
+         {actorRole, "actor"}});
 
-    return -1;
+    request_handler_ = new QThreadPool(this);
 }
 
 
-bool SessionModel::isChildOf(const QModelIndex &parent, const QModelIndex &child) const {
-    auto result = false;
-
-    auto p = child;
-    while (p.isValid()) {
-        if (p == parent) {
-            result = true;
-            break;
-        }
-        p = p.parent();
-    }
-
-    return result;
-}
-
 QVariant SessionModel::data(const QModelIndex &index, int role) const {
     auto result = QVariant();
 
@@ -523,21 +406,21 @@ bool SessionModel::setData(const QModelIndex &index, const QVariant &qvalue, int
             case containerUuidRole:
                 if (j.count("container_uuid") and j.at("container_uuid") != value) {
                     j["container_uuid"] = value;
-                    add_lookup(*indexToTree(index), index);
+                    indexNode(indexToTree(index), false);
                     result = true;
                 }
                 break;
             case actorUuidRole:
                 if (j.count("actor_uuid") and j.at("actor_uuid") != value) {
                     j["actor_uuid"] = value;
-                    add_lookup(*indexToTree(index), index);
+                    indexNode(indexToTree(index), false);
                     result = true;
                 }
                 break;
             case actorRole:
                 if (j.count("actor") and j.at("actor") != value) {
                     j["actor"] = value;
-                    add_lookup(*indexToTree(index), index);
+                    indexNode(indexToTree(index), false);
                     result = true;
                 }
                 break;
@@ -6,6 +6,7 @@
 #include "xstudio/ui/qml/job_control_ui.hpp"
 #include "xstudio/ui/qml/session_model_ui.hpp"
 #include "xstudio/ui/qml/caf_response_ui.hpp"
+#include "xstudio/utility/session_file.hpp"
 
 CAF_PUSH_WARNINGS
 #include <QThreadPool>
@@ -151,10 +152,6 @@ void SessionModel::setSessionActorAddr(const QString &addr) {
                 spdlog::warn("{} {}", __PRETTY_FUNCTION__, e.what());
             }
 
-            // clear lookup..
-            uuid_lookup_.clear();
-            string_lookup_.clear();
-
             setModelData(data);
             emit playlistsChanged();
 
@@ -827,8 +824,7 @@ QFuture<bool> SessionModel::importFuture(const QUrl &path, const QVariant &json)
 
         if (json.isNull()) {
             try {
-                std::ifstream i(StdFromQString(path.path()));
-                i >> js;
+                js = JsonStore(read_session_file(StdFromQString(path.path())));
             } catch (const std::exception &err) {
                 spdlog::warn("{} {}", __PRETTY_FUNCTION__, err.what());
                 return false;
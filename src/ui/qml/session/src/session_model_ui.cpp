@@ -19,42 +19,6 @@ using namespace xstudio;
 using namespace xstudio::utility;
 using namespace xstudio::ui::qml;
 
-void SessionModel::add_uuid_lookup(const utility::Uuid &uuid, const QModelIndex &index) {
-    if (not uuid.is_null()) {
-        if (not uuid_lookup_.count(uuid))
-            uuid_lookup_[uuid] = std::set<QPersistentModelIndex>();
-        uuid_lookup_[uuid].insert(index);
-    }
-}
-
-void SessionModel::add_string_lookup(const std::string &str, const QModelIndex &index) {
-    if (not str.empty()) {
-        if (not string_lookup_.count(str))
-            string_lookup_[str] = std::set<QPersistentModelIndex>();
-        string_lookup_[str].insert(index);
-    }
-}
-
-void SessionModel::add_lookup(const utility::JsonTree &tree, const QModelIndex &index) {
-
-    // add actorUuidLookup
-    if (tree.data().count("id") and not tree.data().at("id").is_null())
-        add_uuid_lookup(tree.data().at("id").get<Uuid>(), index);
-    if (tree.data().count("actor_uuid") and not tree.data().at("actor_uuid").is_null())
-        add_uuid_lookup(tree.data().at("actor_uuid").get<Uuid>(), index);
-    if (tree.data().count("container_uuid") and not tree.data().at("container_uuid").is_null())
-        add_uuid_lookup(tree.data().at("container_uuid").get<Uuid>(), index);
-    if (tree.data().count("actor") and not tree.data().at("actor").is_null())
-        add_string_lookup(tree.data().at("actor").get<std::string>(), index);
-
-    auto ind = 0;
-    for (const auto &i : tree) {
-        add_lookup(i, SessionModel::index(ind, 0, index));
-        ind++;
-    }
-}
-
-
 caf::actor SessionModel::actorFromIndex(const QModelIndex &index, const bool try_parent) {
     auto result = caf::actor();
 
@@ -310,8 +274,6 @@ void SessionModel::processChildren(const nlohmann::json &rj, const QModelIndex &
                         auto new_child =
                             ptree->insert(ptree->end(), json_to_tree(rjc.at(i), "children"));
                         refreshId(new_child->data());
-
-                        add_lookup(*new_child, index(i, 0, parent_index));
                     }
                     endInsertRows();
 
@@ -338,14 +300,15 @@ void SessionModel::processChildren(const nlohmann::json &rj, const QModelIndex &
                         // we can't erase..
                         // or we'd invalidate the index..
                         // auto oldpos = ptree->erase(ptree->child(i));
-                        auto childit    = ptree->child(i);
-                        auto new_item   = json_to_tree(rjc.at(i), "children");
+                        auto childit  = ptree->child(i);
+                        auto new_item = json_to_tree(rjc.at(i), "children");
+                        unindexNode(&(*childit));
                         childit->data() = new_item.data();
                         childit->clear();
                         childit->splice(childit->end(), new_item.base());
                         refreshId(childit->data());
 
-                        add_lookup(*childit, index(i, 0, parent_index));
+                        indexNode(&(*childit));
 
                         // FIX ME ***************************************************
                         forcePopulate(*childit, parent_index);
@@ -370,8 +333,6 @@ void SessionModel::processChildren(const nlohmann::json &rj, const QModelIndex &
                             ptree->insert(ptree->child(i), json_to_tree(rjc.at(i), "children"));
                         refreshId(new_child->data());
 
-                        add_lookup(*new_child, index(i, 0, parent_index));
-
                         endInsertRows();
 
                         try {
@@ -546,7 +507,9 @@ void SessionModel::receivedData(
                     if (role_to_key.count(role)) {
                         if (j.count(role_to_key[role]) and j.at(role_to_key[role]) != result) {
                             j[role_to_key[role]] = result;
-                            emit dataChanged(index, index, roles);
+                            if (role == Roles::actorUuidRole or role == Roles::actorRole)
+                                indexNode(indexToTree(index), false);
+                            queueDataChanged(index, roles);
                         }
                     }
                     break;
@@ -555,7 +518,7 @@ void SessionModel::receivedData(
                         if (j.count(role_to_key[role]) and j.at(role_to_key[role]) != result) {
                             if (result != "RETRY")
                                 j[role_to_key[role]] = result;
-                            emit dataChanged(index, index, roles);
+                            queueDataChanged(index, roles);
                         }
                     }
                     break;
@@ -9,6 +9,7 @@
 #include "xstudio/utility/helpers.hpp"
 #include "xstudio/utility/json_store.hpp"
 #include "xstudio/utility/logging.hpp"
+#include "xstudio/utility/session_file.hpp"
 
 using namespace caf;
 using namespace xstudio;
@@ -139,8 +140,7 @@ QFuture<bool> StudioUI::loadSessionFuture(const QUrl &path, const QVariant &json
             JsonStore js;
 
             if (json.isNull()) {
-                std::ifstream i(StdFromQString(path.path()));
-                i >> js;
+                js = JsonStore(read_session_file(StdFromQString(path.path())));
             } else {
                 js = qvariant_to_json(json);
             }
@@ -165,10 +165,7 @@ QFuture<bool> StudioUI::loadSessionRequestFuture(const QUrl &path) {
         auto result = false;
         try {
             scoped_actor sys{system()};
-            JsonStore js;
-
-            std::ifstream i(StdFromQString(path.path()));
-            i >> js;
+            JsonStore js(read_session_file(StdFromQString(path.path())));
 
             // if current session is empty load.
             // else notify UI
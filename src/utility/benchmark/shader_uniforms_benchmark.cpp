@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// CPU cost of filling the viewport's per draw shader parameters. Refilling a
+// typed std140 block in place, against building the json and unpacking it
+// again as every draw used to.
+//
+// shader_uniforms_benchmark [draws]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "xstudio/utility/json_store.hpp"
+#include "xstudio/utility/shader_uniforms.hpp"
+
+using namespace xstudio::utility;
+
+namespace {
+
+double ns_per_draw(const std::chrono::steady_clock::duration elapsed, const int draws) {
+    return std::chrono::duration<double, std::nano>(elapsed).count() / double(draws);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const int draws = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    Imath::M44f to_coord_system, to_canvas;
+    to_coord_system[3][0] = 0.25f;
+
+    // in the order of the ViewportParameters block
+    auto start = std::chrono::steady_clock::now();
+    ShaderUniforms u;
+    for (int i = 0; i < draws; i++) {
+        u.set("to_coord_system", to_coord_system);
+        u.set("to_canvas", to_canvas);
+        u.set("pixel_aspect", 1.0f);
+        u.set("use_bilinear_filtering", (i & 1) != 0);
+    }
+    const auto typed = std::chrono::steady_clock::now() - start;
+
+    start        = std::chrono::steady_clock::now();
+    float unpack = 0.0f;
+    for (int i = 0; i < draws; i++) {
+        JsonStore params;
+        params["to_coord_system"]        = to_coord_system;
+        params["to_canvas"]              = to_canvas;
+        params["pixel_aspect"]           = 1.0f;
+        params["use_bilinear_filtering"] = (i & 1) != 0;
+        for (auto it = params.begin(); it != params.end(); ++it) {
+            if (it->is_array()) {
+                auto v = it.value().begin();
+                v++;
+                v++;
+                for (; v != it.value().end(); v++)
+                    unpack += v.value().get<float>();
+            } else if (it->is_number_float()) {
+                unpack += it->get<float>();
+            }
+        }
+    }
+    const auto json = std::chrono::steady_clock::now() - start;
+
+    std::printf(
+        "%d draws, %zu byte block: typed %.1fns per draw, json %.1fns per draw (%g)\n",
+        draws,
+        u.size(),
+        ns_per_draw(typed, draws),
+        ns_per_draw(json, draws),
+        double(unpack));
+    return 0;
+}
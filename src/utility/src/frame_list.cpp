@@ -1,4 +1,5 @@
 // SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
 #include <filesystem>
 
 #include <limits>
@@ -92,31 +93,45 @@ std::string xstudio::utility::to_string(const FrameGroup &frame_group) {
 // return empty list if duff..
 // assumes native xstudio format spec..
 FrameList::FrameList(const caf::uri &from_path)
-    : frame_groups_(frame_groups_from_sequence_spec(from_path)) {}
+    : frame_groups_(frame_groups_from_sequence_spec(from_path)) {
+    build_index();
+}
 
 FrameList::FrameList(const int start, const int end, const int step)
-    : frame_groups_({FrameGroup(start, end, step)}) {}
+    : frame_groups_({FrameGroup(start, end, step)}) {
+    build_index();
+}
 
 FrameList::FrameList(const std::string &from_string) {
     for (const auto &i : split(from_string, ',')) {
         frame_groups_.emplace_back(FrameGroup(i));
     }
+    build_index();
 }
 
 FrameList::FrameList(std::vector<FrameGroup> frame_groups)
-    : frame_groups_(std::move(frame_groups)) {}
+    : frame_groups_(std::move(frame_groups)) {
+    build_index();
+}
 
-size_t FrameList::count(const bool implied) const {
-    size_t count = 0;
+void FrameList::build_index() {
+    group_offsets_.resize(frame_groups_.size() + 1);
+    group_offsets_[0] = 0;
+    for (size_t i = 0; i < frame_groups_.size(); i++)
+        group_offsets_[i + 1] = group_offsets_[i] + frame_groups_[i].count();
+}
 
-    if (implied) {
-        count = (end(implied) - start()) + 1;
-    } else {
-        for (const auto &i : frame_groups_)
-            count += i.count();
-    }
+size_t FrameList::group_for_index(const size_t index) const {
+    // first group whose end offset is past index
+    auto it = std::upper_bound(group_offsets_.begin() + 1, group_offsets_.end(), index);
+    return std::distance(group_offsets_.begin() + 1, it);
+}
+
+size_t FrameList::count(const bool implied) const {
+    if (implied)
+        return (end(implied) - start()) + 1;
 
-    return count;
+    return group_offsets_.back();
 }
 
 int FrameList::start() const {
@@ -166,19 +181,38 @@ int FrameList::frame(const size_t index, const bool implied, const bool valid) c
         } else
             return index + start();
     } else {
-        size_t tmp = index;
-        for (const auto &i : frame_groups_) {
-            if (i.count() > tmp) {
-                return i.frame(tmp);
-            } else {
-                tmp -= i.count();
-            }
-        }
+        const auto group = group_for_index(index);
+        if (group < frame_groups_.size())
+            return frame_groups_[group].frame(index - group_offsets_[group]);
     }
 
     throw std::runtime_error("Invalid index");
 }
 
+bool FrameList::frames(const size_t first, const size_t count, std::vector<int> &frames) const {
+    frames.resize(count);
+
+    if (not count)
+        return true;
+
+    if (first + count > group_offsets_.back())
+        return false;
+
+    auto group    = group_for_index(first);
+    auto in_group = first - group_offsets_[group];
+
+    for (size_t i = 0; i < count; i++) {
+        if (in_group == frame_groups_[group].count()) {
+            group++;
+            in_group = 0;
+        }
+        const auto &fg = frame_groups_[group];
+        frames[i]      = fg.start_ + static_cast<int>(in_group++) * fg.step_;
+    }
+
+    return true;
+}
+
 std::vector<int> FrameList::frames() const {
     std::vector<int> frms;
 
@@ -196,6 +230,7 @@ bool FrameList::pop_front() {
         return false;
 
     frame_groups_[0].set_start(frame_groups_[0].start() + 1);
+    build_index();
 
     return true;
 }
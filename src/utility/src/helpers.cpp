@@ -20,6 +20,7 @@
 #include "xstudio/utility/helpers.hpp"
 #include "xstudio/utility/sequence.hpp"
 #include "xstudio/utility/string_helpers.hpp"
+#include "xstudio/utility/uri_template.hpp"
 
 using namespace xstudio::utility;
 using namespace caf;
@@ -297,19 +298,15 @@ xstudio::utility::uri_framelist_as_sequence(const caf::uri &uri, const FrameList
     if (frame_list.empty())
         uris.push_back(uri);
     else {
+        const UriTemplate tmpl(uri);
+        std::string buffer;
         auto fl = frame_list.frames();
         uris.reserve(fl.size());
         for (const auto i : fl) {
-            auto new_uri =
-                caf::make_uri(uri_encode(fmt::format(uri_decode(to_string(uri)), i)));
+            auto new_uri = tmpl.uri(i, buffer);
             if (not new_uri) {
-                spdlog::warn(
-                    "{} {} {}",
-                    to_string(uri),
-                    uri_decode(to_string(uri)),
-                    uri_encode(fmt::format(uri_decode(to_string(uri)), i)));
-                throw std::runtime_error(
-                    "Invalid uri " + uri_encode(fmt::format(uri_decode(to_string(uri)), i)));
+                spdlog::warn("{} {} {}", to_string(uri), uri_decode(to_string(uri)), buffer);
+                throw std::runtime_error("Invalid uri " + buffer);
             }
 
             uris.push_back(*new_uri);
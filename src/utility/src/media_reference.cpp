@@ -116,24 +116,74 @@ caf::uri MediaReference::uri() const { return uri_; }
 void MediaReference::set_uri(const caf::uri &uri) { uri_ = uri; }
 
 std::vector<std::pair<caf::uri, int>> MediaReference::uris() const {
+    return uris(0, duration_.frames());
+}
+
+std::vector<std::pair<caf::uri, int>>
+MediaReference::uris(const int logical_start, const int count) const {
     std::vector<std::pair<caf::uri, int>> frames;
-    int frame;
-    for (auto i = 0; i < duration_.frames(); i++) {
-        if (not container_) {
+
+    if (count <= 0)
+        return frames;
+
+    frames.reserve(count);
+
+    if (container_) {
+        for (auto i = logical_start; i < logical_start + count; i++)
+            frames.emplace_back(std::pair(uri_, i));
+        return frames;
+    }
+
+    const auto tmpl = uri_template();
+    std::string buffer;
+    std::vector<int> file_frames;
+
+    if (frame_list_.empty())
+        file_frames.resize(count, 0);
+    else if (
+        logical_start + offset_ < 0 or
+        not frame_list_.frames(logical_start + offset_, count, file_frames))
+        file_frames.clear();
+
+    if (file_frames.empty()) {
+        // range runs outside the frame list, resolve frame by frame
+        int frame;
+        for (auto i = logical_start; i < logical_start + count; i++) {
             auto _uri = uri(i, frame);
             if (_uri)
                 frames.emplace_back(std::pair(*_uri, frame));
             else {
-                spdlog::warn("{} Invalid uri {}", __PRETTY_FUNCTION__, to_string(uri_), i);
+                spdlog::warn("{} Invalid uri {} {}", __PRETTY_FUNCTION__, to_string(uri_), i);
             }
-        } else {
-            frames.emplace_back(std::pair(uri_, i));
+        }
+        return frames;
+    }
+
+    for (size_t i = 0; i < file_frames.size(); i++) {
+        auto _uri = tmpl->uri(file_frames[i], buffer);
+        if (_uri)
+            frames.emplace_back(std::pair(*_uri, file_frames[i]));
+        else {
+            spdlog::warn(
+                "{} Invalid uri {} {}",
+                __PRETTY_FUNCTION__,
+                to_string(uri_),
+                logical_start + static_cast<int>(i));
         }
     }
 
     return frames;
 }
 
+std::shared_ptr<const UriTemplate> MediaReference::uri_template() const {
+    auto tmpl = std::atomic_load(&uri_template_);
+    if (not tmpl or tmpl->source() != uri_) {
+        tmpl = std::make_shared<const UriTemplate>(uri_);
+        std::atomic_store(&uri_template_, tmpl);
+    }
+    return tmpl;
+}
+
 std::optional<int> MediaReference::frame(const int logical_frame) const {
     if (frame_list_.empty())
         return 0;
@@ -150,12 +200,7 @@ std::optional<caf::uri> MediaReference::uri_from_frame(const int sequence_frame)
     if (container_)
         return uri_;
 
-    auto _uri =
-        caf::make_uri(uri_encode(fmt::format(uri_decode(to_string(uri_)), sequence_frame)));
-    if (_uri)
-        return *_uri;
-
-    return {};
+    return uri_template()->uri(sequence_frame);
 }
 
 void MediaReference::set_timecode(const Timecode &tc) { timecode_ = tc; }
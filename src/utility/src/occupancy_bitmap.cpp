@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+#include <stdexcept>
+
+#include "xstudio/utility/occupancy_bitmap.hpp"
+
+using namespace xstudio::utility;
+
+namespace {
+
+// index of the first bit at or after index whose value is value, or size
+size_t find_next(
+    const std::vector<uint64_t> &words, const size_t size, size_t index, const bool value) {
+    while (index < size) {
+        auto word = words[index >> 6];
+        if (not value)
+            word = ~word;
+        word &= ~uint64_t(0) << (index & 63);
+        if (word)
+            return std::min(size, (index & ~size_t(63)) + __builtin_ctzll(word));
+        index = (index & ~size_t(63)) + 64;
+    }
+    return size;
+}
+
+} // namespace
+
+OccupancyBitmap::OccupancyBitmap(
+    const size_t size, const std::vector<uint32_t> &runs, const uint64_t version)
+    : size_(size), version_(version) {
+    if (not assign_runs(runs))
+        throw std::runtime_error("Occupancy runs don't match bitmap size");
+}
+
+void OccupancyBitmap::resize(const size_t size) {
+    size_ = size;
+    words_.resize((size + 63) / 64, 0);
+    // drop anything past the end so count and equality stay exact
+    if (size & 63)
+        words_.back() &= (uint64_t(1) << (size & 63)) - 1;
+}
+
+bool OccupancyBitmap::set(const size_t index, const bool value) {
+    if (index >= size_)
+        return false;
+
+    auto &word       = words_[index >> 6];
+    const auto bit   = uint64_t(1) << (index & 63);
+    const auto prior = word;
+
+    if (value)
+        word |= bit;
+    else
+        word &= ~bit;
+
+    if (word == prior)
+        return false;
+
+    version_++;
+    return true;
+}
+
+void OccupancyBitmap::clear() {
+    for (auto &i : words_) {
+        if (i) {
+            std::fill(words_.begin(), words_.end(), 0);
+            version_++;
+            break;
+        }
+    }
+}
+
+size_t OccupancyBitmap::count() const {
+    size_t result = 0;
+    for (const auto i : words_)
+        result += __builtin_popcountll(i);
+    return result;
+}
+
+std::vector<uint32_t> OccupancyBitmap::runs() const {
+    std::vector<uint32_t> result;
+    size_t pos = 0;
+    bool value = false;
+
+    while (pos < size_) {
+        const auto next = find_next(words_, size_, pos, not value);
+        result.push_back(uint32_t(next - pos));
+        pos   = next;
+        value = not value;
+    }
+    return result;
+}
+
+bool OccupancyBitmap::assign_runs(const std::vector<uint32_t> &runs) {
+    words_.assign((size_ + 63) / 64, 0);
+
+    size_t pos = 0;
+    bool value = false;
+    for (const auto run : runs) {
+        if (pos + run > size_)
+            return false;
+        if (value) {
+            for (size_t i = pos; i < pos + run; i++)
+                words_[i >> 6] |= uint64_t(1) << (i & 63);
+        }
+        pos += run;
+        value = not value;
+    }
+    return pos == size_;
+}
+
+std::vector<std::pair<int, int>>
+OccupancyBitmap::ranges(const size_t max_frames_per_range) const {
+    std::vector<std::pair<int, int>> result;
+
+    if (max_frames_per_range <= 1) {
+        size_t pos = find_next(words_, size_, 0, true);
+        while (pos < size_) {
+            const auto end = find_next(words_, size_, pos, false);
+            result.emplace_back(int(pos), int(end - 1));
+            pos = find_next(words_, size_, end, true);
+        }
+        return result;
+    }
+
+    // sampled, matching what the cache bar has always drawn
+    bool in_range = false;
+    std::pair<int, int> r;
+    for (size_t i = 0; i < size_; i += max_frames_per_range) {
+        if (test(i) != in_range) {
+            if (not in_range) {
+                r.first = int(i);
+            } else {
+                r.second = int(i) - 1;
+                result.push_back(r);
+            }
+            in_range = not in_range;
+        }
+    }
+    if (in_range) {
+        r.second = int(size_) - 1;
+        result.push_back(r);
+    }
+    return result;
+}
@@ -0,0 +1,536 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+#include <zlib.h>
+
+#include "xstudio/utility/session_file.hpp"
+
+using namespace xstudio::utility;
+namespace fs = std::filesystem;
+
+namespace {
+
+/* File layout, all integers little endian:
+
+    0   char[8]   magic "XSTDSESS"
+    8   uint32    version
+    12  uint32    reserved
+    16  uint64    index offset
+    24  uint64    index size
+    32  ...       chunk data / index
+
+The index is zlib compressed CBOR:
+    {"h": content hash, "c": [[pointer, offset, stored, raw, crc], ...]} */
+
+constexpr char container_magic[8]   = {'X', 'S', 'T', 'D', 'S', 'E', 'S', 'S'};
+constexpr uint32_t container_version = 1;
+constexpr size_t header_size         = 32;
+constexpr int compression_level      = 3;
+
+struct PreparedChunk {
+    std::string path;
+    std::vector<uint8_t> cbor;
+    uint32_t crc{0};
+    uint64_t raw_size{0};
+    std::vector<uint8_t> stored;
+    const SessionContainerChunk *reuse{nullptr};
+};
+
+std::string io_error(const std::string &what, const std::string &path) {
+    return fmt::format("{} {}: {}", what, path, std::strerror(errno));
+}
+
+// run func(0..count-1) over a few threads
+void parallel_for(const size_t count, const std::function<void(size_t)> &func) {
+    const size_t nthreads =
+        std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+
+    if (nthreads <= 1) {
+        for (size_t i = 0; i < count; i++)
+            func(i);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < nthreads; t++) {
+        threads.emplace_back([&]() {
+            try {
+                for (auto i = next++; i < count; i = next++)
+                    func(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                error = std::current_exception();
+                next  = count;
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+std::vector<uint8_t> compress_bytes(const std::vector<uint8_t> &data) {
+    auto size = compressBound(data.size());
+    std::vector<uint8_t> result(size);
+    if (compress2(result.data(), &size, data.data(), data.size(), compression_level) != Z_OK)
+        throw std::runtime_error("Failed to compress session chunk");
+    result.resize(size);
+    return result;
+}
+
+std::vector<uint8_t> uncompress_bytes(const std::vector<uint8_t> &data, const size_t raw_size) {
+    std::vector<uint8_t> result(raw_size);
+    uLongf size = raw_size;
+    if (uncompress(result.data(), &size, data.data(), data.size()) != Z_OK or size != raw_size)
+        throw std::runtime_error("Failed to decompress session chunk");
+    return result;
+}
+
+// the points in the session layout whose children are stored as chunks
+bool is_split_point(const std::vector<std::string> &tokens) {
+    static const std::vector<std::vector<std::string>> split_points = {
+        {},                        // top level entries
+        {"actors"},                // playlists
+        {"actors", "*", "actors"}, // media, timelines, subsets
+        {"bookmarks", "actors"}};  // bookmarks
+
+    for (const auto &point : split_points) {
+        if (point.size() != tokens.size())
+            continue;
+        if (std::equal(
+                point.begin(), point.end(), tokens.begin(), [](const auto &a, const auto &b) {
+                    return a == "*" or a == b;
+                }))
+            return true;
+    }
+    return false;
+}
+
+nlohmann::json split_chunks(
+    const nlohmann::json &node,
+    const nlohmann::json::json_pointer &ptr,
+    std::vector<std::string> &tokens,
+    std::vector<std::pair<std::string, nlohmann::json>> &chunks) {
+
+    if (not node.is_object())
+        return node;
+
+    auto result     = nlohmann::json::object();
+    const auto emit = is_split_point(tokens);
+
+    for (const auto &[key, value] : node.items()) {
+        tokens.push_back(key);
+        auto child = split_chunks(value, ptr / key, tokens, chunks);
+        tokens.pop_back();
+
+        if (emit)
+            chunks.emplace_back((ptr / key).to_string(), std::move(child));
+        else
+            result[key] = std::move(child);
+    }
+
+    return result;
+}
+
+std::vector<PreparedChunk> prepare_chunks(const nlohmann::json &session) {
+    std::vector<std::pair<std::string, nlohmann::json>> split;
+    std::vector<std::string> tokens;
+    auto root = split_chunks(session, nlohmann::json::json_pointer(), tokens, split);
+    split.emplace_back("", std::move(root));
+
+    std::vector<PreparedChunk> result(split.size());
+    parallel_for(split.size(), [&](const size_t i) {
+        result[i].path = split[i].first;
+        result[i].cbor = nlohmann::json::to_cbor(split[i].second);
+        result[i].crc      = crc32(0, result[i].cbor.data(), result[i].cbor.size());
+        result[i].raw_size = result[i].cbor.size();
+    });
+
+    // parents before children, keeps the file in a sensible order
+    std::sort(result.begin(), result.end(), [](const auto &a, const auto &b) {
+        return a.path < b.path;
+    });
+    return result;
+}
+
+uint64_t content_hash(const std::vector<PreparedChunk> &chunks) {
+    // FNV-1a over pointer, crc and size of every chunk
+    uint64_t hash = 14695981039346656037ull;
+    auto mix      = [&hash](const void *data, const size_t size) {
+        auto bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    for (const auto &chunk : chunks) {
+        mix(chunk.path.data(), chunk.path.size());
+        mix(&chunk.crc, sizeof(chunk.crc));
+        mix(&chunk.raw_size, sizeof(chunk.raw_size));
+    }
+    return hash;
+}
+
+void write_all(const int fd, const uint8_t *data, size_t size, const std::string &path) {
+    while (size) {
+        auto n = ::write(fd, data, size);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(io_error("Failed to write", path));
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+void pread_all(const int fd, uint8_t *data, size_t size, uint64_t offset, const std::string &path) {
+    while (size) {
+        auto n = ::pread(fd, data, size, static_cast<off_t>(offset));
+        if (n == -1 and errno == EINTR)
+            continue;
+        if (n <= 0)
+            throw std::runtime_error(io_error("Failed to read", path));
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+}
+
+std::vector<uint8_t> make_header(const uint64_t index_offset, const uint64_t index_size) {
+    std::vector<uint8_t> header(header_size, 0);
+    std::memcpy(header.data(), container_magic, sizeof(container_magic));
+    std::memcpy(header.data() + 8, &container_version, sizeof(container_version));
+    std::memcpy(header.data() + 16, &index_offset, sizeof(index_offset));
+    std::memcpy(header.data() + 24, &index_size, sizeof(index_size));
+    return header;
+}
+
+std::vector<uint8_t>
+make_index(const std::vector<SessionContainerChunk> &chunks, const uint64_t hash) {
+    auto entries = nlohmann::json::array();
+    for (const auto &chunk : chunks)
+        entries.push_back(
+            {chunk.path, chunk.offset, chunk.stored_size, chunk.raw_size, chunk.crc});
+    return compress_bytes(nlohmann::json::to_cbor(nlohmann::json{{"h", hash}, {"c", entries}}));
+}
+
+} // namespace
+
+SessionContainerReader::SessionContainerReader(const std::string &path) : path_(path) {
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ == -1)
+        throw std::runtime_error(io_error("Failed to open", path));
+
+    try {
+        struct stat st;
+        if (fstat(fd_, &st) == -1)
+            throw std::runtime_error(io_error("Failed to stat", path));
+        file_size_ = static_cast<uint64_t>(st.st_size);
+
+        if (file_size_ < header_size)
+            throw std::runtime_error("Not a session container " + path);
+
+        uint8_t header[header_size];
+        pread_all(fd_, header, header_size, 0, path_);
+
+        uint32_t version      = 0;
+        uint64_t index_offset = 0;
+        uint64_t index_size   = 0;
+        std::memcpy(&version, header + 8, sizeof(version));
+        std::memcpy(&index_offset, header + 16, sizeof(index_offset));
+        std::memcpy(&index_size, header + 24, sizeof(index_size));
+
+        if (std::memcmp(header, container_magic, sizeof(container_magic)) != 0)
+            throw std::runtime_error("Not a session container " + path);
+        if (version != container_version)
+            throw std::runtime_error(
+                fmt::format("Unsupported session container version {} {}", version, path));
+        if (index_offset < header_size or index_offset + index_size > file_size_)
+            throw std::runtime_error("Corrupt session container index " + path);
+
+        std::vector<uint8_t> stored(index_size);
+        pread_all(fd_, stored.data(), index_size, index_offset, path_);
+
+        // the index is small, its raw size isn't recorded so inflate by stream
+        std::vector<uint8_t> raw;
+        z_stream zs{};
+        if (inflateInit(&zs) != Z_OK)
+            throw std::runtime_error("Failed to read session container index " + path);
+        zs.next_in  = stored.data();
+        zs.avail_in = static_cast<uInt>(stored.size());
+        int status  = Z_OK;
+        uint8_t buffer[65536];
+        while (status == Z_OK) {
+            zs.next_out  = buffer;
+            zs.avail_out = sizeof(buffer);
+            status       = inflate(&zs, Z_NO_FLUSH);
+            raw.insert(raw.end(), buffer, buffer + (sizeof(buffer) - zs.avail_out));
+        }
+        inflateEnd(&zs);
+        if (status != Z_STREAM_END)
+            throw std::runtime_error("Corrupt session container index " + path);
+
+        auto index = nlohmann::json::from_cbor(raw);
+        hash_      = index.at("h").get<uint64_t>();
+        for (const auto &entry : index.at("c")) {
+            SessionContainerChunk chunk;
+            chunk.path        = entry.at(0).get<std::string>();
+            chunk.offset      = entry.at(1).get<uint64_t>();
+            chunk.stored_size = entry.at(2).get<uint64_t>();
+            chunk.raw_size    = entry.at(3).get<uint64_t>();
+            chunk.crc         = entry.at(4).get<uint32_t>();
+            if (chunk.offset + chunk.stored_size > file_size_)
+                throw std::runtime_error("Corrupt session container chunk " + path);
+            chunks_.push_back(chunk);
+        }
+    } catch (...) {
+        ::close(fd_);
+        fd_ = -1;
+        throw;
+    }
+}
+
+SessionContainerReader::~SessionContainerReader() {
+    if (fd_ != -1)
+        ::close(fd_);
+}
+
+const SessionContainerChunk *SessionContainerReader::find(const std::string &path) const {
+    auto it = std::lower_bound(
+        chunks_.begin(), chunks_.end(), path, [](const auto &chunk, const auto &value) {
+            return chunk.path < value;
+        });
+    if (it != chunks_.end() and it->path == path)
+        return &(*it);
+    return nullptr;
+}
+
+std::vector<uint8_t>
+SessionContainerReader::read_stored(const SessionContainerChunk &chunk) const {
+    std::vector<uint8_t> result(chunk.stored_size);
+    pread_all(fd_, result.data(), chunk.stored_size, chunk.offset, path_);
+    return result;
+}
+
+nlohmann::json SessionContainerReader::read_chunk(const SessionContainerChunk &chunk) const {
+    auto raw = uncompress_bytes(read_stored(chunk), chunk.raw_size);
+    if (crc32(0, raw.data(), raw.size()) != chunk.crc)
+        throw std::runtime_error(
+            fmt::format("Checksum mismatch in session chunk {} {}", chunk.path, path_));
+    return nlohmann::json::from_cbor(raw);
+}
+
+nlohmann::json SessionContainerReader::read() const {
+    std::vector<nlohmann::json> values(chunks_.size());
+    parallel_for(chunks_.size(), [&](const size_t i) { values[i] = read_chunk(chunks_[i]); });
+
+    // chunks are sorted by pointer, so parents come before their children
+    nlohmann::json result;
+    for (size_t i = 0; i < chunks_.size(); i++)
+        result[nlohmann::json::json_pointer(chunks_[i].path)] = std::move(values[i]);
+    return result;
+}
+
+bool xstudio::utility::is_session_container_path(const std::string &path) {
+    return fs::path(path).extension() == session_container_extension;
+}
+
+bool xstudio::utility::is_session_file_path(const std::string &path) {
+    auto ext = fs::path(path).extension();
+    return ext == session_container_extension or ext == session_json_extension;
+}
+
+bool xstudio::utility::is_session_container(const std::string &path) {
+    std::ifstream i(path, std::ios::binary);
+    char magic[sizeof(container_magic)] = {};
+    i.read(magic, sizeof(magic));
+    return i and std::memcmp(magic, container_magic, sizeof(container_magic)) == 0;
+}
+
+nlohmann::json xstudio::utility::read_session_file(const std::string &path) {
+    if (is_session_container(path))
+        return SessionContainerReader(path).read();
+
+    nlohmann::json result;
+    std::ifstream i(path);
+    if (not i.is_open())
+        throw std::runtime_error(io_error("Failed to open", path));
+    i >> result;
+    return result;
+}
+
+uint64_t xstudio::utility::session_container_hash(const nlohmann::json &session) {
+    return content_hash(prepare_chunks(session));
+}
+
+SessionContainerWrite xstudio::utility::write_session_container(
+    const std::string &path,
+    const nlohmann::json &session,
+    const uint64_t skip_hash,
+    const std::string &base) {
+
+    SessionContainerWrite result;
+
+    auto chunks   = prepare_chunks(session);
+    result.hash   = content_hash(chunks);
+    result.chunks = chunks.size();
+    if (result.hash == skip_hash)
+        return result;
+
+    std::unique_ptr<SessionContainerReader> base_reader;
+    if (not base.empty() and fs::exists(base) and is_session_container(base)) {
+        try {
+            base_reader = std::make_unique<SessionContainerReader>(base);
+        } catch (const std::exception &) {
+            // unusable base, write everything
+        }
+    }
+
+    // match chunks against the base
+    uint64_t reused_bytes = 0;
+    if (base_reader) {
+        for (auto &chunk : chunks) {
+            auto existing = base_reader->find(chunk.path);
+            if (existing and existing->crc == chunk.crc and
+                existing->raw_size == chunk.raw_size) {
+                chunk.reuse = existing;
+                reused_bytes += existing->stored_size;
+            }
+        }
+    }
+
+    parallel_for(chunks.size(), [&](const size_t i) {
+        if (not chunks[i].reuse)
+            chunks[i].stored = compress_bytes(chunks[i].cbor);
+        chunks[i].cbor.clear();
+        chunks[i].cbor.shrink_to_fit();
+    });
+
+    uint64_t new_bytes = 0;
+    for (const auto &chunk : chunks)
+        new_bytes += chunk.stored.size();
+
+    std::vector<SessionContainerChunk> index;
+    index.reserve(chunks.size());
+
+    const auto in_place = base_reader and fs::exists(path) and
+                          fs::equivalent(fs::path(base), fs::path(path)) and
+                          // compact once more than half the file would be garbage
+                          (reused_bytes + new_bytes) * 2 > base_reader->file_size() + new_bytes;
+
+    if (in_place) {
+        // append changed chunks and a new index, then switch the header over.
+        auto fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+        if (fd == -1)
+            throw std::runtime_error(io_error("Failed to open", path));
+
+        try {
+            uint64_t offset = base_reader->file_size();
+            if (::lseek(fd, static_cast<off_t>(offset), SEEK_SET) == -1)
+                throw std::runtime_error(io_error("Failed to seek", path));
+
+            for (const auto &chunk : chunks) {
+                if (chunk.reuse) {
+                    index.push_back(*chunk.reuse);
+                } else {
+                    write_all(fd, chunk.stored.data(), chunk.stored.size(), path);
+                    index.push_back(SessionContainerChunk{
+                        chunk.path,
+                        offset,
+                        chunk.stored.size(),
+                        chunk.raw_size,
+                        chunk.crc});
+                    offset += chunk.stored.size();
+                    result.chunks_written++;
+                    result.bytes_written += chunk.stored.size();
+                }
+            }
+
+            auto index_bytes = make_index(index, result.hash);
+            write_all(fd, index_bytes.data(), index_bytes.size(), path);
+            ::fdatasync(fd);
+
+            auto header = make_header(offset, index_bytes.size());
+            if (::pwrite(fd, header.data(), header.size(), 0) !=
+                static_cast<ssize_t>(header.size()))
+                throw std::runtime_error(io_error("Failed to write header", path));
+            ::fdatasync(fd);
+            result.bytes_written += index_bytes.size();
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+    } else {
+        // fresh file next to the target, renamed over it when complete.
+        const auto tmp_path = path + ".tmp";
+        auto fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd == -1)
+            throw std::runtime_error(io_error("Failed to create", tmp_path));
+
+        try {
+            auto header = make_header(0, 0);
+            write_all(fd, header.data(), header.size(), tmp_path);
+            uint64_t offset = header_size;
+
+            for (const auto &chunk : chunks) {
+                std::vector<uint8_t> stored;
+                SessionContainerChunk entry{chunk.path, offset, 0, chunk.raw_size, chunk.crc};
+
+                if (chunk.reuse) {
+                    stored = base_reader->read_stored(*chunk.reuse);
+                } else {
+                    result.chunks_written++;
+                }
+                const auto &bytes = chunk.reuse ? stored : chunk.stored;
+                write_all(fd, bytes.data(), bytes.size(), tmp_path);
+                entry.stored_size = bytes.size();
+                offset += bytes.size();
+                result.bytes_written += bytes.size();
+                index.push_back(entry);
+            }
+
+            auto index_bytes = make_index(index, result.hash);
+            write_all(fd, index_bytes.data(), index_bytes.size(), tmp_path);
+
+            header = make_header(offset, index_bytes.size());
+            if (::pwrite(fd, header.data(), header.size(), 0) !=
+                static_cast<ssize_t>(header.size()))
+                throw std::runtime_error(io_error("Failed to write header", tmp_path));
+            ::fdatasync(fd);
+            result.bytes_written += index_bytes.size() + header.size();
+        } catch (...) {
+            ::close(fd);
+            fs::remove(tmp_path);
+            throw;
+        }
+        ::close(fd);
+        fs::rename(tmp_path, path);
+        result.compacted = base_reader and fs::equivalent(fs::path(base), fs::path(path));
+    }
+
+    result.written = true;
+    return result;
+}
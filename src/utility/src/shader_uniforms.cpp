@@ -0,0 +1,294 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <array>
+#include <functional>
+#include <stdexcept>
+
+#include "xstudio/utility/shader_uniforms.hpp"
+
+using namespace xstudio::utility;
+
+namespace {
+
+using Type = ShaderUniforms::Type;
+
+const std::array<std::pair<const char *, Type>, 13> s_type_names = {
+    {{"bool", Type::Bool},
+     {"int", Type::Int},
+     {"uint", Type::UInt},
+     {"float", Type::Float},
+     {"vec2", Type::Vec2},
+     {"vec3", Type::Vec3},
+     {"colour", Type::Vec3},
+     {"vec4", Type::Vec4},
+     {"ivec2", Type::IVec2},
+     {"ivec3", Type::IVec3},
+     {"ivec4", Type::IVec4},
+     {"mat3", Type::Mat3},
+     {"mat4", Type::Mat4}}};
+
+// number of values in the json form
+size_t component_count(const Type type) {
+    switch (type) {
+    case Type::Vec2:
+    case Type::IVec2:
+        return 2;
+    case Type::Vec3:
+    case Type::IVec3:
+        return 3;
+    case Type::Vec4:
+    case Type::IVec4:
+        return 4;
+    case Type::Mat3:
+        return 9;
+    case Type::Mat4:
+        return 16;
+    default:
+        return 1;
+    }
+}
+
+bool is_integer(const Type type) {
+    return type == Type::Bool or type == Type::Int or type == Type::UInt or
+           type == Type::IVec2 or type == Type::IVec3 or type == Type::IVec4;
+}
+
+} // namespace
+
+size_t ShaderUniforms::std140_alignment(const Type type) {
+    switch (type) {
+    case Type::Vec2:
+    case Type::IVec2:
+        return 8;
+    case Type::Vec3:
+    case Type::Vec4:
+    case Type::IVec3:
+    case Type::IVec4:
+    case Type::Mat3:
+    case Type::Mat4:
+        return 16;
+    default:
+        return 4;
+    }
+}
+
+size_t ShaderUniforms::std140_size(const Type type) {
+    switch (type) {
+    case Type::Vec2:
+    case Type::IVec2:
+        return 8;
+    case Type::Vec3:
+    case Type::IVec3:
+        return 12;
+    case Type::Vec4:
+    case Type::IVec4:
+        return 16;
+    // matrix columns are padded to vec4s
+    case Type::Mat3:
+        return 48;
+    case Type::Mat4:
+        return 64;
+    default:
+        return 4;
+    }
+}
+
+const char *ShaderUniforms::type_name(const Type type) {
+    for (const auto &p : s_type_names) {
+        if (p.second == type)
+            return p.first;
+    }
+    return "";
+}
+
+const ShaderUniforms::Member *ShaderUniforms::find(const std::string &name) const {
+    // blocks are small, a linear search beats a map
+    for (const auto &member : members_) {
+        if (member.name == name)
+            return &member;
+    }
+    return nullptr;
+}
+
+void ShaderUniforms::store(const std::string &name, const Type type, const void *value) {
+    const auto *member = find(name);
+    if (member and member->type != type)
+        throw std::runtime_error(
+            "Shader uniform " + name + " is a " + type_name(member->type) + " not a " +
+            type_name(type));
+
+    if (not member) {
+        const auto alignment = std140_alignment(type);
+        size_t offset        = 0;
+        if (not members_.empty())
+            offset = members_.back().offset + std140_size(members_.back().type);
+        offset = (offset + alignment - 1) & ~(alignment - 1);
+
+        members_.push_back(Member{name, type, uint32_t(offset)});
+        data_.resize((offset + std140_size(type) + 15) & ~size_t(15));
+        layout_id_ = (layout_id_ * 1099511628211ull) ^
+                     (std::hash<std::string>()(name) + uint64_t(type) + 1);
+        member = &members_.back();
+    }
+
+    std::memcpy(data_.data() + member->offset, value, std140_size(type));
+}
+
+void ShaderUniforms::set(const std::string &name, const bool value) {
+    const uint32_t v = value ? 1 : 0;
+    store(name, Type::Bool, &v);
+}
+
+void ShaderUniforms::set(const std::string &name, const int value) {
+    store(name, Type::Int, &value);
+}
+
+void ShaderUniforms::set(const std::string &name, const unsigned int value) {
+    store(name, Type::UInt, &value);
+}
+
+void ShaderUniforms::set(const std::string &name, const float value) {
+    store(name, Type::Float, &value);
+}
+
+void ShaderUniforms::set(const std::string &name, const Imath::V2f &value) {
+    store(name, Type::Vec2, &value.x);
+}
+
+void ShaderUniforms::set(const std::string &name, const Imath::V3f &value) {
+    store(name, Type::Vec3, &value.x);
+}
+
+void ShaderUniforms::set(const std::string &name, const Imath::V4f &value) {
+    store(name, Type::Vec4, &value.x);
+}
+
+void ShaderUniforms::set(const std::string &name, const Imath::V2i &value) {
+    store(name, Type::IVec2, &value.x);
+}
+
+void ShaderUniforms::set(const std::string &name, const Imath::V3i &value) {
+    store(name, Type::IVec3, &value.x);
+}
+
+void ShaderUniforms::set(const std::string &name, const Imath::V4i &value) {
+    store(name, Type::IVec4, &value.x);
+}
+
+// Matrices go in with the same element order as their json form, which is
+// what glUniformMatrix*fv is given elsewhere: one GLSL column per Imath
+// column.
+void ShaderUniforms::set(const std::string &name, const Imath::M33f &value) {
+    std::array<float, 12> columns = {};
+    for (int c = 0; c < 3; ++c)
+        for (int r = 0; r < 3; ++r)
+            columns[c * 4 + r] = value[r][c];
+    store(name, Type::Mat3, columns.data());
+}
+
+void ShaderUniforms::set(const std::string &name, const Imath::M44f &value) {
+    std::array<float, 16> columns = {};
+    for (int c = 0; c < 4; ++c)
+        for (int r = 0; r < 4; ++r)
+            columns[c * 4 + r] = value[r][c];
+    store(name, Type::Mat4, columns.data());
+}
+
+void ShaderUniforms::clear() {
+    members_.clear();
+    data_.clear();
+    layout_id_ = 0;
+}
+
+JsonStore ShaderUniforms::to_json() const {
+    JsonStore result(nlohmann::json::object());
+    for (const auto &member : members_) {
+        const auto *value = data_.data() + member.offset;
+        if (member.type == Type::Bool or member.type == Type::Int or
+            member.type == Type::UInt or member.type == Type::Float) {
+            // plain values, as they'd be written by hand
+            int32_t i;
+            uint32_t u;
+            float f;
+            std::memcpy(&i, value, 4);
+            std::memcpy(&u, value, 4);
+            std::memcpy(&f, value, 4);
+            if (member.type == Type::Bool)
+                result[member.name] = u != 0;
+            else if (member.type == Type::Int)
+                result[member.name] = i;
+            else if (member.type == Type::UInt)
+                result[member.name] = u;
+            else
+                result[member.name] = f;
+            continue;
+        }
+
+        auto item        = nlohmann::json::array({type_name(member.type), 1});
+        const auto count = component_count(member.type);
+        for (size_t i = 0; i < count; ++i) {
+            // skip the padding at the end of each matrix column
+            const auto index = member.type == Type::Mat3 ? (i / 3) * 4 + i % 3 : i;
+            if (is_integer(member.type)) {
+                int32_t v;
+                std::memcpy(&v, value + index * 4, 4);
+                item.push_back(v);
+            } else {
+                float v;
+                std::memcpy(&v, value + index * 4, 4);
+                item.push_back(v);
+            }
+        }
+        result[member.name] = item;
+    }
+    return result;
+}
+
+ShaderUniforms ShaderUniforms::from_json(const nlohmann::json &json) {
+    ShaderUniforms result;
+    for (auto it = json.begin(); it != json.end(); ++it) {
+        const auto &v = it.value();
+        if (v.is_boolean()) {
+            result.set(it.key(), v.get<bool>());
+        } else if (v.is_number_integer()) {
+            // unsigned too, as the json fallback for plain uniforms does
+            result.set(it.key(), v.get<int>());
+        } else if (v.is_number_float()) {
+            result.set(it.key(), v.get<float>());
+        } else if (v.is_array() and v.size() >= 2 and v[0].is_string()) {
+
+            Type type       = Type::Float;
+            bool known      = false;
+            const auto name = v[0].get<std::string>();
+            for (const auto &p : s_type_names) {
+                if (name == p.first) {
+                    type  = p.second;
+                    known = true;
+                }
+            }
+            const auto count = known ? component_count(type) : 0;
+            if (not known or v[1].get<int>() != 1 or v.size() != count + 2)
+                throw std::runtime_error(
+                    "Shader uniform " + it.key() + " can't be used in a uniform block");
+
+            // padded the way std140 lays it out
+            std::array<uint32_t, 16> values = {};
+            for (size_t i = 0; i < count; ++i) {
+                const auto index = type == Type::Mat3 ? (i / 3) * 4 + i % 3 : i;
+                if (is_integer(type)) {
+                    const auto iv = v[i + 2].get<int32_t>();
+                    std::memcpy(&values[index], &iv, 4);
+                } else {
+                    const auto fv = v[i + 2].get<float>();
+                    std::memcpy(&values[index], &fv, 4);
+                }
+            }
+            if (type == Type::Bool)
+                values[0] = values[0] != 0;
+            result.store(it.key(), type, values.data());
+        } else {
+            throw std::runtime_error(
+                "Shader uniform " + it.key() + " can't be used in a uniform block");
+        }
+    }
+    return result;
+}
@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "xstudio/utility/shared_memory.hpp"
+
+using namespace xstudio::utility;
+
+namespace {
+std::string shm_error(const std::string &what, const std::string &name) {
+    return fmt::format("{} \"{}\": {}", what, name, std::strerror(errno));
+}
+} // namespace
+
+SharedMemorySegment::~SharedMemorySegment() {
+    if (addr_)
+        munmap(addr_, size_);
+    if (owner_)
+        unlink();
+}
+
+std::shared_ptr<SharedMemorySegment>
+SharedMemorySegment::create(const size_t size, const std::string &name) {
+    auto result   = std::make_shared<SharedMemorySegment>();
+    result->name_ = name.empty() ? unique_shared_memory_name() : name;
+    result->size_ = size;
+
+    auto fd = shm_open(result->name_.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd == -1)
+        throw std::runtime_error(shm_error("Failed to create shared memory", result->name_));
+    result->owner_ = true;
+
+    if (ftruncate(fd, static_cast<off_t>(size)) == -1) {
+        close(fd);
+        throw std::runtime_error(shm_error("Failed to size shared memory", result->name_));
+    }
+
+    if (size) {
+        result->addr_ = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (result->addr_ == MAP_FAILED) {
+            result->addr_ = nullptr;
+            close(fd);
+            throw std::runtime_error(shm_error("Failed to map shared memory", result->name_));
+        }
+    }
+    close(fd);
+
+    return result;
+}
+
+std::shared_ptr<SharedMemorySegment>
+SharedMemorySegment::open(const std::string &name, const bool read_only, const size_t size) {
+    auto result   = std::make_shared<SharedMemorySegment>();
+    result->name_ = name;
+
+    auto fd = shm_open(name.c_str(), read_only ? O_RDONLY : O_RDWR, 0);
+    if (fd == -1)
+        throw std::runtime_error(shm_error("Failed to open shared memory", name));
+
+    result->size_ = size;
+    if (not result->size_) {
+        struct stat st;
+        if (fstat(fd, &st) == -1) {
+            close(fd);
+            throw std::runtime_error(shm_error("Failed to stat shared memory", name));
+        }
+        result->size_ = static_cast<size_t>(st.st_size);
+    }
+
+    if (result->size_) {
+        result->addr_ = mmap(
+            nullptr,
+            result->size_,
+            read_only ? PROT_READ : PROT_READ | PROT_WRITE,
+            MAP_SHARED,
+            fd,
+            0);
+        if (result->addr_ == MAP_FAILED) {
+            result->addr_ = nullptr;
+            close(fd);
+            throw std::runtime_error(shm_error("Failed to map shared memory", name));
+        }
+    }
+    close(fd);
+
+    return result;
+}
+
+void SharedMemorySegment::unlink() {
+    if (not unlinked_ and not name_.empty()) {
+        shm_unlink(name_.c_str());
+        unlinked_ = true;
+    }
+    owner_ = false;
+}
+
+std::string xstudio::utility::unique_shared_memory_name(const std::string &prefix) {
+    static std::atomic<uint64_t> s_counter{0};
+    return fmt::format("/{}_{}_{}", prefix, getpid(), s_counter++);
+}
@@ -0,0 +1,430 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "xstudio/utility/shm_channel.hpp"
+
+using namespace xstudio::utility;
+
+namespace {
+
+constexpr uint32_t ring_magic   = 0x78534852; // 'xSHR'
+constexpr uint32_t ring_version = 1;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+size_t header_size() { return (sizeof(ShmRingBuffer::Header) + 63) & ~size_t(63); }
+
+std::string socket_error(const std::string &what) {
+    return fmt::format("{}: {}", what, std::strerror(errno));
+}
+
+std::string random_token() {
+    std::random_device rd;
+    return fmt::format("{:08x}{:08x}{:08x}{:08x}", rd(), rd(), rd(), rd());
+}
+
+std::string default_socket_path() {
+    static std::atomic<int> s_counter{0};
+    const char *runtime_dir = std::getenv("XDG_RUNTIME_DIR");
+    return fmt::format(
+        "{}/xstudio_api_{}_{}.sock",
+        runtime_dir and *runtime_dir ? runtime_dir : "/tmp",
+        getpid(),
+        s_counter++);
+}
+
+bool send_all(const int fd, const std::string &data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        auto n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            if (n == -1 and errno == EINTR)
+                continue;
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// read the newline terminated handshake, one byte at a time so we never eat
+// into the wake up bytes that follow it.
+std::string read_line(const int fd, const std::chrono::milliseconds timeout) {
+    std::string result;
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (true) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0)
+            throw std::runtime_error("Timeout waiting for shared memory handshake");
+
+        pollfd pfd{fd, POLLIN, 0};
+        auto ready = poll(&pfd, 1, static_cast<int>(remaining.count()));
+        if (ready == -1 and errno == EINTR)
+            continue;
+        if (ready <= 0)
+            continue;
+
+        char c;
+        auto n = ::recv(fd, &c, 1, 0);
+        if (n <= 0)
+            throw std::runtime_error("Shared memory handshake failed, connection closed");
+        if (c == '\n')
+            break;
+        result.push_back(c);
+    }
+    return result;
+}
+
+} // namespace
+
+size_t ShmRingBuffer::segment_size(const size_t capacity) { return header_size() + capacity; }
+
+ShmRingBuffer::ShmRingBuffer(SharedMemorySegmentPtr segment, const bool initialise)
+    : segment_(std::move(segment)) {
+
+    if (not segment_ or segment_->size() <= header_size())
+        throw std::runtime_error("Shared memory segment too small for ring buffer");
+
+    header_ = reinterpret_cast<Header *>(segment_->data());
+    data_   = segment_->data() + header_size();
+
+    if (initialise) {
+        new (header_) Header();
+        header_->magic    = ring_magic;
+        header_->version  = ring_version;
+        header_->capacity = segment_->size() - header_size();
+        header_->write_pos.store(0);
+        header_->read_pos.store(0);
+        header_->reader_waiting.store(0);
+        header_->closed.store(0);
+        header_->frames_written.store(0);
+        header_->frames_acknowledged.store(0);
+    } else if (
+        header_->magic != ring_magic or header_->version != ring_version or
+        header_->capacity != segment_->size() - header_size()) {
+        throw std::runtime_error("Incompatible shared memory ring buffer");
+    }
+}
+
+size_t ShmRingBuffer::readable() const {
+    return header_->write_pos.load(std::memory_order_acquire) -
+           header_->read_pos.load(std::memory_order_relaxed);
+}
+
+size_t ShmRingBuffer::writable() const {
+    return header_->capacity - (header_->write_pos.load(std::memory_order_relaxed) -
+                                header_->read_pos.load(std::memory_order_acquire));
+}
+
+size_t ShmRingBuffer::write_some(const std::byte *data, const size_t size) {
+    const auto pos   = header_->write_pos.load(std::memory_order_relaxed);
+    const auto count = std::min(size, writable());
+    if (not count)
+        return 0;
+
+    const auto offset = pos % header_->capacity;
+    const auto first  = std::min(count, header_->capacity - offset);
+    std::memcpy(data_ + offset, data, first);
+    if (count > first)
+        std::memcpy(data_, data + first, count - first);
+
+    header_->write_pos.store(pos + count, std::memory_order_release);
+    return count;
+}
+
+size_t ShmRingBuffer::read_some(std::byte *data, const size_t size) {
+    const auto pos   = header_->read_pos.load(std::memory_order_relaxed);
+    const auto count = std::min(size, readable());
+    if (not count)
+        return 0;
+
+    const auto offset = pos % header_->capacity;
+    const auto first  = std::min(count, header_->capacity - offset);
+    std::memcpy(data, data_ + offset, first);
+    if (count > first)
+        std::memcpy(data + first, data_, count - first);
+
+    header_->read_pos.store(pos + count, std::memory_order_release);
+    return count;
+}
+
+ShmChannel::ShmChannel(
+    const int socket_fd,
+    SharedMemorySegmentPtr inbound,
+    SharedMemorySegmentPtr outbound,
+    const bool initialise,
+    std::string token)
+    : socket_fd_(socket_fd),
+      inbound_(std::move(inbound), initialise),
+      outbound_(std::move(outbound), initialise),
+      token_(std::move(token)) {}
+
+ShmChannel::~ShmChannel() {
+    close();
+    if (socket_fd_ != -1)
+        ::close(socket_fd_);
+}
+
+ShmChannelPtr
+ShmChannel::connect(const std::string &socket_path, const std::chrono::milliseconds timeout) {
+    sockaddr_un addr{};
+    if (socket_path.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error("Socket path too long " + socket_path);
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    auto fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+        throw std::runtime_error(socket_error("Failed to create socket"));
+
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1) {
+        auto err = socket_error("Failed to connect to " + socket_path);
+        ::close(fd);
+        throw std::runtime_error(err);
+    }
+
+    try {
+        // "xstudio-shm <version> <client to server> <server to client> <token>"
+        std::istringstream handshake(read_line(fd, timeout));
+        std::string magic, inbound_name, outbound_name, token;
+        uint32_t version = 0;
+        handshake >> magic >> version >> outbound_name >> inbound_name >> token;
+
+        if (magic != "xstudio-shm" or version != ring_version or token.empty())
+            throw std::runtime_error("Unexpected shared memory handshake");
+
+        auto inbound  = SharedMemorySegment::open(inbound_name, false);
+        auto outbound = SharedMemorySegment::open(outbound_name, false);
+        // both ends are mapped now, nobody else needs the names.
+        inbound->unlink();
+        outbound->unlink();
+
+        return std::make_shared<ShmChannel>(fd, inbound, outbound, false, token);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+}
+
+void ShmChannel::notify_reader() {
+    if (outbound_.header().reader_waiting.exchange(0)) {
+        const char c = 0;
+        // if the socket buffer is full the reader has wake ups pending anyway
+        ::send(socket_fd_, &c, 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+    }
+}
+
+bool ShmChannel::send(const std::byte *data, const size_t size) {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+
+    const uint64_t frame_size = size;
+    const std::byte *parts[2] = {reinterpret_cast<const std::byte *>(&frame_size), data};
+    const size_t part_sizes[2] = {sizeof(frame_size), size};
+
+    for (size_t i = 0; i < 2; i++) {
+        auto ptr       = parts[i];
+        auto remaining = part_sizes[i];
+        while (remaining) {
+            if (not is_open())
+                return false;
+
+            auto written = outbound_.write_some(ptr, remaining);
+            if (written) {
+                ptr += written;
+                remaining -= written;
+                notify_reader();
+            } else {
+                // ring full, the frame is bigger than the ring or the reader
+                // is behind, give it a moment to drain.
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+            }
+        }
+    }
+
+    outbound_.header().frames_written.fetch_add(1);
+    notify_reader();
+    return true;
+}
+
+bool ShmChannel::wait_for_data() {
+    auto &header = inbound_.header();
+
+    header.reader_waiting.store(1);
+    if (inbound_.readable()) {
+        header.reader_waiting.store(0);
+        return true;
+    }
+
+    if (not is_open())
+        return false;
+
+    // wake periodically to notice a close from our own side
+    pollfd pfd{socket_fd_, POLLIN, 0};
+    auto ready = poll(&pfd, 1, 100);
+    if (ready == -1 and errno != EINTR) {
+        close();
+        return false;
+    }
+
+    if (ready > 0) {
+        if (pfd.revents & (POLLHUP | POLLERR)) {
+            close();
+            return inbound_.readable() != 0;
+        }
+        char buf[64];
+        auto n = ::recv(socket_fd_, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n == 0) {
+            close();
+            return inbound_.readable() != 0;
+        }
+    }
+    return true;
+}
+
+bool ShmChannel::read_exact(std::byte *data, size_t size) {
+    while (size) {
+        auto got = inbound_.read_some(data, size);
+        if (got) {
+            data += got;
+            size -= got;
+        } else if (not wait_for_data()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ShmChannel::receive(std::vector<std::byte> &frame) {
+    uint64_t frame_size = 0;
+    if (not read_exact(reinterpret_cast<std::byte *>(&frame_size), sizeof(frame_size)))
+        return false;
+
+    frame.resize(frame_size);
+    return read_exact(frame.data(), frame_size);
+}
+
+void ShmChannel::acknowledge() { inbound_.header().frames_acknowledged.fetch_add(1); }
+
+bool ShmChannel::wait_acknowledged(const std::chrono::milliseconds timeout) {
+    auto &header  = outbound_.header();
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (header.frames_acknowledged.load() < header.frames_written.load()) {
+        if (not is_open() or std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+    return true;
+}
+
+bool ShmChannel::is_open() const {
+    return not closed_ and not inbound_.header().closed and not outbound_.header().closed;
+}
+
+void ShmChannel::close() {
+    if (closed_.exchange(true))
+        return;
+
+    inbound_.header().closed.store(1);
+    outbound_.header().closed.store(1);
+    if (socket_fd_ != -1)
+        ::shutdown(socket_fd_, SHUT_RDWR);
+}
+
+ShmChannelListener::ShmChannelListener(const std::string &socket_path, const size_t capacity)
+    : path_(socket_path.empty() ? default_socket_path() : socket_path), capacity_(capacity) {
+
+    sockaddr_un addr{};
+    if (path_.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error("Socket path too long " + path_);
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path_.c_str(), sizeof(addr.sun_path) - 1);
+
+    socket_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socket_fd_ == -1)
+        throw std::runtime_error(socket_error("Failed to create socket"));
+
+    ::unlink(path_.c_str());
+    // only the current user may connect
+    auto old_mask = umask(S_IRWXG | S_IRWXO);
+    auto bound    = bind(socket_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    umask(old_mask);
+
+    if (bound == -1 or listen(socket_fd_, 8) == -1) {
+        auto err = socket_error("Failed to listen on " + path_);
+        ::close(socket_fd_);
+        socket_fd_ = -1;
+        throw std::runtime_error(err);
+    }
+}
+
+ShmChannelListener::~ShmChannelListener() {
+    close();
+    if (socket_fd_ != -1) {
+        ::close(socket_fd_);
+        ::unlink(path_.c_str());
+    }
+}
+
+void ShmChannelListener::close() {
+    if (not closed_.exchange(true) and socket_fd_ != -1)
+        ::shutdown(socket_fd_, SHUT_RDWR);
+}
+
+ShmChannelPtr ShmChannelListener::accept() {
+    while (not closed_) {
+        pollfd pfd{socket_fd_, POLLIN, 0};
+        auto ready = poll(&pfd, 1, 200);
+        if (ready <= 0 or closed_)
+            continue;
+
+        auto fd = ::accept4(socket_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd == -1)
+            continue;
+
+        try {
+            auto size = ShmRingBuffer::segment_size(capacity_);
+            // named from the client's point of view
+            auto client_to_server = SharedMemorySegment::create(size);
+            auto server_to_client = SharedMemorySegment::create(size);
+            auto channel          = std::make_shared<ShmChannel>(
+                fd, client_to_server, server_to_client, true, random_token());
+
+            if (not send_all(
+                    fd,
+                    fmt::format(
+                        "xstudio-shm {} {} {} {}\n",
+                        ring_version,
+                        client_to_server->name(),
+                        server_to_client->name(),
+                        channel->token())))
+                continue;
+
+            return channel;
+        } catch (...) {
+            ::close(fd);
+        }
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <cctype>
+#include <iterator>
+
+#include <fmt/format.h>
+
+#include "xstudio/utility/helpers.hpp"
+#include "xstudio/utility/uri_template.hpp"
+
+using namespace xstudio::utility;
+
+UriTemplate::UriTemplate(const caf::uri &uri)
+    : source_(uri), decoded_(uri_decode(to_string(uri))) {
+
+    // find the replacement field, escaped braces or more than one field
+    // aren't compiled.
+    size_t open   = std::string::npos;
+    size_t close  = std::string::npos;
+    size_t fields = 0;
+    for (size_t i = 0; i < decoded_.size(); i++) {
+        if (decoded_[i] == '{') {
+            const auto end = decoded_.find('}', i);
+            if (end == std::string::npos or decoded_.find('{', i + 1) < end)
+                return;
+            open  = i;
+            close = end;
+            i     = end;
+            fields++;
+        } else if (decoded_[i] == '}') {
+            return;
+        }
+    }
+
+    if (fields > 1)
+        return;
+
+    if (not fields) {
+        prefix_ = uri_encode(decoded_);
+    } else {
+        const auto prefix = decoded_.substr(0, open);
+        prefix_           = uri_encode(prefix);
+        field_            = decoded_.substr(open, close - open + 1);
+        // encoding depends on whether a query has started, so encode the
+        // suffix in the context of the prefix
+        suffix_ = uri_encode(prefix + decoded_.substr(close + 1)).substr(prefix_.size());
+    }
+
+    compiled_ = true;
+}
+
+const std::string &UriTemplate::encoded(const int frame, std::string &buffer) const {
+    buffer.clear();
+
+    if (not compiled_) {
+        buffer = uri_encode(fmt::format(decoded_, frame));
+        return buffer;
+    }
+
+    buffer.append(prefix_);
+
+    if (not field_.empty()) {
+        const auto start = buffer.size();
+        fmt::format_to(std::back_inserter(buffer), field_, frame);
+
+        // padding with spaces etc.
+        for (auto i = start; i < buffer.size(); i++) {
+            if (not std::isdigit(static_cast<unsigned char>(buffer[i])) and buffer[i] != '-') {
+                const auto number = uri_encode(buffer.substr(start));
+                buffer.replace(start, std::string::npos, number);
+                break;
+            }
+        }
+    }
+
+    buffer.append(suffix_);
+
+    return buffer;
+}
+
+std::optional<caf::uri> UriTemplate::uri(const int frame, std::string &buffer) const {
+    auto result = caf::make_uri(encoded(frame, buffer));
+    if (result)
+        return *result;
+    return {};
+}
+
+std::optional<caf::uri> UriTemplate::uri(const int frame) const {
+    std::string buffer;
+    return uri(frame, buffer);
+}
+
+std::vector<caf::uri> UriTemplate::uris(const std::vector<int> &frames) const {
+    std::vector<caf::uri> result;
+    result.reserve(frames.size());
+
+    std::string buffer;
+    for (const auto i : frames) {
+        auto u = uri(i, buffer);
+        result.emplace_back(u ? *u : caf::uri());
+    }
+
+    return result;
+}
@@ -107,4 +107,18 @@ TEST(FrameListTest, Test) {
 
     EXPECT_EQ(FrameList("1-5").frames(), std::vector<int>({1, 2, 3, 4, 5}));
     EXPECT_EQ(FrameList("1-5,6-10x2").frames(), std::vector<int>({1, 2, 3, 4, 5, 6, 8, 10}));
+
+    std::vector<int> frames;
+    EXPECT_TRUE(FrameList("1-5,6-10x2").frames(3, 4, frames));
+    EXPECT_EQ(frames, std::vector<int>({4, 5, 6, 8}));
+    EXPECT_FALSE(FrameList("1-5,6-10x2").frames(6, 3, frames));
+    EXPECT_THROW(static_cast<void>(FrameList("1-5,6-10x2").frame(8)), std::runtime_error);
+
+    FrameList fl("1-3,10-12");
+    EXPECT_TRUE(fl.pop_front());
+    EXPECT_EQ(fl.count(), unsigned(5));
+    EXPECT_EQ(fl.frame(2), 10);
+    fl.set_frame_groups({FrameGroup(1, 2)});
+    EXPECT_EQ(fl.count(), unsigned(2));
+    EXPECT_THROW(static_cast<void>(fl.frame(2)), std::runtime_error);
 }
@@ -2,6 +2,7 @@
 
 #include "xstudio/utility/helpers.hpp"
 #include "xstudio/utility/media_reference.hpp"
+#include "xstudio/utility/uri_template.hpp"
 #include "xstudio/utility/caf_helpers.hpp"
 
 #include <gtest/gtest.h>
@@ -44,3 +45,37 @@ TEST(MediaReferenceTest, Test) {
     EXPECT_EQ(mr5.uri(0, frame), posix_path_to_uri("/tmp/test/test.0002.exr"));
     EXPECT_EQ(mr5.uri(4, frame), posix_path_to_uri("/tmp/test/test.0010.exr"));
 }
+
+TEST(UriTemplateTest, Test) {
+    std::string buffer;
+
+    UriTemplate t1(posix_path_to_uri("/tmp/a b/test.{:04d}.exr"));
+    EXPECT_TRUE(t1.compiled());
+    EXPECT_EQ(t1.uri(12, buffer), posix_path_to_uri("/tmp/a b/test.0012.exr"));
+    EXPECT_EQ(t1.uri(-3, buffer), posix_path_to_uri("/tmp/a b/test.-003.exr"));
+
+    UriTemplate t2(posix_path_to_uri("/tmp/test.{:4d}.exr"));
+    EXPECT_EQ(t2.uri(12), posix_path_to_uri("/tmp/test.  12.exr"));
+
+    UriTemplate t3(posix_path_to_uri("/tmp/test.exr"));
+    EXPECT_EQ(t3.uri(12), posix_path_to_uri("/tmp/test.exr"));
+
+    EXPECT_EQ(
+        t1.uris({1, 2}),
+        std::vector<caf::uri>(
+            {posix_path_to_uri("/tmp/a b/test.0001.exr"),
+             posix_path_to_uri("/tmp/a b/test.0002.exr")}));
+
+    MediaReference mr(
+        posix_path_to_uri("/tmp/test/test.{:04d}.exr"), std::string("1-5,10-20x5"));
+    auto uris = mr.uris(3, 3);
+    ASSERT_EQ(uris.size(), size_t(3));
+    EXPECT_EQ(uris[0].first, posix_path_to_uri("/tmp/test/test.0004.exr"));
+    EXPECT_EQ(uris[2].first, posix_path_to_uri("/tmp/test/test.0010.exr"));
+    EXPECT_EQ(uris[2].second, 10);
+    EXPECT_EQ(mr.uris().size(), size_t(8));
+
+    // template follows the uri
+    mr.set_uri(posix_path_to_uri("/tmp/other.{:03d}.exr"));
+    EXPECT_EQ(mr.uri_from_frame(1), posix_path_to_uri("/tmp/other.001.exr"));
+}
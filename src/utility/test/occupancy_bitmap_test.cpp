@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "xstudio/utility/occupancy_bitmap.hpp"
+#include <gtest/gtest.h>
+
+using namespace xstudio::utility;
+
+TEST(OccupancyBitmapTest, Test) {
+    OccupancyBitmap b(200);
+    EXPECT_EQ(b.size(), size_t(200));
+    EXPECT_EQ(b.count(), size_t(0));
+    EXPECT_EQ(b.runs(), std::vector<uint32_t>({200}));
+    EXPECT_TRUE(b.ranges().empty());
+
+    EXPECT_TRUE(b.set(0));
+    EXPECT_FALSE(b.set(0));
+    EXPECT_FALSE(b.set(200));
+    EXPECT_EQ(b.version(), uint64_t(1));
+
+    for (size_t i = 60; i < 130; i++)
+        b.set(i);
+    b.set(199);
+
+    EXPECT_TRUE(b.test(0));
+    EXPECT_TRUE(b.test(64));
+    EXPECT_FALSE(b.test(130));
+    EXPECT_FALSE(b.test(1000));
+    EXPECT_EQ(b.count(), size_t(72));
+    EXPECT_EQ(b.runs(), std::vector<uint32_t>({0, 1, 59, 70, 69, 1}));
+
+    using Ranges = std::vector<std::pair<int, int>>;
+    EXPECT_EQ(b.ranges(), Ranges({{0, 0}, {60, 129}, {199, 199}}));
+
+    // sampled ranges close at the sample before the gap
+    EXPECT_EQ(b.ranges(50), Ranges({{0, 49}, {100, 149}}));
+
+    // round trip through runs
+    OccupancyBitmap c(b.size(), b.runs(), b.version());
+    EXPECT_EQ(c, b);
+    EXPECT_EQ(c.version(), b.version());
+    EXPECT_THROW(OccupancyBitmap(10, {5, 6}), std::runtime_error);
+
+    EXPECT_TRUE(b.set(64, false));
+    EXPECT_FALSE(b.test(64));
+    EXPECT_FALSE(c == b);
+
+    const auto v = b.version();
+    b.clear();
+    EXPECT_EQ(b.count(), size_t(0));
+    EXPECT_EQ(b.version(), v + 1);
+    b.clear();
+    EXPECT_EQ(b.version(), v + 1);
+
+    // shrinking drops bits past the end
+    b.set(150);
+    b.resize(100);
+    b.resize(200);
+    EXPECT_FALSE(b.test(150));
+    EXPECT_EQ(b.count(), size_t(0));
+}
+
+TEST(OccupancyBitmapTest, Large) {
+    // a long timeline with a cached block is a few runs to send
+    OccupancyBitmap b(100000);
+    for (size_t i = 1000; i < 5000; i++)
+        b.set(i);
+    EXPECT_EQ(b.runs(), std::vector<uint32_t>({1000, 4000, 95000}));
+    EXPECT_EQ(OccupancyBitmap(100000, b.runs()), b);
+}
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+
+#include "xstudio/utility/session_file.hpp"
+
+using namespace xstudio::utility;
+namespace fs = std::filesystem;
+
+namespace {
+nlohmann::json make_session(const int media_count) {
+    auto media = nlohmann::json::object();
+    for (int i = 0; i < media_count; i++)
+        media[std::to_string(i)] = {
+            {"base", {{"name", "media" + std::to_string(i)}, {"rate", 24.0}}},
+            {"actors", {{"a", {{"path", "/tmp/file.####.exr"}}}}}};
+
+    return {
+        {"store", {{"version", "0.10.0"}, {"path/with~tilde", true}}},
+        {"base", {{"container", {{"name", "session"}}}}},
+        {"actors",
+         {{"playlist", {{"base", {{"name", "p1"}}}, {"actors", media}}},
+          {"empty", nlohmann::json::object()}}},
+        {"bookmarks", {{"actors", {{"b1", {{"note", "hello"}}}}}}},
+        {"list", nlohmann::json::array({1, 2, 3})}};
+}
+
+struct TempDir {
+    TempDir() : path(fs::temp_directory_path() / ("xstudio_session_file_test")) {
+        fs::remove_all(path);
+        fs::create_directories(path);
+    }
+    ~TempDir() { fs::remove_all(path); }
+    std::string file(const std::string &name) const { return (path / name).string(); }
+    fs::path path;
+};
+} // namespace
+
+TEST(SessionFileTest, Test) {
+    TempDir dir;
+    auto session = make_session(10);
+    auto path    = dir.file("test.xsz");
+
+    EXPECT_TRUE(is_session_container_path(path));
+    EXPECT_TRUE(is_session_file_path(path));
+    EXPECT_TRUE(is_session_file_path(dir.file("test.xst")));
+    EXPECT_FALSE(is_session_file_path(dir.file("test.json")));
+
+    auto result = write_session_container(path, session);
+    EXPECT_TRUE(result.written);
+    EXPECT_EQ(result.chunks, result.chunks_written);
+    EXPECT_EQ(result.hash, session_container_hash(session));
+    EXPECT_TRUE(is_session_container(path));
+    EXPECT_EQ(read_session_file(path), session);
+
+    SessionContainerReader reader(path);
+    EXPECT_EQ(reader.hash(), result.hash);
+    EXPECT_EQ(reader.chunks().size(), result.chunks);
+    ASSERT_NE(reader.find("/bookmarks/actors/b1"), nullptr);
+    EXPECT_EQ(reader.read_chunk(*reader.find("/bookmarks/actors/b1"))["note"], "hello");
+    EXPECT_EQ(reader.find("/nothing"), nullptr);
+
+    // plain json still loads
+    auto json_path = dir.file("test.xst");
+    std::ofstream(json_path) << session.dump(2);
+    EXPECT_FALSE(is_session_container(json_path));
+    EXPECT_EQ(read_session_file(json_path), session);
+
+    EXPECT_THROW(SessionContainerReader{json_path}, std::runtime_error);
+}
+
+TEST(SessionFileIncrementalTest, Test) {
+    TempDir dir;
+    auto session = make_session(100);
+    auto path    = dir.file("test.xsz");
+
+    auto first = write_session_container(path, session);
+
+    // unchanged, nothing written
+    auto skipped = write_session_container(path, session, first.hash, path);
+    EXPECT_FALSE(skipped.written);
+    EXPECT_EQ(skipped.hash, first.hash);
+
+    // one media changed, only its chunk is appended in place
+    session["actors"]["playlist"]["actors"]["50"]["base"]["name"] = "changed";
+    auto size    = fs::file_size(path);
+    auto changed = write_session_container(path, session, first.hash, path);
+    EXPECT_TRUE(changed.written);
+    EXPECT_FALSE(changed.compacted);
+    EXPECT_NE(changed.hash, first.hash);
+    EXPECT_EQ(changed.chunks_written, size_t(1));
+    EXPECT_GT(fs::file_size(path), size);
+    EXPECT_EQ(read_session_file(path), session);
+
+    // different target, unchanged chunks copied from base
+    auto copy_path = dir.file("copy.xsz");
+    auto copy      = write_session_container(copy_path, session, 0, path);
+    EXPECT_EQ(copy.chunks_written, size_t(0));
+    EXPECT_EQ(copy.hash, changed.hash);
+    EXPECT_EQ(read_session_file(copy_path), session);
+    EXPECT_LT(fs::file_size(copy_path), fs::file_size(path));
+
+    // mostly new content, rewritten from scratch
+    auto replaced = make_session(100);
+    for (auto &[key, value] : replaced["actors"]["playlist"]["actors"].items())
+        value["base"]["rate"] = 25.0;
+    auto compact = write_session_container(path, replaced, 0, path);
+    EXPECT_TRUE(compact.compacted);
+    EXPECT_EQ(read_session_file(path), replaced);
+    EXPECT_FALSE(fs::exists(path + ".tmp"));
+}
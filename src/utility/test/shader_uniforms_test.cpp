@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <cstring>
+#include <gtest/gtest.h>
+
+#include "xstudio/utility/shader_uniforms.hpp"
+
+using namespace xstudio::utility;
+
+namespace {
+
+std::vector<float>
+floats(const ShaderUniforms &u, const std::string &name, const size_t count) {
+    std::vector<float> result(count);
+    std::memcpy(result.data(), u.data() + u.find(name)->offset, count * sizeof(float));
+    return result;
+}
+
+// the same values, in any order
+void expect_same_values(const ShaderUniforms &a, const ShaderUniforms &b) {
+    EXPECT_EQ(a.members().size(), b.members().size());
+    for (const auto &member : a.members()) {
+        const auto *p = b.find(member.name);
+        ASSERT_TRUE(p) << member.name;
+        EXPECT_EQ(p->type, member.type);
+        EXPECT_EQ(
+            std::memcmp(
+                a.data() + member.offset,
+                b.data() + p->offset,
+                ShaderUniforms::std140_size(member.type)),
+            0)
+            << member.name;
+    }
+}
+
+} // namespace
+
+TEST(ShaderUniformsTest, Test) {
+    ShaderUniforms u;
+    EXPECT_TRUE(u.empty());
+
+    Imath::M44f m;
+    m[3][0] = 5.0f;
+    m[0][1] = 2.0f;
+
+    u.set("use_bilinear_filtering", true);
+    u.set("to_coord_system", m);
+    u.set("colour", Imath::V3f(0.1f, 0.2f, 0.3f));
+    u.set("pixel_aspect", 2.0f);
+    u.set("dims", Imath::V2i(1920, 1080));
+    u.set("yuv_conv", Imath::M33f());
+    u.set("count", 3);
+
+    // std140 offsets
+    const std::vector<uint32_t> offsets = {0, 16, 80, 92, 96, 112, 160};
+    for (size_t i = 0; i < offsets.size(); i++)
+        EXPECT_EQ(u.members()[i].offset, offsets[i]) << u.members()[i].name;
+    EXPECT_EQ(u.size(), size_t(176));
+
+    // matrices go in a column at a time
+    const auto mat = floats(u, "to_coord_system", 16);
+    EXPECT_EQ(mat[3], 5.0f);
+    EXPECT_EQ(mat[4], 2.0f);
+    EXPECT_EQ(
+        floats(u, "yuv_conv", 12), std::vector<float>({1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0}));
+
+    EXPECT_EQ(u.value("pixel_aspect", 0.0f), 2.0f);
+    EXPECT_EQ(u.value("dims", Imath::V2i()), Imath::V2i(1920, 1080));
+    EXPECT_TRUE(u.value("use_bilinear_filtering", false));
+    EXPECT_EQ(u.value("count", 0), 3);
+    // missing or the wrong type
+    EXPECT_EQ(u.value("count", 1.0f), 1.0f);
+    EXPECT_EQ(u.value("nothing", 7), 7);
+
+    // overwriting leaves the layout alone
+    const auto layout = u.layout_id();
+    u.set("pixel_aspect", 1.0f);
+    u.set("use_bilinear_filtering", false);
+    EXPECT_EQ(u.layout_id(), layout);
+    EXPECT_EQ(u.size(), size_t(176));
+    EXPECT_EQ(u.value("pixel_aspect", 0.0f), 1.0f);
+    EXPECT_THROW(u.set("pixel_aspect", 1), std::runtime_error);
+
+    ShaderUniforms other;
+    other.set("use_bilinear_filtering", true);
+    EXPECT_NE(other.layout_id(), layout);
+
+    u.clear();
+    EXPECT_TRUE(u.empty());
+    EXPECT_EQ(u.size(), size_t(0));
+}
+
+TEST(ShaderUniformsTest, Json) {
+    ShaderUniforms u;
+    Imath::M44f m;
+    m[3][0] = 5.0f;
+    u.set("to_coord_system", m);
+    u.set("yuv_conv", Imath::M33f(1, 2, 3, 4, 5, 6, 7, 8, 9));
+    u.set("use_bilinear_filtering", true);
+    u.set("num_channels", 4);
+    u.set("offsets", Imath::V3i(16, 128, 128));
+    u.set("norm_coeff", 0.5f);
+
+    const auto js = u.to_json();
+    EXPECT_EQ(js["num_channels"], 4);
+    EXPECT_EQ(js["use_bilinear_filtering"], true);
+    EXPECT_EQ(js["offsets"], nlohmann::json({"ivec3", 1, 16, 128, 128}));
+    // json keys are sorted, so the layout isn't kept
+    expect_same_values(ShaderUniforms::from_json(js), u);
+
+    // the json the shader parameters have always been set with
+    JsonStore params;
+    params["to_coord_system"]        = m;
+    params["yuv_conv"]               = Imath::M33f(1, 2, 3, 4, 5, 6, 7, 8, 9);
+    params["use_bilinear_filtering"] = true;
+    params["num_channels"]           = 4;
+    params["offsets"]                = nlohmann::json({"ivec3", 1, 16, 128, 128});
+    params["norm_coeff"]             = 0.5f;
+
+    expect_same_values(ShaderUniforms::from_json(params), u);
+
+    EXPECT_THROW(
+        ShaderUniforms::from_json(nlohmann::json{{"a", {"vec2", 2, 1, 2, 3, 4}}}),
+        std::runtime_error);
+    EXPECT_THROW(
+        ShaderUniforms::from_json(nlohmann::json{{"a", {"sampler", 1, 0}}}),
+        std::runtime_error);
+}
+
+TEST(ShaderUniformsTest, Packing) {
+    // The viewport's per draw parameters, refilled in place for every draw in
+    // the order of the ViewportParameters block in shader_program_base.cpp:
+    //
+    // layout (std140) uniform ViewportParameters {
+    //     mat4 to_coord_system;
+    //     mat4 to_canvas;
+    //     float pixel_aspect;
+    //     bool use_bilinear_filtering;
+    // };
+    Imath::M44f to_coord_system, to_canvas;
+    to_coord_system[3][0] = 0.25f;
+    to_canvas[0][1]       = 3.0f;
+
+    ShaderUniforms u;
+    uint64_t layout = 0;
+    for (int i = 0; i < 3; i++) {
+        u.set("to_coord_system", to_coord_system);
+        u.set("to_canvas", to_canvas);
+        u.set("pixel_aspect", 1.0f + float(i));
+        u.set("use_bilinear_filtering", (i & 1) != 0);
+        if (i)
+            EXPECT_EQ(u.layout_id(), layout);
+        layout = u.layout_id();
+    }
+
+    // two mat4s, then a float and a bool packed into the next 16 bytes
+    const std::vector<std::string> names = {
+        "to_coord_system", "to_canvas", "pixel_aspect", "use_bilinear_filtering"};
+    const std::vector<uint32_t> offsets = {0, 64, 128, 132};
+    ASSERT_EQ(u.members().size(), offsets.size());
+    for (size_t i = 0; i < offsets.size(); i++) {
+        EXPECT_EQ(u.members()[i].name, names[i]);
+        EXPECT_EQ(u.members()[i].offset, offsets[i]) << u.members()[i].name;
+    }
+    EXPECT_EQ(u.size(), size_t(144));
+
+    // the values from the last draw, matrices a column at a time
+    const auto coord = floats(u, "to_coord_system", 16);
+    EXPECT_EQ(coord[3], 0.25f);
+    EXPECT_EQ(coord[0] + coord[5] + coord[10] + coord[15], 4.0f);
+    const auto canvas = floats(u, "to_canvas", 16);
+    EXPECT_EQ(canvas[4], 3.0f);
+
+    EXPECT_EQ(floats(u, "pixel_aspect", 1), std::vector<float>({3.0f}));
+    uint32_t bilinear = 2;
+    std::memcpy(&bilinear, u.data() + 132, sizeof(bilinear));
+    EXPECT_EQ(bilinear, uint32_t(0));
+
+    // the padding is left zeroed
+    uint32_t padding[2] = {1, 1};
+    std::memcpy(padding, u.data() + 136, sizeof(padding));
+    EXPECT_EQ(padding[0], uint32_t(0));
+    EXPECT_EQ(padding[1], uint32_t(0));
+}
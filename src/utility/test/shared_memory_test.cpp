@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <cstring>
+#include <gtest/gtest.h>
+
+#include "xstudio/utility/shared_memory.hpp"
+
+using namespace xstudio::utility;
+
+TEST(SharedMemoryTest, Test) {
+    auto writer = SharedMemorySegment::create(4096);
+    EXPECT_TRUE(writer->owner());
+    EXPECT_EQ(writer->size(), size_t(4096));
+    EXPECT_NE(writer->data(), nullptr);
+
+    std::memcpy(writer->data(), "xstudio", 8);
+
+    auto reader = SharedMemorySegment::open(writer->name());
+    EXPECT_FALSE(reader->owner());
+    EXPECT_EQ(reader->size(), size_t(4096));
+    EXPECT_EQ(std::string(reinterpret_cast<const char *>(reader->data())), "xstudio");
+
+    // existing mappings survive unlink
+    auto name = writer->name();
+    writer->unlink();
+    EXPECT_EQ(std::string(reinterpret_cast<const char *>(reader->data())), "xstudio");
+    EXPECT_THROW(SharedMemorySegment::open(name), std::runtime_error);
+}
+
+TEST(SharedMemoryTest, Release) {
+    std::string name;
+    {
+        auto writer = SharedMemorySegment::create(16);
+        name        = writer->name();
+        writer->release();
+    }
+
+    auto reader = SharedMemorySegment::open(name);
+    EXPECT_EQ(reader->size(), size_t(16));
+    reader->unlink();
+    EXPECT_THROW(SharedMemorySegment::open(name), std::runtime_error);
+
+    EXPECT_NE(unique_shared_memory_name(), unique_shared_memory_name());
+}
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <numeric>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "xstudio/utility/shm_channel.hpp"
+
+using namespace xstudio::utility;
+
+TEST(ShmRingBufferTest, Test) {
+    auto segment = SharedMemorySegment::create(ShmRingBuffer::segment_size(16));
+    ShmRingBuffer writer(segment, true);
+    ShmRingBuffer reader(SharedMemorySegment::open(segment->name(), false), false);
+
+    EXPECT_EQ(writer.capacity(), size_t(16));
+    EXPECT_EQ(writer.writable(), size_t(16));
+
+    std::vector<std::byte> in(24), out(24);
+    std::iota(
+        reinterpret_cast<uint8_t *>(in.data()), reinterpret_cast<uint8_t *>(in.data()) + 24, 0);
+
+    EXPECT_EQ(writer.write_some(in.data(), 24), size_t(16));
+    EXPECT_EQ(writer.writable(), size_t(0));
+    EXPECT_EQ(reader.read_some(out.data(), 10), size_t(10));
+
+    // wraps around the end
+    EXPECT_EQ(writer.write_some(in.data() + 16, 8), size_t(8));
+    EXPECT_EQ(reader.read_some(out.data() + 10, 24), size_t(14));
+    EXPECT_EQ(in, out);
+}
+
+TEST(ShmChannelTest, Test) {
+    ShmChannelListener listener("", 1024);
+
+    ShmChannelPtr server;
+    std::thread accept_thread([&]() { server = listener.accept(); });
+    auto client = ShmChannel::connect(listener.path());
+    accept_thread.join();
+
+    ASSERT_TRUE(server);
+    EXPECT_EQ(client->token(), server->token());
+
+    std::vector<std::byte> small(100, std::byte{1});
+    // larger than the ring, has to be streamed
+    std::vector<std::byte> large(100000);
+    for (size_t i = 0; i < large.size(); i++)
+        large[i] = static_cast<std::byte>(i % 251);
+
+    std::thread echo([&]() {
+        std::vector<std::byte> frame;
+        while (server->receive(frame)) {
+            server->acknowledge();
+            server->send(frame);
+        }
+    });
+
+    std::vector<std::byte> frame;
+    EXPECT_TRUE(client->send(small));
+    EXPECT_TRUE(client->receive(frame));
+    EXPECT_EQ(frame, small);
+
+    EXPECT_TRUE(client->send(large));
+    EXPECT_TRUE(client->receive(frame));
+    EXPECT_EQ(frame, large);
+    EXPECT_TRUE(client->wait_acknowledged());
+
+    EXPECT_TRUE(client->send(std::vector<std::byte>()));
+    EXPECT_TRUE(client->receive(frame));
+    EXPECT_TRUE(frame.empty());
+
+    client->close();
+    echo.join();
+    EXPECT_FALSE(server->is_open());
+    EXPECT_FALSE(client->send(small));
+}
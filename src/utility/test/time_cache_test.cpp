@@ -179,3 +179,26 @@ TEST(TimeCacheTest2, Test) {
     // new
     EXPECT_TRUE(mc.store_check("test", 1000));
 }
+
+TEST(TimeCacheTest, EvictCallback) {
+    TimeCache<std::string, std::shared_ptr<std::string>> mc;
+    std::vector<std::string> evicted;
+    mc.bind_evict_callback(
+        [&evicted](const std::string &key, const std::shared_ptr<std::string> &value) {
+            EXPECT_TRUE(value);
+            evicted.push_back(key);
+        });
+
+    mc.store("test1", std::make_shared<std::string>("testing"));
+    mc.store("test2", std::make_shared<std::string>("testing"));
+    mc.erase("test2");
+    EXPECT_TRUE(evicted.empty());
+
+    // making room hands the entry over before it goes
+    mc.set_max_count(1);
+    mc.store("test3", std::make_shared<std::string>("testing"), clock::now(), true);
+    EXPECT_EQ(evicted, std::vector<std::string>({"test1"}));
+
+    mc.clear();
+    EXPECT_EQ(evicted.size(), size_t(1));
+}
@@ -13,7 +13,7 @@ FileDialog {
     signal saved
     signal cancelled
 
-    nameFilters:  ["XStudio (*.xst)"]
+    nameFilters:  ["XStudio (*.xst)", "XStudio binary (*.xsz)"]
     selectExisting: false
     selectMultiple: false
 